@@ -102,7 +102,7 @@ int main(int argc, char **argv)
 #include <visp3/gui/vpDisplayGDI.h>
 #include <iostream>
 
-#include "vpRequestImage.h" //See vpRequest class documentation
+#include <visp3/core/vpRequestImage.h>
 
 int main(int argc, char **argv)
 {
@@ -129,7 +129,7 @@ int main(int argc, char **argv)
   client.connectToHostname(servername, port);
   //client.connectToIP("127.0.0.1",port);
 
-  vpRequestImage reqImage(&I);
+  vpRequestImage<unsigned char> reqImage(I);
 
   while(1)
   {
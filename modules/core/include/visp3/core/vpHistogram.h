@@ -53,12 +53,14 @@
 #include <visp3/core/vpHistogramPeak.h>
 #include <visp3/core/vpHistogramValey.h>
 #include <visp3/core/vpColor.h>
+#include <visp3/core/vpRect.h>
 
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
 #  include <visp3/core/vpList.h>
 #endif
 
 #include <list>
+#include <vector>
 
 /*!
   \class vpHistogram
@@ -109,6 +111,11 @@
   threshold = valey.getLevel();
   \endcode
 
+  The histogram can also be computed on a region of interest, on the pixels
+  selected by a mask (see setMask()), and on 16-bits images like depth
+  maps. The cumulative histogram (getCumulative()) gives a fast histogram
+  equalization (equalize()) and the Otsu threshold (getOtsuThreshold()).
+
 */
 class VISP_EXPORT vpHistogram
 {
@@ -240,10 +247,32 @@ public:
   };
 
   void     calculate(const vpImage<unsigned char> &I, const unsigned int nbins=256, const unsigned int nbThreads=1);
+  void     calculate(const vpImage<unsigned char> &I, const vpRect &roi, const unsigned int nbins=256,
+                     const unsigned int nbThreads=1);
+  void     calculate(const vpImage<uint16_t> &I, const unsigned int nbins=0x10000, const unsigned int nbThreads=1);
+  void     calculate(const vpImage<uint16_t> &I, const vpRect &roi, const unsigned int nbins=0x10000,
+                     const unsigned int nbThreads=1);
 
   void     display(const vpImage<unsigned char> &I, const vpColor &color=vpColor::white, const unsigned int thickness=2,
                    const unsigned int maxValue_=0);
 
+  void     equalize(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ieq, const unsigned int nbThreads=1) const;
+  void     getCumulative(std::vector<unsigned int> &cumulative) const;
+  unsigned int getOtsuThreshold() const;
+  unsigned int getTotal() const;
+
+  /*!
+    Set the mask of the pixels taken into account by calculate(): only the
+    pixels where the mask is true are counted. The mask must have the size
+    of the images and exist until the histogram is calculated.
+
+    \param p_mask : Pointer to the mask, or NULL to count all the pixels.
+  */
+  inline void setMask(const vpImage<bool> *p_mask)
+  {
+    mask = p_mask;
+  }
+
   void     smooth(const unsigned int fsize = 3);
   unsigned getPeaks(std::list<vpHistogramPeak> & peaks);
   unsigned getPeaks(unsigned char dist, 
@@ -307,9 +336,11 @@ public:
 
 private:
   void init(unsigned size = 256);
+  void resize(const unsigned int nbins, const unsigned int maxBins);
 
   unsigned int *histogram;
-  unsigned size; // Histogram size (max allowed 256)
+  unsigned size; // Histogram size (max allowed 256, 65536 for 16-bits images)
+  const vpImage<bool> *mask; // Pixels taken into account, or NULL for all the pixels
 };
 
 
@@ -63,17 +63,30 @@
 
   \brief  Various image filter, convolution, etc...
 
+  The separable filters (filter(), filterX(), filterY(), gaussianBlur(),
+  sepFilter(), getGradX(), getGradY(), getGradXGauss2D() and getGradYGauss2D())
+  share the same engine: the rows are processed in single precision float,
+  the borders are handled once per row or per column before the convolution,
+  the convolution is vectorized with SSE2 when available and the image is
+  split in bands of rows processed by vpThreadPool. The functions that apply
+  two 1D filters have an overload taking the intermediate image as a buffer
+  that can be kept by the caller from one image to the next.
+
 */
 class VISP_EXPORT vpImageFilter
 {
 public:
-#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
   static void canny(const vpImage<unsigned char>& I,
                     vpImage<unsigned char>& Ic,
                     const unsigned int gaussianFilterSize,
                     const double thresholdCanny,
                     const unsigned int apertureSobel);
-#endif
+  static void canny(const vpImage<unsigned char>& I,
+                    vpImage<unsigned char>& Ic,
+                    const unsigned int gaussianFilterSize,
+                    const double lowerThreshold,
+                    const double upperThreshold,
+                    const unsigned int apertureSobel);
 
   /*!
    Apply a 1x3 derivative filter to an image pixel.
@@ -181,9 +194,18 @@ public:
                         vpImage<double>& If,
                         const vpColVector& kernelH,
                         const vpColVector& kernelV);
+  static void sepFilter(const vpImage<unsigned char> &I,
+                        vpImage<double>& If,
+                        const vpColVector& kernelH,
+                        const vpColVector& kernelV,
+                        vpImage<float> &buffer);
 
   static void filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size);
   static void filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size);
+  static void filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size,
+                     vpImage<float> &buffer);
+  static void filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size,
+                     vpImage<float> &buffer);
 
   static inline unsigned char filterGaussXPyramidal(const vpImage<unsigned char> &I, unsigned int i, unsigned int j)
   {
@@ -398,6 +420,10 @@ public:
 
   static void gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
   static void gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, unsigned int size=7, double sigma=0., bool normalize=true);
+  static void gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, vpImage<float> &buffer,
+                           unsigned int size=7, double sigma=0., bool normalize=true);
+  static void gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, vpImage<float> &buffer,
+                           unsigned int size=7, double sigma=0., bool normalize=true);
   /*!
    Apply a 5x5 Gaussian filter to an image pixel.
 
@@ -435,6 +461,8 @@ public:
   static void getGradX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter, unsigned int size);
   static void getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel,
                               const double *gaussianDerivativeKernel, unsigned  int size);
+  static void getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel,
+                              const double *gaussianDerivativeKernel, unsigned  int size, vpImage<float> &buffer);
 
   //fonction renvoyant le gradient en Y de l'image I
   static void getGradY(const vpImage<unsigned char> &I, vpImage<double>& dIy);
@@ -442,6 +470,8 @@ public:
   static void getGradY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter, unsigned int size);
   static void getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel,
                               const double *gaussianDerivativeKernel,unsigned  int size);
+  static void getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel,
+                              const double *gaussianDerivativeKernel, unsigned  int size, vpImage<float> &buffer);
 };
 
 
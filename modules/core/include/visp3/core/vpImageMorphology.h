@@ -60,6 +60,30 @@
 
   \brief  Various mathematical morphology tools, erosion, dilatation...
 
+  Besides the 3x3 operators given by a connexity, grayscale erosion and
+  dilatation of unsigned char images can use rectangles and lines of any
+  size as flat structuring elements. They are computed with the van Herk /
+  Gil-Werman algorithm, whose cost of about three comparisons per pixel and
+  per direction does not depend on the size of the element, and are
+  parallelized over bands of rows with vpThreadPool. Opening, closing,
+  top-hats and morphological gradient are built on them.
+
+  \code
+#include <visp3/core/vpImageMorphology.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640, 0);
+  // ...
+  // Remove the bright details smaller than 15x15 pixels
+  vpImageMorphology::opening(I, 15, 15);
+  // Keep the bright lines thinner than 5 pixels on a varying background
+  vpImageMorphology::topHat(I, 5, 5);
+  // Dilate along the diagonal going down to the right
+  vpImageMorphology::dilatation(I, 9, 9, vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL);
+}
+  \endcode
+
   \author Fabien Spindler  (Fabien.Spindler@irisa.fr) Irisa / Inria Rennes
 
 
@@ -77,6 +101,23 @@ public:
                      right, up, down, and the 4 pixels located on the diagonal) */
   } vpConnexityType;
 
+  /*! \enum vpStructuringElementType
+  Shape of a flat structuring element of width x height pixels. The element
+  is centered on the pixel (width/2, height/2) of its bounding box.
+  */
+  typedef enum {
+    STRUCTURING_ELEMENT_RECTANGLE, /*!< All the pixels of the width x height
+                                        rectangle. A width x 1 (resp. 1 x height)
+                                        rectangle is a horizontal (resp. vertical)
+                                        line. */
+    STRUCTURING_ELEMENT_DIAGONAL, /*!< Line going from the top left to the
+                                       bottom right corner of a square
+                                       (width and height must be equal). */
+    STRUCTURING_ELEMENT_ANTIDIAGONAL /*!< Line going from the bottom left to
+                                          the top right corner of a square
+                                          (width and height must be equal). */
+  } vpStructuringElementType;
+
 public:
   template<class Type>
   static void erosion(vpImage<Type> &I, Type value, Type value_out,
@@ -88,6 +129,22 @@ public:
 
   static void erosion(vpImage<unsigned char> &I, const vpConnexityType &connexity = CONNEXITY_4);
   static void dilatation(vpImage<unsigned char> &I, const vpConnexityType &connexity = CONNEXITY_4);
+
+  static void erosion(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                      const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+  static void dilatation(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                         const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+
+  static void opening(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                      const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+  static void closing(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                      const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+  static void topHat(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                     const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+  static void blackHat(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                       const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
+  static void gradient(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                       const vpStructuringElementType &element = STRUCTURING_ELEMENT_RECTANGLE);
 } ;
 
 /*!
@@ -49,14 +49,12 @@
 
 #include <visp3/core/vpImage.h>
 
-#ifdef VISP_HAVE_PTHREAD
-#  include <pthread.h>
-#endif
-
 #include <visp3/core/vpImageException.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpRect.h>
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpUndistortionMap.h>
 
 #include <fstream>
 #include <iostream>
@@ -154,6 +152,12 @@ public:
   static void undistort(const vpImage<Type> &I,
                         const vpCameraParameters &cam,
                         vpImage<Type> &newI);
+  static void undistort(const vpImage<unsigned char> &I,
+                        const vpUndistortionMap &map,
+                        vpImage<unsigned char> &newI);
+  static void undistort(const vpImage<vpRGBa> &I,
+                        const vpUndistortionMap &map,
+                        vpImage<vpRGBa> &newI);
 
 #if defined(VISP_BUILD_DEPRECATED_FUNCTIONS)
   /*!
@@ -477,58 +481,36 @@ inline void vpImageTools::binarise(vpImage<unsigned char> &I,
   }
 }
 
-#ifdef VISP_HAVE_PTHREAD
-
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Undistortion of the rows [start, end) of an image
 template<class Type>
-class vpUndistortInternalType
+class vpUndistortInternalType : public vpParallelLoopBody
 {
 public:
-  Type *src;
-  Type *dst;
-  unsigned int width;
-  unsigned int height;
-  vpCameraParameters cam;
-  unsigned int nthreads;
-  unsigned int threadid;
-public:
-  vpUndistortInternalType()
-    : src(NULL), dst(NULL), width(0), height(0), cam(), nthreads(0), threadid(0)
-  {};
+  vpUndistortInternalType(const vpImage<Type> &I, const vpCameraParameters &cam, vpImage<Type> &undistI)
+    : m_I(I), m_cam(cam), m_undistI(undistI) {}
 
-  vpUndistortInternalType(const vpUndistortInternalType<Type> &u) {
-    *this = u;
-  };
-  vpUndistortInternalType &operator=(const vpUndistortInternalType<Type> &u) {
-    src = u.src;
-    dst = u.dst;
-    width = u.width;
-    height = u.height;
-    cam = u.cam;
-    nthreads = u.nthreads;
-    threadid = u.threadid;
-
-    return *this;
-  }
+  void operator()(unsigned int start, unsigned int end) const;
 
-  static void *vpUndistort_threaded(void *arg);
-};
+private:
+  vpUndistortInternalType &operator=(const vpUndistortInternalType &);
 
+  const vpImage<Type> &m_I;
+  const vpCameraParameters &m_cam;
+  vpImage<Type> &m_undistI;
+};
 
 template<class Type>
-void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
+void vpUndistortInternalType<Type>::operator()(unsigned int start, unsigned int end) const
 {
-  vpUndistortInternalType<Type> *undistortSharedData = (vpUndistortInternalType<Type>*)arg;
-  int offset   = (int)undistortSharedData->threadid;
-  int width    = (int)undistortSharedData->width;
-  int height   = (int)undistortSharedData->height;
-  int nthreads = (int)undistortSharedData->nthreads;
-
-  double u0 = undistortSharedData->cam.get_u0();
-  double v0 = undistortSharedData->cam.get_v0();
-  double px = undistortSharedData->cam.get_px();
-  double py = undistortSharedData->cam.get_py();
-  double kud = undistortSharedData->cam.get_kud();
+  int width = (int) m_I.getWidth();
+  int height = (int) m_I.getHeight();
+
+  double u0 = m_cam.get_u0();
+  double v0 = m_cam.get_v0();
+  double px = m_cam.get_px();
+  double py = m_cam.get_py();
+  double kud = m_cam.get_kud();
 
   double invpx = 1.0/px;
   double invpy = 1.0/py;
@@ -536,10 +518,10 @@ void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
   double kud_px2 = kud * invpx * invpx;
   double kud_py2 = kud * invpy * invpy;
 
-  Type *dst = undistortSharedData->dst+(height/nthreads*offset)*width;
-  Type *src = undistortSharedData->src;
+  Type *dst = m_undistI.bitmap + start * (unsigned int) width;
+  const Type *src = m_I.bitmap;
 
-  for (double v = height/nthreads*offset;v < height/nthreads*(offset+1) ; v++) {
+  for (double v = start; v < end ; v++) {
     double  deltav  = v - v0;
     //double fr1 = 1.0 + kd * (vpMath::sqr(deltav * invpy));
     double fr1 = 1.0 + kud_py2 * deltav * deltav;
@@ -579,12 +561,8 @@ void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
       dst++;
     }
   }
-
-  pthread_exit((void*) 0);
-  return NULL;
 }
 #endif // DOXYGEN_SHOULD_SKIP_THIS
-#endif // VISP_HAVE_PTHREAD
 
 /*!
   Undistort an image
@@ -604,76 +582,23 @@ void *vpUndistortInternalType<Type>::vpUndistort_threaded(void *arg)
   \warning This function is time consuming :
     - On "Rhea"(Intel Core 2 Extreme X6800 2.93GHz, 2Go RAM)
       or "Charon"(Intel Xeon 3 GHz, 2Go RAM) : ~8 ms for a 640x480 image.
+
+  The rows are processed by vpThreadPool::getConcurrency() threads.
+
+  When several images acquired by the same camera have to be undistorted,
+  prefer undistort(const vpImage<unsigned char> &, const vpUndistortionMap &, vpImage<unsigned char> &)
+  that evaluates the distortion model only once.
 */
 template<class Type>
 void vpImageTools::undistort(const vpImage<Type> &I,
                              const vpCameraParameters &cam,
                              vpImage<Type> &undistI)
 {
-#ifdef VISP_HAVE_PTHREAD
-  //
-  // Optimized version using pthreads
-  //
-  unsigned int width = I.getWidth();
-  unsigned int height = I.getHeight();
-
-  undistI.resize(height, width);
-
-  double kud = cam.get_kud();
-
-  //if (kud == 0) {
-  if (std::fabs(kud) <= std::numeric_limits<double>::epsilon()) {
-    // There is no need to undistort the image
-    undistI = I;
-    return;
-  }
-
-  unsigned int nthreads = 2;
-  pthread_attr_t attr;
-  pthread_t *callThd = new pthread_t [nthreads];
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  vpUndistortInternalType<Type> *undistortSharedData;
-  undistortSharedData = new vpUndistortInternalType<Type> [nthreads];
-
-  for(unsigned int i=0;i<nthreads;i++) {
-    // Each thread works on a different set of data.
-    //    vpTRACE("create thread %d", i);
-    undistortSharedData[i].src      = I.bitmap;
-    undistortSharedData[i].dst      = undistI.bitmap;
-    undistortSharedData[i].width    = I.getWidth();
-    undistortSharedData[i].height   = I.getHeight();
-    undistortSharedData[i].cam      = cam;
-    undistortSharedData[i].nthreads = nthreads;
-    undistortSharedData[i].threadid = i;
-    pthread_create( &callThd[i], &attr,
-                    &vpUndistortInternalType<Type>::vpUndistort_threaded,
-                    &undistortSharedData[i]);
-  }
-  pthread_attr_destroy(&attr);
-  /* Wait on the other threads */
-
-  for(unsigned int i=0;i<nthreads;i++) {
-    //  vpTRACE("join thread %d", i);
-    pthread_join( callThd[i], NULL);
-  }
-
-  delete [] callThd;
-  delete [] undistortSharedData;
-#else // VISP_HAVE_PTHREAD
-  //
-  // optimized version without pthreads
-  //
   unsigned int width = I.getWidth();
   unsigned int height = I.getHeight();
 
   undistI.resize(height, width);
 
-  double u0 = cam.get_u0();
-  double v0 = cam.get_v0();
-  double px = cam.get_px();
-  double py = cam.get_py();
   double kud = cam.get_kud();
 
   //if (kud == 0) {
@@ -683,57 +608,9 @@ void vpImageTools::undistort(const vpImage<Type> &I,
     return;
   }
 
-  double invpx = 1.0/px;
-  double invpy = 1.0/py;
-
-  double kud_px2 = kud * invpx * invpx;
-  double kud_py2 = kud * invpy * invpy;
-
-  Type *dst = undistI.bitmap;
-  for (double v = 0;v < height ; v++) {
-    double  deltav  = v - v0;
-    //double fr1 = 1.0 + kd * (vpMath::sqr(deltav * invpy));
-    double fr1 = 1.0 + kud_py2 * deltav * deltav;
+  // The rows are shared between the threads of the pool
+  vpThreadPool::parallelFor(0, height, vpUndistortInternalType<Type>(I, cam, undistI));
 
-    for (double u = 0 ; u < width ; u++) {
-      //computation of u,v : corresponding pixel coordinates in I.
-      double  deltau  = u - u0;
-      //double fr2 = fr1 + kd * (vpMath::sqr(deltau * invpx));
-      double fr2 = fr1 + kud_px2 * deltau * deltau;
-
-      double u_double = deltau * fr2 + u0;
-      double v_double = deltav * fr2 + v0;
-
-      //printf("[%g][%g] %g %g : ", u, v, u_double, v_double );
-
-      //computation of the bilinear interpolation
-
-      //declarations
-      int u_round  = (int) (u_double);
-      int v_round  = (int) (v_double);
-      if (u_round < 0.f) u_round = -1;
-      if (v_round < 0.f) v_round = -1;
-      double  du_double  = (u_double) - (double) u_round;
-      double  dv_double  = (v_double) - (double) v_round;
-      Type  v01;
-      Type  v23;
-      if ( (0 <= u_round) && (0 <= v_round) &&
-           (u_round < (((int)width) - 1)) && (v_round < (((int)height) - 1)) ) {
-        //process interpolation
-        const Type* _mp = &I[(unsigned int)v_round][(unsigned int)u_round];
-        v01 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        _mp += width;
-        v23 = (Type)(_mp[0] + ((_mp[1] - _mp[0]) * du_double));
-        *dst = (Type)(v01 + ((v23 - v01) * dv_double));
-        //printf("R %d G %d B %d\n", dst->R, dst->G, dst->B);
-      }
-      else {
-        *dst = 0;
-      }
-      dst++;
-    }
-  }
-#endif // VISP_HAVE_PTHREAD
 
 
 
@@ -0,0 +1,129 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * File mapped in memory with a private copy-on-write mapping.
+ *
+ *****************************************************************************/
+
+#ifndef __vpMemoryMappedFile_h__
+#define __vpMemoryMappedFile_h__
+
+/*!
+  \file vpMemoryMappedFile.h
+
+  \brief File mapped in memory with a private copy-on-write mapping.
+*/
+
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpMemoryMappedFile
+
+  \ingroup group_core_files_io
+
+  \brief File mapped in memory, to use the content of large files in place
+  instead of reading and copying it.
+
+  The pages of the file are loaded by the system when they are first
+  accessed. The mapping is private and copy-on-write: the content can be
+  modified in memory, a modified page being then copied for this mapping
+  only, and the file itself is never modified. The pages that are not
+  modified are shared between the processes mapping the same file.
+
+  On Unix systems the file is mapped with mmap(), on Windows with
+  MapViewOfFile(). On the other platforms the file is read in a buffer.
+
+  \code
+#include <visp3/core/vpMemoryMappedFile.h>
+
+int main()
+{
+  vpMemoryMappedFile file("data.bin");
+  const unsigned char *data = file.getData();
+  size_t size = file.getSize();
+  // ... use data[0] to data[size-1] while the file is open
+}
+  \endcode
+
+  The data are 64 bytes aligned (page aligned when the file is mapped).
+*/
+class VISP_EXPORT vpMemoryMappedFile
+{
+public:
+  vpMemoryMappedFile();
+  explicit vpMemoryMappedFile(const std::string &filename);
+  virtual ~vpMemoryMappedFile();
+
+  void close();
+
+  /*!
+    \return The content of the file, NULL if no file is open or if the file is empty.
+  */
+  inline unsigned char *getData() { return m_data; }
+  /*!
+    \return The content of the file, NULL if no file is open or if the file is empty.
+  */
+  inline const unsigned char *getData() const { return m_data; }
+  /*!
+    \return The size of the file in bytes.
+  */
+  inline size_t getSize() const { return m_size; }
+  /*!
+    \return true if a file is open.
+  */
+  inline bool isOpen() const { return m_isOpen; }
+
+  void open(const std::string &filename);
+
+private:
+  // The mapping can not be shared
+  vpMemoryMappedFile(const vpMemoryMappedFile &);
+  vpMemoryMappedFile &operator=(const vpMemoryMappedFile &);
+
+  //! Content of the file.
+  unsigned char *m_data;
+  //! Size of the file in bytes.
+  size_t m_size;
+  //! True if a file is open.
+  bool m_isOpen;
+  //! True if m_data is a mapping of the file, false if it points to m_buffer.
+  bool m_isMapped;
+  //! Content of the file when it can not be mapped, with room for the alignment.
+  std::vector<unsigned char> m_buffer;
+#if defined(_WIN32)
+  //! Handle of the file mapping.
+  void *m_mapping;
+#endif
+};
+
+#endif
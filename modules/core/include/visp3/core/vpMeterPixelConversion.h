@@ -53,6 +53,8 @@
 #include <visp3/core/vpImagePoint.h>
 #include <visp3/core/vpMath.h>
 
+#include <vector>
+
 /*!
   \class vpMeterPixelConversion
 
@@ -63,6 +65,9 @@
 
   This class relates to vpCameraParameters.
 
+  To convert many points at once, convertPoints() processes arrays of
+  coordinates.
+
 */
 class VISP_EXPORT vpMeterPixelConversion
 {
@@ -75,6 +80,13 @@ public:
                             const double &rho_m, const double &theta_m,
                             double &rho_p, double &theta_p) ;
 
+    static void convertPoints(const vpCameraParameters &cam,
+                              const double *x, const double *y, unsigned int n,
+                              double *u, double *v);
+    static void convertPoints(const vpCameraParameters &cam,
+                              const std::vector<double> &x, const std::vector<double> &y,
+                              std::vector<double> &u, std::vector<double> &v);
+
 /*!
 
   \brief Point coordinates conversion from normalized coordinates
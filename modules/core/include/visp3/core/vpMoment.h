@@ -90,6 +90,11 @@ class vpMomentObject;
   Each moment must have a string name by implementing the char* vpMoment::name() method which allows to identify the moment in the database.
   Each moment must also implement a compute method describing how to obtain its values from the object.
 
+  A moment that depends on other moments declares their names with addDependency() in its constructor
+  and accesses them with getDependency(). The dependencies are resolved into pointers to the moments of
+  the database once, and only resolved again when a moment is linked to the database. They also allow
+  vpMomentDatabase::computeAll() to compute the moments in the order of their dependencies.
+
   \attention Order of moment computation DOES matter: when you compute a moment using vpMoment::compute(),
   all moment dependencies must be computed.
   We recall that implemented moments are:
@@ -109,6 +114,13 @@ private:
   vpMomentObject* object;
   vpMomentDatabase* moments;
   char _name[255];
+  //! Names of the moments this moment depends on.
+  std::vector<const char*> dependencyNames;
+  //! Moments of the database corresponding to dependencyNames.
+  mutable std::vector<const vpMoment*> dependencies;
+  //! Database and database revision for which the dependencies were resolved.
+  mutable const vpMomentDatabase* dependencyDatabase;
+  mutable unsigned int dependencyRevision;
 
 protected:
   std::vector<double> values;
@@ -118,6 +130,9 @@ protected:
    */
   inline vpMomentDatabase& getMoments() const { return *moments; }
 
+  void addDependency(const char* type);
+  const vpMoment& getDependency(const char* type, bool& found) const;
+
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
 //  vpMoment(const vpMoment &)
@@ -153,6 +168,7 @@ public:
   virtual void printDependencies(std::ostream& os) const;
   void update(vpMomentObject& object);
   //@}
+  friend class vpMomentDatabase;
   friend VISP_EXPORT std::ostream & operator<<(std::ostream & os, const vpMoment& m);
 };
 #endif
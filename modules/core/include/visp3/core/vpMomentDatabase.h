@@ -46,6 +46,7 @@
 #include <map>
 #include <iostream>
 #include <cstring>
+#include <vector>
 
 class vpMoment;
 class vpMomentObject;
@@ -96,10 +97,8 @@ int main()
   
   db.updateAll(obj); // All of the moments must be updated, not just mc
   
-  //There is no global compute method since the order of compute calls
-  //depends on the implementation
-  g.compute(); // compute the moment
-  mc.compute(); //compute centered moments AFTER gravity center
+  //Compute the gravity center first, then the centered moments
+  db.computeAll();
   
   std::cout << "Gravity center: " << g << std:: endl; // print gravity center moment
   std::cout << "Centered moments: " << mc << std:: endl; // print centered moment
@@ -119,6 +118,10 @@ Centered moments:
 
   A moment is identified in the database by it's vpMoment::name method. Consequently, a database can contain at most one moment of each type.
   Often it is useful to update all moments with the same object. Shortcuts (vpMomentDatabase::updateAll) are provided for that matter.
+
+  The dependencies declared by the moments are resolved into pointers the first time they are needed after a moment is
+  linked to the database, and the moments are sorted so that vpMomentDatabase::computeAll() computes each moment after
+  the moments it depends on. Moments without dependencies between them are computed in the order they were linked.
 */
 class VISP_EXPORT vpMomentDatabase{
  private:
@@ -130,9 +133,20 @@ class VISP_EXPORT vpMomentDatabase{
         };
 #endif
         std::map<const char*,vpMoment*,cmp_str> moments;
+        //! Moments in the order they were linked to the database.
+        std::vector<vpMoment*> linkedMoments;
+        //! Moments sorted according to their dependencies.
+        std::vector<vpMoment*> computeOrder;
+        //! Incremented each time a moment is linked to the database.
+        unsigned int revision;
+        //! Revision of the database for which computeOrder was computed.
+        unsigned int computeOrderRevision;
+
         void add(vpMoment& moment, const char* name);
+        const vpMoment* find(const char* type) const;
+        void sortMoments();
  public:
-        vpMomentDatabase() : moments() {}
+        vpMomentDatabase() : moments(), linkedMoments(), computeOrder(), revision(1), computeOrderRevision(0) {}
         virtual ~vpMomentDatabase() {}
 
         /** @name Inherited functionalities from vpMomentDatabase */
@@ -144,8 +158,16 @@ class VISP_EXPORT vpMomentDatabase{
           \return the first element in the database.
           */
         vpMoment& get_first(){return *(moments.begin()->second);}
+        /*!
+          Get the revision of the database, incremented each time a moment is linked to it.
+          Pointers to the moments of the database resolved for a given revision remain valid
+          while the revision is unchanged.
+          \return the revision of the database.
+          */
+        unsigned int getRevision() const {return revision;}
 
         virtual void updateAll(vpMomentObject& object);
+        void computeAll();
         //@}
 
         friend class vpMoment;
@@ -49,9 +49,12 @@
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
 #  include <unistd.h> 
 #  include <sys/socket.h>
+#  include <sys/uio.h>
 #  include <netinet/in.h>
+#  include <netinet/tcp.h>
 #  include <arpa/inet.h>
 #  include <netdb.h>
+#  include <poll.h>
 #else
 #  include<io.h>
 //#  include<winsock.h>
@@ -73,6 +76,18 @@
   TCP provides reliable, ordered delivery of a stream of bytes from a program 
   on one computer to another program on another computer.
   
+  The requests are sent as binary frames: the size of the rest of the frame,
+  the size of the request id, the id, the number of parameters, then the size
+  and the bytes of each parameter, the sizes being 32 bits integers in network
+  byte order. The parameters can thus contain any byte. A request is sent with
+  a single system call gathering the frame header and the parameters of the
+  vpRequest, without copying them in a message. Each receptor has its own
+  receive buffer, allocated with the first request received and reused
+  afterwards, in which the frames are decoded in place. The sockets are
+  watched with poll() (select() on Windows). A receptor announcing a frame
+  larger than setMaxSizeReceivedFrame() is disconnected, so that a corrupted
+  size can not make its receive buffer grow up to 4 GB.
+  
   \warning This class shouldn't be used directly. You better use vpClient and
   vpServer to simulate your network. Some exemples are provided in these classes.
 
@@ -93,8 +108,13 @@ protected:
 #endif
     struct sockaddr_in    receptorAddress;
     std::string           receptorIP;
+    // Bytes received in request mode, the ones not decoded yet being in [receiveStart, receiveEnd)
+    std::vector<char>     receiveBuffer;
+    size_t                receiveStart;
+    size_t                receiveEnd;
 
-    vpReceptor() : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP() {}
+    vpReceptor() : socketFileDescriptorReceptor(0), receptorAddressSize(), receptorAddress(), receptorIP(),
+      receiveBuffer(), receiveStart(0), receiveEnd(0) {}
   };
   
   struct vpEmitter{
@@ -120,39 +140,55 @@ protected:
   
   vpEmitter               emitter;
   std::vector<vpReceptor> receptor_list;
-  fd_set                  readFileDescriptor;
+  
+  //Sockets ready to be read after _waitForSockets()
+  std::vector<unsigned int> readableReceptors;
+  bool                    emitterReadable;
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-  int                     socketMax;
-#else
-  SOCKET                  socketMax;
+  std::vector<struct pollfd> pollFileDescriptors;
 #endif
   
   //Message Handling 
   std::vector<vpRequest*> request_list;
   
   unsigned int            max_size_message;
-  std::string             separator;
-  std::string             beginning;
-  std::string             end;
-  std::string             param_sep;
+  unsigned int            max_size_frame;
   
-  std::string             currentMessageReceived;
+  //Frame of the request being sent: header with the sizes of the parameters, and buffers gathered by the send
+  std::vector<char>       sendHeader;
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  std::vector<struct iovec> sendBuffers;
+#else
+  std::vector<WSABUF>     sendBuffers;
+#endif
     
-  struct timeval          tv;
   long                    tv_sec;
   long                    tv_usec;
   
   bool                    verboseMode;
   
+  void              _removeReceptor(const unsigned int &receptorIndex);
+  int               _waitForSockets(const int &receptorIndex, const bool &withEmitter, const bool &useTimeout = true);
+  
 private:
   
+  //Requests received from disconnected receptors and not handled yet
+  vpReceptor        disconnectedRequests;
+  //Location and size of the parameters of the request being decoded
+  std::vector<const char *> receivedParameters;
+  std::vector<size_t> receivedParameterSizes;
+  
+  int               _decodeFrame(const char *frame, const size_t &frameSize);
   std::vector<int>  _handleRequests();
   int               _handleFirstRequest();
+  int               _handleFirstRequestFrom(vpReceptor &receptor);
   
+  int               _readReceptor(const unsigned int &receptorIndex);
   void              _receiveRequest();
   void              _receiveRequestFrom(const unsigned int &receptorEmitting);
-  int               _receiveRequestOnce();
-  int               _receiveRequestOnceFrom(const unsigned int &receptorEmitting);
+  int               _receiveRequestOnce(const bool &useTimeout = true);
+  int               _receiveRequestOnceFrom(const unsigned int &receptorEmitting, const bool &useTimeout = true);
+  int               _sendBuffers(const unsigned int &dest);
   
 public:
 
@@ -177,12 +213,21 @@ public:
                     }
   
   /*!
-    Get the maximum size that the emitter can receive (in request mode).
+    Get the initial size of the receive buffer of each receptor (in request mode).
     
     \sa vpNetwork::setMaxSizeReceivedMessage()
 
     \return Acutal max size value.
   */
+  /*!
+    Get the maximum size of a frame received in request mode.
+
+    \sa vpNetwork::setMaxSizeReceivedFrame()
+
+    \return Actual max size value.
+  */
+  unsigned int      getMaxSizeReceivedFrame(){ return max_size_frame; }
+
   unsigned int      getMaxSizeReceivedMessage(){ return max_size_message; }
   
   void      print(const char *id = "");
@@ -216,12 +261,25 @@ public:
   int               sendAndEncodeRequestTo(vpRequest &req, const unsigned int &dest);
   
   /*!
-    Change the maximum size that the emitter can receive (in request mode).
+    Change the initial size of the receive buffer of each receptor (in request mode).
+    The buffer of a receptor grows when it receives a larger request.
     
     \sa vpNetwork::getMaxSizeReceivedMessage()
 
     \param s : new maximum size value.
   */
+  /*!
+    Change the maximum size of a frame received in request mode, 128 MB by default.
+    A receptor that announces a larger frame is disconnected, the frames it sent
+    before being kept. It must be larger than the largest request sent, plus 8 bytes,
+    the size of its id and 4 bytes per parameter.
+
+    \sa vpNetwork::getMaxSizeReceivedFrame()
+
+    \param s : new maximum size value.
+  */
+  void              setMaxSizeReceivedFrame(const unsigned int &s){ max_size_frame = s;}
+
   void              setMaxSizeReceivedMessage(const unsigned int &s){ max_size_message = s;}
   
   /*!
@@ -285,25 +343,7 @@ int vpNetwork::receive(T* object, const unsigned int &sizeOfObject)
     return -1;
   }
   
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
-#else
-  tv.tv_usec = tv_usec;
-#endif
-  
-  FD_ZERO(&readFileDescriptor);        
-  
-  for(unsigned int i=0; i<receptor_list.size(); i++){
-    FD_SET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
-
-    if(i == 0)
-      socketMax = receptor_list[i].socketFileDescriptorReceptor;
-   
-    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor; 
-  }
-
-  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  int value = _waitForSockets(-1, false);
   int numbytes = 0;
   
   if(value == -1){
@@ -316,22 +356,17 @@ int vpNetwork::receive(T* object, const unsigned int &sizeOfObject)
     return 0;
   }
   else{
-    for(unsigned int i=0; i<receptor_list.size(); i++){
-      if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor)){
+    unsigned int i = readableReceptors[0];
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-        numbytes = recv(receptor_list[i].socketFileDescriptorReceptor, (char*)(void*)object, sizeOfObject, 0);
+    numbytes = (int)recv(receptor_list[i].socketFileDescriptorReceptor, (char*)(void*)object, sizeOfObject, 0);
 #else
-        numbytes = recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, (char*)(void*)object, (int)sizeOfObject, 0);
+    numbytes = recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, (char*)(void*)object, (int)sizeOfObject, 0);
 #endif
-        if(numbytes <= 0)
-        {
-          std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
-          receptor_list.erase(receptor_list.begin()+(int)i);
-          return numbytes;
-        }
-        
-        break;
-      }
+    if(numbytes <= 0)
+    {
+      std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
+      receptor_list.erase(receptor_list.begin()+(int)i);
+      return numbytes;
     }
   }
   
@@ -369,19 +404,7 @@ int vpNetwork::receiveFrom(T* object, const unsigned int &receptorEmitting, cons
     return -1;
   }
   
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
-#else
-  tv.tv_usec = tv_usec;
-#endif
-
-  FD_ZERO(&readFileDescriptor);
-  
-  socketMax = receptor_list[receptorEmitting].socketFileDescriptorReceptor;
-  FD_SET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor);
-    
-  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  int value = _waitForSockets((int)receptorEmitting, false);
   int numbytes = 0;
   
   if(value == -1){
@@ -394,9 +417,9 @@ int vpNetwork::receiveFrom(T* object, const unsigned int &receptorEmitting, cons
     return 0;
   }
   else{
-    if(FD_ISSET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor)){
+    {
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-      numbytes = recv(receptor_list[receptorEmitting].socketFileDescriptorReceptor, (char*)(void*)object, sizeOfObject, 0);
+      numbytes = (int)recv(receptor_list[receptorEmitting].socketFileDescriptorReceptor, (char*)(void*)object, sizeOfObject, 0);
 #else
       numbytes = recv((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor, (char*)(void*)object, (int)sizeOfObject, 0);
 #endif
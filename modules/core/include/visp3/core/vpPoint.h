@@ -55,6 +55,24 @@ class vpHomogeneousMatrix;
   \class vpPoint
   \ingroup group_core_geometry
   \brief Class that defines what is a point.
+
+  To project many points with the same pose, projectPoints() transforms and
+  projects arrays of coordinates at once, without the per point vpColVector
+  updates of track(). The pixel coordinates are then obtained with
+  vpMeterPixelConversion::convertPoints():
+  \code
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPoint.h>
+
+void projectModel(const vpHomogeneousMatrix &cMo, const vpCameraParameters &cam,
+                  const std::vector<double> &oX, const std::vector<double> &oY, const std::vector<double> &oZ,
+                  std::vector<double> &u, std::vector<double> &v)
+{
+  std::vector<double> x, y;
+  vpPoint::projectPoints(cMo, oX, oY, oZ, x, y);
+  vpMeterPixelConversion::convertPoints(cam, x, y, u, v);
+}
+  \endcode
 */
 class VISP_EXPORT vpPoint : public vpForwardProjection
 {
@@ -119,6 +137,12 @@ public:
 
   void projection();
 
+  static void projectPoints(const vpHomogeneousMatrix &cMo, const double *oX, const double *oY, const double *oZ,
+                            unsigned int n, double *x, double *y, double *Z=NULL);
+  static void projectPoints(const vpHomogeneousMatrix &cMo, const std::vector<double> &oX,
+                            const std::vector<double> &oY, const std::vector<double> &oZ,
+                            std::vector<double> &x, std::vector<double> &y);
+
   // Set coordinates
   void set_X(const double X);
   void set_Y(const double Y);
@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trial scheduling shared by the workers of a parallel RANSAC.
+ *
+ *****************************************************************************/
+
+#ifndef __vpRansacScheduler_h__
+#define __vpRansacScheduler_h__
+
+/*!
+  \file vpRansacScheduler.h
+
+  \brief Trial scheduling shared by the workers of a parallel RANSAC.
+*/
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  include <visp3/core/vpMutex.h>
+#  define VP_RANSAC_SCHEDULER_MUTEX
+#endif
+
+/*!
+  \class vpRansacScheduler
+
+  \ingroup group_core_robust
+
+  \brief Hands out the trials of a RANSAC to one or several workers, keeps
+  the size of the best consensus set and decides when the sampling is over.
+
+  The sampling stops when:
+  - the number of trials needed to draw at least one outlier free sample of
+    \e sampleSize points with the given probability is reached. This number
+    starts at \e maxTrials and is lowered, as given by computeNbTrials(), each
+    time a larger consensus set is reported with update();
+  - a consensus set of \e nbInlierConsensus points is reported;
+  - the time budget is exceeded.
+
+  The scheduler is shared by the workers, typically run with
+  vpThreadPool::parallelFor(), each one drawing its own samples:
+  \code
+#include <visp3/core/vpRansacScheduler.h>
+
+void worker(vpRansacScheduler &scheduler)
+{
+  while (scheduler.nextTrial()) {
+    // Draw a minimal sample, compute the hypotheses and their consensus sets
+    unsigned int nbInliers = ...;
+    scheduler.update(nbInliers);
+  }
+}
+  \endcode
+
+  It is used by vpPose::computePose() with the vpPose::RANSAC method and by
+  vpHomography::ransac().
+*/
+class VISP_EXPORT vpRansacScheduler
+{
+public:
+  vpRansacScheduler(const int maxTrials, const double probability, const double timeBudget,
+                    const unsigned int nbPoints, const unsigned int nbInlierConsensus,
+                    const unsigned int sampleSize);
+  virtual ~vpRansacScheduler() {}
+
+  static int computeNbTrials(double probability, double epsilon, const int sampleSize, int maxTrials);
+
+  unsigned int getBestNbInliers();
+  int getNbTrials();
+
+  bool nextTrial();
+  void update(const unsigned int nbInliers);
+
+private:
+  // The scheduler is shared by the workers, not copied
+  vpRansacScheduler(const vpRansacScheduler &);
+  vpRansacScheduler &operator=(const vpRansacScheduler &);
+
+  void lock();
+  void unlock();
+
+  //! Size of the largest consensus set reported.
+  unsigned int m_bestNbInliers;
+  //! Upper bound on the number of trials.
+  int m_maxTrials;
+  //! Size of a consensus set that stops the sampling.
+  unsigned int m_nbInlierConsensus;
+  //! Number of points.
+  unsigned int m_nbPoints;
+  //! Number of trials handed out.
+  int m_nbTrials;
+  //! Probability to draw at least one outlier free sample.
+  double m_probability;
+  //! Number of trials needed for the current best consensus set.
+  int m_requiredTrials;
+  //! Number of points of a minimal sample.
+  unsigned int m_sampleSize;
+  //! Time when the scheduler was created, in ms.
+  double m_startTime;
+  //! True when the sampling is over.
+  bool m_stop;
+  //! Time budget in ms, no limit if not strictly positive.
+  double m_timeBudget;
+#if defined(VP_RANSAC_SCHEDULER_MUTEX)
+  vpMutex m_mutex;
+#endif
+};
+
+#endif
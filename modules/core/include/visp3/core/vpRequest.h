@@ -44,6 +44,7 @@
 #include <visp3/core/vpImageException.h>
 
 #include <string.h>
+#include <utility>
 #include <vector>
 
 /*!
@@ -58,24 +59,24 @@
   Second parameter : Width of the image.
   Thirs parameter : Bitmap of the image (not compress).
   
-  Here is the header of the vpRequestImage class.
+  Here is the header of the vpRequestMyImage class.
   
   \code
-#ifndef vpRequestImage_H
-#define vpRequestImage_H
+#ifndef vpRequestMyImage_H
+#define vpRequestMyImage_H
 
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpRequest.h>
 
-class vpRequestImage : public vpRequest
+class vpRequestMyImage : public vpRequest
 {
 private:
   vpImage<unsigned char> *I;
   
 public:
-  vpRequestImage();
-  vpRequestImage(vpImage<unsigned char> *);
-  ~vpRequestImage();
+  vpRequestMyImage();
+  vpRequestMyImage(vpImage<unsigned char> *);
+  ~vpRequestMyImage();
   
   virtual void encode();
   virtual void decode();
@@ -84,23 +85,23 @@ public:
 #endif
   \endcode
   
-  Here is the definition of the vpRequestImage class.
+  Here is the definition of the vpRequestMyImage class.
   
   \code
-#include <vpRequestImage.h>
+#include <vpRequestMyImage.h>
 
-vpRequestImage::vpRequestImage(){
+vpRequestMyImage::vpRequestMyImage(){
   request_id = "image";
 }
 
-vpRequestImage::vpRequestImage(vpImage<unsigned char> *Im){
+vpRequestMyImage::vpRequestMyImage(vpImage<unsigned char> *Im){
   request_id = "image";
   I = Im;
 }
 
-vpRequestImage::~vpRequestImage(){}
+vpRequestMyImage::~vpRequestMyImage(){}
 
-void vpRequestImage::encode(){
+void vpRequestMyImage::encode(){
   clear(); 
   
   unsigned int h = I->getHeight();
@@ -111,7 +112,7 @@ void vpRequestImage::encode(){
   addParameterObject(I->bitmap,h*w*sizeof(unsigned char));
 }
   
-void vpRequestImage::decode(){
+void vpRequestMyImage::decode(){
   if(listOfParams.size() == 3){
     unsigned int w, h;
     memcpy((void*)&h, (void*)listOfParams[0].c_str(), sizeof(unsigned int));
@@ -123,15 +124,29 @@ void vpRequestImage::decode(){
 }
   \endcode
   
+  Parameters added with addParameterBuffer() are sent from the memory of the caller,
+  without being copied, and a request can override receiveParameters() to decode the
+  received parameters in place. vpRequestImage and vpRequestMatrix use them to stream
+  images and matrices.
+  
+  \sa vpRequestImage
+  \sa vpRequestMatrix
   \sa vpClient
   \sa vpServer
   \sa vpNetwork
 */
 class VISP_EXPORT vpRequest
 {
+  // Sends the parameters and sets the received ones without copying them
+  friend class vpNetwork;
+  
 protected:
   std::string               request_id;
   std::vector<std::string>  listOfParams;
+  //Parameters sent from the memory of the caller, after the ones of listOfParams
+  std::vector<std::pair<const char *, size_t> > listOfBuffers;
+  
+  virtual bool  receiveParameters(const std::vector<const char *> &params, const std::vector<size_t> &sizes);
   
 public:
                 vpRequest();
@@ -140,6 +155,7 @@ public:
   void          addParameter(char *params);
   void          addParameter(std::string &params);
   void          addParameter(std::vector<std::string> &listOfparams);
+  void          addParameterBuffer(const void *data, const size_t &size);
   template<typename T>
   void          addParameterObject(T * params, const int &sizeOfObject = sizeof(T));
   
@@ -153,7 +169,7 @@ public:
   /*!
     Clear the parameters of the request.
   */
-  void          clear(){ listOfParams.clear(); }
+  void          clear(){ listOfParams.clear(); listOfBuffers.clear(); }
   
   /*!
     Encode the parameters of the request (Funtion that has to be redifined).
@@ -195,7 +211,7 @@ public:
   void          setId(const char *id){ request_id = id; }
   
   /*!
-    Get the number of parameters.
+    Get the number of parameters, without the ones added with addParameterBuffer().
     
     \return Number of parameters.
   */
@@ -0,0 +1,202 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Request sending an image without copying it.
+ *
+ *****************************************************************************/
+
+#ifndef vpRequestImage_H
+#define vpRequestImage_H
+
+/*!
+  \file vpRequestImage.h
+
+  \brief Request sending an image without copying it.
+*/
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRequest.h>
+#include <visp3/core/vpSharedMemory.h>
+
+/*!
+  \class vpRequestImage
+
+  \ingroup group_core_network
+
+  \brief Request streaming an image between a vpClient and a vpServer.
+
+  The bitmap of the image is sent from the image itself, without being copied
+  in the parameters of the request, and the received bitmap is copied directly
+  from the receive buffer of vpNetwork in the image of the receiving request. The
+  image keeps its memory as long as its size doesn't change, and decode() has
+  nothing to do: the image is updated when the request is received.
+
+  When the client and the server are on the same host, setSharedMemory() lets
+  the sender write the bitmap in a vpSharedMemory whose name is sent instead of
+  the bitmap. The receiving request reads the bitmap from this memory, and may
+  then get the last image written by the sender if several requests are pending.
+
+  The image size is sent with the byte order of the sender: both sides are
+  expected to run on the same architecture.
+
+  \code
+#include <visp3/core/vpRequestImage.h>
+#include <visp3/core/vpServer.h>
+
+int main()
+{
+  vpServer server(35000);
+  vpImage<unsigned char> I;
+  vpRequestImage<unsigned char> request(I);
+  server.addDecodingRequest(&request);
+  server.start();
+
+  while (true) {
+    server.checkForConnections();
+    if (server.receiveRequestOnce() != -1) {
+      // ... use I
+    }
+  }
+}
+  \endcode
+
+  On the client side, the image is sent with vpNetwork::sendAndEncodeRequest().
+*/
+template<class Type>
+class vpRequestImage : public vpRequest
+{
+public:
+  /*!
+    Create a request sending or receiving an image.
+
+    \param I : Image sent or received, that must remain valid while the request is used.
+    \param id : Id of the request.
+  */
+  explicit vpRequestImage(vpImage<Type> &I, const std::string &id = "image")
+    : vpRequest(), m_I(I), m_sharedMemoryName(), m_sharedMemory(), m_sentName()
+  {
+    request_id = id;
+    m_header[0] = m_header[1] = m_header[2] = m_header[3] = 0;
+  }
+  virtual ~vpRequestImage() {}
+
+  /*!
+    Nothing to do: the image is updated when the request is received.
+  */
+  virtual void decode() {}
+
+  /*!
+    Set the parameters of the request: the size of the image, then its bitmap
+    or the name of the shared memory in which it has been written.
+    The image must not be modified before the request is sent.
+  */
+  virtual void encode()
+  {
+    clear();
+    size_t size = (size_t) m_I.getWidth() * m_I.getHeight() * sizeof(Type);
+    m_header[0] = m_I.getWidth();
+    m_header[1] = m_I.getHeight();
+    m_header[2] = (unsigned int) sizeof(Type);
+    m_header[3] = m_sharedMemoryName.empty() ? 0 : 1;
+    addParameterBuffer(m_header, sizeof(m_header));
+
+    if (m_sharedMemoryName.empty()) {
+      addParameterBuffer(m_I.bitmap, size);
+    }
+    else {
+      m_sharedMemory.create(m_sharedMemoryName, size);
+      m_sharedMemory.write(m_I.bitmap, size);
+      m_sentName = m_sharedMemory.getName();
+      addParameterBuffer(m_sentName.c_str(), m_sentName.size());
+    }
+  }
+
+  /*!
+    Send the images through a memory shared with the receiver instead of the
+    network. Both must be on the same host.
+
+    \param name : Name of the memory, an empty name to send the images through the network.
+  */
+  void setSharedMemory(const std::string &name)
+  {
+    m_sharedMemoryName = name;
+    if (name.empty())
+      m_sharedMemory.close();
+  }
+
+protected:
+  /*!
+    Copy the received bitmap in the image.
+  */
+  virtual bool receiveParameters(const std::vector<const char *> &params, const std::vector<size_t> &sizes)
+  {
+    unsigned int header[4];
+    if (params.size() != 2 || sizes[0] != sizeof(header))
+      return false;
+    memcpy(header, params[0], sizeof(header));
+    if (header[2] != sizeof(Type))
+      return false;
+
+    size_t size = (size_t) header[0] * header[1] * sizeof(Type);
+    if (header[3] == 0) {
+      if (sizes[1] != size)
+        return false;
+      if (m_I.getWidth() != header[0] || m_I.getHeight() != header[1])
+        m_I.resize(header[1], header[0]);
+      if (size != 0)
+        memcpy((void *) m_I.bitmap, params[1], size);
+      return true;
+    }
+
+    try {
+      std::string name(params[1], sizes[1]);
+      if (!m_sharedMemory.isOpen() || m_sharedMemory.getName() != name)
+        m_sharedMemory.open(name);
+    }
+    catch(const vpException &) {
+      return false;
+    }
+    if (m_I.getWidth() != header[0] || m_I.getHeight() != header[1])
+      m_I.resize(header[1], header[0]);
+    return m_sharedMemory.read(m_I.bitmap, size);
+  }
+
+private:
+  vpImage<Type> &m_I;
+  //! Width, height, size of a pixel and transport (0: network, 1: shared memory).
+  unsigned int m_header[4];
+  std::string m_sharedMemoryName;
+  vpSharedMemory m_sharedMemory;
+  //! Name of the shared memory sent with the request.
+  std::string m_sentName;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Request sending a matrix without copying it.
+ *
+ *****************************************************************************/
+
+#ifndef vpRequestMatrix_H
+#define vpRequestMatrix_H
+
+/*!
+  \file vpRequestMatrix.h
+
+  \brief Request sending a matrix without copying it.
+*/
+
+#include <visp3/core/vpArray2D.h>
+#include <visp3/core/vpRequest.h>
+
+/*!
+  \class vpRequestMatrix
+
+  \ingroup group_core_network
+
+  \brief Request streaming a matrix, a vector or a pose between a vpClient and
+  a vpServer.
+
+  \e Type is a class derived from vpArray2D, such as vpMatrix, vpColVector or
+  vpHomogeneousMatrix. As with vpRequestImage, the elements are sent from the
+  matrix itself and the received ones are copied directly in the matrix of the
+  receiving request, that is resized only if its size differs from the received
+  one. A matrix that can't be resized, such as a vpHomogeneousMatrix, doesn't
+  handle the requests of a different size.
+
+  The elements and the size are sent with the byte order of the sender: both
+  sides are expected to run on the same architecture.
+
+  \code
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpRequestMatrix.h>
+
+int main()
+{
+  vpClient client;
+  client.connectToHostname("localhost", 35000);
+
+  vpHomogeneousMatrix cMo;
+  vpRequestMatrix<vpHomogeneousMatrix> request(cMo, "pose");
+  while (true) {
+    // ... update cMo
+    client.sendAndEncodeRequest(request);
+  }
+}
+  \endcode
+*/
+template<class Type>
+class vpRequestMatrix : public vpRequest
+{
+public:
+  /*!
+    Create a request sending or receiving a matrix.
+
+    \param M : Matrix sent or received, that must remain valid while the request is used.
+    \param id : Id of the request.
+  */
+  explicit vpRequestMatrix(Type &M, const std::string &id = "matrix")
+    : vpRequest(), m_M(M)
+  {
+    request_id = id;
+    m_header[0] = m_header[1] = m_header[2] = 0;
+  }
+  virtual ~vpRequestMatrix() {}
+
+  /*!
+    Nothing to do: the matrix is updated when the request is received.
+  */
+  virtual void decode() {}
+
+  /*!
+    Set the parameters of the request: the size of the matrix then its elements.
+    The matrix must not be modified before the request is sent.
+  */
+  virtual void encode()
+  {
+    clear();
+    m_header[0] = m_M.getRows();
+    m_header[1] = m_M.getCols();
+    m_header[2] = (unsigned int) sizeof(*m_M.data);
+    addParameterBuffer(m_header, sizeof(m_header));
+    addParameterBuffer(m_M.data, (size_t) m_M.getRows() * m_M.getCols() * sizeof(*m_M.data));
+  }
+
+protected:
+  /*!
+    Copy the received elements in the matrix.
+  */
+  virtual bool receiveParameters(const std::vector<const char *> &params, const std::vector<size_t> &sizes)
+  {
+    unsigned int header[3];
+    if (params.size() != 2 || sizes[0] != sizeof(header))
+      return false;
+    memcpy(header, params[0], sizeof(header));
+    size_t size = (size_t) header[0] * header[1] * sizeof(*m_M.data);
+    if (header[2] != sizeof(*m_M.data) || sizes[1] != size)
+      return false;
+
+    if (m_M.getRows() != header[0] || m_M.getCols() != header[1]) {
+      try {
+        m_M.resize(header[0], header[1], false);
+      }
+      catch(const vpException &) {
+        return false;
+      }
+    }
+    if (size != 0)
+      memcpy(m_M.data, params[1], size);
+    return true;
+  }
+
+private:
+  Type &m_M;
+  //! Number of rows, number of columns and size of an element.
+  unsigned int m_header[3];
+};
+
+#endif
@@ -49,6 +49,8 @@
 #include <visp3/core/vpColVector.h>
 #include <visp3/core/vpMath.h>
 
+#include <vector>
+
 
 /*!
   \class vpRobust
@@ -56,6 +58,12 @@
   \brief Contains an M-Estimator and various influence function.
 
   Supported methods: M-estimation, Tukey, Cauchy and Huber
+
+  The scratch vectors used to compute the medians are kept between two calls
+  to MEstimator(), so that no memory is allocated as long as the number of
+  residues does not change. For very large residue vectors (dense or
+  photometric approaches), the medians can be approximated with histograms,
+  see setMedianApproximation().
 */
 class VISP_EXPORT vpRobust
 {
@@ -78,6 +86,12 @@ private:
   vpColVector sorted_normres;
   //!Sorted residues
   vpColVector sorted_residues;
+  //!Normalized residues of all the data, used when the median is computed on a subset
+  vpColVector normres_all;
+  //!Minimal number of residues to approximate the medians with histograms, 0 if disabled
+  unsigned int medianApproxMinSize;
+  //!Histogram used to approximate the medians
+  std::vector<unsigned int> medianHistogram;
 
   //!Noise threshold
   double NoiseThreshold;
@@ -130,6 +144,19 @@ public:
     NoiseThreshold=noise_threshold;
   }
 
+  /*!
+    Approximate the median and the median absolute deviation with two
+    successive histograms instead of an exact selection when the number of
+    residues is at least \e min_size. The approximation error is lower than
+    the range of the residues divided by \f$ 2^{20} \f$.
+
+    \param min_size : Minimal number of residues to use the approximation, or
+    0 to always compute the exact median (default).
+  */
+  inline void setMedianApproximation(const unsigned int min_size) {
+    medianApproxMinSize = min_size;
+  }
+
   //! Simult Mestimator
   vpColVector simultMEstimator(vpColVector &residues);
 
@@ -210,6 +237,10 @@ public:
   int partition(vpColVector &a, int l, int r);
   //! Sort the vector and select a value in the sorted vector
   double select(vpColVector &a, int l, int r, int k);
+  //! Select the median of n values, reordering them
+  double selectMedian(double *a, unsigned int n);
+  //! Approximate the k-th smallest of n values with histograms
+  double selectApprox(const double *a, unsigned int n, unsigned int k);
   //@}
 };
 
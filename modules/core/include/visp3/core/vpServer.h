@@ -101,7 +101,7 @@ int main(int argc,const char** argv)
 #include <visp3/gui/vpDisplayX.h>
 #include <visp3/gui/vpDisplayGDI.h>
 
-#include "vpRequestImage.h" //See vpRequest class documentation
+#include <visp3/core/vpRequestImage.h>
 
 int main(int argc,const char** argv)
 {
@@ -119,7 +119,7 @@ int main(int argc,const char** argv)
 
   vpImage<unsigned char> I;
   
-  vpRequestImage reqImage(&I);
+  vpRequestImage<unsigned char> reqImage(I);
   serv.addDecodingRequest(&reqImage);
   
   bool run = true;
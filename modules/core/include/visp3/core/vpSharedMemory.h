@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Memory shared between processes.
+ *
+ *****************************************************************************/
+
+#ifndef __vpSharedMemory_h__
+#define __vpSharedMemory_h__
+
+/*!
+  \file vpSharedMemory.h
+
+  \brief Memory shared between processes.
+*/
+
+#include <string>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpSharedMemory
+
+  \ingroup group_core_network
+
+  \brief Named memory shared between the processes of a same host, in which
+  one process writes data that the other ones read.
+
+  The writer creates the memory with create() and writes data with write().
+  The readers open the memory from its name with open() and get a copy of the
+  last data written with read(). A sequence number updated by the writer lets
+  the readers detect data that were being written while they were read: these
+  reads are retried, without locking the writer.
+
+  When the writer needs more memory, create() makes a new memory whose name,
+  returned by getName(), is the requested name with a suffix. The readers have
+  to open it with this name, that can be sent with the data (see vpRequestImage).
+
+  On Unix systems the memory is created with shm_open(), on Windows with
+  CreateFileMapping(). The memory is released when the writer closes it.
+
+  \code
+#include <visp3/core/vpSharedMemory.h>
+
+int main()
+{
+  double data[6] = { 0, 0, 1, 0, 0, 0 };
+  vpSharedMemory writer;
+  writer.create("pose", sizeof(data));
+  writer.write(data, sizeof(data));
+
+  // In another process
+  vpSharedMemory reader;
+  reader.open("pose");
+  if (reader.read(data, sizeof(data))) {
+    // ... use data
+  }
+}
+  \endcode
+*/
+class VISP_EXPORT vpSharedMemory
+{
+public:
+  vpSharedMemory();
+  virtual ~vpSharedMemory();
+
+  void close();
+  void create(const std::string &name, const size_t &size);
+
+  /*!
+    \return The size of the data that can be written.
+  */
+  inline size_t getSize() const { return m_size; }
+  /*!
+    \return The name of the memory, to be given to open().
+  */
+  inline std::string getName() const { return m_name; }
+  /*!
+    \return true if a memory is created or open.
+  */
+  inline bool isOpen() const { return m_memory != NULL; }
+
+  void open(const std::string &name);
+  bool read(void *data, const size_t &size);
+  void write(const void *data, const size_t &size);
+
+private:
+  // The memory can not be shared between two objects
+  vpSharedMemory(const vpSharedMemory &);
+  vpSharedMemory &operator=(const vpSharedMemory &);
+
+  void map(const std::string &name, const size_t &size, const bool &create);
+
+  //! Name of the memory.
+  std::string m_name;
+  //! Name given to create(), without the suffix.
+  std::string m_baseName;
+  //! Number of memories created with m_baseName.
+  unsigned int m_generation;
+  //! Mapped memory: a header followed by the data.
+  unsigned char *m_memory;
+  //! Size of the data that can be written.
+  size_t m_size;
+  //! True if the memory has been created by this object.
+  bool m_isWriter;
+#if defined(_WIN32)
+  //! Handle of the file mapping.
+  void *m_mapping;
+#endif
+};
+
+#endif
@@ -0,0 +1,149 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of threads.
+ *
+ *****************************************************************************/
+
+#ifndef __vpThreadPool_h_
+#define __vpThreadPool_h_
+
+/*!
+  \file vpThreadPool.h
+
+  \brief Process-wide pool of threads used by the parallel algorithms of ViSP.
+*/
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpParallelLoopBody
+
+  \ingroup group_core_threading
+
+  \brief Body of a loop executed by vpThreadPool::parallelFor().
+
+  The body is called with sub-ranges of the loop indexes, possibly from
+  several threads at the same time. operator() is const: the body should
+  only write to data that depends on the indexes of the sub-range.
+*/
+class VISP_EXPORT vpParallelLoopBody
+{
+public:
+  virtual ~vpParallelLoopBody() {}
+
+  /*!
+    Process the indexes in [\e start, \e end).
+  */
+  virtual void operator()(unsigned int start, unsigned int end) const = 0;
+};
+
+/*!
+  \class vpThreadPool
+
+  \ingroup group_core_threading
+
+  \brief Process-wide pool of persistent threads with a parallel for loop.
+
+  Creating and joining threads at each call of a parallel algorithm costs
+  more than processing a 640x480 image. The threads of the pool are created
+  on the first parallel loop that needs them and then wait for the next loop.
+
+  parallelFor() splits the index range in as many contiguous parts as there
+  are threads taking part in the loop, the calling thread included. Each
+  thread processes its part by chunks of \e grainSize indexes and, when it
+  is done, steals the second half of the remaining indexes of the most
+  loaded thread, so that an unbalanced workload does not leave threads idle.
+
+  The number of threads used by default is set with setConcurrency() and
+  defaults to the number of cores.
+
+  The pool runs one loop at a time. A parallelFor() called from the body of
+  another parallelFor(), or while another thread is already using the pool,
+  is executed serially by the calling thread. Only the outermost loop of
+  nested parallel code is therefore split between threads: when an
+  algorithm parallelizes both an outer loop over views or images and an
+  inner loop over pixels or points, the inner loops run serially on the
+  thread that processes each outer index. Two threads of the application
+  calling parallelFor() at the same time do not share the pool either: the
+  second one runs its loop alone.
+
+  The pool is created on the first parallelFor() that needs more than one
+  thread. Its threads are never joined at exit; call shutdown() before
+  unloading ViSP dynamically.
+
+  \code
+#include <visp3/core/vpThreadPool.h>
+
+class Scale : public vpParallelLoopBody
+{
+public:
+  Scale(double *data, double scale) : m_data(data), m_scale(scale) {}
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++)
+      m_data[i] *= m_scale;
+  }
+
+private:
+  double *m_data;
+  double m_scale;
+};
+
+int main()
+{
+  std::vector<double> data(100000, 1.0);
+  vpThreadPool::parallelFor(0, (unsigned int) data.size(), Scale(&data[0], 2.0));
+}
+  \endcode
+
+  When neither pthread nor the Windows threads are available, the loop is
+  executed by the calling thread.
+*/
+class VISP_EXPORT vpThreadPool
+{
+public:
+  /*!
+    Number of threads to give to the functions that otherwise run serially
+    when no number of threads is given, like vpImage::performLut() or
+    vpHistogram::calculate(), to use getConcurrency() threads of the pool.
+  */
+  static const unsigned int poolConcurrency;
+
+  static unsigned int getConcurrency();
+  static unsigned int getNumberOfCores();
+
+  static void parallelFor(unsigned int start, unsigned int end, const vpParallelLoopBody &body,
+                          unsigned int nbThreads=0, unsigned int grainSize=0);
+
+  static void setConcurrency(unsigned int nbThreads);
+  static void shutdown();
+};
+
+#endif
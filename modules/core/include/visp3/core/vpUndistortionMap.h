@@ -0,0 +1,138 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Precomputed undistortion map.
+ *
+ *****************************************************************************/
+
+#ifndef vpUndistortionMap_H
+#define vpUndistortionMap_H
+
+/*!
+  \file vpUndistortionMap.h
+
+  \brief Precomputed look-up table used to undistort images.
+*/
+
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpRGBa.h>
+
+/*!
+  \class vpUndistortionMap
+
+  \ingroup group_core_image
+
+  \brief Look-up table that stores, for each pixel of an undistorted image,
+  the location of the corresponding pixel in the distorted image.
+
+  vpImageTools::undistort(const vpImage<Type> &, const vpCameraParameters &, vpImage<Type> &)
+  evaluates the distortion model for each pixel of each image. When the
+  intrinsic parameters of the camera are constant, the model can be
+  evaluated once: the map is built from the camera parameters and the image
+  size, and then undistorting an image is only a gather of four neighbour
+  pixels followed by a bilinear interpolation.
+
+  For each pixel, the map stores the offset in the distorted image of the
+  top-left neighbour and the four bilinear weights in fixed-point arithmetic,
+  the sub-pixel position being quantized to 1/128 pixel. Destination pixels
+  whose source is outside the image are set to 0, as
+  vpImageTools::undistort() does.
+
+  \code
+#include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpUndistortionMap.h>
+
+int main()
+{
+  vpCameraParameters cam(600, 600, 320, 240, -0.2, 0.2);
+  vpUndistortionMap map(cam, 640, 480);
+  map.setNbThreads(2);
+
+  vpImage<unsigned char> I(480, 640), Iundist;
+  // for each acquired image I
+  map.remap(I, Iundist); // or vpImageTools::undistort(I, map, Iundist)
+}
+  \endcode
+*/
+class VISP_EXPORT vpUndistortionMap
+{
+public:
+  vpUndistortionMap();
+  vpUndistortionMap(const vpCameraParameters &cam, unsigned int width, unsigned int height);
+
+  /*!
+    Return the height of the images the map applies to.
+  */
+  inline unsigned int getHeight() const { return m_height; }
+  /*!
+    Return the number of threads used by remap(), 0 meaning
+    vpThreadPool::getConcurrency().
+  */
+  inline unsigned int getNbThreads() const { return m_nbThreads; }
+  /*!
+    Return the width of the images the map applies to.
+  */
+  inline unsigned int getWidth() const { return m_width; }
+
+  void init(const vpCameraParameters &cam, unsigned int width, unsigned int height);
+
+  void remap(const vpImage<unsigned char> &I, vpImage<unsigned char> &Iundist) const;
+  void remap(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Iundist) const;
+
+  void setNbThreads(unsigned int nbThreads);
+
+private:
+  template<class Type>
+  void remapRows(const Type *src, Type *dst, unsigned int start_row, unsigned int end_row) const;
+
+  template<class Type>
+  void remapImage(const vpImage<Type> &I, vpImage<Type> &Iundist) const;
+
+  template<class Type>
+  class RemapBody;
+
+  //! Width of the images
+  unsigned int m_width;
+  //! Height of the images
+  unsigned int m_height;
+  //! Number of threads used by remap(), 0 for vpThreadPool::getConcurrency()
+  unsigned int m_nbThreads;
+  //! True when the camera has no distortion, remap() is then a copy
+  bool m_identity;
+  //! Offset in the distorted image of the top-left neighbour of each pixel
+  std::vector<int> m_offsets;
+  //! Fixed-point bilinear weights of the four neighbours of each pixel
+  std::vector<short> m_weights;
+};
+
+#endif
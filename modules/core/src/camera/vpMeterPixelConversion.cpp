@@ -47,6 +47,11 @@
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpDebug.h>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
 //! Line coordinates conversion (rho,theta).
 void
 vpMeterPixelConversion::convertLine(const vpCameraParameters &cam,
@@ -110,3 +115,80 @@ vpMeterPixelConversion::convertEllipse(const vpCameraParameters &cam,
   mu02_p = mu02_m*vpMath::sqr(cam.get_py());
 }
 
+/*!
+  Point coordinates conversion from normalized coordinates \f$(x,y)\f$ in
+  meter to pixel coordinates \f$(u,v)\f$ for arrays of points, two points at
+  a time with SSE2 when available. The results are the same as with
+  convertPoint() for each point.
+
+  \param cam : camera parameters.
+  \param x, y : input coordinates of the \e n points in meter.
+  \param n : number of points.
+  \param u, v : output coordinates of the \e n points in pixels. They can be
+  the same arrays as \e x and \e y.
+
+  \sa convertPoint()
+*/
+void
+vpMeterPixelConversion::convertPoints(const vpCameraParameters &cam,
+                                      const double *x, const double *y, unsigned int n,
+                                      double *u, double *v)
+{
+  const double px = cam.px, py = cam.py, u0 = cam.u0, v0 = cam.v0, kud = cam.kud;
+  const bool distortion = (cam.projModel == vpCameraParameters::perspectiveProjWithDistortion);
+
+  unsigned int i = 0;
+#if VISP_HAVE_SSE2
+  const __m128d v_px = _mm_set1_pd(px), v_py = _mm_set1_pd(py);
+  const __m128d v_u0 = _mm_set1_pd(u0), v_v0 = _mm_set1_pd(v0);
+  if (distortion) {
+    const __m128d v_kud = _mm_set1_pd(kud), v_one = _mm_set1_pd(1.);
+    for (; i + 2 <= n; i += 2) {
+      const __m128d v_x = _mm_loadu_pd(x + i), v_y = _mm_loadu_pd(y + i);
+      const __m128d v_r2 = _mm_add_pd(v_one, _mm_mul_pd(v_kud, _mm_add_pd(_mm_mul_pd(v_x, v_x), _mm_mul_pd(v_y, v_y))));
+      _mm_storeu_pd(u + i, _mm_add_pd(v_u0, _mm_mul_pd(_mm_mul_pd(v_px, v_x), v_r2)));
+      _mm_storeu_pd(v + i, _mm_add_pd(v_v0, _mm_mul_pd(_mm_mul_pd(v_py, v_y), v_r2)));
+    }
+  }
+  else {
+    for (; i + 2 <= n; i += 2) {
+      _mm_storeu_pd(u + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(x + i), v_px), v_u0));
+      _mm_storeu_pd(v + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(y + i), v_py), v_v0));
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (distortion) {
+      convertPointWithDistortion(cam, x[i], y[i], u[i], v[i]);
+    }
+    else {
+      convertPointWithoutDistortion(cam, x[i], y[i], u[i], v[i]);
+    }
+  }
+}
+
+/*!
+  Point coordinates conversion from normalized coordinates \f$(x,y)\f$ in
+  meter to pixel coordinates \f$(u,v)\f$ for vectors of points.
+
+  \param cam : camera parameters.
+  \param x, y : input coordinates of the points in meter.
+  \param u, v : output coordinates of the points in pixels, resized to the number of points.
+
+  \exception vpException::dimensionError : If \e x and \e y do not have the same size.
+*/
+void
+vpMeterPixelConversion::convertPoints(const vpCameraParameters &cam,
+                                      const std::vector<double> &x, const std::vector<double> &y,
+                                      std::vector<double> &u, std::vector<double> &v)
+{
+  if (y.size() != x.size()) {
+    throw(vpException(vpException::dimensionError, "The coordinate vectors have different sizes"));
+  }
+  u.resize(x.size());
+  v.resize(x.size());
+  if (!x.empty()) {
+    convertPoints(cam, &x[0], &y[0], (unsigned int) x.size(), &u[0], &v[0]);
+  }
+}
@@ -45,9 +45,11 @@
 
 #include <sstream>
 #include <map>
+#include <vector>
 
 // image
 #include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpHistogram.h>
 
 #if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
 #  include <emmintrin.h>
@@ -63,6 +65,19 @@
 #  endif
 #endif
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Cumulative histogram of the depth values in [1,0xFFFF], the invalid null depths being ignored
+  void computeDepthCumulativeHistogram(const vpImage<uint16_t> &src_depth, std::vector<unsigned int> &cumulative)
+  {
+    vpHistogram histogram;
+    histogram.calculate(src_depth);
+    histogram.getCumulative(cumulative);
+    unsigned int nb_invalid = cumulative[0];
+    for(size_t i = 0; i < cumulative.size(); ++i) cumulative[i] -= nb_invalid;
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 bool vpImageConvert::YCbCrLUTcomputed = false;
 int vpImageConvert::vpCrr[256];
@@ -214,18 +229,15 @@ void
 vpImageConvert::createDepthHistogram(const vpImage<uint16_t> &src_depth, vpImage<vpRGBa> &dest_rgba)
 {
   dest_rgba.resize(src_depth.getHeight(), src_depth.getWidth());
-  static uint32_t histogram[0x10000];
-  memset(histogram, 0, sizeof(histogram));
-
-  for(unsigned int i = 0; i < src_depth.getSize(); ++i) ++histogram[src_depth.bitmap[i]];
-  for(int i = 2; i < 0x10000; ++i) histogram[i] += histogram[i-1]; // Build a cumulative histogram for the indices in [1,0xFFFF]
+  std::vector<unsigned int> histogram;
+  computeDepthCumulativeHistogram(src_depth, histogram);
 
   for(unsigned int i = 0; i < src_depth.getSize(); ++i)
   {
     uint16_t d = src_depth.bitmap[i];
     if(d)
     {
-      int f = (int)(histogram[d] * 255 / histogram[0xFFFF]); // 0-255 based on histogram location
+      int f = (int)((unsigned long long) histogram[d] * 255 / histogram[0xFFFF]); // 0-255 based on histogram location
       dest_rgba.bitmap[i].R = 255 - f;
       dest_rgba.bitmap[i].G = 0;
       dest_rgba.bitmap[i].B = f;
@@ -251,18 +263,15 @@ void
 vpImageConvert::createDepthHistogram(const vpImage<uint16_t> &src_depth, vpImage<unsigned char> &dest_depth)
 {
   dest_depth.resize(src_depth.getHeight(), src_depth.getWidth());
-  static uint32_t histogram2[0x10000];
-  memset(histogram2, 0, sizeof(histogram2));
-
-  for(unsigned int i = 0; i < src_depth.getSize(); ++i) ++histogram2[src_depth.bitmap[i]];
-  for(int i = 2; i < 0x10000; ++i) histogram2[i] += histogram2[i-1]; // Build a cumulative histogram for the indices in [1,0xFFFF]
+  std::vector<unsigned int> histogram;
+  computeDepthCumulativeHistogram(src_depth, histogram);
 
   for(unsigned int i = 0; i < src_depth.getSize(); ++i)
   {
     uint16_t d = src_depth.bitmap[i];
     if(d)
     {
-      int f = (int)(histogram2[d] * 255 / histogram2[0xFFFF]); // 0-255 based on histogram location
+      int f = (int)((unsigned long long) histogram[d] * 255 / histogram[0xFFFF]); // 0-255 based on histogram location
       dest_depth.bitmap[i] = f;
     }
     else
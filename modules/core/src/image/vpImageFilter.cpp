@@ -45,6 +45,315 @@
 #  include <cv.h>
 #endif
 
+#include <visp3/core/vpThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+/*
+  Border handling of the separable filtering engine.
+  - vpFilterReflect: the image is mirrored, pixel -k being pixel k on the left and top
+    borders and pixel w-1+k being pixel w-k on the right and bottom borders, as in
+    vpImageFilter::filterXLeftBorder() and vpImageFilter::filterXRightBorder().
+  - vpFilterZero: the pixels that are not fully covered by the kernel are set to 0.
+*/
+enum vpFilterBorder {
+  vpFilterReflect,
+  vpFilterZero
+};
+
+/*
+  1D kernel of the separable filtering engine: out[j] = sum_m taps[m] * in[j + m - anchor].
+  symmetry is 1 (resp. -1) when the kernel is centered and symmetric (resp. antisymmetric),
+  in which case only half of the products are computed.
+*/
+struct vpSeparableKernel
+{
+  std::vector<float> taps;
+  unsigned int anchor;
+  int symmetry;
+};
+
+// Kernel given by its (size+1)/2 right coefficients, as returned by vpImageFilter::getGaussianKernel()
+vpSeparableKernel symmetricKernel(const double *filter, unsigned int size)
+{
+  vpSeparableKernel kernel;
+  unsigned int half = (size-1)/2;
+  kernel.taps.resize(2*half+1);
+  kernel.anchor = half;
+  kernel.symmetry = 1;
+  for (unsigned int i = 0; i <= half; i++) {
+    kernel.taps[half+i] = kernel.taps[half-i] = (float) filter[i];
+  }
+  return kernel;
+}
+
+// Derivative kernel such as out[j] = sum_{i>0} filter[i] * (in[j+i] - in[j-i])
+vpSeparableKernel antisymmetricKernel(const double *filter, unsigned int size)
+{
+  vpSeparableKernel kernel;
+  unsigned int half = (size-1)/2;
+  kernel.taps.resize(2*half+1);
+  kernel.anchor = half;
+  kernel.symmetry = -1;
+  kernel.taps[half] = 0.f;
+  for (unsigned int i = 1; i <= half; i++) {
+    kernel.taps[half+i] = (float) filter[i];
+    kernel.taps[half-i] = - (float) filter[i];
+  }
+  return kernel;
+}
+
+// Convolution kernel as used by vpImageFilter::sepFilter(): out[j] = sum_a k[a] * in[j + size/2 - a]
+vpSeparableKernel convolutionKernel(const vpColVector &k)
+{
+  vpSeparableKernel kernel;
+  unsigned int size = k.size();
+  kernel.taps.resize(size);
+  kernel.anchor = size - 1 - size/2;
+  for (unsigned int m = 0; m < size; m++) {
+    kernel.taps[m] = (float) k[size-1-m];
+  }
+
+  kernel.symmetry = 0;
+  if (size % 2 == 1) {
+    bool symmetric = true, antisymmetric = (kernel.taps[size/2] == 0.f);
+    for (unsigned int i = 1; i <= size/2; i++) {
+      symmetric = symmetric && (kernel.taps[size/2+i] == kernel.taps[size/2-i]);
+      antisymmetric = antisymmetric && (kernel.taps[size/2+i] == -kernel.taps[size/2-i]);
+    }
+    kernel.symmetry = symmetric ? 1 : (antisymmetric ? -1 : 0);
+  }
+  return kernel;
+}
+
+// Mirrored index of x in [0, n)
+inline int reflectIndex(int x, int n)
+{
+  if (x < 0)
+    x = -x;
+  if (x >= n)
+    x = 2*n - x - 1;
+  return x < 0 ? 0 : (x >= n ? n-1 : x);
+}
+
+/*
+  Filter n samples: dst[j] = sum_m taps[m] * src[m][j]. src[m] points to the samples shifted
+  by m - anchor, that are the columns of a padded line or the rows of the image, so that the
+  same code is used in both directions and the border handling is done before.
+*/
+void filterSpan(const float *const *src, float *dst, unsigned int n, const vpSeparableKernel &kernel)
+{
+  const float *taps = &kernel.taps[0];
+  const unsigned int size = (unsigned int) kernel.taps.size();
+  const unsigned int half = kernel.anchor;
+  unsigned int j = 0;
+
+  if (kernel.symmetry > 0) {
+#if VISP_HAVE_SSE2
+    for (; j + 4 <= n; j += 4) {
+      __m128 acc = _mm_mul_ps(_mm_set1_ps(taps[half]), _mm_loadu_ps(src[half] + j));
+      for (unsigned int i = 1; i <= half; i++) {
+        __m128 s = _mm_add_ps(_mm_loadu_ps(src[half+i] + j), _mm_loadu_ps(src[half-i] + j));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[half+i]), s));
+      }
+      _mm_storeu_ps(dst + j, acc);
+    }
+#endif
+    for (; j < n; j++) {
+      float acc = taps[half] * src[half][j];
+      for (unsigned int i = 1; i <= half; i++) {
+        acc += taps[half+i] * (src[half+i][j] + src[half-i][j]);
+      }
+      dst[j] = acc;
+    }
+  }
+  else if (kernel.symmetry < 0) {
+#if VISP_HAVE_SSE2
+    for (; j + 4 <= n; j += 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (unsigned int i = 1; i <= half; i++) {
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(src[half+i] + j), _mm_loadu_ps(src[half-i] + j));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[half+i]), d));
+      }
+      _mm_storeu_ps(dst + j, acc);
+    }
+#endif
+    for (; j < n; j++) {
+      float acc = 0.f;
+      for (unsigned int i = 1; i <= half; i++) {
+        acc += taps[half+i] * (src[half+i][j] - src[half-i][j]);
+      }
+      dst[j] = acc;
+    }
+  }
+  else {
+#if VISP_HAVE_SSE2
+    for (; j + 4 <= n; j += 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (unsigned int m = 0; m < size; m++) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(taps[m]), _mm_loadu_ps(src[m] + j)));
+      }
+      _mm_storeu_ps(dst + j, acc);
+    }
+#endif
+    for (; j < n; j++) {
+      float acc = 0.f;
+      for (unsigned int m = 0; m < size; m++) {
+        acc += taps[m] * src[m][j];
+      }
+      dst[j] = acc;
+    }
+  }
+}
+
+// A float output row is written in place, a double output row goes through the row buffer
+inline float *outputRow(float *out, std::vector<float> &) { return out; }
+inline float *outputRow(double *, std::vector<float> &row) { return &row[0]; }
+
+inline void storeRow(const float *, float *, unsigned int) {}
+inline void storeRow(const float *row, double *out, unsigned int n)
+{
+  for (unsigned int j = 0; j < n; j++) {
+    out[j] = row[j];
+  }
+}
+
+// Filter each row of an image with a band of rows per thread
+template<class SrcType, class DstType>
+class vpFilterRowsBody : public vpParallelLoopBody
+{
+public:
+  vpFilterRowsBody(const vpImage<SrcType> &I, vpImage<DstType> &If, const vpSeparableKernel &kernel, vpFilterBorder border)
+    : m_I(I), m_If(If), m_kernel(kernel), m_border(border) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const int width = (int) m_I.getWidth();
+    const int size = (int) m_kernel.taps.size();
+    const int left = (int) m_kernel.anchor, right = size - 1 - left;
+    const int margin = std::min(size / 2, width);
+
+    std::vector<float> line(width + left + right), row(width);
+    std::vector<const float *> src(size);
+    for (int m = 0; m < size; m++) {
+      src[m] = &line[m];
+    }
+
+    for (unsigned int r = start; r < end; r++) {
+      const SrcType *in = m_I[r];
+      float *center = &line[left];
+      for (int x = 0; x < width; x++) {
+        center[x] = (float) in[x];
+      }
+      for (int x = 1; x <= left; x++) {
+        center[-x] = center[reflectIndex(-x, width)];
+      }
+      for (int x = width; x < width + right; x++) {
+        center[x] = center[reflectIndex(x, width)];
+      }
+
+      DstType *out = m_If[r];
+      float *dst = outputRow(out, row);
+      filterSpan(&src[0], dst, (unsigned int) width, m_kernel);
+      if (m_border == vpFilterZero) {
+        for (int x = 0; x < margin; x++) {
+          dst[x] = dst[width-1-x] = 0.f;
+        }
+      }
+      storeRow(dst, out, (unsigned int) width);
+    }
+  }
+
+private:
+  const vpImage<SrcType> &m_I;
+  vpImage<DstType> &m_If;
+  const vpSeparableKernel &m_kernel;
+  vpFilterBorder m_border;
+};
+
+// Filter each column of a float image with a band of rows per thread
+template<class DstType>
+class vpFilterColumnsBody : public vpParallelLoopBody
+{
+public:
+  vpFilterColumnsBody(const vpImage<float> &I, vpImage<DstType> &If, const vpSeparableKernel &kernel, vpFilterBorder border)
+    : m_I(I), m_If(If), m_kernel(kernel), m_border(border) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const unsigned int width = m_I.getWidth();
+    const int height = (int) m_I.getHeight();
+    const int size = (int) m_kernel.taps.size();
+    const int margin = size / 2;
+
+    std::vector<float> row(width);
+    std::vector<const float *> src(size);
+
+    for (unsigned int r = start; r < end; r++) {
+      DstType *out = m_If[r];
+      if (m_border == vpFilterZero && ((int) r < margin || (int) r >= height - margin)) {
+        for (unsigned int j = 0; j < width; j++) {
+          out[j] = 0;
+        }
+        continue;
+      }
+
+      for (int m = 0; m < size; m++) {
+        src[m] = m_I[reflectIndex((int) r + m - (int) m_kernel.anchor, height)];
+      }
+      float *dst = outputRow(out, row);
+      filterSpan(&src[0], dst, width, m_kernel);
+      storeRow(dst, out, width);
+    }
+  }
+
+private:
+  const vpImage<float> &m_I;
+  vpImage<DstType> &m_If;
+  const vpSeparableKernel &m_kernel;
+  vpFilterBorder m_border;
+};
+
+template<class SrcType, class DstType>
+void filterRows(const vpImage<SrcType> &I, vpImage<DstType> &If, const vpSeparableKernel &kernel, vpFilterBorder border)
+{
+  If.resize(I.getHeight(), I.getWidth());
+  if (I.getSize() == 0)
+    return;
+  vpThreadPool::parallelFor(0, I.getHeight(), vpFilterRowsBody<SrcType, DstType>(I, If, kernel, border));
+}
+
+template<class DstType>
+void filterColumns(const vpImage<float> &I, vpImage<DstType> &If, const vpSeparableKernel &kernel, vpFilterBorder border)
+{
+  If.resize(I.getHeight(), I.getWidth());
+  if (I.getSize() == 0)
+    return;
+  vpThreadPool::parallelFor(0, I.getHeight(), vpFilterColumnsBody<DstType>(I, If, kernel, border));
+}
+
+// The vertical pass reads float rows: other images are converted first
+template<class SrcType>
+void convertAndFilterColumns(const vpImage<SrcType> &I, vpImage<double> &If, const vpSeparableKernel &kernel, vpFilterBorder border)
+{
+  vpImage<float> If_float(I.getHeight(), I.getWidth());
+  for (unsigned int i = 0; i < I.getSize(); i++) {
+    If_float.bitmap[i] = (float) I.bitmap[i];
+  }
+  filterColumns(If_float, If, kernel, border);
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 
 /*!
   Apply a filter to an image.
@@ -228,40 +537,154 @@ vpImageFilter::sepFilter(const vpImage<unsigned char> &I,
                          vpImage<double>& If,
                          const vpColVector& kernelH,
                          const vpColVector &kernelV) {
-  unsigned int size = kernelH.size();
-  unsigned int half_size = size/2;
+  vpImage<float> buffer;
+  sepFilter(I, If, kernelH, kernelV, buffer);
+}
 
-  If.resize(I.getHeight(),I.getWidth(), 0.0);
-  vpImage<double> I_filter(I.getHeight(),I.getWidth(), 0.0);
+/*!
+  Apply a filter to an image using two separable kernels, as
+  sepFilter(const vpImage<unsigned char> &, vpImage<double>&, const vpColVector&, const vpColVector&),
+  using a caller-provided buffer for the intermediate image so that no
+  memory is allocated when the function is called with images of the same
+  size.
 
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
-    for (unsigned int j = half_size; j < I.getWidth()-half_size; j++) {
-      double conv = 0.0;
-      for (unsigned int a = 0; a < kernelH.size(); a++) {
-        conv += kernelH[a] * I[i][j+half_size-a];
-      }
+  \param I : Image to filter
+  \param If : Filtered image.
+  \param kernelH : Separable kernel (performed first).
+  \param kernelV : Separable kernel (performed last).
+  \param buffer : Intermediate image, resized if needed.
+*/
+void
+vpImageFilter::sepFilter(const vpImage<unsigned char> &I,
+                         vpImage<double>& If,
+                         const vpColVector& kernelH,
+                         const vpColVector &kernelV,
+                         vpImage<float> &buffer) {
+  filterRows(I, buffer, convolutionKernel(kernelH), vpFilterZero);
+  filterColumns(buffer, If, convolutionKernel(kernelV), vpFilterZero);
+}
 
-      I_filter[i][j] = conv;
-    }
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+// Sobel kernels of aperture size 3, 5 or 7, in the convolution order of convolutionKernel()
+void getSobelKernels(unsigned int apertureSobel, vpColVector &smooth, vpColVector &derivative)
+{
+  if (apertureSobel != 3 && apertureSobel != 5 && apertureSobel != 7) {
+    throw(vpImageException(vpImageException::incorrectInitializationError,
+                           "Bad Sobel aperture size %d, it should be 3, 5 or 7", apertureSobel));
   }
 
-  for (unsigned int i = half_size; i < I.getHeight()-half_size; i++) {
-    for (unsigned int j = 0; j < I.getWidth(); j++) {
-      double conv = 0.0;
-      for (unsigned int a = 0; a < kernelV.size(); a++) {
-        conv += kernelV[a] * I_filter[i+half_size-a][j];
+  // Binomial coefficients of order apertureSobel-1 and apertureSobel-2
+  std::vector<double> binomial(apertureSobel, 0.), lower(apertureSobel, 0.);
+  binomial[0] = 1.;
+  for (unsigned int n = 1; n < apertureSobel; n++) {
+    if (n == apertureSobel - 1)
+      lower = binomial;
+    for (unsigned int k = n; k > 0; k--)
+      binomial[k] += binomial[k-1];
+  }
+
+  smooth.resize(apertureSobel);
+  derivative.resize(apertureSobel);
+  for (unsigned int k = 0; k < apertureSobel; k++) {
+    smooth[k] = binomial[k];
+    // lower convolved by [1 -1]
+    derivative[k] = lower[k] - (k > 0 ? lower[k-1] : 0.);
+  }
+}
+
+// L1 norm of the gradient
+class vpCannyMagnitudeBody : public vpParallelLoopBody
+{
+public:
+  vpCannyMagnitudeBody(const vpImage<float> &dIx, const vpImage<float> &dIy, vpImage<float> &mag)
+    : m_dIx(dIx), m_dIy(dIy), m_mag(mag) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const unsigned int width = m_mag.getWidth();
+    for (unsigned int r = start; r < end; r++) {
+      const float *dx = m_dIx[r], *dy = m_dIy[r];
+      float *mag = m_mag[r];
+      for (unsigned int c = 0; c < width; c++) {
+        mag[c] = std::fabs(dx[c]) + std::fabs(dy[c]);
       }
+    }
+  }
+
+private:
+  const vpImage<float> &m_dIx, &m_dIy;
+  vpImage<float> &m_mag;
+};
+
+/*
+  Non-maximum suppression along the gradient direction quantized in 4 sectors. The
+  local maxima are marked 2 above the upper threshold and 1 above the lower threshold.
+  The first and last rows and columns are never edges.
+*/
+class vpCannySuppressionBody : public vpParallelLoopBody
+{
+public:
+  vpCannySuppressionBody(const vpImage<float> &dIx, const vpImage<float> &dIy, const vpImage<float> &mag,
+                         vpImage<unsigned char> &edges, float lower, float upper)
+    : m_dIx(dIx), m_dIy(dIy), m_mag(mag), m_edges(edges), m_lower(lower), m_upper(upper) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const float tan22_5 = 0.414213562f, tan67_5 = 2.414213562f;
+    const unsigned int width = m_mag.getWidth(), height = m_mag.getHeight();
+
+    for (unsigned int r = start; r < end; r++) {
+      unsigned char *edges = m_edges[r];
+      memset(edges, 0, width);
+      if (r == 0 || r + 1 >= height)
+        continue;
+
+      const float *prev = m_mag[r-1], *mag = m_mag[r], *next = m_mag[r+1];
+      const float *dx = m_dIx[r], *dy = m_dIy[r];
+      for (unsigned int c = 1; c + 1 < width; c++) {
+        float m = mag[c];
+        if (m <= m_lower)
+          continue;
+
+        float ax = std::fabs(dx[c]), ay = std::fabs(dy[c]);
+        bool maximum;
+        if (ay <= ax * tan22_5) {
+          maximum = (m > mag[c-1] && m >= mag[c+1]);
+        }
+        else if (ay > ax * tan67_5) {
+          maximum = (m > prev[c] && m >= next[c]);
+        }
+        else {
+          // With the image rows going down, a gradient with components of the same sign is along the main diagonal
+          int s = (dx[c] * dy[c] < 0) ? -1 : 1;
+          maximum = (m > prev[(int) c - s] && m > next[(int) c + s]);
+        }
 
-      If[i][j] = conv;
+        if (maximum)
+          edges[c] = (m > m_upper) ? 2 : 1;
+      }
     }
   }
+
+private:
+  const vpImage<float> &m_dIx, &m_dIy, &m_mag;
+  vpImage<unsigned char> &m_edges;
+  float m_lower, m_upper;
+};
 }
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
-#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020100)
 /*!
   Apply the Canny edge operator on the image \e Isrc and return the resulting
   image \e Ires.
 
+  The image is smoothed by a Gaussian filter, the gradient is computed with
+  the Sobel operator and its L1 norm is kept where it is maximum along the
+  gradient direction. The remaining pixels above \e thresholdCanny are
+  edges. The filters and the non-maximum suppression are processed by bands
+  of rows with vpThreadPool.
+
   The following example shows how to use the method:
 
   \code
@@ -271,7 +694,6 @@ vpImageFilter::sepFilter(const vpImage<unsigned char> &I,
 
 int main()
 {
-#if VISP_HAVE_OPENCV_VERSION >= 0x020100 // Canny uses OpenCV >=2.1.0
   // Constants for the Canny operator.
   const unsigned int gaussianFilterSize = 5;
   const double thresholdCanny = 15;
@@ -285,18 +707,22 @@ int main()
 
   //Apply the Canny edge operator and set the Icanny image.
   vpImageFilter::canny(Isrc, Icanny, gaussianFilterSize, thresholdCanny, apertureSobel);
-#endif
   return (0);
 }
   \endcode
 
   \param Isrc : Image to apply the Canny edge detector to.
-  \param Ires : Filtered image (255 means an edge, 0 otherwise).
+  \param Ires : Filtered image (255 means an edge, 0 otherwise). It can be
+  the same image as \e Isrc.
   \param gaussianFilterSize : The size of the mask of the Gaussian filter to
-  apply (an odd number).
+  apply (an odd number). The standard deviation of the Gaussian is
+  0.3*((gaussianFilterSize-1)*0.5 - 1) + 0.8, as in OpenCV. A size of 1
+  disables the smoothing.
   \param thresholdCanny : The threshold for the Canny operator. Only value
   greater than this value are marked as an edge).
-  \param apertureSobel : Size of the mask for the Sobel operator (odd number).
+  \param apertureSobel : Size of the mask for the Sobel operator (3, 5 or 7).
+
+  \sa canny(const vpImage<unsigned char>&, vpImage<unsigned char>&, const unsigned int, const double, const double, const unsigned int)
 */
 void
 vpImageFilter:: canny(const vpImage<unsigned char>& Isrc,
@@ -305,141 +731,219 @@ vpImageFilter:: canny(const vpImage<unsigned char>& Isrc,
                       const double thresholdCanny,
                       const unsigned int apertureSobel)
 {
-#if (VISP_HAVE_OPENCV_VERSION < 0x020408)
-  IplImage* img_ipl = NULL;
-  vpImageConvert::convert(Isrc, img_ipl);
-  IplImage* edges_ipl;
-  edges_ipl = cvCreateImage(cvSize(img_ipl->width, img_ipl->height), img_ipl->depth, img_ipl->nChannels);
+  canny(Isrc, Ires, gaussianFilterSize, thresholdCanny, thresholdCanny, apertureSobel);
+}
 
-  cvSmooth(img_ipl, img_ipl, CV_GAUSSIAN, (int)gaussianFilterSize, (int)gaussianFilterSize, 0, 0);
-  cvCanny(img_ipl, edges_ipl, thresholdCanny, thresholdCanny, (int)apertureSobel);
+/*!
+  Apply the Canny edge operator on the image \e Isrc with a hysteresis
+  thresholding: the pixels above \e upperThreshold are edges, and so are the
+  pixels above \e lowerThreshold connected to them.
 
-  vpImageConvert::convert(edges_ipl, Ires);
-  cvReleaseImage(&img_ipl);
-  cvReleaseImage(&edges_ipl);
-#else
-  cv::Mat img_cvmat, edges_cvmat;
-  vpImageConvert::convert(Isrc, img_cvmat);
-  cv::GaussianBlur(img_cvmat, img_cvmat, cv::Size((int)gaussianFilterSize, (int)gaussianFilterSize), 0, 0);
-  cv::Canny(img_cvmat, edges_cvmat, thresholdCanny, thresholdCanny, (int)apertureSobel);
-  vpImageConvert::convert(edges_cvmat, Ires);
-#endif
+  \param Isrc : Image to apply the Canny edge detector to.
+  \param Ires : Filtered image (255 means an edge, 0 otherwise). It can be
+  the same image as \e Isrc.
+  \param gaussianFilterSize : The size of the mask of the Gaussian filter to
+  apply (an odd number, or 1 to disable the smoothing).
+  \param lowerThreshold : Lower threshold of the hysteresis.
+  \param upperThreshold : Upper threshold of the hysteresis.
+  \param apertureSobel : Size of the mask for the Sobel operator (3, 5 or 7).
+
+  \sa canny(const vpImage<unsigned char>&, vpImage<unsigned char>&, const unsigned int, const double, const unsigned int)
+*/
+void
+vpImageFilter::canny(const vpImage<unsigned char>& Isrc,
+                     vpImage<unsigned char>& Ires,
+                     const unsigned int gaussianFilterSize,
+                     const double lowerThreshold,
+                     const double upperThreshold,
+                     const unsigned int apertureSobel)
+{
+  vpColVector smooth, derivative;
+  getSobelKernels(apertureSobel, smooth, derivative);
+
+  const unsigned int height = Isrc.getHeight(), width = Isrc.getWidth();
+  vpImage<float> I_blur, buffer, dIx, dIy;
+  if (gaussianFilterSize > 1) {
+    double sigma = 0.3 * ((gaussianFilterSize - 1) * 0.5 - 1) + 0.8;
+    std::vector<double> fg((gaussianFilterSize+1)/2);
+    vpImageFilter::getGaussianKernel(&fg[0], gaussianFilterSize, sigma, true);
+    vpSeparableKernel gaussian = symmetricKernel(&fg[0], gaussianFilterSize);
+    filterRows(Isrc, buffer, gaussian, vpFilterReflect);
+    filterColumns(buffer, I_blur, gaussian, vpFilterReflect);
+  }
+  else {
+    I_blur.resize(height, width);
+    for (unsigned int i = 0; i < Isrc.getSize(); i++) {
+      I_blur.bitmap[i] = Isrc.bitmap[i];
+    }
+  }
+
+  vpSeparableKernel smooth_kernel = convolutionKernel(smooth), derivative_kernel = convolutionKernel(derivative);
+  filterRows(I_blur, buffer, derivative_kernel, vpFilterReflect);
+  filterColumns(buffer, dIx, smooth_kernel, vpFilterReflect);
+  filterRows(I_blur, buffer, smooth_kernel, vpFilterReflect);
+  filterColumns(buffer, dIy, derivative_kernel, vpFilterReflect);
+
+  // The blurred image is not used anymore
+  vpImage<float> &mag = I_blur;
+  vpImage<unsigned char> edges(height, width);
+  if (Isrc.getSize() > 0) {
+    vpThreadPool::parallelFor(0, height, vpCannyMagnitudeBody(dIx, dIy, mag));
+    vpThreadPool::parallelFor(0, height, vpCannySuppressionBody(dIx, dIy, mag, edges, (float) lowerThreshold,
+                                                                (float) std::max(lowerThreshold, upperThreshold)));
+  }
+
+  // Hysteresis: the weak edges connected to a strong edge become strong edges
+  Ires.resize(height, width);
+  std::vector<unsigned int> stack;
+  for (unsigned int i = 0; i < edges.getSize(); i++) {
+    if (edges.bitmap[i] == 2)
+      stack.push_back(i);
+  }
+  const int neighbors[8] = { -(int) width - 1, -(int) width, -(int) width + 1, -1, 1,
+                             (int) width - 1, (int) width, (int) width + 1 };
+  while (!stack.empty()) {
+    unsigned int index = stack.back();
+    stack.pop_back();
+    // Edges are never on the image border, their neighbors are in the image
+    for (unsigned int k = 0; k < 8; k++) {
+      unsigned int neighbor = (unsigned int) ((int) index + neighbors[k]);
+      if (edges.bitmap[neighbor] == 1) {
+        edges.bitmap[neighbor] = 2;
+        stack.push_back(neighbor);
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < edges.getSize(); i++) {
+    Ires.bitmap[i] = (edges.bitmap[i] == 2) ? 255 : 0;
+  }
 }
-#endif
 
 /*!
-  Apply a separable filter.
+  Apply a separable filter along the rows and then along the columns.
+
+  \param I : Image to filter.
+  \param GI : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of a symmetric kernel, such as the one
+  computed by getGaussianKernel().
+  \param size : Filter size. This value should be odd.
  */
 void vpImageFilter::filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size)
 {
-  vpImage<double> GIx ;
-  filterX(I, GIx,filter,size);
-  filterY(GIx, GI,filter,size);
-  GIx.destroy();
+  vpImage<float> buffer;
+  vpImageFilter::filter(I, GI, filter, size, buffer);
 }
 
 /*!
-  Apply a separable filter.
+  Apply a separable filter along the rows and then along the columns.
+
+  \param I : Image to filter.
+  \param GI : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of a symmetric kernel, such as the one
+  computed by getGaussianKernel().
+  \param size : Filter size. This value should be odd.
  */
 void vpImageFilter::filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size)
 {
-  vpImage<double> GIx ;
-  filterX(I, GIx,filter,size);
-  filterY(GIx, GI,filter,size);
-  GIx.destroy();
+  vpImage<float> buffer;
+  vpImageFilter::filter(I, GI, filter, size, buffer);
+}
+
+/*!
+  Apply a separable filter along the rows and then along the columns, using a
+  caller-provided buffer for the intermediate image so that no memory is allocated
+  when the function is called with images of the same size.
+
+  \param I : Image to filter.
+  \param GI : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of a symmetric kernel, such as the one
+  computed by getGaussianKernel().
+  \param size : Filter size. This value should be odd.
+  \param buffer : Intermediate image, resized if needed.
+ */
+void vpImageFilter::filter(const vpImage<unsigned char> &I, vpImage<double>& GI, const double *filter,unsigned  int size,
+                           vpImage<float> &buffer)
+{
+  vpSeparableKernel kernel = symmetricKernel(filter, size);
+  filterRows(I, buffer, kernel, vpFilterReflect);
+  filterColumns(buffer, GI, kernel, vpFilterReflect);
 }
 
+/*!
+  Apply a separable filter along the rows and then along the columns, using a
+  caller-provided buffer for the intermediate image so that no memory is allocated
+  when the function is called with images of the same size.
+
+  \param I : Image to filter.
+  \param GI : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of a symmetric kernel, such as the one
+  computed by getGaussianKernel().
+  \param size : Filter size. This value should be odd.
+  \param buffer : Intermediate image, resized if needed.
+ */
+void vpImageFilter::filter(const vpImage<double> &I, vpImage<double>& GI, const double *filter,unsigned  int size,
+                           vpImage<float> &buffer)
+{
+  vpSeparableKernel kernel = symmetricKernel(filter, size);
+  filterRows(I, buffer, kernel, vpFilterReflect);
+  filterColumns(buffer, GI, kernel, vpFilterReflect);
+}
+
+/*!
+  Apply a symmetric filter along the rows of an image. The image is mirrored on the
+  left and right borders.
+
+  \param I : Image to filter.
+  \param dIx : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of the kernel.
+  \param size : Filter size. This value should be odd.
+ */
 void vpImageFilter::filterX(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXLeftBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXRightBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-  }
+  filterRows(I, dIx, symmetricKernel(filter, size), vpFilterReflect);
 }
+
+/*!
+  Apply a symmetric filter along the rows of an image. The image is mirrored on the
+  left and right borders.
+
+  \param I : Image to filter.
+  \param dIx : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of the kernel.
+  \param size : Filter size. This value should be odd.
+ */
 void vpImageFilter::filterX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXLeftBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=vpImageFilter::filterXRightBorder(I,i,j,filter,size);
-      //dIx[i][j]=0;
-    }
-  }
+  filterRows(I, dIx, symmetricKernel(filter, size), vpFilterReflect);
 }
+
+/*!
+  Apply a symmetric filter along the columns of an image. The image is mirrored on the
+  top and bottom borders.
+
+  \param I : Image to filter.
+  \param dIy : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of the kernel.
+  \param size : Filter size. This value should be odd.
+ */
 void vpImageFilter::filterY(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYTopBorder(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYBottomBorder(I,i,j,filter,size);
-    }
-  }
+  convertAndFilterColumns(I, dIy, symmetricKernel(filter, size), vpFilterReflect);
 }
+
+/*!
+  Apply a symmetric filter along the columns of an image. The image is mirrored on the
+  top and bottom borders.
+
+  \param I : Image to filter.
+  \param dIy : Filtered image.
+  \param filter : Pointer to the (size+1)/2 coefficients of the kernel.
+  \param size : Filter size. This value should be odd.
+ */
 void vpImageFilter::filterY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYTopBorder(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::filterYBottomBorder(I,i,j,filter,size);
-    }
-  }
+  convertAndFilterColumns(I, dIy, symmetricKernel(filter, size), vpFilterReflect);
 }
 
 /*!
@@ -453,13 +957,8 @@ void vpImageFilter::filterY(const vpImage<double> &I, vpImage<double>& dIy, cons
  */
 void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, unsigned int size, double sigma, bool normalize)
 {
-  double *fg=new double[(size+1)/2] ;
-  vpImageFilter::getGaussianKernel(fg, size, sigma, normalize) ;
-  vpImage<double> GIx ;
-  vpImageFilter::filterX(I, GIx,fg,size);
-  vpImageFilter::filterY(GIx, GI,fg,size);
-  GIx.destroy();
-  delete[] fg;
+  vpImage<float> buffer;
+  vpImageFilter::gaussianBlur(I, GI, buffer, size, sigma, normalize);
 }
 
 /*!
@@ -473,13 +972,46 @@ void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<double
  */
 void vpImageFilter::gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, unsigned int size, double sigma, bool normalize)
 {
-  double *fg=new double[(size+1)/2] ;
-  vpImageFilter::getGaussianKernel(fg, size, sigma, normalize) ;
-  vpImage<double> GIx ;
-  vpImageFilter::filterX(I, GIx,fg,size);
-  vpImageFilter::filterY(GIx, GI,fg,size);
-  GIx.destroy();
-  delete[] fg;
+  vpImage<float> buffer;
+  vpImageFilter::gaussianBlur(I, GI, buffer, size, sigma, normalize);
+}
+
+/*!
+  Apply a Gaussian blur to an image, using a caller-provided buffer for the
+  intermediate image.
+  \param I : Input image.
+  \param GI : Filtered image.
+  \param buffer : Intermediate image, resized if needed.
+  \param size : Filter size. This value should be odd.
+  \param sigma : Gaussian standard deviation. If it is equal to zero or negative, it is computed from filter size as sigma = (size-1)/6.
+  \param normalize : Flag indicating whether to normalize the filter coefficients or not.
+
+ */
+void vpImageFilter::gaussianBlur(const vpImage<unsigned char> &I, vpImage<double>& GI, vpImage<float> &buffer,
+                                 unsigned int size, double sigma, bool normalize)
+{
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+  vpImageFilter::filter(I, GI, &fg[0], size, buffer);
+}
+
+/*!
+  Apply a Gaussian blur to a double image, using a caller-provided buffer for the
+  intermediate image.
+  \param I : Input double image.
+  \param GI : Filtered image.
+  \param buffer : Intermediate image, resized if needed.
+  \param size : Filter size. This value should be odd.
+  \param sigma : Gaussian standard deviation. If it is equal to zero or negative, it is computed from filter size as sigma = (size-1)/6.
+  \param normalize : Flag indicating whether to normalize the filter coefficients or not.
+
+ */
+void vpImageFilter::gaussianBlur(const vpImage<double> &I, vpImage<double>& GI, vpImage<float> &buffer,
+                                 unsigned int size, double sigma, bool normalize)
+{
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size, sigma, normalize) ;
+  vpImageFilter::filter(I, GI, &fg[0], size, buffer);
 }
 
 /*!
@@ -564,149 +1096,76 @@ void vpImageFilter::getGaussianDerivativeKernel(double *filter, unsigned int siz
 }
 
 
+/*!
+  Compute the gradient along X with the 7 taps derivative filter of derivativeFilterX().
+  The 3 first and last columns are set to 0.
+  \param I : Input image
+  \param dIx : Gradient along X.
+ */
 void vpImageFilter::getGradX(const vpImage<unsigned char> &I, vpImage<double>& dIx)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  //dIx=0;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < 3 ; j++)
-    {
-      dIx[i][j]=0;
-    }
-    for (unsigned int j=3 ; j < I.getWidth()-3 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::derivativeFilterX(I,i,j);
-    }
-    for (unsigned int j=I.getWidth()-3 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=0;
-    }
-  }
+  const double filter[4] = { 0., 2047.0/8418.0, 913.0/8418.0, 112.0/8418.0 };
+  filterRows(I, dIx, antisymmetricKernel(filter, 7), vpFilterZero);
 }
 
+/*!
+  Compute the gradient along Y with the 7 taps derivative filter of derivativeFilterY().
+  The 3 first and last rows are set to 0.
+  \param I : Input image
+  \param dIy : Gradient along Y.
+ */
 void vpImageFilter::getGradY(const vpImage<unsigned char> &I, vpImage<double>& dIy)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  //dIy=0;
-  for (unsigned int i=0 ; i < 3 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
-  for (unsigned int i=3 ; i < I.getHeight()-3 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::derivativeFilterY(I,i,j);
-    }
-  }
-  for (unsigned int i=I.getHeight()-3 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
+  const double filter[4] = { 0., 2047.0/8418.0, 913.0/8418.0, 112.0/8418.0 };
+  convertAndFilterColumns(I, dIy, antisymmetricKernel(filter, 7), vpFilterZero);
 }
 
+/*!
+  Compute the gradient along X. The (size-1)/2 first and last columns are set to 0.
+  \param I : Input image
+  \param dIx : Gradient along X.
+  \param filter : Derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+  \param size : Size of the kernel.
+ */
 void vpImageFilter::getGradX(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  //#pragma omp parallel for
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::derivativeFilterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=0;
-    }
-  }
+  filterRows(I, dIx, antisymmetricKernel(filter, size), vpFilterZero);
 }
+
+/*!
+  Compute the gradient along X. The (size-1)/2 first and last columns are set to 0.
+  \param I : Input image
+  \param dIx : Gradient along X.
+  \param filter : Derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+  \param size : Size of the kernel.
+ */
 void vpImageFilter::getGradX(const vpImage<double> &I, vpImage<double>& dIx, const double *filter,unsigned  int size)
 {
-  dIx.resize(I.getHeight(),I.getWidth()) ;
-  //dIx=0;
-  for (unsigned int i=0 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < (size-1)/2 ; j++)
-    {
-      dIx[i][j]=0;
-    }
-    for (unsigned int j=(size-1)/2 ; j < I.getWidth()-(size-1)/2 ; j++)
-    {
-      dIx[i][j]=vpImageFilter::derivativeFilterX(I,i,j,filter,size);
-    }
-    for (unsigned int j=I.getWidth()-(size-1)/2 ; j < I.getWidth() ; j++)
-    {
-      dIx[i][j]=0;
-    }
-  }
+  filterRows(I, dIx, antisymmetricKernel(filter, size), vpFilterZero);
 }
 
+/*!
+  Compute the gradient along Y. The (size-1)/2 first and last rows are set to 0.
+  \param I : Input image
+  \param dIy : Gradient along Y.
+  \param filter : Derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+  \param size : Size of the kernel.
+ */
 void vpImageFilter::getGradY(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  //#pragma omp parallel for
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
-  //#pragma omp parallel for
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::derivativeFilterY(I,i,j,filter,size);
-    }
-  }
-  //#pragma omp parallel for
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
+  convertAndFilterColumns(I, dIy, antisymmetricKernel(filter, size), vpFilterZero);
 }
 
+/*!
+  Compute the gradient along Y. The (size-1)/2 first and last rows are set to 0.
+  \param I : Input image
+  \param dIy : Gradient along Y.
+  \param filter : Derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+  \param size : Size of the kernel.
+ */
 void vpImageFilter::getGradY(const vpImage<double> &I, vpImage<double>& dIy, const double *filter,unsigned  int size)
 {
-  dIy.resize(I.getHeight(),I.getWidth()) ;
-  //dIy=0;
-  for (unsigned int i=0 ; i < (size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
-  for (unsigned int i=(size-1)/2 ; i < I.getHeight()-(size-1)/2 ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=vpImageFilter::derivativeFilterY(I,i,j,filter,size);
-    }
-  }
-  for (unsigned int i=I.getHeight()-(size-1)/2 ; i < I.getHeight() ; i++)
-  {
-    for (unsigned int j=0 ; j < I.getWidth() ; j++)
-    {
-      dIy[i][j]=0;
-    }
-  }
+  convertAndFilterColumns(I, dIy, antisymmetricKernel(filter, size), vpFilterZero);
 }
 
 /*!
@@ -719,9 +1178,28 @@ void vpImageFilter::getGradY(const vpImage<double> &I, vpImage<double>& dIy, con
  */
 void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel, const double *gaussianDerivativeKernel, unsigned  int size)
 {
-  vpImage<double> GIy;
-  vpImageFilter::filterY(I,  GIy, gaussianKernel, size);
-  vpImageFilter::getGradX(GIy, dIx, gaussianDerivativeKernel, size);
+  vpImage<float> buffer;
+  vpImageFilter::getGradXGauss2D(I, dIx, gaussianKernel, gaussianDerivativeKernel, size, buffer);
+}
+
+/*!
+   Compute the gradient along X after applying a gaussian filter along Y, using a
+   caller-provided buffer for the intermediate image.
+
+   Since the filters are separable, the derivative is computed first along the rows
+   and the Gaussian filter is then applied along the columns.
+   \param I : Input image
+   \param dIx : Gradient along X.
+   \param gaussianKernel : Gaussian kernel which values should be computed using vpImageFilter::getGaussianKernel().
+   \param gaussianDerivativeKernel : Gaussian derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the Gaussian and Gaussian derivative kernels.
+   \param buffer : Intermediate image, resized if needed.
+ */
+void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIx, const double *gaussianKernel,
+                                    const double *gaussianDerivativeKernel, unsigned  int size, vpImage<float> &buffer)
+{
+  filterRows(I, buffer, antisymmetricKernel(gaussianDerivativeKernel, size), vpFilterZero);
+  filterColumns(buffer, dIx, symmetricKernel(gaussianKernel, size), vpFilterReflect);
 }
 
 /*!
@@ -734,9 +1212,25 @@ void vpImageFilter::getGradXGauss2D(const vpImage<unsigned char> &I, vpImage<dou
  */
 void vpImageFilter::getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel, const double *gaussianDerivativeKernel,unsigned  int size)
 {
-  vpImage<double> GIx;
-  vpImageFilter::filterX(I,  GIx, gaussianKernel, size);
-  vpImageFilter::getGradY(GIx, dIy, gaussianDerivativeKernel, size);
+  vpImage<float> buffer;
+  vpImageFilter::getGradYGauss2D(I, dIy, gaussianKernel, gaussianDerivativeKernel, size, buffer);
+}
+
+/*!
+   Compute the gradient along Y after applying a gaussian filter along X, using a
+   caller-provided buffer for the intermediate image.
+   \param I : Input image
+   \param dIy : Gradient along Y.
+   \param gaussianKernel : Gaussian kernel which values should be computed using vpImageFilter::getGaussianKernel().
+   \param gaussianDerivativeKernel : Gaussian derivative kernel which values should be computed using vpImageFilter::getGaussianDerivativeKernel().
+   \param size : Size of the Gaussian and Gaussian derivative kernels.
+   \param buffer : Intermediate image, resized if needed.
+ */
+void vpImageFilter::getGradYGauss2D(const vpImage<unsigned char> &I, vpImage<double>& dIy, const double *gaussianKernel,
+                                    const double *gaussianDerivativeKernel, unsigned  int size, vpImage<float> &buffer)
+{
+  filterRows(I, buffer, symmetricKernel(gaussianKernel, size), vpFilterReflect);
+  filterColumns(buffer, dIy, antisymmetricKernel(gaussianDerivativeKernel, size), vpFilterZero);
 }
 
 //operation pour pyramide gaussienne
@@ -35,13 +35,346 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
 #include <visp3/core/vpImageMorphology.h>
+#include <visp3/core/vpThreadPool.h>
 
 #if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
 #  include <emmintrin.h>
 #  define VISP_HAVE_SSE2 1
 #endif
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+/*
+  Flat erosion and dilatation with the van Herk / Gil-Werman algorithm.
+
+  Along one direction out[x] = op(in[x-left], ..., in[x+right]) with a window of
+  size = left+right+1 pixels. The line padded with the border value is cut in blocks
+  of size pixels; prefix[i] (resp. suffix[i]) is op of the pixels going from the
+  beginning of the block of i to i (resp. from i to the end of its block). A window
+  starting at x overlaps at most two blocks, so that out[x] = op(suffix[x], prefix[x+size-1])
+  whatever the size.
+*/
+struct vpMinOperator
+{
+  // Neutral value, the image being +infinity outside its domain
+  static inline unsigned char border() { return 255; }
+  static inline unsigned char apply(unsigned char a, unsigned char b) { return a < b ? a : b; }
+#if defined(VISP_HAVE_SSE2)
+  static inline __m128i apply(const __m128i &a, const __m128i &b) { return _mm_min_epu8(a, b); }
+#endif
+};
+
+struct vpMaxOperator
+{
+  // Neutral value, the image being -infinity outside its domain
+  static inline unsigned char border() { return 0; }
+  static inline unsigned char apply(unsigned char a, unsigned char b) { return a > b ? a : b; }
+#if defined(VISP_HAVE_SSE2)
+  static inline __m128i apply(const __m128i &a, const __m128i &b) { return _mm_max_epu8(a, b); }
+#endif
+};
+
+// dst[i] = op(a[i], b[i])
+template <class Op> void combine(const unsigned char *a, const unsigned char *b, unsigned char *dst, unsigned int n)
+{
+  unsigned int i = 0;
+#if defined(VISP_HAVE_SSE2)
+  for (; i + 16 <= n; i += 16) {
+    const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+    const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+    _mm_storeu_si128((__m128i *) (dst + i), Op::apply(va, vb));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = Op::apply(a[i], b[i]);
+  }
+}
+
+// dst[i] = max(a[i] - b[i], 0)
+void subtract(const unsigned char *a, const unsigned char *b, unsigned char *dst, unsigned int n)
+{
+  unsigned int i = 0;
+#if defined(VISP_HAVE_SSE2)
+  for (; i + 16 <= n; i += 16) {
+    const __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+    const __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+    _mm_storeu_si128((__m128i *) (dst + i), _mm_subs_epu8(va, vb));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = a[i] > b[i] ? (unsigned char) (a[i] - b[i]) : 0;
+  }
+}
+
+#if defined(VISP_HAVE_SSE2)
+/*
+  Transpose a block of 16x16 bytes. Interleaving the rows i and i+8 rotates the 8 bits
+  (row, column) index of each byte by one bit, four interleavings swap rows and columns.
+*/
+void transpose16x16(const unsigned char *src, size_t srcStride, unsigned char *dst, size_t dstStride)
+{
+  __m128i a[16], b[16];
+  for (unsigned int i = 0; i < 16; i++) {
+    a[i] = _mm_loadu_si128((const __m128i *) (src + i * srcStride));
+  }
+  for (unsigned int k = 0; k < 2; k++) {
+    for (unsigned int i = 0; i < 8; i++) {
+      b[2*i] = _mm_unpacklo_epi8(a[i], a[i+8]);
+      b[2*i+1] = _mm_unpackhi_epi8(a[i], a[i+8]);
+    }
+    for (unsigned int i = 0; i < 8; i++) {
+      a[2*i] = _mm_unpacklo_epi8(b[i], b[i+8]);
+      a[2*i+1] = _mm_unpackhi_epi8(b[i], b[i+8]);
+    }
+  }
+  for (unsigned int i = 0; i < 16; i++) {
+    _mm_storeu_si128((__m128i *) (dst + i * dstStride), a[i]);
+  }
+}
+#endif
+
+// Blocks of prefix and suffix values of a line of n elements of step bytes, one per row
+template <class Op>
+void prefixSuffix(const unsigned char *line, unsigned char *prefix, unsigned char *suffix, unsigned int n,
+                  unsigned int size, unsigned int step)
+{
+  for (unsigned int b = 0; b < n; b += size) {
+    const unsigned int e = std::min(b + size, n);
+    memcpy(prefix + b * step, line + b * step, step);
+    for (unsigned int i = b + 1; i < e; i++) {
+      combine<Op>(prefix + (i-1) * step, line + i * step, prefix + i * step, step);
+    }
+    memcpy(suffix + (e-1) * step, line + (e-1) * step, step);
+    for (unsigned int i = e - 1; i > b; i--) {
+      combine<Op>(suffix + i * step, line + (i-1) * step, suffix + (i-1) * step, step);
+    }
+  }
+}
+
+/*
+  Horizontal window of size pixels starting left pixels before the current one, computed in
+  place. With SSE2 the rows are processed by strips of 16 interleaved rows, so that the
+  recurrences along the rows are vectorized.
+*/
+template <class Op> class vpMorphologyRowsBody : public vpParallelLoopBody
+{
+public:
+  vpMorphologyRowsBody(vpImage<unsigned char> &I, unsigned int size, unsigned int left)
+    : m_I(I), m_size(size), m_left(left) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const unsigned int width = m_I.getWidth();
+    const unsigned int n = width + m_size - 1;
+    unsigned int r = start;
+
+#if defined(VISP_HAVE_SSE2)
+    const unsigned int step = 16;
+    std::vector<unsigned char> strip(n * step, Op::border()), prefix(n * step), suffix(n * step), out(width * step);
+    for (; r + step <= end; r += step) {
+      unsigned int x0 = 0;
+      for (; x0 + step <= width; x0 += step) {
+        transpose16x16(m_I[r] + x0, width, &strip[(m_left + x0) * step], step);
+      }
+      for (unsigned int j = 0; j < step; j++) {
+        const unsigned char *row = m_I[r + j];
+        unsigned char *dst = &strip[m_left * step + j];
+        for (unsigned int x = x0; x < width; x++) {
+          dst[x * step] = row[x];
+        }
+      }
+      prefixSuffix<Op>(&strip[0], &prefix[0], &suffix[0], n, m_size, step);
+      combine<Op>(&suffix[0], &prefix[(m_size-1) * step], &out[0], width * step);
+      for (x0 = 0; x0 + step <= width; x0 += step) {
+        transpose16x16(&out[x0 * step], step, m_I[r] + x0, width);
+      }
+      for (unsigned int j = 0; j < step; j++) {
+        unsigned char *row = m_I[r + j];
+        const unsigned char *src = &out[j];
+        for (unsigned int x = x0; x < width; x++) {
+          row[x] = src[x * step];
+        }
+      }
+    }
+#endif
+
+    if (r < end) {
+      std::vector<unsigned char> line(n, Op::border()), prefix(n), suffix(n);
+      for (; r < end; r++) {
+        unsigned char *row = m_I[r];
+        memcpy(&line[m_left], row, width);
+        for (unsigned int b = 0; b < n; b += m_size) {
+          const unsigned int e = std::min(b + m_size, n);
+          prefix[b] = line[b];
+          for (unsigned int i = b + 1; i < e; i++) {
+            prefix[i] = Op::apply(prefix[i-1], line[i]);
+          }
+          suffix[e-1] = line[e-1];
+          for (unsigned int i = e - 1; i > b; i--) {
+            suffix[i-1] = Op::apply(suffix[i], line[i-1]);
+          }
+        }
+        combine<Op>(&suffix[0], &prefix[m_size-1], row, width);
+      }
+    }
+  }
+
+private:
+  vpMorphologyRowsBody &operator=(const vpMorphologyRowsBody &);
+
+  vpImage<unsigned char> &m_I;
+  unsigned int m_size;
+  unsigned int m_left;
+};
+
+/*
+  Window of size pixels along a vertical (shift = 0), diagonal (shift = 1) or antidiagonal
+  (shift = -1) line: Io[r][c] = op(I[r+t][c+offset+shift*t]) for t in [-left, size-1-left].
+  The recurrences are computed on whole rows, the row i continuing the lines of the row i-1
+  shifted by one column, so that they are vectorized over the columns. Each band of rows
+  computes the blocks covering its rows and the left (resp. size-1-left) rows above (resp. below).
+*/
+template <class Op> class vpMorphologyColumnsBody : public vpParallelLoopBody
+{
+public:
+  vpMorphologyColumnsBody(const vpImage<unsigned char> &I, vpImage<unsigned char> &Io, unsigned int size,
+                          unsigned int left, int shift, int offset)
+    : m_I(I), m_Io(Io), m_size(size), m_left(left), m_shift(shift), m_offset(offset) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const int width = (int) m_I.getWidth(), height = (int) m_I.getHeight();
+    const int size = (int) m_size, left = (int) m_left, right = size - 1 - left;
+    // Columns added on each side so that the lines going out of the image meet the border value
+    const int pad = (m_shift != 0 || m_offset != 0) ? size + std::abs(m_offset) : 0;
+    const int stride = width + 2 * pad;
+    const int n = (int) (end - start) + size - 1;
+
+    std::vector<unsigned char> border((size_t) stride, Op::border()), lines;
+    std::vector<const unsigned char *> line((size_t) n);
+    if (pad > 0) {
+      lines.resize((size_t) (n * stride), Op::border());
+    }
+    for (int i = 0; i < n; i++) {
+      const int y = (int) start + i - left;
+      if (y < 0 || y >= height) {
+        line[i] = &border[0];
+      } else if (pad == 0) {
+        line[i] = m_I[y];
+      } else {
+        memcpy(&lines[(size_t) (i * stride + pad)], m_I[y], (size_t) width);
+        line[i] = &lines[(size_t) (i * stride)];
+      }
+    }
+
+    // Suffix values of a block and prefix values of the next block, so that the buffers stay in cache
+    std::vector<unsigned char> suffix((size_t) (size * stride)), prefix((size_t) (size * stride));
+    // Columns of a row that have a predecessor in the previous (prefix) or next (suffix) row
+    const int count = stride - std::abs(m_shift);
+    const int prefixFirst = m_shift > 0 ? 1 : 0, suffixFirst = m_shift < 0 ? 1 : 0;
+    const int nbRows = (int) (end - start);
+    for (int b = 0; b < nbRows; b += size) {
+      // A window starting in the block [b, b+size) ends in the next block, clipped to the n rows
+      const int e = b + size, e_next = std::min(e + size, n);
+      memcpy(&suffix[(size_t) ((size - 1) * stride)], line[e-1], (size_t) stride);
+      for (int i = e - 1; i > b; i--) {
+        unsigned char *p = &suffix[(size_t) ((i-1-b) * stride)];
+        const unsigned char *q = &suffix[(size_t) ((i-b) * stride)];
+        combine<Op>(line[i-1] + suffixFirst, q + suffixFirst + m_shift, p + suffixFirst, (unsigned int) count);
+        if (m_shift != 0) {
+          const int c = m_shift > 0 ? stride - 1 : 0;
+          p[c] = line[i-1][c];
+        }
+      }
+      if (e < e_next) {
+        memcpy(&prefix[0], line[e], (size_t) stride);
+      }
+      for (int i = e + 1; i < e_next; i++) {
+        unsigned char *p = &prefix[(size_t) ((i-e) * stride)];
+        const unsigned char *q = &prefix[(size_t) ((i-1-e) * stride)];
+        combine<Op>(line[i] + prefixFirst, q + prefixFirst - m_shift, p + prefixFirst, (unsigned int) count);
+        if (m_shift != 0) {
+          const int c = m_shift > 0 ? 0 : stride - 1;
+          p[c] = line[i][c];
+        }
+      }
+
+      const int x_end = std::min(e, nbRows);
+      for (int x = b; x < x_end; x++) {
+        const unsigned char *s = &suffix[(size_t) ((x-b) * stride + pad + m_offset - m_shift * left)];
+        unsigned char *out = m_Io[start + (unsigned int) x];
+        if (x == b) {
+          // The window is the whole block
+          memcpy(out, s, (size_t) width);
+        } else {
+          const unsigned char *p = &prefix[(size_t) ((x+size-1-e) * stride + pad + m_offset + m_shift * right)];
+          combine<Op>(s, p, out, (unsigned int) width);
+        }
+      }
+    }
+  }
+
+private:
+  vpMorphologyColumnsBody &operator=(const vpMorphologyColumnsBody &);
+
+  const vpImage<unsigned char> &m_I;
+  vpImage<unsigned char> &m_Io;
+  unsigned int m_size;
+  unsigned int m_left;
+  int m_shift;
+  int m_offset;
+};
+
+/*
+  Erosion (Op = vpMinOperator, reflect = false) or dilatation (Op = vpMaxOperator,
+  reflect = true) by a flat structuring element of width x height pixels centered
+  on (width/2, height/2). The dilatation uses the structuring element reflected
+  around its center.
+*/
+template <class Op>
+void morphology(vpImage<unsigned char> &I, unsigned int width, unsigned int height,
+                vpImageMorphology::vpStructuringElementType element, bool reflect)
+{
+  if (width == 0 || height == 0) {
+    throw vpException(vpException::badValue, "The structuring element size (%dx%d) must be positive",
+                      width, height);
+  }
+  if (element != vpImageMorphology::STRUCTURING_ELEMENT_RECTANGLE && width != height) {
+    throw vpException(vpException::badValue, "A diagonal structuring element (%dx%d) must be square",
+                      width, height);
+  }
+
+  if (element == vpImageMorphology::STRUCTURING_ELEMENT_RECTANGLE) {
+    // Separable: horizontal line then vertical line
+    if (width > 1) {
+      const unsigned int left = reflect ? width - 1 - width / 2 : width / 2;
+      vpThreadPool::parallelFor(0, I.getHeight(), vpMorphologyRowsBody<Op>(I, width, left));
+    }
+    if (height > 1) {
+      const vpImage<unsigned char> J(I);
+      const unsigned int top = reflect ? height - 1 - height / 2 : height / 2;
+      vpThreadPool::parallelFor(0, I.getHeight(), vpMorphologyColumnsBody<Op>(J, I, height, top, 0, 0));
+    }
+  } else if (height > 1) {
+    // Pixels (t, t) of the diagonal, (t, size - 1 - 2*(size/2) - t) of the antidiagonal,
+    // for t in [-size/2, size-1-size/2]
+    const int size = (int) height;
+    const int shift = element == vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL ? 1 : -1;
+    const int offset = element == vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL ? 0 : size - 1 - 2 * (size / 2);
+    const vpImage<unsigned char> J(I);
+    const unsigned int top = reflect ? height - 1 - height / 2 : height / 2;
+    vpThreadPool::parallelFor(0, I.getHeight(),
+                              vpMorphologyColumnsBody<Op>(J, I, height, top, shift, reflect ? -offset : offset));
+  }
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 
 /*!
   Erode a grayscale image using the given structuring element.
@@ -276,3 +609,165 @@ void vpImageMorphology::dilatation(vpImage<unsigned char> &I, const vpConnexityT
     }
   }
 }
+
+/*!
+  Erode a grayscale image with a flat rectangle or line structuring element
+  of any size.
+
+  The erosion is a local-minimum operator over the pixels of the structuring
+  element centered on the pixel (width/2, height/2) of its bounding box, the
+  image being assumed to be \f$ + \infty \f$ outside its domain, as for
+  erosion(vpImage<unsigned char> &, const vpConnexityType &). A 3x3 rectangle
+  gives the same result as the erosion in CONNEXITY_8.
+
+  The van Herk / Gil-Werman algorithm is used along each direction, so that
+  the computation time does not depend on the size of the structuring element.
+  A rectangle is processed as a horizontal line followed by a vertical line.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \exception vpException::badValue : If width or height is null, or if
+  they differ for a diagonal structuring element.
+
+  \sa dilatation(vpImage<unsigned char> &, const unsigned int &, const unsigned int &, const vpStructuringElementType &)
+*/
+void vpImageMorphology::erosion(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                const vpStructuringElementType &element)
+{
+  if(I.getSize() == 0) {
+    std::cerr << "Input image is empty!" << std::endl;
+    return;
+  }
+  morphology<vpMinOperator>(I, width, height, element, false);
+}
+
+/*!
+  Dilate a grayscale image with a flat rectangle or line structuring element
+  of any size.
+
+  The dilatation is a local-maximum operator over the pixels of the
+  structuring element reflected around its center, the image being assumed to
+  be \f$ - \infty \f$ outside its domain. With this definition an opening
+  (resp. closing) is never above (resp. below) the image, even for a
+  structuring element of even size.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \exception vpException::badValue : If width or height is null, or if
+  they differ for a diagonal structuring element.
+
+  \sa erosion(vpImage<unsigned char> &, const unsigned int &, const unsigned int &, const vpStructuringElementType &)
+*/
+void vpImageMorphology::dilatation(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                   const vpStructuringElementType &element)
+{
+  if(I.getSize() == 0) {
+    std::cerr << "Input image is empty!" << std::endl;
+    return;
+  }
+  morphology<vpMaxOperator>(I, width, height, element, true);
+}
+
+/*!
+  Opening of a grayscale image: erosion followed by a dilatation with the
+  same structuring element. It removes the bright details in which the
+  structuring element does not fit.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \sa closing(), topHat()
+*/
+void vpImageMorphology::opening(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                const vpStructuringElementType &element)
+{
+  erosion(I, width, height, element);
+  dilatation(I, width, height, element);
+}
+
+/*!
+  Closing of a grayscale image: dilatation followed by an erosion with the
+  same structuring element. It removes the dark details in which the
+  structuring element does not fit.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \sa opening(), blackHat()
+*/
+void vpImageMorphology::closing(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                const vpStructuringElementType &element)
+{
+  dilatation(I, width, height, element);
+  erosion(I, width, height, element);
+}
+
+/*!
+  White top-hat of a grayscale image: difference between the image and its
+  opening. It keeps the bright details in which the structuring element does
+  not fit, whatever the background.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \sa opening(), blackHat()
+*/
+void vpImageMorphology::topHat(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                               const vpStructuringElementType &element)
+{
+  vpImage<unsigned char> J(I);
+  opening(J, width, height, element);
+  subtract(I.bitmap, J.bitmap, I.bitmap, I.getSize());
+}
+
+/*!
+  Black top-hat of a grayscale image: difference between the closing of the
+  image and the image. It keeps the dark details in which the structuring
+  element does not fit, whatever the background.
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+
+  \sa closing(), topHat()
+*/
+void vpImageMorphology::blackHat(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                 const vpStructuringElementType &element)
+{
+  vpImage<unsigned char> J(I);
+  closing(J, width, height, element);
+  subtract(J.bitmap, I.bitmap, I.bitmap, I.getSize());
+}
+
+/*!
+  Morphological gradient of a grayscale image: difference between the
+  dilatation and the erosion of the image. The difference is set to 0 where
+  the dilatation is below the erosion, which only happens when the
+  structuring element does not contain its center (antidiagonal of even size).
+
+  \param I : Image to process.
+  \param width : Width of the structuring element in pixels.
+  \param height : Height of the structuring element in pixels.
+  \param element : Shape of the structuring element.
+*/
+void vpImageMorphology::gradient(vpImage<unsigned char> &I, const unsigned int &width, const unsigned int &height,
+                                 const vpStructuringElementType &element)
+{
+  vpImage<unsigned char> J(I);
+  dilatation(J, width, height, element);
+  erosion(I, width, height, element);
+  subtract(J.bitmap, I.bitmap, I.bitmap, I.getSize());
+}
@@ -360,6 +360,40 @@ vpImageTools::imageSubtract(const vpImage<unsigned char> &I1,
   }
 }
 
+/*!
+  Undistort a grey level image using a precomputed undistortion map.
+
+  \param I : Input image to undistort. Its size has to be the size of the map.
+  \param map : Undistortion map built from the camera parameters.
+  \param undistI : Undistorted output image.
+
+  \sa vpUndistortionMap::remap()
+*/
+void
+vpImageTools::undistort(const vpImage<unsigned char> &I,
+                        const vpUndistortionMap &map,
+                        vpImage<unsigned char> &undistI)
+{
+  map.remap(I, undistI);
+}
+
+/*!
+  Undistort a color image using a precomputed undistortion map.
+
+  \param I : Input image to undistort. Its size has to be the size of the map.
+  \param map : Undistortion map built from the camera parameters.
+  \param undistI : Undistorted output image.
+
+  \sa vpUndistortionMap::remap()
+*/
+void
+vpImageTools::undistort(const vpImage<vpRGBa> &I,
+                        const vpUndistortionMap &map,
+                        vpImage<vpRGBa> &undistI)
+{
+  map.remap(I, undistI);
+}
+
 // Reference: http://blog.demofox.org/2015/08/15/resizing-images-with-bicubic-interpolation/
 // t is a value that goes from 0 to 1 to interpolate in a C1 continuous way across uniformly sampled data points.
 // when t is 0, this will return B.  When t is 1, this will return C. In between values will return an interpolation
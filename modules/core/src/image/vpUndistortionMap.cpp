@@ -0,0 +1,335 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Precomputed undistortion map.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+#include <visp3/core/vpImageException.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpUndistortionMap.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
+
+namespace {
+// The sub-pixel position is quantized to 1/128 pixel, the product of two
+// weights is then at most 2^14 and fits in a signed 16 bits integer
+const int vpUndistortionMapFracBits = 7;
+const int vpUndistortionMapFracOne = 1 << vpUndistortionMapFracBits;
+const int vpUndistortionMapWeightBits = 2 * vpUndistortionMapFracBits;
+const int vpUndistortionMapRound = 1 << (vpUndistortionMapWeightBits - 1);
+
+inline unsigned char interpolate(const unsigned char *p, unsigned int width, const short *w)
+{
+  int val = p[0] * w[0] + p[1] * w[1] + p[width] * w[2] + p[width+1] * w[3];
+  return (unsigned char) ((val + vpUndistortionMapRound) >> vpUndistortionMapWeightBits);
+}
+
+#if defined VISP_HAVE_SSE2
+// Gather the four neighbours of a pixel in a 32 bits word: p00 p01 p10 p11
+inline int gatherNeighbours(const unsigned char *p, unsigned int width)
+{
+  return (int) ((unsigned int) p[0] | ((unsigned int) p[1] << 8) |
+                ((unsigned int) p[width] << 16) | ((unsigned int) p[width+1] << 24));
+}
+#endif
+
+}
+
+/*!
+  Default constructor. The map is empty and has to be initialized with init().
+*/
+vpUndistortionMap::vpUndistortionMap()
+  : m_width(0), m_height(0), m_nbThreads(0), m_identity(true), m_offsets(), m_weights()
+{
+}
+
+/*!
+  Build the undistortion map of images of size \e width x \e height acquired
+  by a camera with parameters \e cam.
+
+  \sa init()
+*/
+vpUndistortionMap::vpUndistortionMap(const vpCameraParameters &cam, unsigned int width, unsigned int height)
+  : m_width(0), m_height(0), m_nbThreads(0), m_identity(true), m_offsets(), m_weights()
+{
+  init(cam, width, height);
+}
+
+/*!
+  Build the undistortion map of images of size \e width x \e height acquired
+  by a camera with parameters \e cam. The distortion model is the one used by
+  vpImageTools::undistort(): the pixel \f$(u,v)\f$ of the undistorted image
+  takes the value of the distorted image at
+  \f[
+  u_d = u_0 + (u - u_0)(1 + k_{ud} r^2), \quad v_d = v_0 + (v - v_0)(1 + k_{ud} r^2)
+  \f]
+  with \f$ r^2 = ((u - u_0)/p_x)^2 + ((v - v_0)/p_y)^2 \f$.
+
+  \param cam : Camera parameters with distortion.
+  \param width, height : Size of the images to undistort.
+*/
+void vpUndistortionMap::init(const vpCameraParameters &cam, unsigned int width, unsigned int height)
+{
+  m_width = width;
+  m_height = height;
+
+  double kud = cam.get_kud();
+  m_identity = (std::fabs(kud) <= std::numeric_limits<double>::epsilon());
+  if (m_identity) {
+    m_offsets.clear();
+    m_weights.clear();
+    return;
+  }
+
+  m_offsets.resize((size_t) width * height);
+  m_weights.resize(4 * (size_t) width * height);
+
+  double u0 = cam.get_u0();
+  double v0 = cam.get_v0();
+  double invpx = 1.0 / cam.get_px();
+  double invpy = 1.0 / cam.get_py();
+
+  double kud_px2 = kud * invpx * invpx;
+  double kud_py2 = kud * invpy * invpy;
+
+  int *offset = m_offsets.empty() ? NULL : &m_offsets[0];
+  short *weight = m_weights.empty() ? NULL : &m_weights[0];
+  for (unsigned int i = 0; i < height; i++) {
+    double deltav = i - v0;
+    double fr1 = 1.0 + kud_py2 * deltav * deltav;
+
+    for (unsigned int j = 0; j < width; j++, offset++, weight += 4) {
+      double deltau = j - u0;
+      double fr2 = fr1 + kud_px2 * deltau * deltau;
+
+      double u_double = deltau * fr2 + u0;
+      double v_double = deltav * fr2 + v0;
+
+      int u_round = (int) u_double;
+      int v_round = (int) v_double;
+      if (u_double < 0 || v_double < 0 || u_round >= (int) width - 1 || v_round >= (int) height - 1) {
+        // Pixel outside the image: null weights give a null value without any test in remap()
+        *offset = 0;
+        weight[0] = weight[1] = weight[2] = weight[3] = 0;
+        continue;
+      }
+
+      int du = vpMath::round((u_double - u_round) * vpUndistortionMapFracOne);
+      int dv = vpMath::round((v_double - v_round) * vpUndistortionMapFracOne);
+
+      *offset = v_round * (int) width + u_round;
+      weight[0] = (short) ((vpUndistortionMapFracOne - du) * (vpUndistortionMapFracOne - dv));
+      weight[1] = (short) (du * (vpUndistortionMapFracOne - dv));
+      weight[2] = (short) ((vpUndistortionMapFracOne - du) * dv);
+      weight[3] = (short) (du * dv);
+    }
+  }
+}
+
+/*!
+  Set the number of threads of vpThreadPool used by remap(), the rows being
+  shared between the threads. 1 means that the remapping is done by the
+  calling thread. 0, the default value, means vpThreadPool::getConcurrency().
+*/
+void vpUndistortionMap::setNbThreads(unsigned int nbThreads)
+{
+  m_nbThreads = nbThreads;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template<>
+void vpUndistortionMap::remapRows(const unsigned char *src, unsigned char *dst,
+                                  unsigned int start_row, unsigned int end_row) const
+{
+  size_t start = (size_t) start_row * m_width, end = (size_t) end_row * m_width;
+  const int *offset = &m_offsets[0];
+  const short *weight = &m_weights[0];
+  size_t k = start;
+
+#if defined VISP_HAVE_SSE2
+  // Four pixels at a time: the neighbours are gathered as 16 bits integers
+  // ordered like the weights so that _mm_madd_epi16() gives the two rows of
+  // the bilinear interpolation
+  const __m128i round = _mm_set1_epi32(vpUndistortionMapRound);
+  for (; k + 4 <= end; k += 4) {
+    __m128i p = _mm_set_epi32(gatherNeighbours(src + offset[k+3], m_width),
+                              gatherNeighbours(src + offset[k+2], m_width),
+                              gatherNeighbours(src + offset[k+1], m_width),
+                              gatherNeighbours(src + offset[k], m_width));
+    __m128i zero = _mm_setzero_si128();
+    __m128i w01 = _mm_loadu_si128((const __m128i *) (weight + 4*k));
+    __m128i w23 = _mm_loadu_si128((const __m128i *) (weight + 4*k + 8));
+    __m128i s01 = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), w01);
+    __m128i s23 = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), w23);
+    // Sum the two rows of each pixel
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(s01), _mm_castsi128_ps(s23), _MM_SHUFFLE(2,0,2,0)));
+    __m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(s01), _mm_castsi128_ps(s23), _MM_SHUFFLE(3,1,3,1)));
+    __m128i val = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(even, odd), round), vpUndistortionMapWeightBits);
+    val = _mm_packs_epi32(val, val);
+    int res = _mm_cvtsi128_si32(_mm_packus_epi16(val, val));
+    memcpy((void *) (dst + k), &res, 4);
+  }
+#endif
+
+  for (; k < end; k++) {
+    dst[k] = interpolate(src + offset[k], m_width, weight + 4*k);
+  }
+}
+
+template<>
+void vpUndistortionMap::remapRows(const vpRGBa *src, vpRGBa *dst,
+                                  unsigned int start_row, unsigned int end_row) const
+{
+  size_t start = (size_t) start_row * m_width, end = (size_t) end_row * m_width;
+  const int *offset = &m_offsets[0];
+  const short *weight = &m_weights[0];
+
+#if defined VISP_HAVE_SSE2
+  // The four channels of a pixel are interpolated at once: the channels of the
+  // two neighbours of a row are interleaved so that _mm_madd_epi16() applies
+  // the two weights of the row
+  const __m128i round = _mm_set1_epi32(vpUndistortionMapRound);
+  const __m128i zero = _mm_setzero_si128();
+  for (size_t k = start; k < end; k++) {
+    const unsigned char *p = (const unsigned char *) (src + offset[k]);
+    __m128i r0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), zero);
+    __m128i r1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (p + 4*m_width)), zero);
+    r0 = _mm_unpacklo_epi16(r0, _mm_srli_si128(r0, 8));
+    r1 = _mm_unpacklo_epi16(r1, _mm_srli_si128(r1, 8));
+
+    __m128i w = _mm_loadl_epi64((const __m128i *) (weight + 4*k));
+    __m128i val = _mm_add_epi32(_mm_madd_epi16(r0, _mm_shuffle_epi32(w, _MM_SHUFFLE(0,0,0,0))),
+                                _mm_madd_epi16(r1, _mm_shuffle_epi32(w, _MM_SHUFFLE(1,1,1,1))));
+    val = _mm_srai_epi32(_mm_add_epi32(val, round), vpUndistortionMapWeightBits);
+    val = _mm_packs_epi32(val, val);
+    int res = _mm_cvtsi128_si32(_mm_packus_epi16(val, val));
+    memcpy((void *) (dst + k), &res, 4);
+  }
+#else
+  for (size_t k = start; k < end; k++) {
+    const vpRGBa *p = src + offset[k];
+    const short *w = weight + 4*k;
+    dst[k].R = (unsigned char) ((p[0].R * w[0] + p[1].R * w[1] + p[m_width].R * w[2] + p[m_width+1].R * w[3]
+                                + vpUndistortionMapRound) >> vpUndistortionMapWeightBits);
+    dst[k].G = (unsigned char) ((p[0].G * w[0] + p[1].G * w[1] + p[m_width].G * w[2] + p[m_width+1].G * w[3]
+                                + vpUndistortionMapRound) >> vpUndistortionMapWeightBits);
+    dst[k].B = (unsigned char) ((p[0].B * w[0] + p[1].B * w[1] + p[m_width].B * w[2] + p[m_width+1].B * w[3]
+                                + vpUndistortionMapRound) >> vpUndistortionMapWeightBits);
+    dst[k].A = (unsigned char) ((p[0].A * w[0] + p[1].A * w[1] + p[m_width].A * w[2] + p[m_width+1].A * w[3]
+                                + vpUndistortionMapRound) >> vpUndistortionMapWeightBits);
+  }
+#endif
+}
+
+template<class Type>
+class vpUndistortionMap::RemapBody : public vpParallelLoopBody
+{
+public:
+  RemapBody(const vpUndistortionMap &map, const Type *src, Type *dst) : m_map(map), m_src(src), m_dst(dst) {}
+
+  void operator()(unsigned int start_row, unsigned int end_row) const {
+    m_map.remapRows(m_src, m_dst, start_row, end_row);
+  }
+
+private:
+  RemapBody &operator=(const RemapBody &);
+
+  const vpUndistortionMap &m_map;
+  const Type *m_src;
+  Type *m_dst;
+};
+
+template<class Type>
+void vpUndistortionMap::remapImage(const vpImage<Type> &I, vpImage<Type> &Iundist) const
+{
+  if (I.getWidth() != m_width || I.getHeight() != m_height) {
+    throw(vpImageException(vpImageException::incorrectInitializationError,
+                           "Image size (%dx%d) differs from the undistortion map size (%dx%d)",
+                           I.getWidth(), I.getHeight(), m_width, m_height));
+  }
+
+  if (m_identity) {
+    Iundist = I;
+    return;
+  }
+
+  Iundist.resize(m_height, m_width);
+  if (m_width < 2 || m_height < 2) {
+    // No pixel has its four neighbours in the image
+    memset((void *) Iundist.bitmap, 0, (size_t) m_width * m_height * sizeof(Type));
+    return;
+  }
+
+  if (m_nbThreads == 1) {
+    remapRows(I.bitmap, Iundist.bitmap, 0, m_height);
+  }
+  else {
+    vpThreadPool::parallelFor(0, m_height, RemapBody<Type>(*this, I.bitmap, Iundist.bitmap), m_nbThreads);
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Undistort a grey level image.
+
+  \param I : Distorted image. Its size has to be the one given to init().
+  \param Iundist : Undistorted image, resized if needed.
+
+  \exception vpImageException::incorrectInitializationError : If the size of \e I
+  differs from the size of the map.
+*/
+void vpUndistortionMap::remap(const vpImage<unsigned char> &I, vpImage<unsigned char> &Iundist) const
+{
+  remapImage(I, Iundist);
+}
+
+/*!
+  Undistort a color image. The four channels, including the alpha channel,
+  are interpolated.
+
+  \param I : Distorted image. Its size has to be the one given to init().
+  \param Iundist : Undistorted image, resized if needed.
+
+  \exception vpImageException::incorrectInitializationError : If the size of \e I
+  differs from the size of the map.
+*/
+void vpUndistortionMap::remap(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Iundist) const
+{
+  remapImage(I, Iundist);
+}
@@ -0,0 +1,205 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Trial scheduling shared by the workers of a parallel RANSAC.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpRansacScheduler.cpp
+  \brief Trial scheduling shared by the workers of a parallel RANSAC.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpRansacScheduler.h>
+#include <visp3/core/vpTime.h>
+
+/*!
+  Create a scheduler and start the time budget.
+
+  \param maxTrials : Upper bound on the number of trials, or -1 for INT_MAX.
+  \param probability : Probability to draw at least one outlier free sample
+  (typically 0.99). With a probability of 1 the number of trials is not lowered.
+  \param timeBudget : Time budget in ms, no limit if not strictly positive.
+  \param nbPoints : Number of points the samples are drawn from.
+  \param nbInlierConsensus : Size of a consensus set that stops the sampling.
+  \param sampleSize : Number of points of a minimal sample (3 for P3P, 4 for a homography).
+*/
+vpRansacScheduler::vpRansacScheduler(const int maxTrials, const double probability, const double timeBudget,
+                                     const unsigned int nbPoints, const unsigned int nbInlierConsensus,
+                                     const unsigned int sampleSize)
+  : m_bestNbInliers(0), m_maxTrials(maxTrials < 0 ? std::numeric_limits<int>::max() : maxTrials),
+    m_nbInlierConsensus(nbInlierConsensus), m_nbPoints(nbPoints), m_nbTrials(0), m_probability(probability),
+    m_requiredTrials(m_maxTrials), m_sampleSize(sampleSize), m_startTime(vpTime::measureTimeMs()), m_stop(false),
+    m_timeBudget(timeBudget)
+#if defined(VP_RANSAC_SCHEDULER_MUTEX)
+    , m_mutex()
+#endif
+{
+}
+
+/*!
+  Compute the number of RANSAC iterations to ensure with a probability \e p
+  that at least one of the random samples of \e s points is free from outliers.
+  \note See: Hartley and Zisserman, Multiple View Geometry in Computer Vision, p119 (2. How many samples?).
+
+  \param probability : Probability that at least one of the random samples is free from outliers (typically p=0.99).
+  \param epsilon : Probability that a selected point is an outlier (between 0 and 1).
+  \param sampleSize : Minimum number of points to estimate the model.
+  \param maxTrials : Upper bound on the number of iterations or -1 for INT_MAX.
+  \return The number of RANSAC iterations, \e maxTrials if it exceeds the
+  upper bound, or 0 if it cannot be computed at the machine precision.
+*/
+int vpRansacScheduler::computeNbTrials(double probability, double epsilon, const int sampleSize, int maxTrials)
+{
+  probability = std::max(probability, 0.0);
+  probability = std::min(probability, 1.0);
+  epsilon = std::max(epsilon, 0.0);
+  epsilon = std::min(epsilon, 1.0);
+
+  if (vpMath::nul(epsilon)) {
+    //no outliers
+    return 1;
+  }
+
+  if (maxTrials <= 0) {
+    maxTrials = std::numeric_limits<int>::max();
+  }
+
+  double logarg, logval, N;
+  logarg = -std::pow(1.0 - epsilon, sampleSize);
+#ifdef VISP_HAVE_FUNC_LOG1P
+  logval = log1p(logarg);
+#else
+  logval = log(1.0 + logarg);
+#endif
+  if (vpMath::nul(logval, std::numeric_limits<double>::epsilon())) {
+    std::cerr << "vpMath::nul(log(1.0 - std::pow(1.0 - epsilon, sampleSize)), std::numeric_limits<double>::epsilon())"
+              << std::endl;
+    return 0;
+  }
+
+  N = log(std::max(1.0 - probability, std::numeric_limits<double>::epsilon())) / logval;
+  if (logval < 0.0 && N < maxTrials) {
+    return (int) ceil(N);
+  }
+
+  return maxTrials;
+}
+
+/*!
+  \return The size of the largest consensus set reported with update().
+*/
+unsigned int vpRansacScheduler::getBestNbInliers()
+{
+  lock();
+  unsigned int bestNbInliers = m_bestNbInliers;
+  unlock();
+  return bestNbInliers;
+}
+
+/*!
+  \return The number of trials handed out by nextTrial().
+*/
+int vpRansacScheduler::getNbTrials()
+{
+  lock();
+  int nbTrials = m_nbTrials;
+  unlock();
+  return nbTrials;
+}
+
+/*!
+  Claim a new trial.
+
+  \return false when the sampling is over: the worker has to stop.
+*/
+bool vpRansacScheduler::nextTrial()
+{
+  lock();
+  if (!m_stop) {
+    if (m_nbTrials >= m_requiredTrials ||
+        (m_timeBudget > 0 && vpTime::measureTimeMs() - m_startTime > m_timeBudget)) {
+      m_stop = true;
+    } else {
+      m_nbTrials++;
+    }
+  }
+  bool next = !m_stop;
+  unlock();
+  return next;
+}
+
+/*!
+  Report the size of the consensus set of a hypothesis. A larger consensus
+  set than the previous ones lowers the number of trials still needed, or
+  stops the sampling if it reaches the consensus size.
+
+  \param nbInliers : Number of inliers of the hypothesis.
+*/
+void vpRansacScheduler::update(const unsigned int nbInliers)
+{
+  lock();
+  if (nbInliers > m_bestNbInliers) {
+    m_bestNbInliers = nbInliers;
+    if (m_bestNbInliers >= m_nbInlierConsensus) {
+      m_stop = true;
+    } else if (m_probability < 1 && m_nbPoints > 0) {
+      //Below the machine precision, computeNbTrials() cannot be used and maxTrials is kept
+      double inlierRatio = m_bestNbInliers / (double) m_nbPoints;
+      if (std::pow(inlierRatio, (double) m_sampleSize) > std::numeric_limits<double>::epsilon()) {
+        int nbTrials = computeNbTrials(m_probability, 1.0 - inlierRatio, (int) m_sampleSize, m_maxTrials);
+        if (nbTrials > 0 && nbTrials < m_requiredTrials) {
+          m_requiredTrials = nbTrials;
+        }
+      }
+    }
+  }
+  unlock();
+}
+
+void vpRansacScheduler::lock()
+{
+#if defined(VP_RANSAC_SCHEDULER_MUTEX)
+  m_mutex.lock();
+#endif
+}
+
+void vpRansacScheduler::unlock()
+{
+#if defined(VP_RANSAC_SCHEDULER_MUTEX)
+  m_mutex.unlock();
+#endif
+}
@@ -53,11 +53,49 @@
 #include <stdlib.h>
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
+#include <algorithm> // std::nth_element
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
 
 #define vpITMAX 100
 #define vpEPS 3.0e-7
 #define vpCST 1
 
+namespace {
+#if VISP_HAVE_SSE2
+  // Mask clearing the sign bit of two doubles
+  inline __m128d absMask()
+  {
+    return _mm_castsi128_pd(_mm_set_epi32(0x7fffffff, (int)0xffffffff, 0x7fffffff, (int)0xffffffff));
+  }
+
+  // mask ? a : b
+  inline __m128d blend(const __m128d &mask, const __m128d &a, const __m128d &b)
+  {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+  }
+#endif
+
+  // dst[i] = |src[i] - med|
+  void absDiff(const double *src, const double med, double *dst, const unsigned int n)
+  {
+    unsigned int i = 0;
+#if VISP_HAVE_SSE2
+    const __m128d v_med = _mm_set_pd(med, med);
+    const __m128d v_abs = absMask();
+    for (; i + 2 <= n; i += 2) {
+      _mm_storeu_pd(dst + i, _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(src + i), v_med), v_abs));
+    }
+#endif
+    for (; i < n; i++) {
+      dst[i] = fabs(src[i] - med);
+    }
+  }
+}
+
 
 // ===================================================================
 /*!
@@ -66,7 +104,8 @@
 
 */
 vpRobust::vpRobust(unsigned int n_data)
-  : normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(n_data)
+  : normres(), sorted_normres(), sorted_residues(), normres_all(), medianApproxMinSize(0), medianHistogram(),
+    NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(n_data)
 {
   vpCDEBUG(2) << "vpRobust constructor reached" << std::endl;
 
@@ -80,7 +119,8 @@ vpRobust::vpRobust(unsigned int n_data)
   Default constructor.
 */
 vpRobust::vpRobust()
-  : normres(), sorted_normres(), sorted_residues(), NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(0)
+  : normres(), sorted_normres(), sorted_residues(), normres_all(), medianApproxMinSize(0), medianHistogram(),
+    NoiseThreshold(0.0017), sig_prev(0), it(0), swap(0), size(0)
 {
 }
 
@@ -100,6 +140,9 @@ vpRobust & vpRobust::operator=(const vpRobust &other)
   normres = other.normres;
   sorted_normres = other.sorted_normres;
   sorted_residues = other.sorted_residues;
+  normres_all = other.normres_all;
+  medianApproxMinSize = other.medianApproxMinSize;
+  medianHistogram = other.medianHistogram;
   NoiseThreshold = other.NoiseThreshold;
   sig_prev = other.sig_prev;
   it = other.it;
@@ -117,6 +160,9 @@ vpRobust & vpRobust::operator=(const vpRobust &&other)
   normres = std::move(other.normres);
   sorted_normres = std::move(other.sorted_normres);
   sorted_residues = std::move(other.sorted_residues);
+  normres_all = std::move(other.normres_all);
+  medianApproxMinSize = std::move(other.medianApproxMinSize);
+  medianHistogram = std::move(other.medianHistogram);
   NoiseThreshold = std::move(other.NoiseThreshold);
   sig_prev = std::move(other.sig_prev);
   it = std::move(other.it);
@@ -191,25 +237,22 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
   // resize vector only if the size of residue vector has changed
   unsigned int n_data = residues.getRows();
   resize(n_data); 
-  
-  sorted_residues = residues;
-  
-  unsigned int ind_med = (unsigned int)(ceil(n_data/2.0))-1;
+  if (n_data == 0)
+    return;
+
+  // Selection is done in place, on a copy kept in the preallocated scratch vector
+  memcpy(sorted_residues.data, residues.data, n_data*sizeof(double));
 
   // Calculate median
-  med = select(sorted_residues, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  med = selectMedian(sorted_residues.data, n_data);
    //residualMedian = med ;
 
   // Normalize residues
-  for(unsigned int i=0; i<n_data; i++)
-  {
-    normres[i] = (fabs(residues[i]- med));
-    sorted_normres[i] = (fabs(sorted_residues[i]- med));
-
-  }
+  absDiff(residues.data, med, normres.data, n_data);
+  memcpy(sorted_normres.data, normres.data, n_data*sizeof(double));
 
   // Calculate MAD
-  normmedian = select(sorted_normres, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  normmedian = selectMedian(sorted_normres.data, n_data);
   //normalizedResidualMedian = normmedian ;
   // 1.48 keeps scale estimate consistent for a normal probability dist.
   sigma = 1.4826*normmedian; // median Absolute Deviation
@@ -262,10 +305,10 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
   double sigma=0;// Standard Deviation
 
   unsigned int n_all_data = all_residues.getRows();
-  vpColVector all_normres(n_all_data); 
+  normres_all.resize(n_all_data, false);
 
-  // compute median with the residues vector, return all_normres which are the normalized all_residues vector.
-  normmedian = computeNormalizedMedian(all_normres,residues,all_residues,weights);
+  // compute median with the residues vector, return normres_all which are the normalized all_residues vector.
+  normmedian = computeNormalizedMedian(normres_all,residues,all_residues,weights);
 
 
   // 1.48 keeps scale estimate consistent for a normal probability dist.
@@ -283,7 +326,7 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
   {
   case TUKEY :
     {
-      psiTukey(sigma, all_normres,weights);
+      psiTukey(sigma, normres_all,weights);
 
       vpCDEBUG(2) << "Tukey's function computed" << std::endl;
       break ;
@@ -291,7 +334,7 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
     }
   case CAUCHY :
     {
-      psiCauchy(sigma, all_normres,weights);
+      psiCauchy(sigma, normres_all,weights);
       break ;
     }
     /*  case MCLURE :
@@ -301,7 +344,7 @@ void vpRobust::MEstimator(const vpRobustEstimatorType method,
       }*/
   case HUBER :
     {
-      psiHuber(sigma, all_normres,weights);
+      psiHuber(sigma, normres_all,weights);
       break ;
     }
 
@@ -325,57 +368,33 @@ double vpRobust::computeNormalizedMedian(vpColVector &all_normres,
   
   // resize vector only if the size of residue vector has changed
   resize(n_data);
-    
-  sorted_residues = residues;
-  vpColVector no_null_weight_residues;
-  no_null_weight_residues.resize(n_data);
-  
-  //all_normres.resize(n_all_data); // Normalized Residue
-  //vpColVector sorted_normres(n_data); // Normalized Residue
-  //vpColVector sorted_residues = residues;
-  //vpColVector sorted_residues;
-  
 
+  // Be careful to not use the rejected residues for the
+  // calculation.
   unsigned int index =0;
   for(unsigned int j=0;j<n_data;j++)
   {
     //if(weights[j]!=0)
     if(std::fabs(weights[j]) > std::numeric_limits<double>::epsilon())
     {
-      no_null_weight_residues[index]=residues[j];
+      sorted_residues[index]=residues[j];
       index++;
     }
   }
-  sorted_residues.resize(index);
-  memcpy(sorted_residues.data,no_null_weight_residues.data,index*sizeof(double));
   n_data=index;
 
   vpCDEBUG(2) << "vpRobust MEstimator reached. No. data = " << n_data
 	      << std::endl;
 
   // Calculate Median
-  // Be careful to not use the rejected residues for the
-  // calculation.
-  
-  unsigned int ind_med = (unsigned int)(ceil(n_data/2.0))-1;
-  med = select(sorted_residues, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  med = selectMedian(sorted_residues.data, n_data);
 
-  unsigned int i;
   // Normalize residues
-  for(i=0; i<n_all_data; i++)
-  {
-    all_normres[i] = (fabs(all_residues[i]- med));
-  }
+  absDiff(all_residues.data, med, all_normres.data, n_all_data);
+  absDiff(sorted_residues.data, med, sorted_normres.data, n_data);
 
-  for(i=0; i<n_data; i++)
-  {
-    sorted_normres[i] = (fabs(sorted_residues[i]- med));
-  }
   // MAD calculated only on first iteration
-
-  //normmedian = Median(normres, weights);
-  //normmedian = Median(normres);
-  normmedian = select(sorted_normres, 0, (int)n_data-1, (int)ind_med/*(int)n_data/2*/);
+  normmedian = selectMedian(sorted_normres.data, n_data);
 
   return normmedian;
 }
@@ -675,8 +694,31 @@ void vpRobust::psiTukey(double sig, vpColVector &x, vpColVector & weights)
 
   unsigned int n_data = x.getRows();
   double cst_const = vpCST*4.6851;
+  unsigned int i=0;
 
-  for(unsigned int i=0; i<n_data; i++)
+#if VISP_HAVE_SSE2
+  if(std::fabs(sig) > std::numeric_limits<double>::epsilon())
+  {
+    const __m128d v_sig = _mm_set_pd(sig, sig);
+    const __m128d v_cst = _mm_set_pd(cst_const, cst_const);
+    const __m128d v_eps = _mm_set_pd(std::numeric_limits<double>::epsilon(), std::numeric_limits<double>::epsilon());
+    const __m128d v_one = _mm_set_pd(1.0, 1.0);
+    const __m128d v_abs = absMask();
+    for(; i+2<=n_data; i+=2)
+    {
+      const __m128d v_w = _mm_loadu_pd(weights.data+i);
+      const __m128d v_xi_sig = _mm_div_pd(_mm_loadu_pd(x.data+i), v_sig);
+      const __m128d v_inlier = _mm_and_pd(_mm_cmple_pd(_mm_and_pd(v_xi_sig, v_abs), v_cst),
+                                          _mm_cmpgt_pd(_mm_and_pd(v_w, v_abs), v_eps));
+      const __m128d v_r = _mm_div_pd(v_xi_sig, v_cst);
+      const __m128d v_t = _mm_sub_pd(v_one, _mm_mul_pd(v_r, v_r));
+      // Outliers get a null weight
+      _mm_storeu_pd(weights.data+i, _mm_and_pd(v_inlier, _mm_mul_pd(v_t, v_t)));
+    }
+  }
+#endif
+
+  for(; i<n_data; i++)
   {
     //if(sig==0 && weights[i]!=0)
     if(std::fabs(sig) <= std::numeric_limits<double>::epsilon() && std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
@@ -712,8 +754,25 @@ void vpRobust::psiHuber(double sig, vpColVector &x, vpColVector &weights)
 {
   double c = 1.2107; //1.345;
   unsigned int n_data = x.getRows();
+  unsigned int i=0;
+
+#if VISP_HAVE_SSE2
+  const __m128d v_sig = _mm_set_pd(sig, sig);
+  const __m128d v_c = _mm_set_pd(c, c);
+  const __m128d v_eps = _mm_set_pd(std::numeric_limits<double>::epsilon(), std::numeric_limits<double>::epsilon());
+  const __m128d v_one = _mm_set_pd(1.0, 1.0);
+  const __m128d v_abs = absMask();
+  for(; i+2<=n_data; i+=2)
+  {
+    const __m128d v_w = _mm_loadu_pd(weights.data+i);
+    const __m128d v_abs_xi_sig = _mm_and_pd(_mm_div_pd(_mm_loadu_pd(x.data+i), v_sig), v_abs);
+    const __m128d v_huber = blend(_mm_cmple_pd(v_abs_xi_sig, v_c), v_one, _mm_div_pd(v_c, v_abs_xi_sig));
+    // Rejected data keep their null weight
+    _mm_storeu_pd(weights.data+i, blend(_mm_cmpgt_pd(_mm_and_pd(v_w, v_abs), v_eps), v_huber, v_w));
+  }
+#endif
 
-  for(unsigned int i=0; i<n_data; i++)
+  for(; i<n_data; i++)
   {
     //if(weights[i]!=0)
     if(std::fabs(weights[i]) > std::numeric_limits<double>::epsilon())
@@ -739,9 +798,20 @@ void vpRobust::psiCauchy(double sig, vpColVector &x, vpColVector &weights)
 {
   unsigned int n_data = x.getRows();
   double const_sig = 2.3849*sig;
+  unsigned int i=0;
+
+#if VISP_HAVE_SSE2
+  const __m128d v_const_sig = _mm_set_pd(const_sig, const_sig);
+  const __m128d v_one = _mm_set_pd(1.0, 1.0);
+  for(; i+2<=n_data; i+=2)
+  {
+    const __m128d v_r = _mm_div_pd(_mm_loadu_pd(x.data+i), v_const_sig);
+    _mm_storeu_pd(weights.data+i, _mm_div_pd(v_one, _mm_add_pd(v_one, _mm_mul_pd(v_r, v_r))));
+  }
+#endif
 
   //Calculate Cauchy's equation
-  for(unsigned int i=0; i<n_data; i++)
+  for(; i<n_data; i++)
   {
     weights[i] = 1/(1+vpMath::sqr(x[i]/(const_sig)));
 
@@ -837,6 +907,76 @@ vpRobust::select(vpColVector &a, int l, int r, int k)
   return a[(unsigned int)k];
 }
 
+/*!
+  \brief Select the median of a set of values
+  \param a : pointer to the values, that are reordered
+  \param n : number of values
+  \return the value of rank ceil(n/2)-1, or an approximation of it (see
+  setMedianApproximation())
+*/
+double
+vpRobust::selectMedian(double *a, unsigned int n)
+{
+  if (n == 0)
+    return 0;
+
+  unsigned int k = (n+1)/2 - 1;
+  if (medianApproxMinSize > 0 && n >= medianApproxMinSize)
+    return selectApprox(a, n, k);
+
+  std::nth_element(a, a+k, a+n);
+  return a[k];
+}
+
+/*!
+  \brief Approximate the value of rank k with two successive histograms. The
+  first one locates the bin containing the rank k over the range of the
+  values, the second one refines this bin.
+  \param a : pointer to the values
+  \param n : number of values
+  \param k : rank of the value to approximate
+*/
+double
+vpRobust::selectApprox(const double *a, unsigned int n, unsigned int k)
+{
+  const unsigned int nbBins = 1024;
+  medianHistogram.resize(nbBins);
+
+  double lo = a[0], hi = a[0];
+  for (unsigned int i = 1; i < n; i++) {
+    if (a[i] < lo) lo = a[i];
+    else if (a[i] > hi) hi = a[i];
+  }
+
+  unsigned int rank = k;
+  for (unsigned int level = 0; level < 2; level++) {
+    double width = hi - lo;
+    if (! (width > 0))
+      return lo;
+
+    std::fill(medianHistogram.begin(), medianHistogram.end(), 0);
+    const double scale = nbBins / width;
+    for (unsigned int i = 0; i < n; i++) {
+      if (a[i] >= lo && a[i] <= hi) {
+        unsigned int bin = (unsigned int)((a[i]-lo)*scale);
+        medianHistogram[bin < nbBins ? bin : nbBins-1] ++;
+      }
+    }
+
+    unsigned int bin = 0;
+    while (bin < nbBins-1 && rank >= medianHistogram[bin]) {
+      rank -= medianHistogram[bin];
+      bin ++;
+    }
+
+    width /= nbBins;
+    lo += bin * width;
+    hi = lo + width;
+  }
+
+  return 0.5*(lo + hi);
+}
+
 
 #if !defined(VISP_HAVE_FUNC_ERFC) && !defined(VISP_HAVE_FUNC_STD_ERFC)
 double
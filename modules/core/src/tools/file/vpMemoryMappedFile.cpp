@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * File mapped in memory with a private copy-on-write mapping.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpMemoryMappedFile.cpp
+  \brief File mapped in memory with a private copy-on-write mapping.
+*/
+
+#include <fstream>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VISP_HAVE_MMAP 1
+#elif defined(_WIN32) && !defined(WINRT)
+#  include <windows.h>
+#  define VISP_HAVE_MAP_VIEW_OF_FILE 1
+#endif
+
+/*!
+  Default constructor: no file is open.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile()
+  : m_data(NULL), m_size(0), m_isOpen(false), m_isMapped(false), m_buffer()
+#if defined(_WIN32)
+  , m_mapping(NULL)
+#endif
+{
+}
+
+/*!
+  Map a file in memory.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file can not be opened or mapped.
+*/
+vpMemoryMappedFile::vpMemoryMappedFile(const std::string &filename)
+  : m_data(NULL), m_size(0), m_isOpen(false), m_isMapped(false), m_buffer()
+#if defined(_WIN32)
+  , m_mapping(NULL)
+#endif
+{
+  open(filename);
+}
+
+/*!
+  Destructor that unmaps the file.
+*/
+vpMemoryMappedFile::~vpMemoryMappedFile()
+{
+  close();
+}
+
+/*!
+  Unmap the file. The pointers returned by getData() are no more valid.
+*/
+void vpMemoryMappedFile::close()
+{
+  if (m_isMapped) {
+#if defined(VISP_HAVE_MMAP)
+    munmap(m_data, m_size);
+#elif defined(VISP_HAVE_MAP_VIEW_OF_FILE)
+    UnmapViewOfFile(m_data);
+    CloseHandle((HANDLE) m_mapping);
+    m_mapping = NULL;
+#endif
+  }
+  std::vector<unsigned char>().swap(m_buffer);
+  m_data = NULL;
+  m_size = 0;
+  m_isOpen = false;
+  m_isMapped = false;
+}
+
+/*!
+  Map a file in memory, after closing the previous one.
+
+  \param filename : Name of the file.
+
+  \exception vpException::ioError : If the file can not be opened or mapped.
+*/
+void vpMemoryMappedFile::open(const std::string &filename)
+{
+  close();
+
+#if defined(VISP_HAVE_MMAP)
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw vpException(vpException::ioError, "Cannot open file: %s", filename.c_str());
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw vpException(vpException::ioError, "Cannot get the size of file: %s", filename.c_str());
+  }
+  size_t size = (size_t) st.st_size;
+  if (size > 0) {
+    // Private mapping: the pages written in memory are copied, the file is not modified
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      throw vpException(vpException::ioError, "Cannot map file: %s", filename.c_str());
+    }
+    m_data = (unsigned char *) data;
+    m_isMapped = true;
+  }
+  // The mapping stays valid once the file is closed
+  ::close(fd);
+  m_size = size;
+  m_isOpen = true;
+
+#elif defined(VISP_HAVE_MAP_VIEW_OF_FILE)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw vpException(vpException::ioError, "Cannot open file: %s", filename.c_str());
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    throw vpException(vpException::ioError, "Cannot get the size of file: %s", filename.c_str());
+  }
+  if (size.QuadPart > 0) {
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void *data = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (data == NULL) {
+      if (mapping != NULL)
+        CloseHandle(mapping);
+      CloseHandle(file);
+      throw vpException(vpException::ioError, "Cannot map file: %s", filename.c_str());
+    }
+    m_mapping = mapping;
+    m_data = (unsigned char *) data;
+    m_isMapped = true;
+  }
+  CloseHandle(file);
+  m_size = (size_t) size.QuadPart;
+  m_isOpen = true;
+
+#else
+  std::ifstream file(filename.c_str(), std::ifstream::binary);
+  if (!file.is_open()) {
+    throw vpException(vpException::ioError, "Cannot open file: %s", filename.c_str());
+  }
+  file.seekg(0, std::ios::end);
+  size_t size = (size_t) file.tellg();
+  file.seekg(0, std::ios::beg);
+  if (size > 0) {
+    // Align the data on 64 bytes as a mapping would be
+    m_buffer.resize(size + 63);
+    size_t offset = (64 - ((size_t) &m_buffer[0]) % 64) % 64;
+    m_data = &m_buffer[offset];
+    if (!file.read((char *) m_data, (std::streamsize) size)) {
+      close();
+      throw vpException(vpException::ioError, "Cannot read file: %s", filename.c_str());
+    }
+  }
+  m_size = size;
+  m_isOpen = true;
+#endif
+}
@@ -45,92 +45,142 @@
 */
 
 #include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 #include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpDisplay.h>
 
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-#include <visp3/core/vpThread.h>
+#include <visp3/core/vpThreadPool.h>
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
 namespace {
-  struct Histogram_Param_t {
-    unsigned int m_start_index;
-    unsigned int m_end_index;
-
-    unsigned int m_lut[256];
-    unsigned int *m_histogram;
-    const vpImage<unsigned char> *m_I;
-
-    Histogram_Param_t() : m_start_index(0), m_end_index(0), m_lut(), m_histogram(NULL), m_I(NULL) {
-    }
-
-    Histogram_Param_t(const unsigned int start_index, const unsigned int end_index,
-        const vpImage<unsigned char> * const I) :
-      m_start_index(start_index), m_end_index(end_index), m_lut(), m_histogram(NULL), m_I(I) {
+  // Up to this number of bins, the pixels are counted in interleaved sub-histograms. Neighbouring pixels often
+  // have the same value and incrementing the same counter twice in a row waits for the first increment to be
+  // stored; consecutive pixels go to different sub-histograms instead.
+  const unsigned int vpHistogramMaxInterleavedBins = 1024;
+  const unsigned int vpHistogramNbInterleaved = 4;
+
+  // Partial histograms of blocks of consecutive rows of the region of interest, one block per thread
+  template <class Type>
+  class vpHistogramBody : public vpParallelLoopBody {
+  public:
+    vpHistogramBody(const vpImage<Type> &I, const vpImage<bool> *mask, unsigned int top, unsigned int bottom,
+                    unsigned int left, unsigned int right, const std::vector<unsigned int> &lut, unsigned int nbBlocks,
+                    unsigned int nbSubHistograms, unsigned int nbBins, std::vector<unsigned int> &histograms) :
+      m_I(I), m_mask(mask), m_top(top), m_bottom(bottom), m_left(left), m_right(right), m_lut(lut),
+      m_nbBlocks(nbBlocks), m_nbSubHistograms(nbSubHistograms), m_nbBins(nbBins), m_histograms(histograms) {
     }
 
-    ~Histogram_Param_t() {
-      if(m_histogram != NULL) {
-        delete []m_histogram;
+    void operator()(unsigned int start, unsigned int end) const {
+      const unsigned int *lut = &m_lut[0];
+      unsigned int nbRows = m_bottom - m_top;
+
+      for(unsigned int block = start; block < end; block++) {
+        unsigned int start_row = m_top + (unsigned int) ((unsigned long long) nbRows * block / m_nbBlocks);
+        unsigned int end_row = m_top + (unsigned int) ((unsigned long long) nbRows * (block+1) / m_nbBlocks);
+
+        unsigned int *h0 = &m_histograms[block * m_nbSubHistograms * m_nbBins];
+        unsigned int *h1 = h0 + (m_nbSubHistograms > 1 ? m_nbBins : 0);
+        unsigned int *h2 = h0 + (m_nbSubHistograms > 1 ? 2 * m_nbBins : 0);
+        unsigned int *h3 = h0 + (m_nbSubHistograms > 1 ? 3 * m_nbBins : 0);
+
+        for(unsigned int i = start_row; i < end_row; i++) {
+          const Type *ptrCurrent = m_I[i] + m_left;
+          const Type *ptrEnd = m_I[i] + m_right;
+
+          if(m_mask == NULL) {
+            for(; ptrEnd - ptrCurrent >= 4; ptrCurrent += 4) {
+              h0[ lut[ ptrCurrent[0] ] ] ++;
+              h1[ lut[ ptrCurrent[1] ] ] ++;
+              h2[ lut[ ptrCurrent[2] ] ] ++;
+              h3[ lut[ ptrCurrent[3] ] ] ++;
+            }
+            for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
+              h0[ lut[ *ptrCurrent ] ] ++;
+            }
+          } else {
+            // Adding the mask value avoids a branch per pixel
+            const bool *ptrMask = (*m_mask)[i] + m_left;
+            for(; ptrEnd - ptrCurrent >= 4; ptrCurrent += 4, ptrMask += 4) {
+              h0[ lut[ ptrCurrent[0] ] ] += ptrMask[0] ? 1 : 0;
+              h1[ lut[ ptrCurrent[1] ] ] += ptrMask[1] ? 1 : 0;
+              h2[ lut[ ptrCurrent[2] ] ] += ptrMask[2] ? 1 : 0;
+              h3[ lut[ ptrCurrent[3] ] ] += ptrMask[3] ? 1 : 0;
+            }
+            for(; ptrCurrent != ptrEnd; ++ptrCurrent, ++ptrMask) {
+              h0[ lut[ *ptrCurrent ] ] += *ptrMask ? 1 : 0;
+            }
+          }
+        }
       }
     }
-  };
-
-  vpThread::Return computeHistogramThread(vpThread::Args args) {
-    Histogram_Param_t *histogram_param = static_cast<Histogram_Param_t *>(args);
-    unsigned int start_index = histogram_param->m_start_index;
-    unsigned int end_index = histogram_param->m_end_index;
-
-    const vpImage<unsigned char> *I = histogram_param->m_I;
-
-    unsigned char *ptrStart = (unsigned char*) (I->bitmap) + start_index;
-    unsigned char *ptrEnd = (unsigned char*) (I->bitmap) + end_index;
-    unsigned char *ptrCurrent = ptrStart;
-
-
-//    while(ptrCurrent != ptrEnd) {
-//      histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-//      ++ptrCurrent;
-//    }
-
-    if(end_index - start_index >= 8) {
-      //Unroll loop version
-      for(; ptrCurrent <= ptrEnd - 8;) {
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
-
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
-
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+  private:
+    const vpImage<Type> &m_I;
+    const vpImage<bool> *m_mask;
+    unsigned int m_top, m_bottom, m_left, m_right;
+    const std::vector<unsigned int> &m_lut;
+    unsigned int m_nbBlocks;
+    unsigned int m_nbSubHistograms;
+    unsigned int m_nbBins;
+    std::vector<unsigned int> &m_histograms;
+  };
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+  // Histogram of the pixels of I in the roi (the whole image when NULL) for which the mask (when not NULL) is true.
+  // The nbLevels pixel values are gathered in nbBins bins of the same width.
+  template <class Type>
+  void computeHistogram(const vpImage<Type> &I, const vpImage<bool> *mask, const vpRect *roi, unsigned int nbLevels,
+                        unsigned int nbBins, unsigned int nbThreads, unsigned int *histogram)
+  {
+    memset(histogram, 0, nbBins * sizeof(unsigned int));
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+    if(mask != NULL && (mask->getHeight() != I.getHeight() || mask->getWidth() != I.getWidth())) {
+      throw vpException(vpException::dimensionError, "The mask (%dx%d) and the image (%dx%d) have different sizes",
+                        mask->getWidth(), mask->getHeight(), I.getWidth(), I.getHeight());
+    }
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
+    int top = 0, left = 0, bottom = (int) I.getHeight(), right = (int) I.getWidth();
+    if(roi != NULL) {
+      top = std::max((int) ceil(roi->getTop()), 0);
+      left = std::max((int) ceil(roi->getLeft()), 0);
+      bottom = std::min((int) ceil(roi->getTop() + roi->getHeight()), bottom);
+      right = std::min((int) ceil(roi->getLeft() + roi->getWidth()), right);
+    }
+    if(top >= bottom || left >= right) {
+      return;
+    }
 
-        histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
-        ++ptrCurrent;
-      }
+    std::vector<unsigned int> lut(nbLevels);
+    for(unsigned int i = 0; i < nbLevels; i++) {
+      lut[i] = (unsigned int) ((unsigned long long) i * nbBins / nbLevels);
     }
 
-    for(; ptrCurrent != ptrEnd; ++ptrCurrent) {
-      histogram_param->m_histogram[ histogram_param->m_lut[ *ptrCurrent ] ] ++;
+    unsigned int nbBlocks = (nbThreads == vpThreadPool::poolConcurrency) ? vpThreadPool::getConcurrency()
+                                                                         : std::max(nbThreads, 1u);
+    nbBlocks = std::min(nbBlocks, (unsigned int) (bottom - top));
+    unsigned int nbSubHistograms = (nbBins <= vpHistogramMaxInterleavedBins) ? vpHistogramNbInterleaved : 1;
+
+    std::vector<unsigned int> histograms(nbBlocks * nbSubHistograms * nbBins, 0);
+    vpHistogramBody<Type> body(I, mask, (unsigned int) top, (unsigned int) bottom, (unsigned int) left,
+                               (unsigned int) right, lut, nbBlocks, nbSubHistograms, nbBins, histograms);
+    if(nbBlocks == 1) {
+      body(0, 1);
+    } else {
+      vpThreadPool::parallelFor(0, nbBlocks, body, nbBlocks, 1);
     }
 
-    return 0;
+    for(unsigned int sub = 0; sub < nbBlocks * nbSubHistograms; sub++) {
+      const unsigned int *partial = &histograms[sub * nbBins];
+      for(unsigned int cpt = 0; cpt < nbBins; cpt++) {
+        histogram[cpt] += partial[cpt];
+      }
+    }
   }
 }
-#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 bool compare_vpHistogramPeak (vpHistogramPeak first, vpHistogramPeak second);
 
@@ -146,7 +196,7 @@ bool compare_vpHistogramPeak (vpHistogramPeak first, vpHistogramPeak second)
 /*!
   Defaut constructor for a gray level histogram.
 */
-vpHistogram::vpHistogram() : histogram(NULL), size(256)
+vpHistogram::vpHistogram() : histogram(NULL), size(256), mask(NULL)
 {
   init();
 }
@@ -154,7 +204,7 @@ vpHistogram::vpHistogram() : histogram(NULL), size(256)
 /*!
   Copy constructor of a gray level histogram.
 */
-vpHistogram::vpHistogram(const vpHistogram &h)  : histogram(NULL), size(256)
+vpHistogram::vpHistogram(const vpHistogram &h)  : histogram(NULL), size(256), mask(h.mask)
 {
   init(h.size);
   memcpy(histogram, h.histogram, size * sizeof(unsigned));
@@ -168,7 +218,7 @@ vpHistogram::vpHistogram(const vpHistogram &h)  : histogram(NULL), size(256)
   \sa calculate()
 */
 vpHistogram::vpHistogram(const vpImage<unsigned char> &I)
- : histogram(NULL), size(256)
+ : histogram(NULL), size(256), mask(NULL)
 {
   init();
 
@@ -206,6 +256,7 @@ vpHistogram::operator=(const vpHistogram &h)
 {
   init(h.size);
   memcpy(histogram, h.histogram, size * sizeof(unsigned));
+  mask = h.mask;
 
   return *this;
 }
@@ -232,117 +283,223 @@ vpHistogram::init(unsigned size_)
 }
 
 
+/*!
+  Resize the histogram to \e nbins bins, or to \e maxBins bins when \e nbins is 0 or greater than \e maxBins.
+*/
+void
+vpHistogram::resize(const unsigned int nbins, const unsigned int maxBins)
+{
+  unsigned int size_ = nbins > maxBins ? maxBins : (nbins > 0 ? nbins : maxBins);
+  if(nbins > maxBins || nbins == 0) {
+    std::cerr << "nbins=" << nbins << " , nbins should be between ]0 ; " << maxBins << "] ; use by default nbins="
+              << maxBins << std::endl;
+  }
+
+  if(histogram == NULL || size != size_) {
+    init(size_);
+  }
+}
+
 /*!
 
   Calculate the histogram from a gray level image.
 
+  The pixels are counted in several interleaved histograms, which avoids
+  waiting for the increment of the counter of the previous pixel in uniform
+  areas. When a mask is set with setMask(), only the pixels where the mask
+  is true are counted.
+
   \param I : Gray level image.
   \param nbins : Number of bins to compute the histogram.
-  \param nbThreads : Number of threads to use for the computation.
+  \param nbThreads : Number of threads to use for the computation. 0 or 1 means that the calling thread does the
+  computation, vpThreadPool::poolConcurrency uses vpThreadPool::getConcurrency() threads of the pool.
 */
 void vpHistogram::calculate(const vpImage<unsigned char> &I, const unsigned int nbins, const unsigned int nbThreads)
 {
-  if(size != nbins) {
-    if (histogram != NULL) {
-      delete [] histogram;
-      histogram = NULL;
-    }
+  resize(nbins, 256);
+  computeHistogram(I, mask, NULL, 256, size, nbThreads, histogram);
+}
 
-    size = nbins > 256 ? 256 : (nbins > 0 ? nbins : 256);
-    if(nbins > 256 || nbins == 0) {
-      std::cerr << "nbins=" << nbins << " , nbins should be between ]0 ; 256] ; use by default nbins=256" << std::endl;
-    }
-    histogram = new unsigned int[size];
-  }
+/*!
 
-  memset(histogram, 0, size * sizeof(unsigned int));
+  Calculate the histogram of a region of interest of a gray level image.
 
+  \param I : Gray level image.
+  \param roi : Region of interest. The part of the region outside the image is ignored.
+  \param nbins : Number of bins to compute the histogram.
+  \param nbThreads : Number of threads to use for the computation. 0 or 1 means that the calling thread does the
+  computation, vpThreadPool::poolConcurrency uses vpThreadPool::getConcurrency() threads of the pool.
 
-  bool use_single_thread;
-#if !defined(VISP_HAVE_PTHREAD) && !defined(_WIN32)
-  use_single_thread = true;
-#else
-  use_single_thread = (nbThreads == 0 || nbThreads == 1);
-#endif
+  \sa calculate(const vpImage<unsigned char> &, const unsigned int, const unsigned int)
+*/
+void vpHistogram::calculate(const vpImage<unsigned char> &I, const vpRect &roi, const unsigned int nbins,
+                            const unsigned int nbThreads)
+{
+  resize(nbins, 256);
+  computeHistogram(I, mask, &roi, 256, size, nbThreads, histogram);
+}
 
-  if(!use_single_thread && I.getSize() <= nbThreads) {
-    use_single_thread = true;
-  }
+/*!
 
+  Calculate the histogram from a 16-bits image, like the depth images of
+  RGB-D sensors. With the default number of bins, each bin corresponds to
+  one value.
 
-  unsigned int lut[256];
-  for(unsigned int i = 0; i < 256; i++) {
-    lut[i] = (unsigned int) (i * size / 256.0);
-  }
+  \param I : 16-bits image.
+  \param nbins : Number of bins between 1 and 65536. The 65536 values are gathered in bins of the same width.
+  \param nbThreads : Number of threads to use for the computation. 0 or 1 means that the calling thread does the
+  computation, vpThreadPool::poolConcurrency uses vpThreadPool::getConcurrency() threads of the pool.
+*/
+void vpHistogram::calculate(const vpImage<uint16_t> &I, const unsigned int nbins, const unsigned int nbThreads)
+{
+  resize(nbins, 0x10000);
+  computeHistogram(I, mask, NULL, 0x10000, size, nbThreads, histogram);
+}
 
-  if(use_single_thread) {
-    //Single thread
+/*!
 
-    unsigned int size_ = I.getWidth()*I.getHeight();
-    unsigned char *ptrStart = (unsigned char*) I.bitmap;
-    unsigned char *ptrEnd = ptrStart + size_;
-    unsigned char *ptrCurrent = ptrStart;
+  Calculate the histogram of a region of interest of a 16-bits image.
 
-    while(ptrCurrent != ptrEnd) {
-      histogram[ lut[ *ptrCurrent ] ] ++;
-      ++ptrCurrent;
-    }
-  } else {
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-    //Multi-threads
+  \param I : 16-bits image.
+  \param roi : Region of interest. The part of the region outside the image is ignored.
+  \param nbins : Number of bins between 1 and 65536.
+  \param nbThreads : Number of threads to use for the computation. 0 or 1 means that the calling thread does the
+  computation, vpThreadPool::poolConcurrency uses vpThreadPool::getConcurrency() threads of the pool.
+*/
+void vpHistogram::calculate(const vpImage<uint16_t> &I, const vpRect &roi, const unsigned int nbins,
+                            const unsigned int nbThreads)
+{
+  resize(nbins, 0x10000);
+  computeHistogram(I, mask, &roi, 0x10000, size, nbThreads, histogram);
+}
 
-    std::vector<vpThread *> threadpool;
-    std::vector<Histogram_Param_t *> histogramParams;
+/*!
+  Return the number of pixels counted in the histogram, that is the sum of
+  its values.
+*/
+unsigned int vpHistogram::getTotal() const
+{
+  unsigned int total = 0;
+  for(unsigned int i = 0; i < size; i++) {
+    total += histogram[i];
+  }
+  return total;
+}
 
-    unsigned int image_size = I.getSize();
-    unsigned int step = image_size / nbThreads;
-    unsigned int last_step = image_size - step * (nbThreads-1);
+/*!
+  Compute the cumulative histogram: \e cumulative[i] is the number of
+  pixels in the bins 0 to i.
 
-    for(unsigned int index = 0; index < nbThreads; index++) {
-      unsigned int start_index = index*step;
-      unsigned int end_index = (index+1)*step;
+  \param cumulative : Cumulative histogram, resized to getSize().
+*/
+void vpHistogram::getCumulative(std::vector<unsigned int> &cumulative) const
+{
+  cumulative.resize(size);
+  unsigned int sum = 0;
+  for(unsigned int i = 0; i < size; i++) {
+    sum += histogram[i];
+    cumulative[i] = sum;
+  }
+}
 
-      if(index == nbThreads-1) {
-        end_index = start_index+last_step;
-      }
+/*!
+  Compute the threshold that separates the pixels in two classes with the
+  largest between-class variance (Otsu's method).
 
-      Histogram_Param_t *histogram_param = new Histogram_Param_t(start_index, end_index, &I);
-      histogram_param->m_histogram = new unsigned int[size];
-      memset(histogram_param->m_histogram, 0, size * sizeof(unsigned int));
-      memcpy(histogram_param->m_lut, lut, 256*sizeof(unsigned int));
+  \return The last bin of the first class. The pixels of the bins up to
+  the threshold belong to the first class, the others to the second class.
+  0 is returned when the histogram has less than two non empty bins.
 
-      histogramParams.push_back(histogram_param);
+  \code
+  vpImage<unsigned char> I;
+  ...
+  vpHistogram h(I);
+  unsigned char threshold = (unsigned char) h.getOtsuThreshold();
+  vpImageTools::binarise(I, threshold, (unsigned char) 255, (unsigned char) 0, (unsigned char) 255, (unsigned char) 255);
+  \endcode
+*/
+unsigned int vpHistogram::getOtsuThreshold() const
+{
+  double total = 0, sum = 0;
+  for(unsigned int i = 0; i < size; i++) {
+    total += histogram[i];
+    sum += (double) i * histogram[i];
+  }
 
-      // Start the threads
-      vpThread *histogram_thread = new vpThread((vpThread::Fn) computeHistogramThread, (vpThread::Args) histogram_param);
-      threadpool.push_back(histogram_thread);
+  unsigned int threshold = 0;
+  double w0 = 0, sum0 = 0, max_variance = -1;
+  for(unsigned int t = 0; t < size; t++) {
+    w0 += histogram[t];
+    sum0 += (double) t * histogram[t];
+    double w1 = total - w0;
+    if(w0 == 0) {
+      continue;
+    }
+    if(w1 == 0) {
+      break;
     }
 
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      // Wait until thread ends up
-      threadpool[cpt]->join();
+    double delta = sum0 / w0 - (sum - sum0) / w1;
+    double variance = w0 * w1 * delta * delta;
+    if(variance > max_variance) {
+      max_variance = variance;
+      threshold = t;
     }
+  }
 
-    for(unsigned int cpt1 = 0; cpt1 < size; cpt1++) {
-      unsigned int sum = 0;
+  return threshold;
+}
 
-      for(size_t cpt2 = 0; cpt2 < histogramParams.size(); cpt2++) {
-        sum += histogramParams[cpt2]->m_histogram[cpt1];
-      }
+/*!
+  Equalize a gray level image with the cumulative histogram, so that the
+  gray levels of the result are spread over [0, 255].
 
-      histogram[cpt1] = sum;
-    }
+  \param I : Image to equalize, whose histogram was computed with 256 bins.
+  When a mask or a region of interest was used, the gray levels of the
+  whole image are transformed with the histogram of the region.
+  \param Ieq : Equalized image.
+  \param nbThreads : Number of threads used to transform the image, see vpImage::performLut().
 
-    //Delete
-    for(size_t cpt = 0; cpt < threadpool.size(); cpt++) {
-      delete threadpool[cpt];
-    }
+  \exception vpException::dimensionError : If the histogram does not have 256 bins.
 
-    for(size_t cpt = 0; cpt < histogramParams.size(); cpt++) {
-      delete histogramParams[cpt];
+  \code
+  vpImage<unsigned char> I, Ieq;
+  ...
+  vpHistogram h;
+  h.calculate(I);
+  h.equalize(I, Ieq);
+  \endcode
+*/
+void vpHistogram::equalize(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ieq,
+                           const unsigned int nbThreads) const
+{
+  if(size != 256) {
+    throw vpException(vpException::dimensionError, "Cannot equalize an image with a histogram of %d bins", size);
+  }
+
+  std::vector<unsigned int> cumulative;
+  getCumulative(cumulative);
+
+  // Number of pixels of the first non empty bin, mapped to 0
+  unsigned int cumulative_min = 0;
+  for(unsigned int i = 0; i < size && cumulative_min == 0; i++) {
+    cumulative_min = cumulative[i];
+  }
+
+  unsigned char lut[256];
+  unsigned int range = cumulative[255] - cumulative_min;
+  for(unsigned int i = 0; i < 256; i++) {
+    if(range == 0) {
+      lut[i] = (unsigned char) i;
+    } else if(cumulative[i] <= cumulative_min) {
+      lut[i] = 0;
+    } else {
+      lut[i] = (unsigned char) vpMath::round((cumulative[i] - cumulative_min) * 255.0 / range);
     }
-#endif
   }
+
+  Ieq = I;
+  Ieq.performLut(lut, nbThreads);
 }
 
 /*!
@@ -203,6 +203,10 @@ bool vpClient::connectServer(vpNetwork::vpReceptor &serv)
     return false;
   }
   
+  // Small requests such as poses are sent without waiting to be grouped
+  int noDelay = 1;
+  setsockopt(serv.socketFileDescriptorReceptor, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+  
   receptor_list.push_back(serv);
 
 #ifdef SO_NOSIGPIPE
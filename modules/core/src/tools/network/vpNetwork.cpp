@@ -36,21 +36,83 @@
  *****************************************************************************/
 
 
+#include <algorithm>
+#include <limits.h>
+#include <errno.h>
+#include <stdint.h>
+
 #include <visp3/core/vpNetwork.h>
 
-vpNetwork::vpNetwork()
-  : emitter(), receptor_list(), readFileDescriptor(), socketMax(0), request_list(),
-    max_size_message(999999), separator("[*@*]"), beginning("[*start*]"), end("[*end*]"),
-    param_sep("[*|*]"), currentMessageReceived(), tv(), tv_sec(0), tv_usec(10),
-    verboseMode(false)
-{ 
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
+namespace {
+// Maximum number of buffers given to one sendmsg() call
+#if defined(IOV_MAX)
+const size_t maxNbSendBuffers = IOV_MAX;
 #else
-  tv.tv_usec = tv_usec;
+const size_t maxNbSendBuffers = 16; // Minimum value guaranteed by POSIX
 #endif
 
+// Sizes of the frames are 32 bits integers in network byte order
+void writeFrameSize(char *dst, const size_t &value)
+{
+  uint32_t v = htonl((uint32_t)value);
+  memcpy(dst, &v, sizeof(v));
+}
+
+size_t readFrameSize(const char *src)
+{
+  uint32_t v;
+  memcpy(&v, src, sizeof(v));
+  return (size_t)ntohl(v);
+}
+
+// End of the complete frames stored in buffer from start
+size_t endOfCompleteFrames(const std::vector<char> &buffer, size_t start, const size_t &end)
+{
+  while(end - start >= sizeof(uint32_t) && readFrameSize(&buffer[start]) <= end - start - sizeof(uint32_t))
+    start += sizeof(uint32_t) + readFrameSize(&buffer[start]);
+  return start;
+}
+
+// Add a buffer to send, merged with the previous one when they are contiguous
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+void addSendBuffer(std::vector<struct iovec> &buffers, const char *data, const size_t &size)
+{
+  if(size == 0)
+    return;
+  if(buffers.size() && (const char *)buffers.back().iov_base + buffers.back().iov_len == data){
+    buffers.back().iov_len += size;
+    return;
+  }
+  struct iovec buffer;
+  buffer.iov_base = const_cast<char *>(data);
+  buffer.iov_len = size;
+  buffers.push_back(buffer);
+}
+#else
+void addSendBuffer(std::vector<WSABUF> &buffers, const char *data, const size_t &size)
+{
+  if(size == 0)
+    return;
+  if(buffers.size() && buffers.back().buf + buffers.back().len == data){
+    buffers.back().len += (ULONG)size;
+    return;
+  }
+  WSABUF buffer;
+  buffer.buf = const_cast<char *>(data);
+  buffer.len = (ULONG)size;
+  buffers.push_back(buffer);
+}
+#endif
+}
+
+vpNetwork::vpNetwork()
+  : emitter(), receptor_list(), readableReceptors(), emitterReadable(false),
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+    pollFileDescriptors(),
+#endif
+    request_list(), max_size_message(999999), max_size_frame(128*1024*1024), sendHeader(), sendBuffers(), tv_sec(0), tv_usec(10),
+    verboseMode(false), disconnectedRequests(), receivedParameters(), receivedParameterSizes()
+{ 
 #if defined(_WIN32)
   //Enable the sockets to be used
   //Note that: if we were using "winsock.h" instead of "winsock2.h" we would had to use:
@@ -200,33 +262,52 @@ int vpNetwork::sendRequestTo(vpRequest &req, const unsigned int &dest)
     return 0;
   }
   
-  std::string message = beginning + req.getId() + separator;
+  // Header: frame size, id size, id, number of parameters, then the size of each parameter
+  const std::string &id = req.request_id;
+  const std::vector<std::string> &params = req.listOfParams;
+  const std::vector<std::pair<const char *, size_t> > &buffers = req.listOfBuffers;
+  size_t nbParams = params.size() + buffers.size();
+  size_t headerSize = 3*sizeof(uint32_t) + id.size();
+  size_t frameSize = headerSize - sizeof(uint32_t) + nbParams*sizeof(uint32_t);
+  for(unsigned int i = 0 ; i < params.size() ; i++)
+    frameSize += params[i].size();
+  for(unsigned int i = 0 ; i < buffers.size() ; i++)
+    frameSize += buffers[i].second;
+  
+  if(frameSize > 0xffffffffu)
+  {
+    if(verboseMode)
+      vpTRACE( "Cannot Send Request! Request too large" );
+    return -1;
+  }
   
-  if(req.size() != 0){
-    message += req[0];
-    
-    for(unsigned int i = 1 ; i < req.size() ; i++){
-        message += param_sep + req[i];
+  sendHeader.resize(headerSize + nbParams*sizeof(uint32_t));
+  char *header = &sendHeader[0];
+  writeFrameSize(header, frameSize);
+  writeFrameSize(header + sizeof(uint32_t), id.size());
+  if(id.size() != 0)
+    memcpy(header + 2*sizeof(uint32_t), id.c_str(), id.size());
+  writeFrameSize(header + headerSize - sizeof(uint32_t), nbParams);
+  
+  // The parameters are sent from where they are, without being copied
+  sendBuffers.resize(0);
+  addSendBuffer(sendBuffers, header, headerSize);
+  for(size_t i = 0 ; i < nbParams ; i++){
+    char *paramSize = header + headerSize + i*sizeof(uint32_t);
+    if(i < params.size()){
+      writeFrameSize(paramSize, params[i].size());
+      addSendBuffer(sendBuffers, paramSize, sizeof(uint32_t));
+      addSendBuffer(sendBuffers, params[i].data(), params[i].size());
+    }
+    else{
+      const std::pair<const char *, size_t> &buffer = buffers[i - params.size()];
+      writeFrameSize(paramSize, buffer.second);
+      addSendBuffer(sendBuffers, paramSize, sizeof(uint32_t));
+      addSendBuffer(sendBuffers, buffer.first, buffer.second);
     }
   }
   
-  message += end;
-  
-  int flags = 0;
-//#if ! defined(APPLE) && ! defined(SOLARIS) && ! defined(_WIN32)
-#if defined(__linux__)
-  flags = MSG_NOSIGNAL; // Only for Linux
-#endif
-
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-  int value = (int)sendto(receptor_list[dest].socketFileDescriptorReceptor, message.c_str(), message.size(), flags,
-                          (sockaddr*) &receptor_list[dest].receptorAddress,receptor_list[dest].receptorAddressSize);
-#else
-  int value = sendto((unsigned)receptor_list[dest].socketFileDescriptorReceptor, message.c_str(), (int)message.size(), flags,
-                     (sockaddr*) &receptor_list[dest].receptorAddress,receptor_list[dest].receptorAddressSize);
-#endif
-  
-  return value;
+  return _sendBuffers(dest);
 }
 
 /*!
@@ -330,6 +411,11 @@ std::vector<int> vpNetwork::receiveRequestFrom(const unsigned int &receptorEmitt
 */
 int vpNetwork::receiveRequestOnce()
 {
+  // A request may already have been received with the previous one
+  int index = _handleFirstRequest();
+  if(index != -1)
+    return index;
+  
   _receiveRequestOnce();
   return _handleFirstRequest();
 }
@@ -356,6 +442,10 @@ int vpNetwork::receiveRequestOnce()
 */
 int vpNetwork::receiveRequestOnceFrom(const unsigned int &receptorEmitting)
 {
+  int index = _handleFirstRequest();
+  if(index != -1)
+    return index;
+  
   _receiveRequestOnceFrom(receptorEmitting);
   return _handleFirstRequest();
 }
@@ -511,85 +601,209 @@ std::vector<int> vpNetwork::_handleRequests()
 */
 int vpNetwork::_handleFirstRequest()
 {
-  size_t indStart = currentMessageReceived.find(beginning);
-  size_t indSep = currentMessageReceived.find(separator);
-  size_t indEnd = currentMessageReceived.find(end);
+  int indRequest = _handleFirstRequestFrom(disconnectedRequests);
+  
+  for(unsigned int i = 0 ; i < receptor_list.size() && indRequest == -1 ; i++)
+    indRequest = _handleFirstRequestFrom(receptor_list[i]);
   
-  if (indStart == std::string::npos && indSep == std::string::npos && indEnd == std::string::npos)
+  return indRequest;
+}
+
+/*!
+  Handle the first complete request received from a receptor. The frames that
+  don't correspond to any request are skipped.
+  
+  \param receptor : Receptor whose receive buffer is read.
+  
+  \return : The index of the request that has been handled, -1 if there is no complete request.
+*/
+int vpNetwork::_handleFirstRequestFrom(vpReceptor &receptor)
+{
+  while(receptor.receiveEnd - receptor.receiveStart >= sizeof(uint32_t))
   {
-    if(currentMessageReceived.size() != 0)
-      currentMessageReceived.clear();
+    const char *frame = &receptor.receiveBuffer[receptor.receiveStart];
+    size_t frameSize = readFrameSize(frame);
+    if(frameSize > max_size_frame)
+    {
+      // Received before the maximum size was reduced: the frames that follow can't be trusted
+      if(verboseMode)
+        vpTRACE("Frame larger than the maximum size, the received data are dropped");
+      receptor.receiveStart = receptor.receiveEnd = 0;
+      return -1;
+    }
+    if(receptor.receiveEnd - receptor.receiveStart - sizeof(uint32_t) < frameSize)
+      return -1;
     
-    if(verboseMode)
-      vpTRACE("Incorrect message");
+    // The data are not moved: frame stays valid
+    receptor.receiveStart += sizeof(uint32_t) + frameSize;
+    if(receptor.receiveStart == receptor.receiveEnd)
+      receptor.receiveStart = receptor.receiveEnd = 0;
     
-    return -1;
+    int indRequest = _decodeFrame(frame + sizeof(uint32_t), frameSize);
+    if(indRequest != -1)
+      return indRequest;
   }
   
-  if(indStart == std::string::npos || indSep == std::string::npos || indEnd == std::string::npos)
-    return -1;
+  return -1;
+}
+
+/*!
+  Set the parameters of the request corresponding to a received frame.
   
-  if(indEnd < indStart)
-  {
-    if(verboseMode)
-      vpTRACE("Incorrect message");
-    currentMessageReceived.erase((unsigned)indStart,indEnd+end.size());
-    return -1;
-  }
+  \param frame : Frame, after its size.
+  \param frameSize : Size of the frame.
   
-  size_t indStart2 = currentMessageReceived.find(beginning,indStart+1);
-  if(indStart2 != std::string::npos && indStart2 < indEnd)
+  \return : The index of the request, -1 if the frame is incorrect or no request corresponds to it.
+*/
+int vpNetwork::_decodeFrame(const char *frame, const size_t &frameSize)
+{
+  if(frameSize < 2*sizeof(uint32_t) || readFrameSize(frame) > frameSize - 2*sizeof(uint32_t))
   {
     if(verboseMode)
       vpTRACE("Incorrect message");
-    currentMessageReceived.erase((unsigned)indStart,(unsigned)indStart2);
     return -1;
   }
   
-  size_t deb = indStart + beginning.size();
-  std::string id = currentMessageReceived.substr((unsigned)deb, indSep - deb);
+  size_t idSize = readFrameSize(frame);
+  const char *id = frame + sizeof(uint32_t);
+  size_t pos = sizeof(uint32_t) + idSize;
+  size_t nbParams = readFrameSize(frame + pos);
+  pos += sizeof(uint32_t);
   
-  //deb = indSep+separator.size();
-  //std::string params = currentMessageReceived.substr((unsigned)deb, (unsigned)(indEnd - deb));
+  // Check the sizes of the parameters before modifying the request
+  size_t end = pos;
+  for(size_t i = 0 ; i < nbParams ; i++)
+  {
+    if(frameSize - end < sizeof(uint32_t) || readFrameSize(frame + end) > frameSize - end - sizeof(uint32_t))
+    {
+      if(verboseMode)
+        vpTRACE("Incorrect message");
+      return -1;
+    }
+    end += sizeof(uint32_t) + readFrameSize(frame + end);
+  }
   
-//   std::cout << "Handling : " << currentMessageReceived.substr(indStart, indEnd+end.size() - indStart) << std::endl;
-   
-  int indRequest = 0;
-  bool hasBeenFound = false;
   for(unsigned int i = 0 ; i < request_list.size() ; i++)
   {
-    if(id == request_list[i]->getId()){
-        hasBeenFound = true;
-        request_list[i]->clear();
-        indRequest = (int)i;
-        break;
+    const std::string &requestId = request_list[i]->request_id;
+    if(requestId.size() == idSize && requestId.compare(0, idSize, id, idSize) == 0)
+    {
+      receivedParameters.resize(nbParams);
+      receivedParameterSizes.resize(nbParams);
+      for(size_t j = 0 ; j < nbParams ; j++)
+      {
+        receivedParameterSizes[j] = readFrameSize(frame + pos);
+        pos += sizeof(uint32_t);
+        receivedParameters[j] = frame + pos;
+        pos += receivedParameterSizes[j];
+      }
+      
+      if(!request_list[i]->receiveParameters(receivedParameters, receivedParameterSizes))
+      {
+        if(verboseMode)
+          vpTRACE("Incorrect parameters");
+        return -1;
+      }
+      return (int)i;
     }
   }
   
-  if(!hasBeenFound){
-    //currentMessageReceived.erase(indStart,indEnd+end.size());
-    if(verboseMode)
-      vpTRACE("No request corresponds to the received message");
-    return -1;
+  if(verboseMode)
+    vpTRACE("No request corresponds to the received message");
+  return -1;
+}
+
+/*!
+  Read the data available on the socket of a receptor at the end of its receive buffer.
+  The buffer is allocated with a size of max_size_message the first time, and is
+  compacted or enlarged when it is full. If the first incomplete frame is larger than
+  max_size_frame, the connection is reset and the socket closed.
+  
+  \param receptorIndex : Index of the receptor.
+  
+  \return The number of bytes received, 0 if the receptor has disconnected, -1 if an error occured
+  or if the frame is too large.
+*/
+int vpNetwork::_readReceptor(const unsigned int &receptorIndex)
+{
+  vpReceptor &receptor = receptor_list[receptorIndex];
+  std::vector<char> &buffer = receptor.receiveBuffer;
+  
+  if(receptor.receiveStart == receptor.receiveEnd)
+    receptor.receiveStart = receptor.receiveEnd = 0;
+  
+  if(buffer.size() == 0)
+    buffer.resize(max_size_message > 64 ? max_size_message : 64);
+  else if(receptor.receiveEnd == buffer.size())
+  {
+    if(receptor.receiveStart > 0){
+      memmove(&buffer[0], &buffer[receptor.receiveStart], receptor.receiveEnd - receptor.receiveStart);
+      receptor.receiveEnd -= receptor.receiveStart;
+      receptor.receiveStart = 0;
+    }
+    else
+      buffer.resize(2*buffer.size()); // Request larger than the buffer
   }
   
-  size_t indDebParam = indSep + separator.size();
-  size_t indEndParam = currentMessageReceived.find(param_sep,indDebParam);
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  int numbytes = (int)recv(receptor.socketFileDescriptorReceptor, &buffer[receptor.receiveEnd], buffer.size() - receptor.receiveEnd, 0);
+#else
+  int numbytes = recv((unsigned int)receptor.socketFileDescriptorReceptor, &buffer[receptor.receiveEnd], (int)(buffer.size() - receptor.receiveEnd), 0);
+#endif
   
-  std::string param;
-  while(indEndParam != std::string::npos || indEndParam < indEnd)
+  if(numbytes > 0)
   {
-    param = currentMessageReceived.substr((unsigned)indDebParam,(unsigned)(indEndParam - indDebParam));
-    request_list[(unsigned)indRequest]->addParameter(param);
-    indDebParam = indEndParam+param_sep.size();
-    indEndParam = currentMessageReceived.find(param_sep,indDebParam);
+    receptor.receiveEnd += (size_t)numbytes;
+    
+    // Check the size of the frame being received before the buffer grows to hold it
+    size_t end = endOfCompleteFrames(buffer, receptor.receiveStart, receptor.receiveEnd);
+    if(receptor.receiveEnd - end >= sizeof(uint32_t) && readFrameSize(&buffer[end]) > max_size_frame)
+    {
+      if(verboseMode)
+        vpTRACE("Frame of %u bytes larger than the maximum size", (unsigned int)readFrameSize(&buffer[end]));
+      // Reset the connection: the socket isn't left in the TIME_WAIT state
+      struct linger reset;
+      reset.l_onoff = 1;
+      reset.l_linger = 0;
+      setsockopt(receptor.socketFileDescriptorReceptor, SOL_SOCKET, SO_LINGER, (const char *)&reset, sizeof(reset));
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+      close( receptor.socketFileDescriptorReceptor );
+#else // _WIN32
+      closesocket( (unsigned)receptor.socketFileDescriptorReceptor );
+#endif
+      return -1;
+    }
   }
   
-  param = currentMessageReceived.substr((unsigned)indDebParam, indEnd - indDebParam);
-  request_list[(unsigned)indRequest]->addParameter(param);
-  currentMessageReceived.erase(indStart,indEnd+end.size());
+  return numbytes;
+}
+
+/*!
+  Remove a disconnected receptor. The complete requests received from it
+  are kept, to be handled by the next calls to the receive functions.
   
-  return indRequest;
+  \param receptorIndex : Index of the receptor.
+*/
+void vpNetwork::_removeReceptor(const unsigned int &receptorIndex)
+{
+  vpReceptor &receptor = receptor_list[receptorIndex];
+  std::cout << "Disconnected : " << inet_ntoa(receptor.receptorAddress.sin_addr) << std::endl;
+  
+  size_t end = endOfCompleteFrames(receptor.receiveBuffer, receptor.receiveStart, receptor.receiveEnd);
+  
+  if(end > receptor.receiveStart)
+  {
+    std::vector<char> &buffer = disconnectedRequests.receiveBuffer;
+    if(disconnectedRequests.receiveStart == disconnectedRequests.receiveEnd)
+      disconnectedRequests.receiveStart = disconnectedRequests.receiveEnd = 0;
+    size_t size = end - receptor.receiveStart;
+    if(buffer.size() < disconnectedRequests.receiveEnd + size)
+      buffer.resize(disconnectedRequests.receiveEnd + size);
+    memcpy(&buffer[disconnectedRequests.receiveEnd], &receptor.receiveBuffer[receptor.receiveStart], size);
+    disconnectedRequests.receiveEnd += size;
+  }
+  
+  receptor_list.erase(receptor_list.begin()+(int)receptorIndex);
 }
 
 /*!
@@ -608,7 +822,9 @@ int vpNetwork::_handleFirstRequest()
 */
 void vpNetwork::_receiveRequest()
 {
-  while(_receiveRequestOnce() > 0) {};
+  // Only the first wait uses the timeout
+  if(_receiveRequestOnce() > 0)
+    while(_receiveRequestOnce(false) > 0) {};
 }
 
 /*!
@@ -629,12 +845,14 @@ void vpNetwork::_receiveRequest()
 */
 void vpNetwork::_receiveRequestFrom(const unsigned int &receptorEmitting)
 {
-  while(_receiveRequestOnceFrom(receptorEmitting) > 0) {};
+  if(_receiveRequestOnceFrom(receptorEmitting) > 0)
+    while(_receiveRequestOnceFrom(receptorEmitting, false) > 0) {};
 }
 
 /*!
-  Receives a message once (in the limit of the Maximum message size value).
-  This message can represent an entire request or not. Several calls to this function
+  Receives the data available from all the receptors (in the limit of the free
+  space of their receive buffer).
+  This data can represent an entire request or not. Several calls to this function
   might be necessary to get the entire request.
   
   \warning Requests will be received but not decoded.
@@ -648,9 +866,11 @@ void vpNetwork::_receiveRequestFrom(const unsigned int &receptorEmitting)
   \sa vpNetwork::receiveAndDecodeRequestOnce()
   \sa vpNetwork::receiveAndDecodeRequestOnceFrom()
   
+  \param useTimeout : If false, return immediately when no data are available.
+  
   \return The number of bytes received, -1 if an error occured.
 */
-int vpNetwork::_receiveRequestOnce()
+int vpNetwork::_receiveRequestOnce(const bool &useTimeout)
 {
   if(receptor_list.size() == 0)
   {
@@ -659,68 +879,37 @@ int vpNetwork::_receiveRequestOnce()
     return -1;
   }
   
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
-#else
-  tv.tv_usec = tv_usec;
-#endif
-
-  FD_ZERO(&readFileDescriptor);        
-  
-  for(unsigned int i=0; i<receptor_list.size(); i++){ 
-    if(i == 0)
-      socketMax = receptor_list[i].socketFileDescriptorReceptor;
-    
-    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor); 
-    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor; 
-  }
-
-  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
-  int numbytes = 0;
+  int value = _waitForSockets(-1, false, useTimeout);
   
   if(value == -1){
     if(verboseMode)
-      vpERROR_TRACE( "Select error" );
+      vpERROR_TRACE( "Poll error" );
     return -1;
   }
   else if(value == 0){
     //Timeout
     return 0;
   }
-  else{
-    for(unsigned int i=0; i<receptor_list.size(); i++){
-      if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor)){
-        char *buf = new char [max_size_message];
-#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-        numbytes=(int)recv(receptor_list[i].socketFileDescriptorReceptor, buf, max_size_message, 0);
-#else
-        numbytes=recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, buf, (int)max_size_message, 0);
-#endif
-          
-        if(numbytes <= 0)
-        {
-          std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
-          receptor_list.erase(receptor_list.begin()+(int)i);
-          delete [] buf;
-          return numbytes;
-        }
-        else if(numbytes > 0){
-          std::string returnVal(buf, (unsigned int)numbytes);
-          currentMessageReceived.append(returnVal);
-        }
-        delete [] buf;
-        break;
-      }
-    }
+  
+  int numbytes = 0;
+  int lastResult = 0;
+  // From the last receptor, so that removing one doesn't change the index of the others
+  for(size_t i = readableReceptors.size() ; i > 0 ; i--){
+    unsigned int index = readableReceptors[i-1];
+    lastResult = _readReceptor(index);
+    if(lastResult <= 0)
+      _removeReceptor(index);
+    else
+      numbytes += lastResult;
   }
   
-  return numbytes;
+  return numbytes > 0 ? numbytes : lastResult;
 }
 
 /*!
-  Receives a message once (in the limit of the Maximum message size value), from a specific emitter.
-  This message can represent an entire request or not. Several calls to this function
+  Receives the data available from a specific emitter (in the limit of the free
+  space of its receive buffer).
+  This data can represent an entire request or not. Several calls to this function
   might be necessary to get the entire request.
   
   \warning Requests will be received but not decoded.
@@ -735,10 +924,11 @@ int vpNetwork::_receiveRequestOnce()
   \sa vpNetwork::receiveAndDecodeRequestOnceFrom()
   
   \param receptorEmitting : Index of the receptor emitting the message.
+  \param useTimeout : If false, return immediately when no data are available.
   
   \return The number of bytes received, -1 if an error occured.
 */
-int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
+int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting, const bool &useTimeout)
 {
   int size = (int)receptor_list.size();
   int sizeMinusOne = (int)receptor_list.size()-1;
@@ -749,54 +939,162 @@ int vpNetwork::_receiveRequestOnceFrom(const unsigned int &receptorEmitting)
     return -1;
   }
   
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
-#else
-  tv.tv_usec = tv_usec;
-#endif
-
-  FD_ZERO(&readFileDescriptor);        
+  int value = _waitForSockets((int)receptorEmitting, false, useTimeout);
   
-  socketMax = receptor_list[receptorEmitting].socketFileDescriptorReceptor;
-  FD_SET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor);
-
-  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
-  int numbytes = 0;
   if(value == -1){
     if(verboseMode)
-      vpERROR_TRACE( "Select error" );
+      vpERROR_TRACE( "Poll error" );
     return -1;
   }
   else if(value == 0){
     //Timeout
     return 0;
   }
-  else{
-    if(FD_ISSET((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor,&readFileDescriptor)){
-      char *buf = new char [max_size_message];
+  
+  int numbytes = _readReceptor(receptorEmitting);
+  if(numbytes <= 0)
+    _removeReceptor(receptorEmitting);
+  
+  return numbytes;
+}
+
+/*!
+  Send the buffers of sendBuffers to a receptor, with as few system calls as possible.
+  
+  \param dest : Index of the receptor.
+  
+  \return The number of bytes that have been sent, -1 if an error occured.
+*/
+int vpNetwork::_sendBuffers(const unsigned int &dest)
+{
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-      numbytes=(int)recv(receptor_list[receptorEmitting].socketFileDescriptorReceptor, buf, max_size_message, 0);
-#else
-      numbytes=recv((unsigned int)receptor_list[receptorEmitting].socketFileDescriptorReceptor, buf, (int)max_size_message, 0);
+  int flags = 0;
+#if defined(__linux__)
+  flags = MSG_NOSIGNAL; // Only for Linux
 #endif
-      if(numbytes <= 0)
-      {
-        std::cout << "Disconnected : " << inet_ntoa(receptor_list[receptorEmitting].receptorAddress.sin_addr) << std::endl;
-        receptor_list.erase(receptor_list.begin()+(int)receptorEmitting);
-        delete [] buf;
-        return numbytes;
-      }
-      else if(numbytes > 0){
-        std::string returnVal(buf, (unsigned int)numbytes);
-        currentMessageReceived.append(returnVal);
-      }
-      delete [] buf;
+  
+  size_t first = 0;
+  size_t total = 0;
+  while(first < sendBuffers.size())
+  {
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &sendBuffers[first];
+    message.msg_iovlen = std::min(sendBuffers.size() - first, maxNbSendBuffers);
+    
+    ssize_t numbytes = sendmsg(receptor_list[dest].socketFileDescriptorReceptor, &message, flags);
+    if(numbytes < 0){
+      if(errno == EINTR)
+        continue;
+      return -1;
+    }
+    total += (size_t)numbytes;
+    
+    // Skip what has been sent
+    size_t sent = (size_t)numbytes;
+    while(first < sendBuffers.size() && sent >= sendBuffers[first].iov_len){
+      sent -= sendBuffers[first].iov_len;
+      first++;
+    }
+    if(sent > 0){
+      sendBuffers[first].iov_base = (char *)sendBuffers[first].iov_base + sent;
+      sendBuffers[first].iov_len -= sent;
     }
   }
   
-  return numbytes;
+  return (int)total;
+#else
+  DWORD numbytes = 0;
+  if(WSASend((unsigned)receptor_list[dest].socketFileDescriptorReceptor, &sendBuffers[0], (DWORD)sendBuffers.size(),
+             &numbytes, 0, NULL, NULL) != 0)
+    return -1;
+  
+  return (int)numbytes;
+#endif
 }
 
-
-
+/*!
+  Wait until data can be read on the sockets, for tv_sec seconds and tv_usec microseconds.
+  The indexes of the receptors that can be read are then in readableReceptors, and
+  emitterReadable tells if the emitter socket can be read.
+  
+  \param receptorIndex : Index of the receptor to watch, -1 to watch all of them.
+  \param withEmitter : If true, the emitter socket is watched too.
+  \param useTimeout : If false, return immediately.
+  
+  \return The number of sockets that can be read, 0 on timeout, -1 if an error occured.
+*/
+int vpNetwork::_waitForSockets(const int &receptorIndex, const bool &withEmitter, const bool &useTimeout)
+{
+  readableReceptors.resize(0);
+  emitterReadable = false;
+  
+  unsigned int first = (receptorIndex < 0) ? 0 : (unsigned int)receptorIndex;
+  unsigned int last = (receptorIndex < 0) ? (unsigned int)receptor_list.size() : first + 1;
+  //tv_sec*1000000 overflows a 32 bits long after 35 minutes
+  int64_t timeout_usec = useTimeout ? (int64_t)tv_sec*1000000 + tv_usec : 0;
+  
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+  pollFileDescriptors.resize(0);
+  struct pollfd descriptor;
+  descriptor.events = POLLIN;
+  descriptor.revents = 0;
+  if(withEmitter){
+    descriptor.fd = emitter.socketFileDescriptorEmitter;
+    pollFileDescriptors.push_back(descriptor);
+  }
+  for(unsigned int i = first ; i < last ; i++){
+    descriptor.fd = receptor_list[i].socketFileDescriptorReceptor;
+    pollFileDescriptors.push_back(descriptor);
+  }
+  
+  struct pollfd *descriptors = pollFileDescriptors.size() ? &pollFileDescriptors[0] : NULL;
+#if defined(__linux__)
+  struct timespec timeout;
+  timeout.tv_sec = (time_t)(timeout_usec / 1000000);
+  timeout.tv_nsec = (long)(timeout_usec % 1000000) * 1000;
+  int value = ppoll(descriptors, (nfds_t)pollFileDescriptors.size(), &timeout, NULL);
+#else
+  int value = poll(descriptors, (nfds_t)pollFileDescriptors.size(),
+                   (int)std::min(timeout_usec / 1000, (int64_t)INT_MAX));
+#endif
+  if(value == -1 && errno == EINTR)
+    value = 0;
+  
+  if(value > 0){
+    size_t k = 0;
+    if(withEmitter)
+      emitterReadable = (pollFileDescriptors[k++].revents != 0);
+    for(unsigned int i = first ; i < last ; i++, k++)
+      if(pollFileDescriptors[k].revents != 0)
+        readableReceptors.push_back(i);
+  }
+#else
+  fd_set readFileDescriptor;
+  FD_ZERO(&readFileDescriptor);
+  SOCKET socketMax = 0;
+  if(withEmitter){
+    FD_SET((unsigned)emitter.socketFileDescriptorEmitter,&readFileDescriptor);
+    socketMax = emitter.socketFileDescriptorEmitter;
+  }
+  for(unsigned int i = first ; i < last ; i++){
+    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
+    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor;
+  }
+  
+  struct timeval timeout;
+  timeout.tv_sec = (long)(timeout_usec / 1000000);
+  timeout.tv_usec = (long)(timeout_usec % 1000000);
+  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&timeout);
+  
+  if(value > 0){
+    if(withEmitter)
+      emitterReadable = (FD_ISSET((unsigned int)emitter.socketFileDescriptorEmitter,&readFileDescriptor) != 0);
+    for(unsigned int i = first ; i < last ; i++)
+      if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor))
+        readableReceptors.push_back(i);
+  }
+#endif
+  
+  return value;
+}
@@ -38,7 +38,7 @@
 #include <visp3/core/vpRequest.h>
 
 vpRequest::vpRequest()
-  : request_id(""), listOfParams()
+  : request_id(""), listOfParams(), listOfBuffers()
 {}
 
 vpRequest::~vpRequest()
@@ -69,6 +69,21 @@ void vpRequest::addParameter(std::string &params)
   listOfParams.push_back(params);
 }
 
+/*!
+  Add a buffer as parameter of the request. The buffer is not copied: it is sent
+  from its location by vpNetwork and must remain valid until the request is sent.
+  These parameters are sent after the ones added with addParameter() and addParameterObject().
+  
+  \sa vpRequest::addParameter()
+  
+  \param data : Location of the buffer.
+  \param size : Size of the buffer in bytes.
+*/
+void vpRequest::addParameterBuffer(const void *data, const size_t &size)
+{
+  listOfBuffers.push_back(std::make_pair((const char *)data, size));
+}
+
 /*!
   Add messages as parameters of the request.
   Each message corresponds to one parameter.
@@ -82,3 +97,24 @@ void vpRequest::addParameter(std::vector< std::string > &listOfparams)
   for(unsigned int i = 0; i < listOfparams.size() ; i++)
     listOfparams.push_back(listOfparams[i]);
 }
+
+/*!
+  Set the parameters of the request from a received message. The default
+  implementation copies them in the list of parameters, to be decoded by decode().
+  It can be redefined to decode the parameters in place, for instance directly in
+  an image, in which case decode() may have nothing to do.
+  
+  \param params : Location of each parameter in the received message.
+  \param sizes : Size of each parameter.
+  
+  \return false if the parameters are incorrect and the request can't be handled.
+*/
+bool vpRequest::receiveParameters(const std::vector<const char *> &params, const std::vector<size_t> &sizes)
+{
+  // The strings of the previous parameters are reused
+  listOfParams.resize(params.size());
+  for(unsigned int i = 0 ; i < params.size() ; i++)
+    listOfParams[i].assign(params[i], sizes[i]);
+  
+  return true;
+}
@@ -201,28 +201,7 @@ bool vpServer::checkForConnections()
       return false;
     }
   
-  tv.tv_sec = tv_sec;
-#if TARGET_OS_IPHONE
-  tv.tv_usec = (int)tv_usec;
-#else
-  tv.tv_usec = tv_usec;
-#endif
-
-  FD_ZERO(&readFileDescriptor);         
-  
-  socketMax = emitter.socketFileDescriptorEmitter;
-  FD_SET((unsigned)emitter.socketFileDescriptorEmitter,&readFileDescriptor);
-
-  for(unsigned int i=0; i<receptor_list.size(); i++){
-    FD_SET((unsigned)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor);
-
-    if(i == 0)
-      socketMax = receptor_list[i].socketFileDescriptorReceptor;
-   
-    if(socketMax < receptor_list[i].socketFileDescriptorReceptor) socketMax = receptor_list[i].socketFileDescriptorReceptor; 
-  }
-  
-  int value = select((int)socketMax+1,&readFileDescriptor,NULL,NULL,&tv);
+  int value = _waitForSockets(-1, true);
   if(value == -1){
     //vpERROR_TRACE( "vpServer::run(), select()" );
     return false;
@@ -231,7 +210,7 @@ bool vpServer::checkForConnections()
     return false;
   }
   else{
-    if(FD_ISSET((unsigned int)emitter.socketFileDescriptorEmitter,&readFileDescriptor)){
+    if(emitterReadable){
       vpNetwork::vpReceptor client;
       client.receptorAddressSize = sizeof(client.receptorAddress);
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
@@ -246,6 +225,11 @@ bool vpServer::checkForConnections()
       if((client.socketFileDescriptorReceptor) == INVALID_SOCKET)
 #endif
         vpERROR_TRACE( "vpServer::run(), accept()" );
+      else{
+        // Small requests such as poses are sent without waiting to be grouped
+        int noDelay = 1;
+        setsockopt(client.socketFileDescriptorReceptor, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+      }
       
       client.receptorIP = inet_ntoa(client.receptorAddress.sin_addr);
       printf("New client connected : %s\n", inet_ntoa(client.receptorAddress.sin_addr));
@@ -254,21 +238,19 @@ bool vpServer::checkForConnections()
       return true;
     }
     else{
-      for(unsigned int i=0; i<receptor_list.size(); i++){
-        if(FD_ISSET((unsigned int)receptor_list[i].socketFileDescriptorReceptor,&readFileDescriptor)){
-          char deco;
+      for(unsigned int i=0; i<readableReceptors.size(); i++){
+        unsigned int index = readableReceptors[i];
+        char deco;
 #if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
-          ssize_t numbytes = recv(receptor_list[i].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
+        ssize_t numbytes = recv(receptor_list[index].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
 #else //Win32
-          int numbytes = recv((unsigned int)receptor_list[i].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
+        int numbytes = recv((unsigned int)receptor_list[index].socketFileDescriptorReceptor, &deco, 1, MSG_PEEK);
 #endif
-          
-          if(numbytes == 0)
-          {
-            std::cout << "Disconnected : " << inet_ntoa(receptor_list[i].receptorAddress.sin_addr) << std::endl;
-            receptor_list.erase(receptor_list.begin()+(int)i);
-            return 0;
-          }
+        
+        if(numbytes == 0)
+        {
+          _removeReceptor(index);
+          return 0;
         }
       }
     }
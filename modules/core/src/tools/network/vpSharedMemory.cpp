@@ -0,0 +1,342 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Memory shared between processes.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpSharedMemory.cpp
+  \brief Memory shared between processes.
+*/
+
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpSharedMemory.h>
+
+#if !defined(_WIN32) && (defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))) // UNIX
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <sched.h>
+#  define VISP_HAVE_SHM_OPEN 1
+#elif defined(_WIN32) && !defined(WINRT)
+#  include <windows.h>
+#  define VISP_HAVE_NAMED_FILE_MAPPING 1
+#endif
+
+namespace {
+// Header at the beginning of the memory, followed by the data
+struct SharedMemoryHeader
+{
+  volatile uint32_t sequence; // Odd while the data are written
+  volatile uint32_t closed;   // Set when the writer releases the memory
+  volatile uint64_t size;     // Size of the last data written
+  uint64_t capacity;          // Size of the data that can be written
+};
+const size_t sharedMemoryHeaderSize = 64;
+
+// Number of times a read is retried while the data are written
+const unsigned int maxNbReadAttempts = 1000;
+
+inline void memoryBarrier()
+{
+#if defined(_MSC_VER)
+  MemoryBarrier();
+#elif defined(__GNUC__)
+  __sync_synchronize();
+#endif
+}
+
+inline void yieldThread()
+{
+#if defined(VISP_HAVE_SHM_OPEN)
+  sched_yield();
+#elif defined(VISP_HAVE_NAMED_FILE_MAPPING)
+  SwitchToThread();
+#endif
+}
+
+#if defined(VISP_HAVE_SHM_OPEN)
+std::string systemName(const std::string &name) { return "/" + name; }
+#else
+std::string systemName(const std::string &name) { return "Local\\" + name; }
+#endif
+}
+
+/*!
+  Default constructor: no memory is open.
+*/
+vpSharedMemory::vpSharedMemory()
+  : m_name(), m_baseName(), m_generation(0), m_memory(NULL), m_size(0), m_isWriter(false)
+#if defined(_WIN32)
+  , m_mapping(NULL)
+#endif
+{
+}
+
+/*!
+  Destructor that closes the memory.
+*/
+vpSharedMemory::~vpSharedMemory()
+{
+  close();
+}
+
+/*!
+  Close the memory. If it has been created by this object, it is released:
+  the readers will open it again when it is created anew.
+*/
+void vpSharedMemory::close()
+{
+  if (m_memory != NULL) {
+    SharedMemoryHeader *header = (SharedMemoryHeader *) m_memory;
+    if (m_isWriter)
+      header->closed = 1;
+#if defined(VISP_HAVE_SHM_OPEN)
+    munmap(m_memory, sharedMemoryHeaderSize + m_size);
+    if (m_isWriter)
+      shm_unlink(systemName(m_name).c_str());
+#elif defined(VISP_HAVE_NAMED_FILE_MAPPING)
+    UnmapViewOfFile(m_memory);
+    CloseHandle((HANDLE) m_mapping);
+    m_mapping = NULL;
+#endif
+  }
+  m_memory = NULL;
+  m_size = 0;
+  m_isWriter = false;
+}
+
+/*!
+  Create a memory to write data, or keep the current one if it has the same
+  name and is large enough.
+
+  \param name : Name of the memory, without '/' or '\\'.
+  \param size : Size of the data that can be written.
+
+  \exception vpException::ioError : If the memory can not be created.
+*/
+void vpSharedMemory::create(const std::string &name, const size_t &size)
+{
+  if (m_isWriter && m_baseName == name && m_size >= size)
+    return;
+
+  // The readers keep using the previous memory until they open the new one
+  m_generation = (m_isWriter && m_baseName == name) ? m_generation + 1 : 0;
+  m_baseName = name;
+  std::stringstream ss;
+  ss << name;
+  if (m_generation > 0)
+    ss << "_" << m_generation;
+
+  close();
+  map(ss.str(), size, true);
+}
+
+/*!
+  Open a memory created by another object to read its data. Nothing is done
+  if the memory is already open.
+
+  \param name : Name of the memory.
+
+  \exception vpException::ioError : If the memory can not be opened.
+*/
+void vpSharedMemory::open(const std::string &name)
+{
+  if (m_memory != NULL && !m_isWriter && m_name == name && !((SharedMemoryHeader *) m_memory)->closed)
+    return;
+
+  close();
+  map(name, 0, false);
+}
+
+/*!
+  Copy the last data written in the memory.
+
+  \param data : Location where the data are copied.
+  \param size : Size of the data.
+
+  \return false if no data or data of a different size have been written,
+  or if the data have been written during each attempt to read them.
+*/
+bool vpSharedMemory::read(void *data, const size_t &size)
+{
+  if (m_memory == NULL)
+    return false;
+
+  for (unsigned int i = 0; i < maxNbReadAttempts; i++) {
+    SharedMemoryHeader *header = (SharedMemoryHeader *) m_memory;
+    if (header->closed) {
+      // The writer has released the memory, it may have created it again
+      try {
+        open(m_name);
+      }
+      catch(const vpException &) {
+        return false;
+      }
+      continue;
+    }
+
+    uint32_t sequence = header->sequence;
+    if (sequence == 0)
+      return false; // Nothing written yet
+    if (sequence % 2 == 1) {
+      yieldThread();
+      continue;
+    }
+    memoryBarrier();
+    if (header->size != size || size > m_size)
+      return false;
+    memcpy(data, m_memory + sharedMemoryHeaderSize, size);
+    memoryBarrier();
+    if (header->sequence == sequence)
+      return true;
+  }
+
+  return false;
+}
+
+/*!
+  Write data in the memory.
+
+  \param data : Data to write.
+  \param size : Size of the data.
+
+  \exception vpException::badValue : If the memory hasn't been created by
+  create() or if it is not large enough.
+*/
+void vpSharedMemory::write(const void *data, const size_t &size)
+{
+  if (!m_isWriter || size > m_size) {
+    throw vpException(vpException::badValue, "Cannot write %d bytes in the shared memory %s",
+                      (int) size, m_name.c_str());
+  }
+
+  SharedMemoryHeader *header = (SharedMemoryHeader *) m_memory;
+  header->sequence = header->sequence + 1;
+  memoryBarrier();
+  header->size = size;
+  memcpy(m_memory + sharedMemoryHeaderSize, data, size);
+  memoryBarrier();
+  header->sequence = header->sequence + 1;
+}
+
+/*!
+  Map a memory.
+
+  \param name : Name of the memory.
+  \param size : Size of the data, when the memory is created.
+  \param create : If true, the memory is created if it doesn't exist yet.
+*/
+void vpSharedMemory::map(const std::string &name, const size_t &size, const bool &create)
+{
+  std::string sysName = systemName(name);
+  size_t totalSize = sharedMemoryHeaderSize + size;
+
+#if defined(VISP_HAVE_SHM_OPEN)
+  int fd = shm_open(sysName.c_str(), create ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+  if (fd < 0) {
+    throw vpException(vpException::ioError, "Cannot open shared memory: %s", name.c_str());
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw vpException(vpException::ioError, "Cannot get the size of shared memory: %s", name.c_str());
+  }
+  if (create && (size_t) st.st_size != totalSize) {
+    if (ftruncate(fd, (off_t) totalSize) != 0) {
+      ::close(fd);
+      shm_unlink(sysName.c_str());
+      throw vpException(vpException::ioError, "Cannot allocate shared memory: %s", name.c_str());
+    }
+  }
+  else if (!create) {
+    totalSize = (size_t) st.st_size;
+    if (totalSize < sharedMemoryHeaderSize) {
+      ::close(fd);
+      throw vpException(vpException::ioError, "Incorrect shared memory: %s", name.c_str());
+    }
+  }
+  void *memory = mmap(NULL, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the descriptor is closed
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    if (create)
+      shm_unlink(sysName.c_str());
+    throw vpException(vpException::ioError, "Cannot map shared memory: %s", name.c_str());
+  }
+  m_memory = (unsigned char *) memory;
+
+#elif defined(VISP_HAVE_NAMED_FILE_MAPPING)
+  HANDLE mapping;
+  if (create) {
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                 (DWORD) ((unsigned long long) totalSize >> 32), (DWORD) (totalSize & 0xffffffff),
+                                 sysName.c_str());
+  }
+  else {
+    mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, sysName.c_str());
+  }
+  if (mapping == NULL) {
+    throw vpException(vpException::ioError, "Cannot open shared memory: %s", name.c_str());
+  }
+  void *memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+  if (memory == NULL) {
+    CloseHandle(mapping);
+    throw vpException(vpException::ioError, "Cannot map shared memory: %s", name.c_str());
+  }
+  m_mapping = mapping;
+  m_memory = (unsigned char *) memory;
+  if (!create)
+    totalSize = sharedMemoryHeaderSize + (size_t) ((SharedMemoryHeader *) m_memory)->capacity;
+
+#else
+  (void) totalSize;
+  throw vpException(vpException::fatalError, "Shared memory is not available on this platform: %s", name.c_str());
+#endif
+
+  SharedMemoryHeader *header = (SharedMemoryHeader *) m_memory;
+  if (create) {
+    // A memory left by a writer that didn't close it is reused from scratch
+    header->sequence = 0;
+    header->closed = 0;
+    header->size = 0;
+    header->capacity = size;
+  }
+  m_name = name;
+  m_size = totalSize - sharedMemoryHeaderSize;
+  m_isWriter = create;
+}
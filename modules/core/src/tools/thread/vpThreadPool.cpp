@@ -0,0 +1,493 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Process-wide pool of threads.
+ *
+ *****************************************************************************/
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpThreadPool.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_THREAD_POOL_OK
+#  include <visp3/core/vpMutex.h>
+#  include <visp3/core/vpThread.h>
+#endif
+
+#if defined(VISP_HAVE_PTHREAD)
+#  include <pthread.h>
+#  include <unistd.h>
+#elif defined(_WIN32)
+#  include <windows.h>
+#endif
+
+namespace {
+const unsigned int vpThreadPoolMaxThreads = 256;
+
+#if defined(VP_THREAD_POOL_OK)
+// Auto-reset event: each call to set() releases one call to wait()
+class vpThreadPoolEvent
+{
+public:
+  vpThreadPoolEvent()
+#if defined(VISP_HAVE_PTHREAD)
+    : m_mutex(), m_cond(), m_signaled(false)
+  {
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond, NULL);
+  }
+#else
+    : m_event(CreateEvent(NULL, FALSE, FALSE, NULL))
+  {
+  }
+#endif
+
+  ~vpThreadPoolEvent()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+#else
+    CloseHandle(m_event);
+#endif
+  }
+
+  void set()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_lock(&m_mutex);
+    m_signaled = true;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+#else
+    SetEvent(m_event);
+#endif
+  }
+
+  void wait()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_lock(&m_mutex);
+    while (!m_signaled)
+      pthread_cond_wait(&m_cond, &m_mutex);
+    m_signaled = false;
+    pthread_mutex_unlock(&m_mutex);
+#else
+    WaitForSingleObject(m_event, INFINITE);
+#endif
+  }
+
+private:
+  vpThreadPoolEvent(const vpThreadPoolEvent &);
+  vpThreadPoolEvent &operator=(const vpThreadPoolEvent &);
+
+#if defined(VISP_HAVE_PTHREAD)
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+  bool m_signaled;
+#else
+  HANDLE m_event;
+#endif
+};
+
+// Indexes that remain to be processed by a thread taking part in a loop
+struct vpThreadPoolRange
+{
+  vpThreadPoolRange() : m_mutex(), m_start(0), m_end(0) {}
+
+  vpMutex m_mutex;
+  unsigned int m_start;
+  unsigned int m_end;
+};
+
+// Loop shared by the threads taking part in it
+struct vpThreadPoolJob
+{
+  vpThreadPoolJob() : m_body(NULL), m_grainSize(1), m_nbParticipants(0), m_ranges(NULL),
+    m_mutex(), m_nbRunning(0), m_failed(false), m_message() {}
+
+  const vpParallelLoopBody *m_body;
+  unsigned int m_grainSize;
+  unsigned int m_nbParticipants;
+  vpThreadPoolRange *m_ranges;
+
+  //! Protects the members below
+  vpMutex m_mutex;
+  unsigned int m_nbRunning;
+  bool m_failed;
+  std::string m_message;
+};
+
+class vpThreadPoolImpl
+{
+public:
+  vpThreadPoolImpl() : m_mutex(), m_busy(false), m_stop(false), m_workers(), m_job(NULL), m_done() {}
+
+  ~vpThreadPoolImpl()
+  {
+    m_stop = true;
+    for (size_t i = 0; i < m_workers.size(); i++) {
+      m_workers[i]->m_start.set();
+      m_workers[i]->m_thread.join();
+      delete m_workers[i];
+    }
+  }
+
+  void parallelFor(unsigned int start, unsigned int end, const vpParallelLoopBody &body,
+                   unsigned int nbParticipants, unsigned int grainSize);
+
+private:
+  struct Worker
+  {
+    Worker(vpThreadPoolImpl *pool, unsigned int index) : m_pool(pool), m_index(index), m_start(), m_thread() {}
+
+    vpThreadPoolImpl *m_pool;
+    unsigned int m_index;
+    vpThreadPoolEvent m_start;
+    vpThread m_thread;
+  };
+
+  static vpThread::Return workerLoop(vpThread::Args args);
+
+  static void execute(vpThreadPoolJob &job, unsigned int participant);
+  static bool pop(vpThreadPoolJob &job, unsigned int participant, unsigned int &start, unsigned int &end);
+  static bool steal(vpThreadPoolJob &job, unsigned int participant);
+
+  //! Protects m_busy and m_workers
+  vpMutex m_mutex;
+  bool m_busy;
+  bool m_stop;
+  std::vector<Worker *> m_workers;
+  vpThreadPoolRange m_ranges[vpThreadPoolMaxThreads];
+  vpThreadPoolJob *m_job;
+  vpThreadPoolEvent m_done;
+};
+
+vpThread::Return vpThreadPoolImpl::workerLoop(vpThread::Args args)
+{
+  Worker *worker = (Worker *) args;
+  vpThreadPoolImpl *pool = worker->m_pool;
+
+  for (;;) {
+    worker->m_start.wait();
+    if (pool->m_stop)
+      break;
+
+    vpThreadPoolJob &job = *pool->m_job;
+    execute(job, worker->m_index + 1);
+
+    bool last;
+    {
+      vpMutex::vpScopedLock lock(job.m_mutex);
+      last = (--job.m_nbRunning == 0);
+    }
+    if (last)
+      pool->m_done.set();
+  }
+
+  return 0;
+}
+
+// Process the range of a participant by chunks, then steal indexes from the others
+void vpThreadPoolImpl::execute(vpThreadPoolJob &job, unsigned int participant)
+{
+  try {
+    unsigned int start, end;
+    for (;;) {
+      if (pop(job, participant, start, end))
+        (*job.m_body)(start, end);
+      else if (!steal(job, participant))
+        break;
+    }
+  }
+  catch (const vpException &e) {
+    vpMutex::vpScopedLock lock(job.m_mutex);
+    job.m_failed = true;
+    job.m_message = e.getStringMessage();
+  }
+  catch (const std::exception &e) {
+    vpMutex::vpScopedLock lock(job.m_mutex);
+    job.m_failed = true;
+    job.m_message = e.what();
+  }
+  catch (...) {
+    vpMutex::vpScopedLock lock(job.m_mutex);
+    job.m_failed = true;
+    job.m_message = "unknown exception";
+  }
+}
+
+bool vpThreadPoolImpl::pop(vpThreadPoolJob &job, unsigned int participant, unsigned int &start, unsigned int &end)
+{
+  vpThreadPoolRange &range = job.m_ranges[participant];
+  vpMutex::vpScopedLock lock(range.m_mutex);
+  if (range.m_start >= range.m_end)
+    return false;
+
+  start = range.m_start;
+  end = (range.m_end - range.m_start > job.m_grainSize) ? range.m_start + job.m_grainSize : range.m_end;
+  range.m_start = end;
+  return true;
+}
+
+// Move the second half of the remaining indexes of the most loaded participant to the range of participant
+bool vpThreadPoolImpl::steal(vpThreadPoolJob &job, unsigned int participant)
+{
+  for (;;) {
+    unsigned int victim = participant, max_remaining = 0;
+    for (unsigned int i = 0; i < job.m_nbParticipants; i++) {
+      if (i == participant)
+        continue;
+      vpMutex::vpScopedLock lock(job.m_ranges[i].m_mutex);
+      unsigned int remaining = job.m_ranges[i].m_end - job.m_ranges[i].m_start;
+      if (remaining > max_remaining) {
+        max_remaining = remaining;
+        victim = i;
+      }
+    }
+    if (max_remaining == 0)
+      return false;
+
+    unsigned int start, end;
+    {
+      vpMutex::vpScopedLock lock(job.m_ranges[victim].m_mutex);
+      vpThreadPoolRange &range = job.m_ranges[victim];
+      unsigned int remaining = range.m_end - range.m_start;
+      if (remaining == 0)
+        continue; // Finished in the meantime, look for another victim
+      end = range.m_end;
+      start = (remaining > job.m_grainSize) ? range.m_end - remaining / 2 : range.m_start;
+      range.m_end = start;
+    }
+
+    vpMutex::vpScopedLock lock(job.m_ranges[participant].m_mutex);
+    job.m_ranges[participant].m_start = start;
+    job.m_ranges[participant].m_end = end;
+    return true;
+  }
+}
+
+void vpThreadPoolImpl::parallelFor(unsigned int start, unsigned int end, const vpParallelLoopBody &body,
+                                   unsigned int nbParticipants, unsigned int grainSize)
+{
+  {
+    vpMutex::vpScopedLock lock(m_mutex);
+    if (m_busy) {
+      // Nested loop or loop started by another thread: no thread is available
+      nbParticipants = 1;
+    }
+    else {
+      m_busy = true;
+      try {
+        while (m_workers.size() < nbParticipants - 1) {
+          Worker *worker = new Worker(this, (unsigned int) m_workers.size());
+          worker->m_thread.create((vpThread::Fn) workerLoop, (vpThread::Args) worker);
+          m_workers.push_back(worker);
+        }
+      }
+      catch (...) {
+        // Use the threads that could be created
+        nbParticipants = (unsigned int) m_workers.size() + 1;
+      }
+    }
+  }
+
+  if (nbParticipants <= 1) {
+    body(start, end);
+    return;
+  }
+
+  vpThreadPoolJob job;
+  job.m_body = &body;
+  job.m_grainSize = grainSize;
+  job.m_nbParticipants = nbParticipants;
+  job.m_ranges = m_ranges;
+  job.m_nbRunning = nbParticipants - 1;
+
+  unsigned int size = end - start;
+  for (unsigned int i = 0; i < nbParticipants; i++) {
+    m_ranges[i].m_start = start + (unsigned int) ((unsigned long long) size * i / nbParticipants);
+    m_ranges[i].m_end = start + (unsigned int) ((unsigned long long) size * (i+1) / nbParticipants);
+  }
+
+  m_job = &job;
+  for (unsigned int i = 0; i < nbParticipants - 1; i++)
+    m_workers[i]->m_start.set();
+
+  execute(job, 0);
+  m_done.wait();
+
+  m_job = NULL;
+  {
+    vpMutex::vpScopedLock lock(m_mutex);
+    m_busy = false;
+  }
+
+  if (job.m_failed) {
+    throw(vpException(vpException::fatalError, "Exception in a parallel loop: %s", job.m_message.c_str()));
+  }
+}
+
+// The pool is created on first use and only destroyed by vpThreadPool::shutdown(): joining the
+// workers from a static destructor may deadlock when the library is unloaded on Windows
+vpMutex vpThreadPoolInstanceMutex;
+vpThreadPoolImpl *vpThreadPoolInstance = NULL;
+unsigned int vpThreadPoolConcurrency = 0;
+
+vpThreadPoolImpl &getThreadPoolInstance()
+{
+  vpMutex::vpScopedLock lock(vpThreadPoolInstanceMutex);
+  if (vpThreadPoolInstance == NULL)
+    vpThreadPoolInstance = new vpThreadPoolImpl;
+  return *vpThreadPoolInstance;
+}
+#else
+unsigned int vpThreadPoolConcurrency = 1;
+#endif
+}
+
+const unsigned int vpThreadPool::poolConcurrency = (unsigned int) -1;
+
+/*!
+  Return the number of threads used by parallelFor() when no number of
+  threads is given.
+
+  \sa setConcurrency()
+*/
+unsigned int vpThreadPool::getConcurrency()
+{
+#if defined(VP_THREAD_POOL_OK)
+  vpMutex::vpScopedLock lock(vpThreadPoolInstanceMutex);
+  if (vpThreadPoolConcurrency == 0)
+    vpThreadPoolConcurrency = getNumberOfCores();
+#endif
+  return vpThreadPoolConcurrency;
+}
+
+/*!
+  Return the number of processors available on the computer, or 1 if it
+  can not be determined.
+*/
+unsigned int vpThreadPool::getNumberOfCores()
+{
+  long nb_cores = 1;
+#if defined(VISP_HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+  nb_cores = sysconf(_SC_NPROCESSORS_ONLN);
+#elif defined(_WIN32) && !defined(WINRT)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  nb_cores = (long) info.dwNumberOfProcessors;
+#endif
+  return nb_cores < 1 ? 1 : (unsigned int) nb_cores;
+}
+
+/*!
+  Call \e body on sub-ranges of [\e start, \e end) using the threads of the
+  pool. The function returns when all the indexes have been processed.
+
+  \param start, end : Range of indexes.
+  \param body : Body of the loop.
+  \param nbThreads : Number of threads taking part in the loop, the calling
+  thread included. 0 and poolConcurrency mean getConcurrency().
+  \param grainSize : Number of indexes processed by a call to the body,
+  except at the end of the sub-ranges. 0 selects a size that gives about 8
+  calls per thread.
+
+  \exception vpException::fatalError : If the body threw an exception on a
+  thread of the pool. The remaining indexes of the thread that threw are not
+  processed.
+*/
+void vpThreadPool::parallelFor(unsigned int start, unsigned int end, const vpParallelLoopBody &body,
+                               unsigned int nbThreads, unsigned int grainSize)
+{
+  if (end <= start)
+    return;
+
+  unsigned int size = end - start;
+  if (nbThreads == 0 || nbThreads == poolConcurrency)
+    nbThreads = getConcurrency();
+  if (nbThreads > vpThreadPoolMaxThreads)
+    nbThreads = vpThreadPoolMaxThreads;
+  if (grainSize == 0)
+    grainSize = (size / (8 * nbThreads) > 0) ? size / (8 * nbThreads) : 1;
+  if (nbThreads > (size + grainSize - 1) / grainSize)
+    nbThreads = (size + grainSize - 1) / grainSize;
+
+#if defined(VP_THREAD_POOL_OK)
+  if (nbThreads > 1) {
+    getThreadPoolInstance().parallelFor(start, end, body, nbThreads, grainSize);
+    return;
+  }
+#endif
+  body(start, end);
+}
+
+/*!
+  Set the number of threads used by parallelFor() when no number of threads
+  is given. 0 means the number of cores returned by getNumberOfCores(), which
+  is the default value.
+*/
+void vpThreadPool::setConcurrency(unsigned int nbThreads)
+{
+  if (nbThreads > vpThreadPoolMaxThreads)
+    nbThreads = vpThreadPoolMaxThreads;
+#if defined(VP_THREAD_POOL_OK)
+  vpMutex::vpScopedLock lock(vpThreadPoolInstanceMutex);
+  vpThreadPoolConcurrency = nbThreads;
+#else
+  vpThreadPoolConcurrency = (nbThreads == 0) ? 1 : nbThreads;
+#endif
+}
+
+/*!
+  Stop and join the threads of the pool. The next parallelFor() creates new
+  threads.
+
+  The threads of the pool are not joined when the program exits. An
+  application that unloads ViSP at run time (FreeLibrary() on Windows,
+  dlclose()) has to call this function before, while no parallelFor() is
+  running.
+*/
+void vpThreadPool::shutdown()
+{
+#if defined(VP_THREAD_POOL_OK)
+  vpThreadPoolImpl *pool;
+  {
+    vpMutex::vpScopedLock lock(vpThreadPoolInstanceMutex);
+    pool = vpThreadPoolInstance;
+    vpThreadPoolInstance = NULL;
+  }
+  delete pool;
+#endif
+}
@@ -38,7 +38,14 @@
 
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpDebug.h>
+#include <visp3/core/vpException.h>
 #include <visp3/core/vpFeatureDisplay.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
 
 /*!
   \file vpPoint.cpp
@@ -405,6 +412,96 @@ vpPoint::display(const vpImage<vpRGBa> &I,
   vpFeatureDisplay::displayPoint(_p[0],_p[1], cam, I, color, thickness) ;
 }
 
+/*!
+  Transform arrays of 3D points from the object frame to the camera frame
+  and project them in the image plane, two points at a time with SSE2 when
+  available. The results are the same as with changeFrame() and
+  projection() for each point with a homogeneous coordinate of 1, without
+  the vpColVector updates.
+
+  \param cMo : Transformation from camera to object frame.
+  \param oX, oY, oZ : Coordinates of the \e n points in the object frame.
+  \param n : Number of points.
+  \param x, y : Normalized coordinates \f$x = X/Z\f$ and \f$y = Y/Z\f$ of the
+  projections in the image plane, n values each.
+  \param Z : If not NULL, depth of the points in the camera frame, n values.
+  The points with a depth that is not strictly positive are behind the camera.
+*/
+void vpPoint::projectPoints(const vpHomogeneousMatrix &cMo, const double *oX, const double *oY, const double *oZ,
+                            unsigned int n, double *x, double *y, double *Z)
+{
+  const double r00 = cMo[0][0], r01 = cMo[0][1], r02 = cMo[0][2], tx = cMo[0][3];
+  const double r10 = cMo[1][0], r11 = cMo[1][1], r12 = cMo[1][2], ty = cMo[1][3];
+  const double r20 = cMo[2][0], r21 = cMo[2][1], r22 = cMo[2][2], tz = cMo[2][3];
+
+  unsigned int i = 0;
+#if VISP_HAVE_SSE2
+  const __m128d v_r00 = _mm_set1_pd(r00), v_r01 = _mm_set1_pd(r01), v_r02 = _mm_set1_pd(r02);
+  const __m128d v_r10 = _mm_set1_pd(r10), v_r11 = _mm_set1_pd(r11), v_r12 = _mm_set1_pd(r12);
+  const __m128d v_r20 = _mm_set1_pd(r20), v_r21 = _mm_set1_pd(r21), v_r22 = _mm_set1_pd(r22);
+  const __m128d v_tx = _mm_set1_pd(tx), v_ty = _mm_set1_pd(ty), v_tz = _mm_set1_pd(tz);
+
+  for (; i + 2 <= n; i += 2) {
+    const __m128d v_oX = _mm_loadu_pd(oX + i);
+    const __m128d v_oY = _mm_loadu_pd(oY + i);
+    const __m128d v_oZ = _mm_loadu_pd(oZ + i);
+
+    const __m128d v_cX = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(v_r00, v_oX), _mm_mul_pd(v_r01, v_oY)),
+                                               _mm_mul_pd(v_r02, v_oZ)), v_tx);
+    const __m128d v_cY = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(v_r10, v_oX), _mm_mul_pd(v_r11, v_oY)),
+                                               _mm_mul_pd(v_r12, v_oZ)), v_ty);
+    const __m128d v_cZ = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(v_r20, v_oX), _mm_mul_pd(v_r21, v_oY)),
+                                               _mm_mul_pd(v_r22, v_oZ)), v_tz);
+
+    _mm_storeu_pd(x + i, _mm_div_pd(v_cX, v_cZ));
+    _mm_storeu_pd(y + i, _mm_div_pd(v_cY, v_cZ));
+    if (Z != NULL) {
+      _mm_storeu_pd(Z + i, v_cZ);
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    const double cX = r00*oX[i] + r01*oY[i] + r02*oZ[i] + tx;
+    const double cY = r10*oX[i] + r11*oY[i] + r12*oZ[i] + ty;
+    const double cZ = r20*oX[i] + r21*oY[i] + r22*oZ[i] + tz;
+
+    x[i] = cX / cZ;
+    y[i] = cY / cZ;
+    if (Z != NULL) {
+      Z[i] = cZ;
+    }
+  }
+}
+
+/*!
+  Transform arrays of 3D points from the object frame to the camera frame
+  and project them in the image plane.
+
+  \param cMo : Transformation from camera to object frame.
+  \param oX, oY, oZ : Coordinates of the points in the object frame.
+  \param x, y : Normalized coordinates of the projections in the image
+  plane, resized to the number of points.
+
+  \exception vpException::dimensionError : If the coordinate vectors do not
+  have the same size.
+
+  \sa projectPoints(const vpHomogeneousMatrix &, const double *, const double *, const double *, unsigned int, double *, double *, double *)
+*/
+void vpPoint::projectPoints(const vpHomogeneousMatrix &cMo, const std::vector<double> &oX,
+                            const std::vector<double> &oY, const std::vector<double> &oZ,
+                            std::vector<double> &x, std::vector<double> &y)
+{
+  if (oY.size() != oX.size() || oZ.size() != oX.size()) {
+    throw(vpException(vpException::dimensionError, "The coordinate vectors have different sizes"));
+  }
+  x.resize(oX.size());
+  y.resize(oX.size());
+  if (!oX.empty()) {
+    projectPoints(cMo, &oX[0], &oY[0], &oZ[0], (unsigned int) oX.size(), &x[0], &y[0]);
+  }
+}
+
 VISP_EXPORT std::ostream& operator<<(std::ostream& os, const vpPoint& /* vpp */)
 {
   return( os<<"vpPoint" );
@@ -48,7 +48,52 @@
 /*!
   Default constructor
 */
-vpMoment::vpMoment(): object(NULL), moments(NULL), values() {}
+vpMoment::vpMoment()
+  : object(NULL), moments(NULL), dependencyNames(), dependencies(), dependencyDatabase(NULL),
+    dependencyRevision(0), values() {}
+
+/*!
+  Declares that the moment depends on another moment of the database. Should be called in the constructor
+  of the moments that need other moments to be computed.
+  \param type : Name of the moment's class, as returned by vpMoment::name().
+*/
+void vpMoment::addDependency(const char* type){
+  dependencyNames.push_back(type);
+  dependencyDatabase = NULL;
+}
+
+/*!
+  Retrieves a moment this moment depends on from the linked database.
+
+  The moments declared with addDependency() are looked for in the database once and then accessed
+  directly, until a new moment is linked to the database. Other moments are looked for by name.
+  \param type : Name of the moment's class.
+  \param found : true if the moment is linked to a database containing a moment of this type, false otherwise.
+  \return Moment corresponding to \e type. Must not be used if \e found is false.
+*/
+const vpMoment& vpMoment::getDependency(const char* type, bool& found) const {
+  found = false;
+  if (moments == NULL)
+    return *this;
+
+  if (dependencyDatabase != moments || dependencyRevision != moments->revision) {
+    dependencies.resize(dependencyNames.size());
+    for (size_t i = 0; i < dependencyNames.size(); i++)
+      dependencies[i] = moments->find(dependencyNames[i]);
+    dependencyDatabase = moments;
+    dependencyRevision = moments->revision;
+  }
+
+  for (size_t i = 0; i < dependencyNames.size(); i++) {
+    if (dependencyNames[i] == type || std::strcmp(dependencyNames[i], type) == 0) {
+      found = (dependencies[i] != NULL);
+      return found ? *dependencies[i] : *this;
+    }
+  }
+
+  const vpMoment& moment = moments->get(type, found);
+  return found ? moment : *this;
+}
 
 
 /*!
@@ -47,6 +47,7 @@
  */
 vpMomentAlpha::vpMomentAlpha() : isRef(true), symmetric(false), ref(), alphaRef(0.) {
     values.resize(1);
+    addDependency("vpMomentCentered");
 }
 
 /*!
@@ -63,6 +64,7 @@ vpMomentAlpha::vpMomentAlpha(std::vector<double>& ref_, double alpha_ref)
       symmetric = true;
 
   values.resize(1);
+  addDependency("vpMomentCentered");
 }
 
 /*!
@@ -73,7 +75,7 @@ void vpMomentAlpha::compute(){
 	//symmetric = symmetric | this->getObject().isSymmetric();
 	bool found_moment_centered;
 
-	const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&> (getMoments().get("vpMomentCentered",
+	const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&> (getDependency("vpMomentCentered",
 			found_moment_centered)));
 
 	if (!found_moment_centered)
@@ -163,7 +165,7 @@ Prints the dependencies of alpha, namely centered moments mu11, mu20 ad mu02
 void  vpMomentAlpha::printDependencies(std::ostream& os) const{
     os << (__FILE__) << std::endl;
     bool found_moment_centered;
-    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&> (getMoments().get("vpMomentCentered",
+    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&> (getDependency("vpMomentCentered",
             found_moment_centered)));
     if (!found_moment_centered)
         throw vpException(vpException::notInitialized, "vpMomentCentered not found");
@@ -48,10 +48,10 @@ void vpMomentArea::compute(){
     /* getObject() returns a reference to a vpMomentObject. This is public member of vpMoment */
     if(getObject().getType()==vpMomentObject::DISCRETE) {
     	bool found_moment_centered;
-		/*   getMoments() returns a reference to a vpMomentDatabase. It is a protected member of and is inherited from vpMoment
-		 *  .get() is a member function of vpMomentDatabase that returns a specific moment which is linked to it
+		/*   getDependency() is a protected member inherited from vpMoment that returns a moment of the linked
+		 *  vpMomentDatabase declared with addDependency() in the constructor
 		 */
-		const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getMoments().get("vpMomentCentered",found_moment_centered));
+		const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getDependency("vpMomentCentered",found_moment_centered));
 		if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
 		values[0] = momentCentered.get(2,0) + momentCentered.get(0,2);
     }
@@ -65,6 +65,7 @@ void vpMomentArea::compute(){
 */
 vpMomentArea::vpMomentArea() : vpMoment(){
     values.resize(1);
+    addDependency("vpMomentCentered");
 }
 
 /*!
@@ -85,7 +86,7 @@ void vpMomentArea::printDependencies(std::ostream& os) const{
     os << (__FILE__) << std::endl;
 
     bool found_moment_centered;
-    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getMoments().get("vpMomentCentered",found_moment_centered));
+    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getDependency("vpMomentCentered",found_moment_centered));
     if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
 
     if(getObject().getType()==vpMomentObject::DISCRETE)
@@ -48,9 +48,9 @@
 void vpMomentAreaNormalized::compute(){
     bool found_moment_centered;        
     
-    /* getMoments() returns a reference to a vpMomentDatabase. (a protected member inherited from vpMoment)
-      .get() 		is a member function of vpMomentDatabase that returns a specific moment which is linked to it*/
-    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getMoments().get("vpMomentCentered",found_moment_centered));
+    /* getDependency() is a protected member inherited from vpMoment that returns a moment of the linked
+      vpMomentDatabase declared with addDependency() in the constructor*/
+    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getDependency("vpMomentCentered",found_moment_centered));
 
     if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
 
@@ -74,6 +74,7 @@ vpMomentAreaNormalized::vpMomentAreaNormalized(double desired_surface, double de
   : vpMoment(),desiredSurface(desired_surface),desiredDepth(desired_depth)
 {
     values.resize(1);
+    addDependency("vpMomentCentered");
 }
 
 /*!
@@ -99,7 +100,7 @@ void vpMomentAreaNormalized::printDependencies(std::ostream& os) const{
     os << "Desired area m00* = " << desiredSurface << std::endl;
 
     bool found_moment_centered;
-    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getMoments().get("vpMomentCentered",found_moment_centered));
+    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getDependency("vpMomentCentered",found_moment_centered));
     if(!found_moment_centered)
         throw vpException(vpException::notInitialized,"vpMomentCentered not found");
 
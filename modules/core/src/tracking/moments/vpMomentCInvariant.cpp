@@ -47,6 +47,7 @@ vpMomentCInvariant::vpMomentCInvariant(bool flg_sxsynormalization)
   : I(16),II(4),c(4),s(4), K(0.0), cn(4),sn(4), In1(0.0), flg_sxsynormalization_(flg_sxsynormalization)
 {
   values.resize(14);
+  addDependency("vpMomentCentered");
 }
 
 /*!
@@ -182,7 +183,7 @@ void vpMomentCInvariant::computeI(const vpMomentCentered& momentCentered, std::v
 void vpMomentCInvariant::compute(){
     if(getObject().getOrder()<5) throw vpException(vpException::notInitialized,"Order is not high enough for vpMomentCInvariant. Specify at least order 5.");
     bool found_moment_centered;
-    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(getMoments().get("vpMomentCentered",found_moment_centered)));
+    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(getDependency("vpMomentCentered",found_moment_centered)));
 
     if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
 
@@ -62,7 +62,7 @@ void vpMomentCentered::compute(){
     bool found_moment_gravity;    
     values.resize((getObject().getOrder()+1)*(getObject().getOrder()+1));
 
-    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMoments().get("vpMomentGravityCenter",found_moment_gravity));
+    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getDependency("vpMomentGravityCenter",found_moment_gravity));
     if(!found_moment_gravity) throw vpException(vpException::notInitialized,"vpMomentGravityCenter not found");
 
     unsigned int order = getObject().getOrder()+1;
@@ -88,7 +88,7 @@ void vpMomentCentered::compute(){
   Default constructor.
 */
 vpMomentCentered::vpMomentCentered() : vpMoment(){
-
+    addDependency("vpMomentGravityCenter");
 }
 
 /*!
@@ -173,7 +173,7 @@ vpMomentCentered::printDependencies(std::ostream& os) const {
     Get xg,yg
     */
     bool found_moment_gravity;
-    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMoments().get("vpMomentGravityCenter",found_moment_gravity));
+    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getDependency("vpMomentGravityCenter",found_moment_gravity));
     if(!found_moment_gravity)
         throw vpException(vpException::notInitialized,"vpMomentGravityCenter not found");
     os << "Xg = " << momentGravity.getXg() << "\t" << "Yg = " << momentGravity.getYg() << std::endl;
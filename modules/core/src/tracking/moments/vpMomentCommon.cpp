@@ -67,8 +67,8 @@ vpMomentCommon::vpMomentCommon(double dstSurface,std::vector<double> ref,double
 /*!
 Updates all moments in the database with the object and computes all their values.
 This is possible because this particular database knows the link between the moments it contains.
-The order of computation is as follows:
-vpMomentGravityCenter,vpMomentCentered,vpMomentAlpha,vpMomentCInvariant,vpMomentSInvariant,vpMomentAreaNormalized,vpMomentGravityCenterNormalized
+The moments are computed with vpMomentDatabase::computeAll(), each moment after the moments it depends on:
+vpMomentBasic,vpMomentGravityCenter,vpMomentCentered,vpMomentAreaNormalized,vpMomentCInvariant,vpMomentAlpha,vpMomentArea,vpMomentGravityCenterNormalized
 \param object : Moment object.
 
 Example of using a preconfigured database to compute one of the C-invariants:
@@ -120,15 +120,7 @@ int main()
 void vpMomentCommon::updateAll(vpMomentObject& object){
     try {
         vpMomentDatabase::updateAll(object);
-
-        momentGravity.compute();
-        momentCentered.compute();
-        momentAlpha.compute();
-        momentCInvariant->compute();
-
-        momentSurfaceNormalized.compute();
-        momentGravityNormalized.compute();
-        momentArea.compute();
+        vpMomentDatabase::computeAll();
 
     } catch(const char* ex){
         std::cout << "exception:" << ex <<std::endl;
@@ -49,7 +49,67 @@
         \attention You cannot add two moments with the same name. The rules for insersion are the same as those of std::map.
 */
 void vpMomentDatabase::add(vpMoment& moment,const char* name){
-    moments.insert(std::pair<const char*,vpMoment*>((const char*)name,&moment));
+    if (moments.insert(std::pair<const char*,vpMoment*>((const char*)name,&moment)).second) {
+      linkedMoments.push_back(&moment);
+      revision++;
+    }
+}
+
+/*!
+  Retrieves a moment from the database.
+  \param type : Name of the moment's class.
+  \return Moment corresponding to \e type or NULL if there is no moment of this type in the database.
+*/
+const vpMoment* vpMomentDatabase::find(const char* type) const {
+  std::map<const char*,vpMoment*,vpMomentDatabase::cmp_str>::const_iterator it = moments.find(type);
+  return (it != moments.end()) ? it->second : NULL;
+}
+
+/*!
+  Sorts the moments so that each moment comes after the moments it depends on. Moments that do not depend
+  on each other keep the order in which they were linked. Dependencies that are not in the database are
+  ignored and the moments of a cycle are kept in the link order.
+*/
+void vpMomentDatabase::sortMoments(){
+  const size_t nb = linkedMoments.size();
+  std::vector<bool> sorted(nb, false);
+  computeOrder.clear();
+  computeOrder.reserve(nb);
+
+  while (computeOrder.size() < nb) {
+    bool progress = false;
+    for (size_t i = 0; i < nb; i++) {
+      if (sorted[i])
+        continue;
+      bool ready = true;
+      const std::vector<const char*>& names = linkedMoments[i]->dependencyNames;
+      for (size_t k = 0; k < names.size() && ready; k++) {
+        const vpMoment* dependency = find(names[k]);
+        for (size_t j = 0; j < nb; j++) {
+          if (linkedMoments[j] == dependency && j != i && !sorted[j]) {
+            ready = false;
+            break;
+          }
+        }
+      }
+      if (ready) {
+        computeOrder.push_back(linkedMoments[i]);
+        sorted[i] = true;
+        progress = true;
+      }
+    }
+    if (!progress) {
+      // Dependency cycle: keep the link order for the remaining moments
+      for (size_t i = 0; i < nb; i++) {
+        if (!sorted[i]) {
+          computeOrder.push_back(linkedMoments[i]);
+          sorted[i] = true;
+        }
+      }
+    }
+  }
+
+  computeOrderRevision = revision;
 }
 
 /*!
@@ -73,10 +133,27 @@ const vpMoment& vpMomentDatabase::get(const char* type, bool& found) const {
     The example provided in the header of this class gives an example that shows how to compute gravity center moment and the centered moment using a mass update.
 */
 void vpMomentDatabase::updateAll(vpMomentObject& object){
-  std::map<const char*,vpMoment*,vpMomentDatabase::cmp_str>::const_iterator itr;
-    for(itr = moments.begin(); itr != moments.end(); ++itr){
-        (*itr).second->update(object);
-    }
+  if (computeOrderRevision != revision)
+    sortMoments();
+
+  for (size_t i = 0; i < computeOrder.size(); i++) {
+    computeOrder[i]->update(object);
+  }
+}
+
+/*!
+  Computes all the moments in the database, each moment being computed after the moments it depends on.
+  The moments have to be updated first, with updateAll() for example.
+
+  The order is computed once, when the first computation follows the link of a moment to the database.
+*/
+void vpMomentDatabase::computeAll(){
+  if (computeOrderRevision != revision)
+    sortMoments();
+
+  for (size_t i = 0; i < computeOrder.size(); i++) {
+    computeOrder[i]->compute();
+  }
 }
 
 /*!
@@ -39,70 +39,188 @@
 #include <visp3/core/vpMomentObject.h>
 #include <visp3/core/vpCameraParameters.h>
 #include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/core/vpConfig.h>
 #include <stdexcept>
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
-#ifdef VISP_HAVE_OPENMP
-#include <omp.h>
-#endif
 #include <cassert>
 
-/*!
-  Computes moments from a vector of points describing a polygon.
-  The points must be stored in a clockwise order. Used internally.
-  \param p : moment order (first index)
-  \param q : moment order (second index)
-  \param points : vector of points in a clockwise order
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
 
-  \return moment value
-*/
-double vpMomentObject::calc_mom_polygon(unsigned int p, unsigned int q, const std::vector<vpPoint>& points)
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace
 {
-  unsigned int i,k,l;
-  double den,mom;
-  double x_p_k;
-  double y_l;
-  double y_q_l;
+// Number of image rows whose moments are summed together before the final reduction. The partition
+// does not depend on the number of threads so that the moments do not either.
+const unsigned int vpMomentRowsPerBlock = 16;
+
+// Sum of the n values of a row.
+double sumRow(const double *values, unsigned int n)
+{
+  unsigned int i = 0;
+  double sum = 0;
+#if VISP_HAVE_SSE2
+  __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(values + i));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(values + i + 2));
+  }
+  double tmp[2];
+  _mm_storeu_pd(tmp, _mm_add_pd(acc0, acc1));
+  sum = tmp[0] + tmp[1];
+#endif
+  for (; i < n; i++)
+    sum += values[i];
+  return sum;
+}
+
+// Multiply the n values of a row by the corresponding values of factors.
+void multiplyRow(double *values, const double *factors, unsigned int n)
+{
+  unsigned int i = 0;
+#if VISP_HAVE_SSE2
+  for (; i + 2 <= n; i += 2)
+    _mm_storeu_pd(values + i, _mm_mul_pd(_mm_loadu_pd(values + i), _mm_loadu_pd(factors + i)));
+#endif
+  for (; i < n; i++)
+    values[i] *= factors[i];
+}
 
-  den = static_cast<double>( (p+q+2)*(p+q+1)*vpMath::comb(p+q,p) );
+/*
+  Sums the moments of blocks of image rows, each block in its own array of partial sums.
+  Each pixel is weighted by 1 when it is above a threshold, or by its normalized intensity
+  (1 - intensity with a white background) for photometric moments.
 
-  mom = 0.0;
-  for (i=1;i<=points.size()-1;i++)
+  Without distortion y is constant along a row, so that the moments of a row are obtained from
+  the sums over the row of w*x^l: m_kl += y^k sum(w x^l). These sums are computed with a
+  multiplication and an addition per pixel and per order.
+*/
+class vpMomentImageBody : public vpParallelLoopBody
+{
+public:
+  vpMomentImageBody(const vpImage<unsigned char> &I, const vpCameraParameters &cam, unsigned int order,
+                    bool photometric, unsigned char threshold, double iscale, bool white,
+                    std::vector<double> &partial)
+    : m_I(I), m_cam(cam), m_order(order), m_photometric(photometric), m_threshold(threshold),
+      m_iscale(iscale), m_white(white), m_partial(partial), m_x(I.getWidth())
   {
-    double s = 0.0;
-    double x_k=1;
-    for (k=0;k<=p;k++)
-    {
-      y_l=1;
-      x_p_k = pow(points[i-1].get_x(), (int)(p-k));
-      for (l=0;l<=q;l++)
-      {
-        y_q_l=pow(points[i-1].get_y(), (int)(q-l));
-
-        s += static_cast<double>(
-              vpMath::comb(k+l,l)
-              *vpMath::comb(p+q-k-l,q-l)
-              *x_k
-              *x_p_k
-              *y_l
-              *y_q_l );
-
-        y_l*=points[i].get_y();
+    for (unsigned int i = 0; i < I.getWidth(); i++) {
+      double y;
+      vpPixelMeterConversion::convertPointWithoutDistortion(cam, i, 0, m_x[i], y);
+    }
+  }
 
-      }
-      x_k*=points[i].get_x();
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const unsigned int width = m_I.getWidth(), height = m_I.getHeight();
+    const unsigned int size = m_order * m_order;
+    const bool distortion = (m_cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion);
+    std::vector<double> px(width), pw(width), sums(m_order);
+
+    for (unsigned int block = start; block < end; block++) {
+      double *partial = &m_partial[block * size];
+      const unsigned int last_row = std::min(height, (block + 1) * vpMomentRowsPerBlock);
+
+      for (unsigned int j = block * vpMomentRowsPerBlock; j < last_row; j++) {
+        const unsigned char *row = m_I[j];
+
+        if (distortion) {
+          for (unsigned int i = 0; i < width; i++) {
+            double w = weight(row[i]);
+            if (w == 0)
+              continue;
+            double x = 0, y = 0;
+            vpPixelMeterConversion::convertPoint(m_cam, i, j, x, y);
+            double yval = w;
+            for (unsigned int k = 0; k < m_order; k++) {
+              double xval = yval;
+              for (unsigned int l = 0; l < m_order - k; l++) {
+                partial[k * m_order + l] += xval;
+                xval *= x;
+              }
+              yval *= y;
+            }
+          }
+          continue;
+        }
+
+        // Gather the abscissa and the weight of the pixels that contribute to the moments
+        unsigned int n = 0;
+        for (unsigned int i = 0; i < width; i++) {
+          double w = weight(row[i]);
+          if (w != 0) {
+            px[n] = m_x[i];
+            pw[n] = w;
+            n++;
+          }
+        }
+        if (n == 0)
+          continue;
 
+        for (unsigned int l = 0; l < m_order; l++) {
+          sums[l] = sumRow(&pw[0], n);
+          if (l + 1 < m_order)
+            multiplyRow(&pw[0], &px[0], n);
+        }
+
+        double x, y;
+        vpPixelMeterConversion::convertPointWithoutDistortion(m_cam, 0, j, x, y);
+        double yval = 1.;
+        for (unsigned int k = 0; k < m_order; k++) {
+          for (unsigned int l = 0; l < m_order - k; l++) {
+            partial[k * m_order + l] += yval * sums[l];
+          }
+          yval *= y;
+        }
+      }
     }
+  }
 
-    s *= ((points[i-1].get_x())*(points[i].get_y())-(points[i].get_x())*(points[i-1].get_y()));
-    mom += s;
+private:
+  double weight(unsigned char value) const
+  {
+    if (!m_photometric)
+      return (value > m_threshold) ? 1. : 0.;
+    double intensity = (double) value * m_iscale;
+    return m_white ? 1. - intensity : intensity;
   }
-  mom /= den;
-  return(mom);
+
+  const vpImage<unsigned char> &m_I;
+  const vpCameraParameters &m_cam;
+  unsigned int m_order;
+  bool m_photometric;
+  unsigned char m_threshold;
+  double m_iscale;
+  bool m_white;
+  std::vector<double> &m_partial;
+  std::vector<double> m_x;
+};
+
+// Computes the moments of an image, summing the partial sums of the blocks of rows in a fixed order.
+void imageMoments(const vpImage<unsigned char> &I, const vpCameraParameters &cam, unsigned int order,
+                  bool photometric, unsigned char threshold, double iscale, bool white, std::vector<double> &values)
+{
+  const unsigned int size = order * order;
+  const unsigned int nb_blocks = (I.getHeight() + vpMomentRowsPerBlock - 1) / vpMomentRowsPerBlock;
+  std::vector<double> partial(nb_blocks * size, 0.);
+  vpThreadPool::parallelFor(0, nb_blocks, vpMomentImageBody(I, cam, order, photometric, threshold, iscale, white, partial));
+
+  values.assign(size, 0.);
+  for (unsigned int block = 0; block < nb_blocks; block++) {
+    for (unsigned int k = 0; k < size; k++) {
+      values[k] += partial[block * size + k];
+    }
+  }
+}
 }
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
   Caching to avoid redundant multiplications.
@@ -133,32 +251,6 @@ void vpMomentObject::cacheValues(std::vector<double>& cache,double x, double y){
     }
 }
 
-/*!
- * Manikandan.B
- * Need to cache intensity along with the coordinates for photometric moments
- */
-void vpMomentObject::cacheValues(std::vector<double>& cache,double x, double y, double IntensityNormalized) {
-
-    cache[0]=IntensityNormalized;
-
-    double invIntensityNormalized = 0.;
-    if (std::fabs(IntensityNormalized)>=std::numeric_limits<double>::epsilon())
-         invIntensityNormalized = 1.0/IntensityNormalized;
-
-    for(unsigned int i=1;i<order;i++)
-        cache[i]=cache[i-1]*x;
-
-    for(unsigned int j=order;j<order*order;j+=order)
-        cache[j]=cache[j-order]*y;
-
-    for(unsigned int j=1;j<order;j++){
-        for(unsigned int i=1;i<order-j;i++){
-            cache[j*order+i] = cache[j*order]*cache[i]*invIntensityNormalized;
-        }
-    }
-}
-
-
 /*!
   Computes basic moments from a vector of points.
   There are two cases:
@@ -238,18 +330,71 @@ void vpMomentObject::fromVector(std::vector<vpPoint>& points){
       points.resize(points.size()+1);
       points[points.size()-1] = points[0];
     }
-    for(unsigned int j=0;j<order*order;j++){
-      values[j]=calc_mom_polygon(j%order,j/order,points);
+
+    /*
+      Green's theorem gives for each edge (x0,y0)-(x1,y1) of the polygon a contribution to m_pq of
+      (x0 y1 - x1 y0) sum_k sum_l C(k+l,l) C(p+q-k-l,q-l) x1^k x0^(p-k) y1^l y0^(q-l)
+      divided by (p+q+2)(p+q+1)C(p+q,p). The binomial products are computed once and the
+      powers of the vertex coordinates are obtained by successive multiplications.
+    */
+    std::vector<double> coef(order*order*order*order);
+    for(unsigned int q=0;q<order;q++){
+      for(unsigned int p=0;p<order;p++){
+        for(unsigned int k=0;k<=p;k++){
+          for(unsigned int l=0;l<=q;l++){
+            coef[((q*order+p)*order+k)*order+l] = static_cast<double>( vpMath::comb(k+l,l)*vpMath::comb(p+q-k-l,q-l) );
+          }
+        }
+      }
+    }
+
+    std::vector<double> x0_pow(order), y0_pow(order), x1_pow(order), y1_pow(order);
+    std::fill(values.begin(), values.begin()+order*order, 0.);
+    for(unsigned int i=1;i<points.size();i++){
+      double x0 = points[i-1].get_x(), y0 = points[i-1].get_y();
+      double x1 = points[i].get_x(), y1 = points[i].get_y();
+      x0_pow[0] = y0_pow[0] = x1_pow[0] = y1_pow[0] = 1.;
+      for(unsigned int k=1;k<order;k++){
+        x0_pow[k] = x0_pow[k-1]*x0;
+        y0_pow[k] = y0_pow[k-1]*y0;
+        x1_pow[k] = x1_pow[k-1]*x1;
+        y1_pow[k] = y1_pow[k-1]*y1;
+      }
+      double cross = x0*y1 - x1*y0;
+
+      for(unsigned int q=0;q<order;q++){
+        for(unsigned int p=0;p<order;p++){
+          const double *c_pq = &coef[(q*order+p)*order*order];
+          double s = 0.0;
+          for(unsigned int k=0;k<=p;k++){
+            const double x_k = x1_pow[k]*x0_pow[p-k];
+            const double *c_pqk = c_pq + k*order;
+            for(unsigned int l=0;l<=q;l++){
+              s += c_pqk[l]*x_k*y1_pow[l]*y0_pow[q-l];
+            }
+          }
+          values[q*order+p] += s*cross;
+        }
+      }
+    }
+
+    for(unsigned int q=0;q<order;q++){
+      for(unsigned int p=0;p<order;p++){
+        values[q*order+p] /= static_cast<double>( (p+q+2)*(p+q+1)*vpMath::comb(p+q,p) );
+      }
     }
   } else {
-    std::vector<double> cache(order*order,0.);
     values.assign(order*order,0);
     for(unsigned int i=0;i<points.size();i++){
-      cacheValues(cache,points[i].get_x(),points[i].get_y());
+      double x = points[i].get_x(), y = points[i].get_y();
+      double yval=1.;
       for(unsigned int j=0;j<order;j++){
+        double xval=yval;
         for(unsigned int k=0;k<order-j;k++){
-          values[j*order+k]+=cache[j*order+k];
+          values[j*order+k]+=xval;
+          xval*=x;
         }
+        yval*=y;
       }
     }
   }
@@ -263,6 +408,9 @@ void vpMomentObject::fromVector(std::vector<vpPoint>& points){
   \param threshold : Pixels with a luminance lower than this threshold will be considered.
   \param cam : Camera parameters used to convert pixels coordinates in meters in the image plane.
 
+  The rows of the image are processed in parallel with vpThreadPool. The moments do not depend on
+  the number of threads.
+
   The code below shows how to use this function.
   \code
 #include <visp3/core/vpMomentObject.h>
@@ -285,68 +433,7 @@ int main()
 */
 
 void vpMomentObject::fromImage(const vpImage<unsigned char>& image, unsigned char threshold, const vpCameraParameters& cam){
-#ifdef VISP_HAVE_OPENMP
-  #pragma omp parallel shared(threshold)
-  {
-    std::vector<double> curvals(order*order);
-    curvals.assign(order*order,0.);
-
-    #pragma omp for nowait//automatically organize loop counter between threads
-    for(int i=0;i<(int)image.getCols();i++){
-      for(int j=0;j<(int)image.getRows();j++){
-        unsigned int i_ = static_cast<unsigned int>(i);
-        unsigned int j_ = static_cast<unsigned int>(j);
-        if(image[j_][i_]>threshold){
-          double x=0;
-          double y=0;
-          vpPixelMeterConversion::convertPoint(cam,i_,j_,x,y);
-
-          double yval=1.;
-          for(unsigned int k=0;k<order;k++){
-            double xval=1.;
-            for(unsigned int l=0;l<order-k;l++){
-              curvals[(k*order+l)]+=(xval*yval);
-              xval*=x;
-            }
-            yval*=y;
-          }
-        }
-      }
-    }
-
-    #pragma omp master //only set this variable in master thread
-    {
-      values.assign(order*order, 0.);
-    }
-
-    #pragma omp barrier
-    for(unsigned int k=0;k<order;k++){
-      for(unsigned int l=0;l<order-k;l++){
-        #pragma omp atomic
-        values[k*order+l]+= curvals[k*order+l];
-      }
-    }
-
-  }
-#else
-    std::vector<double> cache(order*order,0.);
-    values.assign(order*order,0);
-    for(unsigned int i=0;i<image.getCols();i++){
-        for(unsigned int j=0;j<image.getRows();j++){
-            if(image[j][i]>threshold){
-                double x=0;
-                double y=0;
-                vpPixelMeterConversion::convertPoint(cam,i,j,x,y);
-                cacheValues(cache,x,y);
-                for(unsigned int k=0;k<order;k++){
-                    for(unsigned int l=0;l<order-k;l++){
-                        values[k*order+l]+=cache[k*order+l];
-                    }
-                }
-            }
-        }
-    }
-#endif
+    imageMoments(image, cam, order, false, threshold, 1., false, values);
 
     //Normalisation equivalent to sampling interval/pixel size delX x delY
     double norm_factor = 1./(cam.get_px()*cam.get_py());
@@ -368,73 +455,14 @@ void vpMomentObject::fromImage(const vpImage<unsigned char>& image, unsigned cha
 void vpMomentObject::fromImage(const vpImage<unsigned char>& image, const vpCameraParameters& cam,
     vpCameraImgBckGrndType bg_type, bool normalize_with_pix_size)
 {
-  std::vector<double> cache(order*order,0.);
-  values.assign(order*order,0);
-
-  // (x,y) - Pixel co-ordinates in metres
-  double x=0;
-  double y=0;
-  //for indexing into cache[] and values[]
-  unsigned int idx = 0;
-  unsigned int kidx = 0;
-
-  double intensity = 0;
-
-  //double Imax = static_cast<double>(image.getMaxValue());
-
   double iscale = 1.0;
   if (flg_normalize_intensity) {                                            // This makes the image a probability density function
     double Imax = 255.;                                                     // To check the effect of gray level change. ISR Coimbra
     iscale = 1.0/Imax;
   }
 
-  if (bg_type == vpMomentObject::WHITE) {
-      /////////// WHITE BACKGROUND ///////////
-      for(unsigned int j=0;j<image.getRows();j++){
-          for(unsigned int i=0;i<image.getCols();i++){
-              x = 0;
-              y = 0;
-              intensity = (double)(image[j][i])*iscale;
-              double intensity_white = 1. - intensity;
-
-              vpPixelMeterConversion::convertPoint(cam,i,j,x,y);
-              cacheValues(cache,x,y, intensity_white);			// Modify 'cache' which has x^p*y^q to x^p*y^q*(1 - I(x,y))
-
-              // Copy to "values"
-              for(unsigned int k=0;k<order;k++){
-                  kidx = k*order;
-                  for(unsigned int l=0;l<order-k;l++){
-                      idx = kidx+l;
-                      values[idx]+= cache[idx];
-                  }
-              }
-          }
-      }
-  }
-  else {
-      /////////// BLACK BACKGROUND	///////////
-      for(unsigned int j=0;j<image.getRows();j++){
-          for(unsigned int i=0;i<image.getCols();i++){
-              x = 0;
-              y = 0;
-              intensity = (double)(image[j][i])*iscale;
-              vpPixelMeterConversion::convertPoint(cam,i,j,x,y);
-
-              // Cache values for fast moment calculation
-              cacheValues(cache,x,y, intensity);					// Modify 'cache' which has x^p*y^q to x^p*y^q*I(x,y)
-
-              // Copy to moments array 'values'
-              for(unsigned int k=0;k<order;k++){
-                  kidx = k*order;
-                  for(unsigned int l=0;l<order-k;l++){
-                      idx = kidx+l;
-                      values[idx]+= cache[idx];
-                  }
-              }
-
-          }
-      }
-  }
+  // Each pixel (x,y) adds x^p*y^q*I(x,y) to m_pq, or x^p*y^q*(1 - I(x,y)) with a white background
+  imageMoments(image, cam, order, true, 0, iscale, bg_type == vpMomentObject::WHITE, values);
 
   if (normalize_with_pix_size){
       // Normalisation equivalent to sampling interval/pixel size delX x delY
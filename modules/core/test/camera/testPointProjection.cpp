@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the projection of arrays of points.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testPointProjection.cpp
+
+  Compare the projection of arrays of points with vpPoint::projectPoints()
+  and vpMeterPixelConversion::convertPoints() to the projection of each
+  point with vpPoint::track() and vpMeterPixelConversion::convertPoint(),
+  with and without distortion, and compare the projection times.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+bool same(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-12 * std::max(1., std::fabs(b));
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the projection of arrays of points.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+
+    vpHomogeneousMatrix cMo(0.1, -0.2, 1.5, vpMath::rad(10), vpMath::rad(-20), vpMath::rad(30));
+    vpCameraParameters cams[2];
+    cams[0].initPersProjWithoutDistortion(600, 610, 320, 240);
+    cams[1].initPersProjWithDistortion(600, 610, 320, 240, -0.2, 0.25);
+
+    // Even and odd numbers of points
+    const unsigned int sizes[4] = { 0, 1, 7, 10000 };
+    for (unsigned int c = 0; c < 4; c++) {
+      const unsigned int n = sizes[c];
+      std::vector<double> oX(n), oY(n), oZ(n);
+      std::vector<vpPoint> points(n);
+      for (unsigned int i = 0; i < n; i++) {
+        oX[i] = rand() - 0.5;
+        oY[i] = rand() - 0.5;
+        oZ[i] = rand() - 0.5;
+        points[i].setWorldCoordinates(oX[i], oY[i], oZ[i]);
+      }
+
+      for (unsigned int k = 0; k < 2; k++) {
+        // Point by point
+        std::vector<double> u_ref(n), v_ref(n), x_ref(n), y_ref(n), Z_ref(n);
+        double t = vpTime::measureTimeMs();
+        for (unsigned int i = 0; i < n; i++) {
+          points[i].track(cMo);
+          x_ref[i] = points[i].get_x();
+          y_ref[i] = points[i].get_y();
+          Z_ref[i] = points[i].get_Z();
+          vpMeterPixelConversion::convertPoint(cams[k], x_ref[i], y_ref[i], u_ref[i], v_ref[i]);
+        }
+        double t_point = vpTime::measureTimeMs() - t;
+
+        // All at once
+        std::vector<double> x(n), y(n), Z(n), u, v;
+        t = vpTime::measureTimeMs();
+        if (n > 0)
+          vpPoint::projectPoints(cMo, &oX[0], &oY[0], &oZ[0], n, &x[0], &y[0], &Z[0]);
+        vpMeterPixelConversion::convertPoints(cams[k], x, y, u, v);
+        double t_batch = vpTime::measureTimeMs() - t;
+
+        bool equal = (u.size() == n && v.size() == n);
+        for (unsigned int i = 0; i < n && equal; i++) {
+          equal &= same(x[i], x_ref[i]) && same(y[i], y_ref[i]) && same(Z[i], Z_ref[i]) &&
+                   same(u[i], u_ref[i]) && same(v[i], v_ref[i]);
+        }
+        std::stringstream ss;
+        ss << n << " points " << (k == 0 ? "without" : "with") << " distortion (point by point: " << t_point
+           << " ms, all at once: " << t_batch << " ms)";
+        if (!equal) {
+          throw vpException(vpException::fatalError, "%s failed", ss.str().c_str());
+        }
+      }
+
+      // Vector interface and conversion in place
+      std::vector<double> x, y;
+      vpPoint::projectPoints(cMo, oX, oY, oZ, x, y);
+      std::vector<double> u = x, v = y;
+      vpMeterPixelConversion::convertPoints(cams[1], x, y, u, v);
+      if (n > 0)
+        vpMeterPixelConversion::convertPoints(cams[1], &x[0], &y[0], n, &x[0], &y[0]);
+      bool equal = (x.size() == n);
+      for (unsigned int i = 0; i < n && equal; i++)
+        equal &= (x[i] == u[i] && y[i] == v[i]);
+      std::stringstream ss;
+      ss << n << " points in place";
+      if (!equal) {
+        throw vpException(vpException::fatalError, "%s failed", ss.str().c_str());
+      }
+    }
+
+    // Vectors of different sizes
+    bool thrown = false;
+    try {
+      std::vector<double> x(3), y(2), u, v;
+      vpMeterPixelConversion::convertPoints(cams[0], x, y, u, v);
+    }
+    catch (const vpException &) {
+      thrown = true;
+    }
+    if (!thrown) {
+      throw vpException(vpException::fatalError, "Different sizes failed");
+    }
+
+    std::cout << "Point projection test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
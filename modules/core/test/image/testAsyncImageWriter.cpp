@@ -0,0 +1,277 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Write images asynchronously on the disk.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testAsyncImageWriter.cpp
+
+  \brief Write images with vpAsyncImageWriter and with the asynchronous mode
+  of vpVideoWriter, then read them back. Also count the frames dropped when
+  the queue is full.
+
+*/
+
+#include <stdio.h>
+#include <iostream>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/io/vpAsyncImageWriter.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/io/vpVideoWriter.h>
+
+// List of allowed command line options
+#define GETOPTARGS	"cdo:h"
+
+void usage(const char *name, const char *badparam, const std::string &opath, const std::string &user);
+bool getOptions(int argc, const char **argv, std::string &opath, const std::string &user);
+
+/*
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+  \param opath : Output image path.
+  \param user : Username.
+
+ */
+void usage(const char *name, const char *badparam, const std::string &opath, const std::string &user)
+{
+  fprintf(stdout, "\n\
+Write images asynchronously on the disk and read them back.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output image path>] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               Default\n\
+  -o <output image path>                               %s\n\
+     Set image output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the images are written.\n\
+\n\
+  -h\n\
+     Print the help.\n\n",
+          opath.c_str(), user.c_str());
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param opath : Output image path.
+  \param user : Username.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv, std::string &opath, const std::string &user)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'o': opath = optarg_; break;
+    case 'h': usage(argv[0], NULL, opath, user); return false; break;
+
+    case 'c':
+    case 'd':
+      break;
+
+    default:
+      usage(argv[0], optarg_, opath, user); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int
+main(int argc, const char ** argv)
+{
+  try {
+    std::string opt_opath;
+    std::string opath;
+    std::string username;
+    char filename[FILENAME_MAX];
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username) == false) {
+      exit (-1);
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+    opath = vpIoTools::createFilePath(opath, "async-writer");
+
+    // Test if the output path exist. If no try to create it
+    if (vpIoTools::checkDirectory(opath) == false) {
+      vpIoTools::makeDirectory(opath);
+    }
+
+    //
+    // Here starts really the test
+    //
+
+    const unsigned int nbFrames = 20;
+    std::vector<vpImage<unsigned char> > frames(nbFrames, vpImage<unsigned char>(120, 160));
+    std::vector<vpImage<vpRGBa> > colorFrames(nbFrames, vpImage<vpRGBa>(120, 160));
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      for (unsigned int i = 0; i < frames[k].getSize(); i++) {
+        frames[k].bitmap[i] = (unsigned char)(i * (k + 1));
+        colorFrames[k].bitmap[i] = vpRGBa((unsigned char)(i + k), (unsigned char)(2 * i), (unsigned char)(3 * k), 255);
+      }
+    }
+
+    // In blocking mode, all the images are written and read back identical
+    {
+      vpAsyncImageWriter writer(4, 2);
+      writer.setBlocking(true);
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        sprintf(filename, "%s/gray%04d.pgm", opath.c_str(), k);
+        writer.write(frames[k], filename);
+        sprintf(filename, "%s/color%04d.ppm", opath.c_str(), k);
+        writer.write(colorFrames[k], filename);
+      }
+      writer.flush();
+      if (writer.getWrittenCount() != 2 * nbFrames || writer.getDroppedCount() != 0 || writer.getErrorCount() != 0) {
+        throw vpException(vpException::fatalError, "Problem with the number of images written in blocking mode !");
+      }
+    }
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      vpImage<unsigned char> I;
+      vpImage<vpRGBa> Irgba;
+      sprintf(filename, "%s/gray%04d.pgm", opath.c_str(), k);
+      vpImageIo::read(I, filename);
+      if (I != frames[k]) {
+        throw vpException(vpException::fatalError, "Problem with the grey image read back from %s !", filename);
+      }
+      vpIoTools::remove(filename);
+      sprintf(filename, "%s/color%04d.ppm", opath.c_str(), k);
+      vpImageIo::read(Irgba, filename);
+      if (Irgba != colorFrames[k]) {
+        throw vpException(vpException::fatalError, "Problem with the color image read back from %s !", filename);
+      }
+      vpIoTools::remove(filename);
+    }
+
+    // Image sequence written by vpVideoWriter with a queue of a single image: the frames saved while the
+    // previous one is being written are dropped, but keep their number in the sequence
+    vpImage<unsigned char> I_large(2000, 2000);
+    for (unsigned int i = 0; i < I_large.getSize(); i++)
+      I_large.bitmap[i] = (unsigned char)(i % 251);
+    std::string sequence = vpIoTools::createFilePath(opath, "frame%04d.pgm");
+    unsigned int nbDropped;
+    {
+      vpVideoWriter writer;
+      writer.setAsyncWriting(true, 1);
+      writer.setFileName(sequence.c_str());
+      writer.open(I_large);
+      for (unsigned int k = 0; k < nbFrames; k++) {
+        I_large.bitmap[0] = (unsigned char)k;
+        writer.saveFrame(I_large);
+      }
+      writer.close();
+      nbDropped = writer.getDroppedFrameCount();
+    }
+    std::cout << "Frames dropped with a queue of 1 image: " << nbDropped << " / " << nbFrames << std::endl;
+    if (nbDropped == 0 || nbDropped >= nbFrames) {
+      throw vpException(vpException::fatalError, "Problem with the number of dropped frames !");
+    }
+
+    unsigned int nbFound = 0;
+    for (unsigned int k = 0; k < nbFrames; k++) {
+      sprintf(filename, sequence.c_str(), k);
+      if (! vpIoTools::checkFilename(filename))
+        continue;
+      nbFound ++;
+      vpImage<unsigned char> I;
+      vpImageIo::read(I, filename);
+      I_large.bitmap[0] = (unsigned char)k;
+      if (I != I_large) {
+        throw vpException(vpException::fatalError, "Problem with the frame read back from %s !", filename);
+      }
+      vpIoTools::remove(filename);
+    }
+    if (nbFound != nbFrames - nbDropped) {
+      throw vpException(vpException::fatalError, "Problem with the number of frames written: %d instead of %d !",
+                        nbFound, nbFrames - nbDropped);
+    }
+
+    std::cout << "Asynchronous image writer test succeed" << std::endl;
+    return 0;
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "You do not have threading capabilities" << std::endl;
+  return 0;
+}
+#endif
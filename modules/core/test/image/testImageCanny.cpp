@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Test the Canny edge detector.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageCanny.cpp
+
+  Test vpImageFilter::canny() on a synthetic image: the edges are found along
+  the borders of the objects, the hysteresis keeps the weak edges connected
+  to strong edges only, and the result does not depend on the number of
+  threads.
+*/
+
+#include <iostream>
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+unsigned int countEdges(const vpImage<unsigned char> &I, unsigned int top, unsigned int left, unsigned int bottom,
+                        unsigned int right)
+{
+  unsigned int count = 0;
+  for (unsigned int i = top; i < bottom; i++) {
+    for (unsigned int j = left; j < right; j++) {
+      if (I[i][j] == 255)
+        count++;
+    }
+  }
+  return count;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the Canny edge detector.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    // A rectangle with a high contrast left part smoothly going to a low contrast right part, and a low contrast square
+    vpImage<unsigned char> I(160, 200, 0);
+    for (unsigned int i = 20; i < 80; i++) {
+      for (unsigned int j = 20; j < 180; j++) {
+        if (j < 60)
+          I[i][j] = 200;
+        else if (j < 140)
+          I[i][j] = (unsigned char) (200 - (170 * (j - 60)) / 80);
+        else
+          I[i][j] = 30;
+      }
+    }
+    for (unsigned int i = 110; i < 140; i++) {
+      for (unsigned int j = 40; j < 70; j++) {
+        I[i][j] = 30;
+      }
+    }
+
+    vpImage<unsigned char> I_strong, I_weak, I_hysteresis;
+    vpImageFilter::canny(I, I_strong, 5, 150, 3);
+    vpImageFilter::canny(I, I_weak, 5, 20, 3);
+    vpImageFilter::canny(I, I_hysteresis, 5, 20, 150, 3);
+
+    // Edges along the borders of the high contrast part, and nowhere inside the objects
+    unsigned int top = countEdges(I_strong, 17, 25, 23, 55), left = countEdges(I_strong, 25, 17, 75, 23);
+    std::cout << "Edges on the top and left borders: " << top << " " << left << std::endl;
+    if (!(top >= 30 && left >= 50)) {
+      throw vpException(vpException::fatalError, "Edges along the borders failed");
+    }
+    if (countEdges(I_weak, 24, 24, 76, 176) != 0) {
+      throw vpException(vpException::fatalError, "No edge inside the rectangle failed");
+    }
+
+    // The low contrast borders are kept by the hysteresis only when they are connected to a strong edge
+    if (countEdges(I_strong, 105, 35, 145, 75) != 0) {
+      throw vpException(vpException::fatalError, "Low contrast square with a single high threshold failed");
+    }
+    if (countEdges(I_weak, 105, 35, 145, 75) <= 0) {
+      throw vpException(vpException::fatalError, "Low contrast square with a single low threshold failed");
+    }
+    if (countEdges(I_hysteresis, 105, 35, 145, 75) != 0) {
+      throw vpException(vpException::fatalError, "Low contrast square with hysteresis failed");
+    }
+    if (countEdges(I_strong, 15, 145, 85, 185) != 0) {
+      throw vpException(vpException::fatalError, "Low contrast part with a single high threshold failed");
+    }
+    if (countEdges(I_hysteresis, 15, 145, 85, 185) <= 100) {
+      throw vpException(vpException::fatalError, "Low contrast part with hysteresis failed");
+    }
+
+    // In place filtering and number of threads
+    vpImage<unsigned char> I_inplace = I, I_threads;
+    vpImageFilter::canny(I_inplace, I_inplace, 5, 20, 150, 3);
+    if (I_inplace != I_hysteresis) {
+      throw vpException(vpException::fatalError, "In place filtering failed");
+    }
+    vpThreadPool::setConcurrency(3);
+    vpImageFilter::canny(I, I_threads, 5, 20, 150, 3);
+    vpThreadPool::setConcurrency(0);
+    if (I_threads != I_hysteresis) {
+      throw vpException(vpException::fatalError, "Filtering with 3 threads failed");
+    }
+
+    // Other Sobel apertures
+    vpImage<unsigned char> I_aperture;
+    vpImageFilter::canny(I, I_aperture, 5, 600, 5);
+    if (countEdges(I_aperture, 17, 25, 23, 55) < 30) {
+      throw vpException(vpException::fatalError, "Sobel aperture 5 failed");
+    }
+    vpImageFilter::canny(I, I_aperture, 3, 3000, 7);
+    if (countEdges(I_aperture, 17, 25, 23, 55) < 30) {
+      throw vpException(vpException::fatalError, "Sobel aperture 7 failed");
+    }
+    bool thrown = false;
+    try {
+      vpImageFilter::canny(I, I_aperture, 5, 20, 4);
+    }
+    catch (const vpException &) {
+      thrown = true;
+    }
+    if (!thrown) {
+      throw vpException(vpException::fatalError, "Bad Sobel aperture failed");
+    }
+
+    vpImage<unsigned char> I_large(480, 640);
+    for (unsigned int i = 0; i < I_large.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_large.getWidth(); j++) {
+        I_large[i][j] = ((i / 40 + j / 40) % 2) ? 200 : 50;
+      }
+    }
+    double t = vpTime::measureTimeMs();
+    vpImageFilter::canny(I_large, I_aperture, 5, 20, 3);
+    std::cout << "Canny time on a 640x480 image: " << vpTime::measureTimeMs() - t << " ms" << std::endl;
+
+    std::cout << "Canny test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
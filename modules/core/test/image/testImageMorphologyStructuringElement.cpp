@@ -0,0 +1,353 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Test morphology with rectangle and line structuring elements.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageMorphologyStructuringElement.cpp
+
+  Compare the erosion and dilatation of vpImageMorphology by rectangles and
+  lines of any size with a direct implementation, check that the result does
+  not depend on the number of threads, check the opening, closing, top-hats
+  and gradient, and compare the time with repeated 3x3 erosions.
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpImageMorphology.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Pixels of the structuring element relative to the pixel (width/2, height/2)
+void elementOffsets(unsigned int width, unsigned int height, vpImageMorphology::vpStructuringElementType element,
+                    std::vector<int> &dy, std::vector<int> &dx)
+{
+  const int w = (int) width, h = (int) height;
+  dy.clear();
+  dx.clear();
+  if (element == vpImageMorphology::STRUCTURING_ELEMENT_RECTANGLE) {
+    for (int i = 0; i < h; i++) {
+      for (int j = 0; j < w; j++) {
+        dy.push_back(i - h / 2);
+        dx.push_back(j - w / 2);
+      }
+    }
+  } else {
+    for (int i = 0; i < h; i++) {
+      dy.push_back(i - h / 2);
+      // The antidiagonal goes from the bottom left to the top right corner
+      dx.push_back((element == vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL ? i : w - 1 - i) - w / 2);
+    }
+  }
+}
+
+void erosionReference(const vpImage<unsigned char> &I, vpImage<unsigned char> &Ie, unsigned int width,
+                      unsigned int height, vpImageMorphology::vpStructuringElementType element)
+{
+  std::vector<int> dy, dx;
+  elementOffsets(width, height, element, dy, dx);
+  Ie.resize(I.getHeight(), I.getWidth());
+  for (int r = 0; r < (int) I.getHeight(); r++) {
+    for (int c = 0; c < (int) I.getWidth(); c++) {
+      unsigned char value = 255;
+      for (size_t k = 0; k < dy.size(); k++) {
+        int y = r + dy[k], x = c + dx[k];
+        if (y >= 0 && y < (int) I.getHeight() && x >= 0 && x < (int) I.getWidth() && I[y][x] < value)
+          value = I[y][x];
+      }
+      Ie[r][c] = value;
+    }
+  }
+}
+
+// The dilatation uses the reflected structuring element
+void dilatationReference(const vpImage<unsigned char> &I, vpImage<unsigned char> &Id, unsigned int width,
+                         unsigned int height, vpImageMorphology::vpStructuringElementType element)
+{
+  std::vector<int> dy, dx;
+  elementOffsets(width, height, element, dy, dx);
+  Id.resize(I.getHeight(), I.getWidth());
+  for (int r = 0; r < (int) I.getHeight(); r++) {
+    for (int c = 0; c < (int) I.getWidth(); c++) {
+      unsigned char value = 0;
+      for (size_t k = 0; k < dy.size(); k++) {
+        int y = r - dy[k], x = c - dx[k];
+        if (y >= 0 && y < (int) I.getHeight() && x >= 0 && x < (int) I.getWidth() && I[y][x] > value)
+          value = I[y][x];
+      }
+      Id[r][c] = value;
+    }
+  }
+}
+
+// Random blocks with noise, so that large structuring elements do not give a constant image
+void createImage(vpUniRand &rand, vpImage<unsigned char> &I, unsigned int height, unsigned int width)
+{
+  I.resize(height, width);
+  for (unsigned int r = 0; r < height; r++) {
+    for (unsigned int c = 0; c < width; c++) {
+      I[r][c] = (unsigned char) (rand() * 40 + (((r / 7) * 13 + (c / 5) * 29) % 200));
+    }
+  }
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the morphological operations with rectangle and line structuring elements.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+
+    // Width not a multiple of 16 to use the scalar tails
+    vpImage<unsigned char> I;
+    createImage(rand, I, 61, 83);
+
+    const unsigned int nbRectangles = 9;
+    const unsigned int widths[nbRectangles] = { 1, 3, 4, 15, 1, 2, 25, 120, 7 };
+    const unsigned int heights[nbRectangles] = { 1, 3, 6, 1, 9, 2, 25, 3, 70 };
+    const unsigned int nbLines = 5;
+    const unsigned int sizes[nbLines] = { 2, 3, 8, 21, 90 };
+
+    std::vector<unsigned int> w, h;
+    std::vector<vpImageMorphology::vpStructuringElementType> elements;
+    for (unsigned int i = 0; i < nbRectangles; i++) {
+      w.push_back(widths[i]);
+      h.push_back(heights[i]);
+      elements.push_back(vpImageMorphology::STRUCTURING_ELEMENT_RECTANGLE);
+    }
+    for (unsigned int i = 0; i < nbLines; i++) {
+      for (unsigned int e = 0; e < 2; e++) {
+        w.push_back(sizes[i]);
+        h.push_back(sizes[i]);
+        elements.push_back(e == 0 ? vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL
+                                  : vpImageMorphology::STRUCTURING_ELEMENT_ANTIDIAGONAL);
+      }
+    }
+
+    const char *names[3] = { "rectangle", "diagonal", "antidiagonal" };
+    for (size_t i = 0; i < elements.size(); i++) {
+      std::stringstream ss;
+      ss << w[i] << "x" << h[i] << " " << names[elements[i]];
+
+      vpImage<unsigned char> Ie_ref, Id_ref;
+      erosionReference(I, Ie_ref, w[i], h[i], elements[i]);
+      dilatationReference(I, Id_ref, w[i], h[i], elements[i]);
+
+      // One thread, and bands of rows smaller than the structuring element
+      bool same_erosion = true, same_dilatation = true;
+      for (unsigned int nbThreads = 1; nbThreads <= 7; nbThreads += 6) {
+        vpThreadPool::setConcurrency(nbThreads);
+        vpImage<unsigned char> Ie(I), Id(I);
+        vpImageMorphology::erosion(Ie, w[i], h[i], elements[i]);
+        vpImageMorphology::dilatation(Id, w[i], h[i], elements[i]);
+        same_erosion &= (Ie == Ie_ref);
+        same_dilatation &= (Id == Id_ref);
+      }
+      vpThreadPool::setConcurrency(0);
+      if (!same_erosion) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + " erosion").c_str());
+      }
+      if (!same_dilatation) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + " dilatation").c_str());
+      }
+
+      // Opening is anti-extensive and idempotent, closing is extensive
+      vpImage<unsigned char> Io(I), Ioo, Ic(I), Iw(I), Ib(I), Ig(I);
+      vpImageMorphology::opening(Io, w[i], h[i], elements[i]);
+      Ioo = Io;
+      vpImageMorphology::opening(Ioo, w[i], h[i], elements[i]);
+      vpImageMorphology::closing(Ic, w[i], h[i], elements[i]);
+      vpImageMorphology::topHat(Iw, w[i], h[i], elements[i]);
+      vpImageMorphology::blackHat(Ib, w[i], h[i], elements[i]);
+      vpImageMorphology::gradient(Ig, w[i], h[i], elements[i]);
+      bool opening_ok = (Io == Ioo), closing_ok = true, hats_ok = true;
+      for (unsigned int k = 0; k < I.getSize(); k++) {
+        opening_ok &= (Io.bitmap[k] <= I.bitmap[k]);
+        closing_ok &= (Ic.bitmap[k] >= I.bitmap[k]);
+        // The dilatation can be below the erosion when the element does not contain its center (even antidiagonal)
+        int g = std::max((int) Id_ref.bitmap[k] - (int) Ie_ref.bitmap[k], 0);
+        hats_ok &= (Iw.bitmap[k] == I.bitmap[k] - Io.bitmap[k]) && (Ib.bitmap[k] == Ic.bitmap[k] - I.bitmap[k]) &&
+                   (Ig.bitmap[k] == g);
+      }
+      if (!(opening_ok && closing_ok)) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + " opening and closing").c_str());
+      }
+      if (!hats_ok) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + " top-hats and gradient").c_str());
+      }
+    }
+
+    // Same result as the 3x3 operators in connexity 8
+    {
+      vpImage<unsigned char> Ie(I), Ie8(I), Id(I), Id8(I);
+      vpImageMorphology::erosion(Ie, 3, 3);
+      vpImageMorphology::erosion(Ie8, vpImageMorphology::CONNEXITY_8);
+      vpImageMorphology::dilatation(Id, 3, 3);
+      vpImageMorphology::dilatation(Id8, vpImageMorphology::CONNEXITY_8);
+      if (!(Ie == Ie8 && Id == Id8)) {
+        throw vpException(vpException::fatalError, "3x3 rectangle and connexity 8 failed");
+      }
+    }
+
+    // Invalid structuring elements
+    {
+      vpImage<unsigned char> J(I);
+      unsigned int nbThrown = 0;
+      try {
+        vpImageMorphology::erosion(J, 0, 3);
+      } catch (const vpException &) {
+        nbThrown++;
+      }
+      try {
+        vpImageMorphology::dilatation(J, 3, 5, vpImageMorphology::STRUCTURING_ELEMENT_DIAGONAL);
+      } catch (const vpException &) {
+        nbThrown++;
+      }
+      if (!(nbThrown == 2 && J == I)) {
+        throw vpException(vpException::fatalError, "Invalid structuring elements failed");
+      }
+    }
+
+    // A 31x31 erosion compared to 15 erosions in connexity 8
+    {
+      vpImage<unsigned char> J;
+      createImage(rand, J, 480, 640);
+      vpImage<unsigned char> Ie(J), Ie8(J);
+      double t = vpTime::measureTimeMs();
+      vpImageMorphology::erosion(Ie, 31, 31);
+      double t_vhgw = vpTime::measureTimeMs() - t;
+      t = vpTime::measureTimeMs();
+      for (unsigned int k = 0; k < 15; k++) {
+        vpImageMorphology::erosion(Ie8, vpImageMorphology::CONNEXITY_8);
+      }
+      double t_3x3 = vpTime::measureTimeMs() - t;
+      if (Ie != Ie8) {
+        throw vpException(vpException::fatalError, "31x31 erosion failed");
+      }
+      std::cout << "  31x31 erosion: " << t_vhgw << " ms, 15 3x3 erosions: " << t_3x3 << " ms" << std::endl;
+    }
+
+    std::cout << "Image morphology test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,369 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Test the separable filters of vpImageFilter.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testSeparableFilter.cpp
+
+  Compare the separable filters of vpImageFilter with a direct double
+  precision implementation using the per-pixel functions of vpImageFilter,
+  and check that the result does not depend on the number of threads nor on
+  the use of a caller-provided buffer.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <visp3/core/vpImageFilter.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+template<class Type>
+void filterXReference(const vpImage<Type> &I, vpImage<double> &If, const double *filter, unsigned int size)
+{
+  unsigned int half = (size-1)/2;
+  If.resize(I.getHeight(), I.getWidth());
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      if (j < half)
+        If[i][j] = vpImageFilter::filterXLeftBorder(I, i, j, filter, size);
+      else if (j >= I.getWidth() - half)
+        If[i][j] = vpImageFilter::filterXRightBorder(I, i, j, filter, size);
+      else
+        If[i][j] = vpImageFilter::filterX(I, i, j, filter, size);
+    }
+  }
+}
+
+template<class Type>
+void filterYReference(const vpImage<Type> &I, vpImage<double> &If, const double *filter, unsigned int size)
+{
+  unsigned int half = (size-1)/2;
+  If.resize(I.getHeight(), I.getWidth());
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      if (i < half)
+        If[i][j] = vpImageFilter::filterYTopBorder(I, i, j, filter, size);
+      else if (i >= I.getHeight() - half)
+        If[i][j] = vpImageFilter::filterYBottomBorder(I, i, j, filter, size);
+      else
+        If[i][j] = vpImageFilter::filterY(I, i, j, filter, size);
+    }
+  }
+}
+
+template<class Type>
+void gradXReference(const vpImage<Type> &I, vpImage<double> &If, const double *filter, unsigned int size)
+{
+  unsigned int half = (size-1)/2;
+  If.resize(I.getHeight(), I.getWidth(), 0.);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = half; j < I.getWidth() - half; j++) {
+      If[i][j] = vpImageFilter::derivativeFilterX(I, i, j, filter, size);
+    }
+  }
+}
+
+template<class Type>
+void gradYReference(const vpImage<Type> &I, vpImage<double> &If, const double *filter, unsigned int size)
+{
+  unsigned int half = (size-1)/2;
+  If.resize(I.getHeight(), I.getWidth(), 0.);
+  for (unsigned int i = half; i < I.getHeight() - half; i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      If[i][j] = vpImageFilter::derivativeFilterY(I, i, j, filter, size);
+    }
+  }
+}
+
+void sepFilterReference(const vpImage<unsigned char> &I, vpImage<double> &If, const vpColVector &kernelH,
+                        const vpColVector &kernelV)
+{
+  unsigned int half = kernelH.size()/2;
+  If.resize(I.getHeight(), I.getWidth(), 0.);
+  vpImage<double> I_filter(I.getHeight(), I.getWidth(), 0.);
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = half; j < I.getWidth() - half; j++) {
+      for (unsigned int a = 0; a < kernelH.size(); a++) {
+        I_filter[i][j] += kernelH[a] * I[i][j+half-a];
+      }
+    }
+  }
+  for (unsigned int i = half; i < I.getHeight() - half; i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      for (unsigned int a = 0; a < kernelV.size(); a++) {
+        If[i][j] += kernelV[a] * I_filter[i+half-a][j];
+      }
+    }
+  }
+}
+
+double maxDifference(const vpImage<double> &I1, const vpImage<double> &I2)
+{
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth())
+    return 1e30;
+  double max_diff = 0;
+  for (unsigned int i = 0; i < I1.getSize(); i++) {
+    max_diff = std::max(max_diff, std::fabs(I1.bitmap[i] - I2.bitmap[i]));
+  }
+  return max_diff;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the separable image filters.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    // A width that is not a multiple of the SIMD width
+    const unsigned int width = 321, height = 243;
+    vpImage<unsigned char> I(height, width);
+    vpImage<double> I_double(height, width);
+    vpUniRand rand(0);
+    for (unsigned int i = 0; i < I.getSize(); i++) {
+      I.bitmap[i] = (unsigned char) (rand() * 256);
+      I_double.bitmap[i] = I.bitmap[i] / 3.;
+    }
+
+    // Values up to 255 are filtered in single precision
+    const double tolerance = 1e-3;
+    vpImage<double> I_ref, I_ref2, I_filtered, I_filtered2;
+    vpImage<float> buffer;
+
+    const unsigned int sizes[3] = { 3, 7, 11 };
+    for (unsigned int s = 0; s < 3; s++) {
+      unsigned int size = sizes[s];
+      std::vector<double> fg((size+1)/2), fgd((size+1)/2);
+      vpImageFilter::getGaussianKernel(&fg[0], size);
+      vpImageFilter::getGaussianDerivativeKernel(&fgd[0], size);
+      std::cout << "* Kernel size " << size << std::endl;
+
+      filterXReference(I, I_ref, &fg[0], size);
+      vpImageFilter::filterX(I, I_filtered, &fg[0], size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "filterX failed");
+      }
+
+      filterYReference(I_double, I_ref, &fg[0], size);
+      vpImageFilter::filterY(I_double, I_filtered, &fg[0], size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "filterY failed");
+      }
+
+      filterXReference(I, I_ref2, &fg[0], size);
+      filterYReference(I_ref2, I_ref, &fg[0], size);
+      vpImageFilter::gaussianBlur(I, I_filtered, size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "gaussianBlur failed");
+      }
+      vpImageFilter::filter(I, I_filtered, &fg[0], size, buffer);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "filter with a buffer failed");
+      }
+
+      gradXReference(I, I_ref, &fgd[0], size);
+      vpImageFilter::getGradX(I, I_filtered, &fgd[0], size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "getGradX failed");
+      }
+
+      gradYReference(I_double, I_ref, &fgd[0], size);
+      vpImageFilter::getGradY(I_double, I_filtered, &fgd[0], size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "getGradY failed");
+      }
+
+      filterYReference(I, I_ref2, &fg[0], size);
+      gradXReference(I_ref2, I_ref, &fgd[0], size);
+      vpImageFilter::getGradXGauss2D(I, I_filtered, &fg[0], &fgd[0], size);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "getGradXGauss2D failed");
+      }
+
+      filterXReference(I, I_ref2, &fg[0], size);
+      gradYReference(I_ref2, I_ref, &fgd[0], size);
+      vpImageFilter::getGradYGauss2D(I, I_filtered, &fg[0], &fgd[0], size, buffer);
+      if (maxDifference(I_filtered, I_ref) > tolerance) {
+        throw vpException(vpException::fatalError, "getGradYGauss2D failed");
+      }
+    }
+
+    // Fixed 7 taps derivative filter
+    vpImage<double> I_gradX(height, width, 0.), I_gradY(height, width, 0.);
+    for (unsigned int i = 3; i < height - 3; i++) {
+      for (unsigned int j = 3; j < width - 3; j++) {
+        I_gradX[i][j] = vpImageFilter::derivativeFilterX(I, i, j);
+        I_gradY[i][j] = vpImageFilter::derivativeFilterY(I, i, j);
+      }
+    }
+    vpImageFilter::getGradX(I, I_filtered);
+    vpImageFilter::getGradY(I, I_filtered2);
+    double max_diff = 0;
+    for (unsigned int i = 3; i < height - 3; i++) {
+      for (unsigned int j = 3; j < width - 3; j++) {
+        max_diff = std::max(max_diff, std::fabs(I_filtered[i][j] - I_gradX[i][j]));
+        max_diff = std::max(max_diff, std::fabs(I_filtered2[i][j] - I_gradY[i][j]));
+      }
+    }
+    if (max_diff > tolerance) {
+      throw vpException(vpException::fatalError, "getGradX and getGradY without kernel failed");
+    }
+
+    // Sobel kernel, and a non symmetric kernel
+    vpColVector kernelH(3), kernelV(3);
+    kernelH[0] = 1; kernelH[1] = 0; kernelH[2] = -1;
+    kernelV[0] = 1; kernelV[1] = 2; kernelV[2] = 1;
+    sepFilterReference(I, I_ref, kernelH, kernelV);
+    vpImageFilter::sepFilter(I, I_filtered, kernelH, kernelV);
+    if (maxDifference(I_filtered, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "sepFilter with the Sobel kernel failed");
+    }
+    vpColVector kernel(5);
+    kernel[0] = 0.1; kernel[1] = -0.3; kernel[2] = 0.5; kernel[3] = 0.2; kernel[4] = 0.05;
+    sepFilterReference(I, I_ref, kernel, kernel);
+    vpImageFilter::sepFilter(I, I_filtered, kernel, kernel, buffer);
+    if (maxDifference(I_filtered, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "sepFilter with a non symmetric kernel failed");
+    }
+
+    // The result does not depend on the number of threads
+    std::vector<double> fg(4), fgd(4);
+    vpImageFilter::getGaussianKernel(&fg[0], 7);
+    vpImageFilter::getGaussianDerivativeKernel(&fgd[0], 7);
+    vpThreadPool::setConcurrency(1);
+    vpImageFilter::getGradXGauss2D(I, I_ref, &fg[0], &fgd[0], 7);
+    vpThreadPool::setConcurrency(3);
+    vpImageFilter::getGradXGauss2D(I, I_filtered, &fg[0], &fgd[0], 7, buffer);
+    vpThreadPool::setConcurrency(0);
+    if (maxDifference(I_filtered, I_ref) > 0.) {
+      throw vpException(vpException::fatalError, "getGradXGauss2D with 1 and 3 threads failed");
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < 100; i++) {
+      vpImageFilter::getGradXGauss2D(I, I_filtered, &fg[0], &fgd[0], 7, buffer);
+    }
+    std::cout << "Mean time of getGradXGauss2D(): " << (vpTime::measureTimeMs() - t) / 100 << " ms" << std::endl;
+
+    std::cout << "Separable filter test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,247 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test image undistortion with a precomputed map.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testUndistortionMap.cpp
+
+  Compare the images undistorted with vpUndistortionMap with a floating
+  point bilinear interpolation, for grey level and color images, with one
+  and several threads.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpImageTools.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUndistortionMap.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Undistortion with the model of vpImageTools::undistort() using a floating point interpolation
+void undistortReference(const vpImage<unsigned char> &I, const vpCameraParameters &cam, vpImage<unsigned char> &Iundist)
+{
+  int width = (int) I.getWidth(), height = (int) I.getHeight();
+  Iundist.resize(I.getHeight(), I.getWidth());
+  double u0 = cam.get_u0(), v0 = cam.get_v0(), px = cam.get_px(), py = cam.get_py(), kud = cam.get_kud();
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      double r2 = vpMath::sqr((j - u0) / px) + vpMath::sqr((i - v0) / py);
+      double u = (j - u0) * (1 + kud * r2) + u0;
+      double v = (i - v0) * (1 + kud * r2) + v0;
+      int u_round = (int) u, v_round = (int) v;
+      if (u < 0 || v < 0 || u_round >= width - 1 || v_round >= height - 1) {
+        Iundist[i][j] = 0;
+        continue;
+      }
+      double du = u - u_round, dv = v - v_round;
+      double val = (1 - dv) * ((1 - du) * I[v_round][u_round] + du * I[v_round][u_round+1]) +
+                   dv * ((1 - du) * I[v_round+1][u_round] + du * I[v_round+1][u_round+1]);
+      Iundist[i][j] = (unsigned char) vpMath::round(val);
+    }
+  }
+}
+
+int maxDifference(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2)
+{
+  int max_diff = 0;
+  for (unsigned int i = 0; i < I1.getSize(); i++) {
+    max_diff = std::max(max_diff, std::abs((int) I1.bitmap[i] - (int) I2.bitmap[i]));
+  }
+  return max_diff;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the undistortion of images with precomputed maps.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    const unsigned int width = 641, height = 479;
+    vpCameraParameters cam(600, 620, 330, 235, -0.25, 0.27);
+
+    // Smooth image, where the quantization of the sub-pixel position has a negligible effect, and noisy image
+    vpImage<unsigned char> I_smooth(height, width), I_noise(height, width);
+    vpUniRand rand(0);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        I_smooth[i][j] = (unsigned char) vpMath::round(127.5 + 127.5 * sin(i / 25.0) * cos(j / 40.0));
+        I_noise[i][j] = (unsigned char) (rand() * 256);
+      }
+    }
+
+    vpUndistortionMap map(cam, width, height);
+    vpImage<unsigned char> I_ref, I_undist;
+
+    undistortReference(I_smooth, cam, I_ref);
+    vpImageTools::undistort(I_smooth, map, I_undist);
+    if (maxDifference(I_undist, I_ref) > 1) {
+      throw vpException(vpException::fatalError, "Smooth image failed");
+    }
+
+    undistortReference(I_noise, cam, I_ref);
+    double t = vpTime::measureTimeMs();
+    vpImageTools::undistort(I_noise, map, I_undist);
+    t = vpTime::measureTimeMs() - t;
+    if (maxDifference(I_undist, I_ref) > 3) {
+      throw vpException(vpException::fatalError, "Noisy image failed");
+    }
+    std::cout << "Remap time: " << t << " ms" << std::endl;
+
+    // The result does not depend on the number of threads
+    vpImage<unsigned char> I_threads;
+    map.setNbThreads(3);
+    map.remap(I_noise, I_threads);
+    if (maxDifference(I_threads, I_undist) > 0) {
+      throw vpException(vpException::fatalError, "Noisy image with 3 threads failed");
+    }
+
+    // Each channel of a color image is interpolated as a grey level image
+    vpImage<vpRGBa> I_color(height, width), I_color_undist;
+    for (unsigned int i = 0; i < I_color.getSize(); i++) {
+      I_color.bitmap[i] = vpRGBa(I_noise.bitmap[i], I_smooth.bitmap[i], I_noise.bitmap[i], I_smooth.bitmap[i]);
+    }
+    map.remap(I_color, I_color_undist);
+    vpImage<unsigned char> I_smooth_undist;
+    map.remap(I_smooth, I_smooth_undist);
+    int max_diff = 0;
+    for (unsigned int i = 0; i < I_color.getSize(); i++) {
+      max_diff = std::max(max_diff, std::abs((int) I_color_undist.bitmap[i].R - (int) I_threads.bitmap[i]));
+      max_diff = std::max(max_diff, std::abs((int) I_color_undist.bitmap[i].G - (int) I_smooth_undist.bitmap[i]));
+      max_diff = std::max(max_diff, std::abs((int) I_color_undist.bitmap[i].B - (int) I_threads.bitmap[i]));
+      max_diff = std::max(max_diff, std::abs((int) I_color_undist.bitmap[i].A - (int) I_smooth_undist.bitmap[i]));
+    }
+    if (max_diff > 0) {
+      throw vpException(vpException::fatalError, "Color image failed");
+    }
+
+    // Without distortion the image is copied
+    vpUndistortionMap map_identity(vpCameraParameters(600, 620, 330, 235), width, height);
+    map_identity.remap(I_noise, I_undist);
+    if (maxDifference(I_undist, I_noise) > 0) {
+      throw vpException(vpException::fatalError, "Camera without distortion failed");
+    }
+
+    std::cout << "Undistortion map test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
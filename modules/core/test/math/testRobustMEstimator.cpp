@@ -0,0 +1,186 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test vpRobust M-estimators against a straightforward implementation.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRobustMEstimator.cpp
+
+  Compare the weights computed by vpRobust::MEstimator() with the ones
+  obtained from a median computed by sorting the residues, with exact and
+  approximated medians.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpGaussRand.h>
+#include <visp3/core/vpRobust.h>
+
+namespace {
+// Median as computed by vpRobust: value of rank ceil(n/2)-1
+double median(std::vector<double> v)
+{
+  std::sort(v.begin(), v.end());
+  return v[(v.size()+1)/2 - 1];
+}
+
+double weight(vpRobust::vpRobustEstimatorType method, double r, double sigma)
+{
+  switch (method) {
+  case vpRobust::TUKEY:
+    if (std::fabs(r/sigma) <= 4.6851)
+      return vpMath::sqr(1 - vpMath::sqr(r/sigma/4.6851));
+    return 0;
+  case vpRobust::CAUCHY:
+    return 1 / (1 + vpMath::sqr(r/(2.3849*sigma)));
+  case vpRobust::HUBER:
+  default:
+    if (std::fabs(r/sigma) <= 1.2107)
+      return 1;
+    return 1.2107 / std::fabs(r/sigma);
+  }
+}
+
+// Weights of the residues with a non null initial weight, the median being computed on these residues only
+vpColVector referenceWeights(vpRobust::vpRobustEstimatorType method, const vpColVector &residues,
+                             const vpColVector &initial_weights, double noise_threshold)
+{
+  std::vector<double> valid;
+  for (unsigned int i = 0; i < residues.size(); i++) {
+    if (initial_weights[i] != 0)
+      valid.push_back(residues[i]);
+  }
+  double med = median(valid);
+  for (size_t i = 0; i < valid.size(); i++)
+    valid[i] = std::fabs(valid[i] - med);
+  double sigma = std::max(1.4826 * median(valid), noise_threshold);
+
+  vpColVector w(residues.size());
+  for (unsigned int i = 0; i < residues.size(); i++) {
+    if (method != vpRobust::CAUCHY && initial_weights[i] == 0)
+      w[i] = 0;
+    else
+      w[i] = weight(method, std::fabs(residues[i] - med), sigma);
+  }
+  return w;
+}
+
+// Gaussian noise with 20% of outliers
+vpColVector generateResidues(unsigned int n, long seed)
+{
+  vpGaussRand noise(0.01, 0.002, seed);
+  vpUniRand outlier(seed+1);
+  vpColVector residues(n);
+  for (unsigned int i = 0; i < n; i++) {
+    if (outlier() < 0.2)
+      residues[i] = 2 * outlier() - 1;
+    else
+      residues[i] = noise();
+  }
+  return residues;
+}
+
+bool compare(const std::string &legend, const vpColVector &w, const vpColVector &w_ref, double tolerance)
+{
+  double max_error = 0;
+  for (unsigned int i = 0; i < w.size(); i++)
+    max_error = std::max(max_error, std::fabs(w[i] - w_ref[i]));
+
+  bool ok = (max_error <= tolerance);
+  std::cout << legend << ": max error " << max_error << (ok ? " ok" : " FAILED") << std::endl;
+  return ok;
+}
+}
+
+int main()
+{
+  const double noise_threshold = 1e-4;
+  const vpRobust::vpRobustEstimatorType methods[3] = { vpRobust::TUKEY, vpRobust::CAUCHY, vpRobust::HUBER };
+  const std::string names[3] = { "Tukey", "Cauchy", "Huber" };
+  bool ok = true;
+
+  // The same estimator is used with different sizes to check that the scratch vectors are correctly resized
+  vpRobust robust;
+  robust.setThreshold(noise_threshold);
+  const unsigned int sizes[4] = { 1001, 1000, 3, 4000 };
+
+  for (unsigned int s = 0; s < 4; s++) {
+    vpColVector residues = generateResidues(sizes[s], (long)s);
+    vpColVector ones(sizes[s], 1.0);
+
+    for (unsigned int m = 0; m < 3; m++) {
+      vpColVector w(sizes[s], 1.0);
+      robust.MEstimator(methods[m], residues, w);
+      std::ostringstream legend;
+      legend << names[m] << " (" << sizes[s] << " residues)";
+      ok &= compare(legend.str(), w, referenceWeights(methods[m], residues, ones, noise_threshold), 1e-12);
+    }
+
+    // Median computed on the residues that are not rejected
+    vpColVector initial_weights(sizes[s], 1.0);
+    for (unsigned int i = 0; i < sizes[s]; i += 3)
+      initial_weights[i] = 0;
+    if (sizes[s] > 3) {
+      for (unsigned int m = 0; m < 3; m++) {
+        vpColVector w = initial_weights;
+        robust.MEstimator(methods[m], residues, residues, w);
+        std::ostringstream legend;
+        legend << names[m] << " with rejected residues (" << sizes[s] << " residues)";
+        ok &= compare(legend.str(), w, referenceWeights(methods[m], residues, initial_weights, noise_threshold), 1e-12);
+      }
+    }
+  }
+
+  // Histogram based approximation of the median
+  {
+    const unsigned int n = 200000;
+    vpColVector residues = generateResidues(n, 10);
+    vpColVector ones(n, 1.0);
+    vpRobust robust_approx;
+    robust_approx.setThreshold(noise_threshold);
+    robust_approx.setMedianApproximation(10000);
+
+    for (unsigned int m = 0; m < 3; m++) {
+      vpColVector w(n, 1.0);
+      robust_approx.MEstimator(methods[m], residues, w);
+      ok &= compare(names[m] + " with approximated median", w,
+                    referenceWeights(methods[m], residues, ones, noise_threshold), 1e-3);
+    }
+  }
+
+  std::cout << "vpRobust test " << (ok ? "succeed" : "failed") << std::endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,347 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Measure the streaming of images between a client and a server.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageStreaming.cpp
+
+  Connect a client to a server on localhost in the same process, check the
+  images and matrices received with vpRequestImage and vpRequestMatrix, and
+  compare the number of images per second streamed with a request copying the
+  image in its parameters, with vpRequestImage, and with vpRequestImage through
+  a shared memory.
+*/
+
+#include <iostream>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpRequestImage.h>
+#include <visp3/core/vpRequestMatrix.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpThread.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Request copying the image in its parameters, as in the vpRequest documentation
+class vpRequestCopiedImage : public vpRequest
+{
+public:
+  vpRequestCopiedImage(vpImage<unsigned char> &I) : m_I(I) { request_id = "copied"; }
+
+  virtual void encode()
+  {
+    clear();
+    unsigned int h = m_I.getHeight(), w = m_I.getWidth();
+    addParameterObject(&h);
+    addParameterObject(&w);
+    addParameterObject(m_I.bitmap, (int)(h*w));
+  }
+  virtual void decode()
+  {
+    if (listOfParams.size() == 3) {
+      unsigned int h, w;
+      memcpy(&h, listOfParams[0].c_str(), sizeof(unsigned int));
+      memcpy(&w, listOfParams[1].c_str(), sizeof(unsigned int));
+      m_I.resize(h, w);
+      memcpy(m_I.bitmap, listOfParams[2].c_str(), w*h);
+    }
+  }
+
+private:
+  vpImage<unsigned char> &m_I;
+};
+
+struct vpStreamArgs
+{
+  vpClient *client;
+  vpRequest *request;
+  vpImage<unsigned char> *I;
+  unsigned int nbImages;
+};
+
+vpThread::Return sendImages(vpThread::Args args)
+{
+  vpStreamArgs *stream = (vpStreamArgs *)args;
+  for (unsigned int i = 0; i < stream->nbImages; i++) {
+    stream->I->bitmap[0] = (unsigned char)i;
+    stream->client->sendAndEncodeRequest(*stream->request);
+  }
+  return 0;
+}
+
+// Index of the next request received and decoded, -1 after the timeout
+int waitRequest(vpNetwork &network, double timeout_ms = 5000)
+{
+  double t = vpTime::measureTimeMs();
+  while (vpTime::measureTimeMs() - t < timeout_ms) {
+    int index = network.receiveAndDecodeRequestOnce();
+    if (index != -1)
+      return index;
+  }
+  return -1;
+}
+
+template<class Type>
+bool sameImage(const vpImage<Type> &I1, const vpImage<Type> &I2)
+{
+  return I1.getWidth() == I2.getWidth() && I1.getHeight() == I2.getHeight()
+      && memcmp(I1.bitmap, I2.bitmap, I1.getWidth()*I1.getHeight()*sizeof(Type)) == 0;
+}
+
+bool sameMatrix(const vpArray2D<double> &M1, const vpArray2D<double> &M2)
+{
+  return M1.getRows() == M2.getRows() && M1.getCols() == M2.getCols()
+      && memcmp(M1.data, M2.data, M1.size()*sizeof(double)) == 0;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Stream images and matrices between a client and a server on localhost.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    unsigned int port = 35011;
+
+    vpServer server((int)port);
+    server.start();
+    vpClient client;
+    if (!client.connectToHostname("localhost", port))
+      return 1;
+    double t = vpTime::measureTimeMs();
+    while (server.getNumberOfClients() == 0 && vpTime::measureTimeMs() - t < 5000)
+      server.checkForConnections();
+    if (server.getNumberOfClients() != 1) {
+      throw vpException(vpException::fatalError, "Connection failed");
+    }
+
+    vpUniRand rand(0);
+    vpImage<unsigned char> I_client(48, 64), I_server;
+    for (unsigned int i = 0; i < I_client.getSize(); i++)
+      I_client.bitmap[i] = (unsigned char)(rand() * 256);
+    vpImage<vpRGBa> Irgba_client(30, 40), Irgba_server(30, 40);
+    for (unsigned int i = 0; i < Irgba_client.getSize(); i++)
+      Irgba_client.bitmap[i] = vpRGBa((unsigned char)i, (unsigned char)(2*i), (unsigned char)(3*i), 255);
+    vpMatrix M_client(5, 7), M_server;
+    for (unsigned int i = 0; i < M_client.size(); i++)
+      M_client.data[i] = rand();
+    vpHomogeneousMatrix cMo_client(0.1, 0.2, 1.0, 0.3, 0.2, 0.1), cMo_server;
+
+    vpRequestImage<unsigned char> imageClient(I_client), imageServer(I_server);
+    vpRequestImage<vpRGBa> rgbaClient(Irgba_client, "rgba"), rgbaServer(Irgba_server, "rgba");
+    vpRequestMatrix<vpMatrix> matrixClient(M_client), matrixServer(M_server);
+    vpRequestMatrix<vpHomogeneousMatrix> poseClient(cMo_client, "pose"), poseServer(cMo_server, "pose");
+    vpRequestMatrix<vpMatrix> wrongPoseClient(M_client, "pose");
+    server.addDecodingRequest(&imageServer);
+    server.addDecodingRequest(&rgbaServer);
+    server.addDecodingRequest(&matrixServer);
+    server.addDecodingRequest(&poseServer);
+
+    client.sendAndEncodeRequest(imageClient);
+    if (!(waitRequest(server) == 0 && sameImage(I_server, I_client))) {
+      throw vpException(vpException::fatalError, "Grey image failed");
+    }
+    unsigned char *bitmap = I_server.bitmap;
+    I_client.bitmap[0]++;
+    client.sendAndEncodeRequest(imageClient);
+    if (!(waitRequest(server) == 0 && sameImage(I_server, I_client) && I_server.bitmap == bitmap)) {
+      throw vpException(vpException::fatalError, "Image memory reused failed");
+    }
+    client.sendAndEncodeRequest(rgbaClient);
+    if (!(waitRequest(server) == 1 && sameImage(Irgba_server, Irgba_client))) {
+      throw vpException(vpException::fatalError, "Color image failed");
+    }
+    client.sendAndEncodeRequest(matrixClient);
+    if (!(waitRequest(server) == 2 && sameMatrix(M_server, M_client))) {
+      throw vpException(vpException::fatalError, "Matrix failed");
+    }
+    client.sendAndEncodeRequest(poseClient);
+    if (!(waitRequest(server) == 3 && sameMatrix(cMo_server, cMo_client))) {
+      throw vpException(vpException::fatalError, "Pose failed");
+    }
+    client.sendAndEncodeRequest(wrongPoseClient);
+    if (!(waitRequest(server, 200) == -1 && sameMatrix(cMo_server, cMo_client))) {
+      throw vpException(vpException::fatalError, "Pose of a wrong size not handled failed");
+    }
+
+    // Through a shared memory, also when the image grows
+    imageClient.setSharedMemory("visp_testImageStreaming");
+    I_client.bitmap[0]++;
+    client.sendAndEncodeRequest(imageClient);
+    if (!(waitRequest(server) == 0 && sameImage(I_server, I_client))) {
+      throw vpException(vpException::fatalError, "Shared memory failed");
+    }
+    I_client.resize(96, 128);
+    for (unsigned int i = 0; i < I_client.getSize(); i++)
+      I_client.bitmap[i] = (unsigned char)(rand() * 256);
+    client.sendAndEncodeRequest(imageClient);
+    if (!(waitRequest(server) == 0 && sameImage(I_server, I_client))) {
+      throw vpException(vpException::fatalError, "Shared memory enlarged failed");
+    }
+    imageClient.setSharedMemory("");
+
+    // Stream VGA images from another thread
+    const unsigned int nbImages = 500;
+    I_client.resize(480, 640);
+    for (unsigned int i = 0; i < I_client.getSize(); i++)
+      I_client.bitmap[i] = (unsigned char)(rand() * 256);
+    vpRequestCopiedImage copiedClient(I_client), copiedServer(I_server);
+    server.addDecodingRequest(&copiedServer);
+
+    const char *legends[3] = { "Copied parameters", "vpRequestImage", "vpRequestImage with shared memory" };
+    vpRequest *requests[3] = { &copiedClient, &imageClient, &imageClient };
+    for (unsigned int mode = 0; mode < 3; mode++) {
+      if (mode == 2)
+        imageClient.setSharedMemory("visp_testImageStreaming");
+      vpStreamArgs stream;
+      stream.client = &client;
+      stream.request = requests[mode];
+      stream.I = &I_client;
+      stream.nbImages = nbImages;
+
+      unsigned int nbReceived = 0;
+      t = vpTime::measureTimeMs();
+      vpThread sender((vpThread::Fn)sendImages, (vpThread::Args)&stream);
+      while (nbReceived < nbImages && waitRequest(server) != -1)
+        nbReceived++;
+      double t_stream = vpTime::measureTimeMs() - t;
+      sender.join();
+
+      if (!(nbReceived == nbImages && I_server.getWidth() == 640 && I_server.getHeight() == 480)) {
+        throw vpException(vpException::fatalError, "%s streaming failed", legends[mode]);
+      }
+      std::cout << "  " << nbImages / (t_stream / 1000) << " images per second" << std::endl;
+    }
+
+    std::cout << "Image streaming test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "You do not have threading capabilities" << std::endl;
+  return 0;
+}
+#endif
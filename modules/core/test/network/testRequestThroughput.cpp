@@ -0,0 +1,329 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Measure the throughput and the latency of the requests sent on localhost.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRequestThroughput.cpp
+
+  Connect a client to a server on localhost in the same process, check that
+  the requests are received unchanged, and measure the round trip latency of
+  pose requests and the number of requests per second sent by bursts.
+*/
+
+#include <iostream>
+#include <string.h>
+#include <stdint.h>
+
+#include <visp3/core/vpClient.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpServer.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+class vpRequestPose : public vpRequest
+{
+public:
+  vpRequestPose(vpHomogeneousMatrix &M) : m_M(M) { request_id = "pose"; }
+
+  virtual void encode()
+  {
+    clear();
+    addParameterObject(m_M.data, 16*sizeof(double));
+  }
+  virtual void decode()
+  {
+    if (listOfParams.size() == 1 && listOfParams[0].size() == 16*sizeof(double))
+      memcpy(m_M.data, listOfParams[0].c_str(), 16*sizeof(double));
+  }
+
+private:
+  vpHomogeneousMatrix &m_M;
+};
+
+class vpRequestData : public vpRequest
+{
+public:
+  vpRequestData() : m_values() { request_id = "data"; }
+
+  virtual void encode()
+  {
+    clear();
+    for (size_t i = 0; i < m_values.size(); i++)
+      addParameter(m_values[i]);
+  }
+  virtual void decode() { m_values = listOfParams; }
+
+  std::vector<std::string> m_values;
+};
+
+// Index of the next request received, -1 after 5 seconds
+int waitRequest(vpNetwork &network)
+{
+  double t = vpTime::measureTimeMs();
+  while (vpTime::measureTimeMs() - t < 5000) {
+    int index = network.receiveAndDecodeRequestOnce();
+    if (index != -1)
+      return index;
+  }
+  return -1;
+}
+
+bool samePose(const vpHomogeneousMatrix &M1, const vpHomogeneousMatrix &M2)
+{
+  return memcmp(M1.data, M2.data, 16*sizeof(double)) == 0;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the throughput of requests exchanged between a client and a server.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    unsigned int port = 35010;
+
+    vpServer server((int)port);
+    server.setMaxSizeReceivedMessage(1024); // Let the receive buffer grow with the large requests
+    server.start();
+    vpClient client;
+    if (!client.connectToHostname("localhost", port))
+      return 1;
+    double t = vpTime::measureTimeMs();
+    while (server.getNumberOfClients() == 0 && vpTime::measureTimeMs() - t < 5000)
+      server.checkForConnections();
+    if (server.getNumberOfClients() != 1) {
+      throw vpException(vpException::fatalError, "Connection failed");
+    }
+
+    vpHomogeneousMatrix cMo_client, cMo_server;
+    vpRequestPose poseClient(cMo_client), poseServer(cMo_server);
+    vpRequestData dataClient, dataServer;
+    client.addDecodingRequest(&poseClient);
+    server.addDecodingRequest(&poseServer);
+    server.addDecodingRequest(&dataServer);
+
+    // Parameters with any byte, the delimiters of the previous text format, empty and large parameters
+    vpUniRand rand(0);
+    std::string binary(256, '\0');
+    for (size_t i = 0; i < binary.size(); i++)
+      binary[i] = (char)i;
+    std::string large(60000, '\0');
+    for (size_t i = 0; i < large.size(); i++)
+      large[i] = (char)(rand() * 256);
+    dataClient.m_values.push_back("[*start*]data[*@*]a[*|*]b[*end*]");
+    dataClient.m_values.push_back(binary);
+    dataClient.m_values.push_back("");
+    dataClient.m_values.push_back(large);
+    client.sendAndEncodeRequest(dataClient);
+    if (!(waitRequest(server) == 1 && dataServer.m_values == dataClient.m_values)) {
+      throw vpException(vpException::fatalError, "Data request failed");
+    }
+
+    dataClient.m_values.clear();
+    client.sendAndEncodeRequest(dataClient);
+    if (!(waitRequest(server) == 1 && dataServer.m_values.empty())) {
+      throw vpException(vpException::fatalError, "Request without parameter failed");
+    }
+
+    // Round trip of a pose
+    const unsigned int nbRoundTrips = 2000;
+    bool same = true;
+    t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nbRoundTrips && same; i++) {
+      cMo_client.buildFrom(0.1*i, 0.2, 1.0, 0.01*i, 0.2, 0.3);
+      client.sendAndEncodeRequest(poseClient);
+      same &= (waitRequest(server) == 0 && samePose(cMo_server, cMo_client));
+      cMo_server[0][3] += 1.0;
+      server.sendAndEncodeRequest(poseServer);
+      same &= (waitRequest(client) == 0 && samePose(cMo_client, cMo_server));
+    }
+    double t_round_trip = (vpTime::measureTimeMs() - t) / nbRoundTrips;
+    if (!same) {
+      throw vpException(vpException::fatalError, "Pose round trips failed");
+    }
+
+    // Bursts of poses
+    const unsigned int nbBursts = 200, burstSize = 100;
+    unsigned int nbReceived = 0;
+    t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < nbBursts; i++) {
+      for (unsigned int j = 0; j < burstSize; j++) {
+        cMo_client[0][3] = j;
+        client.sendAndEncodeRequest(poseClient);
+      }
+      for (unsigned int j = 0; j < burstSize; j++) {
+        if (waitRequest(server) == 0 && cMo_server[0][3] == j)
+          nbReceived++;
+      }
+    }
+    double t_bursts = vpTime::measureTimeMs() - t;
+    if (nbReceived != nbBursts * burstSize) {
+      throw vpException(vpException::fatalError, "Pose bursts failed");
+    }
+
+    // Requests sent before the client disconnects are still received
+    dataClient.m_values.assign(1, binary);
+    for (unsigned int i = 0; i < 3; i++)
+      client.sendAndEncodeRequest(dataClient);
+    client.stop();
+    nbReceived = 0;
+    t = vpTime::measureTimeMs();
+    while (nbReceived < 3 && vpTime::measureTimeMs() - t < 5000) {
+      std::vector<int> indexes = server.receiveAndDecodeRequest();
+      for (size_t i = 0; i < indexes.size(); i++) {
+        if (indexes[i] == 1 && dataServer.m_values == dataClient.m_values)
+          nbReceived++;
+      }
+    }
+    if (!(nbReceived == 3 && server.getNumberOfClients() == 0)) {
+      throw vpException(vpException::fatalError, "Requests received before disconnection failed");
+    }
+
+    // A client announcing a frame larger than the maximum size is disconnected, its previous requests being kept
+    server.setMaxSizeReceivedFrame(100000);
+    vpClient badClient;
+    if (!badClient.connectToHostname("localhost", port))
+      return 1;
+    t = vpTime::measureTimeMs();
+    while (server.getNumberOfClients() == 0 && vpTime::measureTimeMs() - t < 5000)
+      server.checkForConnections();
+    if (server.getNumberOfClients() != 1) {
+      throw vpException(vpException::fatalError, "Connection failed");
+    }
+    badClient.sendAndEncodeRequest(dataClient);
+    uint32_t badFrameSize = htonl(200000);
+    badClient.send(&badFrameSize);
+    nbReceived = 0;
+    t = vpTime::measureTimeMs();
+    while ((nbReceived == 0 || server.getNumberOfClients() != 0) && vpTime::measureTimeMs() - t < 5000) {
+      std::vector<int> indexes = server.receiveAndDecodeRequest();
+      for (size_t i = 0; i < indexes.size(); i++) {
+        if (indexes[i] == 1 && dataServer.m_values == dataClient.m_values)
+          nbReceived++;
+      }
+    }
+    if (!(nbReceived == 1 && server.getNumberOfClients() == 0)) {
+      throw vpException(vpException::fatalError, "Frame larger than the maximum size not rejected");
+    }
+
+    std::cout << "Round trip latency: " << t_round_trip * 1000 << " us" << std::endl;
+    std::cout << "Throughput: " << nbBursts * burstSize / (t_bursts / 1000) << " poses per second" << std::endl;
+
+    std::cout << "Request throughput test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,372 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test histograms of regions of interest, masks and 16-bits images.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testHistogramAdvanced.cpp
+
+  Compare the histograms computed by vpHistogram on a region of interest,
+  with a mask and on 16-bits images with a simple count of the pixels, with
+  one and several threads. Check the cumulative histogram, the Otsu
+  threshold, the equalization and vpImageConvert::createDepthHistogram().
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpHistogram.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Histogram of the pixels of [top, bottom) x [left, right) where the mask is true
+template <class Type>
+std::vector<unsigned int> histogramReference(const vpImage<Type> &I, const vpImage<bool> *mask, unsigned int top,
+                                             unsigned int bottom, unsigned int left, unsigned int right,
+                                             unsigned int nbLevels, unsigned int nbBins)
+{
+  std::vector<unsigned int> histogram(nbBins, 0);
+  for (unsigned int i = top; i < bottom; i++) {
+    for (unsigned int j = left; j < right; j++) {
+      if (mask == NULL || (*mask)[i][j])
+        histogram[(unsigned int) ((double) I[i][j] * nbBins / nbLevels)]++;
+    }
+  }
+  return histogram;
+}
+
+bool sameHistogram(const vpHistogram &h, const std::vector<unsigned int> &reference)
+{
+  vpHistogram histogram(h);
+  if (histogram.getSize() != reference.size())
+    return false;
+  for (unsigned int i = 0; i < histogram.getSize(); i++) {
+    if (histogram.getValues()[i] != reference[i])
+      return false;
+  }
+  return true;
+}
+
+// Threshold maximizing the between-class variance, computed for each threshold from scratch
+unsigned int otsuReference(const std::vector<unsigned int> &histogram)
+{
+  unsigned int threshold = 0;
+  double max_variance = -1;
+  for (unsigned int t = 0; t + 1 < histogram.size(); t++) {
+    double w0 = 0, w1 = 0, s0 = 0, s1 = 0;
+    for (unsigned int i = 0; i < histogram.size(); i++) {
+      if (i <= t) {
+        w0 += histogram[i];
+        s0 += (double) i * histogram[i];
+      } else {
+        w1 += histogram[i];
+        s1 += (double) i * histogram[i];
+      }
+    }
+    if (w0 == 0 || w1 == 0)
+      continue;
+    double variance = w0 * w1 * (s0 / w0 - s1 / w1) * (s0 / w0 - s1 / w1);
+    if (variance > max_variance) {
+      max_variance = variance;
+      threshold = t;
+    }
+  }
+  return threshold;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the histogram computation with masks, regions and 16-bit images.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    const unsigned int width = 641, height = 479;
+    const unsigned int nb_threads[4] = { 1, 3, 0, vpThreadPool::poolConcurrency };
+
+    // Noisy image with uniform areas
+    vpUniRand rand(0);
+    vpImage<unsigned char> I(height, width);
+    vpImage<bool> mask(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        I[i][j] = (j < width / 4) ? 128 : (unsigned char) (rand() * 256);
+        mask[i][j] = rand() < 0.3;
+      }
+    }
+
+    vpHistogram h;
+    for (unsigned int t = 0; t < 4; t++) {
+      std::stringstream ss;
+      ss << " with " << nb_threads[t] << " threads";
+      h.calculate(I, 256, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, NULL, 0, height, 0, width, 256, 256)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Whole image" + ss.str()).c_str());
+      }
+      h.calculate(I, 101, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, NULL, 0, height, 0, width, 256, 101)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("101 bins" + ss.str()).c_str());
+      }
+      h.calculate(I, vpRect(20.5, 10, 301, 200), 256, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, NULL, 10, 210, 21, 322, 256, 256)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Region of interest" + ss.str()).c_str());
+      }
+      h.calculate(I, vpRect(-50, 400, 800, 200), 256, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, NULL, 400, height, 0, width, 256, 256)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Region partly outside" + ss.str()).c_str());
+      }
+
+      h.setMask(&mask);
+      h.calculate(I, 256, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, &mask, 0, height, 0, width, 256, 256)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Mask" + ss.str()).c_str());
+      }
+      h.calculate(I, vpRect(20.5, 10, 301, 200), 256, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(I, &mask, 10, 210, 21, 322, 256, 256)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Mask and region" + ss.str()).c_str());
+      }
+      h.setMask(NULL);
+    }
+
+    vpImage<bool> bad_mask(height, width + 1);
+    h.setMask(&bad_mask);
+    bool thrown = false;
+    try {
+      h.calculate(I);
+    }
+    catch (const vpException &) {
+      thrown = true;
+    }
+    if (!thrown) {
+      throw vpException(vpException::fatalError, "Mask of a different size failed");
+    }
+    h.setMask(NULL);
+
+    // Time of the computation compared to a plain count
+    {
+      const unsigned int nb_iter = 100;
+      std::vector<unsigned int> plain(256);
+      double t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++) {
+        std::fill(plain.begin(), plain.end(), 0);
+        for (unsigned int i = 0; i < I.getSize(); i++)
+          plain[I.bitmap[i]]++;
+      }
+      double t_plain = (vpTime::measureTimeMs() - t) / nb_iter;
+      t = vpTime::measureTimeMs();
+      for (unsigned int iter = 0; iter < nb_iter; iter++)
+        h.calculate(I);
+      double t_histogram = (vpTime::measureTimeMs() - t) / nb_iter;
+      std::cout << "Plain count: " << t_plain << " ms, vpHistogram: " << t_histogram << " ms" << std::endl;
+    }
+
+    // 16-bits images
+    vpImage<uint16_t> D(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++)
+        D[i][j] = (rand() < 0.1) ? 0 : (uint16_t) (500 + rand() * 3000);
+    }
+    for (unsigned int t = 0; t < 4; t++) {
+      std::stringstream ss;
+      ss << " with " << nb_threads[t] << " threads";
+      h.calculate(D, 0x10000, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(D, NULL, 0, height, 0, width, 0x10000, 0x10000)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Depth image" + ss.str()).c_str());
+      }
+      h.calculate(D, 1000, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(D, NULL, 0, height, 0, width, 0x10000, 1000)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Depth image with 1000 bins" + ss.str()).c_str());
+      }
+      h.setMask(&mask);
+      h.calculate(D, vpRect(20.5, 10, 301, 200), 0x10000, nb_threads[t]);
+      if (!(sameHistogram(h, histogramReference(D, &mask, 10, 210, 21, 322, 0x10000, 0x10000)))) {
+        throw vpException(vpException::fatalError, "%s failed", ("Depth image with mask and region" + ss.str()).c_str());
+      }
+      h.setMask(NULL);
+    }
+
+    // Depth histogram image, compared to the former implementation
+    {
+      std::vector<unsigned int> cumulative(0x10000, 0);
+      for (unsigned int i = 0; i < D.getSize(); i++)
+        cumulative[D.bitmap[i]]++;
+      for (unsigned int i = 2; i < 0x10000; i++)
+        cumulative[i] += cumulative[i-1];
+      vpImage<unsigned char> I_depth;
+      vpImage<vpRGBa> I_depth_color;
+      vpImageConvert::createDepthHistogram(D, I_depth);
+      vpImageConvert::createDepthHistogram(D, I_depth_color);
+      bool same = true;
+      for (unsigned int i = 0; i < D.getSize(); i++) {
+        unsigned char f = D.bitmap[i] ? (unsigned char) (cumulative[D.bitmap[i]] * 255 / cumulative[0xFFFF]) : 0;
+        same &= (I_depth.bitmap[i] == f);
+        same &= (D.bitmap[i] == 0 || (I_depth_color.bitmap[i].R == 255 - f && I_depth_color.bitmap[i].B == f));
+      }
+      if (!same) {
+        throw vpException(vpException::fatalError, "Depth histogram image failed");
+      }
+    }
+
+    // Cumulative histogram
+    h.calculate(I);
+    std::vector<unsigned int> cumulative;
+    h.getCumulative(cumulative);
+    bool cumulative_ok = (cumulative.size() == 256 && cumulative[255] == I.getSize() && h.getTotal() == I.getSize());
+    for (unsigned int i = 1; i < cumulative.size(); i++)
+      cumulative_ok &= (cumulative[i] - cumulative[i-1] == h.getValues()[i]);
+    if (!cumulative_ok) {
+      throw vpException(vpException::fatalError, "Cumulative histogram failed");
+    }
+
+    // Otsu threshold of a bimodal image
+    vpImage<unsigned char> I_bimodal(height, width);
+    for (unsigned int i = 0; i < I_bimodal.getSize(); i++)
+      I_bimodal.bitmap[i] = (unsigned char) ((rand() < 0.4 ? 60 : 170) + rand() * 40 - 20);
+    h.calculate(I_bimodal);
+    std::vector<unsigned int> values(h.getValues(), h.getValues() + h.getSize());
+    unsigned int threshold = h.getOtsuThreshold();
+    std::cout << "Otsu threshold: " << threshold << std::endl;
+    if (!(threshold == otsuReference(values) && threshold >= 79 && threshold < 150)) {
+      throw vpException(vpException::fatalError, "Otsu threshold failed");
+    }
+
+    // Equalization of an image with gray levels in [100, 150]
+    vpImage<unsigned char> I_dark(height, width), I_eq;
+    for (unsigned int i = 0; i < I_dark.getSize(); i++)
+      I_dark.bitmap[i] = (unsigned char) (100 + rand() * 51);
+    h.calculate(I_dark);
+    h.equalize(I_dark, I_eq);
+    unsigned char eq_min = 255, eq_max = 0;
+    bool monotonic = true;
+    for (unsigned int i = 0; i < I_dark.getSize(); i++) {
+      eq_min = std::min(eq_min, I_eq.bitmap[i]);
+      eq_max = std::max(eq_max, I_eq.bitmap[i]);
+      // The equalized gray level of a pixel is about its rank
+      monotonic &= (std::fabs(I_eq.bitmap[i] - (I_dark.bitmap[i] - 100) * 255 / 50.0) < 15);
+    }
+    if (!(eq_min == 0 && eq_max == 255 && monotonic)) {
+      throw vpException(vpException::fatalError, "Equalization failed");
+    }
+
+    std::cout << "Histogram test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
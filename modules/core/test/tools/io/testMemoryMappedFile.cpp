@@ -0,0 +1,232 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test files mapped in memory.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMemoryMappedFile.cpp
+
+  Map a file written with std::ofstream and compare the content, check that
+  the file is not modified when the mapped data are, and check empty and
+  missing files.
+*/
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpMemoryMappedFile.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+void writeFile(const std::string &filename, const std::vector<unsigned char> &content)
+{
+  std::ofstream file(filename.c_str(), std::ofstream::binary);
+  if (!content.empty())
+    file.write((const char *) &content[0], (std::streamsize) content.size());
+}
+
+bool sameContent(const vpMemoryMappedFile &file, const std::vector<unsigned char> &content)
+{
+  if (file.getSize() != content.size())
+    return false;
+  for (size_t i = 0; i < content.size(); i++) {
+    if (file.getData()[i] != content[i])
+      return false;
+  }
+  return true;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the memory mapped files.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+#if defined(_WIN32)
+    std::string opath = "C:/temp";
+#else
+    std::string opath = "/tmp";
+#endif
+    if (!vpIoTools::checkDirectory(opath))
+      vpIoTools::makeDirectory(opath);
+    std::string filename = vpIoTools::createFilePath(opath, "testMemoryMappedFile.bin");
+
+    // Content larger than a page
+    vpUniRand rand(0);
+    std::vector<unsigned char> content(100003);
+    for (size_t i = 0; i < content.size(); i++)
+      content[i] = (unsigned char) (rand() * 256);
+    writeFile(filename, content);
+
+    {
+      vpMemoryMappedFile file(filename);
+      if (!(file.isOpen() && sameContent(file, content))) {
+        throw vpException(vpException::fatalError, "Mapped content failed");
+      }
+      if (((size_t) file.getData()) % 64 != 0) {
+        throw vpException(vpException::fatalError, "Alignment failed");
+      }
+
+      // Modifications stay in memory
+      file.getData()[0] = (unsigned char) (content[0] + 1);
+      file.getData()[content.size() - 1] = (unsigned char) (content[content.size() - 1] + 1);
+      if (file.getData()[0] == content[0]) {
+        throw vpException(vpException::fatalError, "Modified content failed");
+      }
+      vpMemoryMappedFile other(filename);
+      if (!(sameContent(other, content))) {
+        throw vpException(vpException::fatalError, "File not modified failed");
+      }
+
+      file.close();
+      if (!(!file.isOpen() && file.getData() == NULL && file.getSize() == 0)) {
+        throw vpException(vpException::fatalError, "Close failed");
+      }
+      file.open(filename);
+      if (!(sameContent(file, content))) {
+        throw vpException(vpException::fatalError, "Reopen failed");
+      }
+    }
+
+    // Empty file
+    writeFile(filename, std::vector<unsigned char>());
+    {
+      vpMemoryMappedFile file(filename);
+      if (!(file.isOpen() && file.getSize() == 0 && file.getData() == NULL)) {
+        throw vpException(vpException::fatalError, "Empty file failed");
+      }
+    }
+    vpIoTools::remove(filename);
+
+    // Missing file
+    bool thrown = false;
+    vpMemoryMappedFile file;
+    try {
+      file.open(filename);
+    }
+    catch (const vpException &) {
+      thrown = true;
+    }
+    if (!(thrown && !file.isOpen())) {
+      throw vpException(vpException::fatalError, "Missing file failed");
+    }
+
+    std::cout << "Memory mapped file test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
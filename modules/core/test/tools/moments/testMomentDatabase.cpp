@@ -0,0 +1,297 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the computation order of the moments of a database.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMomentDatabase.cpp
+
+  Link moments to a vpMomentDatabase in an order that does not follow their
+  dependencies and check that vpMomentDatabase::computeAll() gives the same
+  values as the moments computed one after the other in the right order,
+  also when a moment is linked after a first computation.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpMomentAlpha.h>
+#include <visp3/core/vpMomentArea.h>
+#include <visp3/core/vpMomentAreaNormalized.h>
+#include <visp3/core/vpMomentBasic.h>
+#include <visp3/core/vpMomentCInvariant.h>
+#include <visp3/core/vpMomentCentered.h>
+#include <visp3/core/vpMomentCommon.h>
+#include <visp3/core/vpMomentDatabase.h>
+#include <visp3/core/vpMomentGravityCenter.h>
+#include <visp3/core/vpMomentGravityCenterNormalized.h>
+#include <visp3/core/vpMomentObject.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+double maxDifference(const vpMoment &m1, const vpMoment &m2)
+{
+  if (m1.get().size() != m2.get().size())
+    return 1e10;
+  double max_diff = 0;
+  for (size_t i = 0; i < m1.get().size(); i++)
+    max_diff = std::max(max_diff, std::fabs(m1.get()[i] - m2.get()[i]));
+  return max_diff;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the computation of the moments of a database in the order of their dependencies.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    std::vector<vpPoint> vec_p;
+    const double x[5] = { -0.2, 0.1, 0.25, 0.05, -0.25 }, y[5] = { -0.1, -0.2, 0.05, 0.2, 0.15 };
+    for (unsigned int i = 0; i < 5; i++) {
+      vpPoint p;
+      p.set_x(x[i]);
+      p.set_y(y[i]);
+      vec_p.push_back(p);
+    }
+    vpMomentObject obj(5);
+    obj.setType(vpMomentObject::DENSE_POLYGON);
+    obj.fromVector(vec_p);
+
+    // Reference: moments computed one after the other in the order of their dependencies
+    vpMomentDatabase db_ref;
+    vpMomentBasic basic_ref;
+    vpMomentGravityCenter gravity_ref;
+    vpMomentCentered centered_ref;
+    vpMomentArea area_ref;
+    vpMomentAreaNormalized area_normalized_ref(0.1, 1.0);
+    vpMomentCInvariant cinvariant_ref;
+    vpMomentAlpha alpha_ref;
+    vpMomentGravityCenterNormalized gravity_normalized_ref;
+    basic_ref.linkTo(db_ref);
+    gravity_ref.linkTo(db_ref);
+    centered_ref.linkTo(db_ref);
+    area_ref.linkTo(db_ref);
+    area_normalized_ref.linkTo(db_ref);
+    cinvariant_ref.linkTo(db_ref);
+    alpha_ref.linkTo(db_ref);
+    gravity_normalized_ref.linkTo(db_ref);
+    db_ref.updateAll(obj);
+    basic_ref.compute();
+    gravity_ref.compute();
+    centered_ref.compute();
+    area_ref.compute();
+    area_normalized_ref.compute();
+    cinvariant_ref.compute();
+    alpha_ref.compute();
+    gravity_normalized_ref.compute();
+
+    // Moments linked in the reverse order
+    vpMomentDatabase db;
+    vpMomentBasic basic;
+    vpMomentGravityCenter gravity;
+    vpMomentCentered centered;
+    vpMomentArea area;
+    vpMomentAreaNormalized area_normalized(0.1, 1.0);
+    vpMomentCInvariant cinvariant;
+    vpMomentAlpha alpha;
+    vpMomentGravityCenterNormalized gravity_normalized;
+    gravity_normalized.linkTo(db);
+    alpha.linkTo(db);
+    cinvariant.linkTo(db);
+    area_normalized.linkTo(db);
+    centered.linkTo(db);
+    gravity.linkTo(db);
+    basic.linkTo(db);
+    db.updateAll(obj);
+    db.computeAll();
+
+    if (maxDifference(basic, basic_ref) != 0) {
+      throw vpException(vpException::fatalError, "Basic failed");
+    }
+    if (maxDifference(gravity, gravity_ref) != 0) {
+      throw vpException(vpException::fatalError, "Gravity center failed");
+    }
+    if (maxDifference(centered, centered_ref) != 0) {
+      throw vpException(vpException::fatalError, "Centered failed");
+    }
+    if (maxDifference(area_normalized, area_normalized_ref) != 0) {
+      throw vpException(vpException::fatalError, "Area normalized failed");
+    }
+    if (maxDifference(cinvariant, cinvariant_ref) != 0) {
+      throw vpException(vpException::fatalError, "C invariant failed");
+    }
+    if (maxDifference(alpha, alpha_ref) != 0) {
+      throw vpException(vpException::fatalError, "Alpha failed");
+    }
+    if (maxDifference(gravity_normalized, gravity_normalized_ref) != 0) {
+      throw vpException(vpException::fatalError, "Gravity center normalized failed");
+    }
+
+    // A moment linked after the first computation is sorted with the others
+    area.linkTo(db);
+    db.updateAll(obj);
+    db.computeAll();
+    if (maxDifference(area, area_ref) != 0) {
+      throw vpException(vpException::fatalError, "Area linked after the first computation failed");
+    }
+
+    // vpMomentCommon computes all its moments in the order of their dependencies
+    vpMomentCommon db_common(vpMomentCommon::getSurface(obj), vpMomentCommon::getMu3(obj),
+                             vpMomentCommon::getAlpha(obj), 1.0);
+    db_common.updateAll(obj);
+    bool found;
+    const vpMoment &centered_common = db_common.get("vpMomentCentered", found);
+    if (!(found && maxDifference(centered_common, centered_ref) == 0)) {
+      throw vpException(vpException::fatalError, "Centered from vpMomentCommon failed");
+    }
+    const vpMoment &cinvariant_common = db_common.get("vpMomentCInvariant", found);
+    if (!(found && maxDifference(cinvariant_common, cinvariant_ref) == 0)) {
+      throw vpException(vpException::fatalError, "C invariant from vpMomentCommon failed");
+    }
+
+    // A dependency that is not in the database is reported when the moment is computed
+    {
+      vpMomentDatabase db_missing;
+      vpMomentCentered centered_missing;
+      centered_missing.linkTo(db_missing);
+      db_missing.updateAll(obj);
+      bool thrown = false;
+      try {
+        db_missing.computeAll();
+      }
+      catch(const vpException &e) {
+        std::cout << "Missing dependency: " << e.getStringMessage() << std::endl;
+        thrown = true;
+      }
+      if (!thrown) {
+        throw vpException(vpException::fatalError, "Missing dependency failed");
+      }
+    }
+
+    double t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < 1000; i++) {
+      db.updateAll(obj);
+      db.computeAll();
+    }
+    std::cout << "Mean time to compute the database: " << (vpTime::measureTimeMs() - t) / 1000 << " ms" << std::endl;
+
+    std::cout << "Moment database test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
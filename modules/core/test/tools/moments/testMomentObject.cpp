@@ -0,0 +1,336 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the computation of the basic moments of an object.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testMomentObject.cpp
+
+  Compare the basic moments computed by vpMomentObject up to order 5 from a
+  polygon, a set of discrete points, a binary image and a photometric image
+  with a direct computation of each moment, and check that the moments of an
+  image do not depend on the number of threads.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMomentObject.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Moment m_pq of a closed polygon computed with the Green's theorem, with the sum of the absolute values of the terms
+double polygonMoment(unsigned int p, unsigned int q, const std::vector<vpPoint> &points, double &scale)
+{
+  double den = static_cast<double>((p + q + 2) * (p + q + 1) * vpMath::comb(p + q, p));
+  double mom = 0.0;
+  scale = 0.0;
+  for (size_t i = 1; i < points.size(); i++) {
+    double s = 0.0, s_abs = 0.0;
+    for (unsigned int k = 0; k <= p; k++) {
+      for (unsigned int l = 0; l <= q; l++) {
+        double term = vpMath::comb(k + l, l) * vpMath::comb(p + q - k - l, q - l) * pow(points[i].get_x(), (int) k) *
+                      pow(points[i - 1].get_x(), (int) (p - k)) * pow(points[i].get_y(), (int) l) *
+                      pow(points[i - 1].get_y(), (int) (q - l));
+        s += term;
+        s_abs += std::fabs(term);
+      }
+    }
+    double cross = points[i - 1].get_x() * points[i].get_y() - points[i].get_x() * points[i - 1].get_y();
+    mom += s * cross;
+    scale += s_abs * std::fabs(cross);
+  }
+  scale /= den;
+  return mom / den;
+}
+
+// Moments of an image: each pixel adds weight * x^p * y^q to m_pq
+void imageMoments(const vpImage<double> &weights, const vpCameraParameters &cam, unsigned int order,
+                  std::vector<double> &values, std::vector<double> &scales)
+{
+  values.assign(order * order, 0.);
+  scales.assign(order * order, 0.);
+  for (unsigned int j = 0; j < weights.getHeight(); j++) {
+    for (unsigned int i = 0; i < weights.getWidth(); i++) {
+      if (weights[j][i] == 0)
+        continue;
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, i, j, x, y);
+      for (unsigned int k = 0; k < order; k++) {
+        for (unsigned int l = 0; l < order - k; l++) {
+          double term = weights[j][i] * pow(x, (int) l) * pow(y, (int) k);
+          values[k * order + l] += term;
+          scales[k * order + l] += std::fabs(term);
+        }
+      }
+    }
+  }
+  double norm_factor = 1. / (cam.get_px() * cam.get_py());
+  for (size_t k = 0; k < values.size(); k++) {
+    values[k] *= norm_factor;
+    scales[k] *= norm_factor;
+  }
+}
+
+double maxRelativeError(const vpMomentObject &obj, const std::vector<double> &values, const std::vector<double> &scales,
+                        bool all_orders = false)
+{
+  unsigned int order = obj.getOrder() + 1;
+  double max_error = 0;
+  for (unsigned int q = 0; q < order; q++) {
+    for (unsigned int p = 0; p < order; p++) {
+      if (!all_orders && p + q >= order)
+        continue;
+      double error = std::fabs(obj.get()[q * order + p] - values[q * order + p]) / (scales[q * order + p] + 1e-300);
+      max_error = std::max(max_error, error);
+    }
+  }
+  return max_error;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the moments computed from polygons, points and images.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+
+    // Clockwise polygon and discrete points
+    std::vector<vpPoint> polygon;
+    const double x[6] = { -0.2, -0.1, 0.3, 0.25, 0.05, -0.22 }, y[6] = { 0.1, 0.25, 0.15, -0.1, -0.2, -0.15 };
+    for (unsigned int i = 0; i < 6; i++) {
+      vpPoint p;
+      p.set_x(x[i]);
+      p.set_y(y[i]);
+      polygon.push_back(p);
+    }
+    std::vector<vpPoint> cloud;
+    for (unsigned int i = 0; i < 200; i++) {
+      vpPoint p;
+      p.set_x(-0.3 + 0.7 * rand());
+      p.set_y(-0.2 + 0.5 * rand());
+      cloud.push_back(p);
+    }
+
+    // Binary image of an ellipse and noisy photometric image
+    const unsigned int height = 241, width = 321;
+    vpImage<unsigned char> I_binary(height, width), I_photometric(height, width);
+    for (unsigned int i = 0; i < height; i++) {
+      for (unsigned int j = 0; j < width; j++) {
+        double u = (j - 190.0) / 80.0, v = (i - 110.0) / 50.0;
+        I_binary[i][j] = (u * u + v * v + 0.3 * u * v < 1) ? 200 : 20;
+        I_photometric[i][j] = (unsigned char) (rand() * 256);
+      }
+    }
+    const unsigned char threshold = 128;
+    vpImage<double> W_binary(height, width), W_black(height, width), W_white(height, width);
+    for (unsigned int i = 0; i < W_binary.getSize(); i++) {
+      W_binary.bitmap[i] = (I_binary.bitmap[i] > threshold) ? 1. : 0.;
+      W_black.bitmap[i] = I_photometric.bitmap[i] / 255.;
+      W_white.bitmap[i] = 1. - I_photometric.bitmap[i] / 255.;
+    }
+
+    vpCameraParameters cam(600, 620, 160, 125);
+    vpCameraParameters cam_distortion(600, 620, 160, 125, -0.2, 0.21);
+
+    for (unsigned int max_order = 0; max_order <= 5; max_order++) {
+      const unsigned int order = max_order + 1;
+      vpMomentObject obj(max_order);
+      std::vector<double> values(order * order), scales(order * order);
+
+      std::vector<vpPoint> points = polygon;
+      obj.setType(vpMomentObject::DENSE_POLYGON);
+      obj.fromVector(points);
+      points.push_back(polygon.front());
+      for (unsigned int q = 0; q < order; q++) {
+        for (unsigned int p = 0; p < order; p++) {
+          values[q * order + p] = polygonMoment(p, q, points, scales[q * order + p]);
+        }
+      }
+      if (maxRelativeError(obj, values, scales, true) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Polygon failed");
+      }
+
+      obj.setType(vpMomentObject::DISCRETE);
+      obj.fromVector(cloud);
+      vpImage<double> W_cloud(1, (unsigned int) cloud.size(), 1.);
+      values.assign(order * order, 0.);
+      scales.assign(order * order, 0.);
+      for (size_t i = 0; i < cloud.size(); i++) {
+        for (unsigned int q = 0; q < order; q++) {
+          for (unsigned int p = 0; p + q < order; p++) {
+            double term = pow(cloud[i].get_x(), (int) p) * pow(cloud[i].get_y(), (int) q);
+            values[q * order + p] += term;
+            scales[q * order + p] += std::fabs(term);
+          }
+        }
+      }
+      if (maxRelativeError(obj, values, scales) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Discrete points failed");
+      }
+
+      obj.setType(vpMomentObject::DENSE_FULL_OBJECT);
+      obj.fromImage(I_binary, threshold, cam);
+      imageMoments(W_binary, cam, order, values, scales);
+      if (maxRelativeError(obj, values, scales) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Binary image failed");
+      }
+
+      obj.fromImage(I_binary, threshold, cam_distortion);
+      imageMoments(W_binary, cam_distortion, order, values, scales);
+      if (maxRelativeError(obj, values, scales) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Binary image with distortion failed");
+      }
+
+      obj.fromImage(I_photometric, cam, vpMomentObject::BLACK);
+      imageMoments(W_black, cam, order, values, scales);
+      if (maxRelativeError(obj, values, scales) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Photometric image with black background failed");
+      }
+
+      obj.fromImage(I_photometric, cam, vpMomentObject::WHITE);
+      imageMoments(W_white, cam, order, values, scales);
+      if (maxRelativeError(obj, values, scales) >= 1e-12) {
+        throw vpException(vpException::fatalError, "Photometric image with white background failed");
+      }
+    }
+
+    // The moments of an image do not depend on the number of threads
+    vpMomentObject obj(5), obj_threads(5);
+    vpThreadPool::setConcurrency(1);
+    double t = vpTime::measureTimeMs();
+    obj.fromImage(I_photometric, cam, vpMomentObject::BLACK);
+    std::cout << "Photometric moments of order 5 with 1 thread: " << vpTime::measureTimeMs() - t << " ms" << std::endl;
+    vpThreadPool::setConcurrency(3);
+    obj_threads.fromImage(I_photometric, cam, vpMomentObject::BLACK);
+    vpThreadPool::setConcurrency(0);
+    bool same = (obj.get() == obj_threads.get());
+    if (!same) {
+      throw vpException(vpException::fatalError, "Photometric moments with 3 threads failed");
+    }
+
+    std::cout << "Moment object test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
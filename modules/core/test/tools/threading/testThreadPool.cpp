@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the thread pool.
+ *
+ *****************************************************************************/
+
+/*!
+
+  \example testThreadPool.cpp
+
+  \brief Test vpThreadPool::parallelFor(): each index is processed exactly
+  once whatever the number of threads, the grain size and the workload,
+  nested loops are executed, exceptions are forwarded to the caller and
+  the pool can be shut down and used again.
+
+*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+
+namespace {
+// Count the number of times each index is processed, the cost of an index growing with the index
+class CountBody : public vpParallelLoopBody
+{
+public:
+  CountBody(std::vector<unsigned int> &counts, std::vector<double> &values) : m_counts(counts), m_values(values) {}
+
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++) {
+      double value = 0;
+      for (unsigned int k = 0; k < i / 64; k++)
+        value += sqrt((double) k);
+      m_values[i] = value;
+      m_counts[i]++;
+    }
+  }
+
+private:
+  std::vector<unsigned int> &m_counts;
+  std::vector<double> &m_values;
+};
+
+class NestedBody : public vpParallelLoopBody
+{
+public:
+  NestedBody(std::vector<std::vector<unsigned int> > &counts, std::vector<std::vector<double> > &values)
+    : m_counts(counts), m_values(values) {}
+
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++) {
+      vpThreadPool::parallelFor(0, (unsigned int) m_counts[i].size(), CountBody(m_counts[i], m_values[i]), 4);
+    }
+  }
+
+private:
+  std::vector<std::vector<unsigned int> > &m_counts;
+  std::vector<std::vector<double> > &m_values;
+};
+
+class ThrowBody : public vpParallelLoopBody
+{
+public:
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++) {
+      if (i == 777)
+        throw vpException(vpException::badValue, "Index %d", i);
+    }
+  }
+};
+
+bool checkCounts(const std::vector<unsigned int> &counts, unsigned int start, unsigned int end)
+{
+  for (unsigned int i = 0; i < counts.size(); i++) {
+    if (counts[i] != ((i >= start && i < end) ? 1u : 0u))
+      return false;
+  }
+  return true;
+}
+}
+
+int main()
+{
+  bool ok = true;
+  std::cout << "Number of cores: " << vpThreadPool::getNumberOfCores() << std::endl;
+  std::cout << "Default concurrency: " << vpThreadPool::getConcurrency() << std::endl;
+
+  const unsigned int size = 10000;
+  const unsigned int nb_threads[5] = { 0, 1, 2, 3, 8 };
+  const unsigned int grain_sizes[3] = { 0, 1, 100 };
+  for (unsigned int t = 0; t < 5; t++) {
+    for (unsigned int g = 0; g < 3; g++) {
+      std::vector<unsigned int> counts(size, 0);
+      std::vector<double> values(size, 0);
+      vpThreadPool::parallelFor(13, size - 7, CountBody(counts, values), nb_threads[t], grain_sizes[g]);
+      if (!checkCounts(counts, 13, size - 7)) {
+        std::cout << "Bad indexes with " << nb_threads[t] << " threads and a grain size of " << grain_sizes[g]
+                  << std::endl;
+        ok = false;
+      }
+    }
+  }
+
+  // Less indexes than threads
+  {
+    std::vector<unsigned int> counts(3, 0);
+    std::vector<double> values(3, 0);
+    vpThreadPool::parallelFor(0, 3, CountBody(counts, values), 8);
+    ok &= checkCounts(counts, 0, 3);
+  }
+
+  // Nested loops are executed by the thread of the outer loop
+  {
+    std::vector<std::vector<unsigned int> > counts(16, std::vector<unsigned int>(1000, 0));
+    std::vector<std::vector<double> > values(16, std::vector<double>(1000, 0));
+    vpThreadPool::parallelFor(0, 16, NestedBody(counts, values), 4, 1);
+    for (size_t i = 0; i < counts.size(); i++) {
+      if (!checkCounts(counts[i], 0, 1000)) {
+        std::cout << "Bad indexes with nested loops" << std::endl;
+        ok = false;
+      }
+    }
+  }
+
+  // Exceptions are forwarded to the caller, and the pool can still be used
+  for (unsigned int t = 1; t < 5; t++) {
+    bool thrown = false;
+    try {
+      vpThreadPool::parallelFor(0, size, ThrowBody(), nb_threads[t]);
+    }
+    catch (const vpException &e) {
+      std::cout << "Exception with " << nb_threads[t] << " threads: " << e.getStringMessage() << std::endl;
+      thrown = true;
+    }
+    if (!thrown) {
+      std::cout << "Exception not forwarded with " << nb_threads[t] << " threads" << std::endl;
+      ok = false;
+    }
+  }
+
+  // Concurrency setting
+  vpThreadPool::setConcurrency(3);
+  ok &= (vpThreadPool::getConcurrency() == 3);
+  vpThreadPool::setConcurrency(0);
+  ok &= (vpThreadPool::getConcurrency() == vpThreadPool::getNumberOfCores());
+
+  // Cost of a loop
+  {
+    std::vector<unsigned int> counts(64, 0);
+    std::vector<double> values(64, 0);
+    double t = vpTime::measureTimeMs();
+    for (unsigned int i = 0; i < 1000; i++) {
+      vpThreadPool::parallelFor(0, 64, CountBody(counts, values), 4);
+    }
+    std::cout << "Mean time of a loop with 4 threads: " << (vpTime::measureTimeMs() - t) / 1000 << " ms" << std::endl;
+    for (unsigned int i = 0; i < counts.size(); i++) {
+      ok &= (counts[i] == 1000);
+    }
+  }
+
+  // The pool can be used again after a shutdown
+  vpThreadPool::shutdown();
+  vpThreadPool::shutdown();
+  {
+    std::vector<unsigned int> counts(size, 0);
+    std::vector<double> values(size, 0);
+    vpThreadPool::parallelFor(0, size, CountBody(counts, values), 4);
+    if (!checkCounts(counts, 0, size)) {
+      std::cout << "Bad indexes after a shutdown" << std::endl;
+      ok = false;
+    }
+  }
+  vpThreadPool::shutdown();
+
+  std::cout << "Thread pool test " << (ok ? "succeed" : "failed") << std::endl;
+  return ok ? 0 : 1;
+}
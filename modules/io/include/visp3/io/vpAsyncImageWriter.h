@@ -0,0 +1,181 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writing.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.h
+  \brief Write images asynchronously in worker threads.
+*/
+
+#ifndef vpAsyncImageWriter_h
+#define vpAsyncImageWriter_h
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpMutex.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/core/vpThread.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+/*!
+  \class vpAsyncImageWriter
+
+  \ingroup group_io_image
+
+  \brief Write images on disk in background threads.
+
+  vpImageIo::write() encodes the image (PNG, JPEG, ...) in the calling thread.
+  This class moves that cost out of the caller: write() only copies the image
+  into a preallocated slot of a fixed size pool and returns immediately, while
+  one or more worker threads encode and write the files using vpImageIo::write().
+
+  Once the pool has been filled with images of the same size, no memory is
+  allocated anymore during write(). The idle worker threads, a blocked write()
+  and flush() wait on events and do not poll.
+
+  When all the slots are in use, write() either returns false without copying the
+  image (default behavior, the frame is dropped and counted by getDroppedCount()),
+  or waits for a slot to be released if setBlocking(true) was called.
+
+  With a single worker thread (default) the files are written in the order write()
+  was called. With several worker threads the images are dispatched in order but
+  files may be completed in a different order. Use flush() to wait until all the
+  pending images are written.
+
+  Errors thrown by vpImageIo::write() in a worker thread are caught; they can be
+  retrieved with getErrorCount() and getLastError().
+
+  \code
+#include <visp3/io/vpAsyncImageWriter.h>
+
+int main()
+{
+  vpImage<unsigned char> I(480, 640);
+  vpAsyncImageWriter writer(16); // Pool of 16 images, 1 worker thread
+  char filename[FILENAME_MAX];
+
+  for (unsigned int i = 0; i < 100; i++) {
+    // Here the code to acquire the image in I
+    sprintf(filename, "/tmp/image%04d.png", i);
+    if (! writer.write(I, filename))
+      std::cout << "Image " << i << " dropped" << std::endl;
+  }
+  writer.flush();
+}
+  \endcode
+
+  \sa vpVideoWriter::setAsyncWriting()
+*/
+class VISP_EXPORT vpAsyncImageWriter
+{
+public:
+  vpAsyncImageWriter(const unsigned int queueSize=8, const unsigned int nbThreads=1);
+  virtual ~vpAsyncImageWriter();
+
+  void flush();
+
+  unsigned int getDroppedCount();
+  unsigned int getErrorCount();
+  std::string getLastError();
+  /*!
+    Return the number of worker threads.
+  */
+  inline unsigned int getNbThreads() const { return (unsigned int)m_threads.size(); }
+  unsigned int getPendingCount();
+  /*!
+    Return the maximum number of images that can be queued.
+  */
+  inline unsigned int getQueueSize() const { return (unsigned int)m_slots.size(); }
+  unsigned int getWrittenCount();
+
+  bool isFull();
+
+  /*!
+    Set the behavior of write() when the queue is full.
+
+    \param blocking : When true, write() waits for a slot to be released.
+    When false (default), write() returns false and the image is dropped.
+  */
+  inline void setBlocking(const bool blocking) { m_blocking = blocking; }
+
+  bool write(const vpImage<unsigned char> &I, const std::string &filename);
+  bool write(const vpImage<vpRGBa> &I, const std::string &filename);
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  struct vpImageSlot {
+    vpImageSlot() : m_Igray(), m_Icolor(), m_isColor(false), m_filename() {}
+
+    vpImage<unsigned char> m_Igray;
+    vpImage<vpRGBa> m_Icolor;
+    bool m_isColor;
+    std::string m_filename;
+  };
+  class vpEvent;
+
+  vpAsyncImageWriter(const vpAsyncImageWriter &);
+  vpAsyncImageWriter &operator=(const vpAsyncImageWriter &);
+#endif
+
+  unsigned int acquireSlot();
+  void releaseSlot(const unsigned int index, const bool written);
+  void submitSlot(const unsigned int index);
+  static vpThread::Return workerThread(vpThread::Args args);
+
+  std::vector<vpImageSlot> m_slots;
+  std::vector<unsigned int> m_freeSlots;
+  std::deque<unsigned int> m_pendingSlots;
+  std::vector<vpThread *> m_threads;
+  vpMutex m_mutex;
+  //! Set when an image is queued or when the workers have to stop.
+  vpEvent *m_queuedEvent;
+  //! Set when a slot is put back in the pool.
+  vpEvent *m_releasedEvent;
+  //! Set when all the queued images are written.
+  vpEvent *m_idleEvent;
+  unsigned int m_nbActive;
+  unsigned int m_nbDropped;
+  unsigned int m_nbErrors;
+  unsigned int m_nbWritten;
+  std::string m_lastError;
+  bool m_blocking;
+  bool m_stop;
+};
+
+#endif
+#endif
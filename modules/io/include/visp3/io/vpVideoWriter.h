@@ -45,6 +45,7 @@
 
 #include <string>
 
+#include <visp3/io/vpAsyncImageWriter.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpFFMPEG.h>
 
@@ -114,6 +115,14 @@
   return 0;
   }
   \endcode
+
+  When writing a sequence of images, the encoding of each image (especially in
+  PNG or JPEG) may take longer than the acquisition loop period. Calling
+  setAsyncWriting() before open() moves the encoding in background threads:
+  saveFrame() then only copies the image in a preallocated queue. If the queue
+  is full the frame is dropped and the frame counter is not incremented, so
+  that the sequence of image files remains contiguous. The number of dropped
+  frames is given by getDroppedFrameCount().
   
   The other following example explains how to use the class to write directly an mpeg file.
   
@@ -216,6 +225,15 @@ class VISP_EXPORT vpVideoWriter
     unsigned int width;
     unsigned int height;
 
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    //!Background writer used for image sequences when asynchronous writing is enabled
+    vpAsyncImageWriter *asyncWriter;
+#endif
+    //!Asynchronous writing parameters
+    bool asyncWriting;
+    unsigned int asyncQueueSize;
+    unsigned int asyncNbThreads;
+
   public:
     vpVideoWriter();
     ~vpVideoWriter();
@@ -228,6 +246,7 @@ class VISP_EXPORT vpVideoWriter
       \return Returns the current frame index.
     */
     inline unsigned int getCurrentFrameIndex() const {return frameCount;}
+    unsigned int getDroppedFrameCount();
 
     void open (vpImage< vpRGBa > &I);
     void open (vpImage< unsigned char > &I);
@@ -241,6 +260,8 @@ class VISP_EXPORT vpVideoWriter
     void saveFrame (vpImage< vpRGBa > &I);
     void saveFrame (vpImage< unsigned char > &I);
 
+    void setAsyncWriting(const bool enable, const unsigned int queueSize=8, const unsigned int nbThreads=1);
+
 #ifdef VISP_HAVE_FFMPEG
     /*!
       Sets the bit rate of the video when encoding.
@@ -304,6 +325,7 @@ class VISP_EXPORT vpVideoWriter
 #endif
 
     private:
+      void openAsyncWriter();
       vpVideoFormatType getFormat(const char *filename);
       static std::string getExtension(const std::string &filename);
 };
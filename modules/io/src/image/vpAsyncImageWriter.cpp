@@ -0,0 +1,427 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Asynchronous image writing.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpAsyncImageWriter.cpp
+  \brief Write images asynchronously in worker threads.
+*/
+
+#include <algorithm>
+
+#include <visp3/io/vpAsyncImageWriter.h>
+#include <visp3/io/vpImageIo.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+#if defined(VISP_HAVE_PTHREAD)
+#  include <pthread.h>
+#elif defined(_WIN32)
+#  include <windows.h>
+#endif
+
+namespace {
+  const unsigned int vpAsyncImageWriterNoSlot = (unsigned int)-1;
+
+  template<class Type>
+  void copyImage(const vpImage<Type> &src, vpImage<Type> &dst)
+  {
+    // resize() keeps the previous buffer when the size is unchanged
+    dst.resize(src.getHeight(), src.getWidth());
+    std::copy(src.bitmap, src.bitmap + src.getSize(), dst.bitmap);
+  }
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Auto-reset event: set() releases one call to wait(), or the next one if no
+// thread is waiting. The waiting threads check their condition again when released.
+class vpAsyncImageWriter::vpEvent
+{
+public:
+  vpEvent()
+#if defined(VISP_HAVE_PTHREAD)
+    : m_mutex(), m_cond(), m_signaled(false)
+  {
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_cond, NULL);
+  }
+#else
+    : m_event(CreateEvent(NULL, FALSE, FALSE, NULL))
+  {
+  }
+#endif
+
+  ~vpEvent()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_cond_destroy(&m_cond);
+    pthread_mutex_destroy(&m_mutex);
+#else
+    CloseHandle(m_event);
+#endif
+  }
+
+  void set()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_lock(&m_mutex);
+    m_signaled = true;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_mutex);
+#else
+    SetEvent(m_event);
+#endif
+  }
+
+  void wait()
+  {
+#if defined(VISP_HAVE_PTHREAD)
+    pthread_mutex_lock(&m_mutex);
+    while (!m_signaled)
+      pthread_cond_wait(&m_cond, &m_mutex);
+    m_signaled = false;
+    pthread_mutex_unlock(&m_mutex);
+#else
+    WaitForSingleObject(m_event, INFINITE);
+#endif
+  }
+
+private:
+  vpEvent(const vpEvent &);
+  vpEvent &operator=(const vpEvent &);
+
+#if defined(VISP_HAVE_PTHREAD)
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_cond;
+  bool m_signaled;
+#else
+  HANDLE m_event;
+#endif
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Create the image pool and start the worker threads.
+
+  \param queueSize : Maximum number of images waiting to be written. Should be
+  greater than 0.
+  \param nbThreads : Number of worker threads that encode and write the images.
+  Should be greater than 0.
+*/
+vpAsyncImageWriter::vpAsyncImageWriter(const unsigned int queueSize, const unsigned int nbThreads)
+  : m_slots(), m_freeSlots(), m_pendingSlots(), m_threads(), m_mutex(), m_queuedEvent(NULL),
+    m_releasedEvent(NULL), m_idleEvent(NULL), m_nbActive(0),
+    m_nbDropped(0), m_nbErrors(0), m_nbWritten(0), m_lastError(), m_blocking(false), m_stop(false)
+{
+  if (queueSize == 0 || nbThreads == 0) {
+    throw(vpException(vpException::badValue,
+                      "Queue size (%d) and number of threads (%d) should be greater than 0",
+                      queueSize, nbThreads));
+  }
+
+  m_queuedEvent = new vpEvent;
+  m_releasedEvent = new vpEvent;
+  m_idleEvent = new vpEvent;
+
+  m_slots.resize(queueSize);
+  m_freeSlots.reserve(queueSize);
+  for (unsigned int i = queueSize; i > 0; i--)
+    m_freeSlots.push_back(i-1);
+
+  m_threads.resize(nbThreads, NULL);
+  for (unsigned int i = 0; i < nbThreads; i++)
+    m_threads[i] = new vpThread((vpThread::Fn)&vpAsyncImageWriter::workerThread, (vpThread::Args)this);
+}
+
+/*!
+  Write all the pending images, then stop and join the worker threads.
+*/
+vpAsyncImageWriter::~vpAsyncImageWriter()
+{
+  flush();
+
+  m_mutex.lock();
+  m_stop = true;
+  m_mutex.unlock();
+  // Each worker wakes up the next one before exiting
+  m_queuedEvent->set();
+
+  for (size_t i = 0; i < m_threads.size(); i++) {
+    delete m_threads[i]; // join
+  }
+  m_threads.clear();
+
+  delete m_queuedEvent;
+  delete m_releasedEvent;
+  delete m_idleEvent;
+}
+
+/*!
+  Take a free slot from the pool.
+
+  \return The slot index or vpAsyncImageWriterNoSlot if the pool is full in
+  non blocking mode.
+*/
+unsigned int vpAsyncImageWriter::acquireSlot()
+{
+  for (;;) {
+    {
+      vpMutex::vpScopedLock lock(m_mutex);
+      if (! m_freeSlots.empty()) {
+        unsigned int index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        // Several slots may have been released while a single event was set
+        if (! m_freeSlots.empty())
+          m_releasedEvent->set();
+        return index;
+      }
+      if (! m_blocking) {
+        m_nbDropped ++;
+        return vpAsyncImageWriterNoSlot;
+      }
+    }
+    m_releasedEvent->wait();
+  }
+}
+
+/*!
+  Put a slot back in the pool once its image is written.
+*/
+void vpAsyncImageWriter::releaseSlot(const unsigned int index, const bool written)
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  m_freeSlots.push_back(index);
+  m_nbActive --;
+  if (written)
+    m_nbWritten ++;
+
+  m_releasedEvent->set();
+  if (m_pendingSlots.empty() && m_nbActive == 0)
+    m_idleEvent->set();
+}
+
+/*!
+  Queue a filled slot for the worker threads.
+*/
+void vpAsyncImageWriter::submitSlot(const unsigned int index)
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  m_pendingSlots.push_back(index);
+  m_queuedEvent->set();
+}
+
+/*!
+  Wait until all the images queued by write() are written on disk.
+*/
+void vpAsyncImageWriter::flush()
+{
+  for (;;) {
+    {
+      vpMutex::vpScopedLock lock(m_mutex);
+      if (m_pendingSlots.empty() && m_nbActive == 0) {
+        // Release another thread waiting in flush()
+        m_idleEvent->set();
+        return;
+      }
+    }
+    m_idleEvent->wait();
+  }
+}
+
+/*!
+  Return the number of images that were not written because the queue was full.
+*/
+unsigned int vpAsyncImageWriter::getDroppedCount()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return m_nbDropped;
+}
+
+/*!
+  Return the number of images that could not be written due to an exception
+  thrown by vpImageIo::write().
+
+  \sa getLastError()
+*/
+unsigned int vpAsyncImageWriter::getErrorCount()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return m_nbErrors;
+}
+
+/*!
+  Return the message of the last exception thrown while writing an image, or an
+  empty string if no error occured.
+
+  \sa getErrorCount()
+*/
+std::string vpAsyncImageWriter::getLastError()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return m_lastError;
+}
+
+/*!
+  Return the number of images queued or being written.
+*/
+unsigned int vpAsyncImageWriter::getPendingCount()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return (unsigned int)m_pendingSlots.size() + m_nbActive;
+}
+
+/*!
+  Return the number of images successfully written on disk.
+*/
+unsigned int vpAsyncImageWriter::getWrittenCount()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return m_nbWritten;
+}
+
+/*!
+  Return true when all the slots of the pool are in use, meaning that the next
+  call to write() will either drop the image or block.
+*/
+bool vpAsyncImageWriter::isFull()
+{
+  vpMutex::vpScopedLock lock(m_mutex);
+  return m_freeSlots.empty();
+}
+
+/*!
+  Copy a gray level image in the pool and queue it for writing.
+
+  \param I : Image to write.
+  \param filename : Image file name. As in vpImageIo::write(), the extension
+  sets the image format.
+
+  \return true if the image was queued, false if the queue was full and the
+  image dropped.
+*/
+bool vpAsyncImageWriter::write(const vpImage<unsigned char> &I, const std::string &filename)
+{
+  unsigned int index = acquireSlot();
+  if (index == vpAsyncImageWriterNoSlot)
+    return false;
+
+  // The slot is owned by the caller until it is submitted: copy without locking
+  vpImageSlot &slot = m_slots[index];
+  copyImage(I, slot.m_Igray);
+  slot.m_isColor = false;
+  slot.m_filename = filename;
+
+  submitSlot(index);
+  return true;
+}
+
+/*!
+  Copy a color image in the pool and queue it for writing.
+
+  \param I : Image to write.
+  \param filename : Image file name. As in vpImageIo::write(), the extension
+  sets the image format.
+
+  \return true if the image was queued, false if the queue was full and the
+  image dropped.
+*/
+bool vpAsyncImageWriter::write(const vpImage<vpRGBa> &I, const std::string &filename)
+{
+  unsigned int index = acquireSlot();
+  if (index == vpAsyncImageWriterNoSlot)
+    return false;
+
+  vpImageSlot &slot = m_slots[index];
+  copyImage(I, slot.m_Icolor);
+  slot.m_isColor = true;
+  slot.m_filename = filename;
+
+  submitSlot(index);
+  return true;
+}
+
+vpThread::Return vpAsyncImageWriter::workerThread(vpThread::Args args)
+{
+  vpAsyncImageWriter *writer = (vpAsyncImageWriter *)args;
+
+  for (;;) {
+    unsigned int index = vpAsyncImageWriterNoSlot;
+    bool stop = false;
+    {
+      vpMutex::vpScopedLock lock(writer->m_mutex);
+      if (! writer->m_pendingSlots.empty()) {
+        index = writer->m_pendingSlots.front();
+        writer->m_pendingSlots.pop_front();
+        writer->m_nbActive ++;
+        // Several images may have been queued while a single event was set
+        if (! writer->m_pendingSlots.empty())
+          writer->m_queuedEvent->set();
+      }
+      else if (writer->m_stop) {
+        stop = true;
+      }
+    }
+
+    if (stop) {
+      writer->m_queuedEvent->set();
+      break;
+    }
+    if (index == vpAsyncImageWriterNoSlot) {
+      writer->m_queuedEvent->wait();
+      continue;
+    }
+
+    const vpImageSlot &slot = writer->m_slots[index];
+    bool written = true;
+    try {
+      if (slot.m_isColor)
+        vpImageIo::write(slot.m_Icolor, slot.m_filename);
+      else
+        vpImageIo::write(slot.m_Igray, slot.m_filename);
+    }
+    catch(const vpException &e) {
+      vpMutex::vpScopedLock lock(writer->m_mutex);
+      writer->m_nbErrors ++;
+      writer->m_lastError = slot.m_filename + ": " + e.getStringMessage();
+      written = false;
+    }
+    writer->releaseSlot(index, written);
+  }
+
+  return 0;
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_io.a(vpAsyncImageWriter.cpp.o) has no symbols
+void dummy_vpAsyncImageWriter() {};
+#endif
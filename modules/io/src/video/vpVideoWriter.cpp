@@ -66,7 +66,11 @@ vpVideoWriter::vpVideoWriter() :
     writer(), fourcc(0), framerate(0.),
 #endif
     formatType(FORMAT_UNKNOWN), initFileName(false), isOpen(false), frameCount(0),
-    firstFrame(0), width(0), height(0)
+    firstFrame(0), width(0), height(0),
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    asyncWriter(NULL),
+#endif
+    asyncWriting(false), asyncQueueSize(8), asyncNbThreads(1)
 {
   initFileName = false;
   firstFrame = 0;
@@ -101,6 +105,80 @@ vpVideoWriter::~vpVideoWriter()
   if (ffmpeg != NULL)
     delete ffmpeg;
   #endif
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  if (asyncWriter != NULL)
+    delete asyncWriter; // Write pending images
+#endif
+}
+
+/*!
+  Enable or disable asynchronous writing of image sequences. This setting is
+  taken into account by the next call to open() and has no effect when
+  writing a video file.
+
+  When enabled, saveFrame() copies the image in a queue of \e queueSize
+  preallocated images and returns immediately. The images are encoded and
+  written by \e nbThreads background threads. If the queue is full, the image is
+  dropped and the frame counter is not incremented.
+
+  \param enable : true to enable asynchronous writing.
+  \param queueSize : Maximum number of images waiting to be written.
+  \param nbThreads : Number of threads used to encode and write the images.
+  With more than one thread, files may be completed out of order.
+
+  \sa getDroppedFrameCount(), vpAsyncImageWriter
+*/
+void vpVideoWriter::setAsyncWriting(const bool enable, const unsigned int queueSize, const unsigned int nbThreads)
+{
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  if (enable && (queueSize == 0 || nbThreads == 0)) {
+    throw(vpException(vpException::badValue,
+                      "Queue size and number of threads should be greater than 0"));
+  }
+  asyncWriting = enable;
+  asyncQueueSize = queueSize;
+  asyncNbThreads = nbThreads;
+#else
+  if (enable) {
+    throw(vpException(vpException::functionNotImplementedError,
+                      "Asynchronous writing requires pthread or Windows threading support"));
+  }
+  (void)queueSize;
+  (void)nbThreads;
+#endif
+}
+
+/*!
+  Gets the number of frames that were dropped by saveFrame() because the
+  asynchronous writing queue was full.
+
+  \return The number of dropped frames, always 0 when asynchronous writing is
+  disabled.
+
+  \sa setAsyncWriting()
+*/
+unsigned int vpVideoWriter::getDroppedFrameCount()
+{
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  if (asyncWriter != NULL)
+    return asyncWriter->getDroppedCount();
+#endif
+  return 0;
+}
+
+/*!
+  Create the background writer when asynchronous writing is enabled.
+*/
+void vpVideoWriter::openAsyncWriter()
+{
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  if (asyncWriter != NULL) {
+    delete asyncWriter;
+    asyncWriter = NULL;
+  }
+  if (asyncWriting)
+    asyncWriter = new vpAsyncImageWriter(asyncQueueSize, asyncNbThreads);
+#endif
 }
 
 
@@ -167,6 +245,7 @@ void vpVideoWriter::open(vpImage< vpRGBa > &I)
   {
     width = I.getWidth();
     height = I.getHeight();
+    openAsyncWriter();
   }
   else if (formatType == FORMAT_AVI ||
            formatType == FORMAT_MPEG ||
@@ -220,6 +299,7 @@ void vpVideoWriter::open(vpImage< unsigned char > &I)
   {
     width = I.getWidth();
     height = I.getHeight();
+    openAsyncWriter();
   }
   else if (formatType == FORMAT_AVI ||
            formatType == FORMAT_MPEG ||
@@ -278,6 +358,13 @@ void vpVideoWriter::saveFrame (vpImage< vpRGBa > &I)
 
     sprintf(name,fileName,frameCount);
 
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    if (asyncWriter != NULL) {
+      if (! asyncWriter->write(I, name))
+        return; // Queue full: frame dropped
+    }
+    else
+#endif
     vpImageIo::write(I, name);
   }
   else
@@ -319,6 +406,13 @@ void vpVideoWriter::saveFrame (vpImage< unsigned char > &I)
 
     sprintf(name,fileName,frameCount);
 
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    if (asyncWriter != NULL) {
+      if (! asyncWriter->write(I, name))
+        return; // Queue full: frame dropped
+    }
+    else
+#endif
     vpImageIo::write(I, name);
   }
   else
@@ -344,6 +438,7 @@ void vpVideoWriter::saveFrame (vpImage< unsigned char > &I)
 
 /*!
   Deallocates parameters use to write the video or the image sequence.
+  When asynchronous writing is enabled, waits until all the queued images are written.
 */
 void vpVideoWriter::close()
 {
@@ -358,6 +453,12 @@ void vpVideoWriter::close()
     ffmpeg->endWrite();
   }
   #endif
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+  if (asyncWriter != NULL)
+  {
+    asyncWriter->flush();
+  }
+#endif
 }
 
 
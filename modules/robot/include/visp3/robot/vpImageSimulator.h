@@ -177,9 +177,6 @@ class VISP_EXPORT vpImageSimulator
     double *vbase_u_optim;
     double *vbase_v_optim;
 
-    //allocation memoire du point 3D d'intersection entre le vecteur (centre_cam - point_plan_image) et le plan
-    double *Xinter_optim;
-
     //triangles de projection du plan
     std::vector<vpTriangle> listTriangle;
     
@@ -278,16 +275,8 @@ class VISP_EXPORT vpImageSimulator
     //ie: un plan est oriente dans si normal_plan.focal < 0 => plan est visible sinon invisible.
     bool isVisible() {return visible;}
     
-    //function that project a point x,y on the plane, return true if the projection is on the limited plane
-    // and in this case return the corresponding image pixel Ipixelplan
-    bool getPixel(const vpImagePoint &iP,unsigned char &Ipixelplan);
-    bool getPixel(const vpImagePoint &iP,vpRGBa &Ipixelplan);
-    bool getPixel(vpImage<unsigned char> &Isrc, const vpImagePoint &iP,
-		  unsigned char &Ipixelplan);
-    bool getPixel(vpImage<vpRGBa> &Isrc, const vpImagePoint &iP,
-		  vpRGBa &Ipixelplan);
-    bool getPixelDepth(const vpImagePoint &iP, double &Zpixelplan);
-    bool getPixelVisibility(const vpImagePoint &iP, double &Zpixelplan);
+    //rasterization of the projected planes in the image, by tiles processed in parallel
+    template <class Type> class vpRasterizer;
     
         //operation 3D de base :
     void project(const vpColVector &_vin, const vpHomogeneousMatrix &_cMt,
@@ -80,6 +80,19 @@
   \warning This class uses threading capabilities. Thus on Unix-like
   platforms, the libpthread third-party library need to be
   installed. On Windows, we use the native threading capabilities.
+
+  By default (vpRobotWireFrameSimulator::REAL_TIME mode) a thread moves the
+  robot in wall-clock time and refreshes the external view. In the
+  vpRobotWireFrameSimulator::STEPPED mode there is no thread and nothing is
+  displayed: the robot only moves when step() is called, by one sampling
+  time per step, so that a simulation runs as fast as the computation
+  allows and always gives the same result. Positioning with setPosition()
+  is then immediate and the timestamps are given by getSimulationTime().
+  The views of the scene are only rendered when getInternalView() or
+  getExternalImage() are called. Several simulators in STEPPED mode can be
+  stepped from different threads; their construction and the rendering of
+  their views, which share the state of the wireframe renderer, have to be
+  done from one thread.
 */
 class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, public vpRobotSimulator
 {
@@ -91,6 +104,12 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
       MODEL_3D,
       MODEL_DH
     } vpDisplayRobotType;
+
+    typedef enum
+    {
+      REAL_TIME, //!< A thread moves the robot in wall-clock time and refreshes the external view.
+      STEPPED    //!< The robot only moves when step() is called, without display.
+    } vpSimulationMode;
     
     
   protected:
@@ -169,6 +188,11 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     bool setVelocityCalled;
 
     bool verbose_;
+
+    //! Simulation mode, set at construction.
+    vpSimulationMode simulationMode;
+    //! Simulated time in second, advanced by step() in the STEPPED mode.
+    double simulationTime;
     
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -233,6 +257,16 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     void getInternalView(vpImage<vpRGBa> &I);
     void getInternalView(vpImage<unsigned char> &I);
 
+    /*!
+      Return the simulation mode given at construction.
+    */
+    vpSimulationMode getSimulationMode() const {return simulationMode;}
+    /*!
+      Return the simulated time in second, that is the number of calls to
+      step() times the sampling time, in the STEPPED mode.
+    */
+    double getSimulationTime() const {return simulationTime;}
+
     vpHomogeneousMatrix get_cMo();
     /*!
       Get the pose between the object and the fixed world frame.
@@ -320,11 +354,12 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
       the velocity applied to the robot during this time.
 
       Since the wireframe simulator is threaded, the sampling time is set to vpTime::getMinTimeForUsleepCall() / 1000 seconds.
+      This lower bound does not apply in the STEPPED mode.
 
     */
     inline void setSamplingTime(const double &delta_t)
     {
-      if(delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)){
+      if(simulationMode == REAL_TIME && delta_t < static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3)){
         this->delta_t_ = static_cast<float>(vpTime::getMinTimeForUsleepCall() * 1e-3);
       } else {
         this->delta_t_ = delta_t;
@@ -347,6 +382,8 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
       \param fMo_ : The pose between the object and the fixed world frame.
     */
     void set_fMo(const vpHomogeneousMatrix &fMo_) {this->fMo = fMo_;}
+
+    void step(unsigned int nbSteps = 1);
     //@}
 
   protected:
@@ -372,8 +409,13 @@ class VISP_EXPORT vpRobotWireFrameSimulator : protected vpWireFrameSimulator, pu
     
     /* Robot functions */
     void init() {;}
+    void startSimulation();
+    void stopSimulation();
+    double getTimestamp() const;
     /*! Method lauched by the thread to compute the position of the robot in the articular frame. */
     virtual void updateArticularPosition() = 0;
+    /*! Move the joints with the current articular velocity during \e ellapsedTime seconds, stopping at the joint limits. */
+    virtual void integrateArticularVelocity(double ellapsedTime) = 0;
     /*! Method used to check if the robot reached a joint limit. */
     virtual int isInJointLimit () = 0;
     /*! Compute the articular velocity relative to the velocity in another frame. */
@@ -193,6 +193,7 @@ class VISP_EXPORT vpSimulatorAfma6 : public vpRobotWireFrameSimulator, public vp
 public:
     vpSimulatorAfma6();
     vpSimulatorAfma6(bool display);
+    explicit vpSimulatorAfma6(const vpSimulationMode &mode);
     virtual ~vpSimulatorAfma6();
     
     void getCameraParameters(vpCameraParameters &cam,
@@ -276,6 +277,7 @@ protected:
     int isInJointLimit (void);
     bool singularityTest(const vpColVector q, vpMatrix &J);
     void updateArticularPosition();
+    void integrateArticularVelocity(double ellapsedTime);
     //@}
     
 private:
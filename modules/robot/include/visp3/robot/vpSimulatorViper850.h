@@ -219,6 +219,7 @@ class VISP_EXPORT vpSimulatorViper850 : public vpRobotWireFrameSimulator, public
   public:
     vpSimulatorViper850();
     vpSimulatorViper850(bool display);
+    explicit vpSimulatorViper850(const vpSimulationMode &mode);
     virtual ~vpSimulatorViper850();
     
     void getCameraParameters(vpCameraParameters &cam,
@@ -305,6 +306,7 @@ protected:
     int isInJointLimit (void);
     bool singularityTest(const vpColVector q, vpMatrix &J);
     void updateArticularPosition();
+    void integrateArticularVelocity(double ellapsedTime);
     //@}
       
 private:
@@ -43,11 +43,300 @@
 #include <visp3/core/vpMeterPixelConversion.h>
 #include <visp3/core/vpMatrixException.h>
 #include <visp3/core/vpPolygon3D.h>
+#include <visp3/core/vpThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 #ifdef VISP_HAVE_MODULE_IO
 #  include <visp3/io/vpImageIo.h>
 #endif
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+// Size of the square tiles of the image that are rasterized in parallel
+const unsigned int vpImageSimulatorTileSize = 64;
+
+// Value of a texture at the sub-pixel position (i, j)
+template <class Type>
+inline Type getTexel(const vpImage<Type> &I, double i, double j, vpImageSimulator::vpInterpolationType interp)
+{
+  if (interp == vpImageSimulator::BILINEAR_INTERPOLATION)
+    return I.getValue(i, j);
+  return I[(unsigned int)i][(unsigned int)j];
+}
+
+inline void setPixel(unsigned char &dst, unsigned char src) { dst = src; }
+inline void setPixel(unsigned char &dst, const vpRGBa &src)
+{
+  dst = (unsigned char)(0.2126 * src.R + 0.7152 * src.G + 0.0722 * src.B);
+}
+inline void setPixel(vpRGBa &dst, unsigned char src)
+{
+  vpRGBa pixelcolor;
+  pixelcolor.R = src;
+  pixelcolor.G = src;
+  pixelcolor.B = src;
+  dst = pixelcolor;
+}
+inline void setPixel(vpRGBa &dst, const vpRGBa &src) { dst = src; }
+
+inline void setTexture(const vpImage<unsigned char> *Isrc, const vpImage<unsigned char> *&Ig, const vpImage<vpRGBa> *&)
+{
+  Ig = Isrc;
+}
+inline void setTexture(const vpImage<vpRGBa> *Isrc, const vpImage<unsigned char> *&, const vpImage<vpRGBa> *&Ic)
+{
+  Ic = Isrc;
+}
+
+// Restrict [lo, hi] to the values of x such that c + s * x > bound
+inline void clipSpan(double c, double s, double bound, double &lo, double &hi)
+{
+  if (s > 0)
+    lo = std::max(lo, (bound - c) / s);
+  else if (s < 0)
+    hi = std::min(hi, (bound - c) / s);
+  else if (c <= bound)
+    hi = -std::numeric_limits<double>::max();
+}
+}
+
+/*
+  Rasterize the planes of a set of vpImageSimulator in an image.
+
+  The image is split in square tiles processed in parallel with vpThreadPool.
+  In a tile the planes are drawn one after the other and a pixel keeps the
+  nearest plane, using either the z-buffer given by the user or a z-buffer
+  local to the tile when there are several planes.
+
+  Without distortion, the barycentric coordinates of a pixel in a triangle
+  and the numerator and denominator of the perspective-correct texture
+  coordinates are affine in x along a row: they are set up once per row and
+  only the columns covered by the triangle are visited.
+*/
+template <class Type>
+class vpImageSimulator::vpRasterizer : public vpParallelLoopBody
+{
+public:
+  vpRasterizer(vpImage<Type> &I, const vpCameraParameters &cam, vpMatrix *zBuffer = NULL)
+    : m_I(I), m_cam(cam), m_zBuffer(zBuffer), m_planes(), m_x(), m_y(),
+      m_distortion(cam.get_projModel() == vpCameraParameters::perspectiveProjWithDistortion),
+      m_top(I.getHeight() + 1.), m_bottom(-1.), m_left(I.getWidth() + 1.), m_right(-1.),
+      m_rowStart(0), m_colStart(0), m_rowEnd(0), m_colEnd(0), m_nbTilesX(0)
+  {
+  }
+
+  void addPlane(vpImageSimulator &sim, const vpImage<Type> *Isrc = NULL)
+  {
+    if (!sim.visible)
+      return;
+
+    // The region of interest of the simulator is updated as before
+    sim.getRoi(m_I.getWidth(), m_I.getHeight(), m_cam, sim.needClipping ? sim.ptClipped : sim.pt, sim.rect);
+    m_top = std::min(m_top, sim.rect.getTop());
+    m_bottom = std::max(m_bottom, sim.rect.getBottom());
+    m_left = std::min(m_left, sim.rect.getLeft());
+    m_right = std::max(m_right, sim.rect.getRight());
+
+    vpPlane plane;
+    for (unsigned int i = 0; i < 3; i++) {
+      plane.n[i] = sim.normal_Cam_optim[i];
+      plane.X0[i] = sim.X0_2_optim[i];
+      plane.bu[i] = sim.vbase_u_optim[i];
+      plane.bv[i] = sim.vbase_v_optim[i];
+    }
+    plane.distance = sim.distance;
+    plane.X0bu = plane.X0[0] * plane.bu[0] + plane.X0[1] * plane.bu[1] + plane.X0[2] * plane.bu[2];
+    plane.X0bv = plane.X0[0] * plane.bv[0] + plane.X0[1] * plane.bv[1] + plane.X0[2] * plane.bv[2];
+    plane.inv_nu2 = 1. / (sim.euclideanNorm_u * sim.euclideanNorm_u);
+    plane.inv_nv2 = 1. / (sim.euclideanNorm_v * sim.euclideanNorm_v);
+
+    // Barycentric coordinates of the triangles as with vpTriangle::inTriangle()
+    for (size_t t = 0; t < sim.listTriangle.size(); t++) {
+      vpImagePoint ip1, ip2, ip3;
+      sim.listTriangle[t].getTriangleApexes(ip1, ip2, ip3);
+      double a = ip2.get_i() - ip1.get_i(), b = ip2.get_j() - ip1.get_j();
+      double c = ip3.get_i() - ip1.get_i(), d = ip3.get_j() - ip1.get_j();
+      double det = a * d - b * c;
+      if (std::fabs(det) <= std::numeric_limits<double>::epsilon())
+        continue;
+      double tri[6] = { ip1.get_i(), ip1.get_j(), d / det, -b / det, -c / det, a / det };
+      plane.triangles.insert(plane.triangles.end(), tri, tri + 6);
+    }
+
+    plane.Ig = NULL;
+    plane.Ic = NULL;
+    if (Isrc != NULL)
+      setTexture(Isrc, plane.Ig, plane.Ic);
+    else if (sim.colorI == GRAY_SCALED)
+      plane.Ig = &sim.Ig;
+    else
+      plane.Ic = &sim.Ic;
+    plane.interp = sim.interp;
+
+    m_planes.push_back(plane);
+  }
+
+  void render()
+  {
+    if (m_planes.empty() || m_bottom < 0 || m_right < 0)
+      return;
+
+    m_rowStart = (unsigned int)m_top;
+    m_rowEnd = (unsigned int)m_bottom;
+    m_colStart = (unsigned int)m_left;
+    m_colEnd = (unsigned int)m_right;
+    if (m_rowStart >= m_rowEnd || m_colStart >= m_colEnd)
+      return;
+
+    if (!m_distortion) {
+      m_x.resize(m_I.getWidth());
+      m_y.resize(m_I.getHeight());
+      double x = 0, y = 0;
+      for (unsigned int j = m_colStart; j < m_colEnd; j++)
+        vpPixelMeterConversion::convertPoint(m_cam, (double)j, 0., m_x[j], y);
+      for (unsigned int i = m_rowStart; i < m_rowEnd; i++)
+        vpPixelMeterConversion::convertPoint(m_cam, 0., (double)i, x, m_y[i]);
+    }
+
+    m_nbTilesX = (m_colEnd - m_colStart + vpImageSimulatorTileSize - 1) / vpImageSimulatorTileSize;
+    unsigned int nbTilesY = (m_rowEnd - m_rowStart + vpImageSimulatorTileSize - 1) / vpImageSimulatorTileSize;
+    vpThreadPool::parallelFor(0, m_nbTilesX * nbTilesY, *this, 0, 1);
+  }
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    bool localDepth = (m_zBuffer == NULL && m_planes.size() > 1);
+    std::vector<double> depth;
+    for (unsigned int tile = start; tile < end; tile++) {
+      unsigned int i0 = m_rowStart + (tile / m_nbTilesX) * vpImageSimulatorTileSize;
+      unsigned int j0 = m_colStart + (tile % m_nbTilesX) * vpImageSimulatorTileSize;
+      unsigned int i1 = std::min(i0 + vpImageSimulatorTileSize, m_rowEnd);
+      unsigned int j1 = std::min(j0 + vpImageSimulatorTileSize, m_colEnd);
+      if (localDepth)
+        depth.assign((i1 - i0) * (j1 - j0), -1.);
+
+      for (size_t p = 0; p < m_planes.size(); p++) {
+        for (unsigned int i = i0; i < i1; i++) {
+          double *rowDepth = NULL;
+          if (m_zBuffer != NULL)
+            rowDepth = (*m_zBuffer)[i] + j0;
+          else if (localDepth)
+            rowDepth = &depth[(i - i0) * (j1 - j0)];
+          renderRow(m_planes[p], i, j0, j1, rowDepth);
+        }
+      }
+    }
+  }
+
+private:
+  struct vpPlane
+  {
+    double n[3], X0[3], bu[3], bv[3];
+    double distance, X0bu, X0bv, inv_nu2, inv_nv2;
+    // For each triangle: first apex (i, j) and inverse of the matrix of the edges
+    std::vector<double> triangles;
+    const vpImage<unsigned char> *Ig;
+    const vpImage<vpRGBa> *Ic;
+    vpInterpolationType interp;
+  };
+
+  // Columns of the row i in [j0, j1) that may be inside the triangle t of the plane
+  void getSpan(const vpPlane &plane, size_t t, unsigned int i, unsigned int &j0, unsigned int &j1) const
+  {
+    if (m_distortion)
+      return;
+    const double *tri = &plane.triangles[t];
+    double dy = m_y[i] - tri[0];
+    double c0 = dy * tri[2], c1 = dy * tri[3];
+    const double threshold = 0.00001;
+    double lo = m_x[j0] - tri[1], hi = m_x[j1 - 1] - tri[1];
+    clipSpan(c0, tri[4], -threshold, lo, hi);
+    clipSpan(c1, tri[5], -threshold, lo, hi);
+    clipSpan(-c0 - c1, -tri[4] - tri[5], -1. - threshold, lo, hi);
+    if (lo > hi) {
+      j1 = j0;
+      return;
+    }
+    // One pixel margin, the pixels of the span are tested again
+    double jlo = std::floor((lo + tri[1]) * m_cam.get_px() + m_cam.get_u0()) - 1;
+    double jhi = std::ceil((hi + tri[1]) * m_cam.get_px() + m_cam.get_u0()) + 2;
+    if (jlo > j0)
+      j0 = (unsigned int)jlo;
+    if (jhi < j1)
+      j1 = (unsigned int)std::max(jhi, (double)j0);
+  }
+
+  void renderRow(const vpPlane &plane, unsigned int i, unsigned int j0, unsigned int j1, double *rowDepth) const
+  {
+    Type *bitmap = m_I[i];
+    double y = m_distortion ? 0. : m_y[i];
+    // Terms of the depth and of the texture coordinates that are constant along the row
+    double nRow = plane.n[1] * y + plane.n[2];
+    double buRow = plane.bu[1] * y + plane.bu[2];
+    double bvRow = plane.bv[1] * y + plane.bv[2];
+
+    for (size_t t = 0; t < plane.triangles.size(); t += 6) {
+      unsigned int jstart = j0, jend = j1;
+      getSpan(plane, t, i, jstart, jend);
+      const double *tri = &plane.triangles[t];
+      double dy = y - tri[0];
+
+      for (unsigned int j = jstart; j < jend; j++) {
+        double x = 0;
+        if (m_distortion) {
+          vpPixelMeterConversion::convertPoint(m_cam, (double)j, (double)i, x, y);
+          dy = y - tri[0];
+          nRow = plane.n[1] * y + plane.n[2];
+          buRow = plane.bu[1] * y + plane.bu[2];
+          bvRow = plane.bv[1] * y + plane.bv[2];
+        }
+        else
+          x = m_x[j];
+
+        double dx = x - tri[1];
+        double p0 = dy * tri[2] + dx * tri[4];
+        double p1 = dy * tri[3] + dx * tri[5];
+        if (!(p0 + p1 < 1.00001 && p0 > -0.00001 && p1 > -0.00001))
+          continue;
+
+        double z = plane.distance / (plane.n[0] * x + nRow);
+        double u = (z * (plane.bu[0] * x + buRow) - plane.X0bu) * plane.inv_nu2;
+        double v = (z * (plane.bv[0] * x + bvRow) - plane.X0bv) * plane.inv_nv2;
+        if (!(u > 0 && v > 0 && u < 1. && v < 1.))
+          continue;
+
+        if (rowDepth != NULL) {
+          double &d = rowDepth[j - j0];
+          if (!(z < d || d < 0))
+            continue;
+          d = z;
+        }
+
+        if (plane.Ig != NULL)
+          setPixel(bitmap[j], getTexel(*plane.Ig, v * (plane.Ig->getHeight() - 1), u * (plane.Ig->getWidth() - 1),
+                                       plane.interp));
+        else
+          setPixel(bitmap[j], getTexel(*plane.Ic, v * (plane.Ic->getHeight() - 1), u * (plane.Ic->getWidth() - 1),
+                                       plane.interp));
+      }
+    }
+  }
+
+  vpImage<Type> &m_I;
+  const vpCameraParameters &m_cam;
+  vpMatrix *m_zBuffer;
+  std::vector<vpPlane> m_planes;
+  // Normalized coordinates of the columns and of the rows when there is no distortion
+  std::vector<double> m_x, m_y;
+  bool m_distortion;
+  double m_top, m_bottom, m_left, m_right;
+  unsigned int m_rowStart, m_colStart, m_rowEnd, m_colEnd, m_nbTilesX;
+};
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
   Basic constructor.
   
@@ -61,7 +350,7 @@ vpImageSimulator::vpImageSimulator(const vpColorPlan &col)
   : cMt(), pt(), ptClipped(), interp(SIMPLE), normal_obj(), normal_Cam(), normal_Cam_optim(),
     distance(1.), visible_result(1.), visible(false), X0_2_optim(NULL),
     euclideanNorm_u(0.), euclideanNorm_v(0.), vbase_u(), vbase_v(),
-    vbase_u_optim(NULL), vbase_v_optim(NULL), Xinter_optim(NULL), listTriangle(),
+    vbase_u_optim(NULL), vbase_v_optim(NULL), listTriangle(),
     colorI(col), Ig(), Ic(), rect(), cleanPrevImage(false),
     setBackgroundTexture(false), bgColor(vpColor::white), focal(), needClipping(false)
 {
@@ -88,7 +377,6 @@ vpImageSimulator::vpImageSimulator(const vpColorPlan &col)
   X0_2_optim = new double[3];
   vbase_u_optim = new double[3];
   vbase_v_optim = new double[3];
-  Xinter_optim = new double[3];
 
   pt.resize(4);
 }
@@ -101,7 +389,7 @@ vpImageSimulator::vpImageSimulator(const vpImageSimulator &text)
   : cMt(), pt(), ptClipped(), interp(SIMPLE), normal_obj(), normal_Cam(), normal_Cam_optim(),
     distance(1.), visible_result(1.), visible(false), X0_2_optim(NULL),
     euclideanNorm_u(0.), euclideanNorm_v(0.), vbase_u(), vbase_v(),
-    vbase_u_optim(NULL), vbase_v_optim(NULL), Xinter_optim(NULL), listTriangle(),
+    vbase_u_optim(NULL), vbase_v_optim(NULL), listTriangle(),
     colorI(GRAY_SCALED), Ig(), Ic(), rect(), cleanPrevImage(false),
     setBackgroundTexture(false), bgColor(vpColor::white), focal(), needClipping(false)
 {
@@ -135,7 +423,6 @@ vpImageSimulator::vpImageSimulator(const vpImageSimulator &text)
   X0_2_optim = new double[3];
   vbase_u_optim = new double[3];
   vbase_v_optim = new double[3];
-  Xinter_optim = new double[3];
   
   colorI = text.colorI;
   interp = text.interp;
@@ -155,7 +442,6 @@ vpImageSimulator::~vpImageSimulator()
   delete[] X0_2_optim;
   delete[] vbase_u_optim;
   delete[] vbase_v_optim;
-  delete[] Xinter_optim;
 }
 
 
@@ -218,50 +504,9 @@ vpImageSimulator::getImage(vpImage<unsigned char> &I,
 
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-    
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-    
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        if (colorI == GRAY_SCALED)
-        {
-          unsigned char Ipixelplan = 0;
-          if(getPixel(ip,Ipixelplan))
-          {
-            *(bitmap+i*width+j)=Ipixelplan;
-            nb_point_dessine++;
-          }
-        }
-        else if (colorI == COLORED)
-        {
-          vpRGBa Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            unsigned char pixelgrey = (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-            *(bitmap+i*width+j)=pixelgrey;
-            nb_point_dessine++;
-          }
-        }
-      }
-    }
+    vpRasterizer<unsigned char> rasterizer(I, cam);
+    rasterizer.addPlane(*this);
+    rasterizer.render();
   }
 }
 
@@ -291,37 +536,9 @@ vpImageSimulator::getImage(vpImage<unsigned char> &I,
   }
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        unsigned char Ipixelplan = 0;
-        if(getPixel(Isrc,ip,Ipixelplan))
-        {
-          *(bitmap+i*width+j)=Ipixelplan;
-          nb_point_dessine++;
-        }
-      }
-    }
+    vpRasterizer<unsigned char> rasterizer(I, cam);
+    rasterizer.addPlane(*this, &Isrc);
+    rasterizer.render();
   }
 }
 
@@ -354,58 +571,9 @@ vpImageSimulator::getImage(vpImage<unsigned char> &I,
   }
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-    
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-    
-    unsigned char *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        if (colorI == GRAY_SCALED)
-        {
-          unsigned char Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0)
-            {
-              *(bitmap+i*width+j)=Ipixelplan;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
-        else if (colorI == COLORED)
-        {
-          vpRGBa Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0)
-            {
-              unsigned char pixelgrey = (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-              *(bitmap+i*width+j)=pixelgrey;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
-      }
-    }
+    vpRasterizer<unsigned char> rasterizer(I, cam, &zBuffer);
+    rasterizer.addPlane(*this);
+    rasterizer.render();
   }
 }
 
@@ -431,53 +599,9 @@ vpImageSimulator::getImage(vpImage<vpRGBa> &I, const vpCameraParameters &cam)
   
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-    
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-    
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        if (colorI == GRAY_SCALED)
-        {
-          unsigned char Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            vpRGBa pixelcolor;
-            pixelcolor.R = Ipixelplan;
-            pixelcolor.G = Ipixelplan;
-            pixelcolor.B = Ipixelplan;
-            *(bitmap+i*width+j) = pixelcolor;
-            nb_point_dessine++;
-          }
-        }
-        else if (colorI == COLORED)
-        {
-          vpRGBa Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            *(bitmap+i*width+j) = Ipixelplan;
-            nb_point_dessine++;
-          }
-        }
-      }
-    }
+    vpRasterizer<vpRGBa> rasterizer(I, cam);
+    rasterizer.addPlane(*this);
+    rasterizer.render();
   }
 }
 
@@ -506,37 +630,9 @@ vpImageSimulator::getImage(vpImage<vpRGBa> &I, vpImage<vpRGBa> &Isrc,
   
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-    
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-    
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        vpRGBa Ipixelplan;
-        if(getPixel(Isrc,ip,Ipixelplan))
-        {
-          *(bitmap+i*width+j) = Ipixelplan;
-          nb_point_dessine++;
-        }
-      }
-    }
+    vpRasterizer<vpRGBa> rasterizer(I, cam);
+    rasterizer.addPlane(*this, &Isrc);
+    rasterizer.render();
   }
 }
 
@@ -568,61 +664,9 @@ vpImageSimulator::getImage(vpImage<vpRGBa> &I, const vpCameraParameters &cam,
   }
   if(visible)
   {
-    if(!needClipping)
-      getRoi(I.getWidth(),I.getHeight(),cam,pt,rect);
-    else
-      getRoi(I.getWidth(),I.getHeight(),cam,ptClipped,rect);
-    
-    double top = rect.getTop();
-    double bottom = rect.getBottom();
-    double left = rect.getLeft();
-    double right= rect.getRight();
-    
-    vpRGBa *bitmap = I.bitmap;
-    unsigned int width = I.getWidth();
-    vpImagePoint ip;
-    int nb_point_dessine = 0;
-
-    for (unsigned int i = (unsigned int)top; i < (unsigned int)bottom; i++)
-    {
-      for (unsigned int j = (unsigned int)left; j < (unsigned int)right; j++)
-      {
-        double x=0,y=0;
-        ip.set_ij(i,j);
-        vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-        ip.set_ij(y,x);
-        if (colorI == GRAY_SCALED)
-        {
-          unsigned char Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0)
-            {
-              vpRGBa pixelcolor;
-              pixelcolor.R = Ipixelplan;
-              pixelcolor.G = Ipixelplan;
-              pixelcolor.B = Ipixelplan;
-              *(bitmap+i*width+j) = pixelcolor;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
-        else if (colorI == COLORED)
-        {
-          vpRGBa Ipixelplan;
-          if(getPixel(ip,Ipixelplan))
-          {
-            if (Xinter_optim[2] < zBuffer[i][j] || zBuffer[i][j] < 0)
-            {
-              *(bitmap+i*width+j) = Ipixelplan;
-              nb_point_dessine++;
-              zBuffer[i][j] = Xinter_optim[2];
-            }
-          }
-        }
-      }
-    }
+    vpRasterizer<vpRGBa> rasterizer(I, cam, &zBuffer);
+    rasterizer.addPlane(*this);
+    rasterizer.render();
   }
 }
 
@@ -731,99 +775,10 @@ vpImageSimulator::getImage(vpImage<unsigned char> &I,
                            std::list<vpImageSimulator> &list,
                            const vpCameraParameters &cam)
 {
-
-  unsigned int width = I.getWidth();
-  unsigned int height = I.getHeight();
-
-  unsigned int nbsimList = (unsigned int)list.size();
-
-  if (nbsimList < 1)
-    return;
-
-  vpImageSimulator** simList = new vpImageSimulator* [nbsimList];
-
-  double topFinal = height+1;;
-  double bottomFinal = -1;
-  double leftFinal = width+1;
-  double rightFinal = -1;
-
-  unsigned int unvisible = 0;
-  unsigned int indexSimu=0;
-  for(std::list<vpImageSimulator>::iterator it=list.begin(); it!=list.end(); ++it, ++indexSimu){
-    vpImageSimulator* sim = &(*it);
-    if (sim->visible)
-      simList[indexSimu] = sim;
-    else
-      unvisible++;
-  }
-  nbsimList = nbsimList - unvisible;
-
-   if (nbsimList < 1)
-   {
-     delete[] simList;
-     return;
-   }
-
-
-  for (unsigned int i = 0; i < nbsimList; i++)
-  {
-    if(!simList[i]->needClipping)
-        simList[i]->getRoi(width,height,cam,simList[i]->pt,simList[i]->rect);
-    else
-        simList[i]->getRoi(width,height,cam,simList[i]->ptClipped,simList[i]->rect);
-
-    if (topFinal > simList[i]->rect.getTop()) topFinal = simList[i]->rect.getTop();
-    if (bottomFinal < simList[i]->rect.getBottom()) bottomFinal = simList[i]->rect.getBottom();
-    if (leftFinal > simList[i]->rect.getLeft()) leftFinal = simList[i]->rect.getLeft();
-    if (rightFinal < simList[i]->rect.getRight()) rightFinal = simList[i]->rect.getRight();
-  }
-
-  double zmin = -1;
-  int indice = -1;
-  unsigned char *bitmap = I.bitmap;
-  vpImagePoint ip;
-
-  for (unsigned int i = (unsigned int)topFinal; i < (unsigned int)bottomFinal; i++)
-  {
-    for (unsigned int j = (unsigned int)leftFinal; j < (unsigned int)rightFinal; j++)
-    {
-      zmin = -1;
-      double x=0,y=0;
-      ip.set_ij(i,j);
-      vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-      ip.set_ij(y,x);
-      for (int k = 0; k < (int)nbsimList; k++)
-      {
-  double z = 0;
-  if(simList[k]->getPixelDepth(ip,z))
-  {
-    if (z < zmin || zmin < 0)
-    {
-      zmin = z;
-      indice = k;
-    }
-  }
-      }
-      if (indice >= 0)
-      {
-        if (simList[indice]->colorI == GRAY_SCALED)
-        {
-    unsigned char Ipixelplan = 255;
-          simList[indice]->getPixel(ip,Ipixelplan);
-    *(bitmap+i*width+j)=Ipixelplan;
-        }
-        else if (simList[indice]->colorI == COLORED)
-        {
-    vpRGBa Ipixelplan(255,255,255);
-    simList[indice]->getPixel(ip,Ipixelplan);
-    unsigned char pixelgrey = (unsigned char)(0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B);
-    *(bitmap+i*width+j)=pixelgrey;
-        }
-      }
-    }
-  }
-
-  delete[] simList;
+  vpRasterizer<unsigned char> rasterizer(I, cam);
+  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it)
+    rasterizer.addPlane(*it);
+  rasterizer.render();
 }
 
 
@@ -933,103 +888,10 @@ vpImageSimulator::getImage(vpImage<vpRGBa> &I,
                            std::list<vpImageSimulator> &list,
                            const vpCameraParameters &cam)
 {
-
-  unsigned int width = I.getWidth();
-  unsigned int height = I.getHeight();
-
-  unsigned int nbsimList = (unsigned int)list.size();
-
-  if (nbsimList < 1)
-    return;
-
-  vpImageSimulator** simList = new vpImageSimulator* [nbsimList];
-
-  double topFinal = height+1;;
-  double bottomFinal = -1;
-  double leftFinal = width+1;
-  double rightFinal = -1;
-
-  unsigned int unvisible = 0;
-  unsigned int indexSimu = 0;
-  for(std::list<vpImageSimulator>::iterator it=list.begin(); it!=list.end(); ++it, ++indexSimu){
-    vpImageSimulator* sim = &(*it);
-    if (sim->visible)
-      simList[indexSimu] = sim;
-    else
-      unvisible++;
-  }
-
-  nbsimList = nbsimList - unvisible;
-
-   if (nbsimList < 1)
-   {
-     delete[] simList;
-     return;
-   }
-
-  for (unsigned int i = 0; i < nbsimList; i++)
-  {
-    if(!simList[i]->needClipping)
-        simList[i]->getRoi(width,height,cam,simList[i]->pt,simList[i]->rect);
-    else
-        simList[i]->getRoi(width,height,cam,simList[i]->ptClipped,simList[i]->rect);
-
-    if (topFinal > simList[i]->rect.getTop()) topFinal = simList[i]->rect.getTop();
-    if (bottomFinal < simList[i]->rect.getBottom()) bottomFinal = simList[i]->rect.getBottom();
-    if (leftFinal > simList[i]->rect.getLeft()) leftFinal = simList[i]->rect.getLeft();
-    if (rightFinal < simList[i]->rect.getRight()) rightFinal = simList[i]->rect.getRight();
-  }
-
-  double zmin = -1;
-  int indice = -1;
-  vpRGBa *bitmap = I.bitmap;
-  vpImagePoint ip;
-
-  for (unsigned int i = (unsigned int)topFinal; i < (unsigned int)bottomFinal; i++)
-  {
-    for (unsigned int j = (unsigned int)leftFinal; j < (unsigned int)rightFinal; j++)
-    {
-      zmin = -1;
-      double x=0,y=0;
-      ip.set_ij(i,j);
-      vpPixelMeterConversion::convertPoint(cam,ip, x,y);
-      ip.set_ij(y,x);
-      for (int k = 0; k < (int)nbsimList; k++)
-      {
-  double z = 0;
-  if(simList[k]->getPixelDepth(ip,z))
-  {
-    if (z < zmin || zmin < 0)
-    {
-      zmin = z;
-      indice = k;
-    }
-  }
-      }
-      if (indice >= 0)
-      {
-        if (simList[indice]->colorI == GRAY_SCALED)
-        {
-    unsigned char Ipixelplan = 255;
-          simList[indice]->getPixel(ip,Ipixelplan);
-    vpRGBa pixelcolor;
-    pixelcolor.R = Ipixelplan;
-    pixelcolor.G = Ipixelplan;
-    pixelcolor.B = Ipixelplan;
-    *(bitmap+i*width+j) = pixelcolor;
-        }
-        else if (simList[indice]->colorI == COLORED)
-        {
-    vpRGBa Ipixelplan(255,255,255);
-    simList[indice]->getPixel(ip,Ipixelplan);
-    //unsigned char pixelgrey = 0.2126 * Ipixelplan.R + 0.7152 * Ipixelplan.G + 0.0722 * Ipixelplan.B;
-    *(bitmap+i*width+j)=Ipixelplan;
-        }
-      }
-    }
-  }
-
-  delete[] simList;
+  vpRasterizer<vpRGBa> rasterizer(I, cam);
+  for (std::list<vpImageSimulator>::iterator it = list.begin(); it != list.end(); ++it)
+    rasterizer.addPlane(*it);
+  rasterizer.render();
 }
 
 /*!
@@ -1310,266 +1172,6 @@ vpImageSimulator::init(const char* file_image, const std::vector<vpPoint>& X_)
 }
 #endif
 
-bool
-vpImageSimulator::getPixel(const vpImagePoint &iP, unsigned char &Ipixelplan)
-{
-//  std::cout << "In get Pixel" << std::endl;
-  //test si pixel dans zone projetee
-  bool inside = false;
-  for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-      if(listTriangle[i].inTriangle(iP)){
-          inside = true;
-          break;
-      }
-  if(!inside) return false;
-
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP)){
-////      std::cout << "The pixel is inside the projected area" << std::endl;
-//    return false;}
-
-  //methoed algebrique
-  double z;
-
-  //calcul de la profondeur de l'intersection
-  z = distance/(normal_Cam_optim[0]*iP.get_u()+normal_Cam_optim[1]*iP.get_v()+normal_Cam_optim[2]);
-  //calcul coordonnees 3D intersection
-  Xinter_optim[0]=iP.get_u()*z;
-  Xinter_optim[1]=iP.get_v()*z;
-  Xinter_optim[2]=z;
-
-  //recuperation des coordonnes de l'intersection dans le plan objet
-  //repere plan object : 
-  //	centre = X0_2_optim[i] (premier point definissant le plan)
-  //	base =  u:(X[1]-X[0]) et v:(X[3]-X[0])
-  //ici j'ai considere que le plan est un rectangle => coordonnees sont simplement obtenu par un produit scalaire
-  double u = 0, v = 0;
-  for(unsigned int i = 0; i < 3; i++)
-  {
-    double diff = (Xinter_optim[i]-X0_2_optim[i]);
-    u += diff*vbase_u_optim[i];
-    v += diff*vbase_v_optim[i];
-  }
-  u = u/(euclideanNorm_u*euclideanNorm_u);
-  v = v/(euclideanNorm_v*euclideanNorm_v);
-
-  if( u > 0 && v > 0 && u < 1. && v < 1.)
-  {
-    double i2,j2;
-    i2=v*(Ig.getHeight()-1);
-    j2=u*(Ig.getWidth()-1);
-    if (interp == BILINEAR_INTERPOLATION)
-      Ipixelplan = Ig.getValue(i2,j2);
-    else if (interp == SIMPLE)
-      Ipixelplan = Ig[(unsigned int)i2][(unsigned int)j2];
-    return true;
-  }
-  else
-    return false;
-}
-
-bool
-vpImageSimulator::getPixel(vpImage<unsigned char> &Isrc, 
-			   const vpImagePoint &iP, unsigned char &Ipixelplan)
-{
-  //test si pixel dans zone projetee
-  bool inside = false;
-  for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-      if(listTriangle[i].inTriangle(iP)){
-          inside = true;
-          break;
-      }
-  if(!inside) return false;
-
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP))
-//    return false;
-
-  //methoed algebrique
-  double z;
-
-  //calcul de la profondeur de l'intersection
-  z = distance/(normal_Cam_optim[0]*iP.get_u()+normal_Cam_optim[1]*iP.get_v()+normal_Cam_optim[2]);
-  //calcul coordonnees 3D intersection
-  Xinter_optim[0]=iP.get_u()*z;
-  Xinter_optim[1]=iP.get_v()*z;
-  Xinter_optim[2]=z;
-
-  //recuperation des coordonnes de l'intersection dans le plan objet
-  //repere plan object : 
-  //	centre = X0_2_optim[i] (premier point definissant le plan)
-  //	base =  u:(X[1]-X[0]) et v:(X[3]-X[0])
-  //ici j'ai considere que le plan est un rectangle => coordonnees sont simplement obtenu par un produit scalaire
-  double u = 0, v = 0;
-  for(unsigned int i = 0; i < 3; i++)
-  {
-    double diff = (Xinter_optim[i]-X0_2_optim[i]);
-    u += diff*vbase_u_optim[i];
-    v += diff*vbase_v_optim[i];
-  }
-  u = u/(euclideanNorm_u*euclideanNorm_u);
-  v = v/(euclideanNorm_v*euclideanNorm_v);
-
-  if( u > 0 && v > 0 && u < 1. && v < 1.)
-  {
-    double i2,j2;
-    i2=v*(Isrc.getHeight()-1);
-    j2=u*(Isrc.getWidth()-1);
-    if (interp == BILINEAR_INTERPOLATION)
-      Ipixelplan = Isrc.getValue(i2,j2);
-    else if (interp == SIMPLE)
-      Ipixelplan = Isrc[(unsigned int)i2][(unsigned int)j2];
-    return true;
-  }
-  else
-    return false;
-}
-
-
-bool
-vpImageSimulator::getPixel(const vpImagePoint &iP, vpRGBa &Ipixelplan)
-{
-  //test si pixel dans zone projetee
-  bool inside = false;
-  for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-      if(listTriangle[i].inTriangle(iP)){
-          inside = true;
-          break;
-      }
-  if(!inside) return false;
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP))
-//    return false;
-
-  //methoed algebrique
-  double z;
-
-  //calcul de la profondeur de l'intersection
-  z = distance/(normal_Cam_optim[0]*iP.get_u()+normal_Cam_optim[1]*iP.get_v()+normal_Cam_optim[2]);
-  //calcul coordonnees 3D intersection
-  Xinter_optim[0]=iP.get_u()*z;
-  Xinter_optim[1]=iP.get_v()*z;
-  Xinter_optim[2]=z;
-
-  //recuperation des coordonnes de l'intersection dans le plan objet
-  //repere plan object : 
-  //	centre = X0_2_optim[i] (premier point definissant le plan)
-  //	base =  u:(X[1]-X[0]) et v:(X[3]-X[0])
-  //ici j'ai considere que le plan est un rectangle => coordonnees sont simplement obtenu par un produit scalaire
-  double u = 0, v = 0;
-  for(unsigned int i = 0; i < 3; i++)
-  {
-    double diff = (Xinter_optim[i]-X0_2_optim[i]);
-    u += diff*vbase_u_optim[i];
-    v += diff*vbase_v_optim[i];
-  }
-  u = u/(euclideanNorm_u*euclideanNorm_u);
-  v = v/(euclideanNorm_v*euclideanNorm_v);
-
-  if( u > 0 && v > 0 && u < 1. && v < 1.)
-  {
-    double i2,j2;
-    i2=v*(Ic.getHeight()-1);
-    j2=u*(Ic.getWidth()-1);
-    if (interp == BILINEAR_INTERPOLATION)
-      Ipixelplan = Ic.getValue(i2,j2);
-    else if (interp == SIMPLE)
-      Ipixelplan = Ic[(unsigned int)i2][(unsigned int)j2];
-    return true;
-  }
-  else
-    return false;
-}
-
-bool
-vpImageSimulator::getPixel(vpImage<vpRGBa> &Isrc, const vpImagePoint &iP,
-			   vpRGBa &Ipixelplan)
-{
-  //test si pixel dans zone projetee
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP))
-//    return false;
-  bool inside = false;
-  for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-      if(listTriangle[i].inTriangle(iP)){
-          inside = true;
-          break;
-      }
-  if(!inside) return false;
-
-  //methoed algebrique
-  double z;
-
-  //calcul de la profondeur de l'intersection
-  z = distance/(normal_Cam_optim[0]*iP.get_u()+normal_Cam_optim[1]*iP.get_v()+normal_Cam_optim[2]);
-  //calcul coordonnees 3D intersection
-  Xinter_optim[0]=iP.get_u()*z;
-  Xinter_optim[1]=iP.get_v()*z;
-  Xinter_optim[2]=z;
-
-  //recuperation des coordonnes de l'intersection dans le plan objet
-  //repere plan object : 
-  //	centre = X0_2_optim[i] (premier point definissant le plan)
-  //	base =  u:(X[1]-X[0]) et v:(X[3]-X[0])
-  //ici j'ai considere que le plan est un rectangle => coordonnees sont simplement obtenu par un produit scalaire
-  double u = 0, v = 0;
-  for(unsigned int i = 0; i < 3; i++)
-  {
-    double diff = (Xinter_optim[i]-X0_2_optim[i]);
-    u += diff*vbase_u_optim[i];
-    v += diff*vbase_v_optim[i];
-  }
-  u = u/(euclideanNorm_u*euclideanNorm_u);
-  v = v/(euclideanNorm_v*euclideanNorm_v);
-
-  if( u > 0 && v > 0 && u < 1. && v < 1.)
-  {
-    double i2,j2;
-    i2=v*(Isrc.getHeight()-1);
-    j2=u*(Isrc.getWidth()-1);
-    if (interp == BILINEAR_INTERPOLATION)
-      Ipixelplan = Isrc.getValue(i2,j2);
-    else if (interp == SIMPLE)
-      Ipixelplan = Isrc[(unsigned int)i2][(unsigned int)j2];
-    return true;
-  }
-  else
-    return false;
-}
-
-bool 
-vpImageSimulator::getPixelDepth(const vpImagePoint &iP, double &Zpixelplan)
-{
-  //test si pixel dans zone projetee
-    bool inside = false;
-    for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-        if(listTriangle[i].inTriangle(iP)){
-            inside = true;
-            break;
-        }
-    if(!inside) return false;
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP))
-//    return false;
-
-  Zpixelplan = distance/(normal_Cam_optim[0]*iP.get_u()+normal_Cam_optim[1]*iP.get_v()+normal_Cam_optim[2]);
-  return true;
-}
-
-bool
-vpImageSimulator::getPixelVisibility(const vpImagePoint &iP, 
-				     double &Visipixelplan)
-{
-  //test si pixel dans zone projetee
-  bool inside = false;
-  for(unsigned int i = 0 ; i < listTriangle.size() ; i++)
-      if(listTriangle[i].inTriangle(iP)){
-          inside = true;
-          break;
-      }
-  if(!inside) return false;
-//  if(!T1.inTriangle(iP) && !T2.inTriangle(iP))
-//    return false;
-  
-  Visipixelplan = visible_result;
-  return true;
-}
-
 void
 vpImageSimulator::project(const vpColVector &_vin, 
 			  const vpHomogeneousMatrix &_cMt, vpColVector &_vout)
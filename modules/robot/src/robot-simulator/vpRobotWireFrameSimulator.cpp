@@ -40,6 +40,7 @@
 #if defined(VISP_HAVE_MODULE_GUI) && ((defined(_WIN32) && !defined(WINRT_8_0)) || defined(VISP_HAVE_PTHREAD))
 #include <visp3/robot/vpRobotWireFrameSimulator.h>
 #include <visp3/robot/vpSimulatorViper850.h>
+#include <visp3/robot/vpRobotException.h>
 
 #include "../wireframe-simulator/vpBound.h"
 #include "../wireframe-simulator/vpVwstack.h"
@@ -62,7 +63,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator()
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(true), constantSamplingTimeMode(false),
-    setVelocityCalled(false), verbose_(false)
+    setVelocityCalled(false), verbose_(false), simulationMode(REAL_TIME), simulationTime(0)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -94,7 +95,7 @@ vpRobotWireFrameSimulator::vpRobotWireFrameSimulator(bool do_display)
     display(),
 #endif
     displayType(MODEL_3D), displayAllowed(do_display), constantSamplingTimeMode(false),
-    setVelocityCalled(false), verbose_(false)
+    setVelocityCalled(false), verbose_(false), simulationMode(REAL_TIME), simulationTime(0)
 {
   setSamplingTime(0.010);
   velocity.resize(6);
@@ -119,6 +120,126 @@ vpRobotWireFrameSimulator::~vpRobotWireFrameSimulator()
 {
 }
 
+/*!
+  Create the mutexes and, in the REAL_TIME mode, launch the thread which
+  moves the robot. Called at the end of the constructor of the simulators,
+  once the robot is initialized.
+*/
+void
+vpRobotWireFrameSimulator::startSimulation()
+{
+#if defined(_WIN32)
+#  ifdef WINRT_8_1
+  mutex_fMi = CreateMutexEx(NULL, NULL, 0, NULL);
+  mutex_artVel = CreateMutexEx(NULL, NULL, 0, NULL);
+  mutex_artCoord = CreateMutexEx(NULL, NULL, 0, NULL);
+  mutex_velocity = CreateMutexEx(NULL, NULL, 0, NULL);
+  mutex_display = CreateMutexEx(NULL, NULL, 0, NULL);
+#  else
+  mutex_fMi = CreateMutex(NULL, FALSE, NULL);
+  mutex_artVel = CreateMutex(NULL, FALSE, NULL);
+  mutex_artCoord = CreateMutex(NULL, FALSE, NULL);
+  mutex_velocity = CreateMutex(NULL, FALSE, NULL);
+  mutex_display = CreateMutex(NULL, FALSE, NULL);
+#  endif
+
+  if (simulationMode == REAL_TIME) {
+    DWORD   dwThreadIdArray;
+    hThread = CreateThread(
+              NULL,                   // default security attributes
+              0,                      // use default stack size
+              launcher,               // thread function name
+              this,                   // argument to thread function
+              0,                      // use default creation flags
+              &dwThreadIdArray);      // returns the thread identifier
+  }
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_mutex_init(&mutex_fMi, NULL);
+  pthread_mutex_init(&mutex_artVel, NULL);
+  pthread_mutex_init(&mutex_artCoord, NULL);
+  pthread_mutex_init(&mutex_velocity, NULL);
+  pthread_mutex_init(&mutex_display, NULL);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+
+  if (simulationMode == REAL_TIME)
+    pthread_create(&thread, NULL, launcher, (void *)this);
+#endif
+}
+
+/*!
+  Stop the thread which moves the robot and release the mutexes. Called by
+  the destructor of the simulators, before their members are destroyed.
+*/
+void
+vpRobotWireFrameSimulator::stopSimulation()
+{
+  robotStop = true;
+
+#if defined(_WIN32)
+  if (simulationMode == REAL_TIME) {
+#  if defined(WINRT_8_1)
+    WaitForSingleObjectEx(hThread, INFINITE, FALSE);
+#  else // pure win32
+    WaitForSingleObject(hThread, INFINITE);
+#  endif
+    CloseHandle(hThread);
+  }
+  CloseHandle(mutex_fMi);
+  CloseHandle(mutex_artVel);
+  CloseHandle(mutex_artCoord);
+  CloseHandle(mutex_velocity);
+  CloseHandle(mutex_display);
+#elif defined(VISP_HAVE_PTHREAD)
+  pthread_attr_destroy(&attr);
+  if (simulationMode == REAL_TIME)
+    pthread_join(thread, NULL);
+  pthread_mutex_destroy(&mutex_fMi);
+  pthread_mutex_destroy(&mutex_artVel);
+  pthread_mutex_destroy(&mutex_artCoord);
+  pthread_mutex_destroy(&mutex_velocity);
+  pthread_mutex_destroy(&mutex_display);
+#endif
+}
+
+/*!
+  Return the time used to timestamp the measures: the simulated time in the
+  STEPPED mode, the wall-clock time in second otherwise.
+*/
+double
+vpRobotWireFrameSimulator::getTimestamp() const
+{
+  if (simulationMode == STEPPED)
+    return simulationTime;
+  return vpTime::measureTimeSecond();
+}
+
+/*!
+  Advance the simulation by \e nbSteps sampling times (see setSamplingTime())
+  with the velocity applied to the robot, as the thread of the REAL_TIME mode
+  does in constant sampling time mode. Nothing is displayed.
+
+  \param nbSteps : Number of sampling times.
+
+  \exception vpRobotException::wrongStateError : If the simulator was not
+  created in the STEPPED mode.
+*/
+void
+vpRobotWireFrameSimulator::step(unsigned int nbSteps)
+{
+  if (simulationMode != STEPPED) {
+    throw vpRobotException(vpRobotException::wrongStateError,
+                           "The simulator can only be stepped in the STEPPED mode");
+  }
+
+  for (unsigned int i = 0; i < nbSteps; i++) {
+    computeArticularVelocity();
+    integrateArticularVelocity(getSamplingTime());
+    simulationTime += getSamplingTime();
+  }
+}
+
 /*!
   Initialize the display. It enables to choose the type of scene which will be used to display the object
   at the current position and at the desired position.
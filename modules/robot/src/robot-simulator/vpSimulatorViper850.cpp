@@ -70,43 +70,8 @@ vpSimulatorViper850::vpSimulatorViper850()
   
   tcur = vpTime::measureTimeMs();
 
-  #if defined(_WIN32)
-#  ifdef WINRT_8_1
-  mutex_fMi = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_artVel = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_artCoord = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_velocity = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_display = CreateMutexEx(NULL, NULL, 0, NULL);
-#  else
-  mutex_fMi = CreateMutex(NULL, FALSE, NULL);
-  mutex_artVel = CreateMutex(NULL, FALSE, NULL);
-  mutex_artCoord = CreateMutex(NULL, FALSE, NULL);
-  mutex_velocity = CreateMutex(NULL, FALSE, NULL);
-  mutex_display = CreateMutex(NULL, FALSE, NULL);
-#  endif
-
+  startSimulation();
 
-  DWORD   dwThreadIdArray;
-  hThread = CreateThread( 
-            NULL,                   // default security attributes
-            0,                      // use default stack size  
-			launcher,               // thread function name
-            this,                   // argument to thread function 
-            0,                      // use default creation flags 
-            &dwThreadIdArray);     // returns the thread identifier 
-  #elif defined (VISP_HAVE_PTHREAD)
-  pthread_mutex_init(&mutex_fMi, NULL);
-  pthread_mutex_init(&mutex_artVel, NULL);
-  pthread_mutex_init(&mutex_artCoord, NULL);
-  pthread_mutex_init(&mutex_velocity, NULL);
-  pthread_mutex_init(&mutex_display, NULL);
-  
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-  
-  pthread_create(&thread, NULL, launcher, (void *)this);
-  #endif
-  
   compute_fMi();
 }
 
@@ -125,43 +90,52 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
   initDisplay();
     
   tcur = vpTime::measureTimeMs();
-  
-    #if defined(_WIN32)
-#  ifdef WINRT_8_1
-  mutex_fMi = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_artVel = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_artCoord = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_velocity = CreateMutexEx(NULL, NULL, 0, NULL);
-  mutex_display = CreateMutexEx(NULL, NULL, 0, NULL);
-#  else
-  mutex_fMi = CreateMutex(NULL,FALSE,NULL);
-  mutex_artVel = CreateMutex(NULL,FALSE,NULL);
-  mutex_artCoord = CreateMutex(NULL,FALSE,NULL);
-  mutex_velocity = CreateMutex(NULL,FALSE,NULL);
-  mutex_display = CreateMutex(NULL,FALSE,NULL);
-#  endif
 
-  DWORD   dwThreadIdArray;
-  hThread = CreateThread( 
-            NULL,                   // default security attributes
-            0,                      // use default stack size  
-			launcher,               // thread function name
-            this,                   // argument to thread function 
-            0,                      // use default creation flags 
-            &dwThreadIdArray);      // returns the thread identifier 
-  #elif defined(VISP_HAVE_PTHREAD)
-  pthread_mutex_init(&mutex_fMi, NULL);
-  pthread_mutex_init(&mutex_artVel, NULL);
-  pthread_mutex_init(&mutex_artCoord, NULL);
-  pthread_mutex_init(&mutex_velocity, NULL);
-  pthread_mutex_init(&mutex_display, NULL);
-  
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-  
-  pthread_create(&thread, NULL, launcher, (void *)this);
-  #endif
-  
+  startSimulation();
+
+  compute_fMi();
+}
+
+/*!
+  Constructor used to choose the simulation mode.
+
+  \param mode : With vpRobotWireFrameSimulator::STEPPED, no thread is
+  launched and the external view is not displayed: the robot only moves
+  when step() is called. With vpRobotWireFrameSimulator::REAL_TIME, the
+  simulator behaves as with the default constructor.
+
+  \code
+#include <visp3/robot/vpSimulatorViper850.h>
+
+int main()
+{
+  vpSimulatorViper850 robot(vpRobotWireFrameSimulator::STEPPED);
+  robot.setSamplingTime(0.01);
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+
+  vpColVector v(6, 0);
+  v[2] = 0.05; // 5 cm/s along the camera optical axis
+  robot.setVelocity(vpRobot::CAMERA_FRAME, v);
+  robot.step(100); // One second of simulated time
+
+  vpColVector q;
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+}
+  \endcode
+*/
+vpSimulatorViper850::vpSimulatorViper850(const vpSimulationMode &mode)
+  : vpRobotWireFrameSimulator(mode == REAL_TIME),
+    q_prev_getdis(), first_time_getdis(true), positioningVelocity(defaultPositioningVelocity),
+    zeroPos(), reposPos(), toolCustom(false), arm_dir()
+{
+  init();
+  initDisplay();
+    
+  tcur = vpTime::measureTimeMs();
+
+  simulationMode = mode;
+  startSimulation();
+
   compute_fMi();
 }
 
@@ -170,30 +144,8 @@ vpSimulatorViper850::vpSimulatorViper850(bool do_display)
 */
 vpSimulatorViper850::~vpSimulatorViper850()
 {
-  robotStop = true;
-  
-  #if defined(_WIN32)
-#  if defined(WINRT_8_1)
-  WaitForSingleObjectEx(hThread, INFINITE, FALSE);
-#  else // pure win32
-  WaitForSingleObject(hThread, INFINITE);
-#  endif
-  CloseHandle(hThread);
-  CloseHandle(mutex_fMi);
-  CloseHandle(mutex_artVel);
-  CloseHandle(mutex_artCoord);
-  CloseHandle(mutex_velocity);
-  CloseHandle(mutex_display);
-  #elif defined(VISP_HAVE_PTHREAD)
-  pthread_attr_destroy(&attr);
-  pthread_join(thread, NULL);
-  pthread_mutex_destroy(&mutex_fMi);
-  pthread_mutex_destroy(&mutex_artVel);
-  pthread_mutex_destroy(&mutex_artCoord);
-  pthread_mutex_destroy(&mutex_velocity);
-  pthread_mutex_destroy(&mutex_display);
-  #endif
-  
+  stopSimulation();
+
   if (robotArms != NULL)
   {
    // free_Bound_scene (&(camera));
@@ -485,50 +437,7 @@ vpSimulatorViper850::updateArticularPosition()
         ellapsedTime = getSamplingTime(); // in second
       }
       
-      vpColVector articularCoordinates = get_artCoord();
-      vpColVector articularVelocities = get_artVel();
-      
-      if (jointLimit)
-      {
-        double art = articularCoordinates[jointLimitArt-1] + ellapsedTime*articularVelocities[jointLimitArt-1];
-        if (art <= joint_min[jointLimitArt-1] || art >= joint_max[jointLimitArt-1]) {
-          if (verbose_) {
-            std::cout << "Joint " << jointLimitArt-1
-                    << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt-1]) << " < " << vpMath::deg(art) << " < " << vpMath::deg(joint_max[jointLimitArt-1]) << std::endl;
-          }
-          articularVelocities = 0.0;
-        }
-        else
-          jointLimit = false;
-      }
-      
-      articularCoordinates[0] = articularCoordinates[0] + ellapsedTime*articularVelocities[0];
-      articularCoordinates[1] = articularCoordinates[1] + ellapsedTime*articularVelocities[1];
-      articularCoordinates[2] = articularCoordinates[2] + ellapsedTime*articularVelocities[2];
-      articularCoordinates[3] = articularCoordinates[3] + ellapsedTime*articularVelocities[3];
-      articularCoordinates[4] = articularCoordinates[4] + ellapsedTime*articularVelocities[4];
-      articularCoordinates[5] = articularCoordinates[5] + ellapsedTime*articularVelocities[5];
-      
-      int jl = isInJointLimit();
-      
-      if (jl != 0 && jointLimit == false)
-      {
-        if (jl < 0)
-          ellapsedTime = (joint_min[(unsigned int)(-jl-1)] - articularCoordinates[(unsigned int)(-jl-1)])/(articularVelocities[(unsigned int)(-jl-1)]);
-        else
-          ellapsedTime = (joint_max[(unsigned int)(jl-1)] - articularCoordinates[(unsigned int)(jl-1)])/(articularVelocities[(unsigned int)(jl-1)]);
-        
-        for (unsigned int i = 0; i < 6; i++)
-          articularCoordinates[i] = articularCoordinates[i] + ellapsedTime*articularVelocities[i];
-        
-        jointLimit = true;
-        jointLimitArt = (unsigned int)fabs((double)jl);
-      }
-
-      set_artCoord(articularCoordinates);
-      set_artVel(articularVelocities);
-      
-      compute_fMi();
+      integrateArticularVelocity(ellapsedTime);
      
       if (displayAllowed)
       {
@@ -583,6 +492,61 @@ vpSimulatorViper850::updateArticularPosition()
   }
 }
 
+/*!
+  Move the joints with the current articular velocity during \e ellapsedTime
+  seconds. The motion is stopped when a joint reaches its limit.
+
+  \param ellapsedTime : Duration of the motion in second.
+*/
+void
+vpSimulatorViper850::integrateArticularVelocity(double ellapsedTime)
+{
+  vpColVector articularCoordinates = get_artCoord();
+  vpColVector articularVelocities = get_artVel();
+  
+  if (jointLimit)
+  {
+    double art = articularCoordinates[jointLimitArt-1] + ellapsedTime*articularVelocities[jointLimitArt-1];
+    if (art <= joint_min[jointLimitArt-1] || art >= joint_max[jointLimitArt-1]) {
+      if (verbose_) {
+        std::cout << "Joint " << jointLimitArt-1
+                << " reaches a limit: " << vpMath::deg(joint_min[jointLimitArt-1]) << " < " << vpMath::deg(art) << " < " << vpMath::deg(joint_max[jointLimitArt-1]) << std::endl;
+      }
+      articularVelocities = 0.0;
+    }
+    else
+      jointLimit = false;
+  }
+  
+  articularCoordinates[0] = articularCoordinates[0] + ellapsedTime*articularVelocities[0];
+  articularCoordinates[1] = articularCoordinates[1] + ellapsedTime*articularVelocities[1];
+  articularCoordinates[2] = articularCoordinates[2] + ellapsedTime*articularVelocities[2];
+  articularCoordinates[3] = articularCoordinates[3] + ellapsedTime*articularVelocities[3];
+  articularCoordinates[4] = articularCoordinates[4] + ellapsedTime*articularVelocities[4];
+  articularCoordinates[5] = articularCoordinates[5] + ellapsedTime*articularVelocities[5];
+  
+  int jl = isInJointLimit();
+  
+  if (jl != 0 && jointLimit == false)
+  {
+    if (jl < 0)
+      ellapsedTime = (joint_min[(unsigned int)(-jl-1)] - articularCoordinates[(unsigned int)(-jl-1)])/(articularVelocities[(unsigned int)(-jl-1)]);
+    else
+      ellapsedTime = (joint_max[(unsigned int)(jl-1)] - articularCoordinates[(unsigned int)(jl-1)])/(articularVelocities[(unsigned int)(jl-1)]);
+    
+    for (unsigned int i = 0; i < 6; i++)
+      articularCoordinates[i] = articularCoordinates[i] + ellapsedTime*articularVelocities[i];
+    
+    jointLimit = true;
+    jointLimitArt = (unsigned int)fabs((double)jl);
+  }
+
+  set_artCoord(articularCoordinates);
+  set_artVel(articularVelocities);
+  
+  compute_fMi();
+}
+
 /*!
   Compute the pose between the robot reference frame and the frames used to compute the Denavit-Hartenberg
   representation. The last element of the table corresponds to the pose between the reference frame and
@@ -1150,7 +1114,7 @@ vpSimulatorViper850::getVelocity (const vpRobot::vpControlFrameType frame, vpCol
 void
 vpSimulatorViper850::getVelocity (const vpRobot::vpControlFrameType frame, vpColVector & vel, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getVelocity(frame, vel);
 }
 
@@ -1220,7 +1184,7 @@ vpSimulatorViper850::getVelocity (vpRobot::vpControlFrameType frame)
 vpColVector
 vpSimulatorViper850::getVelocity (vpRobot::vpControlFrameType frame, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   vpColVector vel(6);
   getVelocity (frame, vel);
 
@@ -1250,6 +1214,7 @@ vpSimulatorViper850::findHighestPositioningSpeed(vpColVector &q)
 
   \warning This method is blocking. It returns only when the position
   is reached by the robot.
+  In the STEPPED simulation mode, the position is reached immediately.
 
   \param q : A six dimension vector corresponding to the
   position to reach. All the positions are expressed in meters for the
@@ -1365,12 +1330,13 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
           errsqr = error.sumSquare();
           //findHighestPositioningSpeed(error);
           set_artVel(error);
-          if (errsqr < 1e-4)
+          if (errsqr < 1e-4 || simulationMode == STEPPED)
           {
             set_artCoord (qdes);
             error = 0;
             set_artVel(error);
             set_velocity(error);
+            compute_fMi();
             break;
           }
         }
@@ -1395,12 +1361,13 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
         //findHighestPositioningSpeed(error);
         set_artVel(error);
         setVelocityCalled = true;
-        if (errsqr < 1e-4)
+        if (errsqr < 1e-4 || simulationMode == STEPPED)
         {
           set_artCoord (q);
           error = 0;
           set_artVel(error);
           set_velocity(error);
+          compute_fMi();
           break;
         }
       }while (errsqr > 1e-8);
@@ -1435,12 +1402,13 @@ vpSimulatorViper850::setPosition(const vpRobot::vpControlFrameType frame,const v
           //findHighestPositioningSpeed(error);
           set_artVel(error);
           setVelocityCalled = true;
-          if (errsqr < 1e-4)
+          if (errsqr < 1e-4 || simulationMode == STEPPED)
           {
             set_artCoord (qdes);
             error = 0;
             set_artVel(error);
             set_velocity(error);
+            compute_fMi();
             break;
           }
         }
@@ -1736,7 +1704,7 @@ vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpColV
 void
 vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame, vpColVector &q, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, q);
 }
 
@@ -1784,7 +1752,7 @@ void
 vpSimulatorViper850::getPosition(const vpRobot::vpControlFrameType frame,
                                  vpPoseVector &position, double &timestamp)
 {
-  timestamp = vpTime::measureTimeSecond();
+  timestamp = getTimestamp();
   getPosition(frame, position);
 }
 
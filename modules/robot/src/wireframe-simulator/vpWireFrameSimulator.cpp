@@ -73,6 +73,14 @@
 extern Point2i *point2i;
 extern Point2i *listpoint2i;
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+// Number of simulators sharing the buffers of the display and clipping
+// stages, which are allocated by the first one and released by the last one
+unsigned int vpWireFrameSimulatorInstances = 0;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 
 
 /*
@@ -215,8 +223,10 @@ vpWireFrameSimulator::vpWireFrameSimulator()
     }
   }
     
-  open_display();
-  open_clipping();
+  if (vpWireFrameSimulatorInstances++ == 0) {
+    open_display();
+    open_clipping();
+  }
 
   old_iPr = vpImagePoint(-1,-1);
   old_iPz = vpImagePoint(-1,-1);
@@ -253,8 +263,10 @@ vpWireFrameSimulator::~vpWireFrameSimulator()
     if(displayDesiredObject)
       free_Bound_scene (&(this->desiredScene));
   }
-  close_clipping();
-  close_display ();
+  if (--vpWireFrameSimulatorInstances == 0) {
+    close_clipping();
+    close_display ();
+  }
 
   cameraTrajectory.clear();
   poseList.clear();
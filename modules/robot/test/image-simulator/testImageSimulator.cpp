@@ -0,0 +1,314 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the image simulator.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testImageSimulator.cpp
+
+  Compare the images rendered by vpImageSimulator with a ray casting of the
+  textured planes, for a single plane, a plane and a z-buffer and a list of
+  planes hiding each other, and check that the rendering does not depend on
+  the number of threads.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/core/vpPixelMeterConversion.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/robot/vpImageSimulator.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Textured rectangle seen by the camera
+struct Plane
+{
+  vpColVector P0, bu, bv, n;
+  const vpImage<unsigned char> *texture;
+};
+
+Plane getPlane(vpColVector *X, const vpHomogeneousMatrix &cMt, const vpImage<unsigned char> &texture)
+{
+  vpColVector Xc[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    vpColVector XH(4, 1.);
+    for (unsigned int l = 0; l < 3; l++)
+      XH[l] = X[k][l];
+    Xc[k] = (cMt * XH).extract(0, 3);
+  }
+  Plane plane;
+  plane.P0 = Xc[0];
+  plane.bu = Xc[1] - Xc[0];
+  plane.bv = Xc[3] - Xc[0];
+  plane.n = vpColVector::crossProd(plane.bu, plane.bv);
+  plane.texture = &texture;
+  return plane;
+}
+
+// Cast the ray of each pixel on the planes and keep the nearest texel
+void rayCasting(const std::vector<Plane> &planes, const vpCameraParameters &cam, vpImage<unsigned char> &I)
+{
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      double x = 0, y = 0;
+      vpPixelMeterConversion::convertPoint(cam, (double)j, (double)i, x, y);
+      double zmin = -1;
+      for (size_t k = 0; k < planes.size(); k++) {
+        const Plane &p = planes[k];
+        double z = vpColVector::dotProd(p.n, p.P0) / (p.n[0] * x + p.n[1] * y + p.n[2]);
+        if (z <= 0 || (zmin > 0 && z >= zmin))
+          continue;
+        vpColVector P(3);
+        P[0] = x * z;
+        P[1] = y * z;
+        P[2] = z;
+        double u = vpColVector::dotProd(P - p.P0, p.bu) / p.bu.sumSquare();
+        double v = vpColVector::dotProd(P - p.P0, p.bv) / p.bv.sumSquare();
+        if (u > 0 && v > 0 && u < 1 && v < 1) {
+          zmin = z;
+          I[i][j] = (*p.texture)[(unsigned int)(v * (p.texture->getHeight() - 1))]
+                                [(unsigned int)(u * (p.texture->getWidth() - 1))];
+        }
+      }
+    }
+  }
+}
+
+unsigned int countDifferences(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2)
+{
+  unsigned int nb = 0;
+  for (unsigned int i = 0; i < I1.getSize(); i++) {
+    if (I1.bitmap[i] != I2.bitmap[i])
+      nb++;
+  }
+  return nb;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the projection of images with vpImageSimulator.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    const unsigned int width = 640, height = 480;
+    // Pixels on the border of the projected rectangles, or on the boundary of a texel, may differ
+    const unsigned int tolerance = width * height / 1000;
+    vpCameraParameters cam(800, 810, 320, 240);
+
+    vpImage<unsigned char> texture(90, 120);
+    vpUniRand rand(0);
+    for (unsigned int i = 0; i < texture.getSize(); i++)
+      texture.bitmap[i] = (unsigned char)(1 + rand() * 255);
+    vpImage<vpRGBa> texture_color;
+    vpImageConvert::convert(texture, texture_color);
+
+    vpColVector X[4];
+    for (unsigned int k = 0; k < 4; k++)
+      X[k].resize(3);
+    X[0][0] = -0.4; X[0][1] = -0.3;
+    X[1][0] = 0.4;  X[1][1] = -0.3;
+    X[2][0] = 0.4;  X[2][1] = 0.3;
+    X[3][0] = -0.4; X[3][1] = 0.3;
+
+    vpHomogeneousMatrix cMt1(0.05, -0.02, 1.5, vpMath::rad(20), vpMath::rad(-30), vpMath::rad(10));
+    vpHomogeneousMatrix cMt2(-0.15, 0.1, 1.7, vpMath::rad(-10), vpMath::rad(25), vpMath::rad(-5));
+
+    vpImageSimulator sim(vpImageSimulator::GRAY_SCALED), sim2(vpImageSimulator::GRAY_SCALED);
+    sim.init(texture, X);
+    sim.setCameraPosition(cMt1);
+    sim2.init(texture, X);
+    sim2.setCameraPosition(cMt2);
+
+    std::vector<Plane> planes;
+    planes.push_back(getPlane(X, cMt1, texture));
+    vpImage<unsigned char> I_ref(height, width, 0), I(height, width, 0);
+    rayCasting(planes, cam, I_ref);
+
+    double t = vpTime::measureTimeMs();
+    sim.getImage(I, cam);
+    t = vpTime::measureTimeMs() - t;
+    if (countDifferences(I, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "Single plane failed");
+    }
+    std::cout << "Rendering time: " << t << " ms" << std::endl;
+
+    // Color texture
+    vpImageSimulator sim_color(vpImageSimulator::COLORED);
+    sim_color.init(texture_color, X);
+    sim_color.setCameraPosition(cMt1);
+    vpImage<vpRGBa> I_color(height, width, vpRGBa(0));
+    sim_color.getImage(I_color, cam);
+    vpImage<unsigned char> I_grey(height, width);
+    for (unsigned int i = 0; i < I_color.getSize(); i++)
+      I_grey.bitmap[i] = I_color.bitmap[i].G;
+    if (countDifferences(I_grey, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "Color plane failed");
+    }
+
+    // Two planes drawn one after the other with a z-buffer, and a list of planes
+    planes.push_back(getPlane(X, cMt2, texture));
+    I_ref = 0;
+    rayCasting(planes, cam, I_ref);
+
+    vpMatrix zBuffer(height, width, -1.);
+    I = 0;
+    sim.getImage(I, cam, zBuffer);
+    sim2.getImage(I, cam, zBuffer);
+    if (countDifferences(I, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "Two planes with a z-buffer failed");
+    }
+
+    std::list<vpImageSimulator> list;
+    list.push_back(sim);
+    list.push_back(sim2);
+    I = 0;
+    t = vpTime::measureTimeMs();
+    vpImageSimulator::getImage(I, list, cam);
+    t = vpTime::measureTimeMs() - t;
+    if (countDifferences(I, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "List of planes failed");
+    }
+    std::cout << "Rendering time of the list: " << t << " ms" << std::endl;
+
+    // The rendering does not depend on the number of threads
+    vpImage<unsigned char> I_threads(height, width, 0);
+    vpThreadPool::setConcurrency(3);
+    vpImageSimulator::getImage(I_threads, list, cam);
+    vpThreadPool::setConcurrency(0);
+    if (countDifferences(I_threads, I) > 0) {
+      throw vpException(vpException::fatalError, "List of planes with 3 threads failed");
+    }
+
+    // With distortion the pixels are converted one by one
+    vpCameraParameters cam_distortion(800, 810, 320, 240, -0.1, 0.1);
+    I_ref = 0;
+    rayCasting(planes, cam_distortion, I_ref);
+    I = 0;
+    vpImageSimulator::getImage(I, list, cam_distortion);
+    if (countDifferences(I, I_ref) > tolerance) {
+      throw vpException(vpException::fatalError, "List of planes with distortion failed");
+    }
+
+    std::cout << "Image simulator test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
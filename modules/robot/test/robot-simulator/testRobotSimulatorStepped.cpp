@@ -0,0 +1,298 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the stepped mode of the robot simulators.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testRobotSimulatorStepped.cpp
+
+  Test the vpRobotWireFrameSimulator::STEPPED mode of vpSimulatorAfma6 and
+  vpSimulatorViper850: the joints follow the integrated velocity, two runs
+  give the same trajectory, simulators stepped in parallel give the same
+  trajectories as when stepped one after the other, and the simulation
+  runs faster than real time.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/robot/vpRobotException.h>
+#include <visp3/robot/vpSimulatorAfma6.h>
+#include <visp3/robot/vpSimulatorViper850.h>
+#include <visp3/io/vpParseArgv.h>
+
+#if defined(VISP_HAVE_MODULE_GUI) && ((defined(_WIN32) && !defined(WINRT_8_0)) || defined(VISP_HAVE_PTHREAD))
+
+namespace {
+// Camera velocity applied at a given step, scaled by the gain of the run
+vpColVector cameraVelocity(unsigned int iter, double gain)
+{
+  vpColVector v(6);
+  v[0] = gain * 0.02 * sin(iter * 0.01);
+  v[1] = gain * 0.02 * cos(iter * 0.013);
+  v[2] = gain * 0.01;
+  v[3] = gain * vpMath::rad(2) * cos(iter * 0.007);
+  v[4] = gain * vpMath::rad(1);
+  v[5] = gain * vpMath::rad(3) * sin(iter * 0.011);
+  return v;
+}
+
+// Apply the velocity profile during nbIter sampling times and return the joint positions
+vpColVector run(vpSimulatorViper850 &robot, double gain, unsigned int nbIter)
+{
+  vpColVector q(6, 0);
+  q[1] = vpMath::rad(-70);
+  q[2] = vpMath::rad(135);
+  q[4] = vpMath::rad(45);
+  robot.setRobotState(vpRobot::STATE_POSITION_CONTROL);
+  robot.setPosition(vpRobot::ARTICULAR_FRAME, q);
+
+  robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+  for (unsigned int iter = 0; iter < nbIter; iter++) {
+    robot.setVelocity(vpRobot::CAMERA_FRAME, cameraVelocity(iter, gain));
+    robot.step();
+  }
+  robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+  return q;
+}
+
+class RunBody : public vpParallelLoopBody
+{
+public:
+  RunBody(std::vector<vpSimulatorViper850 *> &robots, std::vector<vpColVector> &q, unsigned int nbIter)
+    : m_robots(robots), m_q(q), m_nbIter(nbIter) {}
+
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++)
+      m_q[i] = run(*m_robots[i], 0.5 + 0.25 * i, m_nbIter);
+  }
+
+private:
+  std::vector<vpSimulatorViper850 *> &m_robots;
+  std::vector<vpColVector> &m_q;
+  unsigned int m_nbIter;
+};
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the robot simulators in stepped mode.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    // The joints follow the integrated articular velocity
+    {
+      vpSimulatorAfma6 robot(vpRobotWireFrameSimulator::STEPPED);
+      robot.setSamplingTime(0.01);
+      vpColVector q0(6, 0), qdot(6), q;
+      q0[2] = 0.2;
+      robot.setRobotState(vpRobot::STATE_POSITION_CONTROL);
+      robot.setPosition(vpRobot::ARTICULAR_FRAME, q0);
+      robot.getPosition(vpRobot::ARTICULAR_FRAME, q);
+      if ((q - q0).infinityNorm() >= 1e-12) {
+        throw vpException(vpException::fatalError, "Immediate positioning failed");
+      }
+
+      for (unsigned int i = 0; i < 6; i++)
+        qdot[i] = 0.01 * (i + 1) * (i % 2 ? -1 : 1);
+      robot.setRobotState(vpRobot::STATE_VELOCITY_CONTROL);
+      robot.setVelocity(vpRobot::ARTICULAR_FRAME, qdot);
+      robot.step(150);
+      double timestamp;
+      robot.getPosition(vpRobot::ARTICULAR_FRAME, q, timestamp);
+      if ((q - (q0 + 1.5 * qdot)).infinityNorm() >= 1e-9) {
+        throw vpException(vpException::fatalError, "Integrated velocity failed");
+      }
+      if (!(std::fabs(timestamp - 1.5) < 1e-9 && std::fabs(robot.getSimulationTime() - 1.5) < 1e-9)) {
+        throw vpException(vpException::fatalError, "Simulated time failed");
+      }
+    }
+
+    // The simulation is deterministic and faster than real time
+    const unsigned int nbIter = 500;
+    const double samplingTime = 0.01;
+    vpColVector q_first, q_second;
+    {
+      vpSimulatorViper850 robot(vpRobotWireFrameSimulator::STEPPED);
+      robot.setSamplingTime(samplingTime);
+      double t = vpTime::measureTimeMs();
+      q_first = run(robot, 1., nbIter);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Simulated " << nbIter * samplingTime << " s in " << t << " ms" << std::endl;
+      if (t >= 1000 * nbIter * samplingTime) {
+        throw vpException(vpException::fatalError, "Faster than real time failed");
+      }
+    }
+    {
+      vpSimulatorViper850 robot(vpRobotWireFrameSimulator::STEPPED);
+      robot.setSamplingTime(samplingTime);
+      q_second = run(robot, 1., nbIter);
+    }
+    if ((q_first - q_second).infinityNorm() != 0) {
+      throw vpException(vpException::fatalError, "Deterministic trajectory failed");
+    }
+
+    // Simulators stepped in parallel give the same result as stepped sequentially
+    const unsigned int nbRobots = 4;
+    std::vector<vpColVector> q_sequential(nbRobots), q_parallel(nbRobots);
+    std::vector<vpSimulatorViper850 *> robots(nbRobots);
+    for (unsigned int k = 0; k < 2; k++) {
+      for (unsigned int i = 0; i < nbRobots; i++) {
+        robots[i] = new vpSimulatorViper850(vpRobotWireFrameSimulator::STEPPED);
+        robots[i]->setSamplingTime(samplingTime);
+      }
+      if (k == 0)
+        RunBody(robots, q_sequential, nbIter)(0, nbRobots);
+      else
+        vpThreadPool::parallelFor(0, nbRobots, RunBody(robots, q_parallel, nbIter), nbRobots, 1);
+      for (unsigned int i = 0; i < nbRobots; i++)
+        delete robots[i];
+    }
+    bool same = true;
+    for (unsigned int i = 0; i < nbRobots; i++)
+      same &= ((q_sequential[i] - q_parallel[i]).infinityNorm() == 0);
+    if (!same) {
+      throw vpException(vpException::fatalError, "Parallel simulators failed");
+    }
+
+    // A real time simulator can not be stepped
+    {
+      vpSimulatorAfma6 robot(false);
+      bool thrown = false;
+      try {
+        robot.step();
+      }
+      catch(const vpRobotException &) {
+        thrown = true;
+      }
+      if (!thrown) {
+        throw vpException(vpException::fatalError, "Step in real time mode failed");
+      }
+    }
+
+    std::cout << "Stepped robot simulator test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
+
+#else
+int main()
+{
+  std::cout << "The robot simulators require the gui module and threading capabilities..." << std::endl;
+  return 0;
+}
+#endif
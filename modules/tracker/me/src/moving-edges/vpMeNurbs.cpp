@@ -56,14 +56,6 @@
 #include <stdlib.h>
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
-#ifdef VISP_HAVE_OPENCV
-#  if (VISP_HAVE_OPENCV_VERSION >= 0x020101) // Require opencv >= 2.1.1
-//#    include <opencv2/imgproc/imgproc.hpp>
-#    include <opencv2/imgproc/imgproc_c.h>
-#  else
-#    include <cv.h>
-#  endif
-#endif
 
 double computeDelta(double deltai, double deltaj);
 void findAngle(const vpImage<unsigned char> &I, const vpImagePoint &iP,
@@ -536,20 +528,12 @@ vpMeNurbs::seekExtremities(const vpImage<unsigned char> &I)
   The any vpMesite  are initialize at this points.
   
   This method is practicle when the edge is not smooth.
-  
-  \note To use the canny detection, OpenCV has to be installed.
 
   \param I : Image in which the edge appears.
 */
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
 void
 vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> &I)
-#else
-void
-vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
-#endif
 {
-#if (defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION < 0x030000))
   vpMeSite pt = list.front();
   vpImagePoint firstPoint(pt.ifloat,pt.jfloat);
   pt = list.back();
@@ -580,17 +564,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u > 0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-    
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-    
-    vpImageConvert::convert(dst, Isub);
-#endif
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -717,17 +691,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     if( u < 1.0)
       lastPtInSubIm = nurbs.computeCurvePoint(u);
     
-#if (VISP_HAVE_OPENCV_VERSION >= 0x020408)
     vpImageFilter::canny(Isub, Isub, 3, cannyTh1, 3);
-#else
-    IplImage* Ip = NULL;
-    vpImageConvert::convert(Isub, Ip);
-
-    IplImage* dst = cvCreateImage( cvSize((int)Isub.getWidth(), (int)Isub.getHeight()), 8, 1 );
-    cvCanny( Ip, dst, cannyTh1, cannyTh2, 3 );
-
-    vpImageConvert::convert(dst, Isub);
-#endif
     
     vpImagePoint firstBorder(-1,-1);
     
@@ -778,7 +742,7 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
         vpImagePoint iP(s.ifloat,s.jfloat);
         if (inRectangle(iP,rect))
         {
-          list.erase(list.end()) ;
+          list.pop_back();
 //          list.end();
         }
         else
@@ -834,9 +798,6 @@ vpMeNurbs::seekExtremitiesCanny(const vpImage<unsigned char> & /* I */)
     /* if (end != NULL) */ delete[] end;
     endPtFound = 0;
   }
-#else
-  vpTRACE("To use the canny detection, OpenCV has to be installed.");
-#endif
 }
 
 
@@ -189,8 +189,8 @@ private:
 
 private:
   unsigned int npt ;       //!< number of points used in calibration computation
-  std::list<double> LoX, LoY, LoZ  ;  //!< list of points coordinates (3D in meters)
-  std::list<vpImagePoint> Lip ; //!< list of points coordinates (2D in pixels)
+  std::vector<double> LoX, LoY, LoZ  ;  //!< list of points coordinates (3D in meters)
+  std::vector<vpImagePoint> Lip ; //!< list of points coordinates (2D in pixels)
 
   double residual ; //!< residual in pixel for camera model without distortion
   double residual_dist ;     //!< residual in pixel for perspective projection with distortion model
@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Nearest neighbor search of binary descriptors with multi-index hashing.
+ *
+ *****************************************************************************/
+
+#ifndef __vpHammingIndex_h__
+#define __vpHammingIndex_h__
+
+/*!
+  \file vpHammingIndex.h
+
+  \brief Nearest neighbor search of binary descriptors with multi-index hashing.
+*/
+
+#include <vector>
+#include <utility>
+
+#include <visp3/core/vpConfig.h>
+
+/*!
+  \class vpHammingIndex
+
+  \ingroup group_vision_keypoints
+
+  \brief Exact nearest neighbor search of binary descriptors (ORB, BRISK,
+  BRIEF, FREAK, AKAZE...) for the Hamming distance.
+
+  The descriptors are split into substrings of 16 bits, each substring being
+  indexed in its own hash table (multi-index hashing, M. Norouzi, A. Punjani
+  and D. J. Fleet, "Fast Exact Search in Hamming Space with Multi-Index Hashing",
+  PAMI 2014). If two descriptors split in \e m substrings differ by less than
+  \f$ m (r+1) \f$ bits, one of their substrings differs by at most \e r bits.
+  The tables are thus probed with increasing radius \e r around the substrings
+  of the query, until all the descriptors closer than the current k-th nearest
+  neighbor have been seen. The candidates are verified with a popcount of the
+  descriptors xor, vectorized with SSSE3 when available. When the probes would
+  cost more than a linear scan, for instance with small sets of descriptors,
+  the search falls back to a linear scan. The results are the same as the ones
+  of a brute-force search, ties being broken by the smallest index.
+
+  match() fuses the ratio test and the cross-check with the search: for the
+  ratio test, the search stops as soon as all the descriptors that could reject
+  the nearest neighbor have been seen, without looking for the exact second
+  nearest neighbor.
+
+  The queries are processed in parallel on the threads of vpThreadPool.
+
+  \code
+#include <visp3/vision/vpHammingIndex.h>
+
+int main()
+{
+  // 1000 ORB descriptors of 32 bytes
+  std::vector<unsigned char> train(1000 * 32), query(100 * 32);
+  // ... fill the descriptors
+  vpHammingIndex index;
+  index.build(&train[0], 1000, 32);
+
+  // Nearest neighbors passing the ratio test and the cross-check
+  std::vector<vpHammingIndex::Match> matches;
+  index.match(&query[0], 100, matches, 0.8, true);
+}
+  \endcode
+
+  vpKeyPoint uses this index with the "MultiIndexHashing" matcher.
+*/
+class VISP_EXPORT vpHammingIndex
+{
+public:
+  /*!
+    Match between a query descriptor and an indexed descriptor.
+  */
+  struct Match {
+    unsigned int queryIdx; //!< Index of the query descriptor.
+    unsigned int trainIdx; //!< Index of the indexed descriptor.
+    unsigned int distance; //!< Hamming distance between the two descriptors.
+  };
+
+  vpHammingIndex();
+
+  void build(const unsigned char *descriptors, unsigned int nbDescriptors, unsigned int descriptorSize);
+  void clear();
+
+  static unsigned int distance(const unsigned char *descriptor1, const unsigned char *descriptor2,
+                               unsigned int descriptorSize);
+
+  /*!
+    \return The size of the indexed descriptors in bytes.
+  */
+  inline unsigned int getDescriptorSize() const { return m_descriptorSize; }
+  /*!
+    \return The number of indexed descriptors.
+  */
+  inline unsigned int getNbDescriptors() const { return m_nbDescriptors; }
+  /*!
+    \return The number of hash tables, 0 if the descriptors are searched by a linear scan.
+  */
+  inline unsigned int getNbSubstrings() const { return m_nbSubstrings; }
+
+  void knnMatch(const unsigned char *queries, unsigned int nbQueries, unsigned int k,
+                std::vector<std::vector<Match> > &matches, unsigned int nbThreads = 0) const;
+  void match(const unsigned char *queries, unsigned int nbQueries, std::vector<Match> &matches,
+             double ratio = 1.0, bool crossCheck = false, unsigned int nbThreads = 0) const;
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  class SearchBody;
+
+  // Buffers of a thread searching the index
+  struct Workspace {
+    std::vector<unsigned char> query;
+    std::vector<unsigned int> stamps;
+    unsigned int stamp;
+    std::vector<std::pair<unsigned int, unsigned int> > best;
+  };
+
+  void initWorkspace(Workspace &workspace) const;
+  void linearSearch(const unsigned char *query, unsigned int k, Workspace &workspace) const;
+  void search(const unsigned char *query, unsigned int k, double ratio, Workspace &workspace) const;
+#endif
+
+  //! Size of the descriptors in bytes.
+  unsigned int m_descriptorSize;
+  //! Size of a row of m_descriptors, multiple of 16 bytes.
+  unsigned int m_stride;
+  //! Number of indexed descriptors.
+  unsigned int m_nbDescriptors;
+  //! Number of substrings of 16 bits, and of hash tables.
+  unsigned int m_nbSubstrings;
+  //! Descriptors padded with zeros to m_stride bytes.
+  std::vector<unsigned char> m_descriptors;
+  //! For each table, index in m_bucketEntries of the first descriptor of each of the 65536 buckets, and end index.
+  std::vector<unsigned int> m_bucketStarts;
+  //! For each table, indexes of the descriptors sorted by bucket.
+  std::vector<unsigned int> m_bucketEntries;
+  //! The 65536 masks of 16 bits sorted by number of bits set.
+  std::vector<unsigned short> m_radiusMasks;
+  //! Index in m_radiusMasks of the first mask with r bits set, for r in [0, 17].
+  std::vector<unsigned int> m_radiusOffsets;
+};
+
+#endif
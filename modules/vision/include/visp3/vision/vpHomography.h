@@ -309,7 +309,11 @@ class VISP_EXPORT vpHomography : public vpArray2D<double>
                        double &residual,
                        unsigned int nbInliersConsensus,
                        double threshold,
-                       bool normalization=true);
+                       bool normalization=true,
+                       int maxTrials=1000,
+                       double probability=0.99,
+                       double timeBudget=0,
+                       unsigned int nbThreads=0);
 
     static vpImagePoint project(const vpCameraParameters &cam, const vpHomography &bHa, const vpImagePoint &iPa);
     static vpPoint project(const vpHomography &bHa, const vpPoint &Pa);
@@ -49,7 +49,9 @@
 
 #include <visp3/core/vpConfig.h>
 #include <visp3/vision/vpBasicKeyPoint.h>
+#include <visp3/vision/vpHammingIndex.h>
 #include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpMemoryMappedFile.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpPlane.h>
@@ -522,6 +524,19 @@ public:
     return m_imageFormat;
   }
 
+  /*!
+    Get the pose that guides the matching of the next call to matchPoint() with a pose,
+    see setUseGuidedMatching().
+
+    \param cMo : Pose estimated in the previous frame.
+    \return True if the pose has been estimated in the previous frame, false if the next
+    query keypoints will be matched to the whole training set.
+  */
+  inline bool getGuidedMatchingPose(vpHomogeneousMatrix &cMo) const {
+    cMo = m_guidedMatchingPose;
+    return m_guidedMatchingPoseValid;
+  }
+
   /*!
     Get the elapsed time to compute the matching.
 
@@ -570,7 +585,7 @@ public:
     \return The number of train images.
   */
   inline unsigned int getNbImages() const {
-    return static_cast<unsigned int>(m_mapOfImages.size());
+    return static_cast<unsigned int>(m_mapOfImages.size() + m_mapOfImagePaths.size());
   }
 
   void getObjectPoints(std::vector<cv::Point3f> &objectPoints) const;
@@ -619,6 +634,9 @@ public:
      Get the train descriptors matrix.
 
      \return : Matrix with descriptors values at each row for each train keypoints (or reference keypoints).
+     When the learning data have been loaded from a memory mapped binary file, the matrix refers to the
+     mapped file and stays valid until reset(), the next loading of a memory mapped file without append or
+     the next saveLearningData() in the memory mapped format, which copies the descriptors.
    */
   inline cv::Mat getTrainDescriptors() const {
     return m_trainDescriptors;
@@ -636,6 +654,17 @@ public:
                            vpImage<unsigned char> &IMatching);
   void insertImageMatching(const vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching);
 
+  /*!
+    Get if the matches of the last call to matchPoint() with a pose come from the guided
+    matching, see setUseGuidedMatching().
+
+    \return True if the pose has been computed from the guided matching, false if the query
+    keypoints have been matched to the whole training set.
+  */
+  inline bool isGuidedMatchingUsed() const {
+    return m_guidedMatchingUsed;
+  }
+
 #ifdef VISP_HAVE_XML2
   void loadConfigFile(const std::string &configFile);
 #endif
@@ -667,7 +696,8 @@ public:
 
   void reset();
 
-  void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true);
+  void saveLearningData(const std::string &filename, const bool binaryMode=false, const bool saveTrainingImages=true,
+                        const bool mappedMode=false);
 
   /*!
     Set if the covariance matrix has to be computed in the Virtual Visual Servoing approach.
@@ -796,6 +826,21 @@ public:
     initExtractors(m_extractorNames);
   }
 
+  /*!
+    Set the radius of the guided matching: a query keypoint is only matched to the
+    train keypoints whose 3D point projects, with the previous pose, closer than
+    this radius.
+
+    \param radius : Search radius in pixels
+  */
+  inline void setGuidedMatchingRadius(const double radius) {
+    if(radius > 0.0) {
+      m_guidedMatchingRadius = radius;
+    } else {
+      throw vpException(vpException::badValue, "The guided matching radius must be positive.");
+    }
+  }
+
   /*!
     Set the image format to use when saving training images.
 
@@ -813,10 +858,15 @@ public:
        - BruteForce-Hamming
        - BruteForce-Hamming(2)
        - FlannBased
+       - MultiIndexHashing (Hamming distance, uses a vpHammingIndex of the train descriptors)
 
      L1 and L2 norms are preferable choices for SIFT and SURF descriptors, NORM_HAMMING should be used with ORB,
      BRISK and BRIEF, NORM_HAMMING2 should be used with ORB when WTA_K==3 or 4.
 
+     MultiIndexHashing finds the same nearest neighbors as BruteForce-Hamming (up to ties) with large sets of
+     binary descriptors at a fraction of the cost, and does the ratio test of the
+     ratioDistanceThreshold filter during the search. It must be set before building the reference.
+
      \param matcherName : Name of the matcher.
    */
   inline void setMatcher(const std::string &matcherName) {
@@ -962,6 +1012,21 @@ public:
     m_useAffineDetection = useAffine;
   }
 
+  /*!
+    Set if, when matching with multiple affine transformations, only the tilts
+    around the one that gave the most matches in the previous frame must be
+    simulated. This reduces the number of simulated views when the viewpoint
+    changes slowly between two frames. All the tilts are used for the reference,
+    for the first frame and after a frame without any match.
+
+    The class_id of the query keypoints is set to the tilt level of their view.
+
+    \param useRestriction : True to restrict the tilts, false to use all of them
+  */
+  inline void setUseAffineTiltRestriction(const bool useRestriction) {
+    m_useAffineTiltRestriction = useRestriction;
+  }
+
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   /*!
     Set if cross check method must be used to eliminate some false matches with a brute-force matching method.
@@ -979,6 +1044,22 @@ public:
   }
 #endif
 
+  /*!
+    Set if the guided matching must be used by matchPoint() when the pose is computed.
+
+    The train keypoints with a 3D point are projected with the pose estimated in the
+    previous frame, and each query keypoint is only compared to the train keypoints
+    projected within setGuidedMatchingRadius() in a grid of the image, instead of the
+    whole training set. This turns the detection into a cheap tracking step. When
+    the pose can not be estimated from these matches, or for the first frame, the
+    query keypoints are matched to the whole training set.
+
+    \param useGuidedMatching : True to use the guided matching
+   */
+  inline void setUseGuidedMatching(const bool useGuidedMatching) {
+    m_useGuidedMatching = useGuidedMatching;
+  }
+
   /*!
     Set if we want to match the train keypoints to the query keypoints.
 
@@ -1017,6 +1098,8 @@ public:
   }
 
 private:
+  //! Tilt level of the affine views that gave the most matches in the previous frame (0 if none).
+  int m_affineTiltLevel;
   //! If true, compute covariance matrix if the user select the pose estimation method using ViSP
   bool m_computeCovariance;
   //! Covariance matrix
@@ -1047,16 +1130,30 @@ private:
   std::vector<cv::DMatch> m_filteredMatches;
   //! Chosen method of filtering to eliminate false matching.
   vpFilterMatchingType m_filterType;
+  //! Pose estimated in the previous frame, used by the guided matching.
+  vpHomogeneousMatrix m_guidedMatchingPose;
+  //! True if m_guidedMatchingPose has been estimated in the previous frame.
+  bool m_guidedMatchingPoseValid;
+  //! Search radius in pixels of the guided matching.
+  double m_guidedMatchingRadius;
+  //! True if the matches of the last matchPoint() with a pose come from the guided matching.
+  bool m_guidedMatchingUsed;
+  //! Index of the binary train descriptors used by the MultiIndexHashing matcher.
+  vpHammingIndex m_hammingIndex;
   //! Image format to use when saving the training images
   vpImageFormatType m_imageFormat;
   //! List of k-nearest neighbors for each detected keypoints (if the method chosen is based upon on knn).
   std::vector<std::vector<cv::DMatch> > m_knnMatches;
+  //! Memory mapped learning data files whose descriptors are used in place by m_trainDescriptors.
+  std::vector<cv::Ptr<vpMemoryMappedFile> > m_learningDataFiles;
   //! Map descriptor enum type to string.
   std::map<vpFeatureDescriptorType, std::string> m_mapOfDescriptorNames;
   //! Map detector enum type to string.
   std::map<vpFeatureDetectorType, std::string> m_mapOfDetectorNames;
   //! Map of image id to know to which training image is related a training keypoints.
   std::map<int, int> m_mapOfImageId;
+  //! Map of image id to the path of the training images not loaded yet, see loadTrainingImages().
+  std::map<int, std::string> m_mapOfImagePaths;
   //! Map of images to have access to the image buffer according to his image id.
   std::map<int, vpImage<unsigned char> > m_mapOfImages;
   //! Smart reference-counting pointer (similar to shared_ptr in Boost) of descriptor matcher (e.g. BruteForce or FlannBased).
@@ -1109,6 +1206,8 @@ private:
   std::vector<vpPoint> m_trainVpPoints;
   //! If true, use multiple affine transformations to cober the 6 affine parameters
   bool m_useAffineDetection;
+  //! If true, only the tilts around the best one of the previous frame are simulated when matching
+  bool m_useAffineTiltRestriction;
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   //! If true, some false matches will be eliminate by keeping only pairs (i,j) such that for i-th
   //! query descriptor the j-th descriptor in the matcher’s collection is the nearest and vice versa.
@@ -1116,6 +1215,8 @@ private:
 #endif
   //! Flag set if a percentage value is used to determine the number of inliers for the Ransac method.
   bool m_useConsensusPercentage;
+  //! If true, match the keypoints close to the projection of the train points with the previous pose.
+  bool m_useGuidedMatching;
   //! Flag set if a knn matching method must be used.
   bool m_useKnn;
   //! Flag set if we want to match the train keypoints to the query keypoints, useful when there is only one train image
@@ -1128,11 +1229,19 @@ private:
   bool m_useSingleMatchFilter;
 
 
-  void affineSkew(double tilt, double phi, cv::Mat& img, cv::Mat& mask, cv::Mat& Ai);
+  class AffineViewBody;
+
+  void affineSkew(double tilt, double phi, const cv::Mat& img, cv::Mat& timg, cv::Mat& mask, cv::Mat& Ai);
 
   double computePoseEstimationError(const std::vector<std::pair<cv::KeyPoint, cv::Point3f> > &matchKeyPoints,
                                     const vpCameraParameters &cam, const vpHomogeneousMatrix &cMo_est);
 
+  void detectExtractAffine(const vpImage<unsigned char> &I, const int minTiltLevel, const int maxTiltLevel,
+                           std::vector<std::vector<cv::KeyPoint> >& listOfKeypoints, std::vector<cv::Mat>& listOfDescriptors,
+                           std::vector<int> &listOfTiltLevels, std::vector<vpImage<unsigned char> > *listOfAffineI=NULL);
+
+  void detectExtractAffineQuery(const vpImage<unsigned char> &I);
+
   void filterMatches();
 
   void init();
@@ -1142,8 +1251,24 @@ private:
   void initExtractor(const std::string &extractorName);
   void initExtractors(const std::vector<std::string> &extractorNames);
 
+  bool filterMatchesAndComputePose(const vpCameraParameters &cam, vpHomogeneousMatrix &cMo, double &error,
+                                   double &elapsedTime, bool (*func)(vpHomogeneousMatrix *));
+
+  void guidedMatch(const vpCameraParameters &cam, const unsigned int height, const unsigned int width,
+                   std::vector<cv::DMatch> &matches, double &elapsedTime);
+
   void initFeatureNames();
 
+  void loadMappedLearningData(const std::string &filename, const std::string &parent, const int startClassId,
+                              const int startImageId, const bool append);
+  void loadTrainingImages();
+
+  void matchHammingIndex(const cv::Mat &queryDescriptors, std::vector<cv::DMatch> &matches);
+
+  void trainMatcher();
+
+  void updateAffineTiltLevel();
+
   inline size_t myKeypointHash(const cv::KeyPoint &kp) {
     size_t _Val = 2166136261U, scale = 16777619U;
     Cv32suf u;
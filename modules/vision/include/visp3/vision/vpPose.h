@@ -51,6 +51,7 @@
 #include <visp3/core/vpHomogeneousMatrix.h>
 #include <visp3/vision/vpHomography.h>
 #include <visp3/core/vpPoint.h>
+#include <visp3/core/vpRansacScheduler.h>
 #include <visp3/core/vpRGBa.h>
 #ifdef VISP_BUILD_DEPRECATED_FUNCTIONS
 #  include <visp3/core/vpList.h>
@@ -87,7 +88,9 @@ public:
       DEMENTHON_LOWE   , /*!< Non linear Lowe aproach initialized by Dementhon approach */
       VIRTUAL_VS       , /*!< Non linear virtual visual servoing approach that needs an initialization from Lagrange or Dementhon aproach */
       DEMENTHON_VIRTUAL_VS, /*!< Non linear virtual visual servoing approach initialized by Dementhon approach */
-      LAGRANGE_VIRTUAL_VS   /*!< Non linear virtual visual servoing approach initialized by Lagrange approach */
+      LAGRANGE_VIRTUAL_VS, /*!< Non linear virtual visual servoing approach initialized by Lagrange approach */
+      P3P              , /*!< Minimal three points approach, the other points are used to select the solution (doesn't need an initialization) */
+      EPNP               /*!< Linear EPnP approach for non coplanar points (doesn't need an initialization) */
     } vpPoseMethodType;
 
   enum FILTERING_RANSAC_FLAGS {
@@ -124,25 +127,57 @@ private:
   std::vector<vpPoint> listOfPoints;
   bool useParallelRansac;
   int nbParallelRansacThreads;
+  double ransacProbability;
+  double ransacTimeBudget;
+  bool useRansacSprt;
 
+  //Coordinates of the points stored contiguously (one array per coordinate)
+  //to evaluate the reprojection errors with a vectorized kernel
+  struct PointArray {
+    PointArray() : oX(), oY(), oZ(), x(), y() {}
+
+    void clear() {
+      oX.clear(); oY.clear(); oZ.clear(); x.clear(); y.clear();
+    }
+
+    void push_back(const vpPoint &pt) {
+      oX.push_back(pt.get_oX()); oY.push_back(pt.get_oY()); oZ.push_back(pt.get_oZ());
+      x.push_back(pt.get_x()); y.push_back(pt.get_y());
+    }
+
+    void reserve(const size_t n) {
+      oX.reserve(n); oY.reserve(n); oZ.reserve(n); x.reserve(n); y.reserve(n);
+    }
+
+    size_t size() const {
+      return x.size();
+    }
+
+    std::vector<double> oX, oY, oZ; //Coordinates in the object frame
+    std::vector<double> x, y;       //Normalized coordinates in the image plane
+  };
+  //Contiguous coordinates of the points of listP, resynchronized by computeResidual() when the
+  //size of listP has changed
+  mutable PointArray pointArray;
 
   //For parallel RANSAC
   class RansacFunctor {
   public:
-    RansacFunctor(const vpHomogeneousMatrix &cMo_,
-                  const unsigned int ransacNbInlierConsensus_, const int ransacMaxTrials_,
+    RansacFunctor(const vpHomogeneousMatrix &cMo_, vpRansacScheduler &scheduler_,
                   const double ransacThreshold_, const unsigned int initial_seed_,
                   const bool checkDegeneratePoints_, const std::vector<vpPoint> &listOfUniquePoints_,
+                  const PointArray &uniquePointArray_, const PointArray *shuffledPointArray_,
                   bool (*func_)(vpHomogeneousMatrix *)) :
       m_best_consensus(), m_checkDegeneratePoints(checkDegeneratePoints_), m_cMo(cMo_), m_foundSolution(false),
-      m_func(func_), m_initial_seed(initial_seed_), m_listOfUniquePoints(listOfUniquePoints_), m_nbInliers(0),
-      m_ransacMaxTrials(ransacMaxTrials_), m_ransacNbInlierConsensus(ransacNbInlierConsensus_), m_ransacThreshold(ransacThreshold_) {
+      m_func(func_), m_initial_seed(initial_seed_), m_listOfUniquePoints(&listOfUniquePoints_), m_nbInliers(0),
+      m_ransacThreshold(ransacThreshold_), m_scheduler(&scheduler_), m_shuffledPointArray(shuffledPointArray_),
+      m_sprtDelta(0.01), m_sprtErrors(), m_uniquePointArray(&uniquePointArray_) {
     }
 
     RansacFunctor() :
       m_best_consensus(),m_checkDegeneratePoints(false), m_cMo(), m_foundSolution(false), m_func(NULL),
-      m_initial_seed(0), m_listOfUniquePoints(), m_nbInliers(0), m_ransacMaxTrials(), m_ransacNbInlierConsensus(),
-      m_ransacThreshold() {
+      m_initial_seed(0), m_listOfUniquePoints(NULL), m_nbInliers(0), m_ransacThreshold(), m_scheduler(NULL),
+      m_shuffledPointArray(NULL), m_sprtDelta(0.01), m_sprtErrors(), m_uniquePointArray(NULL) {
     }
 
     void operator()() {
@@ -173,18 +208,31 @@ private:
     bool m_foundSolution;
     bool (*m_func)(vpHomogeneousMatrix *);
     unsigned int m_initial_seed;
-    std::vector<vpPoint> m_listOfUniquePoints;
+    //Points are shared between the threads, not copied
+    const std::vector<vpPoint> *m_listOfUniquePoints;
     unsigned int m_nbInliers;
-    int m_ransacMaxTrials;
-    unsigned int m_ransacNbInlierConsensus;
     double m_ransacThreshold;
+    //Trial counter and best consensus size shared by the RANSAC workers
+    vpRansacScheduler *m_scheduler;
+    //Same points in a random order for the sequential probability ratio test, NULL if not used
+    const PointArray *m_shuffledPointArray;
+    //Estimated probability that a point is consistent with a bad model
+    double m_sprtDelta;
+    std::vector<double> m_sprtErrors;
+    const PointArray *m_uniquePointArray;
 
     bool poseRansacImpl();
+    bool sprtTest(const vpHomogeneousMatrix &cMo, const unsigned int bestNbInliers);
   };
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-  static vpThread::Return poseRansacImplThread(vpThread::Args arg);
-#endif
+  class RansacBody;
+
+  static double computeSquaredErrors(const vpHomogeneousMatrix &cMo, const PointArray &points,
+                                     const size_t start, const size_t end, double *errors);
+  static unsigned int computeConsensus(const vpHomogeneousMatrix &cMo, const PointArray &points,
+                                       const std::vector<vpPoint> &listOfPoints_, const double threshold,
+                                       const bool checkDegeneratePoints, std::vector<double> &errors,
+                                       std::vector<unsigned int> &consensus);
 
 
 protected:
@@ -212,9 +260,11 @@ public:
   void init() ;
   void poseDementhonPlan(vpHomogeneousMatrix &cMo) ;
   void poseDementhonNonPlan(vpHomogeneousMatrix &cMo) ;
+  void poseEPnP(vpHomogeneousMatrix &cMo) ;
   void poseLagrangePlan(vpHomogeneousMatrix &cMo, const int coplanar_plane_type=0) ;
   void poseLagrangeNonPlan(vpHomogeneousMatrix &cMo) ;
   void poseLowe(vpHomogeneousMatrix & cMo) ;
+  void poseP3P(vpHomogeneousMatrix &cMo) ;
   bool poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMatrix *)=NULL) ;
   void poseVirtualVSrobust(vpHomogeneousMatrix & cMo) ;
   void poseVirtualVS(vpHomogeneousMatrix & cMo) ;
@@ -232,7 +282,40 @@ public:
       throw vpException(vpException::badValue, "The Ransac threshold must be positive as we deal with distance.");
     }
   }
+  /*!
+    Set the maximum number of RANSAC trials. By default all of them are run,
+    unless a consensus set of setRansacNbInliersToReachConsensus() points is
+    found. With setRansacProbability() lower than 1 or setRansacTimeBudget(),
+    the sampling may stop before this number of trials.
+
+    \param rM : Maximum number of trials (default 1000).
+  */
   void setRansacMaxTrials(const int &rM){ ransacMaxTrials = rM; }
+
+  /*!
+    Set the probability that at least one of the RANSAC samples is free from
+    outliers. With a probability lower than 1 (typically 0.99), each time a
+    larger consensus set is found the number of trials is lowered to the one
+    given by computeRansacIterations() for the current inlier ratio. With 1, the
+    default, setRansacMaxTrials() trials are run unless the consensus is reached.
+
+    \param p : Probability in ]0, 1] (default 1).
+  */
+  void setRansacProbability(const double &p) {
+    if (p > 0 && p <= 1) {
+      ransacProbability = p;
+    } else {
+      throw vpException(vpException::badValue, "The Ransac probability must be in ]0, 1].");
+    }
+  }
+
+  /*!
+    Set the maximum duration of the RANSAC sampling. Once elapsed, the best
+    consensus set found so far is used to compute the pose.
+
+    \param ms : Time budget in ms, or a value less or equal to 0 for no limit (default).
+  */
+  void setRansacTimeBudget(const double &ms) { ransacTimeBudget = ms; }
   unsigned int getRansacNbInliers() const { return (unsigned int) ransacInliers.size(); }
   std::vector<unsigned int> getRansacInlierIndex() const{ return ransacInlierIndex; }
   std::vector<vpPoint> getRansacInliers() const{ return ransacInliers; }
@@ -281,7 +364,7 @@ public:
     Set the number of threads for the parallel RANSAC implementation.
 
     \note You have to enable the parallel version with setUseParallelRansac().
-    If the number of threads is 0, the number of threads to use is automatically determined with OpenMP.
+    If the number of threads is 0, vpThreadPool::getConcurrency() threads are used.
     \sa setUseParallelRansac
   */
   inline void setNbParallelRansacThreads(const int nb) {
@@ -298,14 +381,40 @@ public:
   }
 
   /*!
-    Set if parallel RANSAC version should be used or not.
+    Set if parallel RANSAC version should be used or not. The RANSAC workers
+    run on the threads of vpThreadPool.
 
-    \note Need Pthread.
+    \note Need Pthread or the Windows threads, otherwise the workers are run
+    one after the other by the calling thread.
   */
   inline void setUseParallelRansac(const bool use) {
     useParallelRansac = use;
   }
 
+  /*!
+    \return True if the RANSAC hypotheses are evaluated with a sequential probability ratio test.
+
+    \sa setUseRansacSprt
+  */
+  inline bool getUseRansacSprt() const {
+    return useRansacSprt;
+  }
+
+  /*!
+    Set if the RANSAC hypotheses should be evaluated with a sequential
+    probability ratio test (Wald's SPRT, \cite Chum08). The points are visited
+    in a random order and a hypothesis is dropped as soon as the likelihood that
+    it is a bad model exceeds a decision threshold, or when it can no longer
+    beat the best consensus set. Only the hypotheses that pass the test are
+    evaluated on all the points. Disabled by default.
+
+    The decision threshold is computed assuming that the P3P solver costs as
+    much as the evaluation of 200 points and gives 2 hypotheses per sample.
+  */
+  inline void setUseRansacSprt(const bool use) {
+    useRansacSprt = use;
+  }
+
   /*!
     Get the vector of points.
 
@@ -327,6 +436,9 @@ public:
                                   double lx, vpCameraParameters & cam,
                                   vpHomogeneousMatrix & cMo) ;
 
+  static unsigned int poseP3P(const vpPoint &P1, const vpPoint &P2, const vpPoint &P3,
+                              std::vector<vpHomogeneousMatrix> &cMo_solutions);
+
   static int computeRansacIterations(double probability, double epsilon,
                                      const int sampleSize=4, int maxIterations=2000);
                      
@@ -171,10 +171,10 @@ void vpCalibration::computePose(const vpCameraParameters &camera, vpHomogeneousM
   //  the list of point is cleared (if that's not done before)
   pose.clearPoint() ;
   // we set the 3D points coordinates (in meter !) in the object/world frame
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   for (unsigned int i =0 ; i < npt ; i++)
   {
@@ -228,10 +228,10 @@ double vpCalibration::computeStdDeviation(const vpHomogeneousMatrix& cMo_est,
 {
   double residual_ = 0 ;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   double u0 = camera.get_u0() ;
   double v0 = camera.get_v0() ;
@@ -281,10 +281,10 @@ double vpCalibration::computeStdDeviation_dist(const vpHomogeneousMatrix& cMo_es
 {
   double residual_ = 0 ;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   double u0 = camera.get_u0() ;
   double v0 = camera.get_v0() ;
@@ -447,6 +447,10 @@ int vpCalibration::computeCalibration(vpCalibrationMethodType method,
 /*!
   Compute the multi-images calibration according to the desired method using many poses.
 
+  The virtual visual servoing methods estimate the intrinsic parameters and
+  the pose of each image at the same time. The cost of an iteration is linear
+  in the number of images, which are processed in parallel with vpThreadPool.
+
   \param method : Method used to estimate the camera parameters.
   \param table_cal : Vector of vpCalibration.
   \param cam_est : Estimated intrinsic camera parameters.
@@ -601,10 +605,10 @@ int vpCalibration::writeData(const char *filename)
   std::ofstream f(filename) ;
   vpImagePoint ip;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   f.precision(10);
   f.setf(std::ios::fixed,std::ios::floatfield);
@@ -746,7 +750,7 @@ int vpCalibration::displayData(vpImage<unsigned char> &I, vpColor color,
                                unsigned int thickness, int subsampling_factor)
 {
 
-  for (std::list<vpImagePoint>::const_iterator it = Lip.begin(); it != Lip.end(); ++ it) {
+  for (std::vector<vpImagePoint>::const_iterator it = Lip.begin(); it != Lip.end(); ++ it) {
     vpImagePoint ip = *it;
     if (subsampling_factor > 1.) {
       ip.set_u( ip.get_u() / subsampling_factor);
@@ -782,9 +786,9 @@ int vpCalibration::displayGrid(vpImage<unsigned char> &I, vpColor color,
   //   double px = cam.get_px() ;
   //   double py = cam.get_py() ;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
 
   for (unsigned int i =0 ; i < npt ; i++)
   {
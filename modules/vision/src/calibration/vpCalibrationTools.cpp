@@ -41,11 +41,306 @@
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpPixelMeterConversion.h>
 
+#include <visp3/core/vpThreadPool.h>
+
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
 
 #undef MAX
 #undef MIN
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+/*
+  Virtual visual servoing on several images of a calibration grid.
+
+  The pose of an image only acts on the residuals of its own points, so that the
+  interaction matrix L = [A | B] stacked over all the images has one block A_p of 6
+  columns per image and the columns B of the intrinsic parameters. The normal
+  equations L^T L e = L^T error are reduced on the intrinsic parameters with the
+  Schur complement of the pose blocks:
+    S = sum_p (V_p - W_p^T U_p^-1 W_p),   t = sum_p (h_p - W_p^T U_p^-1 g_p)
+  with U_p = A_p^T A_p, W_p = A_p^T B_p, V_p = B_p^T B_p, g_p = A_p^T error_p and
+  h_p = B_p^T error_p. The update of the intrinsic parameters is S^+ t and the update
+  of each pose U_p^-1 (g_p - W_p S^+ t). This is the least-squares solution given by
+  the pseudo-inverse of L, but the cost is linear in the number of images instead of
+  cubic.
+*/
+
+// Points and pose of an image, and its reduced normal equations
+struct vpCalibrationImage
+{
+  vpCalibrationImage()
+    : oX(NULL), oY(NULL), oZ(NULL), ip(NULL), npt(0), cMo(), UiW(), Uig(), S(), t(), residual(0) {}
+
+  // Contiguous coordinates of the points
+  const double *oX, *oY, *oZ;
+  const vpImagePoint *ip;
+  unsigned int npt;
+  vpHomogeneousMatrix cMo;
+
+  vpMatrix UiW; // U_p^-1 W_p
+  vpColVector Uig; // U_p^-1 g_p
+  vpMatrix S; // V_p - W_p^T U_p^-1 W_p
+  vpColVector t; // h_p - W_p^T U_p^-1 g_p
+  double residual;
+};
+
+/*
+  Rows of the interaction matrix of a point and the corresponding errors, without distortion:
+  2 rows, intrinsic parameters (u0, v0, px, py).
+*/
+unsigned int interactionRows(const vpCameraParameters &cam, double X, double Y, double inv_z,
+                             double up, double vp, double a[4][6], double b[4][6], double error[4])
+{
+  double px = cam.get_px(), py = cam.get_py(), u0 = cam.get_u0(), v0 = cam.get_v0();
+
+  error[0] = X * px + u0 - up;
+  error[1] = Y * py + v0 - vp;
+
+  a[0][0] = px * (-inv_z);
+  a[0][1] = 0;
+  a[0][2] = px * (X * inv_z);
+  a[0][3] = px * X * Y;
+  a[0][4] = -px * (1 + X * X);
+  a[0][5] = px * Y;
+  b[0][0] = 1;
+  b[0][1] = 0;
+  b[0][2] = X;
+  b[0][3] = 0;
+
+  a[1][0] = 0;
+  a[1][1] = py * (-inv_z);
+  a[1][2] = py * (Y * inv_z);
+  a[1][3] = py * (1 + Y * Y);
+  a[1][4] = -py * X * Y;
+  a[1][5] = -py * X;
+  b[1][0] = 0;
+  b[1][1] = 1;
+  b[1][2] = 0;
+  b[1][3] = Y;
+  return 2;
+}
+
+/*
+  Rows of the interaction matrix of a point and the corresponding errors, with distortion:
+  2 rows for the distorted to undistorted model and 2 rows for the undistorted to distorted
+  model, intrinsic parameters (u0, v0, px, py, kdu, kud).
+*/
+unsigned int interactionRowsWithDistortion(const vpCameraParameters &cam, double X, double Y, double inv_z,
+                                           double up, double vp, double a[4][6], double b[4][6], double error[4])
+{
+  double px = cam.get_px(), py = cam.get_py(), u0 = cam.get_u0(), v0 = cam.get_v0();
+  double inv_px = 1 / px, inv_py = 1 / py;
+  double kud = cam.get_kud(), kdu = cam.get_kdu();
+  double k2ud = 2 * kud, k2du = 2 * kdu;
+
+  double X2 = X * X;
+  double Y2 = Y * Y;
+  double XY = X * Y;
+
+  double up0 = up - u0;
+  double vp0 = vp - v0;
+
+  double xp0 = up0 * inv_px;
+  double xp02 = xp0 * xp0;
+
+  double yp0 = vp0 * inv_py;
+  double yp02 = yp0 * yp0;
+
+  double r2du = xp02 + yp02;
+  double kr2du = kdu * r2du;
+
+  double r2ud = X2 + Y2;
+  double kr2ud = 1 + kud * r2ud;
+
+  double Axx = px * (kr2ud + k2ud * X2);
+  double Axy = px * k2ud * XY;
+  double Ayy = py * (kr2ud + k2ud * Y2);
+  double Ayx = py * k2ud * XY;
+
+  error[0] = u0 + px * X - kr2du * up0 - up;
+  error[1] = v0 + py * Y - kr2du * vp0 - vp;
+  error[2] = u0 + px * X * kr2ud - up;
+  error[3] = v0 + py * Y * kr2ud - vp;
+
+  //--distorted to undistorted
+  a[0][0] = px * (-inv_z);
+  a[0][1] = 0;
+  a[0][2] = px * X * inv_z;
+  a[0][3] = px * X * Y;
+  a[0][4] = -px * (1 + X2);
+  a[0][5] = px * Y;
+  b[0][0] = 1 + kr2du + k2du * xp02;
+  b[0][1] = k2du * up0 * yp0 * inv_py;
+  b[0][2] = X + k2du * xp02 * xp0;
+  b[0][3] = k2du * up0 * yp02 * inv_py;
+  b[0][4] = -up0 * r2du;
+  b[0][5] = 0;
+
+  a[1][0] = 0;
+  a[1][1] = py * (-inv_z);
+  a[1][2] = py * Y * inv_z;
+  a[1][3] = py * (1 + Y2);
+  a[1][4] = -py * XY;
+  a[1][5] = -py * X;
+  b[1][0] = k2du * xp0 * vp0 * inv_px;
+  b[1][1] = 1 + kr2du + k2du * yp02;
+  b[1][2] = k2du * vp0 * xp02 * inv_px;
+  b[1][3] = Y + k2du * yp02 * yp0;
+  b[1][4] = -vp0 * r2du;
+  b[1][5] = 0;
+
+  //---undistorted to distorted
+  a[2][0] = Axx * (-inv_z);
+  a[2][1] = Axy * (-inv_z);
+  a[2][2] = Axx * (X * inv_z) + Axy * (Y * inv_z);
+  a[2][3] = Axx * X * Y + Axy * (1 + Y2);
+  a[2][4] = -Axx * (1 + X2) - Axy * XY;
+  a[2][5] = Axx * Y - Axy * X;
+  b[2][0] = 1;
+  b[2][1] = 0;
+  b[2][2] = X * kr2ud;
+  b[2][3] = 0;
+  b[2][4] = 0;
+  b[2][5] = px * X * r2ud;
+
+  a[3][0] = Ayx * (-inv_z);
+  a[3][1] = Ayy * (-inv_z);
+  a[3][2] = Ayx * (X * inv_z) + Ayy * (Y * inv_z);
+  a[3][3] = Ayx * XY + Ayy * (1 + Y2);
+  a[3][4] = -Ayx * (1 + X2) - Ayy * XY;
+  a[3][5] = Ayx * Y - Ayy * X;
+  b[3][0] = 0;
+  b[3][1] = 1;
+  b[3][2] = 0;
+  b[3][3] = Y * kr2ud;
+  b[3][4] = 0;
+  b[3][5] = py * Y * r2ud;
+  return 4;
+}
+
+// Residual and reduced normal equations of each image
+class vpCalibrationVVSBody : public vpParallelLoopBody
+{
+public:
+  vpCalibrationVVSBody(std::vector<vpCalibrationImage> &images, const vpCameraParameters &cam, bool distortion)
+    : m_images(images), m_cam(cam), m_distortion(distortion) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    const unsigned int k = m_distortion ? 6 : 4;
+    for (unsigned int p = start; p < end; p++) {
+      vpCalibrationImage &image = m_images[p];
+      const vpHomogeneousMatrix &cMo = image.cMo;
+      vpMatrix U(6, 6), W(6, k), V(k, k);
+      vpColVector g(6), h(k);
+      double r = 0;
+
+      for (unsigned int i = 0; i < image.npt; i++) {
+        double oX = image.oX[i], oY = image.oY[i], oZ = image.oZ[i];
+        double x = oX * cMo[0][0] + oY * cMo[0][1] + oZ * cMo[0][2] + cMo[0][3];
+        double y = oX * cMo[1][0] + oY * cMo[1][1] + oZ * cMo[1][2] + cMo[1][3];
+        double z = oX * cMo[2][0] + oY * cMo[2][1] + oZ * cMo[2][2] + cMo[2][3];
+        double inv_z = 1 / z;
+
+        double a[4][6], b[4][6], error[4];
+        unsigned int nbRows;
+        if (m_distortion) {
+          nbRows = interactionRowsWithDistortion(m_cam, x * inv_z, y * inv_z, inv_z, image.ip[i].get_u(),
+                                                 image.ip[i].get_v(), a, b, error);
+        } else {
+          nbRows = interactionRows(m_cam, x * inv_z, y * inv_z, inv_z, image.ip[i].get_u(), image.ip[i].get_v(),
+                                   a, b, error);
+        }
+
+        double r_point = 0;
+        for (unsigned int row = 0; row < nbRows; row++) {
+          const double *ar = a[row], *br = b[row];
+          for (unsigned int m = 0; m < 6; m++) {
+            double *U_m = U[m], *W_m = W[m];
+            for (unsigned int n = m; n < 6; n++)
+              U_m[n] += ar[m] * ar[n];
+            for (unsigned int n = 0; n < k; n++)
+              W_m[n] += ar[m] * br[n];
+            g[m] += ar[m] * error[row];
+          }
+          for (unsigned int m = 0; m < k; m++) {
+            double *V_m = V[m];
+            for (unsigned int n = m; n < k; n++)
+              V_m[n] += br[m] * br[n];
+            h[m] += br[m] * error[row];
+          }
+          r_point += vpMath::sqr(error[row]);
+        }
+        // With distortion both models are averaged
+        r += m_distortion ? r_point * 0.5 : r_point;
+      }
+      for (unsigned int m = 0; m < 6; m++)
+        for (unsigned int n = 0; n < m; n++)
+          U[m][n] = U[n][m];
+      for (unsigned int m = 0; m < k; m++)
+        for (unsigned int n = 0; n < m; n++)
+          V[m][n] = V[n][m];
+
+      // The squared singular values of A_p are those of U_p
+      vpMatrix Ui = U.pseudoInverse(1e-20);
+      image.UiW = Ui * W;
+      image.Uig = Ui * g;
+      image.S = V - W.t() * image.UiW;
+      image.t = h - W.t() * image.Uig;
+      image.residual = r;
+    }
+  }
+
+private:
+  vpCalibrationVVSBody &operator=(const vpCalibrationVVSBody &);
+
+  std::vector<vpCalibrationImage> &m_images;
+  const vpCameraParameters &m_cam;
+  bool m_distortion;
+};
+
+/*
+  One iteration of the virtual visual servoing: returns the residual at the current
+  estimate, and updates the poses of the images and the intrinsic parameters.
+*/
+double calibVVSIteration(std::vector<vpCalibrationImage> &images, vpCameraParameters &cam, bool distortion,
+                         double gain)
+{
+  const unsigned int k = distortion ? 6 : 4;
+  vpThreadPool::parallelFor(0, (unsigned int) images.size(), vpCalibrationVVSBody(images, cam, distortion));
+
+  // Sum in the order of the images, the result does not depend on the number of threads
+  vpMatrix S(k, k);
+  vpColVector t(k);
+  double r = 0;
+  for (size_t p = 0; p < images.size(); p++) {
+    S += images[p].S;
+    t += images[p].t;
+    r += images[p].residual;
+  }
+
+  vpColVector e = S.pseudoInverse(1e-20) * t;
+
+  for (size_t p = 0; p < images.size(); p++) {
+    vpColVector Tc_v = -(images[p].Uig - images[p].UiW * e) * gain;
+    images[p].cMo = vpExponentialMap::direct(Tc_v).inverse() * images[p].cMo;
+  }
+
+  vpColVector Tc = -e * gain;
+
+  double px = cam.get_px(), py = cam.get_py(), u0 = cam.get_u0(), v0 = cam.get_v0();
+  if (distortion) {
+    cam.initPersProjWithDistortion(px + Tc[2], py + Tc[3], u0 + Tc[0], v0 + Tc[1], cam.get_kud() + Tc[5],
+                                   cam.get_kdu() + Tc[4]);
+  } else {
+    cam.initPersProjWithoutDistortion(px + Tc[2], py + Tc[3], u0 + Tc[0], v0 + Tc[1]);
+  }
+  return r;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
  
 void
 vpCalibration::calibLagrange(vpCameraParameters &cam_est, vpHomogeneousMatrix &cMo_est)
@@ -54,10 +349,10 @@ vpCalibration::calibLagrange(vpCameraParameters &cam_est, vpHomogeneousMatrix &c
   vpMatrix A(2*npt,3) ;
   vpMatrix B(2*npt,9) ;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   vpImagePoint ip;
 
@@ -229,10 +524,10 @@ vpCalibration::calibVVS(vpCameraParameters &cam_est,
 
   vpImagePoint ip;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
 
   for (unsigned int i =0 ; i < n_points ; i++)
   {
@@ -373,15 +668,22 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[256]; //number of points by image
   unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
 
-  for (unsigned int i=0; i<nbPose ; i++)
+  std::vector<vpCalibrationImage> images(nbPose);
+  for (unsigned int p=0; p<nbPose ; p++)
   {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
+    vpCalibration &cal = table_cal[p];
+    if (cal.npt > 0) {
+      images[p].oX = &cal.LoX[0];
+      images[p].oY = &cal.LoY[0];
+      images[p].oZ = &cal.LoZ[0];
+      images[p].ip = &cal.Lip[0];
+    }
+    images[p].npt = cal.npt;
+    images[p].cMo = cal.cMo;
+    nbPointTotal += cal.npt;
   }
 
   if (nbPointTotal < 4) {
@@ -390,178 +692,22 @@ vpCalibration::calibVVSMulti(std::vector<vpCalibration> &table_cal,
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(2*nbPointTotal) ;
-  vpColVector Pd(2*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-    
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-    
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
- 
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
   unsigned int iter = 0 ;
 
   double  residu_1 = 1e12 ;
   double r =1e12-1;
   while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
   {
-
     iter++ ;
     residu_1 = r ;
-    
-    double px = cam_est.get_px();
-    double py = cam_est.get_py();
-    double u0 = cam_est.get_u0();
-    double v0 = cam_est.get_v0();
-   
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;    
-        
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        Pd[curPoint2] =   u[curPoint] ;
-        Pd[curPoint2+1] = v[curPoint] ;
-
-        P[curPoint2] =    cX[curPoint]/cZ[curPoint]*px + u0 ;
-        P[curPoint2+1] =  cY[curPoint]/cZ[curPoint]*py + v0 ;
-
-        r += (vpMath::sqr(P[curPoint2]-Pd[curPoint2])
-               + vpMath::sqr(P[curPoint2+1]-Pd[curPoint2+1])) ;
-        curPoint++;
-      }
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix L(nbPointTotal*2,nbPose6+4) ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;   
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-        unsigned int curPoint21 = curPoint2 + 1;
-
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;
-            
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        //---------------
-        {
-          {
-            L[curPoint2][q] =  px * (-inv_z) ;
-            L[curPoint2][q+1] =  0 ;
-            L[curPoint2][q+2] =  px*(X*inv_z) ;
-            L[curPoint2][q+3] =  px*X*Y ;
-            L[curPoint2][q+4] =  -px*(1+X*X) ;
-            L[curPoint2][q+5] =  px*Y ;
-          }
-          {
-            L[curPoint2][nbPose6]= 1 ;
-            L[curPoint2][nbPose6+1]= 0 ;
-            L[curPoint2][nbPose6+2]= X ;
-            L[curPoint2][nbPose6+3]= 0;
-          }
-          {
-            L[curPoint21][q] = 0 ;
-            L[curPoint21][q+1] = py*(-inv_z) ;
-            L[curPoint21][q+2] = py*(Y*inv_z) ;
-            L[curPoint21][q+3] = py* (1+Y*Y) ;
-            L[curPoint21][q+4] = -py*X*Y ;
-            L[curPoint21][q+5] = -py*X ;
-          }
-          {
-            L[curPoint21][nbPose6]= 0 ;
-            L[curPoint21][nbPose6+1]= 1 ;
-            L[curPoint21][nbPose6+2]= 0;
-            L[curPoint21][nbPose6+3]= Y ;
-          }
-
-        }
-        curPoint++;
-      }    // end interaction
-    }
-    vpMatrix Lp ;
-    Lp = L.pseudoInverse(1e-10) ;
-
-    vpColVector e ;
-    e = Lp*error ;
-
-    vpColVector Tc, Tc_v(nbPose6) ;
-    Tc = -e*gain ;
-
-    //   Tc_v =0 ;
-    for (unsigned int i = 0 ; i < nbPose6 ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithoutDistortion(px+Tc[nbPose6+2],
-                                      py+Tc[nbPose6+3],
-                                      u0+Tc[nbPose6],
-                                      v0+Tc[nbPose6+1]) ;
-
-    //    cam.setKd(get_kd() + Tc[10]) ;
-    vpColVector Tc_v_Tmp(6) ;
-
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo = vpExponentialMap::direct(Tc_v_Tmp,1).inverse()
-                         * table_cal[p].cMo;
-    }
+    r = calibVVSIteration(images, cam_est, false, gain);
 
     if (verbose)
       std::cout <<  " std dev " << sqrt(r/nbPointTotal) << std::endl;
-
   }
+  for (unsigned int p = 0 ; p < nbPose ; p++)
+    table_cal[p].cMo = images[p].cMo;
+
   if (iter == nbIterMax)
   {
     vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
@@ -599,10 +745,10 @@ vpCalibration::calibVVSWithDistortion(vpCameraParameters& cam_est,
   vpColVector P(4*n_points) ;
   vpColVector Pd(4*n_points) ;
 
-  std::list<double>::const_iterator it_LoX = LoX.begin();
-  std::list<double>::const_iterator it_LoY = LoY.begin();
-  std::list<double>::const_iterator it_LoZ = LoZ.begin();
-  std::list<vpImagePoint>::const_iterator it_Lip = Lip.begin();
+  std::vector<double>::const_iterator it_LoX = LoX.begin();
+  std::vector<double>::const_iterator it_LoY = LoY.begin();
+  std::vector<double>::const_iterator it_LoZ = LoZ.begin();
+  std::vector<vpImagePoint>::const_iterator it_Lip = Lip.begin();
   
   vpImagePoint ip;
 
@@ -828,19 +974,28 @@ vpCalibration::calibVVSWithDistortion(vpCameraParameters& cam_est,
 
 void
 vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal,
-                                           vpCameraParameters &cam_est, double &globalReprojectionError,
+                                           vpCameraParameters &cam_est,
+                                           double &globalReprojectionError,
                                            bool verbose)
 {
   std::ios::fmtflags original_flags( std::cout.flags() );
   std::cout.precision(10);
-  unsigned int nbPoint[1024]; //number of points by image
   unsigned int nbPointTotal = 0; //total number of points
   unsigned int nbPose = (unsigned int)table_cal.size();
-  unsigned int nbPose6 = 6*nbPose;
-  for (unsigned int i=0; i<nbPose ; i++)
+
+  std::vector<vpCalibrationImage> images(nbPose);
+  for (unsigned int p=0; p<nbPose ; p++)
   {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
+    vpCalibration &cal = table_cal[p];
+    if (cal.npt > 0) {
+      images[p].oX = &cal.LoX[0];
+      images[p].oY = &cal.LoY[0];
+      images[p].oZ = &cal.LoZ[0];
+      images[p].ip = &cal.Lip[0];
+    }
+    images[p].npt = cal.npt;
+    images[p].cMo = cal.cMo_dist;
+    nbPointTotal += cal.npt;
   }
 
   if (nbPointTotal < 4)
@@ -850,42 +1005,6 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
                                  "Not enough point to calibrate")) ;
   }
 
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(4*nbPointTotal) ;
-  vpColVector Pd(4*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
   unsigned int iter = 0 ;
 
   double  residu_1 = 1e12 ;
@@ -894,209 +1013,14 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
   {
     iter++ ;
     residu_1 = r ;
+    r = calibVVSIteration(images, cam_est, true, gain);
 
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo_dist;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        curPoint++;
-      }
-    }
-
-
-    vpMatrix L(nbPointTotal*4,nbPose6+6) ;
-    curPoint = 0 ; //current point indice
-    double px = cam_est.get_px() ;
-    double py = cam_est.get_py() ;
-    double u0 = cam_est.get_u0() ;
-    double v0 = cam_est.get_v0() ;
-
-    double inv_px = 1/px ;
-    double inv_py = 1/py ;
-
-    double kud = cam_est.get_kud() ;
-    double kdu = cam_est.get_kdu() ;
-
-    double k2ud = 2*kud;
-    double k2du = 2*kdu;
-    
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;   
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint4 = 4*curPoint;
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;    
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        double X2 = X*X;
-        double Y2 = Y*Y;
-        double XY = X*Y;
-       
-        double up = u[curPoint] ;
-        double vp = v[curPoint] ;
-
-        Pd[curPoint4] =   up ;
-        Pd[curPoint4+1] = vp ;
-
-        double up0 = up - u0;
-        double vp0 = vp - v0;
-
-        double xp0 = up0 * inv_px;
-        double xp02 = xp0 *xp0 ;
-      
-        double yp0 = vp0 * inv_py;
-        double yp02 = yp0 * yp0;
-      
-        double r2du = xp02 + yp02 ;
-        double kr2du = kdu * r2du;
-
-        P[curPoint4] =   u0 + px*X - kr2du *(up0) ;
-        P[curPoint4+1] = v0 + py*Y - kr2du *(vp0) ;
-
-        double r2ud = X2 + Y2 ;
-        double kr2ud = 1 + kud * r2ud;
-      
-        double Axx = px*(kr2ud+k2ud*X2);
-        double Axy = px*k2ud*XY;
-        double Ayy = py*(kr2ud+k2ud*Y2);
-        double Ayx = py*k2ud*XY;
-
-        Pd[curPoint4+2] = up ;
-        Pd[curPoint4+3] = vp ;
-
-        P[curPoint4+2] = u0 + px*X*kr2ud ;
-        P[curPoint4+3] = v0 + py*Y*kr2ud ;
-
-        r += (vpMath::sqr(P[curPoint4]-Pd[curPoint4]) +
-             vpMath::sqr(P[curPoint4+1]-Pd[curPoint4+1]) +
-             vpMath::sqr(P[curPoint4+2]-Pd[curPoint4+2]) +
-             vpMath::sqr(P[curPoint4+3]-Pd[curPoint4+3]))*0.5 ;
-
-        unsigned int curInd = curPoint4;
-        //---------------
-        {
-          {
-            L[curInd][q] =  px * (-inv_z) ;
-            L[curInd][q+1] =  0 ;
-            L[curInd][q+2] =  px*X*inv_z ;
-            L[curInd][q+3] =  px*X*Y ;
-            L[curInd][q+4] =  -px*(1+X2) ;
-            L[curInd][q+5] =  px*Y ;
-          }
-          {
-            L[curInd][nbPose6]= 1 + kr2du + k2du*xp02  ;
-            L[curInd][nbPose6+1]= k2du*up0*yp0*inv_py ;
-            L[curInd][nbPose6+2]= X + k2du*xp02*xp0 ;
-            L[curInd][nbPose6+3]= k2du*up0*yp02*inv_py ;
-            L[curInd][nbPose6+4] = -(up0)*(r2du) ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;     
-          {
-            L[curInd][q] = 0 ;
-            L[curInd][q+1] = py*(-inv_z) ;
-            L[curInd][q+2] = py*Y*inv_z ;
-            L[curInd][q+3] = py* (1+Y2) ;
-            L[curInd][q+4] = -py*XY ;
-            L[curInd][q+5] = -py*X ;
-          }
-          {
-            L[curInd][nbPose6]= k2du*xp0*vp0*inv_px ;
-            L[curInd][nbPose6+1]= 1 + kr2du + k2du*yp02;
-            L[curInd][nbPose6+2]= k2du*vp0*xp02*inv_px;
-            L[curInd][nbPose6+3]= Y + k2du*yp02*yp0;
-            L[curInd][nbPose6+4] = -vp0*r2du ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-  //---undistorted to distorted
-          {
-            L[curInd][q] = Axx*(-inv_z) ;
-            L[curInd][q+1] = Axy*(-inv_z) ;
-            L[curInd][q+2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
-            L[curInd][q+3] = Axx*X*Y +  Axy*(1+Y2);
-            L[curInd][q+4] = -Axx*(1+X2) - Axy*XY;
-            L[curInd][q+5] = Axx*Y -Axy*X;
-          }
-          {
-            L[curInd][nbPose6]= 1 ;
-            L[curInd][nbPose6+1]= 0 ;
-            L[curInd][nbPose6+2]= X*kr2ud ;
-            L[curInd][nbPose6+3]= 0;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = px*X*r2ud ;
-          }
-            curInd++;   
-          {
-            L[curInd][q] = Ayx*(-inv_z) ;
-            L[curInd][q+1] = Ayy*(-inv_z) ;
-            L[curInd][q+2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
-            L[curInd][q+3] = Ayx*XY + Ayy*(1+Y2) ;
-            L[curInd][q+4] = -Ayx*(1+X2) -Ayy*XY ;
-            L[curInd][q+5] = Ayx*Y -Ayy*X;
-          }
-          {
-            L[curInd][nbPose6]= 0 ;
-            L[curInd][nbPose6+1]= 1;
-            L[curInd][nbPose6+2]= 0;
-            L[curInd][nbPose6+3]= Y*kr2ud ;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = py*Y*r2ud ;
-          }
-        }  // end interaction
-        curPoint++;
-      }    // end interaction
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix Lp ;
-    /*double rank =*/
-    L.pseudoInverse(Lp,1e-10) ;
-    vpColVector e ;
-    e = Lp*error ;
-    vpColVector Tc, Tc_v(6*nbPose) ;
-    Tc = -e*gain ;
-    for (unsigned int i = 0 ; i < 6*nbPose ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithDistortion(  px+Tc[nbPose6+2], py+Tc[nbPose6+3],
-                                     u0+Tc[nbPose6], v0+Tc[nbPose6+1],
-                                     kud + Tc[nbPose6+5],
-                                     kdu + Tc[nbPose6+4]);
-
-    vpColVector Tc_v_Tmp(6) ;
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo_dist = vpExponentialMap::direct(Tc_v_Tmp).inverse()
-                            * table_cal[p].cMo_dist;
-    }
     if (verbose)
       std::cout <<  " std dev: " << sqrt(r/nbPointTotal) << std::endl;
-    //std::cout <<  "   residual: " << r << std::endl;
-
   }
+  for (unsigned int p = 0 ; p < nbPose ; p++)
+    table_cal[p].cMo_dist = images[p].cMo;
+
   if (iter == nbIterMax)
   {
     vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
@@ -1104,15 +1028,9 @@ vpCalibration::calibVVSWithDistortionMulti(std::vector<vpCalibration> &table_cal
                                  "Maximum number of iterations reached")) ;
   }
 
-  //double perViewError;
-  //double totalError = 0;
-  //int totalPoints = 0;
   for (unsigned int p = 0 ; p < nbPose ; p++)
   {
     table_cal[p].cam_dist = cam_est ;
-    //perViewError = table_cal[p].computeStdDeviation_dist(table_cal[p].cMo_dist, cam_est);
-    //totalError += perViewError*perViewError * table_cal[p].npt;
-    //totalPoints += (int)table_cal[p].npt;
   }
   globalReprojectionError = sqrt(r/(nbPointTotal));
 
@@ -1331,216 +1249,14 @@ vpCalibration::calibVVSMulti(unsigned int nbPose,
                              vpCameraParameters &cam_est,
                              bool verbose)
 {
-  std::ios::fmtflags original_flags( std::cout.flags() );
-  std::cout.precision(10);
-  unsigned int nbPoint[256]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
-
-  unsigned int nbPose6 = 6*nbPose;
-
-  for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
-
-  if (nbPointTotal < 4)
-  {
-    //vpERROR_TRACE("Not enough point to calibrate");
-    throw(vpCalibrationException(vpCalibrationException::notInitializedError,
-                                 "Not enough point to calibrate")) ;
-  }
-
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(2*nbPointTotal) ;
-  vpColVector Pd(2*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
-
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
-  unsigned int iter = 0 ;
-
-  double  residu_1 = 1e12 ;
-  double r =1e12-1;
-  while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
-  {
-
-    iter++ ;
-    residu_1 = r ;
-
-    double px = cam_est.get_px();
-    double py = cam_est.get_py();
-    double u0 = cam_est.get_u0();
-    double v0 = cam_est.get_v0();
-
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        Pd[curPoint2] =   u[curPoint] ;
-        Pd[curPoint2+1] = v[curPoint] ;
-
-        P[curPoint2] =    cX[curPoint]/cZ[curPoint]*px + u0 ;
-        P[curPoint2+1] =  cY[curPoint]/cZ[curPoint]*py + v0 ;
-
-        r += (vpMath::sqr(P[curPoint2]-Pd[curPoint2])
-               + vpMath::sqr(P[curPoint2+1]-Pd[curPoint2+1])) ;
-        curPoint++;
-      }
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix L(nbPointTotal*2,nbPose6+4) ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint2 = 2*curPoint;
-        unsigned int curPoint21 = curPoint2 + 1;
-
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;
-
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        //---------------
-        {
-          {
-            L[curPoint2][q] =  px * (-inv_z) ;
-            L[curPoint2][q+1] =  0 ;
-            L[curPoint2][q+2] =  px*(X*inv_z) ;
-            L[curPoint2][q+3] =  px*X*Y ;
-            L[curPoint2][q+4] =  -px*(1+X*X) ;
-            L[curPoint2][q+5] =  px*Y ;
-          }
-          {
-            L[curPoint2][nbPose6]= 1 ;
-            L[curPoint2][nbPose6+1]= 0 ;
-            L[curPoint2][nbPose6+2]= X ;
-            L[curPoint2][nbPose6+3]= 0;
-          }
-          {
-            L[curPoint21][q] = 0 ;
-            L[curPoint21][q+1] = py*(-inv_z) ;
-            L[curPoint21][q+2] = py*(Y*inv_z) ;
-            L[curPoint21][q+3] = py* (1+Y*Y) ;
-            L[curPoint21][q+4] = -py*X*Y ;
-            L[curPoint21][q+5] = -py*X ;
-          }
-          {
-            L[curPoint21][nbPose6]= 0 ;
-            L[curPoint21][nbPose6+1]= 1 ;
-            L[curPoint21][nbPose6+2]= 0;
-            L[curPoint21][nbPose6+3]= Y ;
-          }
-
-        }
-        curPoint++;
-      }    // end interaction
-    }
-    vpMatrix Lp ;
-    Lp = L.pseudoInverse(1e-10) ;
-
-    vpColVector e ;
-    e = Lp*error ;
-
-    vpColVector Tc, Tc_v(nbPose6) ;
-    Tc = -e*gain ;
-
-    //   Tc_v =0 ;
-    for (unsigned int i = 0 ; i < nbPose6 ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithoutDistortion(px+Tc[nbPose6+2],
-                                      py+Tc[nbPose6+3],
-                                      u0+Tc[nbPose6],
-                                      v0+Tc[nbPose6+1]) ;
-
-    //    cam.setKd(get_kd() + Tc[10]) ;
-    vpColVector Tc_v_Tmp(6) ;
-
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo = vpExponentialMap::direct(Tc_v_Tmp,1).inverse()
-                         * table_cal[p].cMo;
-    }
-    if (verbose)
-      std::cout <<  " std dev " << sqrt(r/nbPointTotal) << std::endl;
-
-  }
-  if (iter == nbIterMax)
-  {
-    vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
-    throw(vpCalibrationException(vpCalibrationException::convergencyError,
-                                 "Maximum number of iterations reached")) ;
-  }
+  std::vector<vpCalibration> table(table_cal, table_cal + nbPose);
+  double globalReprojectionError;
+  calibVVSMulti(table, cam_est, globalReprojectionError, verbose);
   for (unsigned int p = 0 ; p < nbPose ; p++)
-  {
-    table_cal[p].cMo_dist = table_cal[p].cMo ;
-    table_cal[p].cam = cam_est;
-    table_cal[p].cam_dist = cam_est;
-    double deviation,deviation_dist;
-    table_cal[p].computeStdDeviation(deviation,deviation_dist);
-  }
-  if (verbose)
-    std::cout <<  " Global std dev " << sqrt(r/nbPointTotal) << std::endl;
+    table_cal[p] = table[p];
 
-  // Restore ostream format
-  std::cout.flags(original_flags);
+  if (verbose)
+    std::cout <<  " Global std dev " << globalReprojectionError << std::endl;
 }
 
 
@@ -1551,287 +1267,15 @@ vpCalibration::calibVVSWithDistortionMulti(
   vpCameraParameters &cam_est,
   bool verbose)
 {
-  std::ios::fmtflags original_flags( std::cout.flags() );
-  std::cout.precision(10);
-  unsigned int nbPoint[1024]; //number of points by image
-  unsigned int nbPointTotal = 0; //total number of points
-
-  unsigned int nbPose6 = 6*nbPose;
-  for (unsigned int i=0; i<nbPose ; i++)
-  {
-    nbPoint[i] = table_cal[i].npt;
-    nbPointTotal += nbPoint[i];
-  }
-
-  if (nbPointTotal < 4)
-  {
-    //vpERROR_TRACE("Not enough point to calibrate");
-    throw(vpCalibrationException(vpCalibrationException::notInitializedError,
-                                 "Not enough point to calibrate")) ;
-  }
-
-  vpColVector oX(nbPointTotal), cX(nbPointTotal)  ;
-  vpColVector oY(nbPointTotal), cY(nbPointTotal) ;
-  vpColVector oZ(nbPointTotal), cZ(nbPointTotal) ;
-  vpColVector u(nbPointTotal) ;
-  vpColVector v(nbPointTotal) ;
-
-  vpColVector P(4*nbPointTotal) ;
-  vpColVector Pd(4*nbPointTotal) ;
-  vpImagePoint ip;
-
-  unsigned int curPoint = 0 ; //current point indice
-  for (unsigned int p=0; p<nbPose ; p++)
-  {
-    std::list<double>::const_iterator it_LoX = table_cal[p].LoX.begin();
-    std::list<double>::const_iterator it_LoY = table_cal[p].LoY.begin();
-    std::list<double>::const_iterator it_LoZ = table_cal[p].LoZ.begin();
-    std::list<vpImagePoint>::const_iterator it_Lip = table_cal[p].Lip.begin();
-
-    for (unsigned int i =0 ; i < nbPoint[p] ; i++)
-    {
-      oX[curPoint]  = *it_LoX;
-      oY[curPoint]  = *it_LoY;
-      oZ[curPoint]  = *it_LoZ;
-
-      ip = *it_Lip;
-      u[curPoint] = ip.get_u()  ;
-      v[curPoint] = ip.get_v()  ;
-
-      ++ it_LoX;
-      ++ it_LoY;
-      ++ it_LoZ;
-      ++ it_Lip;
-      curPoint++;
-    }
-  }
-  //  double lambda = 0.1 ;
-  unsigned int iter = 0 ;
-
-  double  residu_1 = 1e12 ;
-  double r =1e12-1;
-  while (vpMath::equal(residu_1,r,threshold) == false && iter < nbIterMax)
-  {
-    iter++ ;
-    residu_1 = r ;
-
-    r = 0 ;
-    curPoint = 0 ; //current point indice
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      vpHomogeneousMatrix cMoTmp = table_cal[p].cMo_dist;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        cX[curPoint] = oX[curPoint]*cMoTmp[0][0]+oY[curPoint]*cMoTmp[0][1]
-                       +oZ[curPoint]*cMoTmp[0][2] + cMoTmp[0][3];
-        cY[curPoint] = oX[curPoint]*cMoTmp[1][0]+oY[curPoint]*cMoTmp[1][1]
-                       +oZ[curPoint]*cMoTmp[1][2] + cMoTmp[1][3];
-        cZ[curPoint] = oX[curPoint]*cMoTmp[2][0]+oY[curPoint]*cMoTmp[2][1]
-                       +oZ[curPoint]*cMoTmp[2][2] + cMoTmp[2][3];
-
-        curPoint++;
-      }
-    }
-
-
-    vpMatrix L(nbPointTotal*4,nbPose6+6) ;
-    curPoint = 0 ; //current point indice
-    double px = cam_est.get_px() ;
-    double py = cam_est.get_py() ;
-    double u0 = cam_est.get_u0() ;
-    double v0 = cam_est.get_v0() ;
-
-    double inv_px = 1/px ;
-    double inv_py = 1/py ;
-
-    double kud = cam_est.get_kud() ;
-    double kdu = cam_est.get_kdu() ;
-
-    double k2ud = 2*kud;
-    double k2du = 2*kdu;
-
-    for (unsigned int p=0; p<nbPose ; p++)
-    {
-      unsigned int q = 6*p;
-      for (unsigned int i=0 ; i < nbPoint[p]; i++)
-      {
-        unsigned int curPoint4 = 4*curPoint;
-        double x = cX[curPoint] ;
-        double y = cY[curPoint] ;
-        double z = cZ[curPoint] ;
-
-        double inv_z = 1/z;
-        double X =   x*inv_z ;
-        double Y =   y*inv_z ;
-
-        double X2 = X*X;
-        double Y2 = Y*Y;
-        double XY = X*Y;
-
-        double up = u[curPoint] ;
-        double vp = v[curPoint] ;
-
-        Pd[curPoint4] =   up ;
-        Pd[curPoint4+1] = vp ;
-
-        double up0 = up - u0;
-        double vp0 = vp - v0;
-
-        double xp0 = up0 * inv_px;
-        double xp02 = xp0 *xp0 ;
-
-        double yp0 = vp0 * inv_py;
-        double yp02 = yp0 * yp0;
-
-        double r2du = xp02 + yp02 ;
-        double kr2du = kdu * r2du;
-
-        P[curPoint4] =   u0 + px*X - kr2du *(up0) ;
-        P[curPoint4+1] = v0 + py*Y - kr2du *(vp0) ;
-
-        double r2ud = X2 + Y2 ;
-        double kr2ud = 1 + kud * r2ud;
-
-        double Axx = px*(kr2ud+k2ud*X2);
-        double Axy = px*k2ud*XY;
-        double Ayy = py*(kr2ud+k2ud*Y2);
-        double Ayx = py*k2ud*XY;
-
-        Pd[curPoint4+2] = up ;
-        Pd[curPoint4+3] = vp ;
-
-        P[curPoint4+2] = u0 + px*X*kr2ud ;
-        P[curPoint4+3] = v0 + py*Y*kr2ud ;
-
-        r += (vpMath::sqr(P[curPoint4]-Pd[curPoint4]) +
-             vpMath::sqr(P[curPoint4+1]-Pd[curPoint4+1]) +
-             vpMath::sqr(P[curPoint4+2]-Pd[curPoint4+2]) +
-             vpMath::sqr(P[curPoint4+3]-Pd[curPoint4+3]))*0.5 ;
-
-        unsigned int curInd = curPoint4;
-        //---------------
-        {
-          {
-            L[curInd][q] =  px * (-inv_z) ;
-            L[curInd][q+1] =  0 ;
-            L[curInd][q+2] =  px*X*inv_z ;
-            L[curInd][q+3] =  px*X*Y ;
-            L[curInd][q+4] =  -px*(1+X2) ;
-            L[curInd][q+5] =  px*Y ;
-          }
-          {
-            L[curInd][nbPose6]= 1 + kr2du + k2du*xp02  ;
-            L[curInd][nbPose6+1]= k2du*up0*yp0*inv_py ;
-            L[curInd][nbPose6+2]= X + k2du*xp02*xp0 ;
-            L[curInd][nbPose6+3]= k2du*up0*yp02*inv_py ;
-            L[curInd][nbPose6+4] = -(up0)*(r2du) ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-          {
-            L[curInd][q] = 0 ;
-            L[curInd][q+1] = py*(-inv_z) ;
-            L[curInd][q+2] = py*Y*inv_z ;
-            L[curInd][q+3] = py* (1+Y2) ;
-            L[curInd][q+4] = -py*XY ;
-            L[curInd][q+5] = -py*X ;
-          }
-          {
-            L[curInd][nbPose6]= k2du*xp0*vp0*inv_px ;
-            L[curInd][nbPose6+1]= 1 + kr2du + k2du*yp02;
-            L[curInd][nbPose6+2]= k2du*vp0*xp02*inv_px;
-            L[curInd][nbPose6+3]= Y + k2du*yp02*yp0;
-            L[curInd][nbPose6+4] = -vp0*r2du ;
-            L[curInd][nbPose6+5] = 0 ;
-          }
-            curInd++;
-  //---undistorted to distorted
-          {
-            L[curInd][q] = Axx*(-inv_z) ;
-            L[curInd][q+1] = Axy*(-inv_z) ;
-            L[curInd][q+2] = Axx*(X*inv_z) + Axy*(Y*inv_z) ;
-            L[curInd][q+3] = Axx*X*Y +  Axy*(1+Y2);
-            L[curInd][q+4] = -Axx*(1+X2) - Axy*XY;
-            L[curInd][q+5] = Axx*Y -Axy*X;
-          }
-          {
-            L[curInd][nbPose6]= 1 ;
-            L[curInd][nbPose6+1]= 0 ;
-            L[curInd][nbPose6+2]= X*kr2ud ;
-            L[curInd][nbPose6+3]= 0;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = px*X*r2ud ;
-          }
-            curInd++;
-          {
-            L[curInd][q] = Ayx*(-inv_z) ;
-            L[curInd][q+1] = Ayy*(-inv_z) ;
-            L[curInd][q+2] = Ayx*(X*inv_z) + Ayy*(Y*inv_z) ;
-            L[curInd][q+3] = Ayx*XY + Ayy*(1+Y2) ;
-            L[curInd][q+4] = -Ayx*(1+X2) -Ayy*XY ;
-            L[curInd][q+5] = Ayx*Y -Ayy*X;
-          }
-          {
-            L[curInd][nbPose6]= 0 ;
-            L[curInd][nbPose6+1]= 1;
-            L[curInd][nbPose6+2]= 0;
-            L[curInd][nbPose6+3]= Y*kr2ud ;
-            L[curInd][nbPose6+4] = 0 ;
-            L[curInd][nbPose6+5] = py*Y*r2ud ;
-          }
-        }  // end interaction
-        curPoint++;
-      }    // end interaction
-    }
-
-    vpColVector error ;
-    error = P-Pd ;
-    //r = r/nbPointTotal ;
-
-    vpMatrix Lp ;
-    /*double rank =*/
-    L.pseudoInverse(Lp,1e-10) ;
-    vpColVector e ;
-    e = Lp*error ;
-    vpColVector Tc, Tc_v(6*nbPose) ;
-    Tc = -e*gain ;
-    for (unsigned int i = 0 ; i < 6*nbPose ; i++)
-      Tc_v[i] = Tc[i] ;
-
-    cam_est.initPersProjWithDistortion(  px+Tc[nbPose6+2], py+Tc[nbPose6+3],
-                                     u0+Tc[nbPose6], v0+Tc[nbPose6+1],
-                                     kud + Tc[nbPose6+5],
-                                     kdu + Tc[nbPose6+4]);
-
-    vpColVector Tc_v_Tmp(6) ;
-    for (unsigned int p = 0 ; p < nbPose ; p++)
-    {
-      for (unsigned int i = 0 ; i < 6 ; i++)
-        Tc_v_Tmp[i] = Tc_v[6*p + i];
-
-      table_cal[p].cMo_dist = vpExponentialMap::direct(Tc_v_Tmp).inverse()
-                            * table_cal[p].cMo_dist;
-    }
-    if (verbose)
-      std::cout <<  " std dev: " << sqrt(r/nbPointTotal) << std::endl;
-    //std::cout <<  "   residual: " << r << std::endl;
-
-  }
-  if (iter == nbIterMax)
-  {
-    vpERROR_TRACE("Iterations number exceed the maximum allowed (%d)",nbIterMax);
-    throw(vpCalibrationException(vpCalibrationException::convergencyError,
-                                 "Maximum number of iterations reached")) ;
-  }
-
+  std::vector<vpCalibration> table(table_cal, table_cal + nbPose);
+  double globalReprojectionError;
+  calibVVSWithDistortionMulti(table, cam_est, globalReprojectionError, verbose);
   for (unsigned int p = 0 ; p < nbPose ; p++)
   {
-    table_cal[p].cam_dist = cam_est ;
+    table_cal[p] = table[p];
     table_cal[p].computeStdDeviation_dist(table_cal[p].cMo_dist, cam_est);
   }
-  if (verbose)
-    std::cout <<" Global std dev " << sqrt(r/(nbPointTotal)) << std::endl;
 
-  // Restore ostream format
-  std::cout.flags(original_flags);
+  if (verbose)
+    std::cout <<" Global std dev " << globalReprojectionError << std::endl;
 }
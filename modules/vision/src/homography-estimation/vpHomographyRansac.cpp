@@ -42,6 +42,18 @@
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpRansacScheduler.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpUniRand.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define VISP_HAVE_SSE2 1
+#endif
 
 #define vpEps 1e-6
 
@@ -322,6 +334,252 @@ vpHomography::initRansac(unsigned int n,
   }
 }
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+// Contiguous coordinates of the matched points
+struct vpHomographyRansacPoints
+{
+  const double *xb, *yb, *xa, *ya;
+  unsigned int n;
+};
+
+// Same criterion as isColinear(): squared norm of the cross product of p2-p1 and p3-p1
+bool isColinear(const double *x, const double *y, unsigned int i, unsigned int j, unsigned int k)
+{
+  double cross = (x[j] - x[i]) * (y[k] - y[i]) - (y[j] - y[i]) * (x[k] - x[i]);
+  return cross * cross < vpEps;
+}
+
+bool isDegenerate(const vpHomographyRansacPoints &points, const unsigned int *ind)
+{
+  for (unsigned int i = 0; i < 2; i++) {
+    for (unsigned int j = i + 1; j < 3; j++) {
+      for (unsigned int k = j + 1; k < 4; k++) {
+        if (isColinear(points.xa, points.ya, ind[i], ind[j], ind[k]) ||
+            isColinear(points.xb, points.yb, ind[i], ind[j], ind[k]))
+          return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*
+  Projective transformation B mapping the canonical basis (1,0,0), (0,1,0),
+  (0,0,1), (1,1,1) to the 4 points, as a row-major 3x3 matrix. The first 3
+  points should not be colinear.
+*/
+bool basisToPoints(const double *x, const double *y, const unsigned int *ind, double *B)
+{
+  const double x0 = x[ind[0]], y0 = y[ind[0]], x1 = x[ind[1]], y1 = y[ind[1]], x2 = x[ind[2]], y2 = y[ind[2]];
+  const double x3 = x[ind[3]], y3 = y[ind[3]];
+  // Solve [p0 p1 p2] l = p3 with the Cramer's rule
+  double det = x0 * (y1 - y2) - x1 * (y0 - y2) + x2 * (y0 - y1);
+  if (std::fabs(det) < std::numeric_limits<double>::epsilon())
+    return false;
+  double l0 = (x3 * (y1 - y2) - x1 * (y3 - y2) + x2 * (y3 - y1)) / det;
+  double l1 = (x0 * (y3 - y2) - x3 * (y0 - y2) + x2 * (y0 - y3)) / det;
+  double l2 = (x0 * (y1 - y3) - x1 * (y0 - y3) + x3 * (y0 - y1)) / det;
+  B[0] = l0 * x0; B[1] = l1 * x1; B[2] = l2 * x2;
+  B[3] = l0 * y0; B[4] = l1 * y1; B[5] = l2 * y2;
+  B[6] = l0;      B[7] = l1;      B[8] = l2;
+  return true;
+}
+
+/*
+  Exact homography aHb mapping 4 points in general position, as a row-major
+  3x3 matrix with H[8] = 1. Gives the same matrix as the DLT on the 4 points.
+*/
+bool minimalHomography(const vpHomographyRansacPoints &points, const unsigned int *ind, double *H)
+{
+  double A[9], B[9];
+  if (!basisToPoints(points.xa, points.ya, ind, A) || !basisToPoints(points.xb, points.yb, ind, B))
+    return false;
+  // aHb = A adj(B), adj(B) being the inverse of B up to a scale factor
+  double adjB[9];
+  adjB[0] = B[4] * B[8] - B[5] * B[7]; adjB[1] = B[2] * B[7] - B[1] * B[8]; adjB[2] = B[1] * B[5] - B[2] * B[4];
+  adjB[3] = B[5] * B[6] - B[3] * B[8]; adjB[4] = B[0] * B[8] - B[2] * B[6]; adjB[5] = B[2] * B[3] - B[0] * B[5];
+  adjB[6] = B[3] * B[7] - B[4] * B[6]; adjB[7] = B[1] * B[6] - B[0] * B[7]; adjB[8] = B[0] * B[4] - B[1] * B[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      H[3 * i + j] = A[3 * i] * adjB[j] + A[3 * i + 1] * adjB[3 + j] + A[3 * i + 2] * adjB[6 + j];
+    }
+  }
+  double norm = 0;
+  for (unsigned int i = 0; i < 9; i++)
+    norm += H[i] * H[i];
+  if (std::fabs(H[8]) <= std::numeric_limits<double>::epsilon() * std::sqrt(norm))
+    return false;
+  for (unsigned int i = 0; i < 8; i++)
+    H[i] /= H[8];
+  H[8] = 1;
+  return true;
+}
+
+/*
+  Squared transfer errors || pa - aHb pb ||^2 of the points in [start, end),
+  two points at a time with SSE2.
+*/
+void computeSquaredErrors(const double *H, const vpHomographyRansacPoints &points, unsigned int start,
+                          unsigned int end, double *errors)
+{
+  unsigned int i = start;
+#if defined(VISP_HAVE_SSE2)
+  const __m128d h0 = _mm_set1_pd(H[0]), h1 = _mm_set1_pd(H[1]), h2 = _mm_set1_pd(H[2]);
+  const __m128d h3 = _mm_set1_pd(H[3]), h4 = _mm_set1_pd(H[4]), h5 = _mm_set1_pd(H[5]);
+  const __m128d h6 = _mm_set1_pd(H[6]), h7 = _mm_set1_pd(H[7]), h8 = _mm_set1_pd(H[8]);
+  const __m128d one = _mm_set1_pd(1.0);
+  for (; i + 2 <= end; i += 2) {
+    __m128d xb = _mm_loadu_pd(points.xb + i), yb = _mm_loadu_pd(points.yb + i);
+    __m128d u = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h0, xb), _mm_mul_pd(h1, yb)), h2);
+    __m128d v = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h3, xb), _mm_mul_pd(h4, yb)), h5);
+    __m128d w = _mm_add_pd(_mm_add_pd(_mm_mul_pd(h6, xb), _mm_mul_pd(h7, yb)), h8);
+    __m128d inv_w = _mm_div_pd(one, w);
+    __m128d ex = _mm_sub_pd(_mm_mul_pd(u, inv_w), _mm_loadu_pd(points.xa + i));
+    __m128d ey = _mm_sub_pd(_mm_mul_pd(v, inv_w), _mm_loadu_pd(points.ya + i));
+    _mm_storeu_pd(errors + i - start, _mm_add_pd(_mm_mul_pd(ex, ex), _mm_mul_pd(ey, ey)));
+  }
+#endif
+  for (; i < end; i++) {
+    double xb = points.xb[i], yb = points.yb[i];
+    double u = H[0] * xb + H[1] * yb + H[2];
+    double v = H[3] * xb + H[4] * yb + H[5];
+    double w = H[6] * xb + H[7] * yb + H[8];
+    double inv_w = 1.0 / w;
+    double ex = u * inv_w - points.xa[i];
+    double ey = v * inv_w - points.ya[i];
+    errors[i - start] = ex * ex + ey * ey;
+  }
+}
+
+/*
+  Index of the points whose transfer error is below the threshold. The
+  evaluation is given up, returning false, as soon as maxOutliers points are
+  outliers.
+*/
+bool computeConsensus(const double *H, const vpHomographyRansacPoints &points, double threshold2,
+                      unsigned int maxOutliers, std::vector<unsigned int> &consensus)
+{
+  //Number of points evaluated between two checks of the number of outliers
+  const unsigned int blockSize = 32;
+  double errors[blockSize];
+  unsigned int nbOutliers = 0;
+  consensus.clear();
+  for (unsigned int start = 0; start < points.n; start += blockSize) {
+    unsigned int end = std::min(start + blockSize, points.n);
+    computeSquaredErrors(H, points, start, end, errors);
+    for (unsigned int i = start; i < end; i++) {
+      // Written to reject NaN errors
+      if (errors[i - start] <= threshold2)
+        consensus.push_back(i);
+      else
+        nbOutliers++;
+    }
+    if (nbOutliers >= maxOutliers)
+      return false;
+  }
+  return true;
+}
+
+/*
+  RANSAC worker: draws its own samples with its own random generator while
+  the scheduler hands out trials, and keeps its best hypothesis.
+*/
+class vpHomographyRansacWorker
+{
+public:
+  vpHomographyRansacWorker()
+    : m_consensus(), m_nbInliers(0), m_points(), m_scheduler(NULL), m_seed(0), m_threshold(0)
+  {
+  }
+
+  vpHomographyRansacWorker(const vpHomographyRansacPoints &points, vpRansacScheduler &scheduler,
+                           double threshold, long seed)
+    : m_consensus(), m_nbInliers(0), m_points(points), m_scheduler(&scheduler), m_seed(seed),
+      m_threshold(threshold)
+  {
+  }
+
+  void operator()()
+  {
+    const unsigned int n = m_points.n;
+    const double threshold2 = m_threshold * m_threshold;
+    vpUniRand random(m_seed);
+    std::vector<unsigned int> cur_consensus;
+    cur_consensus.reserve(n);
+    unsigned int ind[4];
+    double H[9];
+
+    while (m_scheduler->nextTrial()) {
+      // Minimal sample of 4 distinct points
+      for (unsigned int i = 0; i < 4; i++) {
+        bool used = true;
+        while (used) {
+          ind[i] = std::min((unsigned int) (random() * n), n - 1);
+          used = false;
+          for (unsigned int j = 0; j < i; j++)
+            used |= (ind[j] == ind[i]);
+        }
+      }
+      if (isDegenerate(m_points, ind) || !minimalHomography(m_points, ind, H))
+        continue;
+
+      // Reject the numerically unstable hypotheses
+      double errors[4];
+      double r = 0;
+      for (unsigned int i = 0; i < 4; i++) {
+        computeSquaredErrors(H, m_points, ind[i], ind[i] + 1, errors + i);
+        r += errors[i];
+      }
+      if (!(std::sqrt(r / 4) < m_threshold))
+        continue;
+
+      // A hypothesis has to beat the best one found by all the workers
+      unsigned int bestNbInliers = m_scheduler->getBestNbInliers();
+      if (!computeConsensus(H, m_points, threshold2, n - bestNbInliers, cur_consensus))
+        continue;
+
+      unsigned int nbInliersCur = (unsigned int) cur_consensus.size();
+      if (nbInliersCur > m_nbInliers) {
+        m_nbInliers = nbInliersCur;
+        m_consensus.swap(cur_consensus);
+      }
+      m_scheduler->update(nbInliersCur);
+    }
+  }
+
+  const std::vector<unsigned int> &getConsensus() const { return m_consensus; }
+  unsigned int getNbInliers() const { return m_nbInliers; }
+
+private:
+  std::vector<unsigned int> m_consensus;
+  unsigned int m_nbInliers;
+  vpHomographyRansacPoints m_points;
+  vpRansacScheduler *m_scheduler;
+  long m_seed;
+  double m_threshold;
+};
+
+// Run the workers with indexes in [start, end) on the threads of the pool
+class vpHomographyRansacBody : public vpParallelLoopBody
+{
+public:
+  explicit vpHomographyRansacBody(std::vector<vpHomographyRansacWorker> &workers) : m_workers(workers) {}
+
+  void operator()(unsigned int start, unsigned int end) const
+  {
+    for (unsigned int i = start; i < end; i++)
+      m_workers[i]();
+  }
+
+private:
+  std::vector<vpHomographyRansacWorker> &m_workers;
+
+  vpHomographyRansacBody &operator=(const vpHomographyRansacBody &);
+};
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
 
   From couples of matched points \f$^a{\bf p}=(x_a,y_a,1)\f$ in image a
@@ -345,8 +603,29 @@ vpHomography::initRansac(unsigned int n,
   \param normalization : When set to true, the coordinates of the points are normalized. The normalization
   carried out is the one preconized by Hartley.
 
+  \param maxTrials : Maximum number of random samples of 4 points, or -1 for no limit.
+
+  \param probability : Probability that at least one of the samples is free from outliers. Each time a larger
+  consensus set is found, the number of trials is lowered to the one needed for the current inlier ratio, see
+  vpRansacScheduler. Use 1 to run \e maxTrials trials.
+
+  \param timeBudget : Time budget in ms, not limited if not strictly positive.
+
+  \param nbThreads : Number of threads evaluating the samples, 0 to use vpThreadPool::getConcurrency().
+
   \return true if the homography could be computed, false otherwise.
 
+  The samples are drawn by one worker per thread, each one with its own
+  random generator with a fixed seed: with one thread, the result is
+  reproducible. The homography of a sample is computed in closed form and
+  evaluated on all the points, with SSE2 when available. The evaluation of a
+  hypothesis is given up as soon as it cannot beat the best consensus set.
+  The sampling stops when a consensus set of \e nbInliersConsensus points is
+  found, when enough samples were drawn for the given \e probability, after
+  \e maxTrials samples or when the time budget is exceeded. The homography is
+  then estimated with DLT() from the points of the largest consensus set,
+  which are given by \e inliers.
+
 */
 bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<double> &yb,
                           const std::vector<double> &xa, const std::vector<double> &ya,
@@ -355,7 +634,11 @@ bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<doubl
                           double &residual,
                           unsigned int nbInliersConsensus,
                           double threshold,
-                          bool normalization)
+                          bool normalization,
+                          int maxTrials,
+                          double probability,
+                          double timeBudget,
+                          unsigned int nbThreads)
 {
   unsigned int n = (unsigned int)xb.size();
   if (yb.size() != n || xa.size() != n || ya.size() != n)
@@ -366,169 +649,69 @@ bool vpHomography::ransac(const std::vector<double> &xb, const std::vector<doubl
   if(n<4)
     throw(vpException(vpException::fatalError, "There must be at least 4 matched points"));
 
-  vpUniRand random((const long)time(NULL)) ;
-
-  std::vector<unsigned int> best_consensus;
-  std::vector<unsigned int> cur_consensus;
-  std::vector<unsigned int> cur_outliers;
-  std::vector<unsigned int> cur_randoms;
-
-  std::vector<unsigned int> rand_ind;
-
-  unsigned int nbMinRandom = 4 ;
-  unsigned int ransacMaxTrials = 1000;
-  unsigned int maxDegenerateIter = 1000;
-
-  unsigned int nbTrials = 0;
-  unsigned int nbDegenerateIter = 0;
-  unsigned int nbInliers = 0;
+  vpHomographyRansacPoints points;
+  points.xb = &xb[0];
+  points.yb = &yb[0];
+  points.xa = &xa[0];
+  points.ya = &ya[0];
+  points.n = n;
+
+  vpRansacScheduler scheduler(maxTrials, probability, timeBudget, n, nbInliersConsensus, 4);
+
+  if (nbThreads == 0)
+    nbThreads = vpThreadPool::getConcurrency();
+  std::vector<vpHomographyRansacWorker> workers(nbThreads);
+  for (unsigned int i = 0; i < nbThreads; i++)
+    workers[i] = vpHomographyRansacWorker(points, scheduler, threshold, (long) (i * 1000003));
+  if (nbThreads > 1)
+    vpThreadPool::parallelFor(0, nbThreads, vpHomographyRansacBody(workers), nbThreads, 1);
+  else
+    workers[0]();
+
+  // Largest consensus set of the workers
+  unsigned int best = 0;
+  for (unsigned int i = 1; i < nbThreads; i++) {
+    if (workers[i].getNbInliers() > workers[best].getNbInliers())
+      best = i;
+  }
+  const std::vector<unsigned int> &best_consensus = workers[best].getConsensus();
 
-  bool foundSolution = false;
+  inliers.assign(n, false);
+  for (size_t i = 0; i < best_consensus.size(); i++)
+    inliers[best_consensus[i]] = true;
 
-  std::vector<double> xa_rand(nbMinRandom);
-  std::vector<double> ya_rand(nbMinRandom);
-  std::vector<double> xb_rand(nbMinRandom);
-  std::vector<double> yb_rand(nbMinRandom);
+  if (best_consensus.empty() || best_consensus.size() < nbInliersConsensus)
+    return false;
 
-  if (inliers.size() != n)
-    inliers.resize(n);
+  std::vector<double> xa_best(best_consensus.size());
+  std::vector<double> ya_best(best_consensus.size());
+  std::vector<double> xb_best(best_consensus.size());
+  std::vector<double> yb_best(best_consensus.size());
 
-  while (nbTrials < ransacMaxTrials && nbInliers < nbInliersConsensus)
+  for(unsigned i = 0 ; i < best_consensus.size(); i++)
   {
-    cur_outliers.clear();
-    cur_randoms.clear();
-
-    bool degenerate = true;
-    while(degenerate == true){
-      std::vector<bool> usedPt(n, false);
-
-      rand_ind.clear();
-      for(unsigned int i = 0; i < nbMinRandom; i++)
-      {
-        // Generate random indicies in the range 0..n
-        unsigned int r = (unsigned int)ceil(random()*n) -1;
-        while(usedPt[r]) {
-          r = (unsigned int)ceil(random()*n) -1;
-        }
-        usedPt[r] = true;
-        rand_ind.push_back(r);
-
-        xa_rand[i] = xa[r];
-        ya_rand[i] = ya[r];
-        xb_rand[i] = xb[r];
-        yb_rand[i] = yb[r];
-      }
-
-      try{
-        if (! vpHomography::degenerateConfiguration(xb_rand, yb_rand, xa_rand, ya_rand)) {
-          vpHomography::DLT(xb_rand, yb_rand, xa_rand, ya_rand, aHb, normalization);
-         degenerate = false;
-        }
-      }
-      catch(...){
-        degenerate = true;
-      }
-
-      nbDegenerateIter ++;
-
-      if (nbDegenerateIter > maxDegenerateIter){
-        vpERROR_TRACE("Unable to select a nondegenerate data set");
-        throw(vpException(vpException::fatalError, "Unable to select a nondegenerate data set"));
-      }
-    }
-
-    aHb /= aHb[2][2] ;
-
-    // Computing Residual
-    double r = 0;
-    vpColVector a(3), b(3), c(3) ;
-    for (unsigned int i=0 ; i < nbMinRandom ; i++) {
-      a[0] = xa_rand[i] ; a[1] = ya_rand[i] ; a[2] = 1 ;
-      b[0] = xb_rand[i] ; b[1] = yb_rand[i] ; b[2] = 1 ;
-
-      c = aHb*b; c /= c[2] ;
-      r += (a-c).sumSquare() ;
-      //cout << "point " <<i << "  " << (a-c).sumSquare()  <<endl ;;
-    }
-
-    // Finding inliers & ouliers
-    r = sqrt(r/nbMinRandom);
-    //std::cout << "Candidate residual: " << r << std::endl;
-    if (r < threshold)
-    {
-      unsigned int nbInliersCur = 0;
-      for (unsigned int i = 0; i < n ; i++)
-      {
-        a[0] = xa[i] ; a[1] = ya[i] ; a[2] = 1 ;
-        b[0] = xb[i] ; b[1] = yb[i] ; b[2] = 1 ;
-
-        c = aHb*b ; c /= c[2] ;
-        double error = sqrt((a-c).sumSquare()) ;
-        if(error <= threshold){
-          nbInliersCur++;
-          cur_consensus.push_back(i);
-          inliers[i] = true;
-        }
-        else{
-          cur_outliers.push_back(i);
-          inliers[i] = false;
-        }
-      }
-      //std::cout << "nb inliers that matches: " << nbInliersCur << std::endl;
-      if(nbInliersCur > nbInliers)
-      {
-        foundSolution = true;
-        best_consensus = cur_consensus;
-        nbInliers = nbInliersCur;
-      }
-
-      cur_consensus.clear();
-    }
-
-    nbTrials++;
-    if(nbTrials >= ransacMaxTrials){
-      vpERROR_TRACE("Ransac reached the maximum number of trials");
-      foundSolution = true;
-    }
+    xa_best[i] = xa[best_consensus[i]];
+    ya_best[i] = ya[best_consensus[i]];
+    xb_best[i] = xb[best_consensus[i]];
+    yb_best[i] = yb[best_consensus[i]];
   }
 
-  if(foundSolution){
-    if(nbInliers >= nbInliersConsensus)
-    {
-      std::vector<double> xa_best(best_consensus.size());
-      std::vector<double> ya_best(best_consensus.size());
-      std::vector<double> xb_best(best_consensus.size());
-      std::vector<double> yb_best(best_consensus.size());
-
-      for(unsigned i = 0 ; i < best_consensus.size(); i++)
-      {
-        xa_best[i] = xa[best_consensus[i]];
-        ya_best[i] = ya[best_consensus[i]];
-        xb_best[i] = xb[best_consensus[i]];
-        yb_best[i] = yb[best_consensus[i]];
-      }
-
-      vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization) ;
-      aHb /= aHb[2][2];
-
-      residual = 0 ;
-      vpColVector a(3), b(3), c(3);
-      for (unsigned int i=0 ; i < best_consensus.size() ; i++) {
-        a[0] = xa_best[i] ; a[1] = ya_best[i] ; a[2] = 1 ;
-        b[0] = xb_best[i] ; b[1] = yb_best[i] ; b[2] = 1 ;
-
-        c = aHb*b ; c /= c[2] ;
-        residual += (a-c).sumSquare() ;
-      }
+  vpHomography::DLT(xb_best, yb_best, xa_best, ya_best, aHb, normalization) ;
+  aHb /= aHb[2][2];
 
-      residual = sqrt(residual/best_consensus.size());
-      return true;
-    }
-    else {
-      return false;
-    }
-  }
-  else {
-    return false;
-  }
+  vpHomographyRansacPoints best_points;
+  best_points.xb = &xb_best[0];
+  best_points.yb = &yb_best[0];
+  best_points.xa = &xa_best[0];
+  best_points.ya = &ya_best[0];
+  best_points.n = (unsigned int) best_consensus.size();
+  std::vector<double> errors(best_consensus.size());
+  computeSquaredErrors(aHb.data, best_points, 0, best_points.n, &errors[0]);
+
+  residual = 0 ;
+  for (unsigned int i=0 ; i < best_consensus.size() ; i++)
+    residual += errors[i];
+
+  residual = sqrt(residual/best_consensus.size());
+  return true;
 }
@@ -0,0 +1,404 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Nearest neighbor search of binary descriptors with multi-index hashing.
+ *
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdint.h>
+
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/vision/vpHammingIndex.h>
+
+#if defined __SSSE3__
+#  include <tmmintrin.h>
+#  define VISP_HAVE_SSSE3 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+  // Number of buckets of a hash table indexing substrings of 16 bits
+  const unsigned int nbBuckets = 0x10000;
+
+  // Below this number of descriptors, a linear scan is faster than the hash tables
+  const unsigned int minIndexedDescriptors = 4096;
+
+  inline unsigned int popcount64(uint64_t x)
+  {
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (unsigned int) ((x * 0x0101010101010101ULL) >> 56);
+#endif
+  }
+
+  // Number of bits that differ between a and b, of size bytes
+  inline unsigned int hammingDistance(const unsigned char *a, const unsigned char *b, unsigned int size)
+  {
+    unsigned int i = 0, distance = 0;
+#if VISP_HAVE_SSSE3
+    // Popcount of each nibble with a lookup in a register, summed by _mm_sad_epu8
+    if (size >= 16) {
+      const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m128i low_mask = _mm_set1_epi8(0x0f);
+      const __m128i zero = _mm_setzero_si128();
+      __m128i acc = zero;
+      for (; i + 16 <= size; i += 16) {
+        const __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (a + i)),
+                                        _mm_loadu_si128((const __m128i *) (b + i)));
+        const __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, low_mask));
+        const __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), low_mask));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_add_epi8(lo, hi), zero));
+      }
+      distance = (unsigned int) (_mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8)));
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+      uint64_t x, y;
+      memcpy(&x, a + i, sizeof(x));
+      memcpy(&y, b + i, sizeof(y));
+      distance += popcount64(x ^ y);
+    }
+    for (; i < size; i++) {
+      distance += popcount64((uint64_t) (a[i] ^ b[i]));
+    }
+    return distance;
+  }
+
+  // Insert (distance, index) in the sorted list of the k best candidates
+  inline void insertCandidate(std::vector<std::pair<unsigned int, unsigned int> > &best, unsigned int k,
+                              unsigned int distance, unsigned int index)
+  {
+    const std::pair<unsigned int, unsigned int> candidate(distance, index);
+    if (best.size() == k && !(candidate < best.back()))
+      return;
+    best.insert(std::upper_bound(best.begin(), best.end(), candidate), candidate);
+    if (best.size() > k)
+      best.pop_back();
+  }
+
+  inline unsigned int substring(const unsigned char *descriptor, unsigned int j)
+  {
+    return (unsigned int) descriptor[2*j] | ((unsigned int) descriptor[2*j+1] << 8);
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*
+  Search the nearest neighbors of the queries with indexes in [start, end).
+*/
+class vpHammingIndex::SearchBody : public vpParallelLoopBody
+{
+public:
+  SearchBody(const vpHammingIndex &index, const unsigned char *queries, unsigned int k, double ratio,
+             std::vector<std::vector<Match> > &matches)
+    : m_index(index), m_queries(queries), m_k(k), m_ratio(ratio), m_matches(matches) {}
+
+  void operator()(unsigned int start, unsigned int end) const {
+    Workspace workspace;
+    m_index.initWorkspace(workspace);
+    for (unsigned int q = start; q < end; q++) {
+      m_index.search(m_queries + (size_t) q * m_index.m_descriptorSize, m_k, m_ratio, workspace);
+      std::vector<Match> &matches = m_matches[q];
+      matches.resize(workspace.best.size());
+      for (size_t i = 0; i < workspace.best.size(); i++) {
+        matches[i].queryIdx = q;
+        matches[i].trainIdx = workspace.best[i].second;
+        matches[i].distance = workspace.best[i].first;
+      }
+    }
+  }
+
+private:
+  const vpHammingIndex &m_index;
+  const unsigned char *m_queries;
+  unsigned int m_k;
+  double m_ratio;
+  std::vector<std::vector<Match> > &m_matches;
+};
+
+/*!
+  Default constructor of an empty index.
+*/
+vpHammingIndex::vpHammingIndex()
+  : m_descriptorSize(0), m_stride(0), m_nbDescriptors(0), m_nbSubstrings(0), m_descriptors(), m_bucketStarts(),
+    m_bucketEntries(), m_radiusMasks(), m_radiusOffsets()
+{
+}
+
+/*!
+  Index a set of binary descriptors. The descriptors are copied.
+
+  \param descriptors : The descriptors, stored row by row.
+  \param nbDescriptors : Number of descriptors.
+  \param descriptorSize : Size of a descriptor in bytes.
+
+  \exception vpException::dimensionError : If the descriptor size is null.
+*/
+void vpHammingIndex::build(const unsigned char *descriptors, unsigned int nbDescriptors, unsigned int descriptorSize)
+{
+  if (descriptorSize == 0) {
+    throw vpException(vpException::dimensionError, "Cannot index descriptors of size 0");
+  }
+
+  m_descriptorSize = descriptorSize;
+  m_stride = (descriptorSize + 15) / 16 * 16;
+  m_nbDescriptors = nbDescriptors;
+  m_descriptors.assign((size_t) nbDescriptors * m_stride, 0);
+  for (unsigned int i = 0; i < nbDescriptors; i++) {
+    memcpy(&m_descriptors[(size_t) i * m_stride], descriptors + (size_t) i * descriptorSize, descriptorSize);
+  }
+
+  m_nbSubstrings = (nbDescriptors >= minIndexedDescriptors) ? descriptorSize / 2 : 0;
+  m_bucketStarts.assign((size_t) m_nbSubstrings * (nbBuckets + 1), 0);
+  m_bucketEntries.resize((size_t) m_nbSubstrings * nbDescriptors);
+  if (m_nbSubstrings == 0) {
+    m_radiusMasks.clear();
+    m_radiusOffsets.clear();
+    return;
+  }
+
+  // Counting sort of the descriptors by substring value, for each table
+  std::vector<unsigned int> positions(nbBuckets);
+  for (unsigned int j = 0; j < m_nbSubstrings; j++) {
+    unsigned int *starts = &m_bucketStarts[(size_t) j * (nbBuckets + 1)];
+    unsigned int *entries = &m_bucketEntries[(size_t) j * nbDescriptors];
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      starts[substring(&m_descriptors[(size_t) i * m_stride], j) + 1]++;
+    }
+    for (unsigned int b = 0; b < nbBuckets; b++) {
+      starts[b + 1] += starts[b];
+    }
+    std::copy(starts, starts + nbBuckets, positions.begin());
+    for (unsigned int i = 0; i < nbDescriptors; i++) {
+      entries[positions[substring(&m_descriptors[(size_t) i * m_stride], j)]++] = i;
+    }
+  }
+
+  // Masks of 16 bits grouped by number of bits set, to probe the buckets at a given radius
+  m_radiusOffsets.assign(18, 0);
+  for (unsigned int mask = 0; mask < nbBuckets; mask++) {
+    m_radiusOffsets[popcount64(mask) + 1]++;
+  }
+  for (unsigned int r = 0; r < 17; r++) {
+    m_radiusOffsets[r + 1] += m_radiusOffsets[r];
+  }
+  m_radiusMasks.resize(nbBuckets);
+  std::vector<unsigned int> next(m_radiusOffsets.begin(), m_radiusOffsets.end() - 1);
+  for (unsigned int mask = 0; mask < nbBuckets; mask++) {
+    m_radiusMasks[next[popcount64(mask)]++] = (unsigned short) mask;
+  }
+}
+
+/*!
+  Remove all the descriptors from the index.
+*/
+void vpHammingIndex::clear()
+{
+  m_descriptorSize = m_stride = m_nbDescriptors = m_nbSubstrings = 0;
+  m_descriptors.clear();
+  m_bucketStarts.clear();
+  m_bucketEntries.clear();
+  m_radiusMasks.clear();
+  m_radiusOffsets.clear();
+}
+
+/*!
+  Hamming distance between two binary descriptors.
+
+  \param descriptor1 : First descriptor.
+  \param descriptor2 : Second descriptor.
+  \param descriptorSize : Size of the descriptors in bytes.
+  \return The number of bits that differ between the two descriptors.
+*/
+unsigned int vpHammingIndex::distance(const unsigned char *descriptor1, const unsigned char *descriptor2,
+                                      unsigned int descriptorSize)
+{
+  return hammingDistance(descriptor1, descriptor2, descriptorSize);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void vpHammingIndex::initWorkspace(Workspace &workspace) const
+{
+  workspace.query.assign(m_stride, 0);
+  workspace.stamps.assign(m_nbSubstrings > 0 ? m_nbDescriptors : 0, 0);
+  workspace.stamp = 0;
+  workspace.best.clear();
+}
+
+void vpHammingIndex::linearSearch(const unsigned char *query, unsigned int k, Workspace &workspace) const
+{
+  workspace.best.clear();
+  for (unsigned int i = 0; i < m_nbDescriptors; i++) {
+    insertCandidate(workspace.best, k, hammingDistance(query, &m_descriptors[(size_t) i * m_stride], m_stride), i);
+  }
+}
+
+/*
+  Search the k nearest neighbors of a query, stored sorted by (distance, index) in workspace.best.
+  If ratio < 1, the search stops as soon as the descriptors that could make the ratio test of the
+  nearest neighbor fail have been seen: the second neighbor is then either exact, or any
+  descriptor for which the ratio test succeeds, or missing.
+*/
+void vpHammingIndex::search(const unsigned char *query, unsigned int k, double ratio, Workspace &workspace) const
+{
+  memcpy(&workspace.query[0], query, m_descriptorSize);
+  const unsigned char *q = &workspace.query[0];
+
+  if (m_nbSubstrings == 0) {
+    linearSearch(q, k, workspace);
+    return;
+  }
+
+  workspace.best.clear();
+  if (++workspace.stamp == 0) {
+    std::fill(workspace.stamps.begin(), workspace.stamps.end(), 0);
+    workspace.stamp = 1;
+  }
+
+  unsigned int nbVerified = 0;
+  for (unsigned int r = 0; r <= 16; r++) {
+    // Probing the tables at this radius is more expensive than a linear scan
+    const unsigned int nbMasks = m_radiusOffsets[r + 1] - m_radiusOffsets[r];
+    if (r > 0 && (size_t) m_nbSubstrings * nbMasks + nbVerified > m_nbDescriptors / 4) {
+      linearSearch(q, k, workspace);
+      return;
+    }
+
+    for (unsigned int j = 0; j < m_nbSubstrings; j++) {
+      const unsigned int key = substring(q, j);
+      const unsigned int *starts = &m_bucketStarts[(size_t) j * (nbBuckets + 1)];
+      const unsigned int *entries = &m_bucketEntries[(size_t) j * m_nbDescriptors];
+      for (unsigned int m = m_radiusOffsets[r]; m < m_radiusOffsets[r + 1]; m++) {
+        const unsigned int bucket = key ^ m_radiusMasks[m];
+        for (unsigned int e = starts[bucket]; e < starts[bucket + 1]; e++) {
+          const unsigned int i = entries[e];
+          if (workspace.stamps[i] != workspace.stamp) {
+            workspace.stamps[i] = workspace.stamp;
+            nbVerified++;
+            insertCandidate(workspace.best, k, hammingDistance(q, &m_descriptors[(size_t) i * m_stride], m_stride), i);
+          }
+        }
+      }
+    }
+
+    // All the descriptors closer than m_nbSubstrings * (r+1) bits have been seen
+    const unsigned int seen = m_nbSubstrings * (r + 1);
+    if (nbVerified == m_nbDescriptors || (workspace.best.size() == k && workspace.best.back().first < seen)) {
+      return;
+    }
+    if (ratio < 1 && !workspace.best.empty() && workspace.best[0].first < ratio * seen) {
+      return;
+    }
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Search the k nearest neighbors of each query descriptor.
+
+  \param queries : Query descriptors, stored row by row, of size getDescriptorSize().
+  \param nbQueries : Number of query descriptors.
+  \param k : Number of neighbors.
+  \param matches : For each query, the min(k, getNbDescriptors()) nearest neighbors sorted
+  by increasing distance. The lists are empty if no descriptor is indexed.
+  \param nbThreads : Number of threads, 0 to use the concurrency of vpThreadPool.
+*/
+void vpHammingIndex::knnMatch(const unsigned char *queries, unsigned int nbQueries, unsigned int k,
+                              std::vector<std::vector<Match> > &matches, unsigned int nbThreads) const
+{
+  matches.assign(nbQueries, std::vector<Match>());
+  if (nbQueries == 0 || m_nbDescriptors == 0)
+    return;
+  vpThreadPool::parallelFor(0, nbQueries, SearchBody(*this, queries, k, 1.0, matches), nbThreads, 256);
+}
+
+/*!
+  Search the nearest neighbor of each query descriptor, and keep the matches
+  that pass the ratio test and the cross-check.
+
+  \param queries : Query descriptors, stored row by row, of size getDescriptorSize().
+  \param nbQueries : Number of query descriptors.
+  \param matches : The matches sorted by query index, empty if no descriptor is indexed.
+  \param ratio : A match is kept if its distance is below \e ratio times the
+  distance of the second nearest neighbor. A ratio greater or equal to 1 disables the test.
+  \param crossCheck : If true, a match is kept only if the query descriptor is
+  also the nearest query descriptor of the indexed descriptor.
+  \param nbThreads : Number of threads, 0 to use the concurrency of vpThreadPool.
+*/
+void vpHammingIndex::match(const unsigned char *queries, unsigned int nbQueries, std::vector<Match> &matches,
+                           double ratio, bool crossCheck, unsigned int nbThreads) const
+{
+  matches.clear();
+  if (nbQueries == 0 || m_nbDescriptors == 0)
+    return;
+
+  std::vector<std::vector<Match> > knnMatches(nbQueries);
+  vpThreadPool::parallelFor(0, nbQueries, SearchBody(*this, queries, ratio < 1 ? 2 : 1, ratio, knnMatches), nbThreads, 256);
+
+  for (unsigned int q = 0; q < nbQueries; q++) {
+    const std::vector<Match> &knn = knnMatches[q];
+    if (ratio < 1 && knn.size() == 2 && !(knn[0].distance < ratio * knn[1].distance))
+      continue;
+    matches.push_back(knn[0]);
+  }
+
+  if (crossCheck && !matches.empty()) {
+    // Nearest query of each matched descriptor
+    std::map<unsigned int, unsigned int> trainIndexes;
+    for (size_t i = 0; i < matches.size(); i++) {
+      trainIndexes.insert(std::make_pair(matches[i].trainIdx, (unsigned int) trainIndexes.size()));
+    }
+    std::vector<unsigned char> trainDescriptors(trainIndexes.size() * m_descriptorSize);
+    for (std::map<unsigned int, unsigned int>::const_iterator it = trainIndexes.begin(); it != trainIndexes.end(); ++it) {
+      memcpy(&trainDescriptors[(size_t) it->second * m_descriptorSize], &m_descriptors[(size_t) it->first * m_stride],
+             m_descriptorSize);
+    }
+    vpHammingIndex queryIndex;
+    queryIndex.build(queries, nbQueries, m_descriptorSize);
+    std::vector<std::vector<Match> > reverseMatches;
+    queryIndex.knnMatch(&trainDescriptors[0], (unsigned int) trainIndexes.size(), 1, reverseMatches, nbThreads);
+
+    size_t nbKept = 0;
+    for (size_t i = 0; i < matches.size(); i++) {
+      if (reverseMatches[trainIndexes[matches[i].trainIdx]][0].trainIdx == matches[i].queryIdx) {
+        matches[nbKept++] = matches[i];
+      }
+    }
+    matches.resize(nbKept);
+  }
+}
@@ -35,12 +35,21 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
 #include <limits>
 #include <iomanip>
+#include <cstdio>
+#include <cstring>
 #include <stdint.h> //uint32_t ; works also with >= VS2010 / _MSC_VER >= 1600
 
 #include <visp3/vision/vpKeyPoint.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpThreadPool.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_KEYPOINT_HAVE_MUTEX
+#  include <visp3/core/vpMutex.h>
+#endif
 
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020101)
 
@@ -289,6 +298,169 @@ namespace {
     file.write((char *)(&double_value), sizeof(double_value));
   #endif
   }
+
+  //Learning data file that can be memory mapped and used in place: a header followed by
+  //the keypoints, the 3D points, the descriptors and the training images table, each
+  //section starting at an offset aligned on 64 bytes. The values are little endian.
+  const char learningDataMagic[8] = { 'V', 'I', 'S', 'P', 'K', 'P', 'D', 'B' };
+
+  //Check if a learning data file starts with the magic number of the memory mapped format
+  bool isMappedLearningData(const std::string &filename) {
+    std::ifstream file(filename.c_str(), std::ifstream::binary);
+    char magic[sizeof(learningDataMagic)];
+    file.read(magic, sizeof(magic));
+    return file.good() && memcmp(magic, learningDataMagic, sizeof(magic)) == 0;
+  }
+
+#ifdef VISP_LITTLE_ENDIAN
+  const uint32_t learningDataVersion = 1;
+
+  struct LearningDataHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t have3DInfo;
+    int32_t nbKeyPoints;
+    int32_t descriptorCols;
+    int32_t descriptorType;
+    //Size in bytes of a row of descriptor
+    uint32_t descriptorRowSize;
+    int32_t nbImages;
+    uint32_t reserved;
+    uint64_t keyPointsOffset;
+    uint64_t pointsOffset;
+    uint64_t descriptorsOffset;
+    //For each training image: image_id, path length, path characters
+    uint64_t imagesOffset;
+  };
+
+  struct LearningDataKeyPoint {
+    float u, v, size, angle, response;
+    int32_t octave, class_id, image_id;
+  };
+
+  inline uint64_t alignLearningDataOffset(const uint64_t offset) {
+    return (offset + 63) & ~((uint64_t) 63);
+  }
+
+  void writeLearningDataPadding(std::ofstream &file, const uint64_t offset) {
+    const char zeros[64] = { 0 };
+    uint64_t position = (uint64_t) file.tellp();
+    if(offset > position) {
+      file.write(zeros, (std::streamsize) (offset - position));
+    }
+  }
+
+  //Write the learning data in the memory mapped format, imageIds being the training image id of each keypoint.
+  //The file is closed when returning.
+  void writeMappedLearningData(std::ofstream &file, const std::map<int, std::string> &mapOfImgPath,
+                               const std::vector<cv::KeyPoint> &keyPoints, const std::vector<int> &imageIds,
+                               const std::vector<cv::Point3f> &points, const cv::Mat &descriptors) {
+    uint64_t nbKeyPoints = (uint64_t) descriptors.rows;
+    LearningDataHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, learningDataMagic, sizeof(learningDataMagic));
+    header.version = learningDataVersion;
+    header.have3DInfo = points.empty() ? 0 : 1;
+    header.nbKeyPoints = descriptors.rows;
+    header.descriptorCols = descriptors.cols;
+    header.descriptorType = descriptors.type();
+    header.descriptorRowSize = (uint32_t) (descriptors.cols * descriptors.elemSize());
+    header.nbImages = (int32_t) mapOfImgPath.size();
+    header.keyPointsOffset = alignLearningDataOffset(sizeof(header));
+    header.pointsOffset = alignLearningDataOffset(header.keyPointsOffset + nbKeyPoints * sizeof(LearningDataKeyPoint));
+    header.descriptorsOffset = alignLearningDataOffset(header.pointsOffset +
+                                                       (points.empty() ? 0 : nbKeyPoints * sizeof(cv::Point3f)));
+    header.imagesOffset = alignLearningDataOffset(header.descriptorsOffset + nbKeyPoints * header.descriptorRowSize);
+    file.write((const char *) &header, sizeof(header));
+
+    //Keypoints
+    if(nbKeyPoints > 0) {
+      std::vector<LearningDataKeyPoint> records((size_t) nbKeyPoints);
+      for(size_t i = 0; i < records.size(); i++) {
+        records[i].u = keyPoints[i].pt.x;
+        records[i].v = keyPoints[i].pt.y;
+        records[i].size = keyPoints[i].size;
+        records[i].angle = keyPoints[i].angle;
+        records[i].response = keyPoints[i].response;
+        records[i].octave = keyPoints[i].octave;
+        records[i].class_id = keyPoints[i].class_id;
+        records[i].image_id = imageIds[i];
+      }
+      writeLearningDataPadding(file, header.keyPointsOffset);
+      file.write((const char *) &records[0], (std::streamsize) (records.size() * sizeof(LearningDataKeyPoint)));
+    }
+
+    //3D points
+    if(!points.empty()) {
+      writeLearningDataPadding(file, header.pointsOffset);
+      file.write((const char *) &points[0], (std::streamsize) (points.size() * sizeof(cv::Point3f)));
+    }
+
+    //Descriptors
+    writeLearningDataPadding(file, header.descriptorsOffset);
+    for(int i = 0; i < descriptors.rows; i++) {
+      file.write((const char *) descriptors.ptr(i), (std::streamsize) header.descriptorRowSize);
+    }
+
+    //Training images
+    writeLearningDataPadding(file, header.imagesOffset);
+    for(std::map<int, std::string>::const_iterator it = mapOfImgPath.begin(); it != mapOfImgPath.end(); ++it) {
+      int32_t id = it->first, length = (int32_t) it->second.length();
+      file.write((const char *) &id, sizeof(id));
+      file.write((const char *) &length, sizeof(length));
+      file.write(it->second.c_str(), length);
+    }
+
+    file.close();
+    if(file.fail()) {
+      throw vpException(vpException::ioError, "Cannot write the file.");
+    }
+  }
+#endif
+
+  //Concatenate the keypoints and the descriptors of the affine views, the descriptors
+  //being copied once in a matrix allocated with the total number of rows. If a list of
+  //tilt levels is given, the class_id of each keypoint is set to the tilt level of its view.
+  void concatenateAffineViews(const std::vector<std::vector<cv::KeyPoint> > &listOfKeyPoints,
+                              const std::vector<cv::Mat> &listOfDescriptors, std::vector<cv::KeyPoint> &keyPoints,
+                              cv::Mat &descriptors, const std::vector<int> *listOfTiltLevels=NULL) {
+    size_t nbKeyPoints = 0;
+    int nbRows = 0, cols = 0, type = -1;
+    for(size_t i = 0; i < listOfKeyPoints.size(); i++) {
+      nbKeyPoints += listOfKeyPoints[i].size();
+      if(!listOfDescriptors[i].empty()) {
+        nbRows += listOfDescriptors[i].rows;
+        cols = listOfDescriptors[i].cols;
+        type = listOfDescriptors[i].type();
+      }
+    }
+
+    keyPoints.clear();
+    keyPoints.reserve(nbKeyPoints);
+    for(size_t i = 0; i < listOfKeyPoints.size(); i++) {
+      size_t first = keyPoints.size();
+      keyPoints.insert(keyPoints.end(), listOfKeyPoints[i].begin(), listOfKeyPoints[i].end());
+      if(listOfTiltLevels != NULL) {
+        for(size_t j = first; j < keyPoints.size(); j++) {
+          keyPoints[j].class_id = (*listOfTiltLevels)[i];
+        }
+      }
+    }
+
+    if(nbRows == 0) {
+      descriptors = cv::Mat();
+      return;
+    }
+
+    descriptors.create(nbRows, cols, type);
+    int row = 0;
+    for(size_t i = 0; i < listOfDescriptors.size(); i++) {
+      if(!listOfDescriptors[i].empty()) {
+        listOfDescriptors[i].copyTo(descriptors.rowRange(row, row + listOfDescriptors[i].rows));
+        row += listOfDescriptors[i].rows;
+      }
+    }
+  }
 }
 
 /*!
@@ -301,21 +473,24 @@ namespace {
  */
 vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatureDescriptorType &descriptorType,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_affineTiltLevel(0), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_guidedMatchingPose(), m_guidedMatchingPoseValid(false), m_guidedMatchingRadius(20.0), m_guidedMatchingUsed(false),
+    m_hammingIndex(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFiles(), m_mapOfImageId(),
+    m_mapOfImagePaths(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
-    m_trainVpPoints(), m_useAffineDetection(false),
+    m_trainVpPoints(), m_useAffineDetection(false), m_useAffineTiltRestriction(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useGuidedMatching(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -336,21 +511,24 @@ vpKeyPoint::vpKeyPoint(const vpFeatureDetectorType &detectorType, const vpFeatur
  */
 vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extractorName,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_affineTiltLevel(0), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(),
     m_detectors(), m_extractionTime(0.), m_extractorNames(), m_extractors(), m_filteredMatches(), m_filterType(filterType),
-    m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_guidedMatchingPose(), m_guidedMatchingPoseValid(false), m_guidedMatchingRadius(20.0), m_guidedMatchingUsed(false),
+    m_hammingIndex(),
+    m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFiles(), m_mapOfImageId(),
+    m_mapOfImagePaths(), m_mapOfImages(),
     m_matcher(), m_matcherName(matcherName),
     m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
-    m_trainVpPoints(), m_useAffineDetection(false),
+    m_trainVpPoints(), m_useAffineDetection(false), m_useAffineTiltRestriction(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useGuidedMatching(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -371,21 +549,23 @@ vpKeyPoint::vpKeyPoint(const std::string &detectorName, const std::string &extra
  */
 vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std::vector<std::string> &extractorNames,
                        const std::string &matcherName, const vpFilterMatchingType &filterType)
-  : m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
+  : m_affineTiltLevel(0), m_computeCovariance(false), m_covarianceMatrix(), m_currentImageId(0), m_detectionMethod(detectionScore),
     m_detectionScore(0.15), m_detectionThreshold(100.0), m_detectionTime(0.), m_detectorNames(detectorNames),
     m_detectors(), m_extractionTime(0.), m_extractorNames(extractorNames), m_extractors(), m_filteredMatches(),
-    m_filterType(filterType), m_imageFormat(jpgImageFormat), m_knnMatches(), m_mapOfImageId(), m_mapOfImages(),
+    m_filterType(filterType), m_guidedMatchingPose(), m_guidedMatchingPoseValid(false), m_guidedMatchingRadius(20.0),
+    m_guidedMatchingUsed(false), m_hammingIndex(), m_imageFormat(jpgImageFormat), m_knnMatches(), m_learningDataFiles(), m_mapOfImageId(),
+    m_mapOfImagePaths(), m_mapOfImages(),
     m_matcher(),
     m_matcherName(matcherName), m_matches(), m_matchingFactorThreshold(2.0), m_matchingRatioThreshold(0.85), m_matchingTime(0.),
     m_matchRansacKeyPointsToPoints(), m_nbRansacIterations(200), m_nbRansacMinInlierCount(100), m_objectFilteredPoints(),
     m_poseTime(0.), m_queryDescriptors(), m_queryFilteredKeyPoints(), m_queryKeyPoints(),
     m_ransacConsensusPercentage(20.0), m_ransacInliers(), m_ransacOutliers(), m_ransacReprojectionError(6.0),
     m_ransacThreshold(0.01), m_trainDescriptors(), m_trainKeyPoints(), m_trainPoints(),
-    m_trainVpPoints(), m_useAffineDetection(false),
+    m_trainVpPoints(), m_useAffineDetection(false), m_useAffineTiltRestriction(false),
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
     m_useBruteForceCrossCheck(true),
 #endif
-    m_useConsensusPercentage(false),
+    m_useConsensusPercentage(false), m_useGuidedMatching(false),
     m_useKnn(false), m_useMatchTrainToQuery(false), m_useRansacVVS(true), m_useSingleMatchFilter(true)
 {
   initFeatureNames();
@@ -396,11 +576,12 @@ vpKeyPoint::vpKeyPoint(const std::vector<std::string> &detectorNames, const std:
    Apply an affine and skew transformation to an image.
    \param tilt : Tilt value in the direction of x
    \param phi : Rotation value
-   \param img : Modified image after the transformation
+   \param img : Input image, left unchanged so that it can be shared by the views processed in parallel
+   \param timg : Image after the transformation
    \param mask : Mask containing the location of the image pixels after the transformation
    \param Ai : Inverse affine matrix
  */
-void vpKeyPoint::affineSkew(double tilt, double phi, cv::Mat& img,
+void vpKeyPoint::affineSkew(double tilt, double phi, const cv::Mat& img, cv::Mat& timg,
     cv::Mat& mask, cv::Mat& Ai) {
   int h = img.rows;
   int w = img.cols;
@@ -409,6 +590,9 @@ void vpKeyPoint::affineSkew(double tilt, double phi, cv::Mat& img,
 
   cv::Mat A = cv::Mat::eye(2, 3, CV_32F);
 
+  //The transformations read from img until the first one writes into timg
+  const cv::Mat *src = &img;
+
   //if (phi != 0.0) {
   if (std::fabs(phi) > std::numeric_limits<double>::epsilon()) {
     phi *= M_PI / 180.;
@@ -430,20 +614,26 @@ void vpKeyPoint::affineSkew(double tilt, double phi, cv::Mat& img,
     cv::Rect rect = cv::boundingRect(tcorners);
     A = (cv::Mat_<float>(2, 3) << c, -s, -rect.x, s, c, -rect.y);
 
-    cv::warpAffine(img, img, A, cv::Size(rect.width, rect.height),
+    cv::warpAffine(*src, timg, A, cv::Size(rect.width, rect.height),
         cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    src = &timg;
   }
   //if (tilt != 1.0) {
   if (std::fabs(tilt - 1.0) > std::numeric_limits<double>::epsilon()) {
     double s = 0.8 * sqrt(tilt * tilt - 1);
-    cv::GaussianBlur(img, img, cv::Size(0, 0), s, 0.01);
-    cv::resize(img, img, cv::Size(0, 0), 1.0 / tilt, 1.0, cv::INTER_NEAREST);
+    cv::Mat blurred;
+    cv::GaussianBlur(*src, blurred, cv::Size(0, 0), s, 0.01);
+    cv::resize(blurred, timg, cv::Size(0, 0), 1.0 / tilt, 1.0, cv::INTER_NEAREST);
+    src = &timg;
     A.row(0) = A.row(0) / tilt;
   }
-  //if (tilt != 1.0 || phi != 0.0) {
-  if (std::fabs(tilt - 1.0) > std::numeric_limits<double>::epsilon() || std::fabs(phi) > std::numeric_limits<double>::epsilon() ) {
-    h = img.rows;
-    w = img.cols;
+
+  if (src == &img) {
+    img.copyTo(timg);
+  } else {
+    //if (tilt != 1.0 || phi != 0.0) {
+    h = timg.rows;
+    w = timg.cols;
     cv::warpAffine(mask, mask, A, cv::Size(w, h), cv::INTER_NEAREST);
   }
   cv::invertAffineTransform(A, Ai);
@@ -488,32 +678,22 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   //So as no 3D point list is passed, we dont need this variables
   m_trainPoints.clear();
   m_mapOfImageId.clear();
+  m_mapOfImagePaths.clear();
   m_mapOfImages.clear();
   m_currentImageId = 1;
+  //The pose found with the previous reference can not guide the matching anymore
+  m_guidedMatchingPoseValid = false;
 
   if(m_useAffineDetection) {
     std::vector<std::vector<cv::KeyPoint> > listOfTrainKeyPoints;
     std::vector<cv::Mat> listOfTrainDescriptors;
 
-    //Detect keypoints and extract descriptors on multiple images
+    //Detect keypoints and extract descriptors on multiple images, with all the tilts
     detectExtractAffine(I, listOfTrainKeyPoints, listOfTrainDescriptors);
+    m_affineTiltLevel = 0;
 
     //Flatten the different train lists
-    m_trainKeyPoints.clear();
-    for(std::vector<std::vector<cv::KeyPoint> >::const_iterator it = listOfTrainKeyPoints.begin();
-        it != listOfTrainKeyPoints.end(); ++it) {
-      m_trainKeyPoints.insert(m_trainKeyPoints.end(), it->begin(), it->end());
-    }
-
-    bool first = true;
-    for(std::vector<cv::Mat>::const_iterator it = listOfTrainDescriptors.begin(); it != listOfTrainDescriptors.end(); ++it) {
-      if(first) {
-        first = false;
-        it->copyTo(m_trainDescriptors);
-      } else {
-        m_trainDescriptors.push_back(*it);
-      }
-    }
+    concatenateAffineViews(listOfTrainKeyPoints, listOfTrainDescriptors, m_trainKeyPoints, m_trainDescriptors);
   } else {
     detect(I, m_trainKeyPoints, m_detectionTime, rectangle);
     extract(I, m_trainKeyPoints, m_trainDescriptors, m_extractionTime);
@@ -534,8 +714,7 @@ unsigned int vpKeyPoint::buildReference(const vpImage<unsigned char> &I,
   _reference_computed = true;
 
   //Add train descriptors in matcher object
-  m_matcher->clear();
-  m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  trainMatcher();
 
   return static_cast<unsigned int>(m_trainKeyPoints.size());
 }
@@ -593,9 +772,13 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, std::vector<cv:
 void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vector<cv::KeyPoint> &trainKeyPoints,
                                 const cv::Mat &trainDescriptors, const std::vector<cv::Point3f> &points3f,
                                 const bool append, const int class_id) {
+  //The pose found with the previous reference can not guide the matching anymore
+  m_guidedMatchingPoseValid = false;
+
   if(!append) {
     m_currentImageId = 0;
     m_mapOfImageId.clear();
+    m_mapOfImagePaths.clear();
     m_mapOfImages.clear();
     this->m_trainKeyPoints.clear();
     this->m_trainPoints.clear();
@@ -635,8 +818,7 @@ void vpKeyPoint::buildReference(const vpImage<unsigned char> &I, const std::vect
   vpConvert::convertFromOpenCV(this->m_trainPoints, m_trainVpPoints);
 
   //Add train descriptors in matcher object
-  m_matcher->clear();
-  m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  trainMatcher();
 
   _reference_computed = true;
 }
@@ -1202,6 +1384,8 @@ void vpKeyPoint::createImageMatching(vpImage<unsigned char> &IRef, vpImage<unsig
    \param IMatching : Image initialized with appropriate size.
  */
 void vpKeyPoint::createImageMatching(vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching) {
+  loadTrainingImages();
+
   //Nb images in the training database + the current image we want to detect the object
   unsigned int nbImg = (unsigned int) (m_mapOfImages.size() + 1);
 
@@ -1398,6 +1582,8 @@ void vpKeyPoint::displayMatching(const vpImage<unsigned char> &IRef, vpImage<uns
  */
 void vpKeyPoint::displayMatching(const vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching,
                                  const std::vector<vpImagePoint> &ransacInliers, unsigned int crossSize, unsigned int lineThickness) {
+  loadTrainingImages();
+
   if(m_mapOfImages.empty() || m_mapOfImageId.empty()) {
     //No training images so return
     std::cerr << "There is no training image loaded !" << std::endl;
@@ -2280,6 +2466,22 @@ void vpKeyPoint::initFeatureNames() {
 #endif
 }
 
+/*!
+   Add the train descriptors to the matcher, and index them for the
+   "MultiIndexHashing" matcher.
+ */
+void vpKeyPoint::trainMatcher() {
+  m_matcher->clear();
+  m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+
+  if(m_matcherName == "MultiIndexHashing" && !m_trainDescriptors.empty()) {
+    cv::Mat train = m_trainDescriptors.isContinuous() ? m_trainDescriptors : m_trainDescriptors.clone();
+    m_hammingIndex.build(train.ptr<unsigned char>(0), (unsigned int) train.rows, (unsigned int) train.cols);
+  } else {
+    m_hammingIndex.clear();
+  }
+}
+
 /*!
    Initialize a matcher based on its name.
 
@@ -2319,6 +2521,13 @@ void vpKeyPoint::initMatcher(const std::string &matcherName) {
       m_matcher = new cv::FlannBasedMatcher(new cv::flann::KDTreeIndexParams());
 #endif
     }
+  } else if(matcherName == "MultiIndexHashing") {
+    if(!m_extractors.empty() && descriptorType != CV_8U) {
+      throw vpException(vpException::fatalError, "The MultiIndexHashing matcher requires binary descriptors !");
+    }
+
+    //Used when the train descriptors are matched to the query descriptors
+    m_matcher = cv::DescriptorMatcher::create("BruteForce-Hamming");
   } else {
     m_matcher = cv::DescriptorMatcher::create(matcherName);
   }
@@ -2361,6 +2570,8 @@ void vpKeyPoint::insertImageMatching(const vpImage<unsigned char> &IRef, const v
    detected in the training images
  */
 void vpKeyPoint::insertImageMatching(const vpImage<unsigned char> &ICurrent, vpImage<unsigned char> &IMatching) {
+  loadTrainingImages();
+
   //Nb images in the training database + the current image we want to detect the object
   int nbImg = (int) (m_mapOfImages.size() + 1);
 
@@ -2493,6 +2704,11 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 /*!
    Load learning data saved on disk.
 
+   The binary files written by saveLearningData() with \e mappedMode are memory mapped: the keypoints
+   and the 3D points are copied in one pass and the descriptors are used in place, without being read
+   and copied (see getTrainDescriptors()). The binary files of the former format are still read. The
+   training images are only loaded when they are needed, for instance to display the matching.
+
    \param filename : Path of the learning file.
    \param binaryMode : If true, the learning file is in a binary mode, otherwise it is in XML mode.
    \param append : If true, concatenate the learning data, otherwise reset the variables.
@@ -2500,10 +2716,14 @@ void vpKeyPoint::loadConfigFile(const std::string &configFile) {
 void vpKeyPoint::loadLearningData(const std::string &filename, const bool binaryMode, const bool append) {
   int startClassId = 0;
   int startImageId = 0;
+  //The pose found with the previous reference can not guide the matching anymore
+  m_guidedMatchingPoseValid = false;
+
   if(!append) {
     m_trainKeyPoints.clear();
     m_trainPoints.clear();
     m_mapOfImageId.clear();
+    m_mapOfImagePaths.clear();
     m_mapOfImages.clear();
   } else {
     //In append case, find the max index of keypoint class Id
@@ -2519,6 +2739,11 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
         startImageId = it->first;
       }
     }
+    for(std::map<int, std::string>::const_iterator it = m_mapOfImagePaths.begin(); it != m_mapOfImagePaths.end(); ++it) {
+      if(startImageId < it->first) {
+        startImageId = it->first;
+      }
+    }
   }
 
   //Get parent directory
@@ -2527,7 +2752,9 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
     parent += "/";
   }
 
-  if(binaryMode) {
+  if(binaryMode && isMappedLearningData(filename)) {
+    loadMappedLearningData(filename, parent, startClassId, startImageId, append);
+  } else if(binaryMode) {
     std::ifstream file(filename.c_str(), std::ifstream::binary);
     if(!file.is_open()){
       throw vpException(vpException::ioError, "Cannot open the file.");
@@ -2561,16 +2788,13 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
       }
       path[length] = '\0';
 
-      vpImage<unsigned char> I;
 #ifdef VISP_HAVE_MODULE_IO
+      //The image is loaded when needed, only if VISP_HAVE_MODULE_IO
       if(vpIoTools::isAbsolutePathname(std::string(path))) {
-        vpImageIo::read(I, path);
+        m_mapOfImagePaths[id + startImageId] = path;
       } else {
-        vpImageIo::read(I, parent + path);
+        m_mapOfImagePaths[id + startImageId] = parent + path;
       }
-
-      //Add the image previously loaded only if VISP_HAVE_MODULE_IO
-      m_mapOfImages[id + startImageId] = I;
 #endif
 
       //Delete path
@@ -2753,18 +2977,14 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
             }
             xmlFree(image_id_property);
 
-            vpImage<unsigned char> I;
 #ifdef VISP_HAVE_MODULE_IO
             std::string path((char *) image_info_node->children->content);
-            //Read path to the training images
+            //Read path to the training images, the image is loaded when needed
             if(vpIoTools::isAbsolutePathname(std::string(path))) {
-              vpImageIo::read(I, path);
+              m_mapOfImagePaths[id + startImageId] = path;
             } else {
-              vpImageIo::read(I, parent + path);
+              m_mapOfImagePaths[id + startImageId] = parent + path;
             }
-
-            //Add the image previously loaded only if VISP_HAVE_MODULE_IO
-            m_mapOfImages[id + startImageId] = I;
 #endif
           }
         }
@@ -2926,14 +3146,294 @@ void vpKeyPoint::loadLearningData(const std::string &filename, const bool binary
   vpConvert::convertFromOpenCV(this->m_trainPoints, m_trainVpPoints);
 
   //Add train descriptors in matcher object
-  m_matcher->clear();
-  m_matcher->add(std::vector<cv::Mat>(1, m_trainDescriptors));
+  trainMatcher();
 
   //Set _reference_computed to true as we load a learning file
   _reference_computed = true;
 
   //Set m_currentImageId
-   m_currentImageId = (int) m_mapOfImages.size();
+   m_currentImageId = (int) (m_mapOfImages.size() + m_mapOfImagePaths.size());
+}
+
+/*!
+   Load learning data saved by saveLearningData() in the memory mapped binary format. The
+   keypoints, the 3D points and the training image paths are appended to the current ones. The
+   descriptors are used in place when there are no other train descriptors, the file staying
+   mapped as long as they are used.
+
+   \param filename : Path of the learning file.
+   \param parent : Directory of the learning file, with a trailing separator, or empty string.
+   \param startClassId : Offset added to the class_id of the keypoints.
+   \param startImageId : Offset added to the training image ids.
+   \param append : If true, concatenate the descriptors to the current ones.
+ */
+void vpKeyPoint::loadMappedLearningData(const std::string &filename, const std::string &parent, const int startClassId,
+                                        const int startImageId, const bool append) {
+#ifdef VISP_LITTLE_ENDIAN
+  cv::Ptr<vpMemoryMappedFile> mappedFile(new vpMemoryMappedFile(filename));
+  unsigned char *data = mappedFile->getData();
+  uint64_t fileSize = (uint64_t) mappedFile->getSize();
+
+  LearningDataHeader header;
+  if(fileSize < sizeof(header)) {
+    throw vpException(vpException::ioError, "Corrupted learning data file: %s", filename.c_str());
+  }
+  memcpy(&header, data, sizeof(header));
+  if(header.version != learningDataVersion) {
+    throw vpException(vpException::ioError, "Unsupported version %u of learning data file: %s", header.version,
+                      filename.c_str());
+  }
+
+  uint64_t nbKeyPoints = header.nbKeyPoints > 0 ? (uint64_t) header.nbKeyPoints : 0;
+  int descriptorType = header.descriptorType;
+  if(header.nbKeyPoints < 0 || header.descriptorCols < 0 || header.nbImages < 0 ||
+     header.descriptorRowSize != (uint64_t) header.descriptorCols * CV_ELEM_SIZE(descriptorType) ||
+     header.keyPointsOffset + nbKeyPoints * sizeof(LearningDataKeyPoint) > fileSize ||
+     (header.have3DInfo && header.pointsOffset + nbKeyPoints * sizeof(cv::Point3f) > fileSize) ||
+     header.descriptorsOffset + nbKeyPoints * header.descriptorRowSize > fileSize ||
+     header.descriptorsOffset % 64 != 0 || header.imagesOffset > fileSize) {
+    throw vpException(vpException::ioError, "Corrupted learning data file: %s", filename.c_str());
+  }
+
+#if !defined(VISP_HAVE_MODULE_IO)
+  (void) parent;
+  if(header.nbImages > 0) {
+    std::cout << "Warning: The learning file contains image data that will not be loaded as visp_io module "
+        "is not available !" << std::endl;
+  }
+#endif
+
+  //Paths of the training images
+  uint64_t offset = header.imagesOffset;
+  for(int32_t i = 0; i < header.nbImages; i++) {
+    int32_t id = 0, length = 0;
+    if(offset + sizeof(id) + sizeof(length) > fileSize) {
+      throw vpException(vpException::ioError, "Corrupted learning data file: %s", filename.c_str());
+    }
+    memcpy(&id, data + offset, sizeof(id));
+    memcpy(&length, data + offset + sizeof(id), sizeof(length));
+    offset += sizeof(id) + sizeof(length);
+    if(length < 0 || offset + (uint64_t) length > fileSize) {
+      throw vpException(vpException::ioError, "Corrupted learning data file: %s", filename.c_str());
+    }
+#ifdef VISP_HAVE_MODULE_IO
+    std::string path((const char *) (data + offset), (size_t) length);
+    m_mapOfImagePaths[id + startImageId] = vpIoTools::isAbsolutePathname(path) ? path : parent + path;
+#endif
+    offset += (uint64_t) length;
+  }
+
+  //Keypoints and image ids, in one pass over the records
+  const LearningDataKeyPoint *records = (const LearningDataKeyPoint *) (data + header.keyPointsOffset);
+  m_trainKeyPoints.reserve(m_trainKeyPoints.size() + (size_t) nbKeyPoints);
+  for(size_t i = 0; i < (size_t) nbKeyPoints; i++) {
+    const LearningDataKeyPoint &record = records[i];
+    m_trainKeyPoints.push_back(cv::KeyPoint(cv::Point2f(record.u, record.v), record.size, record.angle,
+                                            record.response, record.octave, record.class_id + startClassId));
+#ifdef VISP_HAVE_MODULE_IO
+    //No training images if image_id == -1
+    if(record.image_id != -1) {
+      m_mapOfImageId[record.class_id + startClassId] = record.image_id + startImageId;
+    }
+#endif
+  }
+
+  //3D points, stored as cv::Point3f
+  if(header.have3DInfo) {
+    const cv::Point3f *points = (const cv::Point3f *) (data + header.pointsOffset);
+    m_trainPoints.insert(m_trainPoints.end(), points, points + nbKeyPoints);
+  }
+
+  //Descriptors used in place
+  size_t step = header.descriptorRowSize > 0 ? (size_t) header.descriptorRowSize : (size_t) cv::Mat::AUTO_STEP;
+  cv::Mat trainDescriptorsTmp(header.nbKeyPoints, header.descriptorCols, descriptorType, data + header.descriptorsOffset, step);
+  if(!append || m_trainDescriptors.empty()) {
+    //The files previously mapped are no more used once the matcher is trained with the new descriptors
+    m_trainDescriptors = trainDescriptorsTmp;
+    m_learningDataFiles.clear();
+    m_learningDataFiles.push_back(mappedFile);
+  } else {
+    cv::vconcat(m_trainDescriptors, trainDescriptorsTmp, m_trainDescriptors);
+  }
+#else
+  (void) parent; (void) startClassId; (void) startImageId; (void) append;
+  throw vpException(vpException::ioError, "Memory mapped learning data file %s can only be loaded on little endian "
+                    "machines", filename.c_str());
+#endif
+}
+
+/*!
+   Load the training images whose paths have been read in a learning data file, the images being
+   loaded only when they are needed.
+ */
+void vpKeyPoint::loadTrainingImages() {
+#ifdef VISP_HAVE_MODULE_IO
+  for(std::map<int, std::string>::const_iterator it = m_mapOfImagePaths.begin(); it != m_mapOfImagePaths.end(); ++it) {
+    vpImage<unsigned char> I;
+    vpImageIo::read(I, it->second);
+    m_mapOfImages[it->first] = I;
+  }
+#endif
+  m_mapOfImagePaths.clear();
+}
+
+/*!
+   Match the query descriptors to the train descriptors indexed in the
+   vpHammingIndex of the "MultiIndexHashing" matcher. With the ratioDistanceThreshold
+   filter, the ratio test is done during the search: only the kept matches are
+   stored in the list of k-nearest neighbors, with a second neighbor at an
+   infinite distance.
+
+   \param queryDescriptors : Query descriptors.
+   \param matches : Output list of matches.
+ */
+void vpKeyPoint::matchHammingIndex(const cv::Mat &queryDescriptors, std::vector<cv::DMatch> &matches) {
+  matches.clear();
+  m_knnMatches.clear();
+  if(queryDescriptors.empty()) {
+    return;
+  }
+  if(queryDescriptors.cols != (int) m_hammingIndex.getDescriptorSize() || queryDescriptors.depth() != CV_8U) {
+    throw vpException(vpException::dimensionError, "The query descriptors do not have the type of the train descriptors !");
+  }
+
+  cv::Mat query = queryDescriptors.isContinuous() ? queryDescriptors : queryDescriptors.clone();
+  const unsigned char *data = query.ptr<unsigned char>(0);
+  const unsigned int nbQueries = (unsigned int) query.rows;
+
+  if(m_useKnn && m_filterType == ratioDistanceThreshold) {
+    std::vector<vpHammingIndex::Match> hammingMatches;
+    m_hammingIndex.match(data, nbQueries, hammingMatches, m_matchingRatioThreshold);
+    for(std::vector<vpHammingIndex::Match>::const_iterator it = hammingMatches.begin(); it != hammingMatches.end(); ++it) {
+      std::vector<cv::DMatch> knn(2);
+      knn[0] = cv::DMatch((int) it->queryIdx, (int) it->trainIdx, (float) it->distance);
+      knn[1] = cv::DMatch((int) it->queryIdx, (int) it->trainIdx, FLT_MAX);
+      m_knnMatches.push_back(knn);
+      matches.push_back(knn[0]);
+    }
+  } else if(m_useKnn) {
+    std::vector<std::vector<vpHammingIndex::Match> > hammingMatches;
+    m_hammingIndex.knnMatch(data, nbQueries, 2, hammingMatches);
+    m_knnMatches.resize(hammingMatches.size());
+    for(size_t i = 0; i < hammingMatches.size(); i++) {
+      for(std::vector<vpHammingIndex::Match>::const_iterator it = hammingMatches[i].begin(); it != hammingMatches[i].end(); ++it) {
+        m_knnMatches[i].push_back(cv::DMatch((int) it->queryIdx, (int) it->trainIdx, (float) it->distance));
+      }
+    }
+    matches.resize(m_knnMatches.size());
+    std::transform(m_knnMatches.begin(), m_knnMatches.end(), matches.begin(), knnToDMatch);
+  } else {
+    std::vector<vpHammingIndex::Match> hammingMatches;
+    m_hammingIndex.match(data, nbQueries, hammingMatches);
+    for(std::vector<vpHammingIndex::Match>::const_iterator it = hammingMatches.begin(); it != hammingMatches.end(); ++it) {
+      matches.push_back(cv::DMatch((int) it->queryIdx, (int) it->trainIdx, (float) it->distance));
+    }
+  }
+}
+
+/*!
+   Match the query keypoints to the train keypoints whose 3D point projects, with the
+   pose estimated in the previous frame, closer than the guided matching radius. The
+   projections are sorted in a grid of the image with cells of the size of the radius,
+   so that only the neighboring cells of a query keypoint are searched.
+
+   \param cam : Camera parameters
+   \param height : Height of the image
+   \param width : Width of the image
+   \param matches : Output list of matches, the best candidate of each query keypoint.
+   \param elapsedTime : Elapsed time.
+ */
+void vpKeyPoint::guidedMatch(const vpCameraParameters &cam, const unsigned int height, const unsigned int width,
+                             std::vector<cv::DMatch> &matches, double &elapsedTime) {
+  double t = vpTime::measureTimeMs();
+  matches.clear();
+  m_knnMatches.clear();
+
+  //Sort the projections of the train points by cell, the cell index -1 marking the points out of the image
+  const int cellSize = (std::max)(1, (int) ceil(m_guidedMatchingRadius));
+  const int gridCols = (int) width / cellSize + 1, gridRows = (int) height / cellSize + 1;
+  std::vector<int> cellStarts((size_t) (gridCols * gridRows + 1), 0);
+  std::vector<int> cellOfPoint(m_trainPoints.size(), -1);
+  std::vector<cv::Point2f> projections(m_trainPoints.size());
+  const vpHomogeneousMatrix &cMo = m_guidedMatchingPose;
+  for(size_t i = 0; i < m_trainPoints.size(); i++) {
+    const cv::Point3f &P = m_trainPoints[i];
+    double X = cMo[0][0] * P.x + cMo[0][1] * P.y + cMo[0][2] * P.z + cMo[0][3];
+    double Y = cMo[1][0] * P.x + cMo[1][1] * P.y + cMo[1][2] * P.z + cMo[1][3];
+    double Z = cMo[2][0] * P.x + cMo[2][1] * P.y + cMo[2][2] * P.z + cMo[2][3];
+    if(Z <= 0.0) {
+      continue;
+    }
+
+    double u = 0.0, v = 0.0;
+    vpMeterPixelConversion::convertPoint(cam, X / Z, Y / Z, u, v);
+    if(u < 0.0 || v < 0.0 || u >= (double) width || v >= (double) height) {
+      continue;
+    }
+    projections[i] = cv::Point2f((float) u, (float) v);
+    cellOfPoint[i] = ((int) v / cellSize) * gridCols + (int) u / cellSize;
+    cellStarts[(size_t) cellOfPoint[i] + 1]++;
+  }
+  for(size_t c = 1; c < cellStarts.size(); c++) {
+    cellStarts[c] += cellStarts[c - 1];
+  }
+  std::vector<int> cellEntries((size_t) cellStarts.back());
+  std::vector<int> positions(cellStarts.begin(), cellStarts.end() - 1);
+  for(size_t i = 0; i < cellOfPoint.size(); i++) {
+    if(cellOfPoint[i] >= 0) {
+      cellEntries[(size_t) positions[(size_t) cellOfPoint[i]]++] = (int) i;
+    }
+  }
+
+  //Same distance as the matcher
+  int normType = cv::NORM_L2;
+  if(m_queryDescriptors.depth() == CV_8U) {
+    normType = (m_matcherName == "BruteForce-Hamming(2)") ? cv::NORM_HAMMING2 : cv::NORM_HAMMING;
+  } else if(m_matcherName == "BruteForce-L1") {
+    normType = cv::NORM_L1;
+  }
+
+  const float radius2 = (float) (m_guidedMatchingRadius * m_guidedMatchingRadius);
+  for(int q = 0; q < (int) m_queryKeyPoints.size(); q++) {
+    const cv::Point2f &pt = m_queryKeyPoints[(size_t) q].pt;
+    const int cellCol = (int) floor(pt.x / cellSize), cellRow = (int) floor(pt.y / cellSize);
+    cv::DMatch best(q, -1, FLT_MAX), second(q, -1, FLT_MAX);
+
+    for(int r = (std::max)(0, cellRow - 1); r <= (std::min)(gridRows - 1, cellRow + 1); r++) {
+      for(int c = (std::max)(0, cellCol - 1); c <= (std::min)(gridCols - 1, cellCol + 1); c++) {
+        const int cell = r * gridCols + c;
+        for(int e = cellStarts[(size_t) cell]; e < cellStarts[(size_t) cell + 1]; e++) {
+          const int i = cellEntries[(size_t) e];
+          const float dx = projections[(size_t) i].x - pt.x, dy = projections[(size_t) i].y - pt.y;
+          if(dx * dx + dy * dy > radius2) {
+            continue;
+          }
+
+          float d = (float) cv::norm(m_queryDescriptors.row(q), m_trainDescriptors.row(i), normType);
+          if(d < best.distance) {
+            second = best;
+            best = cv::DMatch(q, i, d);
+          } else if(d < second.distance) {
+            second = cv::DMatch(q, i, d);
+          }
+        }
+      }
+    }
+
+    if(best.trainIdx < 0) {
+      continue;
+    }
+
+    matches.push_back(best);
+    if(m_useKnn) {
+      //A single candidate in the search radius passes the ratio test
+      std::vector<cv::DMatch> knn(2, best);
+      knn[1] = second.trainIdx < 0 ? cv::DMatch(q, best.trainIdx, FLT_MAX) : second;
+      m_knnMatches.push_back(knn);
+    }
+  }
+
+  elapsedTime = vpTime::measureTimeMs() - t;
 }
 
 /*!
@@ -2948,6 +3448,12 @@ void vpKeyPoint::match(const cv::Mat &trainDescriptors, const cv::Mat &queryDesc
                        std::vector<cv::DMatch> &matches, double &elapsedTime) {
   double t = vpTime::measureTimeMs();
 
+  if(m_matcherName == "MultiIndexHashing" && !m_useMatchTrainToQuery && m_hammingIndex.getNbDescriptors() > 0) {
+    matchHammingIndex(queryDescriptors, matches);
+    elapsedTime = vpTime::measureTimeMs() - t;
+    return;
+  }
+
   if(m_useKnn) {
     m_knnMatches.clear();
 
@@ -3041,28 +3547,7 @@ unsigned int vpKeyPoint::matchPoint(const vpImage<unsigned char> &I,
   }
 
   if(m_useAffineDetection) {
-    std::vector<std::vector<cv::KeyPoint> > listOfQueryKeyPoints;
-    std::vector<cv::Mat> listOfQueryDescriptors;
-
-    //Detect keypoints and extract descriptors on multiple images
-    detectExtractAffine(I, listOfQueryKeyPoints, listOfQueryDescriptors);
-
-    //Flatten the different train lists
-    m_queryKeyPoints.clear();
-    for(std::vector<std::vector<cv::KeyPoint> >::const_iterator it = listOfQueryKeyPoints.begin();
-        it != listOfQueryKeyPoints.end(); ++it) {
-      m_queryKeyPoints.insert(m_queryKeyPoints.end(), it->begin(), it->end());
-    }
-
-    bool first = true;
-    for(std::vector<cv::Mat>::const_iterator it = listOfQueryDescriptors.begin(); it != listOfQueryDescriptors.end(); ++it) {
-      if(first) {
-        first = false;
-        it->copyTo(m_queryDescriptors);
-      } else {
-        m_queryDescriptors.push_back(*it);
-      }
-    }
+    detectExtractAffineQuery(I);
   } else {
     detect(I, m_queryKeyPoints, m_detectionTime, rectangle);
     extract(I, m_queryKeyPoints, m_queryDescriptors, m_extractionTime);
@@ -3101,6 +3586,10 @@ unsigned int vpKeyPoint::matchPoint(const vpImage<unsigned char> &I,
     }
   }
 
+  if(m_useAffineDetection) {
+    updateAffineTiltLevel();
+  }
+
   //Convert OpenCV type to ViSP type for compatibility
   vpConvert::convertFromOpenCV(m_queryFilteredKeyPoints, currentImagePointsList);
   vpConvert::convertFromOpenCV(m_filteredMatches, matchedReferencePoints);
@@ -3127,6 +3616,9 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
 
 /*!
    Match keypoints detected in the image with those built in the reference list and compute the pose.
+   With setUseGuidedMatching(), the keypoints are first matched around the projection of the train
+   points with the pose of the previous frame, and to the whole reference only if the pose can not
+   be computed from these matches.
 
    \param I : Input image
    \param cam : Camera parameters
@@ -3153,35 +3645,53 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
   }
 
   if(m_useAffineDetection) {
-    std::vector<std::vector<cv::KeyPoint> > listOfQueryKeyPoints;
-    std::vector<cv::Mat> listOfQueryDescriptors;
-
-    //Detect keypoints and extract descriptors on multiple images
-    detectExtractAffine(I, listOfQueryKeyPoints, listOfQueryDescriptors);
-
-    //Flatten the different train lists
-    m_queryKeyPoints.clear();
-    for(std::vector<std::vector<cv::KeyPoint> >::const_iterator it = listOfQueryKeyPoints.begin();
-        it != listOfQueryKeyPoints.end(); ++it) {
-      m_queryKeyPoints.insert(m_queryKeyPoints.end(), it->begin(), it->end());
-    }
-
-    bool first = true;
-    for(std::vector<cv::Mat>::const_iterator it = listOfQueryDescriptors.begin(); it != listOfQueryDescriptors.end(); ++it) {
-      if(first) {
-        first = false;
-        it->copyTo(m_queryDescriptors);
-      } else {
-        m_queryDescriptors.push_back(*it);
-      }
-    }
+    detectExtractAffineQuery(I);
   } else {
     detect(I, m_queryKeyPoints, m_detectionTime, rectangle);
     extract(I, m_queryKeyPoints, m_queryDescriptors, m_extractionTime);
   }
 
+  //Match the query keypoints close to the projection of the train points with the previous pose
+  double guidedMatchingTime = 0.0;
+  m_guidedMatchingUsed = false;
+  if(m_useGuidedMatching && m_guidedMatchingPoseValid && !m_useMatchTrainToQuery
+     && m_trainPoints.size() == m_trainKeyPoints.size()) {
+    guidedMatch(cam, I.getHeight(), I.getWidth(), m_matches, m_matchingTime);
+    if(filterMatchesAndComputePose(cam, cMo, error, elapsedTime, func)) {
+      m_guidedMatchingPose = cMo;
+      m_guidedMatchingUsed = true;
+      return true;
+    }
+    guidedMatchingTime = m_matchingTime;
+  }
+
+  //Global matching, also used when the guided matching failed
   match(m_trainDescriptors, m_queryDescriptors, m_matches, m_matchingTime);
+  m_matchingTime += guidedMatchingTime;
+
+  bool res = filterMatchesAndComputePose(cam, cMo, error, elapsedTime, func);
+  m_guidedMatchingPoseValid = res;
+  if(res) {
+    m_guidedMatchingPose = cMo;
+  }
 
+  return res;
+}
+
+/*!
+   Filter the matches between the query keypoints and the train keypoints and compute the pose.
+
+   \param cam : Camera parameters
+   \param cMo : Homogeneous matrix between the object frame and the camera frame
+   \param error : Reprojection mean square error (in pixel) between the 2D points and the projection of the 3D points with
+   the estimated pose
+   \param elapsedTime : Time to detect, extract, match and compute the pose
+   \param func : Function pointer to filter the pose in Ransac pose estimation, if we want to eliminate
+   the poses which do not respect some criterion
+   \return True if the pose estimation is OK, false otherwise
+ */
+bool vpKeyPoint::filterMatchesAndComputePose(const vpCameraParameters &cam, vpHomogeneousMatrix &cMo, double &error,
+                                             double &elapsedTime, bool (*func)(vpHomogeneousMatrix *)) {
   elapsedTime = m_detectionTime + m_extractionTime + m_matchingTime;
 
   if(m_filterType != noFilterMatching) {
@@ -3215,6 +3725,10 @@ bool vpKeyPoint::matchPoint(const vpImage<unsigned char> &I, const vpCameraParam
     }
   }
 
+  if(m_useAffineDetection) {
+    updateAffineTiltLevel();
+  }
+
   //Convert OpenCV type to ViSP type for compatibility
   vpConvert::convertFromOpenCV(m_queryFilteredKeyPoints, currentImagePointsList);
   vpConvert::convertFromOpenCV(m_filteredMatches, matchedReferencePoints);
@@ -3461,16 +3975,21 @@ bool vpKeyPoint::matchPointAndDetect(const vpImage<unsigned char> &I, const vpCa
                                      bool (*func)(vpHomogeneousMatrix *), const vpRect& rectangle) {
   bool isMatchOk = matchPoint(I, cam, cMo, error, elapsedTime, func, rectangle);
   if(isMatchOk) {
-    //Use the pose estimated to project the model points in the image
-    vpPoint pt;
-    vpImagePoint imPt;
-    std::vector<vpImagePoint> modelImagePoints(m_trainVpPoints.size());
-    size_t cpt = 0;
-    for(std::vector<vpPoint>::const_iterator it = m_trainVpPoints.begin(); it != m_trainVpPoints.end(); ++it, cpt++) {
-      pt = *it;
-      pt.project(cMo);
-      vpMeterPixelConversion::convertPoint(cam, pt.get_x(), pt.get_y(), imPt);
-      modelImagePoints[cpt] = imPt;
+    //Use the pose estimated to project the model points in the image, all at once
+    const size_t nbModelPoints = m_trainVpPoints.size();
+    std::vector<double> oX(nbModelPoints), oY(nbModelPoints), oZ(nbModelPoints);
+    for(size_t i = 0; i < nbModelPoints; i++) {
+      oX[i] = m_trainVpPoints[i].get_oX();
+      oY[i] = m_trainVpPoints[i].get_oY();
+      oZ[i] = m_trainVpPoints[i].get_oZ();
+    }
+    std::vector<double> x, y, u, v;
+    vpPoint::projectPoints(cMo, oX, oY, oZ, x, y);
+    vpMeterPixelConversion::convertPoints(cam, x, y, u, v);
+
+    std::vector<vpImagePoint> modelImagePoints(nbModelPoints);
+    for(size_t i = 0; i < nbModelPoints; i++) {
+      modelImagePoints[i].set_uv(u[i], v[i]);
     }
 
     //Build a polygon with the list of model image points to get the bounding box
@@ -3495,84 +4014,152 @@ bool vpKeyPoint::matchPointAndDetect(const vpImage<unsigned char> &I, const vpCa
   return isMatchOk;
 }
 
-/*!
-    Apply a set of affine transormations to the image, detect keypoints and
-    reproject them into initial image coordinates.
-    See http://www.ipol.im/pub/algo/my_affine_sift/ for the details.
-    See https://github.com/Itseez/opencv/blob/master/samples/python2/asift.py for the Python implementation by Itseez
-    and Matt Sheckells for the current implementation in C++.
-    \param I : Input image
-    \param listOfKeypoints : List of detected keypoints in the multiple images after affine transformations
-    \param listOfDescriptors : Corresponding list of descriptors
-    \param listOfAffineI : Optional parameter, list of images after affine transformations
- */
-void vpKeyPoint::detectExtractAffine(const vpImage<unsigned char> &I,std::vector<std::vector<cv::KeyPoint> >& listOfKeypoints,
-    std::vector<cv::Mat>& listOfDescriptors, std::vector<vpImage<unsigned char> > *listOfAffineI) {
-#if 0
-  cv::Mat img;
-  vpImageConvert::convert(I, img);
-  listOfKeypoints.clear();
-  listOfDescriptors.clear();
-
-  for (int tl = 1; tl < 6; tl++) {
-    double t = pow(2, 0.5 * tl);
-    for (int phi = 0; phi < 180; phi += (int)(72.0 / t)) {
-      std::vector<cv::KeyPoint> keypoints;
-      cv::Mat descriptors;
+/*
+  Detect the keypoints and extract the descriptors of the affine views with indexes in [start, end).
+  Each view is warped from the shared input image, and written at its index in the output lists
+  so that the result does not depend on the number of threads.
+
+  The detectors and the extractors of vpKeyPoint are OpenCV algorithms that may keep a state
+  between two calls, so a detector is only used by one thread at a time, and so is the set of
+  extractors. The warping and the detection with a detector can still run while another view
+  is being described.
+*/
+class vpKeyPoint::AffineViewBody : public vpParallelLoopBody {
+public:
+  AffineViewBody(vpKeyPoint &keyPoint, const cv::Mat &img, const std::vector<std::pair<double, int> > &listOfAffineParams,
+                 std::vector<std::vector<cv::KeyPoint> > &listOfKeypoints, std::vector<cv::Mat> &listOfDescriptors,
+                 std::vector<vpImage<unsigned char> > *listOfAffineI)
+    : m_keyPoint(keyPoint), m_img(img), m_listOfAffineParams(listOfAffineParams), m_listOfKeypoints(listOfKeypoints),
+      m_listOfDescriptors(listOfDescriptors), m_listOfAffineI(listOfAffineI)
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+      , m_detectorMutexes(), m_extractorMutex()
+#endif
+  {
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+    for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_keyPoint.m_detectors.begin();
+        it != m_keyPoint.m_detectors.end(); ++it) {
+      m_detectorMutexes[it->first] = new vpMutex;
+    }
+#endif
+  }
 
-      cv::Mat timg, mask, Ai;
-      img.copyTo(timg);
+  ~AffineViewBody() {
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+    for(std::map<std::string, vpMutex *>::iterator it = m_detectorMutexes.begin(); it != m_detectorMutexes.end(); ++it) {
+      delete it->second;
+    }
+#endif
+  }
 
-      affineSkew(t, phi, timg, mask, Ai);
+  void operator()(unsigned int start, unsigned int end) const {
+    for(unsigned int cpt = start; cpt < end; cpt++) {
+      std::vector<cv::KeyPoint> &keypoints = m_listOfKeypoints[cpt];
+      keypoints.clear();
 
+      cv::Mat timg, mask, Ai;
+      m_keyPoint.affineSkew(m_listOfAffineParams[cpt].first, m_listOfAffineParams[cpt].second, m_img, timg, mask, Ai);
 
-      if(listOfAffineI != NULL) {
+      if(m_listOfAffineI != NULL) {
         cv::Mat img_disp;
         bitwise_and(mask, timg, img_disp);
-        vpImage<unsigned char> tI;
-        vpImageConvert::convert(img_disp, tI);
-        listOfAffineI->push_back(tI);
+        vpImageConvert::convert(img_disp, (*m_listOfAffineI)[cpt]);
       }
-#if 0
-      cv::Mat img_disp;
-      cv::bitwise_and(mask, timg, img_disp);
-      cv::namedWindow( "Skew", cv::WINDOW_AUTOSIZE ); // Create a window for display.
-      cv::imshow( "Skew", img_disp );
-      cv::waitKey(0);
-#endif
 
-      for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin();
-          it != m_detectors.end(); ++it) {
+      for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_keyPoint.m_detectors.begin();
+          it != m_keyPoint.m_detectors.end(); ++it) {
         std::vector<cv::KeyPoint> kp;
-        it->second->detect(timg, kp, mask);
+        {
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+          vpMutex::vpScopedLock lock(*m_detectorMutexes.find(it->first)->second);
+#endif
+          it->second->detect(timg, kp, mask);
+        }
         keypoints.insert(keypoints.end(), kp.begin(), kp.end());
       }
 
-      double elapsedTime;
-      extract(timg, keypoints, descriptors, elapsedTime);
-
-      for(unsigned int i = 0; i < keypoints.size(); i++) {
-        cv::Point3f kpt(keypoints[i].pt.x, keypoints[i].pt.y, 1.f);
-        cv::Mat kpt_t = Ai * cv::Mat(kpt);
-        keypoints[i].pt.x = kpt_t.at<float>(0, 0);
-        keypoints[i].pt.y = kpt_t.at<float>(1, 0);
+      {
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+        vpMutex::vpScopedLock lock(m_extractorMutex);
+#endif
+        double elapsedTime;
+        m_keyPoint.extract(timg, keypoints, m_listOfDescriptors[cpt], elapsedTime);
       }
 
-      listOfKeypoints.push_back(keypoints);
-      listOfDescriptors.push_back(descriptors);
+      //Reproject the keypoints into the input image
+      const float a00 = Ai.at<float>(0, 0), a01 = Ai.at<float>(0, 1), a02 = Ai.at<float>(0, 2);
+      const float a10 = Ai.at<float>(1, 0), a11 = Ai.at<float>(1, 1), a12 = Ai.at<float>(1, 2);
+      for(size_t i = 0; i < keypoints.size(); i++) {
+        float x = keypoints[i].pt.x, y = keypoints[i].pt.y;
+        keypoints[i].pt.x = a00 * x + a01 * y + a02;
+        keypoints[i].pt.y = a10 * x + a11 * y + a12;
+      }
     }
   }
 
-#else
+private:
+  AffineViewBody(const AffineViewBody &);
+  AffineViewBody &operator=(const AffineViewBody &);
+
+  vpKeyPoint &m_keyPoint;
+  const cv::Mat &m_img;
+  const std::vector<std::pair<double, int> > &m_listOfAffineParams;
+  std::vector<std::vector<cv::KeyPoint> > &m_listOfKeypoints;
+  std::vector<cv::Mat> &m_listOfDescriptors;
+  std::vector<vpImage<unsigned char> > *m_listOfAffineI;
+#if defined(VP_KEYPOINT_HAVE_MUTEX)
+  std::map<std::string, vpMutex *> m_detectorMutexes;
+  mutable vpMutex m_extractorMutex;
+#endif
+};
+
+/*!
+    Apply a set of affine transormations to the image, detect keypoints and
+    reproject them into initial image coordinates.
+    See http://www.ipol.im/pub/algo/my_affine_sift/ for the details.
+    See https://github.com/Itseez/opencv/blob/master/samples/python2/asift.py for the Python implementation by Itseez
+    and Matt Sheckells for the current implementation in C++.
+
+    The simulated views are processed concurrently on the threads of vpThreadPool,
+    all the tilts being used.
+
+    \param I : Input image
+    \param listOfKeypoints : List of detected keypoints in the multiple images after affine transformations
+    \param listOfDescriptors : Corresponding list of descriptors
+    \param listOfAffineI : Optional parameter, list of images after affine transformations
+ */
+void vpKeyPoint::detectExtractAffine(const vpImage<unsigned char> &I,std::vector<std::vector<cv::KeyPoint> >& listOfKeypoints,
+    std::vector<cv::Mat>& listOfDescriptors, std::vector<vpImage<unsigned char> > *listOfAffineI) {
+  std::vector<int> listOfTiltLevels;
+  detectExtractAffine(I, 1, 5, listOfKeypoints, listOfDescriptors, listOfTiltLevels, listOfAffineI);
+}
+
+/*!
+    Apply the affine transformations whose tilt level is in [minTiltLevel, maxTiltLevel], the tilt
+    of level \e tl being \f$ 2^{tl/2} \f$, detect keypoints and reproject them into initial image coordinates.
+
+    \param I : Input image
+    \param minTiltLevel : Minimal tilt level, in [1, 5]
+    \param maxTiltLevel : Maximal tilt level, in [1, 5]
+    \param listOfKeypoints : List of detected keypoints in the multiple images after affine transformations
+    \param listOfDescriptors : Corresponding list of descriptors
+    \param listOfTiltLevels : Tilt level of each affine transformation
+    \param listOfAffineI : Optional parameter, list of images after affine transformations
+ */
+void vpKeyPoint::detectExtractAffine(const vpImage<unsigned char> &I, const int minTiltLevel, const int maxTiltLevel,
+                                     std::vector<std::vector<cv::KeyPoint> >& listOfKeypoints,
+                                     std::vector<cv::Mat>& listOfDescriptors, std::vector<int> &listOfTiltLevels,
+                                     std::vector<vpImage<unsigned char> > *listOfAffineI) {
   cv::Mat img;
   vpImageConvert::convert(I, img);
 
   //Create a vector for storing the affine skew parameters
   std::vector<std::pair<double, int> > listOfAffineParams;
-  for (int tl = 1; tl < 6; tl++) {
+  listOfTiltLevels.clear();
+  for (int tl = minTiltLevel; tl <= maxTiltLevel; tl++) {
     double t = pow(2, 0.5 * tl);
     for (int phi = 0; phi < 180; phi += (int)(72.0 / t)) {
       listOfAffineParams.push_back(std::pair<double, int>(t, phi));
+      listOfTiltLevels.push_back(tl);
     }
   }
 
@@ -3583,56 +4170,59 @@ void vpKeyPoint::detectExtractAffine(const vpImage<unsigned char> &I,std::vector
     listOfAffineI->resize(listOfAffineParams.size());
   }
 
-#ifdef VISP_HAVE_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int cpt = 0; cpt < static_cast<int>(listOfAffineParams.size()); cpt++) {
-    std::vector<cv::KeyPoint> keypoints;
-    cv::Mat descriptors;
+  //One view per task, the cost of a view depending on its tilt
+  AffineViewBody body(*this, img, listOfAffineParams, listOfKeypoints, listOfDescriptors, listOfAffineI);
+  vpThreadPool::parallelFor(0, (unsigned int) listOfAffineParams.size(), body, 0, 1);
+}
 
-    cv::Mat timg, mask, Ai;
-    img.copyTo(timg);
+/*!
+   Detect keypoints and extract descriptors in the affine views of the current image
+   and concatenate them in the query lists. With setUseAffineTiltRestriction(), only
+   the tilts around the one that gave the most matches in the previous frame are
+   simulated. The class_id of each query keypoint is set to the tilt level of its view.
 
-    affineSkew(listOfAffineParams[(size_t) cpt].first, listOfAffineParams[(size_t) cpt].second, timg, mask, Ai);
+   \param I : Input image
+ */
+void vpKeyPoint::detectExtractAffineQuery(const vpImage<unsigned char> &I) {
+  int minTiltLevel = 1, maxTiltLevel = 5;
+  if(m_useAffineTiltRestriction && m_affineTiltLevel > 0) {
+    minTiltLevel = (std::max)(1, m_affineTiltLevel - 1);
+    maxTiltLevel = (std::min)(5, m_affineTiltLevel + 1);
+  }
 
+  std::vector<std::vector<cv::KeyPoint> > listOfQueryKeyPoints;
+  std::vector<cv::Mat> listOfQueryDescriptors;
+  std::vector<int> listOfTiltLevels;
 
-    if(listOfAffineI != NULL) {
-      cv::Mat img_disp;
-      bitwise_and(mask, timg, img_disp);
-      vpImage<unsigned char> tI;
-      vpImageConvert::convert(img_disp, tI);
-      (*listOfAffineI)[(size_t) cpt] = tI;
-    }
+  double t = vpTime::measureTimeMs();
+  detectExtractAffine(I, minTiltLevel, maxTiltLevel, listOfQueryKeyPoints, listOfQueryDescriptors, listOfTiltLevels);
+  m_detectionTime = vpTime::measureTimeMs() - t;
+  m_extractionTime = 0.0;
 
-#if 0
-    cv::Mat img_disp;
-    cv::bitwise_and(mask, timg, img_disp);
-    cv::namedWindow( "Skew", cv::WINDOW_AUTOSIZE ); // Create a window for display.
-    cv::imshow( "Skew", img_disp );
-    cv::waitKey(0);
-#endif
+  //Flatten the different query lists
+  concatenateAffineViews(listOfQueryKeyPoints, listOfQueryDescriptors, m_queryKeyPoints, m_queryDescriptors,
+                         &listOfTiltLevels);
+}
 
-    for(std::map<std::string, cv::Ptr<cv::FeatureDetector> >::const_iterator it = m_detectors.begin();
-        it != m_detectors.end(); ++it) {
-      std::vector<cv::KeyPoint> kp;
-      it->second->detect(timg, kp, mask);
-      keypoints.insert(keypoints.end(), kp.begin(), kp.end());
+/*!
+   Keep the tilt level of the affine views that gave the most filtered matches,
+   used by setUseAffineTiltRestriction() to select the views of the next frame.
+   Without any match, all the tilts will be simulated.
+ */
+void vpKeyPoint::updateAffineTiltLevel() {
+  std::vector<unsigned int> nbMatches(6, 0);
+  for(std::vector<cv::KeyPoint>::const_iterator it = m_queryFilteredKeyPoints.begin(); it != m_queryFilteredKeyPoints.end(); ++it) {
+    if(it->class_id >= 1 && it->class_id <= 5) {
+      nbMatches[(size_t) it->class_id]++;
     }
+  }
 
-    double elapsedTime;
-    extract(timg, keypoints, descriptors, elapsedTime);
-
-    for(size_t i = 0; i < keypoints.size(); i++) {
-      cv::Point3f kpt(keypoints[i].pt.x, keypoints[i].pt.y, 1.f);
-      cv::Mat kpt_t = Ai * cv::Mat(kpt);
-      keypoints[i].pt.x = kpt_t.at<float>(0, 0);
-      keypoints[i].pt.y = kpt_t.at<float>(1, 0);
+  m_affineTiltLevel = 0;
+  for(int tl = 1; tl <= 5; tl++) {
+    if(nbMatches[(size_t) tl] > nbMatches[(size_t) m_affineTiltLevel]) {
+      m_affineTiltLevel = tl;
     }
-
-    listOfKeypoints[(size_t) cpt] = keypoints;
-    listOfDescriptors[(size_t) cpt] = descriptors;
   }
-#endif
 }
 
 /*!
@@ -3643,11 +4233,13 @@ void vpKeyPoint::reset() {
   referenceImagePointsList.clear(); currentImagePointsList.clear(); matchedReferencePoints.clear(); _reference_computed = false;
 
 
-  m_computeCovariance = false; m_covarianceMatrix = vpMatrix(); m_currentImageId = 0; m_detectionMethod = detectionScore;
+  m_affineTiltLevel = 0; m_computeCovariance = false; m_covarianceMatrix = vpMatrix(); m_currentImageId = 0; m_detectionMethod = detectionScore;
   m_detectionScore = 0.15; m_detectionThreshold = 100.0; m_detectionTime = 0.0; m_detectorNames.clear();
   m_detectors.clear(); m_extractionTime = 0.0; m_extractorNames.clear(); m_extractors.clear(); m_filteredMatches.clear();
   m_filterType = ratioDistanceThreshold;
-  m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_mapOfImageId.clear(); m_mapOfImages.clear();
+  m_guidedMatchingPose.eye(); m_guidedMatchingPoseValid = false; m_guidedMatchingRadius = 20.0; m_guidedMatchingUsed = false;
+  m_hammingIndex.clear(); m_imageFormat = jpgImageFormat; m_knnMatches.clear(); m_learningDataFiles.clear();
+  m_mapOfImageId.clear(); m_mapOfImagePaths.clear(); m_mapOfImages.clear();
   m_matcher = cv::Ptr<cv::DescriptorMatcher>(); m_matcherName = "BruteForce-Hamming";
   m_matches.clear(); m_matchingFactorThreshold = 2.0; m_matchingRatioThreshold = 0.85; m_matchingTime = 0.0;
   m_matchRansacKeyPointsToPoints.clear(); m_nbRansacIterations = 200; m_nbRansacMinInlierCount = 100;
@@ -3655,11 +4247,11 @@ void vpKeyPoint::reset() {
   m_poseTime = 0.0; m_queryDescriptors = cv::Mat(); m_queryFilteredKeyPoints.clear(); m_queryKeyPoints.clear();
   m_ransacConsensusPercentage = 20.0; m_ransacInliers.clear(); m_ransacOutliers.clear(); m_ransacReprojectionError = 6.0;
   m_ransacThreshold = 0.01; m_trainDescriptors = cv::Mat(); m_trainKeyPoints.clear(); m_trainPoints.clear();
-  m_trainVpPoints.clear(); m_useAffineDetection = false;
+  m_trainVpPoints.clear(); m_useAffineDetection = false; m_useAffineTiltRestriction = false;
 #if (VISP_HAVE_OPENCV_VERSION >= 0x020400 && VISP_HAVE_OPENCV_VERSION < 0x030000)
   m_useBruteForceCrossCheck = true;
 #endif
-  m_useConsensusPercentage = false;
+  m_useConsensusPercentage = false; m_useGuidedMatching = false;
   m_useKnn = true; //as m_filterType == ratioDistanceThreshold
   m_useMatchTrainToQuery = false; m_useRansacVVS = true; m_useSingleMatchFilter = true;
 
@@ -3672,11 +4264,19 @@ void vpKeyPoint::reset() {
 /*!
    Save the learning data in a file in XML or binary mode.
 
+   By default, the binary file is written in the format read by all the ViSP releases. With \e mappedMode,
+   it is written in a versioned format with sections aligned on 64 bytes, that loadLearningData() maps in
+   memory to use the descriptors in place. This format can only be read by the ViSP releases that
+   introduced it, and only on little endian machines: on big endian machines, the former binary format
+   is written.
+
    \param filename : Path of the save file
    \param binaryMode : If true, the data are saved in binary mode, otherwise in XML mode
    \param saveTrainingImages : If true, save also the training images on disk
+   \param mappedMode : If true and in binary mode, the data are saved in the memory mapped format.
  */
-void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages) {
+void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode, const bool saveTrainingImages,
+                                  const bool mappedMode) {
   std::string parent = vpIoTools::getParent(filename);
   if(!parent.empty()) {
     vpIoTools::makeDirectory(parent);
@@ -3685,6 +4285,8 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
   std::map<int, std::string> mapOfImgPath;
   if(saveTrainingImages) {
 #ifdef VISP_HAVE_MODULE_IO
+    loadTrainingImages();
+
     //Save the training image files in the same directory
     int cpt = 0;
 
@@ -3735,6 +4337,64 @@ void vpKeyPoint::saveLearningData(const std::string &filename, bool binaryMode,
     throw vpException(vpException::fatalError, "List of keypoints and list of 3D points have different size !");
   }
 
+#ifdef VISP_LITTLE_ENDIAN
+  if(binaryMode && mappedMode) {
+    if(m_trainKeyPoints.size() != (size_t) m_trainDescriptors.rows) {
+      throw vpException(vpException::fatalError, "List of keypoints and list of descriptors have different size !");
+    }
+
+    std::vector<int> imageIds(m_trainKeyPoints.size(), -1);
+#ifdef VISP_HAVE_MODULE_IO
+    if(saveTrainingImages) {
+      for(size_t i = 0; i < m_trainKeyPoints.size(); i++) {
+        std::map<int, int>::const_iterator it_findImgId = m_mapOfImageId.find(m_trainKeyPoints[i].class_id);
+        if(it_findImgId != m_mapOfImageId.end()) {
+          imageIds[i] = it_findImgId->second;
+        }
+      }
+    }
+#endif
+
+    //The descriptors may be those of the file mapped by loadLearningData(): they are written in a
+    //temporary file that replaces the file afterwards
+    std::string tmpFilename = filename + ".tmp";
+    std::ofstream file(tmpFilename.c_str(), std::ofstream::binary);
+    if(!file.is_open()) {
+      throw vpException(vpException::ioError, "Cannot create the file.");
+    }
+
+    try {
+      writeMappedLearningData(file, mapOfImgPath, m_trainKeyPoints, imageIds, m_trainPoints, m_trainDescriptors);
+    }
+    catch(...) {
+      file.close();
+      std::remove(tmpFilename.c_str());
+      throw;
+    }
+
+    //A mapped file can not be removed or replaced on Windows: the descriptors are copied and the
+    //learning data files are unmapped before replacing the file
+    if(!m_learningDataFiles.empty()) {
+      m_trainDescriptors = m_trainDescriptors.clone();
+      trainMatcher();
+      m_learningDataFiles.clear();
+    }
+
+    if(std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+      //An existing file is not replaced on Windows
+      std::remove(filename.c_str());
+      if(std::rename(tmpFilename.c_str(), filename.c_str()) != 0) {
+        std::remove(tmpFilename.c_str());
+        throw vpException(vpException::ioError, "Cannot create the file.");
+      }
+    }
+  } else
+#else
+  if(binaryMode && mappedMode) {
+    std::cout << "Warning: in vpKeyPoint::saveLearningData() the memory mapped format is only supported on "
+        "little endian machines, the learning data are saved in the former binary format !" << std::endl;
+  }
+#endif
   if(binaryMode) {
     //Save the learning data into little endian binary file.
     std::ofstream file(filename.c_str(), std::ofstream::binary);
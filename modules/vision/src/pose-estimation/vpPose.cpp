@@ -52,6 +52,7 @@ pour faire du calcul de pose par difference methode
 #include <visp3/core/vpDisplay.h>
 #include <visp3/core/vpMath.h>
 
+#include <algorithm> // std::min
 #include <cmath>    // std::fabs
 #include <limits>   // numeric_limits
 
@@ -67,6 +68,8 @@ vpPose::init()
 #endif
   npt = 0 ;
   listP.clear();
+  listOfPoints.clear();
+  pointArray.clear();
   c3d.clear();
 
   lambda = 0.25 ;
@@ -94,7 +97,8 @@ vpPose::vpPose()
     computeCovariance(false), covarianceMatrix(),
     ransacNbInlierConsensus(4), ransacMaxTrials(1000), ransacInliers(), ransacInlierIndex(), ransacThreshold(0.0001),
     distanceToPlaneForCoplanarityTest(0.001), ransacFlags(PREFILTER_DUPLICATE_POINTS),
-    listOfPoints(), useParallelRansac(false), nbParallelRansacThreads(0) //0 means that OpenMP is used to get the number of CPU threads
+    listOfPoints(), useParallelRansac(false), nbParallelRansacThreads(0), //0 means vpThreadPool::getConcurrency()
+    ransacProbability(1.0), ransacTimeBudget(0), useRansacSprt(false), pointArray()
 {
 #if (DEBUG_LEVEL1)
   std::cout << "begin vpPose::vpPose() " << std::endl ;
@@ -130,6 +134,8 @@ void
 vpPose::clearPoint()
 {
   listP.clear();
+  listOfPoints.clear();
+  pointArray.clear();
   npt = 0 ;
 }
 
@@ -146,6 +152,7 @@ vpPose::addPoint(const vpPoint& newP)
 {
   listP.push_back(newP);
   listOfPoints.push_back(newP);
+  pointArray.push_back(newP);
   npt++ ;
 }
 
@@ -161,6 +168,10 @@ void
 vpPose::addPoints(const std::vector<vpPoint> &lP) {
   listP.insert(listP.end(), lP.begin(), lP.end());
   listOfPoints.insert(listOfPoints.end(), lP.begin(), lP.end());
+  pointArray.reserve(pointArray.size() + lP.size());
+  for (std::vector<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it) {
+    pointArray.push_back(*it);
+  }
   npt = (unsigned int) listP.size();
 }
 
@@ -328,6 +339,11 @@ vpPose::coplanar(int &coplanar_plane_type)
 \brief Compute and return the residual expressed in meter for
 the pose matrix 'cMo'.
 
+The coordinates of the points are kept contiguously when they are added with
+addPoint() or addPoints(). As in poseRansac(), only a change of the number of
+points of listP is detected: a point of listP modified in place is not taken
+into account.
+
 \param cMo : Input pose. The matrix that defines the pose to be tested.
 
 \return The value of he residual in meter.
@@ -336,19 +352,54 @@ the pose matrix 'cMo'.
 double
 vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
 {
-  double residual_ = 0 ;
-  vpPoint P ;
-  for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it)
-  {
-    P = *it;
-    double x = P.get_x() ;
-    double y = P.get_y() ;
-
-    P.track(cMo) ;
+  //Check only for adding / removing problem, as in poseRansac(): listP should not be modified
+  if (pointArray.size() != listP.size()) {
+    pointArray.clear();
+    pointArray.reserve(listP.size());
+    for(std::list<vpPoint>::const_iterator it=listP.begin(); it != listP.end(); ++it) {
+      pointArray.push_back(*it);
+    }
+  }
+  return computeSquaredErrors(cMo, pointArray, 0, pointArray.size(), NULL);
+}
 
-    residual_ += vpMath::sqr(x-P.get_x()) + vpMath::sqr(y-P.get_y())  ;
+/*!
+  Compute the squared reprojection errors of the points in [start, end[ for the
+  pose \e cMo. The points are projected in the image plane by blocks directly
+  from the contiguous arrays with vpPoint::projectPoints().
+
+  \param cMo : Pose to evaluate.
+  \param points : Coordinates of the points in the object frame and in the image plane.
+  \param start, end : Range of the points to consider.
+  \param errors : If not NULL, the squared reprojection error of the point i is
+  stored in errors[i].
+  \return The sum of the squared reprojection errors.
+*/
+double
+vpPose::computeSquaredErrors(const vpHomogeneousMatrix &cMo, const PointArray &points,
+                             const size_t start, const size_t end, double *errors)
+{
+  //Number of points projected at once
+  const size_t blockSize = 64;
+  double xp[blockSize], yp[blockSize];
+
+  double sum = 0;
+  for (size_t i = start; i < end; i += blockSize) {
+    const size_t nb = std::min(blockSize, end - i);
+    vpPoint::projectPoints(cMo, &points.oX[i], &points.oY[i], &points.oZ[i], (unsigned int) nb, xp, yp);
+
+    const double *x = &points.x[i];
+    const double *y = &points.y[i];
+    for (size_t j = 0; j < nb; j++) {
+      const double err = vpMath::sqr(xp[j] - x[j]) + vpMath::sqr(yp[j] - y[j]);
+      if (errors != NULL) {
+        errors[i + j] = err;
+      }
+      sum += err;
+    }
   }
-  return residual_ ;
+
+  return sum;
 }
 
 
@@ -366,6 +417,10 @@ vpPose::computeResidual(const vpHomogeneousMatrix &cMo) const
   - vpPose::DEMENTHON_VIRTUAL_VS: Non linear virtual visual servoing approach initialized by Dementhon approach
   - vpPose::LAGRANGE_VIRTUAL_VS: Non linear virtual visual servoing approach initialized by Lagrange approach
   - vpPose::RANSAC: Robust Ransac aproach (does't need an initialization)
+  - vpPose::P3P: Minimal three points approach, the other points are used to select
+    the solution among the P3P solutions (doesn't need an initialization)
+  - vpPose::EPNP: Linear EPnP approach (doesn't need an initialization). With coplanar
+    points the Lagrange or Dementhon planar approach is used.
 
 */
 bool
@@ -498,6 +553,12 @@ vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix& cMo, bool (*fu
       throw ;
     }
     break;
+  case P3P:
+    poseP3P(cMo);
+    break;
+  case EPNP:
+    poseEPnP(cMo);
+    break;
   case LOWE :
   case VIRTUAL_VS:
     break ;
@@ -508,6 +569,8 @@ vpPose::computePose(vpPoseMethodType method, vpHomogeneousMatrix& cMo, bool (*fu
   case LAGRANGE :
   case DEMENTHON :
   case RANSAC :
+  case P3P :
+  case EPNP :
     break ;
   case VIRTUAL_VS:
   case LAGRANGE_VIRTUAL_VS:
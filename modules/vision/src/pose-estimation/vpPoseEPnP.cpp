@@ -0,0 +1,365 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation with the EPnP method.
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseEPnP.cpp
+  \brief Non iterative O(n) pose computation (EPnP).
+*/
+
+#include <float.h>  // DBL_MAX
+#include <limits>   // numeric_limits
+
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpMatrix.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+namespace {
+  // Pairs of control points used to build the distance constraints
+  const unsigned int epnpPairs[6][2] = { {0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3} };
+
+  /*
+    Least squares solution of A x = b.
+  */
+  vpColVector solveLeastSquares(const vpMatrix &A, const vpColVector &b)
+  {
+    return A.pseudoInverse(1e-12) * b;
+  }
+
+  /*
+    Build the 6x10 matrix that relates the squared distances between the control
+    points to the products of the betas:
+    [B11 B12 B22 B13 B23 B33 B14 B24 B34 B44].
+  */
+  void computeL6x10(const vpColVector ker[4], vpMatrix &L)
+  {
+    L.resize(6, 10);
+    double dv[4][6][3];
+    for (unsigned int i = 0; i < 4; i++) {
+      for (unsigned int j = 0; j < 6; j++) {
+        unsigned int a = epnpPairs[j][0], b = epnpPairs[j][1];
+        for (unsigned int k = 0; k < 3; k++)
+          dv[i][j][k] = ker[i][3*a+k] - ker[i][3*b+k];
+      }
+    }
+
+    for (unsigned int j = 0; j < 6; j++) {
+      double dot[4][4];
+      for (unsigned int m = 0; m < 4; m++)
+        for (unsigned int n = m; n < 4; n++)
+          dot[m][n] = dv[m][j][0] * dv[n][j][0] + dv[m][j][1] * dv[n][j][1] + dv[m][j][2] * dv[n][j][2];
+
+      L[j][0] = dot[0][0];
+      L[j][1] = 2. * dot[0][1];
+      L[j][2] = dot[1][1];
+      L[j][3] = 2. * dot[0][2];
+      L[j][4] = 2. * dot[1][2];
+      L[j][5] = dot[2][2];
+      L[j][6] = 2. * dot[0][3];
+      L[j][7] = 2. * dot[1][3];
+      L[j][8] = 2. * dot[2][3];
+      L[j][9] = dot[3][3];
+    }
+  }
+
+  /*
+    Gauss-Newton refinement of the betas minimizing the error on the distances
+    between the control points.
+  */
+  void gaussNewton(const vpMatrix &L, const vpColVector &rho, double betas[4])
+  {
+    vpMatrix A(6, 4);
+    vpColVector b(6);
+    for (unsigned int iter = 0; iter < 5; iter++) {
+      for (unsigned int i = 0; i < 6; i++) {
+        const double *l = L[i];
+        A[i][0] = 2 * l[0] * betas[0] + l[1] * betas[1] + l[3] * betas[2] + l[6] * betas[3];
+        A[i][1] = l[1] * betas[0] + 2 * l[2] * betas[1] + l[4] * betas[2] + l[7] * betas[3];
+        A[i][2] = l[3] * betas[0] + l[4] * betas[1] + 2 * l[5] * betas[2] + l[8] * betas[3];
+        A[i][3] = l[6] * betas[0] + l[7] * betas[1] + l[8] * betas[2] + 2 * l[9] * betas[3];
+
+        b[i] = rho[i] - (l[0] * betas[0] * betas[0] + l[1] * betas[0] * betas[1] + l[2] * betas[1] * betas[1]
+                         + l[3] * betas[0] * betas[2] + l[4] * betas[1] * betas[2] + l[5] * betas[2] * betas[2]
+                         + l[6] * betas[0] * betas[3] + l[7] * betas[1] * betas[3] + l[8] * betas[2] * betas[3]
+                         + l[9] * betas[3] * betas[3]);
+      }
+      vpColVector dx = solveLeastSquares(A, b);
+      for (unsigned int i = 0; i < 4; i++)
+        betas[i] += dx[i];
+    }
+  }
+
+  /*
+    Initial betas for the different dimensions of the kernel.
+    N=1: betas_approx_1 uses [B11 B12 B13 B14]
+    N=2: betas_approx_2 uses [B11 B12 B22]
+    N=3: betas_approx_3 uses [B11 B12 B22 B13 B23]
+  */
+  void findBetas(const vpMatrix &L, const vpColVector &rho, const unsigned int approx, double betas[4])
+  {
+    const unsigned int cols1[4] = { 0, 1, 3, 6 };
+    const unsigned int cols2[3] = { 0, 1, 2 };
+    const unsigned int cols3[5] = { 0, 1, 2, 3, 4 };
+    const unsigned int *cols = (approx == 1) ? cols1 : (approx == 2 ? cols2 : cols3);
+    unsigned int nbCols = (approx == 1) ? 4 : (approx == 2 ? 3 : 5);
+
+    vpMatrix Lsub(6, nbCols);
+    for (unsigned int i = 0; i < 6; i++)
+      for (unsigned int j = 0; j < nbCols; j++)
+        Lsub[i][j] = L[i][cols[j]];
+    vpColVector B = solveLeastSquares(Lsub, rho);
+
+    betas[0] = betas[1] = betas[2] = betas[3] = 0.;
+    if (approx == 1) {
+      if (B[0] < 0) {
+        betas[0] = sqrt(-B[0]);
+        for (unsigned int i = 1; i < 4; i++)
+          betas[i] = -B[i] / betas[0];
+      }
+      else {
+        betas[0] = sqrt(B[0]);
+        for (unsigned int i = 1; i < 4; i++)
+          betas[i] = (betas[0] > 0) ? B[i] / betas[0] : 0.;
+      }
+      if (betas[0] == 0.) {
+        betas[1] = betas[2] = betas[3] = 0.;
+      }
+    }
+    else {
+      if (B[0] < 0) {
+        betas[0] = sqrt(-B[0]);
+        betas[1] = (B[2] < 0) ? sqrt(-B[2]) : 0.;
+      }
+      else {
+        betas[0] = sqrt(B[0]);
+        betas[1] = (B[2] > 0) ? sqrt(B[2]) : 0.;
+      }
+      if (B[1] < 0)
+        betas[0] = -betas[0];
+      if (approx == 3 && std::fabs(betas[0]) > 0)
+        betas[2] = B[3] / betas[0];
+    }
+  }
+}
+
+/*!
+  Compute the pose with the EPnP method \cite Lepetit09.
+
+  The 3D points are expressed as a weighted sum of four virtual control points.
+  The pose is then given by the coordinates of these control points in the
+  camera frame, that lie in the kernel of a 2n x 12 matrix. The complexity is
+  linear in the number of points, which makes this method well suited to
+  estimate the pose from a large set of points, for example to refine the
+  solution of the RANSAC on all the inliers.
+
+  The 3D points should not be coplanar. With coplanar points, the pose is
+  computed with the Lagrange approach if the points lie in a plane x, y or z=cst,
+  and with the Dementhon approach otherwise.
+
+  \param cMo : Computed pose.
+
+  \exception vpPoseException::notEnoughPointError : Less than 4 points.
+*/
+void vpPose::poseEPnP(vpHomogeneousMatrix &cMo)
+{
+  unsigned int n = (unsigned int)listP.size();
+  if (n < 4) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError,
+                          "EPnP needs at least 4 points"));
+  }
+
+  int coplanar_plane_type = 0;
+  if (coplanar(coplanar_plane_type)) {
+    if (coplanar_plane_type == 4) {
+      throw(vpPoseException(vpPoseException::notEnoughPointError, "Points are collinear"));
+    }
+    if (coplanar_plane_type > 0)
+      poseLagrangePlan(cMo, coplanar_plane_type);
+    else
+      poseDementhonPlan(cMo);
+    return;
+  }
+
+  std::vector<double> pw(3*n), uv(2*n), alphas(4*n);
+  unsigned int i = 0;
+  for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it, i++) {
+    pw[3*i]   = it->get_oX();
+    pw[3*i+1] = it->get_oY();
+    pw[3*i+2] = it->get_oZ();
+    uv[2*i]   = it->get_x();
+    uv[2*i+1] = it->get_y();
+  }
+
+  // Control points: centroid and principal directions of the 3D points
+  double cw[4][3] = { {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0} };
+  for (i = 0; i < n; i++)
+    for (unsigned int k = 0; k < 3; k++)
+      cw[0][k] += pw[3*i+k] / n;
+
+  vpMatrix PtP(3, 3, 0.);
+  for (i = 0; i < n; i++) {
+    double d[3] = { pw[3*i] - cw[0][0], pw[3*i+1] - cw[0][1], pw[3*i+2] - cw[0][2] };
+    for (unsigned int r = 0; r < 3; r++)
+      for (unsigned int c = 0; c < 3; c++)
+        PtP[r][c] += d[r] * d[c];
+  }
+  vpColVector w;
+  vpMatrix V;
+  PtP.svd(w, V);
+  for (unsigned int j = 1; j < 4; j++) {
+    double k = sqrt(w[j-1] / n);
+    for (unsigned int r = 0; r < 3; r++)
+      cw[j][r] = cw[0][r] + k * V[r][j-1];
+  }
+
+  // Barycentric coordinates of the points with respect to the control points
+  vpMatrix CC(3, 3);
+  for (unsigned int r = 0; r < 3; r++)
+    for (unsigned int c = 0; c < 3; c++)
+      CC[r][c] = cw[c+1][r] - cw[0][r];
+  vpMatrix CC_inv = CC.inverseByLU();
+  for (i = 0; i < n; i++) {
+    double d[3] = { pw[3*i] - cw[0][0], pw[3*i+1] - cw[0][1], pw[3*i+2] - cw[0][2] };
+    double sum = 0;
+    for (unsigned int j = 0; j < 3; j++) {
+      alphas[4*i+j+1] = CC_inv[j][0] * d[0] + CC_inv[j][1] * d[1] + CC_inv[j][2] * d[2];
+      sum += alphas[4*i+j+1];
+    }
+    alphas[4*i] = 1. - sum;
+  }
+
+  // M^T M where M is the 2n x 12 matrix of the projection equations
+  vpMatrix MtM(12, 12, 0.);
+  for (i = 0; i < n; i++) {
+    double row[2][12];
+    for (unsigned int j = 0; j < 4; j++) {
+      double a = alphas[4*i+j];
+      row[0][3*j] = a;  row[0][3*j+1] = 0.; row[0][3*j+2] = -a * uv[2*i];
+      row[1][3*j] = 0.; row[1][3*j+1] = a;  row[1][3*j+2] = -a * uv[2*i+1];
+    }
+    for (unsigned int l = 0; l < 2; l++)
+      for (unsigned int r = 0; r < 12; r++)
+        if (row[l][r] != 0.)
+          for (unsigned int c = 0; c < 12; c++)
+            MtM[r][c] += row[l][r] * row[l][c];
+  }
+
+  // Kernel: right singular vectors associated to the four smallest singular values
+  MtM.svd(w, V);
+  std::vector<unsigned int> order(12);
+  for (unsigned int j = 0; j < 12; j++)
+    order[j] = j;
+  for (unsigned int j = 0; j < 12; j++)
+    for (unsigned int l = j+1; l < 12; l++)
+      if (w[order[l]] < w[order[j]])
+        std::swap(order[j], order[l]);
+
+  vpColVector ker[4];
+  for (unsigned int j = 0; j < 4; j++)
+    ker[j] = V.getCol(order[j]);
+
+  vpMatrix L;
+  computeL6x10(ker, L);
+  vpColVector rho(6);
+  for (unsigned int j = 0; j < 6; j++) {
+    unsigned int a = epnpPairs[j][0], b = epnpPairs[j][1];
+    rho[j] = vpMath::sqr(cw[a][0] - cw[b][0]) + vpMath::sqr(cw[a][1] - cw[b][1]) + vpMath::sqr(cw[a][2] - cw[b][2]);
+  }
+
+  double best_error = DBL_MAX;
+  for (unsigned int approx = 1; approx <= 3; approx++) {
+    double betas[4];
+    findBetas(L, rho, approx, betas);
+    gaussNewton(L, rho, betas);
+
+    // Control points and points in the camera frame
+    double cc[4][3];
+    for (unsigned int j = 0; j < 4; j++)
+      for (unsigned int k = 0; k < 3; k++)
+        cc[j][k] = betas[0] * ker[0][3*j+k] + betas[1] * ker[1][3*j+k] + betas[2] * ker[2][3*j+k] + betas[3] * ker[3][3*j+k];
+
+    std::vector<double> pc(3*n);
+    for (i = 0; i < n; i++)
+      for (unsigned int k = 0; k < 3; k++)
+        pc[3*i+k] = alphas[4*i] * cc[0][k] + alphas[4*i+1] * cc[1][k] + alphas[4*i+2] * cc[2][k] + alphas[4*i+3] * cc[3][k];
+
+    // Points have to be in front of the camera
+    if (pc[2] < 0) {
+      for (i = 0; i < 3*n; i++)
+        pc[i] = -pc[i];
+    }
+
+    // Absolute orientation between the points in the object and camera frames
+    double pc0[3] = {0, 0, 0}, pw0[3] = {0, 0, 0};
+    for (i = 0; i < n; i++)
+      for (unsigned int k = 0; k < 3; k++) {
+        pc0[k] += pc[3*i+k] / n;
+        pw0[k] += pw[3*i+k] / n;
+      }
+    vpMatrix ABt(3, 3, 0.);
+    for (i = 0; i < n; i++)
+      for (unsigned int r = 0; r < 3; r++)
+        for (unsigned int c = 0; c < 3; c++)
+          ABt[r][c] += (pc[3*i+r] - pc0[r]) * (pw[3*i+c] - pw0[c]);
+
+    vpMatrix U = ABt;
+    vpColVector D;
+    vpMatrix Vt;
+    U.svd(D, Vt);
+    vpMatrix R = U * Vt.t();
+    if (R.det() < 0) {
+      // Reflection: change the sign of the singular vector of the smallest singular value
+      unsigned int jmin = 0;
+      for (unsigned int j = 1; j < 3; j++)
+        if (D[j] < D[jmin])
+          jmin = j;
+      for (unsigned int r = 0; r < 3; r++)
+        U[r][jmin] = -U[r][jmin];
+      R = U * Vt.t();
+    }
+
+    vpHomogeneousMatrix cMo_approx;
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++)
+        cMo_approx[r][c] = R[r][c];
+      cMo_approx[r][3] = pc0[r] - (R[r][0] * pw0[0] + R[r][1] * pw0[1] + R[r][2] * pw0[2]);
+    }
+
+    double error = computeResidual(cMo_approx);
+    if (error < best_error) {
+      best_error = error;
+      cMo = cMo_approx;
+    }
+  }
+}
@@ -0,0 +1,399 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Pose computation from three points (P3P).
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpPoseP3P.cpp
+  \brief Minimal pose computation from three points.
+*/
+
+#include <cmath>    // std::fabs
+#include <float.h>  // DBL_MAX
+#include <limits>   // numeric_limits
+
+#include <visp3/core/vpMath.h>
+#include <visp3/vision/vpPose.h>
+#include <visp3/vision/vpPoseException.h>
+
+namespace {
+  double cubeRoot(const double x)
+  {
+    return (x >= 0.) ? pow(x, 1./3.) : -pow(-x, 1./3.);
+  }
+
+  /*
+    Return the largest real root of m^3 + a m^2 + b m + c = 0.
+  */
+  double solveCubicLargestRoot(const double a, const double b, const double c)
+  {
+    double a_3 = a / 3.;
+    double p = b - a * a_3;
+    double q = 2. * a_3 * a_3 * a_3 - a_3 * b + c;
+    double disc = q * q / 4. + p * p * p / 27.;
+
+    double z;
+    if (disc > 0.) {
+      double sqrt_disc = sqrt(disc);
+      z = cubeRoot(-q / 2. + sqrt_disc) + cubeRoot(-q / 2. - sqrt_disc);
+    }
+    else if (p < 0.) {
+      double arg = (3. * q / (2. * p)) * sqrt(-3. / p);
+      arg = std::max(-1., std::min(1., arg));
+      z = 2. * sqrt(-p / 3.) * cos(acos(arg) / 3.);
+    }
+    else {
+      z = cubeRoot(-q);
+    }
+    return z - a_3;
+  }
+
+  double evalQuartic(const double coef[5], const double x)
+  {
+    return (((coef[4] * x + coef[3]) * x + coef[2]) * x + coef[1]) * x + coef[0];
+  }
+
+  /*
+    Real roots of coef[4] x^4 + coef[3] x^3 + coef[2] x^2 + coef[1] x + coef[0] = 0
+    using Ferrari's method. The roots are polished by two Newton iterations.
+  */
+  unsigned int solveQuartic(const double coef[5], double roots[4])
+  {
+    if (std::fabs(coef[4]) < std::numeric_limits<double>::epsilon())
+      return 0;
+
+    double b = coef[3] / coef[4];
+    double c = coef[2] / coef[4];
+    double d = coef[1] / coef[4];
+    double e = coef[0] / coef[4];
+
+    // Depressed quartic y^4 + p y^2 + q y + r = 0 with x = y - b/4
+    double b2 = b * b;
+    double p = c - 3. * b2 / 8.;
+    double q = d - b * c / 2. + b2 * b / 8.;
+    double r = e - b * d / 4. + b2 * c / 16. - 3. * b2 * b2 / 256.;
+
+    double y[4];
+    unsigned int nbRoots = 0;
+
+    double m = 0.;
+    if (std::fabs(q) > 1e-12) {
+      // Resolvent cubic m^3 + p m^2 + (p^2/4 - r) m - q^2/8 = 0 has a positive root
+      m = solveCubicLargestRoot(p, p * p / 4. - r, -q * q / 8.);
+    }
+
+    if (m <= 0.) {
+      // Biquadratic y^4 + p y^2 + r = 0
+      double disc = p * p - 4. * r;
+      if (disc < 0.)
+        return 0;
+      double sqrt_disc = sqrt(disc);
+      double z[2] = { (-p + sqrt_disc) / 2., (-p - sqrt_disc) / 2. };
+      for (unsigned int i = 0; i < 2; i++) {
+        if (z[i] >= 0.) {
+          y[nbRoots++] = sqrt(z[i]);
+          y[nbRoots++] = -sqrt(z[i]);
+        }
+      }
+    }
+    else {
+      // (y^2 + p/2 + m)^2 = 2m (y - q/(4m))^2
+      double sqrt_2m = sqrt(2. * m);
+      for (int sign = -1; sign <= 1; sign += 2) {
+        // y^2 + sign sqrt(2m) y + p/2 + m - sign sqrt(2m) q/(4m) = 0
+        double B = sign * sqrt_2m;
+        double C = p / 2. + m - sign * sqrt_2m * q / (4. * m);
+        double disc = B * B - 4. * C;
+        if (disc >= 0.) {
+          double sqrt_disc = sqrt(disc);
+          y[nbRoots++] = (-B + sqrt_disc) / 2.;
+          y[nbRoots++] = (-B - sqrt_disc) / 2.;
+        }
+      }
+    }
+
+    for (unsigned int i = 0; i < nbRoots; i++) {
+      double x = y[i] - b / 4.;
+      for (unsigned int iter = 0; iter < 2; iter++) {
+        double df = ((4. * coef[4] * x + 3. * coef[3]) * x + 2. * coef[2]) * x + coef[1];
+        if (std::fabs(df) > std::numeric_limits<double>::epsilon())
+          x -= evalQuartic(coef, x) / df;
+      }
+      roots[i] = x;
+    }
+
+    return nbRoots;
+  }
+
+  /*
+    Gauss-Newton refinement of the distances s between the camera center and the
+    three points, which improves the accuracy of the roots close to a double root.
+  */
+  void refineDistances(const double cos_alpha, const double cos_beta, const double cos_gamma,
+                       const double a2, const double b2, const double c2, double s[3])
+  {
+    for (unsigned int iter = 0; iter < 2; iter++) {
+      // Residuals of the law of cosines for the sides c (P1P2), b (P1P3) and a (P2P3)
+      double r[3] = { s[0] * s[0] + s[1] * s[1] - 2. * s[0] * s[1] * cos_gamma - c2,
+                      s[0] * s[0] + s[2] * s[2] - 2. * s[0] * s[2] * cos_beta - b2,
+                      s[1] * s[1] + s[2] * s[2] - 2. * s[1] * s[2] * cos_alpha - a2 };
+      double J[3][3] = { { 2. * (s[0] - s[1] * cos_gamma), 2. * (s[1] - s[0] * cos_gamma), 0. },
+                         { 2. * (s[0] - s[2] * cos_beta), 0., 2. * (s[2] - s[0] * cos_beta) },
+                         { 0., 2. * (s[1] - s[2] * cos_alpha), 2. * (s[2] - s[1] * cos_alpha) } };
+
+      double det = J[0][0] * (J[1][1] * J[2][2] - J[1][2] * J[2][1])
+                 - J[0][1] * (J[1][0] * J[2][2] - J[1][2] * J[2][0])
+                 + J[0][2] * (J[1][0] * J[2][1] - J[1][1] * J[2][0]);
+      if (std::fabs(det) < std::numeric_limits<double>::epsilon())
+        return;
+
+      // Cramer's rule for J ds = r
+      double ds[3];
+      for (unsigned int k = 0; k < 3; k++) {
+        double M[3][3];
+        for (unsigned int i = 0; i < 3; i++)
+          for (unsigned int j = 0; j < 3; j++)
+            M[i][j] = (j == k) ? r[i] : J[i][j];
+        ds[k] = (M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+               - M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+               + M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0])) / det;
+      }
+      for (unsigned int k = 0; k < 3; k++)
+        s[k] -= ds[k];
+    }
+  }
+
+  /*
+    Orthonormal frame attached to the triangle (P1, P2, P3) stored by columns.
+    Return false if the points are collinear.
+  */
+  bool triangleFrame(const double P1[3], const double P2[3], const double P3[3], double F[3][3])
+  {
+    double e1[3] = { P2[0] - P1[0], P2[1] - P1[1], P2[2] - P1[2] };
+    double v[3]  = { P3[0] - P1[0], P3[1] - P1[1], P3[2] - P1[2] };
+    double e3[3] = { e1[1] * v[2] - e1[2] * v[1], e1[2] * v[0] - e1[0] * v[2], e1[0] * v[1] - e1[1] * v[0] };
+
+    double n1 = sqrt(e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
+    double n3 = sqrt(e3[0] * e3[0] + e3[1] * e3[1] + e3[2] * e3[2]);
+    if (n1 < std::numeric_limits<double>::epsilon() || n3 < std::numeric_limits<double>::epsilon() * n1)
+      return false;
+
+    for (unsigned int i = 0; i < 3; i++) {
+      e1[i] /= n1;
+      e3[i] /= n3;
+    }
+    double e2[3] = { e3[1] * e1[2] - e3[2] * e1[1], e3[2] * e1[0] - e3[0] * e1[2], e3[0] * e1[1] - e3[1] * e1[0] };
+
+    for (unsigned int i = 0; i < 3; i++) {
+      F[i][0] = e1[i];
+      F[i][1] = e2[i];
+      F[i][2] = e3[i];
+    }
+    return true;
+  }
+}
+
+/*!
+  Compute the poses that are compatible with three 2D/3D point correspondences
+  (perspective-three-point problem).
+
+  The distances between the camera center and the three points are obtained
+  from the law of cosines, which leads to Grunert's quartic polynomial
+  \cite Haralick94. Each positive real root gives a pose computed by aligning
+  the triangle expressed in the object frame on the triangle expressed in the
+  camera frame.
+
+  \param P1, P2, P3 : Points for which the 3D coordinates in the object frame
+  (oX, oY, oZ) and the normalized image coordinates (x, y) are set. The 3D
+  points should not be collinear.
+  \param cMo_solutions : Up to 4 poses. Without another point, the solutions
+  cannot be discriminated.
+
+  \return The number of solutions.
+
+  \sa poseP3P(vpHomogeneousMatrix &)
+*/
+unsigned int vpPose::poseP3P(const vpPoint &P1, const vpPoint &P2, const vpPoint &P3,
+                             std::vector<vpHomogeneousMatrix> &cMo_solutions)
+{
+  cMo_solutions.clear();
+
+  const vpPoint *pts[3] = { &P1, &P2, &P3 };
+  double oP[3][3], f[3][3];
+  for (unsigned int i = 0; i < 3; i++) {
+    oP[i][0] = pts[i]->get_oX();
+    oP[i][1] = pts[i]->get_oY();
+    oP[i][2] = pts[i]->get_oZ();
+
+    // Unit bearing vector
+    double n = sqrt(pts[i]->get_x() * pts[i]->get_x() + pts[i]->get_y() * pts[i]->get_y() + 1.);
+    f[i][0] = pts[i]->get_x() / n;
+    f[i][1] = pts[i]->get_y() / n;
+    f[i][2] = 1. / n;
+  }
+
+  double Fo[3][3];
+  if (! triangleFrame(oP[0], oP[1], oP[2], Fo))
+    return 0;
+
+  // Squared side lengths: a opposite to P1, b opposite to P2, c opposite to P3
+  double a2 = vpMath::sqr(oP[1][0] - oP[2][0]) + vpMath::sqr(oP[1][1] - oP[2][1]) + vpMath::sqr(oP[1][2] - oP[2][2]);
+  double b2 = vpMath::sqr(oP[0][0] - oP[2][0]) + vpMath::sqr(oP[0][1] - oP[2][1]) + vpMath::sqr(oP[0][2] - oP[2][2]);
+  double c2 = vpMath::sqr(oP[0][0] - oP[1][0]) + vpMath::sqr(oP[0][1] - oP[1][1]) + vpMath::sqr(oP[0][2] - oP[1][2]);
+
+  // Cosines of the angles between the bearing vectors
+  double cos_alpha = f[1][0] * f[2][0] + f[1][1] * f[2][1] + f[1][2] * f[2][2];
+  double cos_beta  = f[0][0] * f[2][0] + f[0][1] * f[2][1] + f[0][2] * f[2][2];
+  double cos_gamma = f[0][0] * f[1][0] + f[0][1] * f[1][1] + f[0][2] * f[1][2];
+
+  // Two points observed along the same line of sight do not constrain the pose
+  const double cos_max = 1. - 1e-10;
+  if (cos_alpha > cos_max || cos_beta > cos_max || cos_gamma > cos_max)
+    return 0;
+
+  // With s2 = u s1 and s3 = v s1 the distances to the camera center, the law of cosines gives
+  //   s1^2 (1 + u^2 - 2 u cos_gamma) = c^2
+  //   s1^2 (1 + v^2 - 2 v cos_beta)  = b^2
+  //   s1^2 (u^2 + v^2 - 2 u v cos_alpha) = a^2
+  // Eliminating s1 leads to u = N(v) / D(v) and to a quartic polynomial in v:
+  //   N^2 - 2 cos_gamma N D + (1 - K(v)) D^2 = 0 with K(v) = c^2/b^2 (1 + v^2 - 2 v cos_beta)
+  double k = (c2 - a2) / b2;
+  double n0 = k - 1., n1 = -2. * cos_beta * k, n2 = k + 1.;
+  double d0 = -2. * cos_gamma, d1 = 2. * cos_alpha;
+  double k0 = 1. - c2 / b2, k1 = 2. * cos_beta * c2 / b2, k2 = -c2 / b2;
+
+  double coef[5];
+  coef[0] = n0 * n0 - 2. * cos_gamma * n0 * d0 + k0 * d0 * d0;
+  coef[1] = 2. * n0 * n1 - 2. * cos_gamma * (n0 * d1 + n1 * d0) + 2. * k0 * d0 * d1 + k1 * d0 * d0;
+  coef[2] = n1 * n1 + 2. * n0 * n2 - 2. * cos_gamma * (n1 * d1 + n2 * d0) + k0 * d1 * d1 + 2. * k1 * d0 * d1 + k2 * d0 * d0;
+  coef[3] = 2. * n1 * n2 - 2. * cos_gamma * n2 * d1 + k1 * d1 * d1 + 2. * k2 * d0 * d1;
+  coef[4] = n2 * n2 + k2 * d1 * d1;
+
+  double roots[4];
+  unsigned int nbRoots = solveQuartic(coef, roots);
+
+  for (unsigned int i = 0; i < nbRoots; i++) {
+    double v = roots[i];
+    double D = d0 + d1 * v;
+    if (v <= 0. || std::fabs(D) < std::numeric_limits<double>::epsilon())
+      continue;
+    double u = (n0 + n1 * v + n2 * v * v) / D;
+    double den = 1. + v * v - 2. * v * cos_beta;
+    if (u <= 0. || den <= 0.)
+      continue;
+
+    double s[3];
+    s[0] = sqrt(b2 / den);
+    s[1] = u * s[0];
+    s[2] = v * s[0];
+    refineDistances(cos_alpha, cos_beta, cos_gamma, a2, b2, c2, s);
+
+    double cP[3][3];
+    for (unsigned int j = 0; j < 3; j++)
+      for (unsigned int l = 0; l < 3; l++)
+        cP[j][l] = s[j] * f[j][l];
+
+    // Reject spurious roots: the triangle rebuilt in the camera frame must match the object one
+    double a2_c = vpMath::sqr(cP[1][0] - cP[2][0]) + vpMath::sqr(cP[1][1] - cP[2][1]) + vpMath::sqr(cP[1][2] - cP[2][2]);
+    double b2_c = vpMath::sqr(cP[0][0] - cP[2][0]) + vpMath::sqr(cP[0][1] - cP[2][1]) + vpMath::sqr(cP[0][2] - cP[2][2]);
+    double c2_c = vpMath::sqr(cP[0][0] - cP[1][0]) + vpMath::sqr(cP[0][1] - cP[1][1]) + vpMath::sqr(cP[0][2] - cP[1][2]);
+    if (std::fabs(a2_c - a2) > 1e-4 * a2 || std::fabs(b2_c - b2) > 1e-4 * b2 || std::fabs(c2_c - c2) > 1e-4 * c2)
+      continue;
+
+    double Fc[3][3];
+    if (! triangleFrame(cP[0], cP[1], cP[2], Fc))
+      continue;
+
+    // cRo = Fc * Fo^T and cto = cP1 - cRo oP1
+    vpHomogeneousMatrix cMo;
+    for (unsigned int r = 0; r < 3; r++) {
+      for (unsigned int c = 0; c < 3; c++)
+        cMo[r][c] = Fc[r][0] * Fo[c][0] + Fc[r][1] * Fo[c][1] + Fc[r][2] * Fo[c][2];
+    }
+    for (unsigned int r = 0; r < 3; r++)
+      cMo[r][3] = cP[0][r] - (cMo[r][0] * oP[0][0] + cMo[r][1] * oP[0][1] + cMo[r][2] * oP[0][2]);
+
+    // Skip duplicated solutions that come from double roots
+    bool duplicated = false;
+    for (size_t j = 0; j < cMo_solutions.size() && ! duplicated; j++) {
+      double dist = 0;
+      for (unsigned int r = 0; r < 3; r++)
+        for (unsigned int c = 0; c < 4; c++)
+          dist += std::fabs(cMo_solutions[j][r][c] - cMo[r][c]);
+      duplicated = dist < 1e-9;
+    }
+    if (! duplicated)
+      cMo_solutions.push_back(cMo);
+  }
+
+  return (unsigned int)cMo_solutions.size();
+}
+
+/*!
+  Compute the pose using the P3P minimal solver on the first three points of
+  the list. The remaining points are used to select, among the P3P solutions,
+  the one that minimizes the residual.
+
+  \param cMo : Computed pose.
+
+  \exception vpPoseException::notEnoughPointError : Less than 4 points.
+  \exception vpPoseException::poseError : The first three 3D points are collinear
+  or no solution was found.
+
+  \sa poseP3P(const vpPoint &, const vpPoint &, const vpPoint &, std::vector<vpHomogeneousMatrix> &)
+*/
+void vpPose::poseP3P(vpHomogeneousMatrix &cMo)
+{
+  if (listP.size() < 4) {
+    throw(vpPoseException(vpPoseException::notEnoughPointError,
+                          "P3P needs at least 4 points to select the solution"));
+  }
+
+  std::list<vpPoint>::const_iterator it = listP.begin();
+  const vpPoint &P1 = *it; ++it;
+  const vpPoint &P2 = *it; ++it;
+  const vpPoint &P3 = *it;
+
+  std::vector<vpHomogeneousMatrix> cMo_solutions;
+  if (poseP3P(P1, P2, P3, cMo_solutions) == 0) {
+    throw(vpPoseException(vpPoseException::poseError, "No P3P solution found"));
+  }
+
+  double best_residual = DBL_MAX;
+  for (size_t i = 0; i < cMo_solutions.size(); i++) {
+    double r = computeResidual(cMo_solutions[i]);
+    if (r < best_residual) {
+      best_residual = r;
+      cMo = cMo_solutions[i];
+    }
+  }
+}
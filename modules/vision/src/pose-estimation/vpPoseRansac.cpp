@@ -56,15 +56,13 @@
 #include <visp3/core/vpRansac.h>
 #include <visp3/vision/vpPoseException.h>
 #include <visp3/core/vpMath.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
 
 #if defined (VISP_HAVE_CPP11_COMPATIBILITY)
 #  include <unordered_map>
 #endif
 
-#if defined(VISP_HAVE_OPENMP)
-#  include <omp.h>
-#endif
-
 #define eps 1e-6
 
 
@@ -188,212 +186,255 @@ struct ComparePointDuplicateUnorderedMap {
   }
 };
 #endif
-}
-
-bool vpPose::RansacFunctor::poseRansacImpl() {
-  unsigned int size = (unsigned int) m_listOfUniquePoints.size();
-  int nbTrials = 0;
-  unsigned int nbMinRandom = 4;
 
+//Pick a random index in [0, size[
+unsigned int pickRandomIndex(unsigned int &seed, const unsigned int size) {
 #if defined(_WIN32) && defined(_MSC_VER)
-  srand(m_initial_seed);
+  (void)seed;
+  return (unsigned int) rand() % size;
+#else
+  return (unsigned int) rand_r(&seed) % size;
 #endif
+}
 
-  vpPoint p; //Point used to project using the estimated pose
+//Pick randomly a minimal sample set of distinct (and non degenerate if requested) points
+bool pickMinimalSample(const std::vector<vpPoint> &points, const unsigned int nbMinRandom,
+                       const bool checkDegeneratePoints, unsigned int &seed, std::vector<vpPoint> &sample) {
+  unsigned int size = (unsigned int) points.size();
+  //Vector of used points, initialized at false for all points
+  std::vector<bool> usedPt(size, false);
+  unsigned int nbUsedPt = 0;
+
+  sample.clear();
+  while (sample.size() < nbMinRandom) {
+    if (nbUsedPt == size) {
+      //All points was picked once, break otherwise we stay in an infinite loop
+      return false;
+    }
 
-  bool foundSolution = false;
-  while (nbTrials < m_ransacMaxTrials && m_nbInliers < (unsigned int) m_ransacNbInlierConsensus)
-  {
-    //Hold the list of the index of the inliers (points in the consensus set)
-    std::vector<unsigned int> cur_consensus;
-    //Hold the list of the index of the outliers
-    std::vector<unsigned int> cur_outliers;
-    //Hold the list of the index of the points randomly picked
-    std::vector<unsigned int> cur_randoms;
-    //Hold the list of the current inliers points to avoid to add a degenerate point if the flag is set
-    std::vector<vpPoint> cur_inliers;
-
-    vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
-    //Use a temporary variable because if not, the cMo passed in parameters will be modified when
-    // we compute the pose for the minimal sample sets but if the pose is not correct when we pass
-    // a function pointer we do not want to modify the cMo passed in parameters
-    vpHomogeneousMatrix cMo_tmp;
-
-    //Vector of used points, initialized at false for all points
-    std::vector<bool> usedPt(size, false);
-
-    vpPose poseMin;
-    for(unsigned int i = 0; i < nbMinRandom;)
-    {
-      if((size_t) std::count(usedPt.begin(), usedPt.end(), true) == usedPt.size()) {
-        //All points was picked once, break otherwise we stay in an infinite loop
-        break;
-      }
+    unsigned int r_ = pickRandomIndex(seed, size);
+    while (usedPt[r_]) {
+      //If already picked, pick another point randomly
+      r_ = pickRandomIndex(seed, size);
+    }
+    //Mark this point as already picked
+    usedPt[r_] = true;
+    nbUsedPt++;
 
-      //Pick a point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-      unsigned int r_ = (unsigned int) rand() % size;
-#else
-      unsigned int r_ = (unsigned int) rand_r(&m_initial_seed) % size;
-#endif
+    const vpPoint &pt = points[r_];
+    if (checkDegeneratePoints &&
+        std::find_if(sample.begin(), sample.end(), FindDegeneratePoint(pt)) != sample.end()) {
+      continue;
+    }
+    sample.push_back(pt);
+  }
 
-      while(usedPt[r_]) {
-        //If already picked, pick another point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-        r_ = (unsigned int) rand() % size;
-#else
-        r_ = (unsigned int) rand_r(&m_initial_seed) % size;
-#endif
-      }
-      //Mark this point as already picked
-      usedPt[r_] = true;
-      vpPoint pt = m_listOfUniquePoints[r_];
-
-      bool degenerate = false;
-      if (m_checkDegeneratePoints) {
-        if ( std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=  poseMin.listOfPoints.end()) {
-          degenerate = true;
-        }
-      }
+  return true;
+}
+
+}
 
-      if (!degenerate) {
-        poseMin.addPoint(pt);
-        cur_randoms.push_back(r_);
-        //Increment the number of points picked
-        i++;
+/*!
+  Compute the index of the points for which the reprojection error is below the threshold.
+
+  \param cMo : Pose to evaluate.
+  \param points : Contiguous coordinates of the points.
+  \param listOfPoints_ : Same points, used to reject degenerate points.
+  \param threshold : Reprojection error threshold.
+  \param checkDegeneratePoints : If true, a point degenerated with a previous inlier is not added.
+  \param errors : Buffer resized to hold the squared reprojection errors.
+  \param consensus : Index of the inliers.
+  \return The number of inliers.
+*/
+unsigned int vpPose::computeConsensus(const vpHomogeneousMatrix &cMo, const PointArray &points,
+                                      const std::vector<vpPoint> &listOfPoints_, const double threshold,
+                                      const bool checkDegeneratePoints, std::vector<double> &errors,
+                                      std::vector<unsigned int> &consensus) {
+  const size_t size = points.size();
+  errors.resize(size);
+  consensus.clear();
+  if (size == 0) {
+    return 0;
+  }
+
+  computeSquaredErrors(cMo, points, 0, size, &errors[0]);
+
+  //Hold the list of the current inliers points to avoid to add a degenerate point if the flag is set
+  std::vector<vpPoint> cur_inliers;
+  const double threshold2 = threshold * threshold;
+  for (size_t i = 0; i < size; i++) {
+    // the point is considered as inlier if the error is below the threshold
+    if (errors[i] < threshold2) {
+      if (checkDegeneratePoints) {
+        if (std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(listOfPoints_[i])) != cur_inliers.end()) {
+          continue;
+        }
+        cur_inliers.push_back(listOfPoints_[i]);
       }
+      consensus.push_back((unsigned int) i);
     }
+  }
 
-    if(poseMin.npt < nbMinRandom) {
-      nbTrials++;
-      continue;
+  return (unsigned int) consensus.size();
+}
+
+/*
+  Sequential probability ratio test of a hypothesis on the shuffled points
+  (\cite Chum08). The points are evaluated by blocks and the hypothesis is
+  rejected as soon as the likelihood ratio between the bad and the good model
+  exceeds the decision threshold A, or when the number of outliers shows that
+  it cannot beat the best consensus set. The inlier ratio epsilon of a good
+  model is approximated by the one of the best consensus set.
+*/
+bool vpPose::RansacFunctor::sprtTest(const vpHomogeneousMatrix &cMo, const unsigned int bestNbInliers) {
+  //Number of points evaluated at once
+  const size_t blockSize = 16;
+  //Time needed to compute the hypotheses of one sample (P3P), in number of point evaluations
+  const double timePerSample = 200.;
+  //Average number of P3P hypotheses per sample
+  const double nbModelsPerSample = 2.;
+
+  const PointArray &points = *m_shuffledPointArray;
+  const size_t size = points.size();
+  m_sprtErrors.resize(size);
+
+  const double epsilon = bestNbInliers / (double) size;
+  const double delta = m_sprtDelta;
+  const bool useSprt = epsilon > delta && epsilon < 1;
+
+  double logInlier = 0, logOutlier = 0, logA = 0;
+  if (useSprt) {
+    logInlier = log(delta / epsilon);
+    logOutlier = log((1 - delta) / (1 - epsilon));
+
+    //A is the solution of A = K + log(A), K = t_M C / m_S + 1 with C the Kullback-Leibler divergence
+    double C = (1 - delta) * logOutlier + delta * log(delta / epsilon);
+    double K = timePerSample * C / nbModelsPerSample + 1;
+    double A = K;
+    for (unsigned int i = 0; i < 10; i++) {
+      A = K + log(A);
     }
+    logA = log(A);
+  }
 
-    //Flags set if pose computation is OK
-    bool is_valid_lagrange = false;
-    bool is_valid_dementhon = false;
-
-    //Set maximum value for residuals
-    double r_lagrange = DBL_MAX;
-    double r_dementhon = DBL_MAX;
-
-    try {
-      poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
-      r_lagrange = poseMin.computeResidual(cMo_lagrange);
-      is_valid_lagrange = true;
-    } catch(...) { }
-
-    try {
-      poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
-      r_dementhon = poseMin.computeResidual(cMo_dementhon);
-      is_valid_dementhon = true;
-    } catch(...) { }
-
-    //If residual returned is not a number (NAN), set valid to false
-    if(vpMath::isNaN(r_lagrange)) {
-      is_valid_lagrange = false;
-      r_lagrange = DBL_MAX;
+  const double threshold2 = m_ransacThreshold * m_ransacThreshold;
+  //With more outliers, the consensus set cannot be larger than the best one
+  const size_t maxNbOutliers = size - bestNbInliers;
+  size_t nbOutliers = 0;
+  double logLambda = 0;
+  for (size_t start = 0; start < size; start += blockSize) {
+    size_t end = std::min(start + blockSize, size);
+    vpPose::computeSquaredErrors(cMo, points, start, end, &m_sprtErrors[0]);
+
+    for (size_t i = start; i < end; i++) {
+      if (m_sprtErrors[i] < threshold2) {
+        logLambda += logInlier;
+      } else {
+        nbOutliers++;
+        logLambda += logOutlier;
+      }
     }
 
-    if(vpMath::isNaN(r_dementhon)) {
-      is_valid_dementhon = false;
-      r_dementhon = DBL_MAX;
+    if (nbOutliers >= maxNbOutliers || (useSprt && logLambda > logA)) {
+      //Update the estimation of delta with the rejected (bad) model
+      double inlierRatio = (end - nbOutliers) / (double) end;
+      m_sprtDelta = std::max(0.9 * m_sprtDelta + 0.1 * inlierRatio, 1e-4);
+      return false;
     }
+  }
 
-    //If at least one pose computation is OK,
-    //we can continue, otherwise pick another random set
-    if(is_valid_lagrange || is_valid_dementhon) {
-      double r;
-      if (r_lagrange < r_dementhon) {
-        r = r_lagrange;
-        cMo_tmp = cMo_lagrange;
-      }
-      else {
-        r = r_dementhon;
-        cMo_tmp = cMo_dementhon;
-      }
-      r = sqrt(r) / (double) nbMinRandom;
+  return true;
+}
 
-      //Filter the pose using some criterion (orientation angles, translations, etc.)
-      bool isPoseValid = true;
-      if(m_func != NULL) {
-        isPoseValid = m_func(&cMo_tmp);
-        if(isPoseValid) {
-          m_cMo = cMo_tmp;
-        }
-      } else {
-        //No post filtering on pose, so copy cMo_temp to cMo
-        m_cMo = cMo_tmp;
-      }
+bool vpPose::RansacFunctor::poseRansacImpl() {
+  //Minimal sample set size of the P3P solver
+  const unsigned int nbMinRandom = 3;
 
-      if (isPoseValid && r < m_ransacThreshold)
-      {
-        unsigned int nbInliersCur = 0;
-        unsigned int iter = 0;
-        for (std::vector<vpPoint>::const_iterator it = m_listOfUniquePoints.begin(); it != m_listOfUniquePoints.end(); ++it, iter++)
-        {
-          p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-          p.track(m_cMo);
-
-          double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y());
-          double error = sqrt(d);
-          if(error < m_ransacThreshold) {
-            bool degenerate = false;
-            if (m_checkDegeneratePoints) {
-              if ( std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(*it)) != cur_inliers.end() ) {
-                degenerate = true;
-              }
-            }
-
-            if (!degenerate) {
-              // the point is considered as inlier if the error is below the threshold
-              nbInliersCur++;
-              cur_consensus.push_back(iter);
-              cur_inliers.push_back(*it);
-            } else {
-              cur_outliers.push_back(iter);
-            }
-          }
-          else {
-            cur_outliers.push_back(iter);
-          }
-        }
+#if defined(_WIN32) && defined(_MSC_VER)
+  srand(m_initial_seed);
+#endif
 
-        if(nbInliersCur > m_nbInliers)
-        {
-          foundSolution = true;
-          m_best_consensus = cur_consensus;
-          m_nbInliers = nbInliersCur;
-        }
+  //Points randomly picked (minimal sample set)
+  std::vector<vpPoint> cur_sample;
+  //Poses compatible with the minimal sample set
+  std::vector<vpHomogeneousMatrix> cMo_solutions;
+  //Hold the list of the index of the inliers (points in the consensus set)
+  std::vector<unsigned int> cur_consensus;
+  //Squared reprojection errors
+  std::vector<double> cur_errors;
 
-        nbTrials++;
+  bool foundSolution = false;
+  while (m_scheduler->nextTrial())
+  {
+    if (!pickMinimalSample(*m_listOfUniquePoints, nbMinRandom, m_checkDegeneratePoints, m_initial_seed, cur_sample)) {
+      continue;
+    }
 
-        if(nbTrials >= m_ransacMaxTrials) {
-          foundSolution = true;
-        }
+    //P3P gives up to 4 solutions: each one is a hypothesis
+    vpPose::poseP3P(cur_sample[0], cur_sample[1], cur_sample[2], cMo_solutions);
+
+    for (size_t i = 0; i < cMo_solutions.size(); i++) {
+      //Filter the pose using some criterion (orientation angles, translations, etc.)
+      if (m_func != NULL && !m_func(&cMo_solutions[i])) {
+        continue;
       }
-      else {
-        nbTrials++;
+
+      //Early rejection of the hypothesis on a subset of the points
+      if (m_shuffledPointArray != NULL && !sprtTest(cMo_solutions[i], m_scheduler->getBestNbInliers())) {
+        continue;
       }
-    } else {
-      nbTrials++;
+
+      unsigned int nbInliersCur = computeConsensus(cMo_solutions[i], *m_uniquePointArray, *m_listOfUniquePoints,
+                                                   m_ransacThreshold, m_checkDegeneratePoints, cur_errors, cur_consensus);
+      if (nbInliersCur > m_nbInliers) {
+        foundSolution = true;
+        m_best_consensus = cur_consensus;
+        m_nbInliers = nbInliersCur;
+        m_cMo = cMo_solutions[i];
+      }
+      m_scheduler->update(nbInliersCur);
     }
   }
 
   return foundSolution;
 }
 
-#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
-vpThread::Return vpPose::poseRansacImplThread(vpThread::Args arg) {
-  vpPose::RansacFunctor* f = reinterpret_cast<vpPose::RansacFunctor*>(arg);
-  (*f)();
-  return 0;
-}
-#endif
+/*
+  Run the RANSAC workers with indexes in [start, end) on the threads of the pool.
+*/
+class vpPose::RansacBody : public vpParallelLoopBody {
+public:
+  RansacBody(std::vector<RansacFunctor> &functors) : m_functors(functors) {}
+
+  void operator()(unsigned int start, unsigned int end) const {
+    for (unsigned int i = start; i < end; i++) {
+      m_functors[i]();
+    }
+  }
+
+private:
+  std::vector<RansacFunctor> &m_functors;
+};
 
 /*!
   Compute the pose using the Ransac approach.
 
+  Each hypothesis is computed from a minimal set of 3 points with the P3P solver,
+  leading to up to 4 poses that are all evaluated. The pose obtained from the best
+  consensus set is then estimated with EPnP and refined by virtual visual servoing. If
+  EPnP fails on the consensus set, the refinement starts from the best P3P hypothesis.
+
+  The sampling stops as soon as one of these conditions is met:
+  - a consensus set of setRansacNbInliersToReachConsensus() points is found,
+  - the number of trials reaches the one needed to pick an outlier free sample
+  with the probability set by setRansacProbability(), given the inlier ratio of
+  the best consensus set found so far (at most setRansacMaxTrials() trials),
+  - the time budget set by setRansacTimeBudget() is elapsed.
+
+  With setUseParallelRansac(), the trials are handed out on demand to the
+  threads that share the best consensus set size. With setUseRansacSprt(), most
+  of the bad hypotheses are rejected after the evaluation of a few points.
+
   \param cMo : Computed pose
   \param func : Pointer to a function that takes in parameter a vpHomogeneousMatrix
   and returns true if the pose check is OK or false otherwise
@@ -406,6 +447,10 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
   if (listP.size() != listOfPoints.size()) {
     std::cerr << "You should not modify vpPose::listP!" << std::endl;
     listOfPoints = std::vector<vpPoint>(listP.begin(), listP.end());
+    pointArray.clear();
+    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it) {
+      pointArray.push_back(*it);
+    }
   }
 
   ransacInliers.clear();
@@ -414,7 +459,9 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
   std::vector<unsigned int> best_consensus;
   unsigned int nbInliers = 0;
 
-  vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
+  vpHomogeneousMatrix cMo_epnp;
+  //Pose of the best hypothesis, from the minimal sample set of its consensus set
+  vpHomogeneousMatrix cMo_ransac;
 
   if (listOfPoints.size() < 4) {
     //vpERROR_TRACE("Not enough point to compute the pose");
@@ -503,275 +550,59 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
     throw(vpPoseException(vpPoseException::notInitializedError, "Not enough point to compute the pose")) ;
   }
 
+  //Contiguous coordinates shared by all the hypotheses
+  PointArray uniquePointArray;
+  uniquePointArray.reserve(size);
+  for (std::vector<vpPoint>::const_iterator it_pt = listOfUniquePoints.begin(); it_pt != listOfUniquePoints.end(); ++it_pt) {
+    uniquePointArray.push_back(*it_pt);
+  }
 
-  bool executeParallelVersion = useParallelRansac;
+  //Same points in a random order, for the early rejection of the hypotheses
+  PointArray shuffledPointArray;
+  if (useRansacSprt) {
+    std::vector<unsigned int> order(size);
+    for (unsigned int i = 0; i < size; i++) {
+      order[i] = i;
+    }
+    unsigned int shuffle_seed = 0;
+    for (unsigned int i = size - 1; i > 0; i--) {
+      std::swap(order[i], order[pickRandomIndex(shuffle_seed, i + 1)]);
+    }
 
-#if defined (VISP_HAVE_PTHREAD) || (defined (_WIN32) && !defined(WINRT_8_0))
-#  define VP_THREAD_OK
-  int nbThreads = 1;
-#endif
+    shuffledPointArray.reserve(size);
+    for (unsigned int i = 0; i < size; i++) {
+      shuffledPointArray.push_back(listOfUniquePoints[order[i]]);
+    }
+  }
+  const PointArray *sprtPointArray = useRansacSprt ? &shuffledPointArray : NULL;
+
+  vpRansacScheduler scheduler(ransacMaxTrials, ransacProbability, ransacTimeBudget, size, ransacNbInlierConsensus, 3);
+
+  bool executeParallelVersion = useParallelRansac;
+  unsigned int nbThreads = 1;
 
   if (executeParallelVersion) {
-#if !defined (VP_THREAD_OK) && !defined (VISP_HAVE_OPENMP)
-    executeParallelVersion = false;
-    std::cerr << "Pthread or WIN32 API or OpenMP is needed to use the parallel RANSAC version." << std::endl;
-#elif !defined (VP_THREAD_OK)
-    //Use OpenMP
-#define PARALLEL_RANSAC_OPEN_MP
-#elif !defined (VISP_HAVE_OPENMP)
-    if(nbParallelRansacThreads <= 0) {
-      //Cannot get the number of CPU threads so use the sequential mode
+    nbThreads = (nbParallelRansacThreads > 0) ? (unsigned int) nbParallelRansacThreads : vpThreadPool::getConcurrency();
+    if (nbThreads <= 1) {
       executeParallelVersion = false;
-      std::cerr << "OpenMP is needed to get the number of CPU threads so use the sequential mode instead." << std::endl;
-    } else {
-      nbThreads = nbParallelRansacThreads;
-      if (nbThreads == 1) {
-        executeParallelVersion = false;
-      }
-    }
-#elif defined (VP_THREAD_OK) && defined (VISP_HAVE_OPENMP)
-    if (nbParallelRansacThreads <= 0) {
-      //Use OpenMP to get the number of CPU threads
-      nbThreads = omp_get_max_threads();
-      if(nbThreads <= 1) {
-        nbThreads = 1;
-        executeParallelVersion = false;
-      }
     }
-#endif
   }
 
   bool foundSolution = false;
 
   if(executeParallelVersion) {
-#if defined (PARALLEL_RANSAC_OPEN_MP)
-    //List of points picked randomly (minimal sample set, MSS)
-    //std::vector<unsigned int> best_randoms; // never used
-
-    //Section of code run in parallel
-    //All variables declared before the parallel keyword are shared between the team of threads (if private keyword is not used)
-    //Code in parallel section are duplicated between the team of threads
-#pragma omp parallel
-    {
-#if defined(VISP_HAVE_OPENMP)
-      //Set different seeds for each thread in the team, rand() is not thread safe
-      unsigned int initial_seed = (unsigned int) omp_get_thread_num(); //same seed each time
-      //(unsigned int) (int(time(NULL)) ^ omp_get_thread_num());
-      if(omp_get_num_threads() == 1) {
-        initial_seed = 0; //Same seed at each run
-      }
-#else
-      unsigned int initial_seed = 0;
-#endif
-
-#if defined(_WIN32) && defined(_MSC_VER)
-      srand(initial_seed);
-#endif
-
-      unsigned int nbMinRandom = 4;
-
-      //Numbers of points in the best consensus set
-      unsigned int nb_best_inliers = 0;
-
-      //True if we found a consensus set with a size > ransacNbInlierConsensus
-      bool foundSolutionWithConsensus = false;
-
-      vpPoint p; //Point used to project using the estimated pose
-
-#pragma omp for
-      for(int nbTrials = 0; nbTrials < ransacMaxTrials; nbTrials++) {
-        //Flag to check if a solution has been founded, used to "cancel" the threads
-        if(!foundSolutionWithConsensus) {
-          //Hold the list of the index of the inliers (points in the consensus set)
-          std::vector<unsigned int> cur_consensus;
-          //Hold the list of the index of the outliers
-          std::vector<unsigned int> cur_outliers;
-          //Hold the list of the index of the points randomly picked
-          std::vector<unsigned int> cur_randoms;
-          //Hold the list of the current inliers points to avoid to add a degenerate point if the flag is set
-          std::vector<vpPoint> cur_inliers;
-
-          vpHomogeneousMatrix cMo_lagrange, cMo_dementhon;
-          vpHomogeneousMatrix cMo_tmp;
-
-          //Vector of used points, initialized at false for all points
-          std::vector<bool> usedPt(size, false);
-
-          vpPose poseMin;
-
-          for(unsigned int i = 0; i < nbMinRandom;) {
-            if((size_t) std::count(usedPt.begin(), usedPt.end(), true) == usedPt.size()) {
-              //All points was picked once, break otherwise we stay in an infinite loop
-              break;
-            }
-
-            //Pick a point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-            unsigned int r_ = (unsigned int) rand() % size;
-#else
-            unsigned int r_ = (unsigned int) rand_r(&initial_seed) % size;
-#endif
-
-            while(usedPt[r_]) {
-              //If already picked, pick another point randomly
-#if defined(_WIN32) && defined(_MSC_VER)
-              r_ = (unsigned int) rand() % size;
-#else
-              r_ = (unsigned int) rand_r(&initial_seed) % size;
-#endif
-            }
-            //Mark this point as already picked
-            usedPt[r_] = true;
-            vpPoint pt = listOfUniquePoints[r_];
-
-            bool degenerate = false;
-            if (checkDegeneratePoints) {
-              if ( std::find_if(poseMin.listOfPoints.begin(), poseMin.listOfPoints.end(), FindDegeneratePoint(pt)) !=  poseMin.listOfPoints.end()) {
-                degenerate = true;
-              }
-            }
-
-            if (!degenerate) {
-              poseMin.addPoint(pt);
-              cur_randoms.push_back(r_);
-              //Increment the number of points picked
-              i++;
-            }
-          }
-
-          if(poseMin.npt >= nbMinRandom) {
-            //Flags set if pose computation is OK
-            bool is_valid_lagrange = false;
-            bool is_valid_dementhon = false;
-
-            //Set maximum value for residuals
-            double r = DBL_MAX;
-            double r_lagrange = DBL_MAX;
-            double r_dementhon = DBL_MAX;
-
-            try {
-              poseMin.computePose(vpPose::LAGRANGE, cMo_lagrange);
-              r_lagrange = poseMin.computeResidual(cMo_lagrange);
-              is_valid_lagrange = true;
-            } catch(...) { }
-
-            try {
-              poseMin.computePose(vpPose::DEMENTHON, cMo_dementhon);
-              r_dementhon = poseMin.computeResidual(cMo_dementhon);
-              is_valid_dementhon = true;
-            } catch(...) { }
-
-            //If residual returned is not a number (NAN), set valid to false
-            if(vpMath::isNaN(r_lagrange)) {
-              is_valid_lagrange = false;
-              r_lagrange = DBL_MAX;
-            }
-
-            if(vpMath::isNaN(r_dementhon)) {
-              is_valid_dementhon = false;
-              r_dementhon = DBL_MAX;
-            }
-
-            //If at least one pose computation is OK,
-            //we can continue, otherwise pick another random set
-            if(is_valid_lagrange || is_valid_dementhon) {
-              if (r_lagrange < r_dementhon) {
-                r = r_lagrange;
-                cMo_tmp = cMo_lagrange;
-              }
-              else {
-                r = r_dementhon;
-                cMo_tmp = cMo_dementhon;
-              }
-              r = sqrt(r) / (double) nbMinRandom;
-
-              //Filter the pose using some criterion (orientation angles, translations, etc.)
-              bool isPoseValid = true;
-              if(func != NULL) {
-                isPoseValid = func(&cMo_tmp);
-              }
-
-              if (isPoseValid && r < ransacThreshold) {
-                unsigned int nbInliersCur = 0;
-                unsigned int iter = 0;
-                for (std::vector<vpPoint>::const_iterator it = listOfUniquePoints.begin(); it != listOfUniquePoints.end(); ++it, iter++) {
-                  p.setWorldCoordinates(it->get_oX(), it->get_oY(), it->get_oZ());
-                  p.track(cMo_tmp);
-
-                  double d = vpMath::sqr(p.get_x() - it->get_x()) + vpMath::sqr(p.get_y() - it->get_y()) ;
-                  double error = sqrt(d) ;
-                  if(error < ransacThreshold) {
-                    bool degenerate = false;
-                    if (checkDegeneratePoints) {
-                      if ( std::find_if(cur_inliers.begin(), cur_inliers.end(), FindDegeneratePoint(*it)) != cur_inliers.end() ) {
-                        degenerate = true;
-                      }
-                    }
-
-                    if (!degenerate) {
-                      // the point is considered as inlier if the error is below the threshold
-                      nbInliersCur++;
-                      cur_consensus.push_back(iter);
-                      cur_inliers.push_back(*it);
-                    } else {
-                      cur_outliers.push_back(iter);
-                    }
-                  } else {
-                    cur_outliers.push_back(iter);
-                  }
-                }
-
-#pragma omp critical (update_best_consensus_set)
-                {
-                  if(nbInliersCur > nb_best_inliers) {
-                    foundSolution = true;
-                    best_consensus = cur_consensus;
-                    //best_randoms = cur_randoms; // never used
-                    nb_best_inliers = nbInliersCur;
-
-                    if(nbInliersCur >= ransacNbInlierConsensus) {
-                      foundSolutionWithConsensus = true;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-
-      nbInliers = best_consensus.size();
-    }
-#elif defined(VP_THREAD_OK)
-    std::vector<vpThread *> threads((size_t) nbThreads);
     std::vector<RansacFunctor> ransac_func((size_t) nbThreads);
 
-    int splitTrials = ransacMaxTrials / nbThreads;
+    //The trials are handed out by the scheduler as the workers request them
     for(size_t i = 0; i < (size_t) nbThreads; i++) {
       unsigned int initial_seed = (unsigned int) i; //((unsigned int) time(NULL) ^ i);
-      if(i < (size_t) nbThreads-1) {
-        ransac_func[i] = RansacFunctor(cMo, ransacNbInlierConsensus, splitTrials, ransacThreshold,
-                                       initial_seed, checkDegeneratePoints, listOfUniquePoints, func);
-      } else {
-        int maxTrialsRemainder = ransacMaxTrials - splitTrials * (nbThreads-1);
-        ransac_func[i] = RansacFunctor(cMo, ransacNbInlierConsensus, maxTrialsRemainder, ransacThreshold,
-                                       initial_seed, checkDegeneratePoints, listOfUniquePoints, func);
-      }
-
-      threads[(size_t) i] = new vpThread((vpThread::Fn) poseRansacImplThread, (vpThread::Args) &ransac_func[ i]);
+      ransac_func[i] = RansacFunctor(cMo, scheduler, ransacThreshold, initial_seed, checkDegeneratePoints,
+                                     listOfUniquePoints, uniquePointArray, sprtPointArray, func);
     }
 
-    //Get the best pose between the threads
-    vpPose final_pose;
-    for(std::vector<vpPoint>::const_iterator it = listOfPoints.begin(); it != listOfPoints.end(); ++it) {
-      final_pose.addPoint(*it);
-    }
-
-    for(size_t i = 0; i < (size_t) nbThreads; i++) {
-      threads[i]->join();
-      delete threads[i];
-    }
+    vpThreadPool::parallelFor(0, nbThreads, RansacBody(ransac_func), nbThreads, 1);
 
+    //Get the best pose between the workers
     bool successRansac = false;
     size_t best_consensus_size = 0;
     for(size_t i = 0; i < (size_t) nbThreads; i++) {
@@ -782,22 +613,23 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
           nbInliers = ransac_func[i].getNbInliers();
           best_consensus = ransac_func[i].getBestConsensus();
           best_consensus_size = ransac_func[i].getBestConsensus().size();
+          cMo_ransac = ransac_func[i].getEstimatedPose();
         }
       }
     }
 
     foundSolution = successRansac;
-#endif
   } else {
     //Sequential RANSAC
-    RansacFunctor sequentialRansac(cMo, ransacNbInlierConsensus, ransacMaxTrials, ransacThreshold,
-                                   0, checkDegeneratePoints, listOfUniquePoints, func);
+    RansacFunctor sequentialRansac(cMo, scheduler, ransacThreshold, 0, checkDegeneratePoints,
+                                   listOfUniquePoints, uniquePointArray, sprtPointArray, func);
     sequentialRansac();
     foundSolution = sequentialRansac.getResult();
 
     if (foundSolution) {
       nbInliers = sequentialRansac.getNbInliers();
       best_consensus = sequentialRansac.getBestConsensus();
+      cMo_ransac = sequentialRansac.getEstimatedPose();
     }
   }
 
@@ -842,57 +674,27 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
         ransacInlierIndex.push_back((unsigned int) mapOfUniquePointIndex[*it_index]);
       }
 
-      //Flags set if pose computation is OK
-      bool is_valid_lagrange = false;
-      bool is_valid_dementhon = false;
-
-      //Set maximum value for residuals
-      double r_lagrange = DBL_MAX;
-      double r_dementhon = DBL_MAX;
-
+      //Non minimal linear solution on the consensus set, refined by virtual visual servoing
+      bool is_valid = false;
       try {
-        pose.computePose(vpPose::LAGRANGE, cMo_lagrange);
-        r_lagrange = pose.computeResidual(cMo_lagrange);
-        is_valid_lagrange = true;
+        pose.computePose(vpPose::EPNP, cMo_epnp);
+        is_valid = !vpMath::isNaN(pose.computeResidual(cMo_epnp));
       } catch(...) { }
 
-      try {
-        pose.computePose(vpPose::DEMENTHON, cMo_dementhon);
-        r_dementhon = pose.computeResidual(cMo_dementhon);
-        is_valid_dementhon = true;
-      } catch(...) { }
+      //If EPnP fails on the consensus set, the refinement starts from the best P3P hypothesis
+      cMo = is_valid ? cMo_epnp : cMo_ransac;
 
-      //If residual returned is not a number (NAN), set valid to false
-      if(vpMath::isNaN(r_lagrange)) {
-        is_valid_lagrange = false;
-        r_lagrange = DBL_MAX;
-      }
+      pose.setCovarianceComputation(computeCovariance);
+      pose.computePose(vpPose::VIRTUAL_VS, cMo);
 
-      if(vpMath::isNaN(r_dementhon)) {
-        is_valid_dementhon = false;
-        r_dementhon = DBL_MAX;
+      //In some rare cases, the final pose could not respect the pose criterion even
+      //if the pose estimated from the minimal points picked respects the pose criterion.
+      if(func != NULL && !func(&cMo)) {
+        return false;
       }
 
-      if(is_valid_lagrange || is_valid_dementhon) {
-        if (r_lagrange < r_dementhon) {
-          cMo = cMo_lagrange;
-        }
-        else {
-          cMo = cMo_dementhon;
-        }
-
-        pose.setCovarianceComputation(computeCovariance);
-        pose.computePose(vpPose::VIRTUAL_VS, cMo);
-
-        //In some rare cases, the final pose could not respect the pose criterion even
-        //if the 4 minimal points picked respect the pose criterion.
-        if(func != NULL && !func(&cMo)) {
-          return false;
-        }
-
-        if(computeCovariance) {
-          covarianceMatrix = pose.covarianceMatrix;
-        }
+      if(computeCovariance) {
+        covarianceMatrix = pose.covarianceMatrix;
       }
     } else {
       return false;
@@ -909,46 +711,16 @@ bool vpPose::poseRansac(vpHomogeneousMatrix & cMo, bool (*func)(vpHomogeneousMat
 
   \param probability : Probability that at least one of the random samples is free from outliers (typically p=0.99).
   \param epsilon : Probability that a selected point is an outlier (between 0 and 1).
-  \param sampleSize : Minimum number of points to estimate the model (4 for a pose estimation).
+  \param sampleSize : Minimum number of points to estimate the model (3 for the P3P minimal solver used in poseRansac()).
   \param maxIterations : Upper bound on the number of iterations or -1 for INT_MAX.
   \return The number of RANSAC iterations to ensure with a probability \e p
   that at least one of the random samples of \e s points is free from outliers or \p maxIterations if it exceeds
   the desired upper bound or \e INT_MAX if maxIterations=-1.
+
+  \sa vpRansacScheduler::computeNbTrials()
 */
 int vpPose::computeRansacIterations(double probability, double epsilon, const int sampleSize, int maxIterations) {
-  probability = std::max(probability, 0.0);
-  probability = std::min(probability, 1.0);
-  epsilon = std::max(epsilon, 0.0);
-  epsilon = std::min(epsilon, 1.0);
-
-  if (vpMath::nul(epsilon)) {
-    //no outliers
-    return 1;
-  }
-
-  if (maxIterations <= 0) {
-    maxIterations = std::numeric_limits<int>::max();
-  }
-
-  double logarg, logval, N;
-  logarg = -std::pow(1.0 - epsilon, sampleSize);
-#ifdef VISP_HAVE_FUNC_LOG1P
-  logval = log1p(logarg);
-#else
-  logval = log(1.0 + logarg);
-#endif
-  if (vpMath::nul(logval, std::numeric_limits<double>::epsilon())) {
-    std::cerr << "vpMath::nul(log(1.0 - std::pow(1.0 - epsilon, sampleSize)), std::numeric_limits<double>::epsilon())"
-              << std::endl;
-    return 0;
-  }
-
-  N = log(std::max(1.0 - probability, std::numeric_limits<double>::epsilon())) / logval;
-  if (logval < 0.0 && N < maxIterations) {
-    return (int) ceil(N);
-  }
-
-  return maxIterations;
+  return vpRansacScheduler::computeNbTrials(probability, epsilon, sampleSize, maxIterations);
 }
 
 /*!
@@ -71,18 +71,19 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
     vpColVector sd(2*nb),s(2*nb) ;
     vpColVector v ;
     
-    vpPoint P;
-    std::list<vpPoint> lP ;
+    // Contiguous coordinates of the points, projected all at once at each iteration
+    PointArray points;
+    points.reserve(nb);
+    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+      points.push_back(*it);
+    std::vector<double> x_(nb), y_(nb), Z_(nb);
 
     // create sd
     unsigned int k =0 ;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+    for (k = 0; k < nb; k++)
     {
-      P = *it;
-      sd[2*k] = P.get_x() ;
-      sd[2*k+1] = P.get_y() ;
-      lP.push_back(P);
-      k ++;
+      sd[2*k] = points.x[k] ;
+      sd[2*k+1] = points.y[k] ;
     }
 
     vpHomogeneousMatrix cMoPrev = cMo;
@@ -92,18 +93,17 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
       residu_1 = r ;
 
       // Compute the interaction matrix and the error
-      k =0 ;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it)
+      // forward projection of the 3D model for a given pose
+      // change frame coordinates
+      // perspective projection
+      if (nb > 0)
+        vpPoint::projectPoints(cMo, &points.oX[0], &points.oY[0], &points.oZ[0], nb, &x_[0], &y_[0], &Z_[0]);
+
+      for (k = 0; k < nb; k++)
       {
-        P = *it;
-        // forward projection of the 3D model for a given pose
-        // change frame coordinates
-        // perspective projection
-        P.track(cMo) ;
-
-        double x = s[2*k] = P.get_x();  /* point projected from cMo */
-        double y = s[2*k+1] = P.get_y();
-        double Z = P.get_Z() ;
+        double x = s[2*k] = x_[k];  /* point projected from cMo */
+        double y = s[2*k+1] = y_[k];
+        double Z = Z_[k] ;
         L[2*k][0] = -1/Z  ;
         L[2*k][1] = 0 ;
         L[2*k][2] = x/Z ;
@@ -117,8 +117,6 @@ vpPose::poseVirtualVS(vpHomogeneousMatrix & cMo)
         L[2*k+1][3] = 1+y*y ;
         L[2*k+1][4] = -x*y ;
         L[2*k+1][5] = -x ;
-
-        k+=1 ;
       }
       err = s - sd ;
 
@@ -178,19 +176,19 @@ vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
     vpColVector sd(2*nb),s(2*nb) ;
     vpColVector v ;
 
-    listP.front() ;
-    vpPoint P;
-    std::list<vpPoint> lP ;
+    // Contiguous coordinates of the points, projected all at once at each iteration
+    PointArray points;
+    points.reserve(nb);
+    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+      points.push_back(*it);
+    std::vector<double> x_(nb), y_(nb), Z_(nb);
 
     // create sd
     unsigned int k_ =0 ;
-    for (std::list<vpPoint>::const_iterator it = listP.begin(); it != listP.end(); ++it)
+    for (k_ = 0; k_ < nb; k_++)
     {
-      P = *it;
-      sd[2*k_] = P.get_x() ;
-      sd[2*k_+1] = P.get_y() ;
-      lP.push_back(P) ;
-      k_ ++;
+      sd[2*k_] = points.x[k_] ;
+      sd[2*k_+1] = points.y[k_] ;
     }
     int iter = 0 ;
     res.resize(s.getRows()/2) ;
@@ -204,18 +202,17 @@ vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
       residu_1 = r ;
 
       // Compute the interaction matrix and the error
-      k_ =0 ;
-      for (std::list<vpPoint>::const_iterator it = lP.begin(); it != lP.end(); ++it)
+      // forward projection of the 3D model for a given pose
+      // change frame coordinates
+      // perspective projection
+      if (nb > 0)
+        vpPoint::projectPoints(cMo, &points.oX[0], &points.oY[0], &points.oZ[0], nb, &x_[0], &y_[0], &Z_[0]);
+
+      for (k_ = 0; k_ < nb; k_++)
       {
-        P = *it;
-        // forward projection of the 3D model for a given pose
-        // change frame coordinates
-        // perspective projection
-        P.track(cMo) ;
-
-        double x = s[2*k_] = P.get_x();  // point projected from cMo
-        double y = s[2*k_+1] = P.get_y();
-        double Z = P.get_Z() ;
+        double x = s[2*k_] = x_[k_];  // point projected from cMo
+        double y = s[2*k_+1] = y_[k_];
+        double Z = Z_[k_] ;
         L[2*k_][0] = -1/Z  ;
         L[2*k_][1] = 0 ;
         L[2*k_][2] = x/Z ;
@@ -229,9 +226,6 @@ vpPose::poseVirtualVSrobust(vpHomogeneousMatrix & cMo)
         L[2*k_+1][3] = 1+y*y ;
         L[2*k_+1][4] = -x*y ;
         L[2*k_+1][5] = -x ;
-
-        k_ ++;
-
       }
       error = s - sd ;
 
@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Test the multi-images camera calibration.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testCalibrationMulti.cpp
+
+  Calibrate a camera with and without distortion from synthetic images of a
+  planar grid seen from many poses, compare the estimated parameters with the
+  ground truth and check that the result does not depend on the number of
+  threads.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpMeterPixelConversion.h>
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpCalibration.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Images of a 9x7 grid with 3 cm squares, observed with a noise of +/- noise pixels
+void createCalibrationData(vpUniRand &rand, const vpCameraParameters &cam, unsigned int nbImages, double noise,
+                           std::vector<vpCalibration> &table_cal)
+{
+  table_cal.clear();
+  for (unsigned int n = 0; n < nbImages; n++) {
+    // Camera looking at the center of the grid
+    vpHomogeneousMatrix cMg(0.04 * (rand() - 0.5), 0.04 * (rand() - 0.5), 0.45 + 0.3 * rand(),
+                            vpMath::rad(50 * (rand() - 0.5)), vpMath::rad(50 * (rand() - 0.5)),
+                            vpMath::rad(60 * (rand() - 0.5)));
+    vpHomogeneousMatrix cMo = cMg * vpHomogeneousMatrix(-0.12, -0.09, 0, 0, 0, 0);
+    vpCalibration calib;
+    calib.clearPoint();
+    for (unsigned int i = 0; i < 7; i++) {
+      for (unsigned int j = 0; j < 9; j++) {
+        double oX = 0.03 * j, oY = 0.03 * i, oZ = 0;
+        double cX = cMo[0][0] * oX + cMo[0][1] * oY + cMo[0][2] * oZ + cMo[0][3];
+        double cY = cMo[1][0] * oX + cMo[1][1] * oY + cMo[1][2] * oZ + cMo[1][3];
+        double cZ = cMo[2][0] * oX + cMo[2][1] * oY + cMo[2][2] * oZ + cMo[2][3];
+        double u = 0, v = 0;
+        vpMeterPixelConversion::convertPoint(cam, cX / cZ, cY / cZ, u, v);
+        vpImagePoint ip(v + noise * (2 * rand() - 1), u + noise * (2 * rand() - 1));
+        calib.addPoint(oX, oY, oZ, ip);
+      }
+    }
+    table_cal.push_back(calib);
+  }
+}
+
+bool closeParameters(const vpCameraParameters &cam, const vpCameraParameters &truth, double tolerance)
+{
+  return std::fabs(cam.get_px() - truth.get_px()) < tolerance && std::fabs(cam.get_py() - truth.get_py()) < tolerance &&
+         std::fabs(cam.get_u0() - truth.get_u0()) < tolerance && std::fabs(cam.get_v0() - truth.get_v0()) < tolerance;
+}
+
+bool sameParameters(const vpCameraParameters &cam1, const vpCameraParameters &cam2)
+{
+  return cam1.get_px() == cam2.get_px() && cam1.get_py() == cam2.get_py() && cam1.get_u0() == cam2.get_u0() &&
+         cam1.get_v0() == cam2.get_v0() && cam1.get_kud() == cam2.get_kud() && cam1.get_kdu() == cam2.get_kdu();
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the calibration from several images.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+    std::cout.precision(10);
+
+    vpCameraParameters cam_true;
+    cam_true.initPersProjWithDistortion(600, 605, 322, 238, -0.15, 0.16);
+    vpCameraParameters cam_init;
+    cam_init.initPersProjWithoutDistortion(550, 550, 320, 240);
+
+    const unsigned int nbImages[2] = { 3, 120 };
+    for (unsigned int c = 0; c < 2; c++) {
+      std::vector<vpCalibration> table_cal;
+      createCalibrationData(rand, cam_true, nbImages[c], 0.2, table_cal);
+      std::stringstream ss;
+      ss << nbImages[c] << " images";
+
+      // With the default number of threads, and with 3 threads
+      vpCameraParameters cam[2];
+      double error[2];
+      double t[2];
+      for (unsigned int n = 0; n < 2; n++) {
+        vpThreadPool::setConcurrency(n == 0 ? 0 : 3);
+        std::vector<vpCalibration> table(table_cal);
+        cam[n] = cam_init;
+        t[n] = vpTime::measureTimeMs();
+        vpCalibration::computeCalibrationMulti(vpCalibration::CALIB_VIRTUAL_VS_DIST, table, cam[n], error[n], false);
+        t[n] = vpTime::measureTimeMs() - t[n];
+      }
+      vpThreadPool::setConcurrency(0);
+
+      if (!(closeParameters(cam[0], cam_true, 2.))) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": intrinsic parameters").c_str());
+      }
+      if (!(std::fabs(cam[0].get_kud() - cam_true.get_kud()) < 0.02 && std::fabs(cam[0].get_kdu() - cam_true.get_kdu()) < 0.02)) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": distortion").c_str());
+      }
+      if (error[0] >= 0.2) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": reprojection error").c_str());
+      }
+      if (!(sameParameters(cam[0], cam[1]) && error[0] == error[1])) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": same result with 3 threads").c_str());
+      }
+      std::cout << "  px " << cam[0].get_px() << " py " << cam[0].get_py() << " u0 " << cam[0].get_u0() << " v0 "
+                << cam[0].get_v0() << " kud " << cam[0].get_kud() << " kdu " << cam[0].get_kdu() << " error "
+                << error[0] << ", " << t[0] << " ms" << std::endl;
+    }
+
+    std::cout << "Calibration test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the robust estimation of an homography with RANSAC.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testHomographyRansac.cpp
+
+  Estimate homographies with vpHomography::ransac() from matched points with
+  outliers, with one and several threads, and check the inliers, the
+  homography and the stopping conditions.
+*/
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpThreadPool.h>
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpHomography.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Points of image b, their transfer in image a with some noise, and a ratio of outliers moved away
+void createPoints(vpUniRand &rand, const vpHomography &aHb, unsigned int n, double outlierRatio,
+                  std::vector<double> &xb, std::vector<double> &yb, std::vector<double> &xa, std::vector<double> &ya,
+                  std::vector<bool> &isInlier)
+{
+  xb.resize(n); yb.resize(n); xa.resize(n); ya.resize(n); isInlier.resize(n);
+  for (unsigned int i = 0; i < n; i++) {
+    xb[i] = rand() - 0.5;
+    yb[i] = rand() - 0.5;
+    double w = aHb[2][0] * xb[i] + aHb[2][1] * yb[i] + aHb[2][2];
+    xa[i] = (aHb[0][0] * xb[i] + aHb[0][1] * yb[i] + aHb[0][2]) / w + (rand() - 0.5) * 1e-4;
+    ya[i] = (aHb[1][0] * xb[i] + aHb[1][1] * yb[i] + aHb[1][2]) / w + (rand() - 0.5) * 1e-4;
+    isInlier[i] = rand() >= outlierRatio;
+    if (!isInlier[i]) {
+      xa[i] += (rand() < 0.5 ? -1 : 1) * (0.02 + 0.2 * rand());
+      ya[i] += (rand() < 0.5 ? -1 : 1) * (0.02 + 0.2 * rand());
+    }
+  }
+}
+
+double distance(const vpHomography &H1, const vpHomography &H2)
+{
+  double d = 0;
+  for (unsigned int i = 0; i < 3; i++)
+    for (unsigned int j = 0; j < 3; j++)
+      d += vpMath::sqr(H1[i][j] / H1[2][2] - H2[i][j] / H2[2][2]);
+  return sqrt(d);
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the robust estimation of a homography with RANSAC.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+
+    vpHomography aHb;
+    aHb[0][0] = 1.02; aHb[0][1] = 0.05; aHb[0][2] = 0.01;
+    aHb[1][0] = -0.03; aHb[1][1] = 0.98; aHb[1][2] = -0.02;
+    aHb[2][0] = 0.1; aHb[2][1] = -0.05; aHb[2][2] = 1;
+    const double threshold = 2e-3;
+
+    const unsigned int sizes[3] = { 20, 200, 2000 };
+    const double outlierRatios[3] = { 0.2, 0.5, 0.3 };
+    for (unsigned int c = 0; c < 3; c++) {
+      std::vector<double> xb, yb, xa, ya;
+      std::vector<bool> isInlier;
+      createPoints(rand, aHb, sizes[c], outlierRatios[c], xb, yb, xa, ya, isInlier);
+      unsigned int nbInliers = 0;
+      for (size_t i = 0; i < isInlier.size(); i++)
+        nbInliers += isInlier[i] ? 1 : 0;
+
+      // Sampling until a consensus set with all the inliers is found, then with the adaptive number of trials
+      for (unsigned int consensus = 0; consensus < 2; consensus++) {
+        unsigned int nbInliersConsensus = consensus == 0 ? nbInliers : nbInliers / 2;
+        for (unsigned int nbThreads = 1; nbThreads <= 3; nbThreads += 2) {
+          vpHomography H;
+          std::vector<bool> inliers;
+          double residual = 0;
+          double t = vpTime::measureTimeMs();
+          bool found = vpHomography::ransac(xb, yb, xa, ya, H, inliers, residual, nbInliersConsensus, threshold,
+                                            true, 1000, 0.99, 0, nbThreads);
+          t = vpTime::measureTimeMs() - t;
+
+          std::stringstream ss;
+          ss << sizes[c] << " points with " << sizes[c] - nbInliers << " outliers, consensus "
+             << nbInliersConsensus << ", " << nbThreads << " threads (" << t << " ms)";
+          bool same = inliers.size() == isInlier.size();
+          for (size_t i = 0; i < inliers.size() && same; i++) {
+            // An outlier may fall below the threshold, an inlier may not be consistent with a sample
+            same &= (!inliers[i] || isInlier[i]) || consensus == 1;
+          }
+          unsigned int nbFound = 0;
+          for (size_t i = 0; i < inliers.size(); i++)
+            nbFound += inliers[i] ? 1 : 0;
+          if (!(found && same && nbFound >= nbInliersConsensus && residual < threshold && distance(H, aHb) < 1e-3)) {
+            throw vpException(vpException::fatalError, "%s failed", ss.str().c_str());
+          }
+        }
+      }
+    }
+
+    // Consensus that cannot be reached
+    {
+      std::vector<double> xb, yb, xa, ya;
+      std::vector<bool> isInlier, inliers;
+      createPoints(rand, aHb, 100, 0.5, xb, yb, xa, ya, isInlier);
+      vpHomography H;
+      double residual = 0;
+      bool found = vpHomography::ransac(xb, yb, xa, ya, H, inliers, residual, 90, threshold);
+      unsigned int nbFound = 0;
+      for (size_t i = 0; i < inliers.size(); i++)
+        nbFound += inliers[i] ? 1 : 0;
+      if (!(!found && inliers.size() == 100 && nbFound > 0)) {
+        throw vpException(vpException::fatalError, "Consensus not reached failed");
+      }
+
+      // Time budget
+      double t = vpTime::measureTimeMs();
+      found = vpHomography::ransac(xb, yb, xa, ya, H, inliers, residual, 90, threshold, true, -1, 1, 50, 2);
+      t = vpTime::measureTimeMs() - t;
+      std::stringstream ss;
+      ss << "Time budget of 50 ms (" << t << " ms)";
+      if (!(!found && t > 45 && t < 1000)) {
+        throw vpException(vpException::fatalError, "%s failed", ss.str().c_str());
+      }
+    }
+
+    // Colinear points
+    {
+      std::vector<double> xb(10), yb(10), xa(10), ya(10);
+      for (unsigned int i = 0; i < 10; i++) {
+        xb[i] = xa[i] = 0.1 * i;
+        yb[i] = ya[i] = 0.2 * i;
+      }
+      vpHomography H;
+      std::vector<bool> inliers;
+      double residual = 0;
+      if (!(!vpHomography::ransac(xb, yb, xa, ya, H, inliers, residual, 6, threshold))) {
+        throw vpException(vpException::fatalError, "Colinear points failed");
+      }
+    }
+
+    std::cout << "Homography RANSAC test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,307 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the nearest neighbor search of binary descriptors.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testHammingIndex.cpp
+
+  Compare the nearest neighbors and the matches found by vpHammingIndex with
+  a brute-force search, for descriptors of different sizes, sets of different
+  sizes and different numbers of threads, and compare the search times.
+*/
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <visp3/core/vpTime.h>
+#include <visp3/core/vpUniRand.h>
+#include <visp3/vision/vpHammingIndex.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+// Query descriptors: noisy copies of indexed descriptors, and random descriptors
+void createDescriptors(vpUniRand &rand, unsigned int nbTrain, unsigned int nbQueries, unsigned int size,
+                       std::vector<unsigned char> &train, std::vector<unsigned char> &queries)
+{
+  train.resize(nbTrain * size);
+  for (size_t i = 0; i < train.size(); i++)
+    train[i] = (unsigned char) (rand() * 256);
+
+  queries.resize(nbQueries * size);
+  for (unsigned int q = 0; q < nbQueries; q++) {
+    if (q % 3 == 2) {
+      for (unsigned int b = 0; b < size; b++)
+        queries[q * size + b] = (unsigned char) (rand() * 256);
+    } else {
+      unsigned int t = (unsigned int) (rand() * nbTrain);
+      for (unsigned int b = 0; b < size; b++)
+        queries[q * size + b] = train[t * size + b];
+      unsigned int nbFlips = (unsigned int) (rand() * size * 8 / 6);
+      for (unsigned int f = 0; f < nbFlips; f++) {
+        unsigned int bit = (unsigned int) (rand() * size * 8);
+        queries[q * size + bit / 8] ^= (unsigned char) (1 << (bit % 8));
+      }
+    }
+  }
+}
+
+// k nearest neighbors sorted by distance then index
+std::vector<std::vector<vpHammingIndex::Match> > bruteForceKnn(const std::vector<unsigned char> &train,
+                                                                 const std::vector<unsigned char> &queries,
+                                                                 unsigned int size, unsigned int k)
+{
+  unsigned int nbTrain = (unsigned int) train.size() / size, nbQueries = (unsigned int) queries.size() / size;
+  unsigned int nbBits[256];
+  nbBits[0] = 0;
+  for (unsigned int x = 1; x < 256; x++)
+    nbBits[x] = (x & 1) + nbBits[x / 2];
+  std::vector<std::vector<vpHammingIndex::Match> > knn(nbQueries);
+  for (unsigned int q = 0; q < nbQueries; q++) {
+    for (unsigned int t = 0; t < nbTrain; t++) {
+      vpHammingIndex::Match m;
+      m.queryIdx = q;
+      m.trainIdx = t;
+      m.distance = 0;
+      for (unsigned int b = 0; b < size; b++)
+        m.distance += nbBits[queries[q * size + b] ^ train[t * size + b]];
+      size_t pos = knn[q].size();
+      while (pos > 0 && m.distance < knn[q][pos - 1].distance)
+        pos--;
+      if (pos < k) {
+        knn[q].insert(knn[q].begin() + (long) pos, m);
+        if (knn[q].size() > k)
+          knn[q].pop_back();
+      }
+    }
+  }
+  return knn;
+}
+
+bool sameMatch(const vpHammingIndex::Match &m1, const vpHammingIndex::Match &m2)
+{
+  return m1.queryIdx == m2.queryIdx && m1.trainIdx == m2.trainIdx && m1.distance == m2.distance;
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the matching of binary descriptors with a Hamming index.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpUniRand rand(0);
+
+    // ORB and BRISK sizes, a size that is not a multiple of 16 bytes (AKAZE), and a linear scan
+    const unsigned int sizes[4] = { 32, 64, 61, 32 };
+    const unsigned int nbTrains[4] = { 20000, 8000, 6000, 500 };
+    const unsigned int nbQueries = 1500;
+    const double ratio = 0.8;
+
+    for (unsigned int c = 0; c < 4; c++) {
+      std::vector<unsigned char> train, queries;
+      createDescriptors(rand, nbTrains[c], nbQueries, sizes[c], train, queries);
+      std::stringstream ss;
+      ss << nbTrains[c] << " descriptors of " << sizes[c] << " bytes";
+
+      double t = vpTime::measureTimeMs();
+      std::vector<std::vector<vpHammingIndex::Match> > reference = bruteForceKnn(train, queries, sizes[c], 2);
+      double t_brute_force = vpTime::measureTimeMs() - t;
+
+      t = vpTime::measureTimeMs();
+      vpHammingIndex index;
+      index.build(&train[0], nbTrains[c], sizes[c]);
+      double t_build = vpTime::measureTimeMs() - t;
+      if (index.getNbSubstrings() != (nbTrains[c] < 4096 ? 0 : sizes[c] / 2)) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": tables").c_str());
+      }
+
+      // Two nearest neighbors, with one and several threads
+      for (unsigned int nbThreads = 0; nbThreads < 3; nbThreads++) {
+        std::vector<std::vector<vpHammingIndex::Match> > knn;
+        index.knnMatch(&queries[0], nbQueries, 2, knn, nbThreads);
+        bool same = (knn.size() == reference.size());
+        for (size_t q = 0; q < knn.size() && same; q++) {
+          same &= (knn[q].size() == 2 && sameMatch(knn[q][0], reference[q][0]) && sameMatch(knn[q][1], reference[q][1]));
+        }
+        std::stringstream ss_threads;
+        ss_threads << ": knn with " << nbThreads << " threads";
+        if (!same) {
+          throw vpException(vpException::fatalError, "%s failed", (ss.str() + ss_threads.str()).c_str());
+        }
+      }
+
+      // Ratio test and cross-check
+      std::vector<vpHammingIndex::Match> expected;
+      std::vector<std::vector<vpHammingIndex::Match> > reverse;
+      {
+        std::vector<unsigned char> matchedTrain;
+        std::vector<vpHammingIndex::Match> candidates;
+        for (size_t q = 0; q < reference.size(); q++) {
+          if (reference[q][0].distance < ratio * reference[q][1].distance) {
+            candidates.push_back(reference[q][0]);
+            matchedTrain.insert(matchedTrain.end(), train.begin() + reference[q][0].trainIdx * sizes[c],
+                                train.begin() + (reference[q][0].trainIdx + 1) * sizes[c]);
+          }
+        }
+        reverse = bruteForceKnn(queries, matchedTrain, sizes[c], 1);
+        for (size_t i = 0; i < candidates.size(); i++) {
+          if (reverse[i][0].trainIdx == candidates[i].queryIdx)
+            expected.push_back(candidates[i]);
+        }
+      }
+
+      t = vpTime::measureTimeMs();
+      std::vector<vpHammingIndex::Match> matches;
+      index.match(&queries[0], nbQueries, matches, ratio, true);
+      double t_match = vpTime::measureTimeMs() - t;
+      bool same = (matches.size() == expected.size());
+      for (size_t i = 0; i < matches.size() && same; i++)
+        same &= sameMatch(matches[i], expected[i]);
+      if (!(same && !matches.empty())) {
+        throw vpException(vpException::fatalError, "%s failed", (ss.str() + ": ratio test and cross-check").c_str());
+      }
+
+      std::cout << "  brute-force knn: " << t_brute_force << " ms, index build: " << t_build
+                << " ms, match: " << t_match << " ms, " << matches.size() << " matches" << std::endl;
+    }
+
+    // Empty index and distance
+    {
+      vpHammingIndex index;
+      std::vector<unsigned char> query(32, 0);
+      std::vector<vpHammingIndex::Match> matches;
+      index.match(&query[0], 1, matches);
+      std::vector<std::vector<vpHammingIndex::Match> > knnMatches;
+      index.knnMatch(&query[0], 1, 2, knnMatches);
+      if (!matches.empty() || knnMatches.size() != 1 || !knnMatches[0].empty()) {
+        throw vpException(vpException::fatalError, "Empty index failed");
+      }
+      index.build(&query[0], 0, 32);
+      index.knnMatch(&query[0], 1, 2, knnMatches);
+      if (knnMatches.size() != 1 || !knnMatches[0].empty()) {
+        throw vpException(vpException::fatalError, "Index without descriptor failed");
+      }
+
+      std::vector<unsigned char> d1(40, 0xff), d2(40, 0x0f);
+      if (vpHammingIndex::distance(&d1[0], &d2[0], 40) != 160) {
+        throw vpException(vpException::fatalError, "Distance failed");
+      }
+    }
+
+    std::cout << "Hamming index test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}
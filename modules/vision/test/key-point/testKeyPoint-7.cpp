@@ -418,6 +418,71 @@ int main(int argc, const char ** argv) {
       }
 
 
+      //Save in binary in the memory mapped format
+      filename = vpIoTools::createFilePath(opath, "bin_mapped");
+      vpIoTools::makeDirectory(filename);
+      filename = vpIoTools::createFilePath(filename, "test_save_in_bin_mapped.bin");
+      keyPoints.saveLearningData(filename, true, false, true);
+
+      //Test if save is ok
+      if(!vpIoTools::checkFilename(filename) || vpIoTools::checkFilename(filename + ".tmp")) {
+        std::stringstream ss;
+        ss << "Problem when saving file=" << filename;
+        throw vpException(vpException::ioError, ss.str().c_str());
+      }
+
+      //Test if read is ok
+      vpKeyPoint read_keypoint_mapped;
+      read_keypoint_mapped.loadLearningData(filename, true);
+      trainKeyPoints_read.clear();
+      read_keypoint_mapped.getTrainKeyPoints(trainKeyPoints_read);
+      trainDescriptors_read = read_keypoint_mapped.getTrainDescriptors();
+
+      if(!compareKeyPoints(trainKeyPoints, trainKeyPoints_read)) {
+        throw vpException(vpException::fatalError, "Problem with trainKeyPoints when reading learning file saved in "
+            "binary in the memory mapped format !");
+      }
+
+      if(!compareDescriptors(trainDescriptors, trainDescriptors_read)) {
+        throw vpException(vpException::fatalError, "Problem with trainDescriptors when reading learning file saved in "
+            "binary in the memory mapped format !");
+      }
+
+      //The descriptors refer to the mapped file, matching must give the same matches as with the original data
+      unsigned int nbMatches = keyPoints.matchPoint(I);
+      unsigned int nbMatches_mapped = read_keypoint_mapped.matchPoint(I);
+      std::vector<cv::DMatch> matches = keyPoints.getMatches();
+      std::vector<cv::DMatch> matches_mapped = read_keypoint_mapped.getMatches();
+      if(nbMatches == 0 || nbMatches != nbMatches_mapped || matches.size() != matches_mapped.size()) {
+        std::stringstream ss;
+        ss << "Problem when matching with the learning file loaded in the memory mapped format: " << nbMatches_mapped
+           << " matches instead of " << nbMatches << " !";
+        throw vpException(vpException::fatalError, ss.str().c_str());
+      }
+      for(size_t cpt = 0; cpt < matches.size(); cpt++) {
+        if(matches[cpt].queryIdx != matches_mapped[cpt].queryIdx || matches[cpt].trainIdx != matches_mapped[cpt].trainIdx ||
+           !vpMath::equal(matches[cpt].distance, matches_mapped[cpt].distance, std::numeric_limits<float>::epsilon())) {
+          throw vpException(vpException::fatalError, "Problem with the matches of the learning file loaded in the "
+              "memory mapped format !");
+        }
+      }
+
+      //Replace the file that is mapped by the loaded learning data
+      read_keypoint_mapped.saveLearningData(filename, true, false, true);
+      vpKeyPoint read_keypoint_remapped;
+      read_keypoint_remapped.loadLearningData(filename, true);
+      trainKeyPoints_read.clear();
+      read_keypoint_remapped.getTrainKeyPoints(trainKeyPoints_read);
+      trainDescriptors_read = read_keypoint_remapped.getTrainDescriptors();
+
+      if(!compareKeyPoints(trainKeyPoints, trainKeyPoints_read) ||
+         !compareDescriptors(trainDescriptors, trainDescriptors_read) ||
+         !compareDescriptors(trainDescriptors, read_keypoint_mapped.getTrainDescriptors())) {
+        throw vpException(vpException::fatalError, "Problem when replacing a learning file saved in binary in the "
+            "memory mapped format !");
+      }
+
+
 #if defined(VISP_HAVE_XML2)
       //Save in xml with training images
       filename = vpIoTools::createFilePath(opath, "xml_with_img");
@@ -0,0 +1,326 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the guided matching of vpKeyPoint.
+ *
+ *****************************************************************************/
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_OPENCV) && (VISP_HAVE_OPENCV_VERSION >= 0x020301)
+
+#include <visp3/core/vpCameraParameters.h>
+#include <visp3/core/vpException.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpImagePoint.h>
+#include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpRect.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/io/vpParseArgv.h>
+#include <visp3/vision/vpKeyPoint.h>
+
+// List of allowed command line options
+#define GETOPTARGS	"cdo:h"
+
+void usage(const char *name, const char *badparam, std::string opath, std::string user);
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+  \param opath : Output path.
+  \param user : Username.
+
+*/
+void usage(const char *name, const char *badparam, std::string opath, std::string user)
+{
+  fprintf(stdout, "\n\
+Test the guided matching of vpKeyPoint.\n\
+\n\
+SYNOPSIS\n\
+  %s [-o <output path>] [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -o <output path>                                     %s\n\
+     Set output path.\n\
+     From this directory, creates the \"%s\"\n\
+     subdirectory depending on the username, where \n\
+     the learning file will be written.\n\
+\n\
+  -h\n\
+     Print the help.\n",
+     opath.c_str(), user.c_str());
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \param opath : Output path.
+  \param user : Username.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv, std::string &opath, std::string user)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c': break; //not used, to avoid error with default arguments ctest
+    case 'd': break; //not used, to avoid error with default arguments ctest
+    case 'o': opath = optarg_; break;
+    case 'h': usage(argv[0], NULL, opath, user); return false; break;
+
+    default:
+      usage(argv[0], optarg_, opath, user); return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL, opath, user);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/*!
+  \example testKeyPoint-8.cpp
+
+  \brief   Test the guided matching of vpKeyPoint.
+
+  The reference keypoints lie on a plane in front of the camera. The image is
+  matched twice, the second matching being guided by the pose of the first one.
+  The image shifted by more than the guided matching radius makes the guided
+  pose fail, and the keypoints are then matched to the whole reference. The
+  pose of the previous frame must be forgotten when the reference is built
+  again or when learning data are loaded. Finally, the bounding box given by
+  matchPointAndDetect() must be the one of the reference keypoints.
+*/
+int main(int argc, const char ** argv) {
+  try {
+    std::string env_ipath;
+    std::string opt_opath;
+    std::string username;
+    std::string opath;
+
+    //Get the visp-images-data package path or VISP_INPUT_IMAGE_PATH environment variable value
+    env_ipath = vpIoTools::getViSPImagesDataPath();
+
+    if(env_ipath.empty()) {
+      throw vpException(vpException::ioError, "Please set the VISP_INPUT_IMAGE_PATH environment variable value.");
+    }
+
+    // Set the default output path
+#if defined(_WIN32)
+    opt_opath = "C:/temp";
+#else
+    opt_opath = "/tmp";
+#endif
+
+    // Get the user login name
+    vpIoTools::getUserName(username);
+
+    // Read the command line options
+    if (getOptions(argc, argv, opt_opath, username) == false) {
+      throw vpException(vpException::fatalError, "getOptions(argc, argv, opt_opath, username) == false");
+    }
+
+    // Append to the output path string, the login name of the user
+    opath = vpIoTools::createFilePath(opt_opath, username);
+
+    // Test if the output path exist. If no try to create it
+    if (vpIoTools::checkDirectory(opath) == false) {
+      try {
+        // Create the dirname
+        vpIoTools::makeDirectory(opath);
+      }
+      catch (...) {
+        usage(argv[0], NULL, opt_opath, username);
+        std::stringstream ss;
+        ss << std::endl << "ERROR:" << std::endl;
+        ss << "  Cannot create " << opath << std::endl;
+        ss << "  Check your -o " << opt_opath << " option " << std::endl;
+        throw vpException(vpException::ioError, ss.str().c_str());
+      }
+    }
+
+    vpImage<unsigned char> I;
+    std::string filename = vpIoTools::createFilePath(env_ipath, "ViSP-images/Klimt/Klimt.pgm");
+    vpImageIo::read(I, filename);
+
+    //The reference plane is at 1 meter in front of the camera, the object frame being the camera frame
+    vpCameraParameters cam(600.0, 600.0, I.getWidth() / 2.0, I.getHeight() / 2.0);
+    vpKeyPoint keypoints("ORB", "ORB", "BruteForce-Hamming");
+    keypoints.setUseGuidedMatching(true);
+    keypoints.setGuidedMatchingRadius(10.0);
+    keypoints.setRansacMinInlierCount(30);
+
+    std::vector<cv::KeyPoint> trainKeyPoints;
+    keypoints.detect(I, trainKeyPoints);
+    std::vector<cv::Point3f> points3f;
+    for(size_t i = 0; i < trainKeyPoints.size(); i++) {
+      double x = (trainKeyPoints[i].pt.x - cam.get_u0()) / cam.get_px();
+      double y = (trainKeyPoints[i].pt.y - cam.get_v0()) / cam.get_py();
+      points3f.push_back(cv::Point3f((float) x, (float) y, 1.0f));
+    }
+    keypoints.buildReference(I, trainKeyPoints, points3f);
+    std::cout << "Build " << trainKeyPoints.size() << " reference points." << std::endl;
+
+    //First frame: no previous pose, the keypoints are matched to the whole reference
+    vpHomogeneousMatrix cMo, cMo_guided;
+    if(!keypoints.matchPoint(I, cam, cMo)) {
+      throw vpException(vpException::fatalError, "No pose with the matching to the whole reference !");
+    }
+    if(keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "The first frame can not be matched with the guided matching !");
+    }
+    if(!keypoints.getGuidedMatchingPose(cMo_guided)) {
+      throw vpException(vpException::fatalError, "The pose of the first frame does not guide the next matching !");
+    }
+
+    //Second frame: matched around the projections of the reference points with the pose of the first frame
+    if(!keypoints.matchPoint(I, cam, cMo)) {
+      throw vpException(vpException::fatalError, "No pose with the guided matching !");
+    }
+    if(!keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "The second frame has not been matched with the guided matching !");
+    }
+    if(cMo.getTranslationVector().euclideanNorm() > 0.01) {
+      std::stringstream ss;
+      ss << "Wrong pose with the guided matching: " << cMo.getTranslationVector().t();
+      throw vpException(vpException::fatalError, ss.str());
+    }
+
+    //The image shifted by 60 pixels is too far from the projections of the previous pose,
+    //the keypoints are matched again to the whole reference
+    const unsigned int shift = 60;
+    vpImage<unsigned char> Ishift(I.getHeight(), I.getWidth(), 0);
+    for(unsigned int i = 0; i < I.getHeight(); i++) {
+      for(unsigned int j = shift; j < I.getWidth(); j++) {
+        Ishift[i][j] = I[i][j - shift];
+      }
+    }
+    if(!keypoints.matchPoint(Ishift, cam, cMo)) {
+      throw vpException(vpException::fatalError, "No pose when the guided matching fails !");
+    }
+    if(keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "The shifted frame must be matched to the whole reference !");
+    }
+    //The plane is at 1 meter, a shift of 60 pixels is a translation of 0.1 meter
+    if(std::fabs(cMo[0][3] - shift / cam.get_px()) > 0.01) {
+      std::stringstream ss;
+      ss << "Wrong pose after the guided matching failed: " << cMo.getTranslationVector().t();
+      throw vpException(vpException::fatalError, ss.str());
+    }
+
+    //The pose found with the previous reference must not guide the matching anymore
+    keypoints.buildReference(I, trainKeyPoints, points3f);
+    if(keypoints.getGuidedMatchingPose(cMo_guided)) {
+      throw vpException(vpException::fatalError, "buildReference() keeps the pose of the previous reference !");
+    }
+    if(!keypoints.matchPoint(I, cam, cMo) || keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "The first frame after buildReference() is not matched to the whole "
+                        "reference !");
+    }
+
+    filename = vpIoTools::createFilePath(opath, "testKeyPoint-8.bin");
+    keypoints.saveLearningData(filename, true, false);
+    if(!keypoints.getGuidedMatchingPose(cMo_guided)) {
+      throw vpException(vpException::fatalError, "The pose of the previous frame is lost !");
+    }
+    keypoints.loadLearningData(filename, true);
+    if(keypoints.getGuidedMatchingPose(cMo_guided)) {
+      throw vpException(vpException::fatalError, "loadLearningData() keeps the pose of the previous reference !");
+    }
+    if(!keypoints.matchPoint(I, cam, cMo) || keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "The first frame after loadLearningData() is not matched to the "
+                        "whole reference !");
+    }
+    if(!keypoints.matchPoint(I, cam, cMo) || !keypoints.isGuidedMatchingUsed()) {
+      throw vpException(vpException::fatalError, "No guided matching with the loaded learning data !");
+    }
+
+    //The reference points projected with the pose of the unmoved image are the reference keypoints
+    vpRect boundingBox;
+    vpImagePoint centerOfGravity;
+    double error, elapsedTime;
+    if(!keypoints.matchPointAndDetect(I, cam, cMo, error, elapsedTime, boundingBox, centerOfGravity)) {
+      throw vpException(vpException::fatalError, "No pose with matchPointAndDetect() !");
+    }
+    std::vector<vpImagePoint> referencePoints;
+    keypoints.getTrainKeyPoints(referencePoints);
+    vpRect referenceBoundingBox(referencePoints);
+    if(std::fabs(boundingBox.getLeft() - referenceBoundingBox.getLeft()) > 2.0 ||
+       std::fabs(boundingBox.getTop() - referenceBoundingBox.getTop()) > 2.0 ||
+       std::fabs(boundingBox.getRight() - referenceBoundingBox.getRight()) > 2.0 ||
+       std::fabs(boundingBox.getBottom() - referenceBoundingBox.getBottom()) > 2.0 ||
+       !boundingBox.isInside(centerOfGravity)) {
+      std::stringstream ss;
+      ss << "Wrong detection with matchPointAndDetect(): " << boundingBox << " instead of " << referenceBoundingBox;
+      throw vpException(vpException::fatalError, ss.str());
+    }
+
+  } catch(vpException &e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+
+  std::cout << "testKeyPoint-8 is ok !" << std::endl;
+  return 0;
+}
+#else
+int main() {
+  std::cerr << "You need OpenCV library." << std::endl;
+
+  return 0;
+}
+
+#endif
@@ -35,6 +35,7 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
 #include <iostream>
 
 #include <visp3/core/vpConfig.h>
@@ -50,6 +51,7 @@
 #include <visp3/gui/vpDisplayOpenCV.h>
 #include <visp3/io/vpVideoReader.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpThreadPool.h>
 #include <visp3/io/vpParseArgv.h>
 
 // List of allowed command line options
@@ -231,6 +233,80 @@ int main(int argc, const char ** argv) {
       }
     }
 
+    //Match with multiple affine transformations, the tilts being restricted after the first matching
+    vpKeyPoint keypointsAffine("ORB", "ORB", "BruteForce-Hamming");
+    keypointsAffine.setUseAffineDetection(true);
+    keypointsAffine.setUseAffineTiltRestriction(true);
+    unsigned int nbAffineReferencePoints = keypointsAffine.buildReference(Iref);
+    std::cout << "Build " << nbAffineReferencePoints << " reference points with affine views." << std::endl;
+    if(nbAffineReferencePoints == 0) {
+      throw vpException(vpException::fatalError, "No reference point with affine views !");
+    }
+
+    for(int i = 0; i < 2; i++) {
+      if(keypointsAffine.matchPoint(Iref) == 0) {
+        throw vpException(vpException::fatalError, "No match with affine views !");
+      }
+    }
+
+    //The affine views are shared between the threads of the pool, the result must be the same as with one thread
+    unsigned int concurrency = vpThreadPool::getConcurrency();
+    std::vector<std::vector<cv::KeyPoint> > listOfAffineKeyPoints, listOfAffineKeyPointsSerial;
+    std::vector<cv::Mat> listOfAffineDescriptors, listOfAffineDescriptorsSerial;
+    vpThreadPool::setConcurrency(4);
+    keypointsAffine.detectExtractAffine(Iref, listOfAffineKeyPoints, listOfAffineDescriptors);
+    vpThreadPool::setConcurrency(1);
+    keypointsAffine.detectExtractAffine(Iref, listOfAffineKeyPointsSerial, listOfAffineDescriptorsSerial);
+    vpThreadPool::setConcurrency(concurrency);
+
+    if(listOfAffineKeyPoints.size() != listOfAffineKeyPointsSerial.size()) {
+      throw vpException(vpException::fatalError, "Different number of affine views with one and four threads !");
+    }
+    for(size_t i = 0; i < listOfAffineKeyPoints.size(); i++) {
+      if(listOfAffineKeyPoints[i].size() != listOfAffineKeyPointsSerial[i].size() ||
+         listOfAffineDescriptors[i].rows != listOfAffineDescriptorsSerial[i].rows ||
+         (!listOfAffineDescriptors[i].empty() &&
+          cv::norm(listOfAffineDescriptors[i], listOfAffineDescriptorsSerial[i], cv::NORM_L1) > 0.0)) {
+        throw vpException(vpException::fatalError, "The affine view %d differs with one and four threads !", (int) i);
+      }
+    }
+
+    //Match with the binary descriptors indexed by the "MultiIndexHashing" matcher, the search being exact
+    //the matches must be the ones of the brute-force matcher
+    vpKeyPoint keypointsIndex("ORB", "ORB", "MultiIndexHashing");
+    vpKeyPoint keypointsBruteForce("ORB", "ORB", "BruteForce-Hamming");
+    keypointsIndex.setFilterMatchingType(vpKeyPoint::ratioDistanceThreshold);
+    keypointsBruteForce.setFilterMatchingType(vpKeyPoint::ratioDistanceThreshold);
+    keypointsIndex.buildReference(Iref);
+    keypointsBruteForce.buildReference(Iref);
+
+    unsigned int nbIndexMatches = keypointsIndex.matchPoint(Icur);
+    unsigned int nbBruteForceMatches = keypointsBruteForce.matchPoint(Icur);
+    std::cout << "MultiIndexHashing: " << nbIndexMatches << " matches, BruteForce-Hamming: "
+              << nbBruteForceMatches << " matches." << std::endl;
+    if(nbIndexMatches == 0) {
+      throw vpException(vpException::fatalError, "No match with the MultiIndexHashing matcher !");
+    }
+    if(nbIndexMatches != nbBruteForceMatches) {
+      throw vpException(vpException::fatalError, "The MultiIndexHashing and BruteForce-Hamming matchers differ !");
+    }
+
+    //Ties may be broken differently, but the distances of the matches must be the same
+    std::vector<cv::DMatch> indexMatches = keypointsIndex.getMatches();
+    std::vector<cv::DMatch> bruteForceMatches = keypointsBruteForce.getMatches();
+    std::vector<float> indexDistances, bruteForceDistances;
+    for(size_t i = 0; i < indexMatches.size(); i++) {
+      indexDistances.push_back(indexMatches[i].distance);
+    }
+    for(size_t i = 0; i < bruteForceMatches.size(); i++) {
+      bruteForceDistances.push_back(bruteForceMatches[i].distance);
+    }
+    std::sort(indexDistances.begin(), indexDistances.end());
+    std::sort(bruteForceDistances.begin(), bruteForceDistances.end());
+    if(indexDistances != bruteForceDistances) {
+      throw vpException(vpException::fatalError, "The distances of the MultiIndexHashing matches differ !");
+    }
+
   } catch(vpException &e) {
     std::cerr << e.what() << std::endl;
     return -1;
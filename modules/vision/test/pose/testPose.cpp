@@ -48,13 +48,14 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 #define L 0.035
 
 /*!
   \example testPose.cpp
 
-  Compute the pose of a 3D object using the Dementhon, Lagrange and
+  Compute the pose of a 3D object using the Dementhon, Lagrange, P3P, EPnP and
   Non-Linear approach.
 
 */
@@ -150,6 +151,20 @@ int main()
     fail = compare_pose(pose, cMo_ref, cMo, "pose by Dementhon");
     test_fail |= fail;
 
+    std::cout <<"--------------------------------------------------"<<std::endl ;
+    pose.computePose(vpPose::P3P, cMo) ;
+
+    print_pose(cMo, std::string("Pose estimated by P3P"));
+    fail = compare_pose(pose, cMo_ref, cMo, "pose by P3P");
+    test_fail |= fail;
+
+    std::cout <<"--------------------------------------------------"<<std::endl ;
+    pose.computePose(vpPose::EPNP, cMo) ;
+
+    print_pose(cMo, std::string("Pose estimated by EPnP"));
+    fail = compare_pose(pose, cMo_ref, cMo, "pose by EPnP");
+    test_fail |= fail;
+
     std::cout <<"--------------------------------------------------"<<std::endl ;
     pose.setRansacNbInliersToReachConsensus(4);
     pose.setRansacThreshold(0.01);
@@ -196,6 +211,21 @@ int main()
     fail = compare_pose(pose, cMo_ref, cMo, "pose by Lagrange than by VVS");
     test_fail |= fail;
 
+    std::cout <<"--------------------------------------------------"<<std::endl ;
+    // The residual is computed from contiguous coordinates: compare with a projection of each point
+    vpHomogeneousMatrix cMo_perturbed = vpHomogeneousMatrix(0.005, -0.01, 0.02, vpMath::rad(2), vpMath::rad(-3), 0) * cMo_ref;
+    double residual_ref = 0;
+    for(int i=0 ; i < 5 ; i++) {
+      vpPoint p = P[i];
+      p.project(cMo_perturbed);
+      residual_ref += vpMath::sqr(p.get_x()-P[i].get_x()) + vpMath::sqr(p.get_y()-P[i].get_y());
+    }
+    double residual_est = pose.computeResidual(cMo_perturbed);
+    fail = (std::fabs(residual_est - residual_ref) > 1e-12 * std::max(1., residual_ref)) ? 1 : 0;
+    std::cout << "Residual " << residual_est << " (expected " << residual_ref << ") is "
+              << (fail ? "badly" : "well") << " computed" << std::endl;
+    test_fail |= fail;
+
     std::cout << "\nGlobal pose estimation test " << (test_fail ? "fail" : "is ok") << std::endl;
 
     return test_fail;
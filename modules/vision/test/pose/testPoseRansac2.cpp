@@ -39,6 +39,7 @@
 #include <sstream>
 #include <algorithm>
 #include <map>
+#include <limits>
 #include <visp3/vision/vpPose.h>
 #include <visp3/core/vpPoint.h>
 #include <visp3/core/vpMath.h>
@@ -1905,6 +1906,9 @@ bool testRansac(const std::vector<vpPoint> &bunnyModelPoints_original, const std
   pose_ransac2.setRansacThreshold(threshold);
   int ransac_iterations = vpPose::computeRansacIterations(0.99, 0.4, 4, -1);
   pose_ransac2.setRansacMaxTrials(ransac_iterations);
+  //Adaptive number of trials and early rejection of the hypotheses
+  pose_ransac2.setRansacProbability(0.99);
+  pose_ransac2.setUseRansacSprt(true);
   std::cout << "Number of RANSAC iterations to ensure p=0.99 and epsilon=0.4: " << ransac_iterations << std::endl;
 
   vpHomogeneousMatrix cMo_estimated_RANSAC;
@@ -1930,6 +1934,29 @@ bool testRansac(const std::vector<vpPoint> &bunnyModelPoints_original, const std
   double r_RANSAC_estimated_2 = ground_truth_pose.computeResidual(cMo_estimated_RANSAC_2);
   std::cout << "Corresponding residual (" << ransac_iterations << " iterations): " << r_RANSAC_estimated_2 << std::endl;
 
+  //RANSAC only stopped by the time budget: the consensus cannot be reached and the number of trials is not adapted
+  vpPose pose_ransac_budget;
+  pose_ransac_budget.setRansacFilterFlags(vpPose::PREFILTER_DUPLICATE_POINTS + vpPose::CHECK_DEGENERATE_POINTS);
+  pose_ransac_budget.addPoints(bunnyModelPoints_noisy);
+  pose_ransac_budget.setRansacNbInliersToReachConsensus((unsigned int) bunnyModelPoints_noisy.size() + 1);
+  pose_ransac_budget.setRansacThreshold(threshold);
+  pose_ransac_budget.setRansacMaxTrials(std::numeric_limits<int>::max());
+  pose_ransac_budget.setRansacProbability(1.0);
+  double time_budget = 100.0;
+  pose_ransac_budget.setRansacTimeBudget(time_budget);
+
+  vpHomogeneousMatrix cMo_estimated_RANSAC_budget;
+  double t_RANSAC_budget = vpTime::measureTimeMs();
+  pose_ransac_budget.computePose(vpPose::RANSAC, cMo_estimated_RANSAC_budget);
+  t_RANSAC_budget = vpTime::measureTimeMs() - t_RANSAC_budget;
+
+  std::cout << "\ncMo estimated with RANSAC (" << time_budget << " ms time budget) on noisy data:\n"
+            << cMo_estimated_RANSAC_budget << std::endl;
+  std::cout << "Computation time: " << t_RANSAC_budget << " ms" << std::endl;
+
+  double r_RANSAC_estimated_budget = ground_truth_pose.computeResidual(cMo_estimated_RANSAC_budget);
+  std::cout << "Corresponding residual (" << time_budget << " ms time budget): " << r_RANSAC_estimated_budget << std::endl;
+
 
   pose.computePose(vpPose::DEMENTHON, cMo_dementhon);
   pose.computePose(vpPose::LAGRANGE, cMo_lagrange);
@@ -2060,6 +2087,13 @@ bool testRansac(const std::vector<vpPoint> &bunnyModelPoints_original, const std
     std::cerr << "threshold=" << threshold << std::endl;
     return false;
   } else {
+    //The pose refinement once the budget is elapsed should not take more than a few ms
+    if (r_RANSAC_estimated_budget > threshold || t_RANSAC_budget > time_budget + 1000.0) {
+      std::cerr << "The pose estimated with the RANSAC method and a time budget is badly estimated!" << std::endl;
+      std::cerr << "r_RANSAC_estimated_budget=" << r_RANSAC_estimated_budget << std::endl;
+      std::cerr << "t_RANSAC_budget=" << t_RANSAC_budget << " ms" << std::endl;
+      return false;
+    }
 #ifdef TEST_PARALLEL_RANSAC
     if (r_RANSAC_estimated_parallel > threshold) {
       std::cerr << "The pose estimated with the parallel RANSAC method is badly estimated!" << std::endl;
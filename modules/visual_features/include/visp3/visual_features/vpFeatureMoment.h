@@ -150,6 +150,23 @@ protected:
   double C;
   char _name[255];
 
+  void addFeatureDependency(const char* type);
+  const vpMoment& getMomentDependency(const char* type, bool& found);
+  vpFeatureMoment& getFeatureDependency(const char* type, bool& found);
+
+private:
+  //! Names and pointers of the moments used by the feature, resolved in the moment database.
+  std::vector<const char*> momentDependencyNames;
+  std::vector<const vpMoment*> momentDependencies;
+  unsigned int momentDependencyRevision;
+  //! Names and pointers of the features used by the feature, resolved in the feature database.
+  std::vector<const char*> featureDependencyNames;
+  std::vector<vpFeatureMoment*> featureDependencies;
+  const vpFeatureMomentDatabase* featureDependencyDatabase;
+  unsigned int featureDependencyRevision;
+
+protected:
+
 //private:
 //#ifndef DOXYGEN_SHOULD_SKIP_THIS
 //  vpFeatureMoment(const vpFeatureMoment &fm)
@@ -180,7 +197,10 @@ public:
       moments(data_base),
       featureMomentsDataBase(featureMoments),
       interaction_matrices(nbmatrices),
-      A(A_),B(B_),C(C_)
+      A(A_),B(B_),C(C_),
+      momentDependencyNames(), momentDependencies(), momentDependencyRevision(0),
+      featureDependencyNames(), featureDependencies(), featureDependencyDatabase(NULL),
+      featureDependencyRevision(0)
   {}
 
   virtual ~vpFeatureMoment();
@@ -214,6 +234,7 @@ public:
   void update (double A, double B, double C);
 
   //@}
+  friend class vpFeatureMomentDatabase;
   friend VISP_EXPORT std::ostream& operator<<(std::ostream & os, const vpFeatureMoment& featM);
 };
 
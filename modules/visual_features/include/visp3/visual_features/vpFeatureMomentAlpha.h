@@ -81,7 +81,9 @@ class VISP_EXPORT vpFeatureMomentAlpha : public vpFeatureMoment{
     */
     vpFeatureMomentAlpha(vpMomentDatabase& moments,double A, double B, double C,vpFeatureMomentDatabase* featureMoments=NULL) :
         vpFeatureMoment(moments,A,B,C,featureMoments,1)
-    {}
+    {
+      addFeatureDependency("vpFeatureMomentCentered");
+    }
 
     void compute_interaction();
         /*!
@@ -81,7 +81,11 @@ class VISP_EXPORT vpFeatureMomentAreaNormalized : public vpFeatureMoment{
 
         */
         vpFeatureMomentAreaNormalized(vpMomentDatabase& database,double A_, double B_, double C_,vpFeatureMomentDatabase* featureMoments=NULL)
-          : vpFeatureMoment(database,A_,B_,C_,featureMoments,1){}
+          : vpFeatureMoment(database,A_,B_,C_,featureMoments,1)
+        {
+          addFeatureDependency("vpFeatureMomentBasic");
+          addFeatureDependency("vpFeatureMomentCentered");
+        }
         void compute_interaction();
         /*!
           associated moment name
@@ -87,7 +87,11 @@ class VISP_EXPORT vpFeatureMomentCInvariant : public vpFeatureMoment{
 
     */
     vpFeatureMomentCInvariant(vpMomentDatabase& moments,double A, double B, double C,vpFeatureMomentDatabase* featureMoments=NULL) :
-        vpFeatureMoment(moments,A,B,C,featureMoments,16){}
+        vpFeatureMoment(moments,A,B,C,featureMoments,16)
+    {
+      addFeatureDependency("vpFeatureMomentCentered");
+      addFeatureDependency("vpFeatureMomentBasic");
+    }
     void compute_interaction();
         /*!
           associated moment name
@@ -208,7 +212,10 @@ class VISP_EXPORT vpFeatureMomentCInvariant : public vpFeatureMoment{
     */
     vpFeatureMomentCInvariant(vpMomentDatabase& data_base,double A_, double B_, double C_, vpFeatureMomentDatabase* featureMoments=NULL)
       : vpFeatureMoment(data_base,A_,B_,C_,featureMoments,16), LI(16)
-    {}
+    {
+      addFeatureDependency("vpFeatureMomentCentered");
+      addFeatureDependency("vpFeatureMomentBasic");
+    }
 
     void compute_interaction();
         /*!
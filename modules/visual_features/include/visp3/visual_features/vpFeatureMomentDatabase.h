@@ -47,6 +47,7 @@
 #include <map>
 #include <iostream>
 #include <cstring>
+#include <vector>
 
 class vpFeatureMoment;
 class vpMomentObject;
@@ -145,6 +146,11 @@ int main()
   return 0;
 }
 \endcode
+
+  The features declare the features they depend on, which allows vpFeatureMomentDatabase::updateAll() to
+  update each feature after the features it depends on. The update order is computed once, after the
+  last feature is linked to the database, and the features retrieve each other through pointers resolved
+  at the same time.
 */
 class VISP_EXPORT vpFeatureMomentDatabase{
  private:
@@ -155,12 +161,26 @@ class VISP_EXPORT vpFeatureMomentDatabase{
     char* operator=(const char *){ return NULL;} // Only to avoid a warning under Visual with /Wall flag
   };
   std::map<const char*,vpFeatureMoment*,cmp_str> featureMomentsDataBase;
+  //! Features in the order they were linked to the database.
+  std::vector<vpFeatureMoment*> linkedFeatures;
+  //! Features sorted according to their dependencies.
+  std::vector<vpFeatureMoment*> updateOrder;
+  //! Index in updateOrder of the first feature of each dependency level, followed by the number of features.
+  std::vector<unsigned int> levelStarts;
+  //! Incremented each time a feature is linked to the database.
+  unsigned int revision;
+  //! Revision of the database for which updateOrder was computed.
+  unsigned int updateOrderRevision;
+
   void add(vpFeatureMoment& featureMoment,char* name);
+  vpFeatureMoment* find(const char* type) const;
+  void sortFeatures();
  public:
   /*!
     Default constructor.
   */
-  vpFeatureMomentDatabase() : featureMomentsDataBase() {}
+  vpFeatureMomentDatabase()
+    : featureMomentsDataBase(), linkedFeatures(), updateOrder(), levelStarts(), revision(1), updateOrderRevision(0) {}
   /*!
     Virtual destructor that does nothing.
   */
@@ -151,7 +151,9 @@ class VISP_EXPORT vpFeatureMomentGravityCenter: public vpFeatureMoment{
         */
         vpFeatureMomentGravityCenter(vpMomentDatabase& database,double A_, double B_, double C_,vpFeatureMomentDatabase* featureMoments=NULL)
           : vpFeatureMoment(database,A_,B_,C_,featureMoments,2)
-        {}
+        {
+          addFeatureDependency("vpFeatureMomentBasic");
+        }
         void compute_interaction();
         /*!
           Associated moment name.
@@ -88,7 +88,10 @@ class VISP_EXPORT vpFeatureMomentGravityCenterNormalized : public vpFeatureMomen
         */
         vpFeatureMomentGravityCenterNormalized(vpMomentDatabase& database,double A_, double B_, double C_,vpFeatureMomentDatabase* featureMoments=NULL)
           : vpFeatureMoment(database,A_,B_,C_,featureMoments,2)
-        {}
+        {
+          addFeatureDependency("vpFeatureMomentGravityCenter");
+          addFeatureDependency("vpFeatureMomentAreaNormalized");
+        }
         void compute_interaction();
         /*!
           associated moment name
@@ -245,6 +245,84 @@ void vpFeatureMoment::compute_interaction (){
 
 }
 
+/*!
+  Declares that the feature depends on another feature of the feature database. Should be called in the
+  constructor of the features that use the interaction matrices of other features, so that
+  vpFeatureMomentDatabase::updateAll() updates them first.
+  \param type : Name of the feature's class, as returned by vpFeatureMoment::name().
+*/
+void vpFeatureMoment::addFeatureDependency(const char* type){
+  featureDependencyNames.push_back(type);
+  featureDependencyDatabase = NULL;
+}
+
+/*!
+  Retrieves a moment from the database of moment primitives.
+  The moment is looked for by name the first time and then accessed directly, until a new moment
+  is linked to the database.
+  \param type : Name of the moment's class.
+  \param found : true if the moment is in the database, false otherwise.
+  \return Moment corresponding to \e type. Must not be used if \e found is false.
+*/
+const vpMoment& vpFeatureMoment::getMomentDependency(const char* type, bool& found){
+  if (momentDependencyRevision != moments.getRevision()) {
+    momentDependencyNames.clear();
+    momentDependencies.clear();
+    momentDependencyRevision = moments.getRevision();
+  }
+
+  for (size_t i = 0; i < momentDependencyNames.size(); i++) {
+    if (momentDependencyNames[i] == type || std::strcmp(momentDependencyNames[i], type) == 0) {
+      if (momentDependencies[i] != NULL) {
+        found = true;
+        return *momentDependencies[i];
+      }
+      return moments.get(type, found);
+    }
+  }
+
+  const vpMoment& dependency = moments.get(type, found);
+  momentDependencyNames.push_back(type);
+  momentDependencies.push_back(found ? &dependency : NULL);
+  return dependency;
+}
+
+/*!
+  Retrieves a feature from the feature database.
+  The features declared with addFeatureDependency() or already retrieved are looked for by name once
+  and then accessed directly, until a new feature is linked to the database.
+  \param type : Name of the feature's class.
+  \param found : true if the feature is linked to a database containing a feature of this type, false otherwise.
+  \return Feature corresponding to \e type. Must not be used if \e found is false.
+*/
+vpFeatureMoment& vpFeatureMoment::getFeatureDependency(const char* type, bool& found){
+  found = false;
+  if (featureMomentsDataBase == NULL)
+    return *this;
+
+  if (featureDependencyDatabase != featureMomentsDataBase
+      || featureDependencyRevision != featureMomentsDataBase->revision) {
+    featureDependencies.resize(featureDependencyNames.size());
+    for (size_t i = 0; i < featureDependencyNames.size(); i++)
+      featureDependencies[i] = featureMomentsDataBase->find(featureDependencyNames[i]);
+    featureDependencyDatabase = featureMomentsDataBase;
+    featureDependencyRevision = featureMomentsDataBase->revision;
+  }
+
+  for (size_t i = 0; i < featureDependencyNames.size(); i++) {
+    if (featureDependencyNames[i] == type || std::strcmp(featureDependencyNames[i], type) == 0) {
+      found = (featureDependencies[i] != NULL);
+      return found ? *featureDependencies[i] : *this;
+    }
+  }
+
+  vpFeatureMoment* dependency = featureMomentsDataBase->find(type);
+  featureDependencyNames.push_back(type);
+  featureDependencies.push_back(dependency);
+  found = (dependency != NULL);
+  return found ? *dependency : *this;
+}
+
 vpFeatureMoment::~vpFeatureMoment (){
 }
 
@@ -58,8 +58,8 @@ void vpFeatureMomentAlpha::compute_interaction(){
     bool found_moment_centered;
     bool found_FeatureMoment_centered;
 
-    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered)));
-    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(featureMomentsDataBase->get("vpFeatureMomentCentered",found_FeatureMoment_centered)));
+    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered)));
+    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(getFeatureDependency("vpFeatureMomentCentered",found_FeatureMoment_centered)));
 
     if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
     if(!found_FeatureMoment_centered) throw vpException(vpException::notInitialized,"vpFeatureMomentCentered not found");
@@ -83,8 +83,8 @@ void vpFeatureMomentAlpha::compute_interaction(){
     bool found_moment_centered;
     bool found_moment_gravity;
 
-    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered));
-    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(moments.get("vpMomentGravityCenter",found_moment_gravity));
+    const vpMomentCentered& momentCentered = static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered));
+    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMomentDependency("vpMomentGravityCenter",found_moment_gravity));
     const vpMomentObject& momentObject = moment->getObject();
 
 
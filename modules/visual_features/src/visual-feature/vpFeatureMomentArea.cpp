@@ -76,11 +76,11 @@ void vpFeatureMomentArea::compute_interaction(){
 	else {
         // Get Xg and Yg
 		bool found_xgyg;
-		const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(moments.get("vpMomentGravityCenter",found_xgyg));
+		const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMomentDependency("vpMomentGravityCenter",found_xgyg));
 		if (!found_xgyg) throw vpException(vpException::notInitialized,"vpMomentGravityCenter not found");
 
 		bool found_m00;
-		const vpMomentArea& areamoment = static_cast<const vpMomentArea&>(moments.get("vpMomentArea", found_m00));
+		const vpMomentArea& areamoment = static_cast<const vpMomentArea&>(getMomentDependency("vpMomentArea", found_m00));
 		if (!found_m00) throw vpException(vpException::notInitialized,"vpMomentArea not found");
 
 		double Xg = momentGravity.getXg();
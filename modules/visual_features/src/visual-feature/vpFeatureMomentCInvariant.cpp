@@ -65,11 +65,11 @@ void vpFeatureMomentCInvariant::compute_interaction(){
     bool found_featuremoment_basic;
 
     const vpMomentObject& momentObject = moment->getObject();
-    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered)));
-    const vpMomentCInvariant& momentCInvariant = (static_cast<const vpMomentCInvariant&>(moments.get("vpMomentCInvariant",found_moment_cinvariant)));
-    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(featureMomentsDataBase->get("vpFeatureMomentCentered",found_FeatureMoment_centered)));
+    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered)));
+    const vpMomentCInvariant& momentCInvariant = (static_cast<const vpMomentCInvariant&>(getMomentDependency("vpMomentCInvariant",found_moment_cinvariant)));
+    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(getFeatureDependency("vpFeatureMomentCentered",found_FeatureMoment_centered)));
 
-    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(featureMomentsDataBase->get("vpFeatureMomentBasic",found_featuremoment_basic)));
+    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(getFeatureDependency("vpFeatureMomentBasic",found_featuremoment_basic)));
 
     if(!found_featuremoment_basic) throw vpException(vpException::notInitialized,"vpFeatureMomentBasic not found");
 
@@ -212,12 +212,12 @@ void vpFeatureMomentCInvariant::compute_interaction(){
     bool found_featuremoment_basic;
 
     const vpMomentObject& momentObject = moment->getObject();
-    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered)));
-    const vpMomentCInvariant& momentCInvariant = (static_cast<const vpMomentCInvariant&>(moments.get("vpMomentCInvariant",found_moment_cinvariant)));
+    const vpMomentCentered& momentCentered = (static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered)));
+    const vpMomentCInvariant& momentCInvariant = (static_cast<const vpMomentCInvariant&>(getMomentDependency("vpMomentCInvariant",found_moment_cinvariant)));
 
-    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(featureMomentsDataBase->get("vpFeatureMomentCentered",found_FeatureMoment_centered)));
+    vpFeatureMomentCentered& featureMomentCentered = (static_cast<vpFeatureMomentCentered&>(getFeatureDependency("vpFeatureMomentCentered",found_FeatureMoment_centered)));
 
-    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(featureMomentsDataBase->get("vpFeatureMomentBasic",found_featuremoment_basic)));
+    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(getFeatureDependency("vpFeatureMomentBasic",found_featuremoment_basic)));
 
     if(!found_featuremoment_basic) throw vpException(vpException::notInitialized,"vpFeatureMomentBasic not found");
     if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
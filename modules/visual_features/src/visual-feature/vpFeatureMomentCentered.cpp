@@ -62,6 +62,10 @@ vpFeatureMomentCentered::vpFeatureMomentCentered(vpMomentDatabase& moments_,
                                                  vpFeatureMomentDatabase* featureMoments)
   : vpFeatureMoment(moments_, A_, B_, C_, featureMoments), order(0)
 {
+#ifdef VISP_MOMENTS_COMBINE_MATRICES
+  addFeatureDependency("vpFeatureMomentGravityCenter");
+  addFeatureDependency("vpFeatureMomentBasic");
+#endif
 }
 
 /*!
@@ -147,23 +151,23 @@ void vpFeatureMomentCentered::compute_interaction() {
         i->resize(1,6);
 
     bool found_moment_gravity;
-    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(moments.get("vpMomentGravityCenter",found_moment_gravity));
+    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMomentDependency("vpMomentGravityCenter",found_moment_gravity));
     if(!found_moment_gravity) throw vpException(vpException::notInitialized,"vpMomentGravityCenter not found");
     double xg = momentGravity.get()[0];
     double yg = momentGravity.get()[1];
 
     bool found_feature_gravity_center;
-    vpFeatureMomentGravityCenter& featureMomentGravityCenter= (static_cast<vpFeatureMomentGravityCenter&>(featureMomentsDataBase->get("vpFeatureMomentGravityCenter",found_feature_gravity_center)));
+    vpFeatureMomentGravityCenter& featureMomentGravityCenter= (static_cast<vpFeatureMomentGravityCenter&>(getFeatureDependency("vpFeatureMomentGravityCenter",found_feature_gravity_center)));
     if(!found_feature_gravity_center) throw vpException(vpException::notInitialized,"vpFeatureMomentGravityCenter not found");
     vpMatrix Lxg = featureMomentGravityCenter.interaction(1<<0);
     vpMatrix Lyg = featureMomentGravityCenter.interaction(1<<1);
 
     bool found_moment_basic;
-    const vpMomentBasic& momentbasic = static_cast<const vpMomentBasic&>(moments.get("vpMomentBasic",found_moment_basic));
+    const vpMomentBasic& momentbasic = static_cast<const vpMomentBasic&>(getMomentDependency("vpMomentBasic",found_moment_basic));
     if(!found_moment_basic) throw vpException(vpException::notInitialized,"vpMomentBasic not found");
 
     bool found_featuremoment_basic;
-    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(featureMomentsDataBase->get("vpFeatureMomentBasic",found_featuremoment_basic)));
+    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(getFeatureDependency("vpFeatureMomentBasic",found_featuremoment_basic)));
     if(!found_featuremoment_basic) throw vpException(vpException::notInitialized,"vpFeatureMomentBasic not found");
 
     // Calls the main compute_Lmu_pq function for moments upto order-1
@@ -176,8 +180,8 @@ void vpFeatureMomentCentered::compute_interaction() {
   bool found_moment_centered;
   bool found_moment_gravity;
 
-  const vpMomentCentered& momentCentered= (static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered)));
-  const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(moments.get("vpMomentGravityCenter",found_moment_gravity));
+  const vpMomentCentered& momentCentered= (static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered)));
+  const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMomentDependency("vpMomentGravityCenter",found_moment_gravity));
 
   if(!found_moment_centered) throw vpException(vpException::notInitialized,"vpMomentCentered not found");
   if(!found_moment_gravity) throw vpException(vpException::notInitialized,"vpMomentGravityCenter not found");
@@ -71,15 +71,10 @@ vpFeatureMomentCommon::vpFeatureMomentCommon(vpMomentDatabase& moments,double A,
   \param A : first plane coefficient for a plane equation of the following type Ax+By+C=1/Z
   \param B : second plane coefficient for a plane equation of the following type Ax+By+C=1/Z
   \param C : third plane coefficient for a plane equation of the following type Ax+By+C=1/Z  
+
+  Each feature is updated after the features it depends on, see vpFeatureMomentDatabase::updateAll().
 */
 void vpFeatureMomentCommon::updateAll(double A,double B,double C){
-    featureMomentBasic.update(A,B,C);
-    featureGravity.update(A,B,C);
-    featureCentered.update(A,B,C);
-    featureAn.update(A,B,C);    
-    featureGravityNormalized.update(A,B,C);
-    featureCInvariant.update(A,B,C);    
-    featureAlpha.update(A,B,C);
-    feature_moment_area.update(A,B,C);
+    vpFeatureMomentDatabase::updateAll(A,B,C);
 }
 
@@ -47,7 +47,74 @@
   \param name : the feature's name, usually the string naming it's class. Each name must be unique
 */
 void vpFeatureMomentDatabase::add(vpFeatureMoment& featureMoment,char* name){
-    featureMomentsDataBase.insert(std::pair<const char*,vpFeatureMoment*>((const char*)name,&featureMoment));
+    if (featureMomentsDataBase.insert(std::pair<const char*,vpFeatureMoment*>((const char*)name,&featureMoment)).second) {
+      linkedFeatures.push_back(&featureMoment);
+      revision++;
+    }
+}
+
+/*!
+  Retrieves a moment feature from the database
+  \param type : the name of the feature
+  \return the moment feature corresponding to the type string or NULL if it is not in the database
+*/
+vpFeatureMoment* vpFeatureMomentDatabase::find(const char* type) const {
+  std::map<const char*,vpFeatureMoment*,vpFeatureMomentDatabase::cmp_str>::const_iterator it = featureMomentsDataBase.find(type);
+  return (it != featureMomentsDataBase.end()) ? it->second : NULL;
+}
+
+/*!
+  Sorts the features by dependency level: the features of a level only depend on features of the previous
+  levels. Features of the same level keep the order in which they were linked. Dependencies that are not
+  in the database are ignored and the features of a cycle are put in the last level.
+*/
+void vpFeatureMomentDatabase::sortFeatures(){
+  const size_t nb = linkedFeatures.size();
+  std::vector<bool> sorted(nb, false);
+  updateOrder.clear();
+  updateOrder.reserve(nb);
+  levelStarts.clear();
+
+  while (updateOrder.size() < nb) {
+    size_t levelStart = updateOrder.size();
+    std::vector<bool> ready(nb, false);
+    for (size_t i = 0; i < nb; i++) {
+      if (sorted[i])
+        continue;
+      ready[i] = true;
+      const std::vector<const char*>& names = linkedFeatures[i]->featureDependencyNames;
+      for (size_t k = 0; k < names.size() && ready[i]; k++) {
+        const vpFeatureMoment* dependency = find(names[k]);
+        for (size_t j = 0; j < nb; j++) {
+          if (linkedFeatures[j] == dependency && j != i && !sorted[j]) {
+            ready[i] = false;
+            break;
+          }
+        }
+      }
+    }
+    for (size_t i = 0; i < nb; i++) {
+      if (ready[i])
+        updateOrder.push_back(linkedFeatures[i]);
+    }
+    if (updateOrder.size() == levelStart) {
+      // Dependency cycle: the remaining features are updated in the link order
+      for (size_t i = 0; i < nb; i++) {
+        if (!sorted[i])
+          updateOrder.push_back(linkedFeatures[i]);
+      }
+    }
+    for (size_t i = levelStart; i < updateOrder.size(); i++) {
+      for (size_t j = 0; j < nb; j++) {
+        if (linkedFeatures[j] == updateOrder[i])
+          sorted[j] = true;
+      }
+    }
+    levelStarts.push_back((unsigned int)levelStart);
+  }
+  levelStarts.push_back((unsigned int)nb);
+
+  updateOrderRevision = revision;
 }
 
 /*!
@@ -69,26 +136,28 @@ vpFeatureMoment& vpFeatureMomentDatabase::get(const char* type, bool& found){
   \param A : first plane coefficient for a plane equation of the following type Ax+By+C=1/Z
   \param B : second plane coefficient for a plane equation of the following type Ax+By+C=1/Z
   \param C : third plane coefficient for a plane equation of the following type Ax+By+C=1/Z  
+
+  Each feature is updated after the features it depends on. With OpenMP, the features that do not
+  depend on each other are updated in parallel.
 */
 void vpFeatureMomentDatabase::updateAll(double A, double B, double C)
 {
-  std::map<const char*,vpFeatureMoment*,vpFeatureMomentDatabase::cmp_str>::const_iterator itr;
+  if (updateOrderRevision != revision)
+    sortFeatures();
+
+  for (size_t level = 0; level + 1 < levelStarts.size(); level++) {
 #ifdef VISP_HAVE_OPENMP
-  std::vector<vpFeatureMoment*> values;
-  values.reserve(featureMomentsDataBase.size());
-  for(itr = featureMomentsDataBase.begin(); itr != featureMomentsDataBase.end(); ++itr){
-    values.push_back((*itr).second);
-  }
-  #pragma omp parallel for shared(A,B,C)
-  for(int i=0;i<(int)values.size();i++){
-    unsigned int i_ = static_cast<unsigned int>(i);
-    values[i_]->update(A,B,C);
-  }
+    #pragma omp parallel for shared(A,B,C)
+    for(int i=(int)levelStarts[level];i<(int)levelStarts[level+1];i++){
+      unsigned int i_ = static_cast<unsigned int>(i);
+      updateOrder[i_]->update(A,B,C);
+    }
 #else
-  for(itr = featureMomentsDataBase.begin(); itr != featureMomentsDataBase.end(); ++itr){
-		(*itr).second->update(A,B,C);
-	}
+    for(unsigned int i=levelStarts[level];i<levelStarts[level+1];i++){
+      updateOrder[i]->update(A,B,C);
+    }
 #endif
+  }
 }
 
 /*
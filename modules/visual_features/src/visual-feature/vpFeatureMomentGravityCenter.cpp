@@ -59,7 +59,7 @@
 void vpFeatureMomentGravityCenter::compute_interaction(){
     bool found_featuremoment_basic;
 
-    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(featureMomentsDataBase->get("vpFeatureMomentBasic",found_featuremoment_basic)));
+    vpFeatureMomentBasic& featureMomentBasic= (static_cast<vpFeatureMomentBasic&>(getFeatureDependency("vpFeatureMomentBasic",found_featuremoment_basic)));
     const vpMomentObject& momentObject = moment->getObject();
 
     if(!found_featuremoment_basic) throw vpException(vpException::notInitialized,"vpFeatureMomentBasic not found");
@@ -100,8 +100,8 @@ void vpFeatureMomentGravityCenter::compute_interaction(){
     bool found_moment_centered;
     bool found_moment_gravity;
 
-    const vpMomentCentered& momentCentered= (static_cast<const vpMomentCentered&>(moments.get("vpMomentCentered",found_moment_centered)));
-    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(moments.get("vpMomentGravityCenter",found_moment_gravity));
+    const vpMomentCentered& momentCentered= (static_cast<const vpMomentCentered&>(getMomentDependency("vpMomentCentered",found_moment_centered)));
+    const vpMomentGravityCenter& momentGravity = static_cast<const vpMomentGravityCenter&>(getMomentDependency("vpMomentGravityCenter",found_moment_gravity));
 
 
     const vpMomentObject& momentObject = moment->getObject();
@@ -380,6 +380,8 @@ public:
   void setInteractionMatrixType(const vpServoIteractionMatrixType &interactionMatrixType,
                                 const vpServoInversionType &interactionMatrixInversion=PSEUDO_INVERSE) ;
 
+  void setFullRankTask(bool fullRank) ;
+
   /*!
     Set the gain \f$\lambda\f$ used in the control law (see vpServo::vpServoType) as constant.
 
@@ -481,6 +483,8 @@ public:
    */
   void computeProjectionOperators();
 
+  void computeTaskJacobianInverse();
+
   public:
   //! Interaction matrix
   vpMatrix L ;
@@ -611,6 +615,12 @@ public:
 
   //! A diag matrix used to determine which are the degrees of freedom that are controlled in the camera frame
   vpMatrix cJc;
+
+  //! Task Jacobian for which J1p, WpW and I_WpW were computed.
+  vpMatrix J1_last;
+
+  //! Boolean to know if the task Jacobian is full rank (for fast computation of its inverse).
+  bool fullRankTask;
 } ;
 
 #endif
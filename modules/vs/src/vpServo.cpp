@@ -40,6 +40,7 @@
 
 #include <visp3/vs/vpServo.h>
 
+#include <cstring>
 #include <sstream>
 
 // Exception
@@ -72,7 +73,7 @@ vpServo::vpServo()
     cVf(), init_cVf(false), fVe(), init_fVe(false), eJe(), init_eJe(false), fJe(), init_fJe(false),
     errorComputed(false), interactionMatrixComputed(false), dim_task(0), taskWasKilled(false),
     forceInteractionMatrixComputation(false), WpW(), I_WpW(), P(), sv(), mu(4.), e1_initial(),
-    iscJcIdentity(true), cJc(6,6)
+    iscJcIdentity(true), cJc(6,6), J1_last(), fullRankTask(false)
 {
   cJc.eye();
 }
@@ -97,7 +98,7 @@ vpServo::vpServo(vpServoType servo_type)
     cVf(), init_cVf(false), fVe(), init_fVe(false), eJe(), init_eJe(false), fJe(), init_fJe(false),
     errorComputed(false), interactionMatrixComputed(false), dim_task(0), taskWasKilled(false),
     forceInteractionMatrixComputation(false), WpW(), I_WpW(), P(), sv(), mu(4), e1_initial(),
-    iscJcIdentity(true), cJc(6,6)
+    iscJcIdentity(true), cJc(6,6), J1_last(), fullRankTask(false)
 {
   cJc.eye();
 }
@@ -170,6 +171,8 @@ void vpServo::init()
   forceInteractionMatrixComputation = false;
 
   rankJ1 = 0;
+  J1_last.resize(0, 0);
+  fullRankTask = false;
 }
 
 /*!
@@ -587,6 +590,29 @@ void vpServo::setInteractionMatrixType(const vpServoIteractionMatrixType &intera
 {
   this->interactionMatrixType = interactionMatrix_type ;
   this->inversionType = interactionMatrixInversion ;
+  // The inverse of the task Jacobian has to be computed again
+  J1_last.resize(0, 0);
+}
+
+/*!
+  Indicate that the task Jacobian is known to have a full rank, equal to
+  the smallest of its dimensions. Its pseudo inverse is then computed by
+  inverting \f${\bf J}^\top{\bf J}\f$ (or \f${\bf J}{\bf J}^\top\f$ when the
+  task dimension is lower than the number of degrees of freedom) with a LU
+  decomposition instead of a singular value decomposition, which is several
+  times faster for small tasks.
+
+  This is only valid when the task Jacobian is far from singular: the rank is
+  not checked and the singular values returned by getTaskSingularValues() are
+  not updated.
+
+  \param fullRank : true to use the faster inversion, false to use the
+  singular value decomposition (default).
+*/
+void vpServo::setFullRankTask(bool fullRank)
+{
+  this->fullRankTask = fullRank;
+  J1_last.resize(0, 0);
 }
 
 
@@ -648,9 +674,7 @@ static void computeInteractionMatrixFromList  (const std::list<vpBasicFeature *>
 
     /* Copy the temporarily matrix into L. */
     for (unsigned int k = 0; k < rowMatrixTmp; ++k, ++cursorL) {
-      for (unsigned int j = 0; j <  colMatrixTmp; ++j) {
-        L[cursorL][j] = matrixTmp[k][j];
-      }
+      memcpy(L[cursorL], matrixTmp[k], colMatrixTmp*sizeof(double));
     }
   }
 
@@ -723,7 +747,9 @@ vpMatrix vpServo::computeInteractionMatrix()
       {
         throw ;
       }
-      L = (L+Lstar)/2;
+      for (unsigned int i = 0; i < L.size(); i++) {
+        L.data[i] = (L.data[i] + Lstar.data[i]) / 2;
+      }
 
       dim_task = L.getRows() ;
       interactionMatrixComputed = true ;
@@ -1017,21 +1043,9 @@ vpColVector vpServo::computeControlLaw()
     // handle the eye-in-hand eye-to-hand case
     J1 *= signInteractionMatrix ;
 
-    // pseudo inverse of the task Jacobian
-    // and rank of the task Jacobian
-    // the image of J1 is also computed to allows the computation
-    // of the projection operator
-    vpMatrix imJ1t, imJ1 ;
-    bool imageComputed = false ;
-
-    if (inversionType==PSEUDO_INVERSE)
-    {
-      rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t) ;
-
-      imageComputed = true ;
-    }
-    else
-      J1p = J1.t() ;
+    // pseudo inverse of the task Jacobian, rank of the task Jacobian
+    // and projection operators, computed again only if J1 changed
+    computeTaskJacobianInverse() ;
 
     if (rankJ1 == J1.getCols())
     {
@@ -1039,37 +1053,13 @@ vpColVector vpServo::computeControlLaw()
        WpW = I, multiply by WpW is useless
     */
       e1 = J1p*error ;// primary task
-
-      WpW.eye(J1.getCols(), J1.getCols()) ;
     }
     else
     {
-      if (imageComputed!=true)
-      {
-        vpMatrix Jtmp ;
-        // image of J1 is computed to allows the computation
-        // of the projection operator
-        rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t) ;
-      }
-      WpW = imJ1t*imJ1t.t() ;
-
-#ifdef DEBUG
-      std::cout << "rank J1 " << rankJ1 <<std::endl ;
-      std::cout << "imJ1t"<<std::endl  << imJ1t ;
-      std::cout << "imJ1"<<std::endl  << imJ1 ;
-
-      std::cout << "WpW" <<std::endl <<WpW  ;
-      std::cout << "J1" <<std::endl <<J1  ;
-      std::cout << "J1p" <<std::endl <<J1p  ;
-#endif
       e1 = WpW*J1p*error ;
     }
     e = - lambda(e1) * e1 ;
 
-    vpMatrix I ;
-
-    I.eye(J1.getCols(),J1.getCols()) ;
-
     computeProjectionOperators();
 
   }
@@ -1173,21 +1163,9 @@ vpColVector vpServo::computeControlLaw(double t)
     // handle the eye-in-hand eye-to-hand case
     J1 *= signInteractionMatrix ;
 
-    // pseudo inverse of the task Jacobian
-    // and rank of the task Jacobian
-    // the image of J1 is also computed to allows the computation
-    // of the projection operator
-    vpMatrix imJ1t, imJ1 ;
-    bool imageComputed = false ;
-
-    if (inversionType==PSEUDO_INVERSE)
-    {
-      rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t) ;
-
-      imageComputed = true ;
-    }
-    else
-      J1p = J1.t() ;
+    // pseudo inverse of the task Jacobian, rank of the task Jacobian
+    // and projection operators, computed again only if J1 changed
+    computeTaskJacobianInverse() ;
 
     if (rankJ1 == J1.getCols())
     {
@@ -1195,29 +1173,9 @@ vpColVector vpServo::computeControlLaw(double t)
        WpW = I, multiply by WpW is useless
     */
       e1 = J1p*error ;// primary task
-
-      WpW.eye(J1.getCols(), J1.getCols()) ;
     }
     else
     {
-      if (imageComputed!=true)
-      {
-        vpMatrix Jtmp ;
-        // image of J1 is computed to allows the computation
-        // of the projection operator
-        rankJ1 = J1.pseudoInverse(Jtmp, sv, 1e-6, imJ1, imJ1t) ;
-      }
-      WpW = imJ1t*imJ1t.t() ;
-
-#ifdef DEBUG
-      std::cout << "rank J1 " << rankJ1 <<std::endl ;
-      std::cout << "imJ1t"<<std::endl  << imJ1t ;
-      std::cout << "imJ1"<<std::endl  << imJ1 ;
-
-      std::cout << "WpW" <<std::endl <<WpW  ;
-      std::cout << "J1" <<std::endl <<J1  ;
-      std::cout << "J1p" <<std::endl <<J1p  ;
-#endif
       e1 = WpW*J1p*error ;
     }
 
@@ -1231,10 +1189,6 @@ vpColVector vpServo::computeControlLaw(double t)
 
     e = - lambda(e1) * e1 + lambda(e1) * e1_initial*exp(-mu*t);
 
-    vpMatrix I ;
-
-    I.eye(J1.getCols(), J1.getCols()) ;
-
     computeProjectionOperators() ;
   }
   catch(...) {
@@ -1336,8 +1290,74 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
     // handle the eye-in-hand eye-to-hand case
     J1 *= signInteractionMatrix ;
 
-    // pseudo inverse of the task Jacobian
-    // and rank of the task Jacobian
+    // pseudo inverse of the task Jacobian, rank of the task Jacobian
+    // and projection operators, computed again only if J1 changed
+    computeTaskJacobianInverse() ;
+
+    if (rankJ1 == J1.getCols())
+    {
+      /* if no degrees of freedom remains (rank J1 = ndof)
+       WpW = I, multiply by WpW is useless
+    */
+      e1 = J1p*error ;// primary task
+    }
+    else
+    {
+      e1 = WpW*J1p*error ;
+    }
+
+    // memorize the initial e1 value if the function is called the first time or if the time given as parameter is equal to 0.
+    if (iteration==0 || std::fabs(t) < std::numeric_limits<double>::epsilon()) {
+      e1_initial = e1;
+    }
+    // Security check. If size of e1_initial and e1 differ, that means that e1_initial was not set
+    if (e1_initial.getRows() != e1.getRows())
+      e1_initial = e1;
+
+    e = - lambda(e1) * e1 + (e_dot_init + lambda(e1) * e1_initial)*exp(-mu*t);
+
+    computeProjectionOperators();
+  }
+  catch(...) {
+    throw;
+  }
+
+  iteration++ ;
+  return e ;
+}
+
+/*!
+  Compute the pseudo inverse \f${\bf J}_1^+\f$ of the task Jacobian, its rank and the
+  projection operators \f${\bf W}^+{\bf W}\f$ and \f${\bf I}-{\bf W}^+{\bf W}\f$.
+
+  They only depend on the task Jacobian: when it is the same as at the previous
+  call, which is the case with an interaction matrix computed from constant desired
+  features and a constant robot Jacobian, the previous values are kept.
+*/
+void vpServo::computeTaskJacobianInverse()
+{
+  const unsigned int n = J1.getCols();
+  if (J1_last.getRows() == J1.getRows() && J1_last.getCols() == n && J1.size() > 0
+      && memcmp(J1_last.data, J1.data, J1.size()*sizeof(double)) == 0) {
+    return;
+  }
+
+  if (inversionType == PSEUDO_INVERSE && fullRankTask)
+  {
+    // J1p = (J1^T J1)^-1 J1^T, or J1^T (J1 J1^T)^-1 when the task dimension is lower than n
+    if (J1.getRows() >= n) {
+      J1p = J1.AtA().inverseByLU() * J1.t() ;
+      rankJ1 = n ;
+      WpW.eye(n, n) ;
+    }
+    else {
+      J1p = J1.t() * J1.AAt().inverseByLU() ;
+      rankJ1 = J1.getRows() ;
+      WpW = J1p * J1 ;
+    }
+  }
+  else
+  {
     // the image of J1 is also computed to allows the computation
     // of the projection operator
     vpMatrix imJ1t, imJ1 ;
@@ -1346,20 +1366,17 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
     if (inversionType==PSEUDO_INVERSE)
     {
       rankJ1 = J1.pseudoInverse(J1p, sv, 1e-6, imJ1, imJ1t) ;
-
       imageComputed = true ;
     }
     else
       J1p = J1.t() ;
 
-    if (rankJ1 == J1.getCols())
+    if (rankJ1 == n)
     {
       /* if no degrees of freedom remains (rank J1 = ndof)
        WpW = I, multiply by WpW is useless
-    */
-      e1 = J1p*error ;// primary task
-
-      WpW.eye(J1.getCols(), J1.getCols()) ;
+      */
+      WpW.eye(n, n) ;
     }
     else
     {
@@ -1381,44 +1398,24 @@ vpColVector vpServo::computeControlLaw(double t, const vpColVector &e_dot_init)
       std::cout << "J1" <<std::endl <<J1  ;
       std::cout << "J1p" <<std::endl <<J1p  ;
 #endif
-      e1 = WpW*J1p*error ;
     }
-
-    // memorize the initial e1 value if the function is called the first time or if the time given as parameter is equal to 0.
-    if (iteration==0 || std::fabs(t) < std::numeric_limits<double>::epsilon()) {
-      e1_initial = e1;
-    }
-    // Security check. If size of e1_initial and e1 differ, that means that e1_initial was not set
-    if (e1_initial.getRows() != e1.getRows())
-      e1_initial = e1;
-
-    e = - lambda(e1) * e1 + (e_dot_init + lambda(e1) * e1_initial)*exp(-mu*t);
-
-    vpMatrix I ;
-
-    I.eye(J1.getCols(), J1.getCols()) ;
-
-    computeProjectionOperators();
-  }
-  catch(...) {
-    throw;
   }
 
-  iteration++ ;
-  return e ;
+  //Compute classical projection operator
+  vpMatrix I;
+  I.eye(n);
+  I_WpW = (I - WpW) ;
+
+  J1_last = J1 ;
 }
 
 void vpServo::computeProjectionOperators()
 {
   // Initialization
   unsigned int n = J1.getCols();
-  P.resize(n,n);
-
-  vpMatrix I;
-  I.eye(n);
+  P.resize(n,n,false);
 
-  //Compute classical projection operator
-  I_WpW = (I - WpW) ;
+  // The classical projection operator I_WpW is updated in computeTaskJacobianInverse()
 
   // Compute gain depending by the task error to ensure a smooth change between the operators.
   double e0_ = 0.1;
@@ -1433,19 +1430,28 @@ void vpServo::computeProjectionOperators()
   else
     sig = 0.0;
 
-  vpMatrix J1t = J1.transpose();
-
-  double pp = (error.t() * (J1 * J1t) * error);
-
-  vpMatrix  ee_t(n,n);
-  ee_t =  error * error.t();
-
-  vpMatrix P_norm_e(n,n);
-  P_norm_e = I - (1.0 / pp ) * J1t * ee_t * J1;
+  if (sig == 0.0) {
+    P = I_WpW;
+    return;
+  }
 
-  P = sig * P_norm_e + (1 - sig) * I_WpW;
+  // P_norm_e = I - (1 / e^T J1 J1^T e) J1^T e e^T J1 is computed from the n-vector J1^T e,
+  // without forming the task dimension square matrix e e^T
+  vpColVector J1te(n, 0.0);
+  for (unsigned int i = 0; i < J1.getRows(); i++) {
+    const double *J1_i = J1[i];
+    for (unsigned int j = 0; j < n; j++) {
+      J1te[j] += J1_i[j] * error[i];
+    }
+  }
+  double pp = J1te.sumSquare();
 
-  return;
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      double P_norm_e = (i == j ? 1.0 : 0.0) - J1te[i] * J1te[j] / pp;
+      P[i][j] = sig * P_norm_e + (1 - sig) * I_WpW[i][j];
+    }
+  }
 }
 
 /*!
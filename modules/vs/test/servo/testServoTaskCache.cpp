@@ -0,0 +1,286 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2017 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Test the inverse of the task Jacobian computed by vpServo.
+ *
+ *****************************************************************************/
+
+/*!
+  \example testServoTaskCache.cpp
+
+  Compare the velocities and projection operators computed by vpServo, when
+  the inverse of the task Jacobian is kept from one iteration to the other or
+  computed with the full rank assumption, with an explicit computation.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <visp3/core/vpExponentialMap.h>
+#include <visp3/core/vpHomogeneousMatrix.h>
+#include <visp3/core/vpMath.h>
+#include <visp3/core/vpPoint.h>
+#include <visp3/visual_features/vpFeatureBuilder.h>
+#include <visp3/visual_features/vpFeaturePoint.h>
+#include <visp3/vs/vpServo.h>
+#include <visp3/io/vpParseArgv.h>
+
+namespace {
+double maxDifference(const vpArray2D<double> &A, const vpArray2D<double> &B)
+{
+  if (A.getRows() != B.getRows() || A.getCols() != B.getCols())
+    return 1e10;
+  double max_diff = 0;
+  for (unsigned int i = 0; i < A.size(); i++)
+    max_diff = std::max(max_diff, fabs(A.data[i] - B.data[i]));
+  return max_diff;
+}
+
+// Build the current and desired features of nbPoints points seen by the camera at cMo and cdMo
+void buildFeatures(unsigned int nbPoints, const vpHomogeneousMatrix &cMo, const vpHomogeneousMatrix &cdMo,
+                   std::vector<vpFeaturePoint> &p, std::vector<vpFeaturePoint> &pd)
+{
+  const double X[4] = { -0.1, 0.1, 0.1, -0.1 }, Y[4] = { -0.1, -0.1, 0.1, 0.12 };
+  p.resize(nbPoints);
+  pd.resize(nbPoints);
+  for (unsigned int i = 0; i < nbPoints; i++) {
+    vpPoint point(X[i], Y[i], 0);
+    point.track(cMo);
+    vpFeatureBuilder::create(p[i], point);
+    point.track(cdMo);
+    vpFeatureBuilder::create(pd[i], point);
+  }
+}
+}
+
+// List of allowed command line options
+#define GETOPTARGS	"cdh"
+
+void usage(const char *name, const char *badparam);
+bool getOptions(int argc, const char **argv);
+
+/*!
+
+  Print the program options.
+
+  \param name : Program name.
+  \param badparam : Bad parameter name.
+
+*/
+void usage(const char *name, const char *badparam)
+{
+  fprintf(stdout, "\n\
+Test the interaction matrices and projection operators cached by vpServo.\n\
+\n\
+SYNOPSIS\n\
+  %s [-c] [-d] [-h]\n", name);
+
+  fprintf(stdout, "\n\
+OPTIONS:                                               \n\
+\n\
+  -c\n\
+     Disable the mouse click. Useless in this test.\n\
+\n\
+  -d\n\
+     Turn off the display. Useless in this test.\n\
+\n\
+  -h\n\
+     Print the help.\n\n");
+
+  if (badparam)
+    fprintf(stdout, "\nERROR: Bad parameter [%s]\n", badparam);
+}
+
+/*!
+
+  Set the program options.
+
+  \param argc : Command line number of parameters.
+  \param argv : Array of command line parameters.
+  \return false if the program has to be stopped, true otherwise.
+
+*/
+bool getOptions(int argc, const char **argv)
+{
+  const char *optarg_;
+  int	c;
+  while ((c = vpParseArgv::parse(argc, argv, GETOPTARGS, &optarg_)) > 1) {
+
+    switch (c) {
+    case 'c':
+    case 'd':
+      break;
+    case 'h': usage(argv[0], NULL); return false; break;
+
+    default:
+      usage(argv[0], optarg_);
+      return false; break;
+    }
+  }
+
+  if ((c == 1) || (c == -1)) {
+    // standalone param or error
+    usage(argv[0], NULL);
+    std::cerr << "ERROR: " << std::endl;
+    std::cerr << "  Bad argument " << optarg_ << std::endl << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  try {
+    // Read the command line options
+    if (getOptions(argc, argv) == false) {
+      return (-1);
+    }
+
+    vpHomogeneousMatrix cdMo(0, 0, 0.75, 0, 0, 0);
+    const double lambda = 0.5;
+
+    // Eye-in-hand task with 4 points: the interaction matrix changes at each iteration,
+    // the inverse is computed again with the singular value decomposition or with the full rank assumption
+    for (unsigned int full_rank = 0; full_rank < 2; full_rank++) {
+      vpServo task;
+      task.setServo(vpServo::EYEINHAND_CAMERA);
+      task.setInteractionMatrixType(vpServo::CURRENT);
+      task.setLambda(lambda);
+      task.setFullRankTask(full_rank == 1);
+      std::vector<vpFeaturePoint> p, pd;
+      vpHomogeneousMatrix cMo(0.1, 0.05, 1.2, vpMath::rad(5), vpMath::rad(-10), vpMath::rad(20));
+      buildFeatures(4, cMo, cdMo, p, pd);
+      for (unsigned int i = 0; i < 4; i++)
+        task.addFeature(p[i], pd[i]);
+
+      double max_diff = 0;
+      for (unsigned int iter = 0; iter < 5; iter++) {
+        vpColVector v = task.computeControlLaw();
+        vpColVector v_ref = - lambda * task.L.pseudoInverse(1e-6) * task.error;
+        max_diff = std::max(max_diff, maxDifference(v, v_ref));
+
+        cMo = vpExponentialMap::direct(v, 0.04).inverse() * cMo;
+        std::vector<vpFeaturePoint> p_new, pd_new;
+        buildFeatures(4, cMo, cdMo, p_new, pd_new);
+        for (unsigned int i = 0; i < 4; i++)
+          p[i].buildFrom(p_new[i].get_x(), p_new[i].get_y(), p_new[i].get_Z());
+      }
+      if (max_diff >= 1e-8) {
+        throw vpException(vpException::fatalError, "%s failed",
+                          full_rank ? "Current interaction matrix with full rank assumption" : "Current interaction matrix");
+      }
+      task.kill();
+    }
+
+    // With the desired interaction matrix the inverse is kept but the error changes
+    {
+      vpServo task;
+      task.setServo(vpServo::EYEINHAND_CAMERA);
+      task.setInteractionMatrixType(vpServo::DESIRED);
+      task.setLambda(lambda);
+      std::vector<vpFeaturePoint> p, pd;
+      vpHomogeneousMatrix cMo(0.1, 0.05, 1.2, vpMath::rad(5), vpMath::rad(-10), vpMath::rad(20));
+      buildFeatures(4, cMo, cdMo, p, pd);
+      for (unsigned int i = 0; i < 4; i++)
+        task.addFeature(p[i], pd[i]);
+
+      double max_diff = 0;
+      for (unsigned int iter = 0; iter < 3; iter++) {
+        vpColVector v = task.computeControlLaw();
+        vpColVector v_ref = - lambda * task.L.pseudoInverse(1e-6) * task.error;
+        max_diff = std::max(max_diff, maxDifference(v, v_ref));
+        p[0].set_x(p[0].get_x() + 0.01);
+      }
+      if (max_diff >= 1e-8) {
+        throw vpException(vpException::fatalError, "Desired interaction matrix failed");
+      }
+
+      // Changing the inversion type invalidates the inverse
+      task.setInteractionMatrixType(vpServo::DESIRED, vpServo::TRANSPOSE);
+      vpColVector v = task.computeControlLaw();
+      if (maxDifference(v, - lambda * task.L.t() * task.error) >= 1e-8) {
+        throw vpException(vpException::fatalError, "Transpose of the interaction matrix failed");
+      }
+      task.kill();
+    }
+
+    // Task with 2 points: the projection operators on the 2 remaining degrees of freedom
+    {
+      vpServo task;
+      task.setServo(vpServo::EYEINHAND_CAMERA);
+      task.setInteractionMatrixType(vpServo::CURRENT);
+      task.setLambda(lambda);
+      std::vector<vpFeaturePoint> p, pd;
+      vpHomogeneousMatrix cMo(0.1, 0.05, 1.2, vpMath::rad(5), vpMath::rad(-10), vpMath::rad(20));
+      buildFeatures(2, cMo, cdMo, p, pd);
+      for (unsigned int i = 0; i < 2; i++)
+        task.addFeature(p[i], pd[i]);
+
+      for (unsigned int full_rank = 0; full_rank < 2; full_rank++) {
+        task.setFullRankTask(full_rank == 1);
+        vpColVector v = task.computeControlLaw();
+        vpMatrix J = task.L, Jp, imJ, imJt;
+        vpColVector sv;
+        unsigned int rank = J.pseudoInverse(Jp, sv, 1e-6, imJ, imJt);
+        vpMatrix WpW = imJt * imJt.t(), I;
+        I.eye(6);
+        vpColVector e = task.error;
+        vpMatrix P_norm_e = I - (1.0 / (e.t() * J * J.t() * e)) * J.t() * e * e.t() * J;
+        double norm_e = e.euclideanNorm();
+        double sig = norm_e > 0.7 ? 1.0 : (norm_e >= 0.1 ? 1.0 / (1.0 + exp(-12.0 * (norm_e - 0.1) / 0.6 + 6.0)) : 0.0);
+        vpMatrix P = sig * P_norm_e + (1 - sig) * (I - WpW);
+
+        std::string legend = full_rank ? "Two points with full rank assumption" : "Two points";
+        if (task.getTaskRank() != rank) {
+          throw vpException(vpException::fatalError, "%s failed", (legend + ", rank").c_str());
+        }
+        if (maxDifference(v, - lambda * WpW * Jp * e) >= 1e-8) {
+          throw vpException(vpException::fatalError, "%s failed", (legend + ", velocity").c_str());
+        }
+        if (maxDifference(task.getI_WpW(), I - WpW) >= 1e-8) {
+          throw vpException(vpException::fatalError, "%s failed", (legend + ", classical projection operator").c_str());
+        }
+        if (maxDifference(task.getLargeP(), P) >= 1e-8) {
+          throw vpException(vpException::fatalError, "%s failed", (legend + ", large projection operator").c_str());
+        }
+      }
+      task.kill();
+    }
+
+    std::cout << "Servo task cache test succeed" << std::endl;
+    return 0;
+  }
+  catch(const vpException &e) {
+    std::cerr << "Catch an exception: " << e << std::endl;
+    return 1;
+  }
+}